@@ -0,0 +1,40 @@
+function updateWheelSizeFromPreset() {
+  var preset = document.getElementById('wheel_size_preset');
+  var manual = document.getElementById('wheel_size');
+  if (preset.value) {
+    manual.value = preset.value;
+  }
+}
+
+function updatePresetFromManual() {
+  var preset = document.getElementById('wheel_size_preset');
+  var manual = document.getElementById('wheel_size');
+  var manualValue = parseInt(manual.value);
+
+  // Check if manual value matches a preset (with 5mm tolerance)
+  var presets = [
+    {value: '1590', mm: 1590},
+    {value: '1910', mm: 1910},
+    {value: '2075', mm: 2075},
+    {value: '2224', mm: 2224},
+    {value: '2300', mm: 2300}
+  ];
+
+  var matched = false;
+  for (var i = 0; i < presets.length; i++) {
+    if (Math.abs(manualValue - presets[i].mm) <= 5) {
+      preset.value = presets[i].value;
+      matched = true;
+      break;
+    }
+  }
+
+  if (!matched) {
+    preset.value = '';
+  }
+}
+
+// Initialize preset selection on page load
+window.onload = function() {
+  updatePresetFromManual();
+};
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""
+Pre-build script to embed the static config portal assets.
+Compresses the files in portal/ with gzip and writes them as byte arrays
+to src/portal_assets.h, which configserver.cpp serves with
+Content-Encoding: gzip. The header is only rewritten when its content
+changes, so it does not trigger a rebuild on every run.
+
+Can also be run directly: python3 scripts/build_portal_assets.py
+"""
+
+import gzip
+from pathlib import Path
+
+# (source file in portal/, C identifier prefix)
+ASSETS = [
+    ('style.css', 'PORTAL_STYLE_CSS'),
+    ('portal.js', 'PORTAL_SCRIPT_JS'),
+]
+
+HEADER_TEMPLATE = """/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    portal_assets.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Generated by scripts/build_portal_assets.py from portal/ - do not edit.
+ * Static files of the config portal, gzip compressed, kept in flash.
+ */
+
+#ifndef PORTAL_ASSETS_H
+#define PORTAL_ASSETS_H
+
+#include <Arduino.h>
+
+{arrays}
+#endif
+"""
+
+
+def c_array(name, data):
+    """Format data as a PROGMEM byte array with its length constant."""
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ', '.join(f'0x{b:02x}' for b in data[i:i + 16]) + ',')
+    return (f'static const uint8_t {name}_GZ[] PROGMEM = {{\n' + '\n'.join(lines) + '\n};\n'
+            f'static const size_t {name}_GZ_LEN = sizeof({name}_GZ);\n')
+
+
+def build(project_dir):
+    portal_dir = project_dir / 'portal'
+    header_file = project_dir / 'src' / 'portal_assets.h'
+    arrays = []
+    for filename, name in ASSETS:
+        raw = (portal_dir / filename).read_bytes()
+        # mtime=0: the same input always gives the same bytes
+        data = gzip.compress(raw, compresslevel=9, mtime=0)
+        arrays.append(f'// {filename}: {len(raw)} bytes, {len(data)} bytes compressed\n' + c_array(name, data))
+    content = HEADER_TEMPLATE.replace('{arrays}', '\n'.join(arrays))
+    if header_file.exists() and header_file.read_text() == content:
+        return
+    header_file.write_text(content)
+    print(f"Updated {header_file.relative_to(project_dir)}")
+
+
+try:
+    Import("env")
+    build(Path(env["PROJECT_DIR"]))
+except NameError:
+    # Run outside of PlatformIO
+    build(Path(__file__).resolve().parent.parent)
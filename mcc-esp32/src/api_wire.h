@@ -0,0 +1,227 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    api_wire.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Wire format of the device API: request bodies of update-data,
+ * get-user-id and heartbeat, and the response fields the firmware reads
+ * from them. Shared by the firmware and the host fleet simulator
+ * (test/fleet), so the load test sends exactly what a device sends.
+ * Header-only; uses ArduinoJson but no Arduino types.
+ */
+
+#ifndef API_WIRE_H
+#define API_WIRE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ArduinoJson.h>
+#include "ride_stats.h"
+#include "ride_trace.h"
+
+/**
+ * @brief Fills the update-data body: {"distance": km, "device_id": "...", "id_tag": "..."}.
+ *
+ * Strings are stored by pointer and must outlive the serialization.
+ */
+static inline void apiWireUpdateData(JsonObject doc, const char* deviceId, const char* idTag, float distance_km) {
+    doc["distance"] = distance_km;
+    doc["device_id"] = deviceId;
+    doc["id_tag"] = idTag;
+}
+
+/**
+ * @brief Adds the ride statistics of one upload interval as "stats" object.
+ *
+ * Format: {"ride_ms": 28750, "idle_ms": 0, "v_min": 1202, "v_avg": 2135, "v_max": 3241, "bands_ms": [0, 0, 1200, ...]}
+ * Speeds are in 0.01 km/h; bands_ms holds the riding time per 5 km/h band (last band: from 40 km/h).
+ * Nothing is added for an interval without pulse intervals.
+ */
+static inline void apiWireRideStats(JsonObject doc, const RideStats& stats) {
+    if (stats.intervals == 0 && stats.idleUs == 0) {
+        return;
+    }
+    JsonObject obj = doc.createNestedObject("stats");
+    obj["ride_ms"] = (uint32_t)(stats.activeUs / 1000);
+    obj["idle_ms"] = (uint32_t)(stats.idleUs / 1000);
+    obj["v_min"] = stats.minCkmh;
+    obj["v_avg"] = rideStatsAvgCkmh(&stats);
+    obj["v_max"] = stats.maxCkmh;
+    JsonArray bands = obj.createNestedArray("bands_ms");
+    for (int i = 0; i < RIDE_STATS_BANDS; i++) {
+        bands.add(stats.bandMs[i]);
+    }
+}
+
+/**
+ * @brief Adds a ride trace (ride_trace.h) as "trace" object.
+ *
+ * Format: {"res_us": 100, "n": 118, "age_ms": 30412, "dropped": 0, "data": "<base64>"}
+ * age_ms is the time from the trace's anchor pulse to building the body. Nothing is added for an empty trace.
+ *
+ * @param base64 Encoded trace data; stored by pointer and must outlive the serialization
+ */
+static inline void apiWireRideTrace(JsonObject doc, const RideTrace& trace, const char* base64, uint32_t ageMs) {
+    if (trace.count == 0) {
+        return;
+    }
+    JsonObject obj = doc.createNestedObject("trace");
+    obj["res_us"] = RIDE_TRACE_TICK_US;
+    obj["n"] = trace.count;
+    obj["age_ms"] = ageMs;
+    obj["dropped"] = trace.dropped;
+    obj["data"] = base64;
+}
+
+/**
+ * @brief Fills the get-user-id body.
+ *
+ * @param idTag Tag to look up
+ * @param deviceName Device name as configured (without the MAC suffix, as the firmware sends it)
+ * @param currentIdTag Tag the device counts for right now
+ */
+static inline void apiWireUserIdQuery(JsonObject doc, const char* idTag, const char* deviceName, const char* currentIdTag) {
+    doc["id_tag"] = idTag;
+    doc["device_id"] = deviceName;
+    doc["current_id_tag"] = currentIdTag;
+}
+
+/**
+ * @brief Fills the fields every heartbeat carries; boot reason and metrics are added by the caller.
+ */
+static inline void apiWireHeartbeat(JsonObject doc, const char* deviceId, uint32_t heapFree, uint32_t heapMinFree,
+                                    uint32_t heapMaxBlock) {
+    doc["device_id"] = deviceId;
+    // Heap low-water mark: stays flat if the upload cycle does not allocate
+    doc["heap_free"] = heapFree;
+    doc["heap_min_free"] = heapMinFree;
+    doc["heap_max_block"] = heapMaxBlock;
+}
+
+/**
+ * @brief If-None-Match value of a config fetch: the decimal config hash in quotes (ETag of config/fetch).
+ *
+ * @return false for hash 0 (no config applied yet, no header)
+ */
+static inline bool apiWireConfigEtag(char* out, size_t outSize, uint32_t serverHash) {
+    if (serverHash == 0) {
+        return false;
+    }
+    snprintf(out, outSize, "\"%u\"", (unsigned)serverHash);
+    return true;
+}
+
+/**
+ * @brief How the firmware treats an HTTP result of an API request.
+ */
+enum ApiWireError : uint8_t {
+    API_WIRE_OK = 0,          // 2xx (304 of a config fetch is handled by the caller)
+    API_WIRE_API_KEY,         // 401, 403: API key error, shown until a request succeeds
+    API_WIRE_NOT_FOUND,       // 404: unknown cyclist or device
+    API_WIRE_MAINTENANCE,     // 503
+    API_WIRE_SERVER,          // Any other HTTP status
+    API_WIRE_CONNECTION,      // HTTPClient error (< 0), no response
+    API_WIRE_ERROR_COUNT
+};
+
+static inline ApiWireError apiWireError(int httpCode) {
+    if (httpCode <= 0) {
+        return API_WIRE_CONNECTION;
+    }
+    if (httpCode >= 200 && httpCode < 300) {
+        return API_WIRE_OK;
+    }
+    if (httpCode == 401 || httpCode == 403) {
+        return API_WIRE_API_KEY;
+    }
+    if (httpCode == 404) {
+        return API_WIRE_NOT_FOUND;
+    }
+    if (httpCode == 503) {
+        return API_WIRE_MAINTENANCE;
+    }
+    return API_WIRE_SERVER;
+}
+
+/**
+ * @brief Fields of a get-user-id response (HTTP 200).
+ */
+struct ApiWireUserId {
+    const char* userId;        // user_id; "NULL" for an unknown tag, nullptr if missing
+    bool operatorTag;          // is_operator_tag: reset to the default tag instead of a rider
+    uint32_t cacheTtlSec;      // cache_ttl or the default; 0 = do not cache
+};
+
+static inline ApiWireUserId apiWireUserId(JsonVariantConst doc, uint32_t defaultTtlSec) {
+    ApiWireUserId result;
+    result.userId = doc["user_id"] | (const char*)nullptr;
+    result.operatorTag = doc["is_operator_tag"] | false;
+    result.cacheTtlSec = doc["cache_ttl"] | defaultTtlSec;
+    return result;
+}
+
+/**
+ * @brief Backpressure fields of upload responses.
+ */
+struct ApiWireBackpressure {
+    uint32_t retryAfterSec;    // retry_after of a 503 (mirrors the Retry-After header), 0 if not sent
+    uint32_t intervalSec;      // upload_interval_seconds suggested by the server, 0 if not sent
+};
+
+static inline ApiWireBackpressure apiWireBackpressure(JsonVariantConst doc) {
+    ApiWireBackpressure result;
+    result.retryAfterSec = doc["retry_after"] | 0u;
+    result.intervalSec = doc["upload_interval_seconds"] | 0u;
+    return result;
+}
+
+/**
+ * @brief Display Velos fields of update-data, heartbeat and sync responses.
+ */
+struct ApiWireDisplayVelos {
+    const char* mode;          // display_mode, "" before round support
+    const char* text;          // Formatted value for the OLED
+    int velos;                 // Numeric value, valid if live
+    bool live;                 // Not a frozen round: extrapolated with local pulses
+    float sessionKm;           // session_km, negative if not sent
+    const char* epoch;         // session_epoch, "" if not sent
+};
+
+/**
+ * @brief Reads display_velos_display (or the older session_velos_display) and its companions.
+ *
+ * Strings point into the document.
+ *
+ * @return false if the response carries no display value
+ */
+static inline bool apiWireDisplayVelos(JsonVariantConst doc, ApiWireDisplayVelos* out) {
+    JsonVariantConst velos;
+    if (doc.containsKey("display_velos_display")) {
+        out->text = doc["display_velos_display"] | "";
+        velos = doc["display_velos"];
+    } else if (doc.containsKey("session_velos_display")) {
+        out->text = doc["session_velos_display"] | "";
+        velos = doc["session_velos"];
+    } else {
+        return false;
+    }
+    out->mode = doc["display_mode"] | "";
+    out->epoch = doc["session_epoch"] | "";
+    out->live = strcmp(out->mode, "round_frozen") != 0 && velos.is<int>();
+    out->velos = out->live ? velos.as<int>() : 0;
+
+    JsonVariantConst sessionKm = doc["session_km"];
+    out->sessionKm = -1.0f;
+    if (sessionKm.is<const char*>()) {
+        out->sessionKm = atof(sessionKm.as<const char*>());  // Decimal string
+    } else if (sessionKm.is<float>()) {
+        out->sessionKm = sessionKm.as<float>();
+    }
+    return true;
+}
+
+#endif // API_WIRE_H
@@ -0,0 +1,107 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    bike_channel.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Counting state of the further bikes of a multi-bike station: each bike
+ * has its own sensor pin (PCNT unit), wheel size and fixed ID tag. The
+ * station_bikes setting lists them as "pin:wheel_mm:id_tag;...". The bike
+ * on SENSOR_PIN stays channel 0 with RFID, display and sleep handling.
+ */
+
+#ifndef BIKE_CHANNEL_H
+#define BIKE_CHANNEL_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bikes per board including channel 0 (one PCNT unit each)
+#ifndef BIKE_CHANNEL_MAX
+#define BIKE_CHANNEL_MAX 4
+#endif
+
+#define BIKE_CHANNEL_ID_TAG_LEN 40
+
+struct BikeChannel {
+    int pin;
+    float wheelSize_mm;
+    char idTag[BIKE_CHANNEL_ID_TAG_LEN];
+    uint32_t pulsesAtLastSend;  // Counter value up to which pulses are uploaded or journaled
+    uint32_t pulsesInFlight;    // Counter value of the batch upload in flight
+    uint32_t lastPulseCount;    // Last counter value seen by loop() (activity detection)
+};
+
+/**
+ * @brief Parses the station_bikes setting into channels 1 .. BIKE_CHANNEL_MAX - 1.
+ *
+ * Entries are separated by ';', fields by ':'. The ID tag is the rest of the
+ * entry. Entries with an invalid pin (0-39), wheel size (500-3000 mm, as
+ * in the portal) or an empty ID tag are skipped, as are entries beyond the
+ * channel limit.
+ *
+ * @param spec Setting value, may be empty
+ * @param channels Receives up to BIKE_CHANNEL_MAX - 1 channels
+ * @return Number of valid channels
+ */
+static inline uint8_t bikeChannelParse(const char* spec, BikeChannel* channels) {
+    uint8_t count = 0;
+    const char* entry = spec;
+    while (entry != nullptr && *entry != '\0' && count < BIKE_CHANNEL_MAX - 1) {
+        const char* end = strchr(entry, ';');
+        const size_t len = end != nullptr ? (size_t)(end - entry) : strlen(entry);
+
+        char buf[64];
+        if (len < sizeof(buf)) {
+            memcpy(buf, entry, len);
+            buf[len] = '\0';
+            char* cursor = buf;
+            while (*cursor == ' ') {
+                cursor++;
+            }
+            char* pinEnd = nullptr;
+            const long pin = strtol(cursor, &pinEnd, 10);
+            char* wheelEnd = nullptr;
+            const float wheel = (pinEnd != cursor && *pinEnd == ':') ? strtof(pinEnd + 1, &wheelEnd) : 0.0f;
+            if (wheelEnd != nullptr && *wheelEnd == ':' && pin >= 0 && pin <= 39 &&
+                wheel >= 500.0f && wheel <= 3000.0f) {
+                const char* tag = wheelEnd + 1;
+                size_t tagLen = strlen(tag);
+                while (tagLen > 0 && tag[tagLen - 1] == ' ') {
+                    tagLen--;
+                }
+                if (tagLen > 0 && tagLen < BIKE_CHANNEL_ID_TAG_LEN) {
+                    BikeChannel* channel = &channels[count++];
+                    memset(channel, 0, sizeof(*channel));
+                    channel->pin = (int)pin;
+                    channel->wheelSize_mm = wheel;
+                    memcpy(channel->idTag, tag, tagLen);
+                    channel->idTag[tagLen] = '\0';
+                }
+            }
+        }
+        entry = end != nullptr ? end + 1 : nullptr;
+    }
+    return count;
+}
+
+/**
+ * @brief Pulses of the next upload: counted since the last upload or journal entry.
+ *
+ * Remembers the counter value, so the result can be confirmed later.
+ */
+static inline uint32_t bikeChannelTakeInterval(BikeChannel* channel, uint32_t pulseCount) {
+    channel->pulsesInFlight = pulseCount;
+    return pulseCount - channel->pulsesAtLastSend;
+}
+
+/**
+ * @brief The interval taken last is uploaded or journaled; later pulses stay pending.
+ */
+static inline void bikeChannelConfirm(BikeChannel* channel) {
+    channel->pulsesAtLastSend = channel->pulsesInFlight;
+}
+
+#endif // BIKE_CHANNEL_H
@@ -0,0 +1,74 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    boot_profile.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Boot phase timer: setup() marks the end of each init stage with a
+ * microsecond timestamp (esp_timer, 0 = application start). The timeline
+ * is printed at the end of setup() and sent once with the first heartbeat
+ * or sync, next to boot_reason.
+ */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdint.h>
+
+#ifndef BOOT_PROFILE_MAX_STAGES
+#define BOOT_PROFILE_MAX_STAGES 16
+#endif
+
+struct BootProfile {
+    const char* names[BOOT_PROFILE_MAX_STAGES];   // String literals, also used as JSON keys
+    uint32_t us[BOOT_PROFILE_MAX_STAGES];         // End of the stage since application start
+    uint8_t count;
+    bool reported;                                // Sent to the server; the timeline is closed
+};
+
+/**
+ * @brief Records the end of a stage.
+ *
+ * @param name Stage name; must stay valid (string literal)
+ * @param us Timestamp in microseconds since application start
+ * @return false if the profile is full or already reported (mark ignored)
+ */
+static inline bool bootProfileMark(BootProfile* profile, const char* name, uint32_t us) {
+    if (profile->reported || profile->count >= BOOT_PROFILE_MAX_STAGES) {
+        return false;
+    }
+    profile->names[profile->count] = name;
+    profile->us[profile->count] = us;
+    profile->count++;
+    return true;
+}
+
+/**
+ * @brief Duration of a stage: time since the previous mark (the first stage
+ * starts with the application).
+ */
+static inline uint32_t bootProfileStageUs(const BootProfile* profile, uint8_t index) {
+    if (index >= profile->count) {
+        return 0;
+    }
+    return index == 0 ? profile->us[0] : profile->us[index] - profile->us[index - 1];
+}
+
+/**
+ * @brief Index of the slowest stage, or -1 if nothing was marked.
+ */
+static inline int bootProfileSlowest(const BootProfile* profile) {
+    int slowest = -1;
+    uint32_t slowestUs = 0;
+    for (uint8_t i = 0; i < profile->count; i++) {
+        const uint32_t stageUs = bootProfileStageUs(profile, i);
+        if (slowest < 0 || stageUs > slowestUs) {
+            slowest = i;
+            slowestUs = stageUs;
+        }
+    }
+    return slowest;
+}
+
+#endif // BOOT_PROFILE_H
@@ -7,8 +7,16 @@
  */
 
 #include "configserver.h"
+#include "mcc_log.h"
 #include <WiFi.h>
 #include <Update.h>
+#include "fast_resume.h"
+#include "device_config.h"
+#include "gateway_link.h"
+#include "bike_channel.h"
+#include "portal_assets.h"
+#include "metrics.h"
+#include "wifi_manager.h"
 
 #ifdef ENABLE_OLED
 extern void display_FirmwareUpdate();
@@ -25,36 +33,27 @@ const char* DEFAULT_AP_PASSWORD = "mccmuims";
  * @return String AP password (minimum 8 characters, default if not set)
  */
 String getAPPassword() {
-    // NVS key max length is 15 characters, so use shorter key
-    String password = preferences.getString("ap_passwd", "");
+    const String& password = deviceConfig.apPassword;
     if (password.length() == 0 || password.length() < 8) {
         // Use default if not set or invalid (minimum 8 chars for WPA2)
-        if (debugEnabled) {
-            Serial.printf("DEBUG: Using default AP password: %s\n", DEFAULT_AP_PASSWORD);
-        }
+        MCC_LOGD("Using default AP password: %.3s***\n", DEFAULT_AP_PASSWORD);
         return String(DEFAULT_AP_PASSWORD);
     }
-    if (debugEnabled) {
-        Serial.printf("DEBUG: AP password loaded from NVS: %s\n", password.c_str());
-    }
+    MCC_LOGD("AP password loaded from NVS: %.3s***\n", password.c_str());
     return password;
 }
 
-// HTML configuration form
-const char* HTML_FORM = R"rawliteral(
+// HTML configuration form; %NAME% placeholders are filled in by writePortalField().
+// Styles and script are served separately (gzip, see portal_assets.h) and cached by the browser.
+static const char HTML_FORM[] PROGMEM = R"rawliteral(
 <!DOCTYPE html>
 <html>
 <head>
 <title>ESP32 Bike Tacho Konfiguration</title>
 <meta name="viewport" content="width=device-width, initial-scale=1">
-<meta charset="UTF-8"> <style>
-  body{font-family:Arial,sans-serif;margin:auto;max-width:600px;padding:20px;}
-  .container{background:#f4f4f4;padding:20px;border-radius:10px;box-sizing:border-box;}
-  h2{text-align:center;}
-  label{font-weight:bold;}
-  input[type="text"], input[type="number"], input[type="file"], select{width:100%;padding:10px;margin:8px 0;border:1px solid #ccc;border-radius:5px;box-sizing:border-box;}
-  input[type="submit"], button{width:100%;padding:10px;background:#007bff;color:white;border:none;border-radius:5px;cursor:pointer;box-sizing:border-box;}
-</style>
+<meta charset="UTF-8">
+<link rel="stylesheet" href="/style.css">
+<script src="/portal.js"></script>
 </head>
 <body>
 <div class="container">
@@ -64,6 +63,26 @@ const char* HTML_FORM = R"rawliteral(
   <input type="text" id="wifi_ssid" name="wifi_ssid" value="%WIFI_SSID%">
   <label for="wifi_password">WLAN-Passwort:</label>
   <input type="text" id="wifi_password" name="wifi_password" value="%WIFI_PASSWORD%">
+  <label for="wifi_ssid2">Ausweich-WLAN-SSID (optional):</label>
+  <input type="text" id="wifi_ssid2" name="wifi_ssid2" value="%WIFI_SSID2%">
+  <label for="wifi_password2">Ausweich-WLAN-Passwort:</label>
+  <input type="text" id="wifi_password2" name="wifi_password2" value="%WIFI_PASSWORD2%">
+  <label for="static_ip">Statische IP (optional):</label>
+  <input type="text" id="static_ip" name="static_ip" value="%STATIC_IP%" placeholder="IP,Gateway,Maske[,DNS]">
+  <small>(leer = DHCP)</small>
+  <label for="node_role">Verbindung zum Server:</label>
+  <select id="node_role" name="node_role">
+    <option value="0" %ROLE_0%>Eigenes WLAN</option>
+    <option value="1" %ROLE_1%>Über Gateway (ESP-NOW)</option>
+    <option value="2" %ROLE_2%>Gateway für andere Fahrräder</option>
+  </select>
+  <small>Fahrräder über Gateway brauchen kein WLAN, nur Server-URL und API Key. Änderung erfordert Neustart.</small>
+  <label for="gateway_secret">Gateway-Schlüssel:</label>
+  <input type="text" id="gateway_secret" name="gateway_secret" value="%GATEWAY_SECRET%" minlength="8">
+  <small>(gleich auf Gateway und Fahrrädern, mindestens 8 Zeichen; verschlüsselt die ESP-NOW-Verbindung)</small>
+  <label for="mqtt_url">MQTT-Broker (optional):</label>
+  <input type="text" id="mqtt_url" name="mqtt_url" value="%MQTT_URL%" placeholder="mqtts://broker:8883">
+  <small>(leer = nur HTTP; Anmeldung mit Geräte-ID und API Key)</small>
   <hr>
   <label for="deviceName">Gerätename:</label>
   <input type="text" id="deviceName" name="deviceName" value="%DEVICENAME%" required>
@@ -76,60 +95,21 @@ const char* HTML_FORM = R"rawliteral(
   <label for="wheel_size_preset">Radgröße (Standard):</label>
   <select id="wheel_size_preset" onchange="updateWheelSizeFromPreset()">
     <option value="">-- Manuelle Eingabe --</option>
-    <option value="1590" %PRESET_20_SELECTED%>20 Zoll (1590 mm)</option>
-    <option value="1910" %PRESET_24_SELECTED%>24 Zoll (1910 mm)</option>
-    <option value="2075" %PRESET_26_SELECTED%>26 Zoll (2075 mm)</option>
-    <option value="2224" %PRESET_28_SELECTED%>28 Zoll (2224 mm)</option>
-    <option value="2300" %PRESET_29_SELECTED%>29 Zoll (2300 mm)</option>
+    <option value="1590" %PRESET_1590%>20 Zoll (1590 mm)</option>
+    <option value="1910" %PRESET_1910%>24 Zoll (1910 mm)</option>
+    <option value="2075" %PRESET_2075%>26 Zoll (2075 mm)</option>
+    <option value="2224" %PRESET_2224%>28 Zoll (2224 mm)</option>
+    <option value="2300" %PRESET_2300%>29 Zoll (2300 mm)</option>
   </select>
   <br><br>
   <label for="wheel_size">Radumfang (mm):</label>
   <input type="number" id="wheel_size" name="wheel_size" step="1" min="500" max="3000" value="%WHEELSIZE%" required oninput="updatePresetFromManual()">
   <small>Radumfang in Millimeter (500-3000 mm). Wählen Sie eine Standard-Radgröße oder geben Sie einen manuellen Wert ein.</small>
   <br><br>
-  
-  <script>
-  function updateWheelSizeFromPreset() {
-    var preset = document.getElementById('wheel_size_preset');
-    var manual = document.getElementById('wheel_size');
-    if (preset.value) {
-      manual.value = preset.value;
-    }
-  }
-  
-  function updatePresetFromManual() {
-    var preset = document.getElementById('wheel_size_preset');
-    var manual = document.getElementById('wheel_size');
-    var manualValue = parseInt(manual.value);
-    
-    // Check if manual value matches a preset (with 5mm tolerance)
-    var presets = [
-      {value: '1590', mm: 1590},
-      {value: '1910', mm: 1910},
-      {value: '2075', mm: 2075},
-      {value: '2224', mm: 2224},
-      {value: '2300', mm: 2300}
-    ];
-    
-    var matched = false;
-    for (var i = 0; i < presets.length; i++) {
-      if (Math.abs(manualValue - presets[i].mm) <= 5) {
-        preset.value = presets[i].value;
-        matched = true;
-        break;
-      }
-    }
-    
-    if (!matched) {
-      preset.value = '';
-    }
-  }
-  
-  // Initialize preset selection on page load
-  window.onload = function() {
-    updatePresetFromManual();
-  };
-  </script>
+  <label for="station_bikes">Weitere Fahrräder an diesem Gerät (optional):</label>
+  <input type="text" id="station_bikes" name="station_bikes" value="%STATION_BIKES%" placeholder="Pin:Radumfang:ID-Tag;...">
+  <small>Bis zu 3 weitere Sensoren mit festem ID-Tag, z.&nbsp;B. 25:2075:rolle-2;26:2224:rolle-3. Änderung erfordert Neustart.</small>
+  <br><br>
 
   <label for="serverUrl">Webserver-URL:</label>
   <input type="text" id="serverUrl" name="serverUrl" value="%SERVERURL%">
@@ -152,6 +132,11 @@ const char* HTML_FORM = R"rawliteral(
   <br>
   <label for="debugEnabled">Debug-Modus</label>
   <input type="checkbox" id="debugEnabled" name="debugEnabled" value="1" %DEBUG_ENABLED%>
+
+  <br>
+  <label for="fastBoot">Schnellstart</label>
+  <input type="checkbox" id="fastBoot" name="fastBoot" value="1" %FASTBOOTCHECKED%>
+  <small>Zählt sofort nach dem Einschalten; Startbildschirm, Töne und Serververbindung folgen im Hintergrund.</small>
   
   <br><br>
   <label for="deepSleepTimeout">Deep-Sleep-Zeit:</label>
@@ -177,88 +162,239 @@ const char* HTML_FORM = R"rawliteral(
 </html>
 )rawliteral";
 
+// Only shown if enabled by the server (server parameter "test_mode_admin_enabled")
+static const char HTML_TESTMODE_SECTION[] PROGMEM = R"rawliteral(<hr>
+  <h2>Testmodus</h2>
+  <label for="testModeEnabled">Testmodus</label>
+  <input type="checkbox" id="testModeEnabled" name="testModeEnabled" value="1" %TESTMODECHECKED%>
+  <br><br>
+  <label for="testDistance">Simulierte Distanz (km):</label>
+  <input type="number" id="testDistance" name="testDistance" step="0.01" value="%TESTDISTANCE%" required>
+  <label for="testInterval">Sendeintervall (Sekunden):</label>
+  <input type="number" id="testInterval" name="testInterval" value="%TESTINTERVAL%" required>
+)rawliteral";
 
+// Output buffer of the streamed page: one chunk per sendContent()
+#define PORTAL_CHUNK_SIZE 512
 
+/**
+ * @brief Print sink that sends the page in chunks of PORTAL_CHUNK_SIZE bytes.
+ *
+ * The page is never held as a whole, so rendering needs the same memory
+ * regardless of heap fragmentation or uptime.
+ */
+class PortalWriter : public Print {
+public:
+    explicit PortalWriter(WebServer& target = server) : target(target) {}
+
+    size_t write(uint8_t c) override {
+        buffer[used++] = (char)c;
+        if (used == sizeof(buffer)) {
+            sendBuffered();
+        }
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t size) override {
+        for (size_t i = 0; i < size; i++) {
+            write(data[i]);
+        }
+        return size;
+    }
+
+    void sendBuffered() {
+        if (used > 0) {
+            target.sendContent(buffer, used);
+            used = 0;
+        }
+    }
+
+private:
+    WebServer& target;
+    char buffer[PORTAL_CHUNK_SIZE];
+    size_t used = 0;
+};
+
+/**
+ * @brief Writes a value for an HTML attribute, escaping characters that would end it.
+ */
+static void writeEscaped(Print& out, const char* text) {
+    for (const char* c = text; *c != '\0'; c++) {
+        switch (*c) {
+            case '&':  out.print("&amp;"); break;
+            case '"':  out.print("&quot;"); break;
+            case '<':  out.print("&lt;"); break;
+            case '>':  out.print("&gt;"); break;
+            default:   out.write((uint8_t)*c); break;
+        }
+    }
+}
+
+static void renderTemplate(PortalWriter& out, const char* tpl);
+
+/**
+ * @brief Writes the value of one template placeholder, read from deviceConfig.
+ */
+static void writePortalField(PortalWriter& out, const char* name) {
+    // Wheel presets: "selected" if the circumference is within 5 mm
+    if (strncmp(name, "PRESET_", 7) == 0) {
+        int currentSizeInt = (int)(deviceConfig.wheelSize + 0.5); // Round to nearest integer
+        if (abs(currentSizeInt - atoi(name + 7)) <= 5) {
+            out.print("selected");
+        }
+    } else if (strncmp(name, "ROLE_", 5) == 0) {
+        if (deviceConfig.nodeRole == atoi(name + 5)) {
+            out.print("selected");
+        }
+    } else if (strcmp(name, "WIFI_SSID") == 0) {
+        writeEscaped(out, deviceConfig.wifiSsid.c_str());
+    } else if (strcmp(name, "WIFI_PASSWORD") == 0) {
+        writeEscaped(out, deviceConfig.wifiPassword.c_str());
+    } else if (strcmp(name, "WIFI_SSID2") == 0) {
+        writeEscaped(out, deviceConfig.wifiSsid2.c_str());
+    } else if (strcmp(name, "WIFI_PASSWORD2") == 0) {
+        writeEscaped(out, deviceConfig.wifiPassword2.c_str());
+    } else if (strcmp(name, "GATEWAY_SECRET") == 0) {
+        writeEscaped(out, deviceConfig.gatewaySecret.c_str());
+    } else if (strcmp(name, "MQTT_URL") == 0) {
+        writeEscaped(out, deviceConfig.mqttUrl.c_str());
+    } else if (strcmp(name, "STATION_BIKES") == 0) {
+        writeEscaped(out, deviceConfig.stationBikes.c_str());
+    } else if (strcmp(name, "STATIC_IP") == 0) {
+        writeEscaped(out, deviceConfig.staticIp.c_str());
+    } else if (strcmp(name, "AP_PASSWORD") == 0) {
+        writeEscaped(out, getAPPassword().c_str());
+    } else if (strcmp(name, "DEVICENAME") == 0) {
+        writeEscaped(out, deviceConfig.deviceName.c_str());
+    } else if (strcmp(name, "FULL_DEVICENAME") == 0) {
+        writeEscaped(out, deviceConfig.deviceName.c_str());
+        out.print('_');
+        writeEscaped(out, deviceIdSuffix.c_str());
+    } else if (strcmp(name, "IDTAG") == 0) {
+        writeEscaped(out, deviceConfig.defaultIdTag.c_str());
+    } else if (strcmp(name, "WHEELSIZE") == 0) {
+        // Display current wheel size in mm
+        out.print(deviceConfig.wheelSize, 1);
+    } else if (strcmp(name, "LEDCHECKED") == 0) {
+        out.print(deviceConfig.led ? "checked" : "");
+    } else if (strcmp(name, "DEBUG_ENABLED") == 0) {
+        out.print(deviceConfig.debug ? "checked" : "");
+    } else if (strcmp(name, "FASTBOOTCHECKED") == 0) {
+        out.print(deviceConfig.fastBoot ? "checked" : "");
+    } else if (strcmp(name, "TESTMODE_SECTION") == 0) {
+        if (deviceConfig.testAdmin) {
+            renderTemplate(out, HTML_TESTMODE_SECTION);
+        }
+    } else if (strcmp(name, "TESTMODECHECKED") == 0) {
+        out.print(deviceConfig.testMode ? "checked" : "");
+    } else if (strcmp(name, "TESTDISTANCE") == 0) {
+        out.print(deviceConfig.testDistance);
+    } else if (strcmp(name, "TESTINTERVAL") == 0) {
+        out.print(deviceConfig.testInterval);
+    } else if (strcmp(name, "SERVERURL") == 0) {
+        writeEscaped(out, deviceConfig.serverUrl.c_str());
+    } else if (strcmp(name, "APIKEY") == 0) {
+        writeEscaped(out, deviceConfig.apiKey.c_str());
+    } else if (strcmp(name, "SENDINTERVAL") == 0) {
+        out.print(deviceConfig.sendInterval);
+    } else if (strcmp(name, "DEEPSLEEPTIMEOUT") == 0) {
+        out.print(deviceConfig.deepSleep);
+    }
+}
+
+/**
+ * @brief Copies the template to out, replacing each %NAME% (A-Z, 0-9, _) in a single pass.
+ *
+ * A '%' that does not start a placeholder (e.g. in "100%") is copied unchanged.
+ */
+static void renderTemplate(PortalWriter& out, const char* tpl) {
+    const char* p = tpl;
+    while (*p != '\0') {
+        const char* start = strchr(p, '%');
+        if (start == nullptr) {
+            out.write((const uint8_t*)p, strlen(p));
+            return;
+        }
+        out.write((const uint8_t*)p, start - p);
+
+        char name[24];
+        size_t len = 0;
+        const char* c = start + 1;
+        while ((isupper((unsigned char)*c) || isdigit((unsigned char)*c) || *c == '_') && len < sizeof(name) - 1) {
+            name[len++] = *c++;
+        }
+        if (len > 0 && *c == '%') {
+            name[len] = '\0';
+            writePortalField(out, name);
+            p = c + 1;
+        } else {
+            out.write('%');
+            p = start + 1;
+        }
+    }
+}
 
 // --- Web server functions ---
 /**
  * @brief Handles HTTP GET request to root path ("/").
  * 
- * Serves the HTML configuration form with current values from NVS storage.
- * Replaces placeholders in HTML template with actual configuration values.
+ * Serves the HTML configuration form with current values from deviceConfig.
+ * The template is rendered in one pass and sent with chunked transfer
+ * encoding, PORTAL_CHUNK_SIZE bytes at a time.
  * 
  * @note Pure logic function - web server response only
  * @note Side effects: Sends HTML response via WebServer, writes to Serial
  */
 void handleRoot() {
-  String html = HTML_FORM;
-  html.replace("%WIFI_SSID%", preferences.getString("wifi_ssid", wifi_ssid));
-  html.replace("%WIFI_PASSWORD%", preferences.getString("wifi_password", wifi_password));
-  html.replace("%AP_PASSWORD%", getAPPassword());
-  
-  // Load device name and create full name with suffix
-  String currentDeviceName = preferences.getString("deviceName", deviceName);
-  html.replace("%DEVICENAME%", currentDeviceName);
-  html.replace("%FULL_DEVICENAME%", currentDeviceName + "_" + deviceIdSuffix);
-  
-  html.replace("%IDTAG%", preferences.getString("idTag", idTag));
-  
-  float currentWheelSize = preferences.getFloat("wheel_size", wheel_size);
-  Serial.print("Loaded wheel circumference for display: ");
-  Serial.println(currentWheelSize, 1);
-  
-  // Display current wheel size in mm
-  html.replace("%WHEELSIZE%", String(currentWheelSize, 1));
-  
-  // Determine which preset is selected (with 5mm tolerance)
-  int currentSizeInt = (int)(currentWheelSize + 0.5); // Round to nearest integer
-  String preset20Selected = "";
-  String preset24Selected = "";
-  String preset26Selected = "";
-  String preset28Selected = "";
-  String preset29Selected = "";
-  
-  if (abs(currentSizeInt - 1590) <= 5) {
-    preset20Selected = "selected";
-  } else if (abs(currentSizeInt - 1910) <= 5) {
-    preset24Selected = "selected";
-  } else if (abs(currentSizeInt - 2075) <= 5) {
-    preset26Selected = "selected";
-  } else if (abs(currentSizeInt - 2224) <= 5) {
-    preset28Selected = "selected";
-  } else if (abs(currentSizeInt - 2300) <= 5) {
-    preset29Selected = "selected";
-  }
-  
-  // Replace preset selection placeholders in HTML
-  html.replace("%PRESET_20_SELECTED%", preset20Selected);
-  html.replace("%PRESET_24_SELECTED%", preset24Selected);
-  html.replace("%PRESET_26_SELECTED%", preset26Selected);
-  html.replace("%PRESET_28_SELECTED%", preset28Selected);
-  html.replace("%PRESET_29_SELECTED%", preset29Selected);
-  
-  html.replace("%LEDCHECKED%", preferences.getBool("ledEnabled", true) ? "checked" : "");
-  html.replace("%DEBUG_ENABLED%", preferences.getBool("debugEnabled", false) ? "checked" : "");
-
-  // Testmodus nur anzeigen, wenn vom Server aktiviert (NVS-Parameter "test_mode_admin_enabled")
-  String testModeSection = "";
-  if (preferences.getBool("test_mode_admin_enabled", false)) {
-    testModeSection = "<hr>\n  <h2>Testmodus</h2>\n  <label for=\"testModeEnabled\">Testmodus</label>\n  <input type=\"checkbox\" id=\"testModeEnabled\" name=\"testModeEnabled\" value=\"1\" %TESTMODECHECKED%>\n  <br><br>\n  <label for=\"testDistance\">Simulierte Distanz (km):</label>\n  <input type=\"number\" id=\"testDistance\" name=\"testDistance\" step=\"0.01\" value=\"%TESTDISTANCE%\" required>\n  <label for=\"testInterval\">Sendeintervall (Sekunden):</label>\n  <input type=\"number\" id=\"testInterval\" name=\"testInterval\" value=\"%TESTINTERVAL%\" required>\n";
-    testModeSection.replace("%TESTDISTANCE%", String(preferences.getFloat("testDistance", testDistance)));
-    testModeSection.replace("%TESTINTERVAL%", String(preferences.getUInt("testInterval", testInterval_sec)));
-    testModeSection.replace("%TESTMODECHECKED%", preferences.getBool("testModeEnabled", false) ? "checked" : "");
-  }
-  html.replace("%TESTMODE_SECTION%", testModeSection);
-  
-  html.replace("%SERVERURL%", preferences.getString("serverUrl", serverUrl));
-  html.replace("%APIKEY%", preferences.getString("apiKey", apiKey));
-  html.replace("%SENDINTERVAL%", String(preferences.getUInt("sendInterval", sendInterval_sec)));
-  
-  // Load deep sleep timeout from NVS
-  unsigned long currentDeepSleep = preferences.getUInt("deep_sleep", 300);
-  html.replace("%DEEPSLEEPTIMEOUT%", String(currentDeepSleep));
-  
-  server.send(200, "text/html", html);
+  logSerial.print("Loaded wheel circumference for display: ");
+  logSerial.println(deviceConfig.wheelSize, 1);
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/html", "");
+  PortalWriter out;
+  renderTemplate(out, HTML_FORM);
+  out.sendBuffered();
+  server.sendContent("");  // Terminating chunk
+}
+
+/**
+ * @brief Answers a GET request to "/metrics": runtime metrics as JSON (see metrics.h).
+ *
+ * Streamed in chunks like the portal page, so the response needs no
+ * buffer for the whole document.
+ */
+static void sendMetrics(WebServer& web) {
+  web.sendHeader("Cache-Control", "no-store");
+  web.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  web.send(200, "application/json", "");
+  PortalWriter out(web);
+  metricsWriteJson(out);
+  out.sendBuffered();
+  web.sendContent("");  // Terminating chunk
+}
+
+/**
+ * @brief Answers a GET request to "/log": the latest log lines as plain text.
+ *
+ * The last MCC_LOG_BUFFER_SIZE bytes; debug lines only while debug mode is on.
+ */
+static void sendLog(WebServer& web) {
+  web.sendHeader("Cache-Control", "no-store");
+  web.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  web.send(200, "text/plain; charset=utf-8", "");
+  PortalWriter out(web);
+  mccLogDump(out);
+  out.sendBuffered();
+  web.sendContent("");  // Terminating chunk
+}
+
+/**
+ * @brief Serves a gzip compressed static file from flash.
+ */
+static void sendGzipAsset(const char* contentType, const uint8_t* data, size_t len) {
+  server.sendHeader("Content-Encoding", "gzip");
+  server.sendHeader("Cache-Control", "max-age=86400");
+  server.send_P(200, contentType, (const char*)data, len);
 }
 
 /**
@@ -273,23 +409,77 @@ void handleRoot() {
  */
 void handleSave() {
   if (server.hasArg("wifi_ssid")) {
-    preferences.putString("wifi_ssid", server.arg("wifi_ssid"));
+    configSetString(CFG_WIFI_SSID, server.arg("wifi_ssid"));
     wifi_ssid = server.arg("wifi_ssid");
   }
   if (server.hasArg("wifi_password")) {
-    preferences.putString("wifi_password", server.arg("wifi_password"));
+    configSetString(CFG_WIFI_PASSWORD, server.arg("wifi_password"));
     wifi_password = server.arg("wifi_password");
   }
+  if (server.hasArg("wifi_ssid2")) {
+    String newSsid2 = server.arg("wifi_ssid2");
+    newSsid2.trim();
+    configSetString(CFG_WIFI_SSID2, newSsid2);
+    wifi_ssid2 = newSsid2;
+  }
+  if (server.hasArg("wifi_password2")) {
+    configSetString(CFG_WIFI_PASSWORD2, server.arg("wifi_password2"));
+    wifi_password2 = server.arg("wifi_password2");
+  }
+  if (server.hasArg("node_role")) {
+    long role = server.arg("node_role").toInt();
+    if (role >= GATEWAY_ROLE_STANDALONE && role <= GATEWAY_ROLE_GATEWAY) {
+      configSetUChar(CFG_NODE_ROLE, (uint8_t)role);
+      logSerial.printf("Node role: %s (restart required)\n", gatewayRoleToString((GatewayRole)role));
+    }
+  }
+  if (server.hasArg("gateway_secret")) {
+    String newSecret = server.arg("gateway_secret");
+    newSecret.trim();
+    if (newSecret.length() == 0 || newSecret.length() >= GATEWAY_SECRET_MIN_LEN) {
+      configSetString(CFG_GATEWAY_SECRET, newSecret);
+      gatewaySecret = newSecret;
+    } else {
+      MCC_LOGW("Gateway secret needs at least %d characters, keeping current setting\n", GATEWAY_SECRET_MIN_LEN);
+    }
+  }
+  if (server.hasArg("mqtt_url")) {
+    String newMqttUrl = server.arg("mqtt_url");
+    newMqttUrl.trim();
+    if (newMqttUrl.length() == 0 || newMqttUrl.startsWith("mqtt://") || newMqttUrl.startsWith("mqtts://")) {
+      configSetString(CFG_MQTT_URL, newMqttUrl);
+      mqttUrl = newMqttUrl;
+    } else {
+      MCC_LOGW("MQTT broker URL must start with mqtt:// or mqtts://, keeping current setting");
+    }
+  }
+  if (server.hasArg("station_bikes")) {
+    String newStationBikes = server.arg("station_bikes");
+    newStationBikes.trim();
+    BikeChannel parsed[BIKE_CHANNEL_MAX - 1];
+    configSetString(CFG_STATION_BIKES, newStationBikes);
+    logSerial.printf("Station bikes: %u valid (restart required)\n",
+                  (unsigned)bikeChannelParse(newStationBikes.c_str(), parsed));
+  }
+  if (server.hasArg("static_ip")) {
+    String newStaticIp = server.arg("static_ip");
+    newStaticIp.trim();
+    IPAddress ip, gateway, subnet, dns;
+    // A malformed entry keeps the previous setting
+    if (newStaticIp.length() == 0 || staticIpParse(newStaticIp, &ip, &gateway, &subnet, &dns)) {
+      configSetString(CFG_STATIC_IP, newStaticIp);
+      staticIp = newStaticIp;
+    }
+  }
   if (server.hasArg("deviceName")) {
-    preferences.putString("deviceName", server.arg("deviceName"));
+    configSetString(CFG_DEVICE_NAME, server.arg("deviceName"));
     deviceName = server.arg("deviceName");
   }
   if (server.hasArg("idTag")) {
     // Save as default_id_tag (not idTag) to distinguish from temporary RFID tag
     String newDefaultTag = server.arg("idTag");
-    preferences.putString("default_id_tag", newDefaultTag);
-    // Also update legacy "idTag" key for backward compatibility
-    preferences.putString("idTag", newDefaultTag);
+    // The commit also updates the legacy "idTag" key for backward compatibility
+    configSetString(CFG_DEFAULT_ID_TAG, newDefaultTag);
     idTag = newDefaultTag; // Update global variable
   }
   
@@ -298,13 +488,11 @@ void handleSave() {
       float newSizeMm = server.arg("wheel_size").toFloat();
       // Validate range: 500-3000 mm
       if (newSizeMm >= 500.0 && newSizeMm <= 3000.0) {
-          preferences.putFloat("wheel_size", newSizeMm);
+          configSetFloat(CFG_WHEEL_SIZE, newSizeMm);
           wheel_size = newSizeMm;
-          if (debugEnabled) {
-              Serial.printf("DEBUG: Wheel size updated to: %.1f mm\n", newSizeMm);
-          }
+          MCC_LOGD("Wheel size updated to: %.1f mm\n", newSizeMm);
       } else {
-          Serial.printf("WARNING: Wheel size out of valid range (%.1f mm, expected 500-3000 mm), keeping current value\n", newSizeMm);
+          MCC_LOGW("Wheel size out of valid range (%.1f mm, expected 500-3000 mm), keeping current value\n", newSizeMm);
       }
   }
 
@@ -314,7 +502,7 @@ void handleSave() {
 
     // If URL is empty, clear it from NVS (will use default from build flag)
     if (url.length() == 0) {
-        preferences.remove("serverUrl");
+        configSetString(CFG_SERVER_URL, "");
         serverUrl = "";
         // Default will be applied in getPreferences() if DEFAULT_SERVER_URL is defined
     } else {
@@ -329,10 +517,10 @@ void handleSave() {
         }
         // Only save if URL is valid (not empty and has content after processing)
         if (url.length() > 0) {
-            preferences.putString("serverUrl", url);
+            configSetString(CFG_SERVER_URL, url);
             serverUrl = url;
         } else {
-            preferences.remove("serverUrl");
+            configSetString(CFG_SERVER_URL, "");
             serverUrl = "";
         }
     }
@@ -344,11 +532,11 @@ void handleSave() {
     
     // If key is empty, clear it from NVS (will use default from build flag)
     if (key.length() == 0) {
-        preferences.remove("apiKey");
+        configSetString(CFG_API_KEY, "");
         apiKey = "";
         // Default will be applied in getPreferences() if DEFAULT_API_KEY is defined
     } else {
-        preferences.putString("apiKey", key);
+        configSetString(CFG_API_KEY, key);
         apiKey = key;
     }
   }
@@ -359,74 +547,78 @@ void handleSave() {
     
     // Validate: minimum 8 characters (WPA2 requirement), empty not allowed
     if (newAPPassword.length() >= 8) {
-        preferences.putString("ap_passwd", newAPPassword);
-        Serial.println("Config AP password updated (restart required)");
-        if (debugEnabled) {
-            Serial.printf("DEBUG: New AP password saved: %s\n", newAPPassword.c_str());
-        }
+        configSetString(CFG_AP_PASSWORD, newAPPassword);
+        logSerial.println("Config AP password updated (restart required)");
+        MCC_LOGD("New AP password saved: %.3s***\n", newAPPassword.c_str());
     } else if (newAPPassword.length() > 0) {
-        Serial.println("WARNING: AP password too short (min 8 chars), keeping current password");
-        if (debugEnabled) {
-            Serial.printf("DEBUG: Rejected AP password (too short): %s\n", newAPPassword.c_str());
-        }
+        MCC_LOGW("AP password too short (min 8 chars), keeping current password");
+        MCC_LOGD("Rejected AP password (too short): %.3s***\n", newAPPassword.c_str());
     }
     // If empty, do nothing (empty password not allowed)
   }
   if (server.hasArg("sendInterval")) {
-    preferences.putUInt("sendInterval", server.arg("sendInterval").toInt());
+    configSetUInt(CFG_SEND_INTERVAL, server.arg("sendInterval").toInt());
     sendInterval_sec = server.arg("sendInterval").toInt();
   }
   
   if (server.hasArg("deepSleepTimeout")) {
     unsigned long newDeepSleep = server.arg("deepSleepTimeout").toInt();
-    // NVS key max length is 15 characters, so use shorter key
-    preferences.putUInt("deep_sleep", newDeepSleep);
+    configSetUInt(CFG_DEEP_SLEEP, newDeepSleep);
     deepSleepTimeout_sec = newDeepSleep;
     // If deepSleepTimeout_sec is 0, disable deep sleep immediately
     if (newDeepSleep == 0) {
         DeepSleep = false;
-        Serial.println("Deep-Sleep deaktiviert (Zeit = 0)");
+        logSerial.println("Deep-Sleep deaktiviert (Zeit = 0)");
     } else {
         DeepSleep = true;
-        Serial.printf("Deep-Sleep-Zeit aktualisiert: %lu Sekunden\n", newDeepSleep);
+        logSerial.printf("Deep-Sleep-Zeit aktualisiert: %lu Sekunden\n", newDeepSleep);
     }
   }
   
   ledEnabled = server.hasArg("ledEnabled");
-  preferences.putBool("ledEnabled", ledEnabled);
+  configSetBool(CFG_LED, ledEnabled);
 
   debugEnabled = server.hasArg("debugEnabled");
-  preferences.putBool("debugEnabled", debugEnabled);
+  configSetBool(CFG_DEBUG, debugEnabled);
+
+  // Takes effect with the next start
+  configSetBool(CFG_FAST_BOOT, server.hasArg("fastBoot"));
 
   testModeActive = server.hasArg("testModeEnabled");
-  preferences.putBool("testModeEnabled", testModeActive);
+  configSetBool(CFG_TEST_MODE, testModeActive);
 
   // Always save test data, regardless of test mode status
   if (server.hasArg("testDistance") && server.arg("testDistance").length() > 0) {
-      preferences.putFloat("testDistance", server.arg("testDistance").toFloat());
+      configSetFloat(CFG_TEST_DISTANCE, server.arg("testDistance").toFloat());
   }
   if (server.hasArg("testInterval") && server.arg("testInterval").length() > 0) {
-      preferences.putUInt("testInterval", server.arg("testInterval").toInt());
+      configSetUInt(CFG_TEST_INTERVAL, server.arg("testInterval").toInt());
+  }
+
+  // Only the fields that really changed are written, with a single NVS commit
+  if (!configCommit()) {
+    MCC_LOGE("handleSave() - Failed to save configuration to NVS");
   }
 
 
   // NEW: Debug output of saved data
   if (debugEnabled) {
-    Serial.println("\n--- NVS configuration saved ---");
-    Serial.printf("WiFi SSID: %s\n", wifi_ssid.c_str());
-    Serial.printf("WiFi password: %s\n", wifi_password.c_str());
-    Serial.printf("Device name: %s\n", deviceName.c_str());
-    Serial.printf("ID Tag: %s\n", idTag.c_str());
-    Serial.printf("Wheel circumference: %.2f cm\n", wheel_size);
-    Serial.printf("Server URL: %s\n", serverUrl.c_str());
-    Serial.printf("API Key: %s\n", apiKey.c_str());
-    Serial.printf("Send interval: %d s\n", sendInterval_sec);
-    Serial.printf("LED enabled: %s\n", ledEnabled ? "Yes" : "No");
-    Serial.printf("Debug mode: %s\n", debugEnabled ? "Yes" : "No");
-    Serial.printf("Test mode: %s\n", testModeActive ? "Yes" : "No");
-    Serial.printf("  Test distance: %.2f km\n", preferences.getFloat("testDistance", 0.0));
-    Serial.printf("  Test interval: %u s\n", preferences.getUInt("testInterval", 0));
-    Serial.println("-------------------------------------\n");
+    logSerial.println("\n--- NVS configuration saved ---");
+    logSerial.printf("WiFi SSID: %s\n", wifi_ssid.c_str());
+    logSerial.printf("WiFi password: %.3s***\n", wifi_password.c_str());
+    logSerial.printf("Device name: %s\n", deviceName.c_str());
+    logSerial.printf("ID Tag: %s\n", idTag.c_str());
+    logSerial.printf("Wheel circumference: %.2f cm\n", wheel_size);
+    logSerial.printf("Server URL: %s\n", serverUrl.c_str());
+    logSerial.printf("API Key: %.3s***\n", apiKey.c_str());
+    logSerial.printf("Send interval: %d s\n", sendInterval_sec);
+    logSerial.printf("LED enabled: %s\n", ledEnabled ? "Yes" : "No");
+    logSerial.printf("Debug mode: %s\n", debugEnabled ? "Yes" : "No");
+    logSerial.printf("Fast boot: %s\n", deviceConfig.fastBoot ? "Yes" : "No");
+    logSerial.printf("Test mode: %s\n", testModeActive ? "Yes" : "No");
+    logSerial.printf("  Test distance: %.2f km\n", deviceConfig.testDistance);
+    logSerial.printf("  Test interval: %u s\n", (unsigned)deviceConfig.testInterval);
+    logSerial.println("-------------------------------------\n");
   }
 
 
@@ -446,6 +638,7 @@ void handleSave() {
 void handleReboot() {
   server.send(200, "text/plain", "Das Gerät wird neu gestartet...");
   delay(100);
+  mccLogFlush();
   ESP.restart();
 }
 
@@ -463,7 +656,7 @@ void handleUpdate() {
   HTTPUpload& upload = server.upload();
   
   if (upload.status == UPLOAD_FILE_START) {
-    Serial.printf("Update start: %s\n", upload.filename.c_str());
+    logSerial.printf("Update start: %s\n", upload.filename.c_str());
     #ifdef ENABLE_OLED
     display_FirmwareUpdate();
     #endif
@@ -480,17 +673,17 @@ void handleUpdate() {
     }
     // Progress feedback
     if (upload.totalSize > 0) {
-      Serial.printf("Progress: %d%%\n", (upload.currentSize * 100) / upload.totalSize);
+      logSerial.printf("Progress: %d%%\n", (upload.currentSize * 100) / upload.totalSize);
     }
   } else if (upload.status == UPLOAD_FILE_END) {
     if (Update.end(true)) {
-      Serial.printf("Update successful: %u bytes\n", upload.totalSize);
+      logSerial.printf("Update successful: %u bytes\n", upload.totalSize);
       
       // Firmware version is now always read from build flag (FIRMWARE_VERSION)
       // No NVS cleanup needed - version is embedded in the binary
       if (debugEnabled) {
-        Serial.println("DEBUG: Manual firmware upload completed.");
-        Serial.println("DEBUG: Version will be read from FIRMWARE_VERSION build flag on next boot.");
+        logSerial.println("DEBUG: Manual firmware upload completed.");
+        logSerial.println("DEBUG: Version will be read from FIRMWARE_VERSION build flag on next boot.");
       }
       
       // Send success response before restart
@@ -499,6 +692,7 @@ void handleUpdate() {
       
       // Small delay to ensure response is sent
       delay(500);
+      mccLogFlush();
       ESP.restart();
     } else {
       Update.printError(Serial);
@@ -506,7 +700,7 @@ void handleUpdate() {
     }
   } else if (upload.status == UPLOAD_FILE_ABORTED) {
     Update.abort();
-    Serial.println("Update aborted");
+    logSerial.println("Update aborted");
     server.send(500, "text/plain", "Update aborted");
   }
 }
@@ -529,21 +723,31 @@ void setupConfigServer() {
     String ap_ssid_dynamic = "MCC" + deviceIdSuffix;
 
     // Create Wi-Fi access point (AP) to host web server
-    Serial.print("Creating access point with SSID: "); 
-    Serial.println(ap_ssid_dynamic);
+    logSerial.print("Creating access point with SSID: "); 
+    logSerial.println(ap_ssid_dynamic);
     String ap_password_dynamic = getAPPassword();
-    if (debugEnabled) {
-        Serial.printf("DEBUG: Starting AP with password: %s\n", ap_password_dynamic.c_str());
-    }
+    MCC_LOGD("Starting AP with password: %.3s***\n", ap_password_dynamic.c_str());
     WiFi.softAP(ap_ssid_dynamic.c_str(), ap_password_dynamic.c_str());
-    Serial.print("Access point created! IP address: "); 
-    Serial.println(WiFi.softAPIP());
+    logSerial.print("Access point created! IP address: "); 
+    logSerial.println(WiFi.softAPIP());
 
     extern const unsigned long CONFIG_TIMEOUT_SEC; // NEW: Externally declare timeout variable
-    Serial.printf("Config mode active. Automatically ends after %u seconds without interaction.\n", CONFIG_TIMEOUT_SEC); // NEW: Timeout output
+    logSerial.printf("Config mode active. Automatically ends after %u seconds without interaction.\n", CONFIG_TIMEOUT_SEC); // NEW: Timeout output
 
     // Define web server routes
     server.on("/", handleRoot);
+    server.on("/style.css", []() {
+      sendGzipAsset("text/css", PORTAL_STYLE_CSS_GZ, PORTAL_STYLE_CSS_GZ_LEN);
+    });
+    server.on("/portal.js", []() {
+      sendGzipAsset("application/javascript", PORTAL_SCRIPT_JS_GZ, PORTAL_SCRIPT_JS_GZ_LEN);
+    });
+    server.on("/metrics", HTTP_GET, []() {
+      sendMetrics(server);
+    });
+    server.on("/log", HTTP_GET, []() {
+      sendLog(server);
+    });
     server.on("/save", handleSave);
     server.on("/reboot", handleReboot);
     // For multipart/form-data uploads, don't send response in POST handler
@@ -552,5 +756,44 @@ void setupConfigServer() {
       // Do nothing here - handleUpdate() will process the upload
     }, handleUpdate);
     server.begin();
-    Serial.println("HTTP server started");
-}
\ No newline at end of file
+    logSerial.println("HTTP server started");
+}
+
+// Diagnostics in normal operation: same port as the portal, which is stopped by then
+static WebServer diagServer(80);
+static bool diagServerStarted = false;
+
+/**
+ * @brief True if the request carries the API key of the device as X-Api-Key.
+ */
+static bool diagAuthorized() {
+  if (apiKey.length() > 0 && diagServer.header("X-Api-Key") == apiKey) {
+    return true;
+  }
+  diagServer.send(403, "text/plain", "X-Api-Key required\n");
+  return false;
+}
+
+void diagServerLoop() {
+  if (!diagServerStarted) {
+    if (!wifiManagerConnected()) {
+      return;
+    }
+    static const char* headers[] = {"X-Api-Key"};
+    diagServer.collectHeaders(headers, 1);
+    diagServer.on("/metrics", HTTP_GET, []() {
+      if (diagAuthorized()) {
+        sendMetrics(diagServer);
+      }
+    });
+    diagServer.on("/log", HTTP_GET, []() {
+      if (diagAuthorized()) {
+        sendLog(diagServer);
+      }
+    });
+    diagServer.begin();
+    diagServerStarted = true;
+    MCC_LOGI("Diagnostics on http://%s/metrics and /log\n", WiFi.localIP().toString().c_str());
+  }
+  diagServer.handleClient();
+}
@@ -22,6 +22,11 @@ extern bool debugEnabled;
 
 extern String wifi_ssid;
 extern String wifi_password;
+extern String wifi_ssid2;
+extern String wifi_password2;
+extern String staticIp;
+extern String mqttUrl;
+extern String gatewaySecret;
 extern String deviceName;
 extern String idTag;
 extern float wheel_size;
@@ -51,4 +56,14 @@ extern const unsigned long CONFIG_TIMEOUT_SEC; // NEU: Timeout-Konstante
  */
 void setupConfigServer();
 
+/**
+ * @brief Serves GET /metrics and GET /log on the station IP in normal operation.
+ *
+ * Starts once the WiFi connection is up; requests need the API key of the
+ * device in the X-Api-Key header. Runs in loop().
+ *
+ * @note Side effects: Starts an HTTP server on port 80
+ */
+void diagServerLoop();
+
 #endif
\ No newline at end of file
@@ -0,0 +1,282 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    device_config.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "device_config.h"
+#include "mcc_log.h"
+#include <Preferences.h>
+#include <nvs.h>
+
+// External variables from main.cpp
+extern Preferences preferences;
+extern bool debugEnabled;
+
+DeviceConfig deviceConfig;
+
+enum ConfigType : uint8_t {
+    CONFIG_TYPE_STRING,
+    CONFIG_TYPE_UINT,
+    CONFIG_TYPE_FLOAT,
+    CONFIG_TYPE_BOOL,
+    CONFIG_TYPE_UCHAR
+};
+
+struct ConfigFieldDesc {
+    const char* key;           // NVS key (max. 15 characters)
+    ConfigType type;
+    void* value;               // Member of deviceConfig
+    bool eraseWhenEmpty;       // Empty string removes the key (build flag default applies)
+    const char* legacyKey;     // Written with the same value for older firmware, may be nullptr
+};
+
+// Same keys and encodings as the Preferences calls used before (float = 4 byte blob)
+static const ConfigFieldDesc CONFIG_FIELDS[CFG_FIELD_COUNT] = {
+    {"wifi_ssid",      CONFIG_TYPE_STRING, &deviceConfig.wifiSsid,            false, nullptr},
+    {"wifi_password",  CONFIG_TYPE_STRING, &deviceConfig.wifiPassword,        false, nullptr},
+    {"deviceName",     CONFIG_TYPE_STRING, &deviceConfig.deviceName,          false, nullptr},
+    {"default_id_tag", CONFIG_TYPE_STRING, &deviceConfig.defaultIdTag,        false, "idTag"},
+    {"serverUrl",      CONFIG_TYPE_STRING, &deviceConfig.serverUrl,           true,  nullptr},
+    {"apiKey",         CONFIG_TYPE_STRING, &deviceConfig.apiKey,              true,  nullptr},
+    {"ap_passwd",      CONFIG_TYPE_STRING, &deviceConfig.apPassword,          false, nullptr},
+    {"static_ip",      CONFIG_TYPE_STRING, &deviceConfig.staticIp,            false, nullptr},
+    {"sendInterval",   CONFIG_TYPE_UINT,   &deviceConfig.sendInterval,        false, nullptr},
+    {"deep_sleep",     CONFIG_TYPE_UINT,   &deviceConfig.deepSleep,           false, nullptr},
+    {"testInterval",   CONFIG_TYPE_UINT,   &deviceConfig.testInterval,        false, nullptr},
+    {"cfg_fetch_int",  CONFIG_TYPE_UINT,   &deviceConfig.configFetchInterval, false, nullptr},
+    {"upload_batch",   CONFIG_TYPE_UINT,   &deviceConfig.uploadBatch,         false, nullptr},
+    {"wheel_size",     CONFIG_TYPE_FLOAT,  &deviceConfig.wheelSize,           false, nullptr},
+    {"ped_bonus",      CONFIG_TYPE_FLOAT,  &deviceConfig.pedBonus,            false, nullptr},
+    {"testDistance",   CONFIG_TYPE_FLOAT,  &deviceConfig.testDistance,        false, nullptr},
+    {"debugEnabled",   CONFIG_TYPE_BOOL,   &deviceConfig.debug,               false, nullptr},
+    {"ledEnabled",     CONFIG_TYPE_BOOL,   &deviceConfig.led,                 false, nullptr},
+    {"testModeEnabled", CONFIG_TYPE_BOOL,  &deviceConfig.testMode,            false, nullptr},
+    {"test_admin_en",  CONFIG_TYPE_BOOL,   &deviceConfig.testAdmin,           false, nullptr},
+    {"low_power_ride", CONFIG_TYPE_BOOL,   &deviceConfig.lowPowerRide,        false, nullptr},
+    {"wifi_ssid2",     CONFIG_TYPE_STRING, &deviceConfig.wifiSsid2,           true,  nullptr},
+    {"wifi_password2", CONFIG_TYPE_STRING, &deviceConfig.wifiPassword2,       true,  nullptr},
+    {"node_role",      CONFIG_TYPE_UCHAR,  &deviceConfig.nodeRole,            false, nullptr},
+    {"mqtt_url",       CONFIG_TYPE_STRING, &deviceConfig.mqttUrl,             true,  nullptr},
+    {"station_bikes",  CONFIG_TYPE_STRING, &deviceConfig.stationBikes,        true,  nullptr},
+    {"fast_boot",      CONFIG_TYPE_BOOL,   &deviceConfig.fastBoot,            false, nullptr},
+    {"trace_bytes",    CONFIG_TYPE_UINT,   &deviceConfig.traceMaxBytes,       false, nullptr},
+    {"trace_interval", CONFIG_TYPE_UINT,   &deviceConfig.traceInterval,       false, nullptr},
+    {"gw_secret",      CONFIG_TYPE_STRING, &deviceConfig.gatewaySecret,       false, nullptr},
+};
+
+static const char* CONFIG_VERSION_KEY = "cfg_version";
+static const char* CONFIG_SERVER_HASH_KEY = "cfg_srv_hash";
+
+static uint32_t dirtyMask = 0;
+
+static_assert(CFG_FIELD_COUNT <= 32, "dirtyMask holds one bit per field");
+
+void configLoad(const DeviceConfig& defaults) {
+    // Missing keys keep the default value
+    deviceConfig = defaults;
+    for (int i = 0; i < CFG_FIELD_COUNT; i++) {
+        const ConfigFieldDesc& desc = CONFIG_FIELDS[i];
+        switch (desc.type) {
+            case CONFIG_TYPE_STRING: {
+                // isKey() first: getString() logs an error for missing keys
+                String value = preferences.isKey(desc.key) ? preferences.getString(desc.key, "") : String("");
+                if (value.length() == 0 && desc.legacyKey != nullptr && preferences.isKey(desc.legacyKey)) {
+                    value = preferences.getString(desc.legacyKey, "");
+                }
+                if (value.length() > 0) {
+                    *(String*)desc.value = value;
+                }
+                break;
+            }
+            case CONFIG_TYPE_UINT:
+                *(uint32_t*)desc.value = preferences.getUInt(desc.key, *(uint32_t*)desc.value);
+                break;
+            case CONFIG_TYPE_FLOAT:
+                *(float*)desc.value = preferences.getFloat(desc.key, *(float*)desc.value);
+                break;
+            case CONFIG_TYPE_BOOL:
+                *(bool*)desc.value = preferences.getBool(desc.key, *(bool*)desc.value);
+                break;
+            case CONFIG_TYPE_UCHAR:
+                *(uint8_t*)desc.value = preferences.getUChar(desc.key, *(uint8_t*)desc.value);
+                break;
+        }
+    }
+    deviceConfig.version = preferences.getUInt(CONFIG_VERSION_KEY, 0);
+    deviceConfig.serverHash = preferences.getUInt(CONFIG_SERVER_HASH_KEY, 0);
+    dirtyMask = 0;
+}
+
+static bool markIfChanged(ConfigField field, bool changed) {
+    if (changed) {
+        dirtyMask |= (1UL << field);
+    }
+    return changed;
+}
+
+bool configSetString(ConfigField field, const String& value) {
+    String* current = (String*)CONFIG_FIELDS[field].value;
+    if (*current == value) {
+        return false;
+    }
+    *current = value;
+    return markIfChanged(field, true);
+}
+
+bool configSetUInt(ConfigField field, uint32_t value) {
+    uint32_t* current = (uint32_t*)CONFIG_FIELDS[field].value;
+    bool changed = *current != value;
+    *current = value;
+    return markIfChanged(field, changed);
+}
+
+bool configSetFloat(ConfigField field, float value) {
+    float* current = (float*)CONFIG_FIELDS[field].value;
+    bool changed = *current != value;
+    *current = value;
+    return markIfChanged(field, changed);
+}
+
+bool configSetBool(ConfigField field, bool value) {
+    bool* current = (bool*)CONFIG_FIELDS[field].value;
+    bool changed = *current != value;
+    *current = value;
+    return markIfChanged(field, changed);
+}
+
+bool configSetUChar(ConfigField field, uint8_t value) {
+    uint8_t* current = (uint8_t*)CONFIG_FIELDS[field].value;
+    bool changed = *current != value;
+    *current = value;
+    return markIfChanged(field, changed);
+}
+
+void configMarkDirty(ConfigField field) {
+    markIfChanged(field, true);
+}
+
+bool configIsDirty(ConfigField field) {
+    return (dirtyMask & (1UL << field)) != 0;
+}
+
+uint8_t configDirtyCount() {
+    uint8_t count = 0;
+    for (uint32_t mask = dirtyMask; mask != 0; mask &= mask - 1) {
+        count++;
+    }
+    return count;
+}
+
+static esp_err_t writeField(nvs_handle_t handle, const ConfigFieldDesc& desc) {
+    switch (desc.type) {
+        case CONFIG_TYPE_STRING: {
+            const String& value = *(const String*)desc.value;
+            if (value.length() == 0 && desc.eraseWhenEmpty) {
+                esp_err_t err = nvs_erase_key(handle, desc.key);
+                return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+            }
+            esp_err_t err = nvs_set_str(handle, desc.key, value.c_str());
+            if (err == ESP_OK && desc.legacyKey != nullptr) {
+                err = nvs_set_str(handle, desc.legacyKey, value.c_str());
+            }
+            return err;
+        }
+        case CONFIG_TYPE_UINT:
+            return nvs_set_u32(handle, desc.key, *(const uint32_t*)desc.value);
+        case CONFIG_TYPE_FLOAT:
+            return nvs_set_blob(handle, desc.key, desc.value, sizeof(float));
+        case CONFIG_TYPE_BOOL:
+            return nvs_set_u8(handle, desc.key, *(const bool*)desc.value ? 1 : 0);
+        case CONFIG_TYPE_UCHAR:
+            return nvs_set_u8(handle, desc.key, *(const uint8_t*)desc.value);
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+static bool commitDirty(uint32_t serverHash) {
+    if (dirtyMask == 0 && serverHash == deviceConfig.serverHash) {
+        return true;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(DEVICE_CONFIG_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        MCC_LOGE("configCommit() - Could not open NVS (error %d)\n", (int)err);
+        return false;
+    }
+
+    bool ok = true;
+    uint8_t written = 0;
+    for (int i = 0; i < CFG_FIELD_COUNT; i++) {
+        if (!configIsDirty((ConfigField)i)) {
+            continue;
+        }
+        err = writeField(handle, CONFIG_FIELDS[i]);
+        if (err != ESP_OK) {
+            MCC_LOGE("configCommit() - Failed to write parameter '%s' to NVS (error %d)\n",
+                          CONFIG_FIELDS[i].key, (int)err);
+            ok = false;
+        } else {
+            written++;
+        }
+    }
+
+    if (dirtyMask != 0) {
+        deviceConfig.version++;
+        nvs_set_u32(handle, CONFIG_VERSION_KEY, deviceConfig.version);
+    }
+    if (serverHash != deviceConfig.serverHash) {
+        deviceConfig.serverHash = serverHash;
+        nvs_set_u32(handle, CONFIG_SERVER_HASH_KEY, serverHash);
+    }
+
+    err = nvs_commit(handle);
+    nvs_close(handle);
+    if (err != ESP_OK) {
+        MCC_LOGE("configCommit() - NVS commit failed (error %d)\n", (int)err);
+        ok = false;
+    }
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: [config] Committed %u field(s), config version %u\n",
+                      (unsigned)written, (unsigned)deviceConfig.version);
+    }
+    dirtyMask = 0;
+    return ok;
+}
+
+bool configCommit() {
+    // A local change may differ from the server config: compare it field by field next time
+    return commitDirty(dirtyMask != 0 ? 0 : deviceConfig.serverHash);
+}
+
+bool configCommitServer(uint32_t serverHash) {
+    return commitDirty(serverHash);
+}
+
+// Print sink that hashes the serialized bytes
+class ConfigHashPrint : public Print {
+public:
+    uint32_t hash = 2166136261UL;
+
+    size_t write(uint8_t c) override {
+        hash ^= c;
+        hash *= 16777619UL;
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        for (size_t i = 0; i < size; i++) {
+            write(buffer[i]);
+        }
+        return size;
+    }
+};
+
+uint32_t configHash(JsonVariantConst config) {
+    ConfigHashPrint hasher;
+    serializeJson(config, hasher);
+    return hasher.hash != 0 ? hasher.hash : 1;
+}
@@ -0,0 +1,159 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    device_config.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Persistent device configuration as one typed struct. It is loaded from NVS
+ * once at startup; setters only mark fields dirty when the value really
+ * changes, and configCommit() writes all dirty fields in one NVS
+ * open/commit. The runtime globals in main.cpp keep their role for the
+ * running firmware; this struct is what NVS contains.
+ */
+
+#ifndef DEVICE_CONFIG_H
+#define DEVICE_CONFIG_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// NVS namespace shared with the Preferences instance in main.cpp
+#define DEVICE_CONFIG_NAMESPACE "bike-tacho"
+
+enum ConfigField : uint8_t {
+    CFG_WIFI_SSID = 0,
+    CFG_WIFI_PASSWORD,
+    CFG_DEVICE_NAME,
+    CFG_DEFAULT_ID_TAG,
+    CFG_SERVER_URL,
+    CFG_API_KEY,
+    CFG_AP_PASSWORD,
+    CFG_STATIC_IP,
+    CFG_SEND_INTERVAL,
+    CFG_DEEP_SLEEP,
+    CFG_TEST_INTERVAL,
+    CFG_FETCH_INTERVAL,
+    CFG_UPLOAD_BATCH,
+    CFG_WHEEL_SIZE,
+    CFG_PED_BONUS,
+    CFG_TEST_DISTANCE,
+    CFG_DEBUG,
+    CFG_LED,
+    CFG_TEST_MODE,
+    CFG_TEST_ADMIN,
+    CFG_LOW_POWER_RIDE,
+    CFG_WIFI_SSID2,
+    CFG_WIFI_PASSWORD2,
+    CFG_NODE_ROLE,
+    CFG_MQTT_URL,
+    CFG_STATION_BIKES,
+    CFG_FAST_BOOT,
+    CFG_TRACE_MAX_BYTES,
+    CFG_TRACE_INTERVAL,
+    CFG_GATEWAY_SECRET,
+    CFG_FIELD_COUNT
+};
+
+/**
+ * @brief Configuration values as stored in NVS.
+ */
+struct DeviceConfig {
+    String wifiSsid;
+    String wifiPassword;
+    String deviceName;
+    String defaultIdTag;
+    String serverUrl;          // Empty: key removed, build flag default applies
+    String apiKey;             // Empty: key removed, build flag default applies
+    String apPassword;
+    String staticIp;
+    uint32_t sendInterval;
+    uint32_t deepSleep;
+    uint32_t testInterval;
+    uint32_t configFetchInterval;
+    uint32_t uploadBatch;
+    float wheelSize;
+    float pedBonus;
+    float testDistance;
+    bool debug;
+    bool led;
+    bool testMode;
+    bool testAdmin;
+    bool lowPowerRide;
+    String wifiSsid2;          // Fallback network, empty: none
+    String wifiPassword2;
+    uint8_t nodeRole;          // GatewayRole: standalone, node (uploads through a gateway) or gateway
+    String mqttUrl;            // MQTT broker (mqtt:// or mqtts://), empty: HTTP only
+    String stationBikes;       // Further bikes "pin:wheel_mm:id_tag;..." (bike_channel.h), empty: one bike
+    bool fastBoot;             // Counting first; splash, tones and network calls follow from loop()
+    uint32_t traceMaxBytes;    // Ride trace bytes per upload (ride_trace.h), 0: no trace
+    uint32_t traceInterval;    // Seconds between uploads that carry a trace, 0: every upload
+    String gatewaySecret;      // Shared by a gateway and its nodes, keys the ESP-NOW link (gateway_link.h)
+
+    uint32_t version;          // Incremented by every commit that changed NVS
+    uint32_t serverHash;       // Hash of the last applied server config, 0 after local changes
+};
+
+extern DeviceConfig deviceConfig;
+
+/**
+ * @brief Reads all fields from NVS (defaults for missing keys) and clears the dirty set.
+ *
+ * @param defaults Values used for keys that are not in NVS
+ *
+ * @note Side effects: Reads NVS
+ */
+void configLoad(const DeviceConfig& defaults);
+
+/**
+ * @brief Setters: update a field and mark it dirty if the value differs.
+ *
+ * @return true if the value changed
+ */
+bool configSetString(ConfigField field, const String& value);
+bool configSetUInt(ConfigField field, uint32_t value);
+bool configSetFloat(ConfigField field, float value);
+bool configSetBool(ConfigField field, bool value);
+bool configSetUChar(ConfigField field, uint8_t value);
+
+/**
+ * @brief Marks a field dirty without changing it, e.g. to store a default value once.
+ */
+void configMarkDirty(ConfigField field);
+
+/**
+ * @brief true if a field was changed since the last commit.
+ */
+bool configIsDirty(ConfigField field);
+
+/**
+ * @brief Number of fields changed since the last commit.
+ */
+uint8_t configDirtyCount();
+
+/**
+ * @brief Writes all dirty fields with a single NVS commit.
+ *
+ * Does nothing (no flash access) if no field is dirty. A local change
+ * invalidates serverHash, so the next server config is compared field by field.
+ *
+ * @return false if NVS could not be opened or a write failed
+ *
+ * @note Side effects: Writes NVS
+ */
+bool configCommit();
+
+/**
+ * @brief Like configCommit(), remembering the hash of the server config just applied.
+ */
+bool configCommitServer(uint32_t serverHash);
+
+/**
+ * @brief FNV-1a hash of the server config serialized as compact JSON; never 0.
+ *
+ * The server sends no config version, so an unchanged config is detected
+ * by this hash (without buffering the serialized text).
+ */
+uint32_t configHash(JsonVariantConst config);
+
+#endif
@@ -7,12 +7,22 @@
  */
 
 #include "device_management.h"
+#include "mcc_log.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
-#include <Update.h>
 #include <Preferences.h>
 #include <cmath>
+#include "http_session.h"
+#include "ride_journal.h"
+#include "payload_codec.h"
+#include "ui_scheduler.h"
+#include "fast_resume.h"
+#include "device_config.h"
+#include "ota_update.h"
+#include "metrics.h"
+#include "boot_profile.h"
+#include "api_wire.h"
 
 static String pendingBootReason;
 
@@ -31,6 +41,20 @@ bool appendPendingBootReasonToJson(JsonObject doc) {
     return true;
 }
 
+extern BootProfile bootProfile;   // main.cpp
+
+bool appendBootTimelineToJson(JsonObject doc) {
+    if (bootProfile.reported || bootProfile.count == 0) {
+        return false;
+    }
+    JsonObject timeline = doc.createNestedObject("boot_timeline");
+    for (uint8_t i = 0; i < bootProfile.count; i++) {
+        timeline[bootProfile.names[i]] = bootProfile.us[i];
+    }
+    bootProfile.reported = true;
+    return true;
+}
+
 // External global variables from main.cpp
 extern Preferences preferences;
 extern String serverUrl;
@@ -49,16 +73,23 @@ extern char displayedSessionVelosStr[16];
 extern String sessionEpoch;
 extern bool hasSessionVelosFromServer;
 extern bool oledVelosNeedsRefresh;
+extern void anchorLocalVelos(bool live, int velos, float sessionKm, bool newSession);
 extern float testDistance;
 extern bool apiKeyErrorActive;  // Track if API key error is active
 extern unsigned int testInterval_sec;
 extern unsigned long deepSleepTimeout_sec;
 extern bool ledEnabled;
 extern unsigned int configFetchInterval_sec;
+extern unsigned int uploadBatchSize;
+extern bool batchUploadUnsupported;
+extern String staticIp;
+extern bool lowPowerRide;
+extern unsigned int traceMaxBytes;
+extern unsigned int traceInterval_sec;
 #ifdef ENABLE_OLED
 #include <U8g2lib.h>
 extern U8G2_SSD1306_128X64_NONAME_F_HW_I2C display;
-extern void display_ServerError(const char* errorType, int errorCode);
+extern void display_ServerError(const char* errorType, int errorCode, uint16_t holdMs);
 extern void display_FirmwareUpdate();
 extern void display_ConfigCheck();
 #endif
@@ -71,6 +102,78 @@ static unsigned long lastHeartbeatTime = 0;
 static unsigned long lastFirmwareCheckTime = 0;
 static bool deviceManagementInitialized = false;
 static String pendingFirmwareVersion = "";  // Store version from firmware/info response
+static String pendingFirmwareSha256 = "";   // Expected SHA-256 of the image (empty for older servers)
+static uint32_t pendingFirmwareSize = 0;    // Image size from firmware/info (0 = unknown, no resume)
+static bool syncUnsupported = false;        // Server answered /api/device/sync with 404/405
+
+/**
+ * @brief Combines serverUrl and an API path without a double slash.
+ */
+String buildApiUrl(const char* path) {
+    String finalUrl = serverUrl;
+    if (finalUrl.endsWith("/")) {
+        finalUrl.remove(finalUrl.length() - 1);
+    }
+    finalUrl += path;
+    return finalUrl;
+}
+
+// External paths from main.cpp
+extern const char* API_UPDATE_DATA_PATH;
+extern const char* API_UPDATE_DATA_BATCH_PATH;
+extern const char* API_GET_USER_ID_PATH;
+
+// Inputs the cached URLs were built from; compared on every access instead of hooking every setter
+static char cachedServerUrl[API_URL_MAX_LEN] = "";
+static char cachedDeviceName[48] = "";
+static char cachedDeviceSuffix[16] = "";
+static bool apiUrlsValid = false;
+static char apiUrls[API_EP_COUNT][API_URL_MAX_LEN];
+static char fullDeviceId[64] = "";
+
+static void apiUrlsRefresh() {
+    if (apiUrlsValid && strcmp(cachedServerUrl, serverUrl.c_str()) == 0 &&
+        strcmp(cachedDeviceName, deviceName.c_str()) == 0 &&
+        strcmp(cachedDeviceSuffix, deviceIdSuffix.c_str()) == 0) {
+        return;
+    }
+    strlcpy(cachedServerUrl, serverUrl.c_str(), sizeof(cachedServerUrl));
+    strlcpy(cachedDeviceName, deviceName.c_str(), sizeof(cachedDeviceName));
+    strlcpy(cachedDeviceSuffix, deviceIdSuffix.c_str(), sizeof(cachedDeviceSuffix));
+
+    if (deviceName.length() > 0) {
+        snprintf(fullDeviceId, sizeof(fullDeviceId), "%s%s", deviceName.c_str(), deviceIdSuffix.c_str());
+    } else {
+        fullDeviceId[0] = '\0';
+    }
+
+    // Same trailing slash handling as buildApiUrl()
+    int baseLen = (int)strlen(cachedServerUrl);
+    if (baseLen > 0 && cachedServerUrl[baseLen - 1] == '/') {
+        baseLen--;
+    }
+    const char* paths[API_EP_COUNT] = {
+        API_UPDATE_DATA_PATH, API_UPDATE_DATA_BATCH_PATH, API_GET_USER_ID_PATH,
+        API_DEVICE_CONFIG_FETCH_PATH, API_DEVICE_CONFIG_REPORT_PATH, API_DEVICE_HEARTBEAT_PATH,
+        API_DEVICE_SYNC_PATH
+    };
+    for (int i = 0; i < API_EP_COUNT; i++) {
+        snprintf(apiUrls[i], API_URL_MAX_LEN, "%.*s%s", baseLen, cachedServerUrl, paths[i]);
+    }
+    snprintf(apiUrls[API_EP_CONFIG_FETCH], API_URL_MAX_LEN, "%.*s%s?device_id=%s",
+             baseLen, cachedServerUrl, API_DEVICE_CONFIG_FETCH_PATH, fullDeviceId);
+    apiUrlsValid = true;
+}
+
+const char* apiUrl(ApiEndpoint endpoint) {
+    apiUrlsRefresh();
+    return apiUrls[endpoint];
+}
+
+const char* deviceIdFull() {
+    apiUrlsRefresh();
+    return fullDeviceId;
+}
 
 /**
  * @brief Gets the current firmware version from build flag.
@@ -105,8 +208,8 @@ void initDeviceManagement() {
     deviceManagementInitialized = true;
     
     if (debugEnabled) {
-        Serial.println("DEBUG: Device management initialized");
-        Serial.printf("DEBUG: Firmware version: %s\n", getFirmwareVersion().c_str());
+        logSerial.println("DEBUG: Device management initialized");
+        logSerial.printf("DEBUG: Firmware version: %s\n", getFirmwareVersion().c_str());
     }
 }
 
@@ -118,9 +221,8 @@ void initDeviceManagement() {
  * @return String AP password (minimum 8 characters, default if not set)
  */
 String getAPPasswordFromNVS() {
-    // NVS key max length is 15 characters, so use shorter key
     const char* DEFAULT_AP_PASSWORD = "mccmuims";
-    String password = preferences.getString("ap_passwd", "");
+    const String& password = deviceConfig.apPassword;
     if (password.length() == 0 || password.length() < 8) {
         // Use default if not set or invalid (minimum 8 chars for WPA2)
         return String(DEFAULT_AP_PASSWORD);
@@ -131,15 +233,10 @@ String getAPPasswordFromNVS() {
 /**
  * @brief Creates a JSON document with current device configuration.
  */
-StaticJsonDocument<512> createConfigJson() {
-    StaticJsonDocument<512> config;
-    
-    String finalDeviceId = deviceName;
-    if (finalDeviceId.length() > 0) {
-        finalDeviceId += deviceIdSuffix;
-    }
+StaticJsonDocument<640> createConfigJson() {
+    StaticJsonDocument<640> config;
     
-    config["device_name"] = finalDeviceId;
+    config["device_name"] = deviceIdFull();
     config["default_id_tag"] = idTag;
     config["send_interval_seconds"] = sendInterval_sec;
     config["server_url"] = serverUrl;
@@ -156,6 +253,11 @@ StaticJsonDocument<512> createConfigJson() {
     
     // Add config_fetch_interval_seconds
     config["config_fetch_interval_seconds"] = configFetchInterval_sec;
+    config["upload_batch_size"] = uploadBatchSize;
+    config["static_ip"] = staticIp;
+    config["low_power_ride"] = lowPowerRide;
+    config["trace_max_bytes"] = traceMaxBytes;
+    config["trace_interval_seconds"] = traceInterval_sec;
     
     // Add ap_password (read from NVS)
     String apPassword = getAPPasswordFromNVS();
@@ -173,9 +275,7 @@ bool reportDeviceConfig() {
     
     if (serverUrl.length() == 0 || WiFi.status() != WL_CONNECTED) {
         digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-        if (debugEnabled) {
-            Serial.println("DEBUG: reportDeviceConfig: No connection or configuration error.");
-        }
+        MCC_LOGD("reportDeviceConfig: No connection or configuration error.");
         return false;
     }
 
@@ -183,93 +283,66 @@ bool reportDeviceConfig() {
     display_ConfigCheck();
     #endif
 
-    HTTPClient http;
-    StaticJsonDocument<600> doc;
+    HttpSession session;
+    HTTPClient& http = session.http();
+    StaticJsonDocument<768> doc;
     
-    String finalDeviceId = deviceName;
-    if (finalDeviceId.length() > 0) {
-        finalDeviceId += deviceIdSuffix;
-    }
-    
-    doc["device_id"] = finalDeviceId;
+    doc["device_id"] = deviceIdFull();
     doc["config"] = createConfigJson();
 
     String jsonPayload;
     serializeJson(doc, jsonPayload);
 
-    String finalUrl = serverUrl;
-    if (finalUrl.endsWith("/")) {
-        finalUrl.remove(finalUrl.length() - 1);
-    }
-    finalUrl += API_DEVICE_CONFIG_REPORT_PATH;
+    const char* finalUrl = apiUrl(API_EP_CONFIG_REPORT);
 
     if (debugEnabled) {
-        Serial.print("DEBUG: Reporting device config to: ");
-        Serial.println(finalUrl);
-        Serial.println("DEBUG: Config JSON:");
-        Serial.println(jsonPayload);
+        logSerial.print("DEBUG: Reporting device config to: ");
+        logSerial.println(finalUrl);
+        logSerial.println("DEBUG: Config JSON:");
+        logSerial.println(jsonPayload);
     }
 
-    http.begin(finalUrl);
+    session.begin(finalUrl, METRIC_EP_CONFIG_REPORT);
     http.addHeader("Content-Type", "application/json");
     if (apiKey.length() > 0) {
         http.addHeader("X-Api-Key", apiKey);
     }
     
-    int httpCode = http.POST(jsonPayload);
+    // The differences list can be long; only the summary is kept. The following
+    // config fetch logs every field it changes.
+    StaticJsonDocument<64> filter;
+    filter["success"] = true;
+    filter["has_differences"] = true;
+    StaticJsonDocument<96> responseDoc;
+    DeserializationError error;
+    int httpCode = session.recordResult(payloadExchangeFiltered(http, jsonPayload.c_str(), jsonPayload.length(),
+                                                                responseDoc, filter, &error));
     
     bool success = false;
     if (httpCode > 0) {
         if (httpCode == HTTP_CODE_OK) {
-            String response = http.getString();
-            if (debugEnabled) {
-                Serial.println("DEBUG: Config report response:");
-                Serial.println(response);
-            }
-            
-            StaticJsonDocument<2000> responseDoc;  // Increased size for large responses with many differences
-            DeserializationError error = deserializeJson(responseDoc, response);
-            
             if (error && debugEnabled) {
-                Serial.printf("DEBUG: Config report JSON parse error: %s\n", error.c_str());
+                logSerial.printf("DEBUG: Config report JSON parse error: %s\n", error.c_str());
             }
             
             if (!error && responseDoc.containsKey("success")) {
                 success = responseDoc["success"].as<bool>();
-                if (debugEnabled) {
-                    Serial.printf("DEBUG: reportDeviceConfig() returning: %s\n", success ? "true" : "false");
-                }
+                MCC_LOGD("reportDeviceConfig() returning: %s\n", success ? "true" : "false");
                 
-                // Check if there are differences
-                if (responseDoc.containsKey("has_differences")) {
-                    bool hasDiff = responseDoc["has_differences"].as<bool>();
-                    if (hasDiff && debugEnabled) {
-                        Serial.println("DEBUG: Configuration differences detected!");
-                        if (responseDoc.containsKey("differences")) {
-                            Serial.println("DEBUG: Differences:");
-                            JsonArray diffs = responseDoc["differences"].as<JsonArray>();
-                            for (JsonObject diff : diffs) {
-                                Serial.printf("  - %s: server='%s', device='%s'\n",
-                                    diff["field"].as<const char*>(),
-                                    diff["server_value"].as<const char*>(),
-                                    diff["device_value"].as<const char*>());
-                            }
-                        }
-                    }
+                if (debugEnabled && responseDoc["has_differences"].as<bool>()) {
+                    logSerial.println("DEBUG: Configuration differences detected!");
                 }
             } else if (debugEnabled) {
-                Serial.println("DEBUG: Config report response missing 'success' field or parse error");
+                logSerial.println("DEBUG: Config report response missing 'success' field or parse error");
             }
         } else {
             if (debugEnabled) {
-                Serial.printf("DEBUG: Config report HTTP error: %d\n", httpCode);
-                Serial.println(http.getString());
+                logSerial.printf("DEBUG: Config report HTTP error: %d\n", httpCode);
+                logSerial.println(http.getString());
             }
         }
     } else {
-        if (debugEnabled) {
-            Serial.printf("DEBUG: Config report connection error: %s\n", http.errorToString(httpCode).c_str());
-        }
+        MCC_LOGD("Config report connection error: %s\n", http.errorToString(httpCode).c_str());
     }
 
     http.end();
@@ -284,71 +357,150 @@ bool fetchDeviceConfig() {
     // Turn on LED to indicate WiFi activity
     digitalWrite(LED_PIN, HIGH);
     
-    if (debugEnabled) {
-        Serial.println("DEBUG: [fetchDeviceConfig] Starting...");
-    }
+    MCC_LOGD("[fetchDeviceConfig] Starting...");
     
     if (serverUrl.length() == 0 || WiFi.status() != WL_CONNECTED) {
         digitalWrite(LED_PIN, LOW);  // Turn off LED on error
         if (debugEnabled) {
-            Serial.printf("DEBUG: [fetchDeviceConfig] No connection or configuration error. serverUrl.length()=%d, WiFi.status()=%d\n", 
+            logSerial.printf("DEBUG: [fetchDeviceConfig] No connection or configuration error. serverUrl.length()=%d, WiFi.status()=%d\n", 
                 serverUrl.length(), WiFi.status());
         }
         return false;
     }
 
-    HTTPClient http;
-    
-    String finalDeviceId = deviceName;
-    if (finalDeviceId.length() > 0) {
-        finalDeviceId += deviceIdSuffix;
+    const char* finalUrl = apiUrl(API_EP_CONFIG_FETCH);
+
+    if (debugEnabled) {
+        logSerial.print("DEBUG: [fetchDeviceConfig] Fetching device config from: ");
+        logSerial.println(finalUrl);
     }
 
-    String finalUrl = serverUrl;
-    if (finalUrl.endsWith("/")) {
-        finalUrl.remove(finalUrl.length() - 1);
+    int httpCode;
+    StaticJsonDocument<DEVICE_CONFIG_DOC_SIZE> responseDoc;
+    DeserializationError error;
+    {
+        // Release the shared connection before applying: the API key test issues its own request
+        HttpSession session;
+        HTTPClient& http = session.http();
+        session.begin(finalUrl, METRIC_EP_CONFIG_FETCH);
+        http.addHeader("Content-Type", "application/json");
+        if (apiKey.length() > 0) {
+            http.addHeader("X-Api-Key", apiKey);
+        }
+
+        addConfigIfNoneMatch(http, deviceConfig.serverHash);
+
+        httpCode = session.recordResult(payloadExchangeFiltered(http, nullptr, 0, responseDoc, deviceConfigFilter(), &error));
+        if (httpCode <= 0 && debugEnabled) {
+            logSerial.printf("DEBUG: [fetchDeviceConfig] Connection error: %s\n", http.errorToString(httpCode).c_str());
+        }
+        http.end();
     }
-    finalUrl += API_DEVICE_CONFIG_FETCH_PATH;
-    finalUrl += "?device_id=" + finalDeviceId;
 
-    if (debugEnabled) {
-        Serial.print("DEBUG: [fetchDeviceConfig] Fetching device config from: ");
-        Serial.println(finalUrl);
+    bool success = applyDeviceConfigDocument(httpCode, responseDoc, error);
+    digitalWrite(LED_PIN, LOW);  // Turn off LED after completion
+    MCC_LOGD("[fetchDeviceConfig] Returning: %s\n", success ? "true" : "false");
+    return success;
+}
+
+static StaticJsonDocument<512> buildDeviceConfigFilter() {
+    StaticJsonDocument<512> filter;
+    filter["success"] = true;
+    filter["config_hash"] = true;
+    JsonObject config = filter.createNestedObject("config");
+    const char* keys[] = {
+        "default_id_tag", "send_interval_seconds", "server_url", "debug_mode", "test_mode",
+        "test_mode_admin_enabled", "test_distance_km", "test_interval_seconds", "deep_sleep_seconds",
+        "wheel_size", "paedagogischer_bonus", "device_api_key", "ap_password",
+        "config_fetch_interval_seconds", "upload_batch_size", "static_ip",
+        "low_power_ride", "trace_max_bytes", "trace_interval_seconds"
+    };
+    for (const char* key : keys) {
+        config[key] = true;
+    }
+    return filter;
+}
+
+const JsonDocument& deviceConfigFilter() {
+    // Built once; shared by loop() and the network worker (read-only afterwards)
+    static const StaticJsonDocument<512> filter = buildDeviceConfigFilter();
+    return filter;
+}
+
+void addConfigIfNoneMatch(HTTPClient& http, uint32_t serverHash) {
+    char etag[16];
+    if (apiWireConfigEtag(etag, sizeof(etag), serverHash)) {
+        http.addHeader("If-None-Match", etag);
     }
+}
 
-    http.begin(finalUrl);
-    http.addHeader("Content-Type", "application/json");
-    if (apiKey.length() > 0) {
-        http.addHeader("X-Api-Key", apiKey);
+/**
+ * @brief Applies a config fetch response (HTTP code and body) to NVS and globals.
+ */
+bool applyDeviceConfigResponse(int httpCode, const char* response) {
+    StaticJsonDocument<DEVICE_CONFIG_DOC_SIZE> responseDoc;
+    DeserializationError error = DeserializationError::EmptyInput;
+    if (httpCode == HTTP_CODE_OK && response != nullptr && response[0] != '\0') {
+        error = deserializeJson(responseDoc, response, DeserializationOption::Filter(deviceConfigFilter()));
+    } else if (httpCode > 0 && httpCode != HTTP_CODE_NOT_MODIFIED && debugEnabled && response != nullptr) {
+        logSerial.print("DEBUG: [fetchDeviceConfig] Error response: ");
+        logSerial.println(response);
     }
-    
-    int httpCode = http.GET();
-    
-    if (debugEnabled) {
-        Serial.printf("DEBUG: [fetchDeviceConfig] HTTP response code: %d\n", httpCode);
+    return applyDeviceConfigDocument(httpCode, responseDoc, error);
+}
+
+/**
+ * @brief Applies a parsed config fetch response to NVS and globals.
+ */
+/**
+ * @brief Logs the filtered config response with the secrets cut to "abc***".
+ */
+static void logConfigResponse(const JsonDocument& responseDoc) {
+    static const char* const secretKeys[] = {"device_api_key", "ap_password", "wifi_password"};
+    // Debug only: a copy, so the applied document keeps the full values
+    DynamicJsonDocument masked(responseDoc.memoryUsage() + 128);
+    masked.set(responseDoc);
+    JsonObject config = masked["config"];
+    for (const char* key : secretKeys) {
+        const char* value = config[key];
+        if (value != nullptr) {
+            char shown[8];
+            snprintf(shown, sizeof(shown), "%.3s***", value);
+            config[key] = shown;
+        }
     }
+    logSerial.print("DEBUG: [fetchDeviceConfig] Config fetch response (filtered): ");
+    serializeJson(masked, logSerial);
+    logSerial.println();
+}
+
+bool applyDeviceConfigDocument(int httpCode, JsonDocument& responseDoc, DeserializationError error) {
+    MCC_LOGD("[fetchDeviceConfig] HTTP response code: %d\n", httpCode);
     
+    if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+        // Unchanged since the last applied config: nothing to parse, compare or write
+        apiKeyErrorActive = false;
+        if (debugEnabled) {
+            logSerial.printf("DEBUG: [fetchDeviceConfig] Configuration unchanged (config hash %08X)\n",
+                          (unsigned)deviceConfig.serverHash);
+        }
+        return true;
+    }
+
     bool success = false;
     if (httpCode > 0) {
         if (httpCode == HTTP_CODE_OK) {
-            String response = http.getString();
-            if (debugEnabled) {
-                Serial.println("DEBUG: [fetchDeviceConfig] Config fetch response:");
-                Serial.println(response);
+            if (debugEnabled && !error) {
+                logConfigResponse(responseDoc);
             }
             
-            StaticJsonDocument<2000> responseDoc;  // Increased size for large config responses
-            DeserializationError error = deserializeJson(responseDoc, response);
-            
             if (error && debugEnabled) {
-                Serial.printf("DEBUG: [fetchDeviceConfig] JSON parse error: %s\n", error.c_str());
+                logSerial.printf("DEBUG: [fetchDeviceConfig] JSON parse error: %s\n", error.c_str());
             }
             
             if (!error && responseDoc.containsKey("success")) {
                 success = responseDoc["success"].as<bool>();
-                if (debugEnabled) {
-                    Serial.printf("DEBUG: [fetchDeviceConfig] Response success: %s\n", success ? "true" : "false");
-                }
+                MCC_LOGD("[fetchDeviceConfig] Response success: %s\n", success ? "true" : "false");
                 
                 // Clear API key error flag on successful communication
                 if (success) {
@@ -358,17 +510,31 @@ bool fetchDeviceConfig() {
                 if (success && responseDoc.containsKey("config")) {
                     JsonObject config = responseDoc["config"].as<JsonObject>();
                     bool configChanged = false;
+
+                    // Same config as the last one applied: no comparisons, no API key test, no flash access
+                    // Sync and config fetch responses carry the server's hash; it is sent back
+                    // with the next sync and as If-None-Match of the next config fetch
+                    const uint32_t serverHash = responseDoc["config_hash"] | configHash(config);
+                    if (serverHash == deviceConfig.serverHash) {
+                        if (debugEnabled) {
+                            logSerial.printf("DEBUG: [Config Update] Configuration is already in sync (config hash %08X) - no changes needed.\n",
+                                          (unsigned)serverHash);
+                        }
+                        return true;
+                    }
+                    // A rejected API key is tested again with the next fetch
+                    bool rememberServerHash = true;
                     
                     if (debugEnabled) {
-                        Serial.println("DEBUG: [Config Update] Starting configuration update from server...");
-                        Serial.print("DEBUG: [Config Update] Received fields: ");
+                        logSerial.println("DEBUG: [Config Update] Starting configuration update from server...");
+                        logSerial.print("DEBUG: [Config Update] Received fields: ");
                         bool first = true;
                         for (JsonPair kv : config) {
-                            if (!first) Serial.print(", ");
-                            Serial.print(kv.key().c_str());
+                            if (!first) logSerial.print(", ");
+                            logSerial.print(kv.key().c_str());
                             first = false;
                         }
-                        Serial.println();
+                        logSerial.println();
                     }
                     
                     // Note: device_name is only configurable via device WebGUI, not from server
@@ -379,33 +545,23 @@ bool fetchDeviceConfig() {
                         String newTag = config["default_id_tag"].as<String>();
                         // Only update if server provides a real (non-empty) value
                         if (newTag.length() > 0) {
-                            // Get current default from NVS (not from RAM, as RAM might have temporary RFID tag)
-                            String currentDefault = preferences.getString("default_id_tag", "");
-                            // Fallback to legacy "idTag" key for backward compatibility
-                            if (currentDefault.length() == 0) {
-                                currentDefault = preferences.getString("idTag", "");
-                            }
+                            // Compare with the stored default (not idTag, as RAM might have temporary RFID tag)
+                            const String& currentDefault = deviceConfig.defaultIdTag;
                             
-                            if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] default_id_tag from server: %s, current default: %s\n", newTag.c_str(), currentDefault.c_str());
-                            }
+                            MCC_LOGD("[Config Update] default_id_tag from server: %s, current default: %s\n", newTag.c_str(), currentDefault.c_str());
                             if (newTag != currentDefault) {
-                                // Save as default_id_tag (not idTag) to distinguish from temporary RFID tag
-                                preferences.putString("default_id_tag", newTag);
-                                // Also update legacy "idTag" key for backward compatibility
-                                preferences.putString("idTag", newTag);
+                                // Save as default_id_tag (the commit also updates the legacy "idTag" key)
+                                configSetString(CFG_DEFAULT_ID_TAG, newTag);
                                 // Only update global idTag if no RFID tag is currently active
                                 // (We can't easily detect this, so we update it - RFID will override on next detection)
                                 idTag = newTag;  // Update global variable
                                 configChanged = true;
-                                if (debugEnabled) {
-                                    Serial.printf("DEBUG: [Config Update] default_id_tag updated to: %s\n", newTag.c_str());
-                                }
+                                MCC_LOGD("[Config Update] default_id_tag updated to: %s\n", newTag.c_str());
                             } else if (debugEnabled) {
-                                Serial.println("DEBUG: [Config Update] default_id_tag unchanged, no update needed");
+                                logSerial.println("DEBUG: [Config Update] default_id_tag unchanged, no update needed");
                             }
                         } else if (debugEnabled) {
-                            Serial.println("DEBUG: [Config Update] default_id_tag from server is empty, ignoring (preserving device value)");
+                            logSerial.println("DEBUG: [Config Update] default_id_tag from server is empty, ignoring (preserving device value)");
                         }
                     }
                     
@@ -413,21 +569,17 @@ bool fetchDeviceConfig() {
                         unsigned int newInterval = config["send_interval_seconds"].as<unsigned int>();
                         // Only update if server provides a real (non-zero) value
                         if (newInterval > 0) {
-                            if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] send_interval_seconds from server: %u, current: %u\n", newInterval, sendInterval_sec);
-                            }
+                            MCC_LOGD("[Config Update] send_interval_seconds from server: %u, current: %u\n", newInterval, sendInterval_sec);
                             if (newInterval != sendInterval_sec) {
-                                preferences.putUInt("sendInterval", newInterval);
+                                configSetUInt(CFG_SEND_INTERVAL, newInterval);
                                 sendInterval_sec = newInterval;  // Update global variable immediately
                                 configChanged = true;
-                                if (debugEnabled) {
-                                    Serial.printf("DEBUG: [Config Update] send_interval_seconds updated to: %u\n", newInterval);
-                                }
+                                MCC_LOGD("[Config Update] send_interval_seconds updated to: %u\n", newInterval);
                             } else if (debugEnabled) {
-                                Serial.println("DEBUG: [Config Update] send_interval_seconds unchanged, no update needed");
+                                logSerial.println("DEBUG: [Config Update] send_interval_seconds unchanged, no update needed");
                             }
                         } else if (debugEnabled) {
-                            Serial.println("DEBUG: [Config Update] send_interval_seconds from server is 0, ignoring (preserving device value)");
+                            logSerial.println("DEBUG: [Config Update] send_interval_seconds from server is 0, ignoring (preserving device value)");
                         }
                     }
                     
@@ -435,21 +587,17 @@ bool fetchDeviceConfig() {
                         String newUrl = config["server_url"].as<String>();
                         // Only update if server provides a real (non-empty) value
                         if (newUrl.length() > 0) {
-                            if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] server_url from server: %s, current: %s\n", newUrl.c_str(), serverUrl.c_str());
-                            }
+                            MCC_LOGD("[Config Update] server_url from server: %s, current: %s\n", newUrl.c_str(), serverUrl.c_str());
                             if (newUrl != serverUrl) {
-                                preferences.putString("serverUrl", newUrl);
+                                configSetString(CFG_SERVER_URL, newUrl);
                                 serverUrl = newUrl;  // Update global variable immediately
                                 configChanged = true;
-                                if (debugEnabled) {
-                                    Serial.printf("DEBUG: [Config Update] server_url updated to: %s\n", newUrl.c_str());
-                                }
+                                MCC_LOGD("[Config Update] server_url updated to: %s\n", newUrl.c_str());
                             } else if (debugEnabled) {
-                                Serial.println("DEBUG: [Config Update] server_url unchanged, no update needed");
+                                logSerial.println("DEBUG: [Config Update] server_url unchanged, no update needed");
                             }
                         } else if (debugEnabled) {
-                            Serial.println("DEBUG: [Config Update] server_url from server is empty, ignoring (preserving device value)");
+                            logSerial.println("DEBUG: [Config Update] server_url from server is empty, ignoring (preserving device value)");
                         }
                     }
                     
@@ -459,21 +607,19 @@ bool fetchDeviceConfig() {
                         // Only update if server provides a valid value (500-3000 mm)
                         if (newSizeMm >= 500.0 && newSizeMm <= 3000.0) {
                             if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] wheel_size from server: %.1f mm, current: %.1f mm\n", 
+                                logSerial.printf("DEBUG: [Config Update] wheel_size from server: %.1f mm, current: %.1f mm\n", 
                                     newSizeMm, wheel_size);
                             }
                             if (abs(newSizeMm - wheel_size) > 1.0) {  // 1mm tolerance for comparison
-                                preferences.putFloat("wheel_size", newSizeMm);
+                                configSetFloat(CFG_WHEEL_SIZE, newSizeMm);
                                 wheel_size = newSizeMm;  // Update global variable immediately
                                 configChanged = true;
-                                if (debugEnabled) {
-                                    Serial.printf("DEBUG: [Config Update] wheel_size updated to: %.1f mm\n", newSizeMm);
-                                }
+                                MCC_LOGD("[Config Update] wheel_size updated to: %.1f mm\n", newSizeMm);
                             } else if (debugEnabled) {
-                                Serial.println("DEBUG: [Config Update] wheel_size unchanged, no update needed");
+                                logSerial.println("DEBUG: [Config Update] wheel_size unchanged, no update needed");
                             }
                         } else if (debugEnabled) {
-                            Serial.printf("DEBUG: [Config Update] wheel_size from server is out of valid range (%.1f mm, expected 500-3000 mm), ignoring (preserving device value)\n", 
+                            logSerial.printf("DEBUG: [Config Update] wheel_size from server is out of valid range (%.1f mm, expected 500-3000 mm), ignoring (preserving device value)\n", 
                                 newSizeMm);
                         }
                     }
@@ -481,18 +627,16 @@ bool fetchDeviceConfig() {
                     if (config.containsKey("paedagogischer_bonus")) {
                         float newBonus = config["paedagogischer_bonus"].as<float>();
                         if (debugEnabled) {
-                            Serial.printf("DEBUG: [Config Update] paedagogischer_bonus from server: %.2f, current: %.2f\n",
+                            logSerial.printf("DEBUG: [Config Update] paedagogischer_bonus from server: %.2f, current: %.2f\n",
                                 newBonus, paedagogischer_bonus);
                         }
                         if (fabsf(newBonus - paedagogischer_bonus) > 0.001f) {
-                            preferences.putFloat("ped_bonus", newBonus);
+                            configSetFloat(CFG_PED_BONUS, newBonus);
                             paedagogischer_bonus = newBonus;
                             configChanged = true;
-                            if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] paedagogischer_bonus updated to: %.2f\n", newBonus);
-                            }
+                            MCC_LOGD("[Config Update] paedagogischer_bonus updated to: %.2f\n", newBonus);
                         } else if (debugEnabled) {
-                            Serial.println("DEBUG: [Config Update] paedagogischer_bonus unchanged, no update needed");
+                            logSerial.println("DEBUG: [Config Update] paedagogischer_bonus unchanged, no update needed");
                         }
                     }
                     
@@ -500,44 +644,34 @@ bool fetchDeviceConfig() {
                     // We check if the key exists, and if it does, we update (even if false)
                     if (config.containsKey("debug_mode")) {
                         bool newDebug = config["debug_mode"].as<bool>();
-                        if (debugEnabled) {
-                            Serial.printf("DEBUG: [Config Update] debug_mode from server: %s, current: %s\n", newDebug ? "true" : "false", debugEnabled ? "true" : "false");
-                        }
+                        MCC_LOGD("[Config Update] debug_mode from server: %s, current: %s\n", newDebug ? "true" : "false", debugEnabled ? "true" : "false");
                         if (newDebug != debugEnabled) {
-                            preferences.putBool("debugEnabled", newDebug);
+                            configSetBool(CFG_DEBUG, newDebug);
                             debugEnabled = newDebug;  // Update global variable immediately
                             configChanged = true;
-                            if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] debug_mode updated to: %s\n", newDebug ? "true" : "false");
-                            }
+                            MCC_LOGD("[Config Update] debug_mode updated to: %s\n", newDebug ? "true" : "false");
                         } else if (debugEnabled) {
-                            Serial.println("DEBUG: [Config Update] debug_mode unchanged, no update needed");
+                            logSerial.println("DEBUG: [Config Update] debug_mode unchanged, no update needed");
                         }
                     }
                     
                     // Enable test mode admin access in config GUI (set by server)
                     if (config.containsKey("test_mode_admin_enabled")) {
                         bool adminEnabled = config["test_mode_admin_enabled"].as<bool>();
-                        preferences.putBool("test_mode_admin_enabled", adminEnabled);
-                        if (debugEnabled) {
-                            Serial.printf("DEBUG: [Config Update] test_mode_admin_enabled set to: %s\n", adminEnabled ? "true" : "false");
-                        }
+                        configSetBool(CFG_TEST_ADMIN, adminEnabled);
+                        MCC_LOGD("[Config Update] test_mode_admin_enabled set to: %s\n", adminEnabled ? "true" : "false");
                     }
                     
                     if (config.containsKey("test_mode")) {
                         bool newTest = config["test_mode"].as<bool>();
-                        if (debugEnabled) {
-                            Serial.printf("DEBUG: [Config Update] test_mode from server: %s, current: %s\n", newTest ? "true" : "false", testActive ? "true" : "false");
-                        }
+                        MCC_LOGD("[Config Update] test_mode from server: %s, current: %s\n", newTest ? "true" : "false", testActive ? "true" : "false");
                         if (newTest != testActive) {
-                            preferences.putBool("testModeEnabled", newTest);
+                            configSetBool(CFG_TEST_MODE, newTest);
                             testActive = newTest;  // Update global variable immediately
                             configChanged = true;
-                            if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] test_mode updated to: %s\n", newTest ? "true" : "false");
-                            }
+                            MCC_LOGD("[Config Update] test_mode updated to: %s\n", newTest ? "true" : "false");
                         } else if (debugEnabled) {
-                            Serial.println("DEBUG: [Config Update] test_mode unchanged, no update needed");
+                            logSerial.println("DEBUG: [Config Update] test_mode unchanged, no update needed");
                         }
                     }
                     
@@ -546,21 +680,17 @@ bool fetchDeviceConfig() {
                         float newTestDistance = config["test_distance_km"].as<float>();
                         // Only update if server provides a valid value (> 0)
                         if (newTestDistance > 0.0) {
-                            if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] test_distance_km from server: %.2f, current: %.2f\n", newTestDistance, testDistance);
-                            }
+                            MCC_LOGD("[Config Update] test_distance_km from server: %.2f, current: %.2f\n", newTestDistance, testDistance);
                             if (abs(newTestDistance - testDistance) > 0.001) {  // 0.001 km tolerance for comparison
-                                preferences.putFloat("testDistance", newTestDistance);
+                                configSetFloat(CFG_TEST_DISTANCE, newTestDistance);
                                 testDistance = newTestDistance;  // Update global variable immediately
                                 configChanged = true;
-                                if (debugEnabled) {
-                                    Serial.printf("DEBUG: [Config Update] test_distance_km updated to: %.2f\n", newTestDistance);
-                                }
+                                MCC_LOGD("[Config Update] test_distance_km updated to: %.2f\n", newTestDistance);
                             } else if (debugEnabled) {
-                                Serial.println("DEBUG: [Config Update] test_distance_km unchanged, no update needed");
+                                logSerial.println("DEBUG: [Config Update] test_distance_km unchanged, no update needed");
                             }
                         } else if (debugEnabled) {
-                            Serial.printf("DEBUG: [Config Update] test_distance_km from server is invalid (%.2f, expected > 0), ignoring (preserving device value)\n", newTestDistance);
+                            logSerial.printf("DEBUG: [Config Update] test_distance_km from server is invalid (%.2f, expected > 0), ignoring (preserving device value)\n", newTestDistance);
                         }
                     }
                     
@@ -569,21 +699,17 @@ bool fetchDeviceConfig() {
                         unsigned int newTestInterval = config["test_interval_seconds"].as<unsigned int>();
                         // Only update if server provides a valid value (> 0)
                         if (newTestInterval > 0) {
-                            if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] test_interval_seconds from server: %u, current: %u\n", newTestInterval, testInterval_sec);
-                            }
+                            MCC_LOGD("[Config Update] test_interval_seconds from server: %u, current: %u\n", newTestInterval, testInterval_sec);
                             if (newTestInterval != testInterval_sec) {
-                                preferences.putUInt("testInterval", newTestInterval);
+                                configSetUInt(CFG_TEST_INTERVAL, newTestInterval);
                                 testInterval_sec = newTestInterval;  // Update global variable immediately
                                 configChanged = true;
-                                if (debugEnabled) {
-                                    Serial.printf("DEBUG: [Config Update] test_interval_seconds updated to: %u\n", newTestInterval);
-                                }
+                                MCC_LOGD("[Config Update] test_interval_seconds updated to: %u\n", newTestInterval);
                             } else if (debugEnabled) {
-                                Serial.println("DEBUG: [Config Update] test_interval_seconds unchanged, no update needed");
+                                logSerial.println("DEBUG: [Config Update] test_interval_seconds unchanged, no update needed");
                             }
                         } else if (debugEnabled) {
-                            Serial.printf("DEBUG: [Config Update] test_interval_seconds from server is invalid (%u, expected > 0), ignoring (preserving device value)\n", newTestInterval);
+                            logSerial.printf("DEBUG: [Config Update] test_interval_seconds from server is invalid (%u, expected > 0), ignoring (preserving device value)\n", newTestInterval);
                         }
                     }
                     
@@ -591,19 +717,14 @@ bool fetchDeviceConfig() {
                         unsigned long newSleep = config["deep_sleep_seconds"].as<unsigned long>();
                         // Note: 0 is a valid value for deep_sleep_seconds (means disabled)
                         // So we always update if the key exists, even if value is 0
-                        // NVS key max length is 15 characters, so use shorter key
-                        if (debugEnabled) {
-                            Serial.printf("DEBUG: [Config Update] deep_sleep_seconds from server: %lu, current: %lu\n", newSleep, deepSleepTimeout_sec);
-                        }
+                        MCC_LOGD("[Config Update] deep_sleep_seconds from server: %lu, current: %lu\n", newSleep, deepSleepTimeout_sec);
                         if (newSleep != deepSleepTimeout_sec) {
-                            preferences.putUInt("deep_sleep", newSleep);  // Shortened key (max 15 chars)
+                            configSetUInt(CFG_DEEP_SLEEP, newSleep);
                             deepSleepTimeout_sec = newSleep;  // Update global variable immediately
                             configChanged = true;
-                            if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] deep_sleep_seconds updated to: %lu\n", newSleep);
-                            }
+                            MCC_LOGD("[Config Update] deep_sleep_seconds updated to: %lu\n", newSleep);
                         } else if (debugEnabled) {
-                            Serial.println("DEBUG: [Config Update] deep_sleep_seconds unchanged, no update needed");
+                            logSerial.println("DEBUG: [Config Update] deep_sleep_seconds unchanged, no update needed");
                         }
                     }
                     
@@ -612,25 +733,21 @@ bool fetchDeviceConfig() {
                         // Only update if server provides a real (non-empty, min 8 chars) value
                         if (newAPPassword.length() >= 8) {
                             if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] ap_password from server: %s\n", newAPPassword.c_str());
-                                String currentAPPassword = preferences.getString("ap_passwd", "");
-                                Serial.printf("DEBUG: [Config Update] Current AP password in NVS: %s\n", currentAPPassword.length() > 0 ? currentAPPassword.c_str() : "(empty/default)");
+                                logSerial.printf("DEBUG: [Config Update] ap_password from server: %.3s***\n", newAPPassword.c_str());
+                                logSerial.printf("DEBUG: [Config Update] Current AP password in NVS: %.3s***\n", deviceConfig.apPassword.length() > 0 ? deviceConfig.apPassword.c_str() : "(empty/default)");
                             }
-                            String currentAPPassword = preferences.getString("ap_passwd", "");
-                            if (newAPPassword != currentAPPassword) {
-                                preferences.putString("ap_passwd", newAPPassword);
+                            if (newAPPassword != deviceConfig.apPassword) {
+                                configSetString(CFG_AP_PASSWORD, newAPPassword);
                                 configChanged = true;
-                                if (debugEnabled) {
-                                    Serial.printf("DEBUG: [Config Update] ap_password updated to: %s (restart required)\n", newAPPassword.c_str());
-                                }
+                                MCC_LOGD("[Config Update] ap_password updated to: %.3s*** (restart required)\n", newAPPassword.c_str());
                             } else if (debugEnabled) {
-                                Serial.println("DEBUG: [Config Update] ap_password unchanged, no update needed");
+                                logSerial.println("DEBUG: [Config Update] ap_password unchanged, no update needed");
                             }
                         } else if (debugEnabled) {
                             if (newAPPassword.length() > 0) {
-                                Serial.printf("DEBUG: [Config Update] ap_password from server too short (min 8 chars), ignoring (preserving device value): %s\n", newAPPassword.c_str());
+                                logSerial.printf("DEBUG: [Config Update] ap_password from server too short (min 8 chars), ignoring (preserving device value): %.3s***\n", newAPPassword.c_str());
                             } else {
-                                Serial.println("DEBUG: [Config Update] ap_password from server is empty, ignoring (preserving device value)");
+                                logSerial.println("DEBUG: [Config Update] ap_password from server is empty, ignoring (preserving device value)");
                             }
                         }
                     }
@@ -643,27 +760,24 @@ bool fetchDeviceConfig() {
                         // Only update if server provides a real (non-empty) value
                         if (newApiKey.length() > 0) {
                             if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] device_api_key received from server: %s\n", newApiKey.c_str());
-                                Serial.printf("DEBUG: [Config Update] Current API key in NVS: %s\n", apiKey.length() > 0 ? apiKey.c_str() : "(empty/default)");
+                                logSerial.printf("DEBUG: [Config Update] device_api_key received from server: %.3s***\n", newApiKey.c_str());
+                                logSerial.printf("DEBUG: [Config Update] Current API key in NVS: %.3s***\n", apiKey.length() > 0 ? apiKey.c_str() : "(empty/default)");
                             }
                             
                             // Test the new API key before saving it
                             if (testApiKey(newApiKey)) {
                                 // New key works, save it to NVS
-                                preferences.putString("apiKey", newApiKey);
+                                configSetString(CFG_API_KEY, newApiKey);
                                 apiKey = newApiKey;
                                 configChanged = true;
-                                if (debugEnabled) {
-                                    Serial.printf("DEBUG: [Config Update] device_api_key updated to: %s (tested successfully)\n", newApiKey.c_str());
-                                }
+                                MCC_LOGD("[Config Update] device_api_key updated to: %.3s*** (tested successfully)\n", newApiKey.c_str());
                             } else {
                                 // New key doesn't work, keep current key
-                                if (debugEnabled) {
-                                    Serial.println("DEBUG: [Config Update] device_api_key from server failed test, keeping current key");
-                                }
+                                rememberServerHash = false;
+                                MCC_LOGD("[Config Update] device_api_key from server failed test, keeping current key");
                             }
                         } else if (debugEnabled) {
-                            Serial.println("DEBUG: [Config Update] device_api_key from server is empty, ignoring (preserving device value)");
+                            logSerial.println("DEBUG: [Config Update] device_api_key from server is empty, ignoring (preserving device value)");
                         }
                     }
                     
@@ -672,34 +786,112 @@ bool fetchDeviceConfig() {
                         unsigned int newInterval = config["config_fetch_interval_seconds"].as<unsigned int>();
                         // Only update if server provides a real (non-zero) value
                         if (newInterval > 0) {
-                            if (debugEnabled) {
-                                Serial.printf("DEBUG: [Config Update] config_fetch_interval_seconds from server: %u, current: %u\n", newInterval, configFetchInterval_sec);
-                            }
+                            MCC_LOGD("[Config Update] config_fetch_interval_seconds from server: %u, current: %u\n", newInterval, configFetchInterval_sec);
                             if (newInterval != configFetchInterval_sec) {
-                                // NVS key max length is 15 characters, so use shorter key
-                                preferences.putUInt("cfg_fetch_int", newInterval);
+                                configSetUInt(CFG_FETCH_INTERVAL, newInterval);
                                 configFetchInterval_sec = newInterval;  // Update global variable immediately
                                 configChanged = true;
-                                if (debugEnabled) {
-                                    Serial.printf("DEBUG: [Config Update] config_fetch_interval_seconds updated to: %u\n", newInterval);
-                                }
+                                MCC_LOGD("[Config Update] config_fetch_interval_seconds updated to: %u\n", newInterval);
                             } else if (debugEnabled) {
-                                Serial.println("DEBUG: [Config Update] config_fetch_interval_seconds unchanged, no update needed");
+                                logSerial.println("DEBUG: [Config Update] config_fetch_interval_seconds unchanged, no update needed");
                             }
                         } else if (debugEnabled) {
-                            Serial.println("DEBUG: [Config Update] config_fetch_interval_seconds from server is 0, ignoring (preserving device value)");
+                            logSerial.println("DEBUG: [Config Update] config_fetch_interval_seconds from server is 0, ignoring (preserving device value)");
                         }
                     }
                     
-                    if (configChanged) {
+                    // Handle upload_batch_size from server (1 = send every interval on its own)
+                    if (config.containsKey("upload_batch_size")) {
+                        unsigned int newBatchSize = config["upload_batch_size"].as<unsigned int>();
+                        if (newBatchSize > 0) {
+                            newBatchSize = min(newBatchSize, (unsigned int)UPLOAD_BATCH_MAX);
+                            MCC_LOGD("[Config Update] upload_batch_size from server: %u, current: %u\n", newBatchSize, uploadBatchSize);
+                            if (newBatchSize != uploadBatchSize) {
+                                configSetUInt(CFG_UPLOAD_BATCH, newBatchSize);
+                                uploadBatchSize = newBatchSize;  // Update global variable immediately
+                                batchUploadUnsupported = false;  // Probe the batch endpoint again
+                                configChanged = true;
+                                MCC_LOGD("[Config Update] upload_batch_size updated to: %u\n", newBatchSize);
+                            } else if (debugEnabled) {
+                                logSerial.println("DEBUG: [Config Update] upload_batch_size unchanged, no update needed");
+                            }
+                        } else if (debugEnabled) {
+                            logSerial.println("DEBUG: [Config Update] upload_batch_size from server is 0, ignoring (preserving device value)");
+                        }
+                    }
+                    
+                    // Handle low_power_ride from server (light sleep between uploads, ULP counts pulses)
+                    if (config.containsKey("low_power_ride")) {
+                        bool newLowPower = config["low_power_ride"].as<bool>();
+                        MCC_LOGD("[Config Update] low_power_ride from server: %s, current: %s\n", newLowPower ? "true" : "false", lowPowerRide ? "true" : "false");
+                        if (newLowPower != lowPowerRide) {
+                            configSetBool(CFG_LOW_POWER_RIDE, newLowPower);
+                            lowPowerRide = newLowPower;  // Update global variable immediately
+                            configChanged = true;
+                            MCC_LOGD("[Config Update] low_power_ride updated to: %s\n", newLowPower ? "true" : "false");
+                        } else if (debugEnabled) {
+                            logSerial.println("DEBUG: [Config Update] low_power_ride unchanged, no update needed");
+                        }
+                    }
+
+                    // Handle trace_max_bytes from server (ride trace bytes per upload, 0 = off)
+                    if (config.containsKey("trace_max_bytes")) {
+                        unsigned int newTraceBytes = min(config["trace_max_bytes"].as<unsigned int>(), (unsigned int)RIDE_TRACE_MAX_BYTES);
+                        MCC_LOGD("[Config Update] trace_max_bytes from server: %u, current: %u\n", newTraceBytes, traceMaxBytes);
+                        if (newTraceBytes != traceMaxBytes) {
+                            configSetUInt(CFG_TRACE_MAX_BYTES, newTraceBytes);
+                            traceMaxBytes = newTraceBytes;  // Applied with the next upload
+                            configChanged = true;
+                            MCC_LOGD("[Config Update] trace_max_bytes updated to: %u\n", newTraceBytes);
+                        } else if (debugEnabled) {
+                            logSerial.println("DEBUG: [Config Update] trace_max_bytes unchanged, no update needed");
+                        }
+                    }
+
+                    // Handle trace_interval_seconds from server (0 = a trace with every upload)
+                    if (config.containsKey("trace_interval_seconds")) {
+                        unsigned int newTraceInterval = config["trace_interval_seconds"].as<unsigned int>();
+                        MCC_LOGD("[Config Update] trace_interval_seconds from server: %u, current: %u\n", newTraceInterval, traceInterval_sec);
+                        if (newTraceInterval != traceInterval_sec) {
+                            configSetUInt(CFG_TRACE_INTERVAL, newTraceInterval);
+                            traceInterval_sec = newTraceInterval;
+                            configChanged = true;
+                            MCC_LOGD("[Config Update] trace_interval_seconds updated to: %u\n", newTraceInterval);
+                        } else if (debugEnabled) {
+                            logSerial.println("DEBUG: [Config Update] trace_interval_seconds unchanged, no update needed");
+                        }
+                    }
+
+                    // Handle static_ip from server ("ip,gateway,subnet[,dns]", empty = DHCP)
+                    if (config.containsKey("static_ip")) {
+                        String newStaticIp = config["static_ip"].as<String>();
+                        newStaticIp.trim();
+                        IPAddress ip, gateway, subnet, dns;
                         if (debugEnabled) {
-                            Serial.println("DEBUG: [Config Update] Configuration updated from server. Restart recommended.");
+                            logSerial.printf("DEBUG: [Config Update] static_ip from server: '%s', current: '%s'\n",
+                                newStaticIp.c_str(), staticIp.c_str());
+                        }
+                        if (newStaticIp.length() > 0 && !staticIpParse(newStaticIp, &ip, &gateway, &subnet, &dns)) {
+                            MCC_LOGD("[Config Update] static_ip from server is malformed, ignoring (preserving device value)");
+                        } else if (newStaticIp != staticIp) {
+                            configSetString(CFG_STATIC_IP, newStaticIp);
+                            staticIp = newStaticIp;  // Used from the next WiFi connection on
+                            configChanged = true;
+                            MCC_LOGD("[Config Update] static_ip updated to: '%s'\n", staticIp.c_str());
+                        } else if (debugEnabled) {
+                            logSerial.println("DEBUG: [Config Update] static_ip unchanged, no update needed");
                         }
+                    }
+                    
+                    // All changed fields with a single NVS commit
+                    if (!configCommitServer(rememberServerHash ? serverHash : 0)) {
+                        MCC_LOGE("[Config Update] Failed to save configuration to NVS");
+                    }
+                    if (configChanged) {
+                        MCC_LOGD("[Config Update] Configuration updated from server. Restart recommended.");
                         // Note: We don't auto-restart here, let the user decide or restart manually
                     } else {
-                        if (debugEnabled) {
-                            Serial.println("DEBUG: [Config Update] Configuration is already in sync - no changes needed.");
-                        }
+                        MCC_LOGD("[Config Update] Configuration is already in sync - no changes needed.");
                     }
                 }
             }
@@ -707,57 +899,27 @@ bool fetchDeviceConfig() {
             // Check for API key errors (401, 403)
             if (httpCode == 401 || httpCode == 403) {
                 apiKeyErrorActive = true;
-                if (debugEnabled) {
-                    Serial.printf("DEBUG: [fetchDeviceConfig] API key error detected (HTTP %d). Setting apiKeyErrorActive = true\n", httpCode);
-                }
+                MCC_LOGD("[fetchDeviceConfig] API key error detected (HTTP %d). Setting apiKeyErrorActive = true\n", httpCode);
             }
             
             // Show specific error message for device not found (404)
             if (httpCode == 404) {
                 #ifdef ENABLE_OLED
                 // Show specific message for device not found
-                display.clearBuffer();
-                display.setFont(u8g2_font_7x14_tf);
-                
-                String textline = "Fehler:";
-                int textWidth = display.getStrWidth(textline.c_str());
-                display.setCursor((128 - textWidth) / 2, 12);
-                display.print(textline);
-                
-                textline = "Gerät nicht";
-                textWidth = display.getStrWidth(textline.c_str());
-                display.setCursor((128 - textWidth) / 2, 28);
-                display.print(textline);
-                
-                textline = "gefunden";
-                textWidth = display.getStrWidth(textline.c_str());
-                display.setCursor((128 - textWidth) / 2, 44);
-                display.print(textline);
-                
-                display.sendBuffer();
-                delay(3000);
+                UiScreen screen;
+                uiScreenInit(&screen, 3000);
+                uiScreenAddLine(&screen, 12, "Fehler:");
+                uiScreenAddLine(&screen, 28, "Gerät nicht");
+                uiScreenAddLine(&screen, 44, "gefunden");
+                uiShowScreen(screen);
                 #endif
                 digitalWrite(LED_PIN, LOW);
             }
             
-            if (debugEnabled) {
-                Serial.printf("DEBUG: [fetchDeviceConfig] HTTP error: %d\n", httpCode);
-                String errorResponse = http.getString();
-                Serial.print("DEBUG: [fetchDeviceConfig] Error response: ");
-                Serial.println(errorResponse);
-            }
-        }
-    } else {
-        if (debugEnabled) {
-            Serial.printf("DEBUG: [fetchDeviceConfig] Connection error: %s\n", http.errorToString(httpCode).c_str());
+            MCC_LOGD("[fetchDeviceConfig] HTTP error: %d\n", httpCode);
         }
     }
 
-    http.end();
-    digitalWrite(LED_PIN, LOW);  // Turn off LED after completion
-    if (debugEnabled) {
-        Serial.printf("DEBUG: [fetchDeviceConfig] Returning: %s\n", success ? "true" : "false");
-    }
     return success;
 }
 
@@ -770,56 +932,50 @@ bool sendHeartbeat() {
     
     if (serverUrl.length() == 0 || WiFi.status() != WL_CONNECTED) {
         digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-        if (debugEnabled) {
-            Serial.println("DEBUG: sendHeartbeat: No connection or configuration error.");
-        }
+        MCC_LOGD("sendHeartbeat: No connection or configuration error.");
         return false;
     }
 
-    HTTPClient http;
-    StaticJsonDocument<256> doc;
-    
-    String finalDeviceId = deviceName;
-    if (finalDeviceId.length() > 0) {
-        finalDeviceId += deviceIdSuffix;
-    }
+    HttpSession session;
+    HTTPClient& http = session.http();
+    StaticJsonDocument<1024> doc;
     
-    doc["device_id"] = finalDeviceId;
+    apiWireHeartbeat(doc.to<JsonObject>(), deviceIdFull(), ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap());
     appendPendingBootReasonToJson(doc.as<JsonObject>());
+    appendBootTimelineToJson(doc.as<JsonObject>());
+    metricsAppendSummary(doc.as<JsonObject>());
 
-    String jsonPayload;
-    serializeJson(doc, jsonPayload);
+    char jsonPayload[768];
+    size_t payloadLen = serializeJson(doc, jsonPayload, sizeof(jsonPayload));
 
-    String finalUrl = serverUrl;
-    if (finalUrl.endsWith("/")) {
-        finalUrl.remove(finalUrl.length() - 1);
-    }
-    finalUrl += API_DEVICE_HEARTBEAT_PATH;
+    const char* finalUrl = apiUrl(API_EP_HEARTBEAT);
 
     if (debugEnabled) {
-        Serial.print("DEBUG: Sending heartbeat to: ");
-        Serial.println(finalUrl);
+        logSerial.print("DEBUG: Sending heartbeat to: ");
+        logSerial.println(finalUrl);
     }
 
-    http.begin(finalUrl);
+    session.begin(finalUrl, METRIC_EP_HEARTBEAT);
     http.addHeader("Content-Type", "application/json");
     if (apiKey.length() > 0) {
         http.addHeader("X-Api-Key", apiKey);
     }
     
-    int httpCode = http.POST(jsonPayload);
+    // Only called from loop(), so one static buffer is enough
+    static char response[1024];
+    int httpCode = session.recordResult(payloadExchange(http, jsonPayload, payloadLen, response, sizeof(response), nullptr));
     
     bool success = false;
     if (httpCode > 0) {
         if (httpCode == HTTP_CODE_OK) {
-            String response = http.getString();
             if (debugEnabled) {
-                Serial.println("DEBUG: Heartbeat response:");
-                Serial.println(response);
+                logSerial.println("DEBUG: Heartbeat response:");
+                logSerial.println(response);
             }
             
             StaticJsonDocument<512> responseDoc;
-            DeserializationError error = deserializeJson(responseDoc, response);
+            // const input: ArduinoJson would otherwise parse in place and applyDisplayVelosFromResponse() reads it again
+            DeserializationError error = deserializeJson(responseDoc, (const char*)response);
             
             if (!error && responseDoc.containsKey("success")) {
                 success = responseDoc["success"].as<bool>();
@@ -828,18 +984,13 @@ bool sendHeartbeat() {
                 lastHeartbeatTime = millis();
                 preferences.putULong64("last_hb_time", lastHeartbeatTime);
 
-                String responseJson = response;
-                applyDisplayVelosFromResponse(responseJson);
+                applyDisplayVelosFromResponse(response);
             }
         } else {
-            if (debugEnabled) {
-                Serial.printf("DEBUG: Heartbeat HTTP error: %d\n", httpCode);
-            }
+            MCC_LOGD("Heartbeat HTTP error: %d\n", httpCode);
         }
     } else {
-        if (debugEnabled) {
-            Serial.printf("DEBUG: Heartbeat connection error: %s\n", http.errorToString(httpCode).c_str());
-        }
+        MCC_LOGD("Heartbeat connection error: %s\n", http.errorToString(httpCode).c_str());
     }
 
     http.end();
@@ -847,6 +998,42 @@ bool sendHeartbeat() {
     return success;
 }
 
+/**
+ * @brief Stores version, SHA-256 and size of an available update for downloadFirmware().
+ *
+ * @param info firmware/info response or the "firmware" object of a sync response
+ * @return Value of update_available
+ */
+static bool storeFirmwareInfo(JsonVariantConst info) {
+    const bool updateAvailable = info["update_available"] | false;
+    if (!updateAvailable) {
+        pendingFirmwareVersion = "";  // Clear pending version if no update
+        pendingFirmwareSha256 = "";
+        pendingFirmwareSize = 0;
+        MCC_LOGD("Firmware is up to date.");
+        return false;
+    }
+
+    // Store the available version for later use after successful update
+    pendingFirmwareVersion = info["available_version"] | "";
+    if (debugEnabled) {
+        if (pendingFirmwareVersion.length() > 0) {
+            logSerial.println("DEBUG: Firmware update available!");
+            logSerial.printf("DEBUG: Available version: %s\n", pendingFirmwareVersion.c_str());
+        } else {
+            logSerial.println("DEBUG: Firmware update available, but version not in response!");
+        }
+    }
+    // Used to verify the image and to resume an interrupted download
+    pendingFirmwareSha256 = info["checksum_sha256"] | "";
+    pendingFirmwareSize = info["file_size"] | 0;
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: Image size: %u bytes, SHA-256: %s\n", (unsigned)pendingFirmwareSize,
+                      pendingFirmwareSha256.length() > 0 ? pendingFirmwareSha256.c_str() : "(not provided)");
+    }
+    return true;
+}
+
 /**
  * @brief Checks if a firmware update is available.
  */
@@ -856,128 +1043,90 @@ bool checkFirmwareUpdate() {
     
     if (serverUrl.length() == 0 || WiFi.status() != WL_CONNECTED) {
         digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-        if (debugEnabled) {
-            Serial.println("DEBUG: checkFirmwareUpdate: No connection or configuration error.");
-        }
+        MCC_LOGD("checkFirmwareUpdate: No connection or configuration error.");
         return false;
     }
 
-    HTTPClient http;
-    
-    String finalDeviceId = deviceName;
-    if (finalDeviceId.length() > 0) {
-        finalDeviceId += deviceIdSuffix;
-    }
+    HttpSession session;
+    HTTPClient& http = session.http();
     
-    String currentVersion = getFirmwareVersion();
-
-    String finalUrl = serverUrl;
-    if (finalUrl.endsWith("/")) {
-        finalUrl.remove(finalUrl.length() - 1);
-    }
-    finalUrl += API_DEVICE_FIRMWARE_INFO_PATH;
-    finalUrl += "?device_id=" + finalDeviceId;
-    finalUrl += "&current_version=" + currentVersion;
+    String finalUrl = buildApiUrl(API_DEVICE_FIRMWARE_INFO_PATH);
+    finalUrl += "?device_id=";
+    finalUrl += deviceIdFull();
+    finalUrl += "&current_version=" + getFirmwareVersion();
 
     if (debugEnabled) {
-        Serial.print("DEBUG: Checking firmware update from: ");
-        Serial.println(finalUrl);
+        logSerial.print("DEBUG: Checking firmware update from: ");
+        logSerial.println(finalUrl);
     }
 
-    http.begin(finalUrl);
+    session.begin(finalUrl, METRIC_EP_FIRMWARE);
     http.addHeader("Content-Type", "application/json");
     if (apiKey.length() > 0) {
         http.addHeader("X-Api-Key", apiKey);
     }
     
-    int httpCode = http.GET();
+    int httpCode = session.recordResult(http.GET());
     
     bool updateAvailable = false;
     if (httpCode > 0) {
         if (httpCode == HTTP_CODE_OK) {
             String response = http.getString();
             if (debugEnabled) {
-                Serial.println("DEBUG: Firmware info response:");
-                Serial.println(response);
+                logSerial.println("DEBUG: Firmware info response:");
+                logSerial.println(response);
             }
             
             // Increase JSON document size to handle full firmware info response
             // Response includes: success, update_available, current_version, available_version,
-            // firmware_name, file_size, checksum_md5, download_url, message
-            StaticJsonDocument<800> responseDoc;
+            // firmware_name, file_size, checksum_md5, checksum_sha256, download_url, message
+            StaticJsonDocument<1024> responseDoc;
             DeserializationError error = deserializeJson(responseDoc, response);
             
             if (error) {
-                if (debugEnabled) {
-                    Serial.printf("DEBUG: JSON parse error: %s\n", error.c_str());
-                }
+                MCC_LOGD("JSON parse error: %s\n", error.c_str());
             } else {
-                if (debugEnabled) {
-                    Serial.println("DEBUG: JSON parsed successfully");
-                }
+                MCC_LOGD("JSON parsed successfully");
                 
                 if (responseDoc.containsKey("success")) {
                     bool success = responseDoc["success"].as<bool>();
                     
                     if (debugEnabled) {
-                        Serial.printf("DEBUG: Parsed success: %s\n", success ? "true" : "false");
-                        Serial.printf("DEBUG: Has update_available key: %s\n", 
+                        logSerial.printf("DEBUG: Parsed success: %s\n", success ? "true" : "false");
+                        logSerial.printf("DEBUG: Has update_available key: %s\n", 
                             responseDoc.containsKey("update_available") ? "true" : "false");
                     }
                     
                     if (success && responseDoc.containsKey("update_available")) {
-                        updateAvailable = responseDoc["update_available"].as<bool>();
-                        
                         if (debugEnabled) {
-                            Serial.printf("DEBUG: Parsed update_available: %s\n", updateAvailable ? "true" : "false");
+                            logSerial.printf("DEBUG: Parsed update_available: %s\n",
+                                          responseDoc["update_available"].as<bool>() ? "true" : "false");
                         }
                         
-                        if (updateAvailable) {
-                            // Store the available version for later use after successful update
-                            if (responseDoc.containsKey("available_version")) {
-                                pendingFirmwareVersion = responseDoc["available_version"].as<String>();
-                                if (debugEnabled) {
-                                    Serial.println("DEBUG: Firmware update available!");
-                                    Serial.printf("DEBUG: Available version: %s\n", pendingFirmwareVersion.c_str());
-                                }
-                            } else {
-                                if (debugEnabled) {
-                                    Serial.println("DEBUG: Firmware update available, but version not in response!");
-                                }
-                            }
-                        } else {
-                            pendingFirmwareVersion = "";  // Clear pending version if no update
-                            if (debugEnabled) {
-                                Serial.println("DEBUG: Firmware is up to date.");
-                            }
-                        }
+                        updateAvailable = storeFirmwareInfo(responseDoc.as<JsonVariantConst>());
                     } else {
                         if (debugEnabled) {
-                            Serial.println("DEBUG: Response missing 'success' or 'update_available' field");
+                            logSerial.println("DEBUG: Response missing 'success' or 'update_available' field");
                             if (!success) {
-                                Serial.println("DEBUG: success field is false");
+                                logSerial.println("DEBUG: success field is false");
                             }
                             if (!responseDoc.containsKey("update_available")) {
-                                Serial.println("DEBUG: update_available key not found in response");
+                                logSerial.println("DEBUG: update_available key not found in response");
                             }
                         }
                     }
                 } else {
-                    if (debugEnabled) {
-                        Serial.println("DEBUG: Response does not contain 'success' field");
-                    }
+                    MCC_LOGD("Response does not contain 'success' field");
                 }
             }
         } else {
             if (debugEnabled) {
-                Serial.printf("DEBUG: Firmware info HTTP error: %d\n", httpCode);
-                Serial.println(http.getString());
+                logSerial.printf("DEBUG: Firmware info HTTP error: %d\n", httpCode);
+                logSerial.println(http.getString());
             }
         }
     } else {
-        if (debugEnabled) {
-            Serial.printf("DEBUG: Firmware info connection error: %s\n", http.errorToString(httpCode).c_str());
-        }
+        MCC_LOGD("Firmware info connection error: %s\n", http.errorToString(httpCode).c_str());
     }
 
     http.end();
@@ -991,6 +1140,152 @@ bool checkFirmwareUpdate() {
     return updateAvailable;
 }
 
+static StaticJsonDocument<768> buildDeviceSyncFilter() {
+    StaticJsonDocument<768> filter;
+    filter.set(deviceConfigFilter());
+    JsonObject firmware = filter.createNestedObject("firmware");
+    firmware["update_available"] = true;
+    firmware["available_version"] = true;
+    firmware["file_size"] = true;
+    firmware["checksum_sha256"] = true;
+    filter["config_report"]["has_differences"] = true;
+    filter["display_mode"] = true;
+    filter["display_velos_display"] = true;
+    filter["session_velos_display"] = true;
+    filter["session_epoch"] = true;
+    return filter;
+}
+
+static const JsonDocument& deviceSyncFilter() {
+    static const StaticJsonDocument<768> filter = buildDeviceSyncFilter();
+    return filter;
+}
+
+bool deviceSyncSupported() {
+    return !syncUnsupported;
+}
+
+/**
+ * @brief One round trip replacing heartbeat, config report/fetch and firmware check.
+ */
+SyncResult syncDevice(bool reportConfig, bool* updateAvailable) {
+    if (updateAvailable != nullptr) {
+        *updateAvailable = false;
+    }
+    if (syncUnsupported) {
+        return SYNC_UNSUPPORTED;
+    }
+
+    // Turn on LED to indicate WiFi activity
+    digitalWrite(LED_PIN, HIGH);
+
+    if (serverUrl.length() == 0 || WiFi.status() != WL_CONNECTED) {
+        digitalWrite(LED_PIN, LOW);  // Turn off LED on error
+        MCC_LOGD("syncDevice: No connection or configuration error.");
+        return SYNC_FAILED;
+    }
+
+    #ifdef ENABLE_OLED
+    if (reportConfig) {
+        display_ConfigCheck();
+    }
+    #endif
+
+    StaticJsonDocument<1536> doc;
+    apiWireHeartbeat(doc.to<JsonObject>(), deviceIdFull(), ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap());
+    doc["firmware_version"] = getFirmwareVersion();
+    // The server only sends the config if its hash differs
+    doc["config_hash"] = deviceConfig.serverHash;
+    const bool hadBootReason = appendPendingBootReasonToJson(doc.as<JsonObject>());
+    const bool hadBootTimeline = appendBootTimelineToJson(doc.as<JsonObject>());
+    metricsAppendSummary(doc.as<JsonObject>());
+    if (reportConfig) {
+        doc["config_report"] = createConfigJson();
+    }
+
+    String jsonPayload;
+    serializeJson(doc, jsonPayload);
+
+    const char* finalUrl = apiUrl(API_EP_SYNC);
+    if (debugEnabled) {
+        logSerial.print("DEBUG: [syncDevice] Syncing with: ");
+        logSerial.println(finalUrl);
+        logSerial.println(jsonPayload);
+    }
+
+    // Only called from loop(); static keeps the document off the loop task stack
+    static StaticJsonDocument<DEVICE_SYNC_DOC_SIZE> responseDoc;
+    responseDoc.clear();
+    DeserializationError error;
+    int httpCode;
+    {
+        // Release the shared connection before applying: the API key test issues its own request
+        HttpSession session;
+        HTTPClient& http = session.http();
+        session.begin(finalUrl, METRIC_EP_SYNC);
+        http.addHeader("Content-Type", "application/json");
+        if (apiKey.length() > 0) {
+            http.addHeader("X-Api-Key", apiKey);
+        }
+        httpCode = session.recordResult(payloadExchangeFiltered(http, jsonPayload.c_str(), jsonPayload.length(),
+                                                                responseDoc, deviceSyncFilter(), &error));
+        if (httpCode <= 0 && debugEnabled) {
+            logSerial.printf("DEBUG: [syncDevice] Connection error: %s\n", http.errorToString(httpCode).c_str());
+        }
+        http.end();
+    }
+
+    if (httpCode == 404 || httpCode == 405) {
+        // Older server (or unknown device, which the separate calls then report):
+        // the separate endpoints are used until the next restart
+        syncUnsupported = true;
+        if (hadBootReason) {
+            setPendingBootReason(doc["boot_reason"] | "");
+        }
+        if (hadBootTimeline) {
+            bootProfile.reported = false;  // Goes with the separate heartbeat
+        }
+        digitalWrite(LED_PIN, LOW);
+        MCC_LOGD("[syncDevice] Server does not support sync (HTTP %d), using separate requests\n", httpCode);
+        return SYNC_UNSUPPORTED;
+    }
+
+    if (httpCode != HTTP_CODE_OK || error || !(responseDoc["success"] | false)) {
+        if (httpCode == 401 || httpCode == 403) {
+            apiKeyErrorActive = true;
+        }
+        digitalWrite(LED_PIN, LOW);
+        MCC_LOGD("[syncDevice] Failed (HTTP %d, parse: %s)\n", httpCode, error.c_str());
+        return SYNC_FAILED;
+    }
+
+    apiKeyErrorActive = false;
+    lastHeartbeatTime = millis();
+    preferences.putULong64("last_hb_time", lastHeartbeatTime);
+
+    if (debugEnabled && responseDoc["config_report"]["has_differences"].as<bool>()) {
+        logSerial.println("DEBUG: Configuration differences detected!");
+    }
+
+    if (responseDoc.containsKey("config")) {
+        applyDeviceConfigDocument(httpCode, responseDoc, error);
+    } else if (debugEnabled) {
+        logSerial.printf("DEBUG: [syncDevice] Configuration unchanged (config hash %08X)\n", (unsigned)deviceConfig.serverHash);
+    }
+
+    const bool update = storeFirmwareInfo(responseDoc["firmware"]);
+    if (updateAvailable != nullptr) {
+        *updateAvailable = update;
+    }
+    lastFirmwareCheckTime = millis();
+    preferences.putULong64("last_fw_chk", lastFirmwareCheckTime);
+
+    applyDisplayVelosFromDocument(responseDoc.as<JsonVariantConst>());
+
+    digitalWrite(LED_PIN, LOW);  // Turn off LED after completion
+    return SYNC_OK;
+}
+
 /**
  * @brief Downloads and installs firmware update from the server.
  */
@@ -1000,148 +1295,127 @@ bool downloadFirmware() {
     
     if (serverUrl.length() == 0 || WiFi.status() != WL_CONNECTED) {
         digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-        if (debugEnabled) {
-            Serial.println("DEBUG: downloadFirmware: No connection or configuration error.");
-        }
+        MCC_LOGD("downloadFirmware: No connection or configuration error.");
         return false;
     }
 
-    HTTPClient http;
-    
-    String finalDeviceId = deviceName;
-    if (finalDeviceId.length() > 0) {
-        finalDeviceId += deviceIdSuffix;
+    // Resume needs the size and an identity of the image from firmware/info
+    const String& imageId = pendingFirmwareSha256.length() > 0 ? pendingFirmwareSha256 : pendingFirmwareVersion;
+    int32_t resumeAt = otaBegin(pendingFirmwareSize, imageId.c_str(), pendingFirmwareSha256.c_str(), false);
+    if (resumeAt < 0) {
+        digitalWrite(LED_PIN, LOW);  // Turn off LED on error
+        return false;
     }
 
-    String finalUrl = serverUrl;
-    if (finalUrl.endsWith("/")) {
-        finalUrl.remove(finalUrl.length() - 1);
-    }
-    finalUrl += API_DEVICE_FIRMWARE_DOWNLOAD_PATH;
-    finalUrl += "?device_id=" + finalDeviceId;
+    HttpSession session;
+    HTTPClient& http = session.http();
+    
+    String finalUrl = buildApiUrl(API_DEVICE_FIRMWARE_DOWNLOAD_PATH);
+    finalUrl += "?device_id=";
+    finalUrl += deviceIdFull();
 
     if (debugEnabled) {
-        Serial.print("DEBUG: Downloading firmware from: ");
-        Serial.println(finalUrl);
+        logSerial.print("DEBUG: Downloading firmware from: ");
+        logSerial.println(finalUrl);
     }
 
-    http.begin(finalUrl);
+    session.begin(finalUrl, METRIC_EP_FIRMWARE);
     if (apiKey.length() > 0) {
         http.addHeader("X-Api-Key", apiKey);
     }
+    if (resumeAt > 0) {
+        char range[32];
+        snprintf(range, sizeof(range), "bytes=%ld-", (long)resumeAt);
+        http.addHeader("Range", range);
+        MCC_LOGD("Resuming firmware download at %ld bytes\n", (long)resumeAt);
+    }
+    const char* headerKeys[] = {"X-Firmware-Version"};
+    http.collectHeaders(headerKeys, 1);
     
-    int httpCode = http.GET();
+    int httpCode = session.recordResult(http.GET());
     
-    if (httpCode > 0) {
-        if (httpCode == HTTP_CODE_OK) {
-            // Get content length
-            int contentLength = http.getSize();
+    if (httpCode == HTTP_CODE_OK && resumeAt > 0) {
+        // Server ignored the Range request and sends the whole image
+        MCC_LOGD("Server does not support resume, downloading the whole image");
+        resumeAt = otaBegin(pendingFirmwareSize, imageId.c_str(), pendingFirmwareSha256.c_str(), true);
+    }
+
+    if (httpCode == HTTP_CODE_OK || (httpCode == HTTP_CODE_PARTIAL_CONTENT && resumeAt > 0)) {
+        // Bytes still to download
+        int contentLength = http.getSize();
+        if (debugEnabled) {
+            logSerial.printf("DEBUG: Firmware size: %u bytes, %d bytes to download\n",
+                          (unsigned)pendingFirmwareSize, contentLength);
+        }
+
+        if (httpCode == HTTP_CODE_OK && contentLength > 0 && (uint32_t)contentLength != pendingFirmwareSize) {
+            // Size in firmware/info missing or outdated: the downloaded file counts
+            pendingFirmwareSize = (uint32_t)contentLength;
+            resumeAt = otaBegin(pendingFirmwareSize, imageId.c_str(), pendingFirmwareSha256.c_str(), true);
+        }
+        if (contentLength <= 0 || resumeAt < 0 || (uint32_t)(resumeAt + contentLength) != pendingFirmwareSize) {
+            digitalWrite(LED_PIN, LOW);  // Turn off LED on error
+            MCC_LOGD("Invalid firmware size!");
+            otaAbort(false);
+            http.end();
+            return false;
+        }
+
+        #ifdef ENABLE_OLED
+        display_FirmwareUpdate();
+        #endif
+
+        // Sector-sized reads straight into the flash buffer, no available() polling
+        unsigned long startMs = millis();
+        uint32_t received = otaWriteFromStream(*http.getStreamPtr(), (uint32_t)contentLength);
+        if (debugEnabled) {
+            unsigned long elapsedMs = max(millis() - startMs, 1UL);
+            logSerial.printf("DEBUG: Downloaded %u / %d bytes in %lu ms (%lu KB/s)\n",
+                          (unsigned)received, contentLength, elapsedMs,
+                          (unsigned long)((uint64_t)received * 1000 / 1024 / elapsedMs));
+        }
+
+        if (received == (uint32_t)contentLength && otaFinish()) {
+            // Firmware version is now always read from build flag (FIRMWARE_VERSION)
+            // No need to update NVS - the new firmware binary contains the correct version
             if (debugEnabled) {
-                Serial.printf("DEBUG: Firmware size: %d bytes\n", contentLength);
-            }
-            
-            if (contentLength > 0) {
-                #ifdef ENABLE_OLED
-                display_FirmwareUpdate();
-                #endif
-                
-                // Begin update
-                        if (!Update.begin(contentLength)) {
-                            digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-                            if (debugEnabled) {
-                                Serial.println("DEBUG: Update.begin() failed!");
-                                Update.printError(Serial);
-                            }
-                            http.end();
-                            return false;
-                        }
-                
-                // Download and write firmware in chunks
-                WiFiClient* stream = http.getStreamPtr();
-                uint8_t buffer[512];
-                size_t written = 0;
-                
-                while (http.connected() && (written < contentLength)) {
-                    size_t available = stream->available();
-                    if (available) {
-                        size_t toRead = (available > sizeof(buffer)) ? sizeof(buffer) : available;
-                        size_t bytesRead = stream->readBytes(buffer, toRead);
-                        
-                        if (Update.write(buffer, bytesRead) != bytesRead) {
-                            digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-                            if (debugEnabled) {
-                                Serial.println("DEBUG: Update.write() failed!");
-                                Update.printError(Serial);
-                            }
-                            Update.abort();
-                            http.end();
-                            return false;
-                        }
-                        
-                        written += bytesRead;
-                        
-                        if (debugEnabled && (written % 10240 == 0)) {
-                            Serial.printf("DEBUG: Downloaded %d / %d bytes\n", written, contentLength);
-                        }
-                    }
-                    delay(1);
+                String newVersion = pendingFirmwareVersion;
+                if (newVersion.length() == 0) {
+                    // Try to get version from response header for logging
+                    newVersion = http.header("X-Firmware-Version");
                 }
-                
-                // End update
-                if (Update.end()) {
-                    if (Update.isFinished()) {
-                        // Firmware version is now always read from build flag (FIRMWARE_VERSION)
-                        // No need to update NVS - the new firmware binary contains the correct version
-                        if (debugEnabled) {
-                        String newVersion = pendingFirmwareVersion;
-                        if (newVersion.length() == 0) {
-                                // Try to get version from response header for logging
-                                newVersion = http.header("X-Firmware-Version");
-                            }
-                        if (newVersion.length() > 0) {
-                                Serial.printf("DEBUG: Firmware update successful! New version: %s (will be read from binary on restart)\n", newVersion.c_str());
-                        } else {
-                                Serial.println("DEBUG: Firmware update successful! Version will be read from binary on restart.");
-                            }
-                            Serial.println("DEBUG: Restarting...");
-                        }
-                        http.end();
-                        delay(1000);
-                        ESP.restart();
-                        return true; // This will never be reached, but compiler is happy
-                    } else {
-                        digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-                        if (debugEnabled) {
-                            Serial.println("DEBUG: Update not finished!");
-                        }
-                        Update.abort();
-                    }
+                if (newVersion.length() > 0) {
+                    logSerial.printf("DEBUG: Firmware update successful! New version: %s (will be read from binary on restart)\n", newVersion.c_str());
                 } else {
-                    digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-                    if (debugEnabled) {
-                        Serial.println("DEBUG: Update.end() failed!");
-                        Update.printError(Serial);
-                    }
-                }
-            } else {
-                digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-                if (debugEnabled) {
-                    Serial.println("DEBUG: Invalid firmware size!");
+                    logSerial.println("DEBUG: Firmware update successful! Version will be read from binary on restart.");
                 }
+                logSerial.println("DEBUG: Restarting...");
             }
-        } else {
-            digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-            if (debugEnabled) {
-                Serial.printf("DEBUG: Firmware download HTTP error: %d\n", httpCode);
-                String response = http.getString();
-                Serial.println(response);
-            }
+            http.end();
+            delay(1000);
+            mccLogFlush();
+            ESP.restart();
+            return true; // This will never be reached, but compiler is happy
         }
-    } else {
+
         digitalWrite(LED_PIN, LOW);  // Turn off LED on error
+        if (received != (uint32_t)contentLength) {
+            // Connection lost: keep what is in flash for the next attempt
+            otaAbort(true);
+        }
+        MCC_LOGD("Firmware update failed!");
+    } else if (httpCode > 0) {
+        digitalWrite(LED_PIN, LOW);  // Turn off LED on error
+        otaAbort(httpCode != HTTP_CODE_RANGE_NOT_SATISFIABLE);
         if (debugEnabled) {
-            Serial.printf("DEBUG: Firmware download connection error: %s\n", http.errorToString(httpCode).c_str());
+            logSerial.printf("DEBUG: Firmware download HTTP error: %d\n", httpCode);
+            String response = http.getString();
+            logSerial.println(response);
         }
+    } else {
+        digitalWrite(LED_PIN, LOW);  // Turn off LED on error
+        otaAbort(true);
+        MCC_LOGD("Firmware download connection error: %s\n", http.errorToString(httpCode).c_str());
     }
 
     http.end();
@@ -1157,42 +1431,32 @@ bool downloadFirmware() {
  */
 bool testApiKey(const String& testKey) {
     if (testKey.length() == 0 || serverUrl.length() == 0 || WiFi.status() != WL_CONNECTED) {
-        if (debugEnabled) {
-            Serial.println("DEBUG: [testApiKey] Cannot test: no key, no server URL, or no WiFi connection");
-        }
+        MCC_LOGD("[testApiKey] Cannot test: no key, no server URL, or no WiFi connection");
         return false;
     }
 
-    HTTPClient http;
+    HttpSession session;
+    HTTPClient& http = session.http();
     
-    String finalDeviceId = deviceName;
-    if (finalDeviceId.length() > 0) {
-        finalDeviceId += deviceIdSuffix;
-    }
-
     // Use heartbeat endpoint for testing (lightweight request)
-    String finalUrl = serverUrl;
-    if (finalUrl.endsWith("/")) {
-        finalUrl.remove(finalUrl.length() - 1);
-    }
-    finalUrl += API_DEVICE_HEARTBEAT_PATH;
+    const char* finalUrl = apiUrl(API_EP_HEARTBEAT);
 
     if (debugEnabled) {
-        Serial.print("DEBUG: [testApiKey] Testing API key with heartbeat request to: ");
-        Serial.println(finalUrl);
+        logSerial.print("DEBUG: [testApiKey] Testing API key with heartbeat request to: ");
+        logSerial.println(finalUrl);
     }
 
-    http.begin(finalUrl);
+    session.begin(finalUrl, METRIC_EP_HEARTBEAT);
     http.addHeader("Content-Type", "application/json");
     http.addHeader("X-Api-Key", testKey);
     
     // Create minimal JSON payload
     StaticJsonDocument<100> doc;
-    doc["device_id"] = finalDeviceId;
+    doc["device_id"] = deviceIdFull();
     String jsonPayload;
     serializeJson(doc, jsonPayload);
     
-    int httpCode = http.POST(jsonPayload);
+    int httpCode = session.recordResult(http.POST(jsonPayload));
     
     bool success = false;
     if (httpCode > 0) {
@@ -1201,25 +1465,17 @@ bool testApiKey(const String& testKey) {
         // Other codes mean server error or unexpected response
         if (httpCode == HTTP_CODE_OK) {
             success = true;
-            if (debugEnabled) {
-                Serial.printf("DEBUG: [testApiKey] API key test successful (HTTP %d) - key is valid\n", httpCode);
-            }
+            MCC_LOGD("[testApiKey] API key test successful (HTTP %d) - key is valid\n", httpCode);
         } else if (httpCode == 401 || httpCode == 403) {
-            if (debugEnabled) {
-                Serial.printf("DEBUG: [testApiKey] API key test failed: Unauthorized/Forbidden (HTTP %d) - key is invalid\n", httpCode);
-            }
+            MCC_LOGD("[testApiKey] API key test failed: Unauthorized/Forbidden (HTTP %d) - key is invalid\n", httpCode);
             success = false;
         } else {
-            if (debugEnabled) {
-                Serial.printf("DEBUG: [testApiKey] API key test returned unexpected HTTP code: %d - keeping current key\n", httpCode);
-            }
+            MCC_LOGD("[testApiKey] API key test returned unexpected HTTP code: %d - keeping current key\n", httpCode);
             // For other codes, we're conservative and don't update (server error, etc.)
             success = false;
         }
     } else {
-        if (debugEnabled) {
-            Serial.printf("DEBUG: [testApiKey] API key test connection error: %s - keeping current key\n", http.errorToString(httpCode).c_str());
-        }
+        MCC_LOGD("[testApiKey] API key test connection error: %s - keeping current key\n", http.errorToString(httpCode).c_str());
         success = false;
     }
 
@@ -1257,67 +1513,60 @@ bool shouldCheckFirmware() {
     return (now - lastFirmwareCheckTime >= FIRMWARE_CHECK_INTERVAL_MS);
 }
 
-bool applyDisplayVelosFromResponse(const String& response) {
-    if (response.length() == 0) {
+bool applyDisplayVelosFromResponse(const char* response) {
+    if (response == nullptr || response[0] == '\0') {
         return false;
     }
 
     StaticJsonDocument<512> responseDoc;
     DeserializationError error = deserializeJson(responseDoc, response);
     if (error) {
-        if (debugEnabled) {
-            Serial.printf("DEBUG: display_velos JSON parse error: %s\n", error.c_str());
-        }
+        MCC_LOGD("display_velos JSON parse error: %s\n", error.c_str());
         return false;
     }
+    return applyDisplayVelosFromDocument(responseDoc.as<JsonVariantConst>());
+}
 
-    String displayMode = responseDoc["display_mode"] | "";
-    String newDisplay;
-
-    if (responseDoc.containsKey("display_velos_display")) {
-        newDisplay = responseDoc["display_velos_display"].as<String>();
-    } else if (responseDoc.containsKey("session_velos_display")) {
-        newDisplay = responseDoc["session_velos_display"].as<String>();
-    } else {
+bool applyDisplayVelosFromDocument(JsonVariantConst responseDoc) {
+    // Strings stay in the document pool; the globals are only written when they change
+    ApiWireDisplayVelos fields;
+    if (!apiWireDisplayVelos(responseDoc, &fields)) {
         return false;
     }
+    const char* displayMode = fields.mode;
+    const char* newDisplay = fields.text;
+    const char* newEpoch = fields.epoch;
+    const bool newSession = !hasSessionVelosFromServer || sessionEpoch != newEpoch;
 
-    if (displayMode == "round_frozen") {
-        String newEpoch = responseDoc["session_epoch"] | "";
-        if (newEpoch.length() > 0 && newEpoch != sessionEpoch) {
-            sessionEpoch = newEpoch;
-        }
-    } else {
-        String newEpoch = responseDoc["session_epoch"] | "";
-        if (newEpoch.length() > 0 && newEpoch != sessionEpoch) {
+    // Live values are extrapolated with local pulses until the next response; a frozen round is shown as sent
+    anchorLocalVelos(fields.live, fields.velos, fields.sessionKm, newSession);
+
+    if (newEpoch[0] != '\0') {
+        if (sessionEpoch != newEpoch) {
             sessionEpoch = newEpoch;
-        } else if (newEpoch.length() == 0) {
-            if (!hasSessionVelosFromServer) {
-                sessionEpoch = "legacy";
-            }
         }
+    } else if (strcmp(displayMode, "round_frozen") != 0 && !hasSessionVelosFromServer) {
+        sessionEpoch = "legacy";
     }
 
-    if (newDisplay.length() >= sizeof(displayedSessionVelosStr)) {
-        newDisplay = newDisplay.substring(0, sizeof(displayedSessionVelosStr) - 1);
-    }
+    char truncated[sizeof(displayedSessionVelosStr)];
+    strlcpy(truncated, newDisplay, sizeof(truncated));
 
     // Trigger an OLED refresh when the displayed value or first server value
     // changes, so the update is visible without waiting for the next pulse.
-    bool changed = (!hasSessionVelosFromServer) || (newDisplay != displayedSessionVelosStr);
+    bool changed = (!hasSessionVelosFromServer) || (strcmp(truncated, displayedSessionVelosStr) != 0);
 
-    strncpy(displayedSessionVelosStr, newDisplay.c_str(), sizeof(displayedSessionVelosStr) - 1);
-    displayedSessionVelosStr[sizeof(displayedSessionVelosStr) - 1] = '\0';
+    memcpy(displayedSessionVelosStr, truncated, sizeof(displayedSessionVelosStr));
     hasSessionVelosFromServer = true;
     if (changed) {
         oledVelosNeedsRefresh = true;
     }
 
     if (debugEnabled) {
-        Serial.printf(
+        logSerial.printf(
             "DEBUG: OLED display_velos updated: %s (mode=%s, epoch=%s)\n",
             displayedSessionVelosStr,
-            displayMode.length() > 0 ? displayMode.c_str() : "legacy",
+            displayMode[0] != '\0' ? displayMode : "legacy",
             sessionEpoch.c_str()
         );
     }
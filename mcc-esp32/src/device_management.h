@@ -12,6 +12,8 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
+class HTTPClient;
+
 // API endpoint paths for device management
 // Using static to avoid multiple definition errors when header is included in multiple files
 static const char* API_DEVICE_CONFIG_REPORT_PATH = "/api/device/config/report";
@@ -19,6 +21,7 @@ static const char* API_DEVICE_CONFIG_FETCH_PATH = "/api/device/config/fetch";
 static const char* API_DEVICE_HEARTBEAT_PATH = "/api/device/heartbeat";
 static const char* API_DEVICE_FIRMWARE_INFO_PATH = "/api/device/firmware/info";
 static const char* API_DEVICE_FIRMWARE_DOWNLOAD_PATH = "/api/device/firmware/download";
+static const char* API_DEVICE_SYNC_PATH = "/api/device/sync";
 
 // Default firmware version (can be overridden by build flag)
 #ifndef FIRMWARE_VERSION
@@ -62,11 +65,53 @@ bool reportDeviceConfig();
  */
 bool fetchDeviceConfig();
 
+// Capacity of a filtered config fetch response (only the keys in deviceConfigFilter())
+#define DEVICE_CONFIG_DOC_SIZE 1536
+
+/**
+ * @brief ArduinoJson filter selecting the config fetch fields the firmware applies.
+ *
+ * Unknown keys and large server-side extras are skipped while parsing.
+ */
+const JsonDocument& deviceConfigFilter();
+
+/**
+ * @brief Makes a config fetch conditional on the server config last applied.
+ *
+ * Adds If-None-Match with serverHash (the config_hash of the server), so an
+ * unchanged config is answered with 304 and no body. Nothing is added for 0.
+ *
+ * @param serverHash deviceConfig.serverHash at the time the request is prepared
+ */
+void addConfigIfNoneMatch(HTTPClient& http, uint32_t serverHash);
+
+/**
+ * @brief Applies a config fetch response to NVS and globals.
+ * 
+ * Used by the network worker result handling, which receives the filtered
+ * response re-serialized as compact JSON.
+ * 
+ * @param httpCode HTTP status code of the fetch (<= 0 on connection error, 304 = unchanged)
+ * @param response Response body (may be empty)
+ * @return true if the server reported success
+ * 
+ * @note Side effects: Modifies NVS and globals, may update OLED display
+ */
+bool applyDeviceConfigResponse(int httpCode, const char* response);
+
+/**
+ * @brief Applies an already parsed (filtered) config fetch response.
+ *
+ * @param error Parse result; the document is only evaluated without error
+ */
+bool applyDeviceConfigDocument(int httpCode, JsonDocument& responseDoc, DeserializationError error);
+
 /**
  * @brief Sends a heartbeat signal to the server.
  * 
  * Sends a POST request to /api/device/heartbeat to indicate the device
  * is alive and operational. This allows the server to monitor device health.
+ * The payload carries heap statistics and the metrics summary (see metrics.h).
  * 
  * @return true if successful, false on error
  * 
@@ -75,6 +120,81 @@ bool fetchDeviceConfig();
  */
 bool sendHeartbeat();
 
+// Capacity of a filtered sync response (config fields plus firmware and display fields)
+#define DEVICE_SYNC_DOC_SIZE (DEVICE_CONFIG_DOC_SIZE + 512)
+
+/**
+ * @brief Result of syncDevice().
+ */
+enum SyncResult : uint8_t {
+    SYNC_OK = 0,
+    SYNC_FAILED,        // Connection or server error; retried with the next sync
+    SYNC_UNSUPPORTED    // Server without /api/device/sync: use the separate calls
+};
+
+/**
+ * @brief One round trip replacing heartbeat, config report/fetch and firmware check.
+ * 
+ * Sends a POST request to /api/device/sync with heap values, boot reason,
+ * firmware version and the hash of the last applied server config. The
+ * server answers with the config only if it changed since then, plus the
+ * firmware availability and the display Velos. If the server does not know
+ * the endpoint (HTTP 404/405), SYNC_UNSUPPORTED is returned for the rest
+ * of the boot without further requests.
+ * 
+ * @param reportConfig true to include the current configuration (same content as reportDeviceConfig())
+ * @param updateAvailable Receives true if a firmware update is available (may be nullptr)
+ * @return SYNC_OK, SYNC_FAILED or SYNC_UNSUPPORTED
+ * 
+ * @note Requires WiFi connection and valid serverUrl/authToken
+ * @note Side effects: Sends HTTP request, may modify NVS and globals, writes to Serial
+ */
+SyncResult syncDevice(bool reportConfig, bool* updateAvailable);
+
+/**
+ * @brief false after the server answered a sync with 404/405 (until restart).
+ */
+bool deviceSyncSupported();
+
+/**
+ * @brief Combines serverUrl and an API path without a double slash.
+ */
+String buildApiUrl(const char* path);
+
+// Longest endpoint URL kept by apiUrl() (same limit as a network worker job)
+#define API_URL_MAX_LEN 192
+
+/**
+ * @brief Endpoints whose complete URL is kept in a static buffer.
+ */
+enum ApiEndpoint {
+    API_EP_UPDATE_DATA = 0,
+    API_EP_UPDATE_DATA_BATCH,
+    API_EP_GET_USER_ID,
+    API_EP_CONFIG_FETCH,     // Including ?device_id=
+    API_EP_CONFIG_REPORT,
+    API_EP_HEARTBEAT,
+    API_EP_SYNC,
+    API_EP_COUNT
+};
+
+/**
+ * @brief Complete URL of an endpoint without building a String.
+ *
+ * The URLs are rebuilt only when serverUrl or the device name changed,
+ * so the upload cycle does not allocate for them.
+ *
+ * @return Pointer to a static buffer, valid until the next change of serverUrl/deviceName
+ */
+const char* apiUrl(ApiEndpoint endpoint);
+
+/**
+ * @brief Device ID as sent to the server (deviceName + MAC suffix, empty without a name).
+ *
+ * @return Pointer to a static buffer, see apiUrl()
+ */
+const char* deviceIdFull();
+
 /**
  * @brief Set boot_reason for the next heartbeat or update_data request (once).
  */
@@ -85,10 +205,21 @@ void setPendingBootReason(const char* reason);
  */
 bool appendPendingBootReasonToJson(JsonObject doc);
 
+/**
+ * @brief Append the boot timeline ("boot_timeline": stage -> µs since application start) once.
+ * @return false if it was sent already; later boot marks are not recorded
+ */
+bool appendBootTimelineToJson(JsonObject doc);
+
 /**
  * @brief Apply server display Velos fields from API JSON (update_data / heartbeat).
  */
-bool applyDisplayVelosFromResponse(const String& response);
+bool applyDisplayVelosFromResponse(const char* response);
+
+/**
+ * @brief Same as above for an already parsed response (e.g. a sync response).
+ */
+bool applyDisplayVelosFromDocument(JsonVariantConst responseDoc);
 
 /**
  * @brief Checks if a firmware update is available.
@@ -106,8 +237,10 @@ bool checkFirmwareUpdate();
 /**
  * @brief Downloads and installs firmware update from the server.
  * 
- * Downloads firmware binary from /api/device/firmware/download and
- * installs it using ESP32 Update library. The device will restart
+ * Downloads firmware binary from /api/device/firmware/download into the
+ * next OTA partition (see ota_update.h). The image is checked against the
+ * SHA-256 from checkFirmwareUpdate(); after an interrupted download the next
+ * call continues with an HTTP Range request. The device will restart
  * after successful installation.
  * 
  * @return true if successful, false on error
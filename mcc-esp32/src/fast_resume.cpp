@@ -0,0 +1,158 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    fast_resume.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "fast_resume.h"
+#include "mcc_log.h"
+#include <time.h>
+
+// External variables from main.cpp
+extern bool debugEnabled;
+
+static const uint32_t FAST_RESUME_MAGIC = 0x4D434346; // "MCCF"
+
+struct FastResumeState {
+    uint32_t magic;
+    // WiFi
+    uint8_t wifiValid;
+    char ssid[33];
+    uint8_t bssid[6];
+    int32_t channel;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    int64_t savedAt;         // time() when the lease was cached; the RTC timer keeps running in deep sleep
+    // Rider session
+    uint8_t sessionValid;
+    char idTag[40];
+    char username[48];
+    char sessionEpoch[24];
+    char velos[16];
+};
+
+RTC_DATA_ATTR static FastResumeState resumeState;
+
+static bool wokeFromSleep = false;
+
+static void copyString(char* dst, size_t len, const char* src) {
+    strncpy(dst, src != nullptr ? src : "", len - 1);
+    dst[len - 1] = '\0';
+}
+
+void fastResumeBegin(bool wokeFromDeepSleep) {
+    wokeFromSleep = wokeFromDeepSleep;
+    if (!wokeFromDeepSleep || resumeState.magic != FAST_RESUME_MAGIC) {
+        // Power-on reset: RTC memory content is undefined
+        memset(&resumeState, 0, sizeof(resumeState));
+        resumeState.magic = FAST_RESUME_MAGIC;
+    }
+}
+
+bool fastResumeAvailable(const String& ssid) {
+    return resumeState.magic == FAST_RESUME_MAGIC && resumeState.wifiValid &&
+           ssid.length() > 0 && ssid == resumeState.ssid;
+}
+
+bool staticIpParse(const String& config, IPAddress* ip, IPAddress* gateway, IPAddress* subnet, IPAddress* dns) {
+    String parts[4];
+    int count = 0;
+    int start = 0;
+    while (count < 4) {
+        int comma = config.indexOf(',', start);
+        parts[count++] = (comma < 0 ? config.substring(start) : config.substring(start, comma));
+        parts[count - 1].trim();
+        if (comma < 0) {
+            break;
+        }
+        start = comma + 1;
+    }
+    if (count < 3 || !ip->fromString(parts[0]) || !gateway->fromString(parts[1]) ||
+        !subnet->fromString(parts[2])) {
+        return false;
+    }
+    // Without an explicit DNS server the gateway usually resolves names
+    if (count < 4 || !dns->fromString(parts[3])) {
+        *dns = *gateway;
+    }
+    return true;
+}
+
+bool fastResumeWifiBegin(const String& ssid, const String& password, const String& staticIp, bool* dhcp) {
+    if (!fastResumeAvailable(ssid)) {
+        return false;
+    }
+
+    IPAddress ip, gateway, subnet, dns;
+    const int64_t sleptSec = (int64_t)time(nullptr) - resumeState.savedAt;
+    *dhcp = false;
+    if (staticIpParse(staticIp, &ip, &gateway, &subnet, &dns)) {
+        WiFi.config(ip, gateway, subnet, dns);
+    } else if (resumeState.ip != 0 && sleptSec >= 0 && sleptSec < FAST_RESUME_LEASE_MAX_SEC) {
+        WiFi.config(IPAddress(resumeState.ip), IPAddress(resumeState.gateway),
+                    IPAddress(resumeState.subnet), IPAddress(resumeState.dns));
+    } else {
+        *dhcp = true;
+    }
+
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: [fastResume] Connecting on channel %d to %02X:%02X:%02X:%02X:%02X:%02X (slept %llds)\n",
+                      (int)resumeState.channel, resumeState.bssid[0], resumeState.bssid[1], resumeState.bssid[2],
+                      resumeState.bssid[3], resumeState.bssid[4], resumeState.bssid[5], (long long)sleptSec);
+    }
+    WiFi.begin(ssid.c_str(), password.c_str(), resumeState.channel, resumeState.bssid, true);
+    return true;
+}
+
+void fastResumeWifiFailed() {
+    resumeState.wifiValid = 0;
+    WiFi.disconnect();
+    // Back to DHCP for the normal connection attempt
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    MCC_LOGD("[fastResume] Cached access point not reachable, connecting normally.");
+}
+
+void fastResumeSaveWifi(const String& ssid, bool dhcp) {
+    const uint8_t* bssid = WiFi.BSSID();
+    if (bssid == nullptr) {
+        return;
+    }
+    copyString(resumeState.ssid, sizeof(resumeState.ssid), ssid.c_str());
+    memcpy(resumeState.bssid, bssid, sizeof(resumeState.bssid));
+    resumeState.channel = WiFi.channel();
+    if (dhcp) {
+        resumeState.ip = (uint32_t)WiFi.localIP();
+        resumeState.gateway = (uint32_t)WiFi.gatewayIP();
+        resumeState.subnet = (uint32_t)WiFi.subnetMask();
+        resumeState.dns = (uint32_t)WiFi.dnsIP();
+        resumeState.savedAt = (int64_t)time(nullptr);
+    }
+    resumeState.wifiValid = 1;
+    resumeState.magic = FAST_RESUME_MAGIC;
+}
+
+void fastResumeSaveSession(const char* idTag, const char* username, const char* sessionEpoch, const char* velos) {
+    copyString(resumeState.idTag, sizeof(resumeState.idTag), idTag);
+    copyString(resumeState.username, sizeof(resumeState.username), username);
+    copyString(resumeState.sessionEpoch, sizeof(resumeState.sessionEpoch), sessionEpoch);
+    copyString(resumeState.velos, sizeof(resumeState.velos), velos);
+    resumeState.sessionValid = idTag != nullptr && idTag[0] != '\0';
+    resumeState.magic = FAST_RESUME_MAGIC;
+}
+
+bool fastResumeRestoreSession(const char* idTag, String* username, String* sessionEpoch, char* velos, size_t velosLen) {
+    if (!wokeFromSleep || !resumeState.sessionValid || idTag == nullptr ||
+        strcasecmp(resumeState.idTag, idTag) != 0) {
+        return false;
+    }
+    *username = resumeState.username;
+    *sessionEpoch = resumeState.sessionEpoch;
+    if (velos != nullptr && velosLen > 0) {
+        copyString(velos, velosLen, resumeState.velos);
+    }
+    return true;
+}
@@ -0,0 +1,104 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    fast_resume.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Runtime state kept in RTC memory across deep sleep, so a wakeup by the
+ * wheel sensor can count immediately and reconnect to the known access
+ * point without a scan and without DHCP.
+ */
+
+#ifndef FAST_RESUME_H
+#define FAST_RESUME_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+// Give up on the cached channel/BSSID/IP after this time and connect normally
+#ifndef FAST_RESUME_CONNECT_TIMEOUT_MS
+#define FAST_RESUME_CONNECT_TIMEOUT_MS 1500
+#endif
+
+// A cached DHCP lease is only reused if the device slept for a shorter time
+#ifndef FAST_RESUME_LEASE_MAX_SEC
+#define FAST_RESUME_LEASE_MAX_SEC 3600
+#endif
+
+// Heartbeat, config report and firmware check run this long after a fast wakeup
+#ifndef FAST_RESUME_DEFER_MS
+#define FAST_RESUME_DEFER_MS 10000
+#endif
+
+/**
+ * @brief Validates the RTC state; call once at the start of setup().
+ *
+ * @param wokeFromDeepSleep false after power-on/reset, which discards the state
+ */
+void fastResumeBegin(bool wokeFromDeepSleep);
+
+/**
+ * @brief true if connection data for ssid is cached (from this boot or before deep sleep).
+ */
+bool fastResumeAvailable(const String& ssid);
+
+/**
+ * @brief Parses the static_ip setting "ip,gateway,subnet[,dns]".
+ *
+ * @return false for an empty or malformed setting (DHCP is used)
+ */
+bool staticIpParse(const String& config, IPAddress* ip, IPAddress* gateway, IPAddress* subnet, IPAddress* dns);
+
+/**
+ * @brief Starts a connection with the cached channel and BSSID.
+ *
+ * Uses the static IP if configured, otherwise the cached DHCP lease if it
+ * is younger than FAST_RESUME_LEASE_MAX_SEC.
+ *
+ * @param dhcp Receives true if neither was applied and the address comes from DHCP
+ * @return false if nothing is cached (WiFi.begin() was not called)
+ *
+ * @note Hardware interaction: WiFi radio
+ */
+bool fastResumeWifiBegin(const String& ssid, const String& password, const String& staticIp, bool* dhcp);
+
+/**
+ * @brief Drops cached connection data after a failed fast connect and re-enables DHCP.
+ *
+ * @note Hardware interaction: WiFi radio (disconnect)
+ */
+void fastResumeWifiFailed();
+
+/**
+ * @brief Remembers channel, BSSID and IP configuration of the current connection.
+ *
+ * The lease (IP configuration and its age) is only replaced by an address
+ * obtained by DHCP; a reused lease keeps its original time, so it expires
+ * after FAST_RESUME_LEASE_MAX_SEC even across many fast wakeups.
+ *
+ * @param dhcp true if the address of this connection came from DHCP
+ *
+ * @note Side effects: Writes RTC_DATA_ATTR memory
+ */
+void fastResumeSaveWifi(const String& ssid, bool dhcp);
+
+/**
+ * @brief Keeps the rider session before deep sleep.
+ *
+ * @param velos Session Velos text shown on the OLED (may be nullptr)
+ *
+ * @note Side effects: Writes RTC_DATA_ATTR memory
+ */
+void fastResumeSaveSession(const char* idTag, const char* username, const char* sessionEpoch, const char* velos);
+
+/**
+ * @brief Restores the rider session kept by fastResumeSaveSession().
+ *
+ * @param idTag ID tag after wakeup; the session is only restored for the same tag
+ * @param velos Receives the Velos text (velosLen bytes)
+ * @return false if there is no session for idTag
+ */
+bool fastResumeRestoreSession(const char* idTag, String* username, String* sessionEpoch, char* velos, size_t velosLen);
+
+#endif
@@ -0,0 +1,290 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    gateway_frame.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Frame format between bike nodes and a gateway. A request or response
+ * message is split into fragments that fit one radio frame (ESP-NOW: 250
+ * bytes, LoRa: 255).
+ */
+
+#ifndef GATEWAY_FRAME_H
+#define GATEWAY_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define GATEWAY_FRAME_MAGIC 0x4D47u        // "MG"
+#define GATEWAY_FRAME_VERSION 2          // 2: gateway handshake, encrypted unicast
+#define GATEWAY_FRAME_MAX_LEN 250          // ESP-NOW payload limit
+#define GATEWAY_FRAME_HEADER_LEN 10
+#define GATEWAY_FRAGMENT_LEN (GATEWAY_FRAME_MAX_LEN - GATEWAY_FRAME_HEADER_LEN)
+#define GATEWAY_MAX_FRAGMENTS 6
+#define GATEWAY_MESSAGE_MAX_LEN (GATEWAY_FRAGMENT_LEN * GATEWAY_MAX_FRAGMENTS)
+
+#define GATEWAY_NONCE_LEN 8                // HELLO: random challenge of the node
+#define GATEWAY_PROOF_LEN 16               // WELCOME: HMAC of the challenge with the gateway secret
+
+// Request flags
+#define GATEWAY_REQUEST_HAS_KEY 0x01       // API key of the node follows the path
+
+// Status in ACK frames; negative like HTTPClient errors so the node can return it as httpCode
+#define GATEWAY_STATUS_ACCEPTED 0
+#define GATEWAY_STATUS_BUSY (-30)          // Gateway queue full, try again later
+#define GATEWAY_STATUS_NO_KEY (-31)        // Gateway does not know the API key of this node
+#define GATEWAY_STATUS_OFFLINE (-32)       // Gateway has no server connection
+#define GATEWAY_STATUS_INVALID (-33)       // Request could not be decoded
+
+enum GatewayFrameType : uint8_t {
+    GATEWAY_FRAME_REQUEST = 1,   // Node → gateway: one fragment of a request message
+    GATEWAY_FRAME_ACK,           // Gateway → node: request received complete, status follows
+    GATEWAY_FRAME_RESPONSE,      // Gateway → node: one fragment of the server response
+    GATEWAY_FRAME_HELLO,         // Node → broadcast: looking for a gateway, nonce follows
+    GATEWAY_FRAME_WELCOME        // Gateway → broadcast: proof that it knows the gateway secret
+};
+
+struct GatewayFrameHeader {
+    uint8_t type;           // GatewayFrameType
+    uint16_t seq;           // Message number chosen by the node, same for all fragments
+    uint8_t fragIndex;
+    uint8_t fragCount;
+    uint16_t totalLen;      // Length of the whole message
+};
+
+/**
+ * @brief Request message: one network worker job of the node.
+ *
+ * Layout: jobType, flags, context (4, LE), pathLen, path, [keyLen, key], body.
+ * The body is the request body as MessagePack; the gateway adds its own server URL.
+ */
+struct GatewayRequest {
+    uint8_t jobType;        // NetJobType of the node
+    uint8_t flags;          // GATEWAY_REQUEST_*
+    uint32_t context;       // Job context (config hash for conditional config fetches)
+    const char* path;       // URL path with query, not NUL-terminated after decode
+    uint8_t pathLen;
+    const char* apiKey;     // Valid if flags has GATEWAY_REQUEST_HAS_KEY
+    uint8_t apiKeyLen;
+    const uint8_t* body;
+    size_t bodyLen;
+};
+
+static inline void gatewayPutU16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline uint16_t gatewayGetU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief Number of fragments for a message (at least 1, also for an empty one).
+ */
+static inline uint8_t gatewayFragmentCount(size_t messageLen) {
+    if (messageLen == 0) {
+        return 1;
+    }
+    return (uint8_t)((messageLen + GATEWAY_FRAGMENT_LEN - 1) / GATEWAY_FRAGMENT_LEN);
+}
+
+/**
+ * @brief Writes fragment fragIndex of a message into out (GATEWAY_FRAME_MAX_LEN bytes).
+ *
+ * @return Frame length, 0 if the message is too long or fragIndex is out of range
+ */
+static inline size_t gatewayFrameEncode(uint8_t* out, uint8_t type, uint16_t seq,
+                                        const uint8_t* message, size_t messageLen, uint8_t fragIndex) {
+    const uint8_t fragCount = gatewayFragmentCount(messageLen);
+    if (messageLen > GATEWAY_MESSAGE_MAX_LEN || fragIndex >= fragCount) {
+        return 0;
+    }
+    const size_t offset = (size_t)fragIndex * GATEWAY_FRAGMENT_LEN;
+    const size_t chunk = messageLen - offset < GATEWAY_FRAGMENT_LEN ? messageLen - offset : GATEWAY_FRAGMENT_LEN;
+    gatewayPutU16(out, GATEWAY_FRAME_MAGIC);
+    out[2] = GATEWAY_FRAME_VERSION;
+    out[3] = type;
+    gatewayPutU16(out + 4, seq);
+    out[6] = fragIndex;
+    out[7] = fragCount;
+    gatewayPutU16(out + 8, (uint16_t)messageLen);
+    if (chunk > 0) {
+        memcpy(out + GATEWAY_FRAME_HEADER_LEN, message + offset, chunk);
+    }
+    return GATEWAY_FRAME_HEADER_LEN + chunk;
+}
+
+/**
+ * @brief Checks a received frame and splits it into header and fragment data.
+ *
+ * @return false for foreign or inconsistent frames (other magic or version, wrong fragment size)
+ */
+static inline bool gatewayFrameDecode(const uint8_t* frame, size_t len, GatewayFrameHeader* hdr,
+                                      const uint8_t** payload, size_t* payloadLen) {
+    if (len < GATEWAY_FRAME_HEADER_LEN || len > GATEWAY_FRAME_MAX_LEN ||
+        gatewayGetU16(frame) != GATEWAY_FRAME_MAGIC || frame[2] != GATEWAY_FRAME_VERSION) {
+        return false;
+    }
+    hdr->type = frame[3];
+    hdr->seq = gatewayGetU16(frame + 4);
+    hdr->fragIndex = frame[6];
+    hdr->fragCount = frame[7];
+    hdr->totalLen = gatewayGetU16(frame + 8);
+    if (hdr->totalLen > GATEWAY_MESSAGE_MAX_LEN || hdr->fragCount != gatewayFragmentCount(hdr->totalLen) ||
+        hdr->fragIndex >= hdr->fragCount) {
+        return false;
+    }
+    const size_t offset = (size_t)hdr->fragIndex * GATEWAY_FRAGMENT_LEN;
+    const size_t expected = hdr->totalLen - offset < GATEWAY_FRAGMENT_LEN ? hdr->totalLen - offset : GATEWAY_FRAGMENT_LEN;
+    if (len - GATEWAY_FRAME_HEADER_LEN != expected) {
+        return false;
+    }
+    *payload = frame + GATEWAY_FRAME_HEADER_LEN;
+    *payloadLen = expected;
+    return true;
+}
+
+/**
+ * @brief Collects the fragments of one message; fragments may arrive in any order.
+ */
+struct GatewayReassembly {
+    bool active;
+    uint8_t type;
+    uint16_t seq;
+    uint8_t fragCount;
+    uint8_t receivedMask;   // Bit per received fragment
+    uint16_t totalLen;
+    uint8_t data[GATEWAY_MESSAGE_MAX_LEN];
+};
+
+static inline void gatewayReassemblyReset(GatewayReassembly* r) {
+    r->active = false;
+    r->receivedMask = 0;
+}
+
+/**
+ * @brief Adds a decoded fragment; a fragment of another message restarts the reassembly.
+ *
+ * @return true when the message is complete (data and totalLen are valid)
+ */
+static inline bool gatewayReassemblyAdd(GatewayReassembly* r, const GatewayFrameHeader* hdr,
+                                        const uint8_t* payload, size_t payloadLen) {
+    if (!r->active || r->seq != hdr->seq || r->type != hdr->type || r->totalLen != hdr->totalLen) {
+        r->active = true;
+        r->type = hdr->type;
+        r->seq = hdr->seq;
+        r->fragCount = hdr->fragCount;
+        r->totalLen = hdr->totalLen;
+        r->receivedMask = 0;
+    }
+    memcpy(r->data + (size_t)hdr->fragIndex * GATEWAY_FRAGMENT_LEN, payload, payloadLen);
+    r->receivedMask |= (uint8_t)(1u << hdr->fragIndex);
+    return r->receivedMask == (uint8_t)((1u << r->fragCount) - 1u);
+}
+
+/**
+ * @brief Serializes a request message.
+ *
+ * @return Message length, 0 if it does not fit into outSize
+ */
+static inline size_t gatewayRequestEncode(uint8_t* out, size_t outSize, const GatewayRequest* req) {
+    const bool hasKey = (req->flags & GATEWAY_REQUEST_HAS_KEY) != 0;
+    const size_t len = 7 + req->pathLen + (hasKey ? 1 + req->apiKeyLen : 0) + req->bodyLen;
+    if (len > outSize) {
+        return 0;
+    }
+    uint8_t* p = out;
+    *p++ = req->jobType;
+    *p++ = req->flags;
+    gatewayPutU16(p, (uint16_t)req->context);
+    gatewayPutU16(p + 2, (uint16_t)(req->context >> 16));
+    p += 4;
+    *p++ = req->pathLen;
+    memcpy(p, req->path, req->pathLen);
+    p += req->pathLen;
+    if (hasKey) {
+        *p++ = req->apiKeyLen;
+        memcpy(p, req->apiKey, req->apiKeyLen);
+        p += req->apiKeyLen;
+    }
+    if (req->bodyLen > 0) {
+        memcpy(p, req->body, req->bodyLen);
+    }
+    return len;
+}
+
+/**
+ * @brief Parses a request message; path, key and body point into msg.
+ */
+static inline bool gatewayRequestDecode(const uint8_t* msg, size_t len, GatewayRequest* req) {
+    if (len < 7) {
+        return false;
+    }
+    const uint8_t* p = msg;
+    const uint8_t* end = msg + len;
+    req->jobType = *p++;
+    req->flags = *p++;
+    req->context = (uint32_t)gatewayGetU16(p) | ((uint32_t)gatewayGetU16(p + 2) << 16);
+    p += 4;
+    req->pathLen = *p++;
+    if ((size_t)(end - p) < req->pathLen) {
+        return false;
+    }
+    req->path = (const char*)p;
+    p += req->pathLen;
+    req->apiKey = nullptr;
+    req->apiKeyLen = 0;
+    if (req->flags & GATEWAY_REQUEST_HAS_KEY) {
+        if (p >= end || (size_t)(end - p - 1) < p[0]) {
+            return false;
+        }
+        req->apiKeyLen = *p++;
+        req->apiKey = (const char*)p;
+        p += req->apiKeyLen;
+    }
+    req->body = p;
+    req->bodyLen = (size_t)(end - p);
+    return true;
+}
+
+/**
+ * @brief Path with query of a URL ("http://host:8000/api/x?a=1" → "/api/x?a=1").
+ *
+ * Always points into url, so the origin is url up to the returned pointer;
+ * the end of url (empty path) if it has no path.
+ */
+static inline const char* gatewayUrlPath(const char* url) {
+    const char* host = strstr(url, "://");
+    host = host != nullptr ? host + 3 : url;
+    const char* path = strchr(host, '/');
+    return path != nullptr ? path : host + strlen(host);
+}
+
+/**
+ * @brief Last request the gateway queued for a node; a repeated one is only acknowledged.
+ *
+ * A HELLO resets it: the node searches again after a power cycle, so its
+ * sequence numbers may start over.
+ */
+struct GatewaySeqFilter {
+    bool valid;
+    uint16_t lastSeq;
+};
+
+static inline bool gatewaySeqIsLast(const GatewaySeqFilter* f, uint16_t seq) {
+    return f->valid && f->lastSeq == seq;
+}
+
+static inline void gatewaySeqAccept(GatewaySeqFilter* f, uint16_t seq) {
+    f->lastSeq = seq;
+    f->valid = true;
+}
+
+static inline void gatewaySeqReset(GatewaySeqFilter* f) {
+    f->valid = false;
+}
+
+#endif // GATEWAY_FRAME_H
@@ -0,0 +1,720 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    gateway_link.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "gateway_link.h"
+#include "mcc_log.h"
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <ArduinoJson.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <mbedtls/md.h>
+#include "esp_attr.h"
+#include "freertos/semphr.h"
+#include "gateway_frame.h"
+#include "wifi_manager.h"
+
+// External variables from main.cpp
+extern bool debugEnabled;
+extern String serverUrl;
+
+// Working document for the JSON <-> MessagePack conversion of one message
+static const size_t GATEWAY_JSON_DOC_SIZE = 3072;
+// Request bodies as JSON on the gateway (update-data with stats is below 512 bytes)
+static const size_t GATEWAY_JSON_MAX_LEN = 1536;
+// Received frames waiting for the worker (node) or loop() (gateway)
+static const uint8_t GATEWAY_RX_QUEUE_LEN = 16;
+// Messages reassembled at the same time on the gateway
+static const uint8_t GATEWAY_RX_SLOTS = 4;
+// Channels searched by a node when the gateway does not answer
+static const uint8_t GATEWAY_CHANNEL_COUNT = 13;
+// Wait for the send callback before the next fragment is queued
+static const uint32_t GATEWAY_SEND_TIMEOUT_MS = 50;
+// A response can wait behind the full job queue of the gateway
+static const uint32_t GATEWAY_RESPONSE_TIMEOUT_MS = NET_WORKER_HTTP_TIMEOUT_MS * (NET_WORKER_JOB_QUEUE_LEN + 1) + 1000;
+
+static const uint8_t BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+struct GatewayRxFrame {
+    uint8_t mac[6];
+    uint8_t len;
+    uint8_t data[GATEWAY_FRAME_MAX_LEN];
+};
+
+// Derived from the gateway secret in gatewayLinkBegin()
+static uint8_t linkPmk[ESP_NOW_KEY_LEN];
+static uint8_t linkLmk[ESP_NOW_KEY_LEN];
+static uint8_t linkAuthKey[32];
+
+static volatile GatewayRole linkRole = GATEWAY_ROLE_STANDALONE;
+static bool linkStarted = false;
+static QueueHandle_t rxQueue = nullptr;
+static SemaphoreHandle_t sendDone = nullptr;
+
+// Node: gateway and channel survive deep sleep, so the first upload after a wakeup needs no search
+RTC_DATA_ATTR static uint8_t nodeGatewayMac[6];
+RTC_DATA_ATTR static bool nodeGatewayKnown = false;
+RTC_DATA_ATTR static bool nodeGatewayHasKey = false;
+RTC_DATA_ATTR static uint8_t nodeChannel = 1;
+// Continues across deep sleep: the gateway takes a known seq for a repeated request
+RTC_DATA_ATTR static uint16_t nodeSeq = 0;
+RTC_DATA_ATTR static bool nodeSeqSeeded = false;
+static volatile unsigned long nodeUnreachableSince = 0;  // 0: last exchange reached the gateway
+// Only used by the network worker task
+static uint8_t nodeMessage[GATEWAY_MESSAGE_MAX_LEN];
+static uint8_t nodeBody[GATEWAY_MESSAGE_MAX_LEN];
+static GatewayReassembly nodeResponse;
+
+struct GatewayPeer {
+    bool used;
+    bool espNowPeer;        // Registered with esp_now_add_peer()
+    uint8_t mac[6];
+    GatewaySeqFilter requests;
+    unsigned long lastSeenMs;
+    char apiKey[NET_JOB_API_KEY_LEN];
+};
+
+struct GatewayRxSlot {
+    uint8_t mac[6];
+    unsigned long lastMs;
+    GatewayReassembly message;
+};
+
+// Gateway: only used from loop()
+static GatewayPeer peers[GATEWAY_MAX_PEERS];
+static GatewayRxSlot rxSlots[GATEWAY_RX_SLOTS];
+static uint8_t gatewayMessage[GATEWAY_MESSAGE_MAX_LEN];
+static char gatewayJson[GATEWAY_JSON_MAX_LEN];
+
+GatewayRole gatewayRoleFromString(const String& value) {
+    if (value == "node") {
+        return GATEWAY_ROLE_NODE;
+    }
+    if (value == "gateway") {
+        return GATEWAY_ROLE_GATEWAY;
+    }
+    return GATEWAY_ROLE_STANDALONE;
+}
+
+const char* gatewayRoleToString(GatewayRole role) {
+    switch (role) {
+        case GATEWAY_ROLE_NODE:
+            return "node";
+        case GATEWAY_ROLE_GATEWAY:
+            return "gateway";
+        default:
+            return "standalone";
+    }
+}
+
+// Runs in the WiFi task: copy and hand over, no processing here
+static void onReceive(const uint8_t* mac, const uint8_t* data, int len) {
+    if (rxQueue == nullptr || len < GATEWAY_FRAME_HEADER_LEN || len > GATEWAY_FRAME_MAX_LEN ||
+        gatewayGetU16(data) != GATEWAY_FRAME_MAGIC) {
+        return;
+    }
+    GatewayRxFrame frame;
+    memcpy(frame.mac, mac, sizeof(frame.mac));
+    frame.len = (uint8_t)len;
+    memcpy(frame.data, data, len);
+    xQueueSend(rxQueue, &frame, 0);
+}
+
+static void onSent(const uint8_t* mac, esp_now_send_status_t status) {
+    xSemaphoreGive(sendDone);
+}
+
+static bool sendFrame(const uint8_t* mac, const uint8_t* frame, size_t len) {
+    xSemaphoreTake(sendDone, 0);
+    if (esp_now_send(mac, frame, len) != ESP_OK) {
+        return false;
+    }
+    // One frame in flight at a time, back-to-back sends fail with ESP_ERR_ESPNOW_NO_MEM
+    return xSemaphoreTake(sendDone, pdMS_TO_TICKS(GATEWAY_SEND_TIMEOUT_MS)) == pdTRUE;
+}
+
+static bool sendMessage(const uint8_t* mac, uint8_t type, uint16_t seq, const uint8_t* message, size_t len) {
+    uint8_t frame[GATEWAY_FRAME_MAX_LEN];
+    const uint8_t count = gatewayFragmentCount(len);
+    for (uint8_t i = 0; i < count; i++) {
+        const size_t frameLen = gatewayFrameEncode(frame, type, seq, message, len, i);
+        if (frameLen == 0 || !sendFrame(mac, frame, frameLen)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void linkHmac(const uint8_t* key, size_t keyLen, const uint8_t* data, size_t len, uint8_t* digest) {
+    mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), key, keyLen, data, len, digest);
+}
+
+/**
+ * @brief Key for one purpose, derived from the gateway secret (HMAC-SHA256 of the label).
+ */
+static void deriveLinkKey(const String& secret, const char* label, uint8_t* key, size_t keyLen) {
+    uint8_t digest[32];
+    linkHmac((const uint8_t*)secret.c_str(), secret.length(), (const uint8_t*)label, strlen(label), digest);
+    memcpy(key, digest, keyLen);
+}
+
+/**
+ * @brief WELCOME proof: binds the nonce of the node to both MAC addresses.
+ */
+static void linkProof(const uint8_t* nonce, const uint8_t* gatewayMac, const uint8_t* nodeMac, uint8_t* proof) {
+    uint8_t data[GATEWAY_NONCE_LEN + 12];
+    memcpy(data, nonce, GATEWAY_NONCE_LEN);
+    memcpy(data + GATEWAY_NONCE_LEN, gatewayMac, 6);
+    memcpy(data + GATEWAY_NONCE_LEN + 6, nodeMac, 6);
+    uint8_t digest[32];
+    linkHmac(linkAuthKey, sizeof(linkAuthKey), data, sizeof(data), digest);
+    memcpy(proof, digest, GATEWAY_PROOF_LEN);
+}
+
+/**
+ * @brief Registers a peer; all unicast peers use the link key, only broadcast stays unencrypted.
+ */
+static bool addEspNowPeer(const uint8_t* mac) {
+    if (esp_now_is_peer_exist(mac)) {
+        return true;
+    }
+    esp_now_peer_info_t info = {};
+    memcpy(info.peer_addr, mac, 6);
+    info.channel = 0;  // Current channel
+    info.ifidx = WIFI_IF_STA;
+    info.encrypt = memcmp(mac, BROADCAST_MAC, 6) != 0;
+    if (info.encrypt) {
+        memcpy(info.lmk, linkLmk, sizeof(info.lmk));
+    }
+    return esp_now_add_peer(&info) == ESP_OK;
+}
+
+void gatewayLinkBegin(GatewayRole role, const String& secret) {
+    if (linkStarted || role == GATEWAY_ROLE_STANDALONE) {
+        return;
+    }
+    if (secret.length() < GATEWAY_SECRET_MIN_LEN) {
+        MCC_LOGE("gatewayLinkBegin() - No gateway secret set, ESP-NOW link not started");
+        return;
+    }
+    deriveLinkKey(secret, "mcc-espnow-pmk", linkPmk, sizeof(linkPmk));
+    deriveLinkKey(secret, "mcc-espnow-lmk", linkLmk, sizeof(linkLmk));
+    deriveLinkKey(secret, "mcc-gateway-auth", linkAuthKey, sizeof(linkAuthKey));
+    if (role == GATEWAY_ROLE_NODE) {
+        // Station mode for the radio only; the node never joins a network
+        WiFi.mode(WIFI_STA);
+        WiFi.disconnect();
+        esp_wifi_set_channel(nodeChannel, WIFI_SECOND_CHAN_NONE);
+        if (!nodeSeqSeeded) {
+            // Power-on: RTC memory is cleared, start away from the numbers used before
+            nodeSeq = (uint16_t)esp_random();
+            nodeSeqSeeded = true;
+        }
+    }
+    if (esp_now_init() != ESP_OK || esp_now_set_pmk(linkPmk) != ESP_OK) {
+        MCC_LOGE("gatewayLinkBegin() - esp_now_init failed");
+        return;
+    }
+    rxQueue = xQueueCreate(GATEWAY_RX_QUEUE_LEN, sizeof(GatewayRxFrame));
+    sendDone = xSemaphoreCreateBinary();
+    if (rxQueue == nullptr || sendDone == nullptr) {
+        MCC_LOGE("gatewayLinkBegin() - Could not create queue");
+        return;
+    }
+    esp_now_register_recv_cb(onReceive);
+    esp_now_register_send_cb(onSent);
+    // HELLO and WELCOME are broadcast, everything else goes encrypted to a peer
+    addEspNowPeer(BROADCAST_MAC);
+    if (role == GATEWAY_ROLE_NODE && nodeGatewayKnown) {
+        addEspNowPeer(nodeGatewayMac);
+    }
+    linkRole = role;
+    linkStarted = true;
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: [gateway] ESP-NOW started as %s, channel %d\n", gatewayRoleToString(role),
+                      role == GATEWAY_ROLE_NODE ? nodeChannel : (int)WiFi.channel());
+    }
+}
+
+GatewayRole gatewayLinkRole() {
+    return linkRole;
+}
+
+// ---------------------------------------------------------------------------
+// Node
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Waits for a frame of message seq from the gateway.
+ *
+ * Only a WELCOME may come from any device (it is checked by its proof);
+ * everything else must come from the gateway the node registered.
+ */
+static bool nodeWaitFrame(uint8_t type, uint16_t seq, uint32_t timeoutMs, GatewayRxFrame* frame,
+                          GatewayFrameHeader* hdr, const uint8_t** payload, size_t* payloadLen) {
+    const unsigned long start = millis();
+    for (;;) {
+        const unsigned long waited = millis() - start;
+        if (waited >= timeoutMs || xQueueReceive(rxQueue, frame, pdMS_TO_TICKS(timeoutMs - waited)) != pdTRUE) {
+            return false;
+        }
+        if (type != GATEWAY_FRAME_WELCOME && memcmp(frame->mac, nodeGatewayMac, 6) != 0) {
+            continue;
+        }
+        if (gatewayFrameDecode(frame->data, frame->len, hdr, payload, payloadLen) &&
+            hdr->type == type && hdr->seq == seq) {
+            return true;
+        }
+    }
+}
+
+static void nodeForgetGateway() {
+    if (nodeGatewayKnown) {
+        esp_now_del_peer(nodeGatewayMac);
+    }
+    nodeGatewayKnown = false;
+    nodeGatewayHasKey = false;
+}
+
+/**
+ * @brief Looks for a gateway that knows the gateway secret, searching all channels if needed.
+ *
+ * Only a gateway whose WELCOME carries the proof for our nonce is added as
+ * (encrypted) peer, so the API key and the ride data never reach a device
+ * without the secret.
+ */
+static bool nodeFindGateway(uint16_t seq) {
+    GatewayRxFrame frame;
+    GatewayFrameHeader hdr;
+    const uint8_t* payload;
+    size_t payloadLen;
+    uint8_t ownMac[6];
+    WiFi.macAddress(ownMac);
+    // Last known channel first, then every other channel (gateway moved to another AP channel)
+    for (int i = 0; i < GATEWAY_CHANNEL_COUNT; i++) {
+        if (i > 0) {
+            nodeChannel = nodeChannel % GATEWAY_CHANNEL_COUNT + 1;
+            esp_wifi_set_channel(nodeChannel, WIFI_SECOND_CHAN_NONE);
+        }
+        uint8_t nonce[GATEWAY_NONCE_LEN];
+        for (size_t n = 0; n < sizeof(nonce); n += 4) {
+            const uint32_t r = esp_random();
+            memcpy(nonce + n, &r, 4);
+        }
+        sendMessage(BROADCAST_MAC, GATEWAY_FRAME_HELLO, seq, nonce, sizeof(nonce));
+        const unsigned long start = millis();
+        for (;;) {
+            const unsigned long waited = millis() - start;
+            if (waited >= GATEWAY_ACK_TIMEOUT_MS ||
+                !nodeWaitFrame(GATEWAY_FRAME_WELCOME, seq, GATEWAY_ACK_TIMEOUT_MS - waited,
+                               &frame, &hdr, &payload, &payloadLen)) {
+                break;
+            }
+            uint8_t proof[GATEWAY_PROOF_LEN];
+            linkProof(nonce, frame.mac, ownMac, proof);
+            if (payloadLen != sizeof(proof) || memcmp(proof, payload, sizeof(proof)) != 0) {
+                MCC_LOGD("[gateway] WELCOME from %02X:%02X:%02X:%02X:%02X:%02X without a valid proof, ignored\n",
+                         frame.mac[0], frame.mac[1], frame.mac[2], frame.mac[3], frame.mac[4], frame.mac[5]);
+                continue;
+            }
+            memcpy(nodeGatewayMac, frame.mac, 6);
+            nodeGatewayKnown = addEspNowPeer(nodeGatewayMac);
+            if (debugEnabled) {
+                logSerial.printf("DEBUG: [gateway] Gateway %02X:%02X:%02X:%02X:%02X:%02X on channel %u\n",
+                              frame.mac[0], frame.mac[1], frame.mac[2], frame.mac[3], frame.mac[4], frame.mac[5],
+                              (unsigned)nodeChannel);
+            }
+            return nodeGatewayKnown;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Sends a request until the gateway acknowledges it; searches again if the known one does not answer.
+ *
+ * @return ACK status, -1 if no gateway answered
+ */
+static int nodeDeliver(uint16_t seq, size_t len) {
+    GatewayRxFrame frame;
+    GatewayFrameHeader hdr;
+    const uint8_t* payload;
+    size_t payloadLen;
+    // A known gateway that stopped answering moved to another channel or restarted and lost our peer entry
+    for (int round = 0; round < 2; round++) {
+        if (!nodeGatewayKnown && !nodeFindGateway(seq)) {
+            break;
+        }
+        for (int attempt = 0; attempt < GATEWAY_NODE_ATTEMPTS; attempt++) {
+            sendMessage(nodeGatewayMac, GATEWAY_FRAME_REQUEST, seq, nodeMessage, len);
+            if (nodeWaitFrame(GATEWAY_FRAME_ACK, seq, GATEWAY_ACK_TIMEOUT_MS, &frame, &hdr, &payload, &payloadLen) &&
+                payloadLen >= 2) {
+                nodeUnreachableSince = 0;
+                return (int16_t)gatewayGetU16(payload);
+            }
+        }
+        nodeForgetGateway();
+    }
+    nodeUnreachableSince = millis() | 1;  // Never 0
+    MCC_LOGD("[gateway] No gateway answered on any channel");
+    return -1;
+}
+
+/**
+ * @brief Waits for the response of an accepted request and converts its body to JSON.
+ */
+static int nodeReceiveResponse(uint16_t seq, char* response, size_t responseSize) {
+    GatewayRxFrame frame;
+    GatewayFrameHeader hdr;
+    const uint8_t* payload;
+    size_t payloadLen;
+    gatewayReassemblyReset(&nodeResponse);
+    const unsigned long start = millis();
+    for (;;) {
+        const unsigned long waited = millis() - start;
+        if (waited >= GATEWAY_RESPONSE_TIMEOUT_MS ||
+            !nodeWaitFrame(GATEWAY_FRAME_RESPONSE, seq, GATEWAY_RESPONSE_TIMEOUT_MS - waited,
+                           &frame, &hdr, &payload, &payloadLen)) {
+            return HTTPC_ERROR_READ_TIMEOUT;
+        }
+        if (gatewayReassemblyAdd(&nodeResponse, &hdr, payload, payloadLen)) {
+            break;
+        }
+    }
+    if (nodeResponse.totalLen < 2) {
+        return GATEWAY_STATUS_INVALID;
+    }
+    const int httpCode = (int16_t)gatewayGetU16(nodeResponse.data);
+    if (nodeResponse.totalLen > 2) {
+        DynamicJsonDocument doc(GATEWAY_JSON_DOC_SIZE);
+        if (!deserializeMsgPack(doc, (const char*)nodeResponse.data + 2, nodeResponse.totalLen - 2) &&
+            measureJson(doc) < responseSize) {
+            serializeJson(doc, response, responseSize);
+        } else if (debugEnabled) {
+            logSerial.printf("DEBUG: [gateway] Response body of %u bytes dropped\n", (unsigned)nodeResponse.totalLen);
+        }
+    }
+    return httpCode;
+}
+
+int gatewayNodeExchange(NetJobType type, const char* url, const char* apiKey,
+                        const char* body, size_t bodyLen, uint32_t context,
+                        char* response, size_t responseSize) {
+    response[0] = '\0';
+    if (!linkStarted) {
+        return -1;
+    }
+
+    // The body travels as MessagePack, an interval record then fits into one frame
+    size_t packedLen = 0;
+    if (bodyLen > 0) {
+        DynamicJsonDocument doc(GATEWAY_JSON_DOC_SIZE);
+        if (deserializeJson(doc, body, bodyLen)) {
+            return GATEWAY_STATUS_INVALID;
+        }
+        if (measureMsgPack(doc) > sizeof(nodeBody)) {
+            return GATEWAY_STATUS_INVALID;
+        }
+        packedLen = serializeMsgPack(doc, nodeBody, sizeof(nodeBody));
+    }
+
+    const char* path = gatewayUrlPath(url);
+    GatewayRequest req;
+    req.jobType = (uint8_t)type;
+    req.flags = nodeGatewayHasKey ? 0 : GATEWAY_REQUEST_HAS_KEY;
+    req.context = context;
+    req.path = path;
+    req.pathLen = (uint8_t)strnlen(path, 255);
+    req.apiKey = apiKey;
+    req.apiKeyLen = (uint8_t)strnlen(apiKey, NET_JOB_API_KEY_LEN);
+    req.body = nodeBody;
+    req.bodyLen = packedLen;
+
+    for (;;) {
+        const size_t len = gatewayRequestEncode(nodeMessage, sizeof(nodeMessage), &req);
+        if (len == 0) {
+            return GATEWAY_STATUS_INVALID;
+        }
+        const uint16_t seq = ++nodeSeq;
+        const int status = nodeDeliver(seq, len);
+        if (status == GATEWAY_STATUS_NO_KEY && !(req.flags & GATEWAY_REQUEST_HAS_KEY)) {
+            // Gateway restarted and lost its peer table: send again with the key
+            req.flags |= GATEWAY_REQUEST_HAS_KEY;
+            continue;
+        }
+        if (status != GATEWAY_STATUS_ACCEPTED) {
+            return status;
+        }
+        nodeGatewayHasKey = true;
+        return nodeReceiveResponse(seq, response, responseSize);
+    }
+}
+
+bool gatewayNodeReachable() {
+    const unsigned long since = nodeUnreachableSince;
+    return since == 0 || millis() - since >= GATEWAY_NODE_RETRY_MS;
+}
+
+// ---------------------------------------------------------------------------
+// Gateway
+// ---------------------------------------------------------------------------
+
+// Wraparound-safe: true if a was seen before b
+static bool seenBefore(unsigned long a, unsigned long b) {
+    return (long)(a - b) < 0;
+}
+
+/**
+ * @brief Peer table entry of a node, -1 if it is not in the table.
+ */
+static int peerIndex(const uint8_t* mac) {
+    for (int i = 0; i < GATEWAY_MAX_PEERS; i++) {
+        if (peers[i].used && memcmp(peers[i].mac, mac, 6) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Peer table entry of a node; a new node replaces the one not seen for the longest time.
+ */
+static int findPeer(const uint8_t* mac) {
+    const int known = peerIndex(mac);
+    if (known >= 0) {
+        return known;
+    }
+    int slot = -1;
+    for (int i = 0; i < GATEWAY_MAX_PEERS; i++) {
+        if (slot < 0 || (peers[slot].used && (!peers[i].used || seenBefore(peers[i].lastSeenMs, peers[slot].lastSeenMs)))) {
+            slot = i;
+        }
+    }
+    GatewayPeer& peer = peers[slot];
+    if (peer.used && peer.espNowPeer) {
+        esp_now_del_peer(peer.mac);
+    }
+    memset(&peer, 0, sizeof(peer));
+    peer.used = true;
+    memcpy(peer.mac, mac, 6);
+    return slot;
+}
+
+/**
+ * @brief Registers a node with ESP-NOW for unicast; frees the least recently seen one if the table is full.
+ */
+static bool ensureEspNowPeer(int index) {
+    GatewayPeer& peer = peers[index];
+    if (peer.espNowPeer && esp_now_is_peer_exist(peer.mac)) {
+        return true;
+    }
+    while (!addEspNowPeer(peer.mac)) {
+        int victim = -1;
+        for (int i = 0; i < GATEWAY_MAX_PEERS; i++) {
+            if (i != index && peers[i].used && peers[i].espNowPeer &&
+                (victim < 0 || seenBefore(peers[i].lastSeenMs, peers[victim].lastSeenMs))) {
+                victim = i;
+            }
+        }
+        if (victim < 0) {
+            return false;
+        }
+        esp_now_del_peer(peers[victim].mac);
+        peers[victim].espNowPeer = false;
+    }
+    peer.espNowPeer = true;
+    return true;
+}
+
+static void sendAck(int index, uint16_t seq, int status) {
+    uint8_t message[2];
+    gatewayPutU16(message, (uint16_t)(int16_t)status);
+    if (ensureEspNowPeer(index)) {
+        sendMessage(peers[index].mac, GATEWAY_FRAME_ACK, seq, message, sizeof(message));
+    }
+}
+
+/**
+ * @brief Answers the HELLO of a node and registers it as encrypted peer.
+ *
+ * The WELCOME goes out as broadcast because the node can only decrypt
+ * frames of the gateway after it checked the proof and added it as peer.
+ */
+static void welcomeNode(const uint8_t* mac, uint16_t seq, const uint8_t* nonce, size_t nonceLen) {
+    if (nonceLen != GATEWAY_NONCE_LEN) {
+        return;
+    }
+    const int index = findPeer(mac);
+    peers[index].lastSeenMs = millis();
+    gatewaySeqReset(&peers[index].requests);
+    if (!ensureEspNowPeer(index)) {
+        return;
+    }
+    uint8_t ownMac[6];
+    WiFi.macAddress(ownMac);
+    uint8_t proof[GATEWAY_PROOF_LEN];
+    linkProof(nonce, ownMac, mac, proof);
+    sendMessage(BROADCAST_MAC, GATEWAY_FRAME_WELCOME, seq, proof, sizeof(proof));
+}
+
+/**
+ * @brief Checks a complete request and queues it in the network worker.
+ *
+ * @return ACK status for the node
+ */
+static int forwardRequest(int index, uint16_t seq, const uint8_t* message, size_t len) {
+    GatewayPeer& peer = peers[index];
+    GatewayRequest req;
+    if (!gatewayRequestDecode(message, len, &req) || req.jobType >= NET_JOB_GATEWAY_FORWARD) {
+        return GATEWAY_STATUS_INVALID;
+    }
+    if (req.pathLen == 0 || req.path[0] != '/') {
+        // The path is appended to the origin of the gateway: "@otherhost" would change the host
+        return GATEWAY_STATUS_INVALID;
+    }
+    for (uint8_t i = 0; i < req.pathLen; i++) {
+        if ((uint8_t)req.path[i] <= ' ') {
+            return GATEWAY_STATUS_INVALID;  // Would end the request line
+        }
+    }
+    if (req.flags & GATEWAY_REQUEST_HAS_KEY) {
+        const size_t keyLen = req.apiKeyLen < sizeof(peer.apiKey) - 1 ? req.apiKeyLen : sizeof(peer.apiKey) - 1;
+        memcpy(peer.apiKey, req.apiKey, keyLen);
+        peer.apiKey[keyLen] = '\0';
+    }
+    if (gatewaySeqIsLast(&peer.requests, seq)) {
+        // ACK was lost and the node sent again: the request is already queued
+        return GATEWAY_STATUS_ACCEPTED;
+    }
+    if (peer.apiKey[0] == '\0') {
+        return GATEWAY_STATUS_NO_KEY;
+    }
+    if (!wifiManagerConnected()) {
+        return GATEWAY_STATUS_OFFLINE;
+    }
+
+    size_t jsonLen = 0;
+    if (req.bodyLen > 0) {
+        DynamicJsonDocument doc(GATEWAY_JSON_DOC_SIZE);
+        if (deserializeMsgPack(doc, (const char*)req.body, req.bodyLen)) {
+            return GATEWAY_STATUS_INVALID;
+        }
+        if (measureJson(doc) >= sizeof(gatewayJson)) {
+            return GATEWAY_STATUS_INVALID;
+        }
+        jsonLen = serializeJson(doc, gatewayJson, sizeof(gatewayJson));
+    }
+
+    // Path of the node on the server of the gateway (scheme, host and port)
+    char url[NET_JOB_URL_LEN];
+    const int originLen = (int)(gatewayUrlPath(serverUrl.c_str()) - serverUrl.c_str());
+    const int urlLen = snprintf(url, sizeof(url), "%.*s%.*s", originLen, serverUrl.c_str(), (int)req.pathLen, req.path);
+    if (urlLen <= 0 || urlLen >= (int)sizeof(url)) {
+        return GATEWAY_STATUS_INVALID;
+    }
+
+    if (!netWorkerSubmitForward((NetJobType)req.jobType, url, peer.apiKey, gatewayJson, jsonLen,
+                                req.context, ((uint32_t)index << 16) | seq)) {
+        return GATEWAY_STATUS_BUSY;
+    }
+    gatewaySeqAccept(&peer.requests, seq);
+    return GATEWAY_STATUS_ACCEPTED;
+}
+
+/**
+ * @brief Reassembly slot for a sender: its current message, a free slot or the oldest one.
+ */
+static GatewayRxSlot* rxSlotFor(const uint8_t* mac) {
+    GatewayRxSlot* candidate = nullptr;
+    for (int i = 0; i < GATEWAY_RX_SLOTS; i++) {
+        GatewayRxSlot* slot = &rxSlots[i];
+        if (slot->message.active && memcmp(slot->mac, mac, 6) == 0) {
+            return slot;
+        }
+        if (candidate == nullptr ||
+            (candidate->message.active && (!slot->message.active || seenBefore(slot->lastMs, candidate->lastMs)))) {
+            candidate = slot;
+        }
+    }
+    gatewayReassemblyReset(&candidate->message);
+    memcpy(candidate->mac, mac, 6);
+    return candidate;
+}
+
+void gatewayLinkLoop() {
+    if (linkRole != GATEWAY_ROLE_GATEWAY || rxQueue == nullptr) {
+        return;
+    }
+    GatewayRxFrame frame;
+    GatewayFrameHeader hdr;
+    const uint8_t* payload;
+    size_t payloadLen;
+    while (xQueueReceive(rxQueue, &frame, 0) == pdTRUE) {
+        if (!gatewayFrameDecode(frame.data, frame.len, &hdr, &payload, &payloadLen)) {
+            continue;
+        }
+        if (hdr.type == GATEWAY_FRAME_HELLO) {
+            welcomeNode(frame.mac, hdr.seq, payload, payloadLen);
+            continue;
+        }
+        // Requests are only taken from registered peers: anything else arrived unencrypted
+        const int index = peerIndex(frame.mac);
+        if (hdr.type != GATEWAY_FRAME_REQUEST || index < 0 || !peers[index].espNowPeer) {
+            continue;
+        }
+        GatewayRxSlot* slot = rxSlotFor(frame.mac);
+        slot->lastMs = millis();
+        if (!gatewayReassemblyAdd(&slot->message, &hdr, payload, payloadLen)) {
+            continue;
+        }
+
+        peers[index].lastSeenMs = millis();
+        const int status = forwardRequest(index, hdr.seq, slot->message.data, slot->message.totalLen);
+        sendAck(index, hdr.seq, status);
+        if (debugEnabled) {
+            logSerial.printf("DEBUG: [gateway] Request %u (job %u, %u bytes) from %02X:%02X:%02X:%02X:%02X:%02X: status %d\n",
+                          (unsigned)hdr.seq, (unsigned)slot->message.data[0], (unsigned)slot->message.totalLen,
+                          frame.mac[0], frame.mac[1], frame.mac[2], frame.mac[3], frame.mac[4], frame.mac[5], status);
+        }
+        gatewayReassemblyReset(&slot->message);
+    }
+}
+
+void gatewayHandleForwardResult(const NetResult& result) {
+    const uint32_t index = result.session >> 16;
+    const uint16_t seq = (uint16_t)result.session;
+    if (index >= GATEWAY_MAX_PEERS || !peers[index].used || !gatewaySeqIsLast(&peers[index].requests, seq)) {
+        return;  // Node was replaced in the peer table or searched again meanwhile
+    }
+
+    // Response message: HTTP status (2 bytes) and the body as MessagePack
+    gatewayPutU16(gatewayMessage, (uint16_t)(int16_t)result.httpCode);
+    size_t len = 2;
+    if (result.body != nullptr && result.body[0] != '\0') {
+        DynamicJsonDocument doc(GATEWAY_JSON_DOC_SIZE);
+        if (!deserializeJson(doc, result.body) && measureMsgPack(doc) <= sizeof(gatewayMessage) - 2) {
+            len += serializeMsgPack(doc, gatewayMessage + 2, sizeof(gatewayMessage) - 2);
+        }
+        if (len == 2 && debugEnabled) {
+            logSerial.printf("DEBUG: [gateway] Response for request %u too large, status only\n", (unsigned)seq);
+        }
+    }
+    if (ensureEspNowPeer(index)) {
+        sendMessage(peers[index].mac, GATEWAY_FRAME_RESPONSE, seq, gatewayMessage, len);
+    }
+}
+
+uint32_t gatewayPeerCount() {
+    uint32_t count = 0;
+    for (int i = 0; i < GATEWAY_MAX_PEERS; i++) {
+        if (peers[i].used) {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,130 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    gateway_link.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * ESP-NOW link between bike nodes and a gateway. A node does not join the
+ * WiFi network: its network worker hands each job to the gateway and gets the
+ * server response back. The gateway forwards the requests through its own
+ * network worker over one keep-alive connection and relays the responses
+ * (Velos, username, config). The role is selected by the node_role setting.
+ *
+ * Gateway and nodes share the gateway secret: a node broadcasts a HELLO with
+ * a nonce and only uses a gateway whose WELCOME proves the secret. All
+ * unicast frames are encrypted by ESP-NOW with keys derived from it.
+ */
+
+#ifndef GATEWAY_LINK_H
+#define GATEWAY_LINK_H
+
+#include <Arduino.h>
+#include "net_worker.h"
+
+// Nodes served by one gateway (ESP-NOW keeps few encrypted peers, 7 by default; the rest are swapped
+// in on demand, a swapped-out node is found again by its next HELLO)
+#ifndef GATEWAY_MAX_PEERS
+#define GATEWAY_MAX_PEERS 48
+#endif
+
+// Node: wait for the ACK of a request before it is sent again or the channel is changed
+#ifndef GATEWAY_ACK_TIMEOUT_MS
+#define GATEWAY_ACK_TIMEOUT_MS 200
+#endif
+
+// Node: sends per request on the last known channel before all channels are tried
+#ifndef GATEWAY_NODE_ATTEMPTS
+#define GATEWAY_NODE_ATTEMPTS 3
+#endif
+
+// Minimum length of the gateway secret; without one the ESP-NOW link is not started
+#define GATEWAY_SECRET_MIN_LEN 8
+
+// Node: after the gateway was not found, periodic lookups and replays pause this long
+#ifndef GATEWAY_NODE_RETRY_MS
+#define GATEWAY_NODE_RETRY_MS 30000
+#endif
+
+enum GatewayRole : uint8_t {
+    GATEWAY_ROLE_STANDALONE = 0,  // Own WiFi connection to the server (default)
+    GATEWAY_ROLE_NODE = 1,        // Uploads through a gateway, no WiFi association
+    GATEWAY_ROLE_GATEWAY = 2      // Own WiFi connection, also forwards for nodes
+};
+
+/**
+ * @brief Parses the node_role setting ("standalone", "node" or "gateway").
+ *
+ * @return GATEWAY_ROLE_STANDALONE for unknown values
+ */
+GatewayRole gatewayRoleFromString(const String& value);
+
+const char* gatewayRoleToString(GatewayRole role);
+
+/**
+ * @brief Starts ESP-NOW for the role; does nothing for standalone or if already started.
+ *
+ * A node puts the radio into station mode without joining a network. A
+ * gateway must call this after WiFi.begin(), ESP-NOW then uses the channel of
+ * its access point.
+ *
+ * @param secret Gateway secret (same on the gateway and its nodes, at least GATEWAY_SECRET_MIN_LEN characters)
+ *
+ * @note Hardware interaction: WiFi radio (ESP-NOW)
+ * @note Side effects: Creates the frame queue, registers ESP-NOW callbacks and keys
+ */
+void gatewayLinkBegin(GatewayRole role, const String& secret);
+
+/**
+ * @brief Role passed to gatewayLinkBegin(), standalone before.
+ */
+GatewayRole gatewayLinkRole();
+
+/**
+ * @brief Node: runs one network worker job through the gateway; blocks the calling task.
+ *
+ * Finds the gateway by sending on all channels if needed. Returns the HTTP
+ * status of the forwarded request, or a negative value if the gateway was not
+ * reachable or could not forward it (the caller journals the interval as for
+ * a WiFi outage).
+ *
+ * @param type Job type; the gateway uses the same request handling
+ * @param url Full request URL; only path and query are sent
+ * @param apiKey API key of this node, sent (encrypted) when the gateway does not know it yet
+ * @param body JSON request body (bodyLen bytes, 0 for GET)
+ * @param context Job context (config hash of conditional config fetches)
+ * @param response Receives the JSON response body
+ * @param responseSize Size of response in bytes
+ * @return HTTP status code or a negative error
+ *
+ * @note Hardware interaction: WiFi radio (ESP-NOW, channel changes)
+ */
+int gatewayNodeExchange(NetJobType type, const char* url, const char* apiKey,
+                        const char* body, size_t bodyLen, uint32_t context,
+                        char* response, size_t responseSize);
+
+/**
+ * @brief Node: false for GATEWAY_NODE_RETRY_MS after the gateway could not be reached.
+ */
+bool gatewayNodeReachable();
+
+/**
+ * @brief Gateway: takes received requests and queues them in the network worker; call from loop().
+ *
+ * @note Side effects: Sends ACK frames, updates the peer table
+ */
+void gatewayLinkLoop();
+
+/**
+ * @brief Gateway: sends the result of a NET_JOB_GATEWAY_FORWARD job back to its node.
+ *
+ * @note Hardware interaction: WiFi radio (ESP-NOW)
+ */
+void gatewayHandleForwardResult(const NetResult& result);
+
+/**
+ * @brief Gateway: number of nodes seen since boot.
+ */
+uint32_t gatewayPeerCount();
+
+#endif
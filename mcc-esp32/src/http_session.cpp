@@ -0,0 +1,134 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    http_session.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "http_session.h"
+#include "mcc_log.h"
+#include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+
+// External variables from main.cpp
+extern bool debugEnabled;
+
+static SemaphoreHandle_t sessionMutex = nullptr;
+static HTTPClient sessionHttp;
+static WiFiClient plainClient;
+static WiFiClientSecure secureClient;
+static WiFiClient* activeClient = nullptr;
+static String activeOrigin;   // "scheme://host:port" of the open connection
+
+/**
+ * @brief Extracts "scheme://host[:port]" from a URL.
+ *
+ * @return Empty string if the URL has no scheme
+ */
+static String urlOrigin(const String& url) {
+    int schemeEnd = url.indexOf("://");
+    if (schemeEnd <= 0) {
+        return "";
+    }
+    int pathStart = url.indexOf('/', schemeEnd + 3);
+    return pathStart < 0 ? url : url.substring(0, pathStart);
+}
+
+/**
+ * @brief Opens the connection to origin on the active client and records the setup time.
+ *
+ * HTTPClient reuses an already connected client, so the request itself
+ * starts on the established socket. If this fails, HTTPClient tries once
+ * more and reports the error as usual.
+ */
+static void connectTimed(const String& origin) {
+    const bool tls = origin.startsWith("https");
+    const int hostStart = origin.indexOf("://") + 3;
+    const int portSep = origin.indexOf(':', hostStart);
+    const String host = portSep < 0 ? origin.substring(hostStart) : origin.substring(hostStart, portSep);
+    const uint16_t port = portSep < 0 ? (tls ? 443 : 80) : (uint16_t)origin.substring(portSep + 1).toInt();
+
+    const unsigned long start = millis();
+    const bool connected = tls ? secureClient.connect(host.c_str(), port) : plainClient.connect(host.c_str(), port);
+    const unsigned long duration = millis() - start;
+    metricsRecordConnect(duration, tls, connected);
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: [httpSession] %s connection to %s %s after %lu ms\n", tls ? "TLS" : "TCP",
+                      origin.c_str(), connected ? "established" : "failed", duration);
+    }
+}
+
+static void closeActiveClient() {
+    sessionHttp.end();
+    if (activeClient != nullptr) {
+        activeClient->stop();
+    }
+    activeClient = nullptr;
+    activeOrigin = "";
+}
+
+void httpSessionInit() {
+    if (sessionMutex == nullptr) {
+        sessionMutex = xSemaphoreCreateMutex();
+        // Same behaviour as HTTPClient::begin(url) without CA certificate
+        secureClient.setInsecure();
+        sessionHttp.setReuse(true);
+    }
+}
+
+HttpSession::HttpSession() : endpoint(METRIC_EP_OTHER), startMs(0) {
+    httpSessionInit();
+    xSemaphoreTake(sessionMutex, portMAX_DELAY);
+}
+
+HttpSession::~HttpSession() {
+    // Keeps the socket open if the server answered with keep-alive
+    sessionHttp.end();
+    xSemaphoreGive(sessionMutex);
+}
+
+bool HttpSession::begin(const String& url, MetricEndpoint metricEndpoint) {
+    endpoint = metricEndpoint;
+    startMs = millis();
+    String origin = urlOrigin(url);
+    if (origin.length() == 0) {
+        return false;
+    }
+
+    if (origin != activeOrigin) {
+        if (debugEnabled && activeOrigin.length() > 0) {
+            logSerial.printf("DEBUG: [httpSession] Origin changed, closing connection to %s\n", activeOrigin.c_str());
+        }
+        closeActiveClient();
+        activeClient = url.startsWith("https") ? static_cast<WiFiClient*>(&secureClient) : &plainClient;
+        activeOrigin = origin;
+    } else if (debugEnabled && activeClient->connected()) {
+        logSerial.printf("DEBUG: [httpSession] Reusing connection to %s\n", activeOrigin.c_str());
+    }
+
+    sessionHttp.setTimeout(HTTPCLIENT_DEFAULT_TCP_TIMEOUT);
+    if (!sessionHttp.begin(*activeClient, url)) {
+        return false;
+    }
+    if (!activeClient->connected()) {
+        connectTimed(origin);
+    }
+    return true;
+}
+
+HTTPClient& HttpSession::http() {
+    return sessionHttp;
+}
+
+int HttpSession::recordResult(int httpCode) {
+    metricsRecordHttp(endpoint, millis() - startMs, httpCode);
+    return httpCode;
+}
+
+void httpSessionClose() {
+    httpSessionInit();
+    xSemaphoreTake(sessionMutex, portMAX_DELAY);
+    closeActiveClient();
+    xSemaphoreGive(sessionMutex);
+}
@@ -0,0 +1,83 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    http_session.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Shared keep-alive connection to the backend server. All API requests go
+ * through one HTTPClient and one persistent WiFiClient/WiFiClientSecure, so
+ * consecutive requests to serverUrl reuse the open TCP/TLS connection instead
+ * of paying a full handshake every time.
+ */
+
+#ifndef HTTP_SESSION_H
+#define HTTP_SESSION_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include "metrics.h"
+
+/**
+ * @brief Exclusive use of the shared connection for one request.
+ *
+ * Construct on the stack, call begin() instead of HTTPClient::begin(url) and
+ * use http() exactly like a local HTTPClient. The destructor ends the request
+ * and releases the connection for other tasks. The socket stays open when the
+ * server allows keep-alive.
+ *
+ * @note Side effects: Blocks until no other task is using the connection
+ */
+class HttpSession {
+public:
+    HttpSession();
+    ~HttpSession();
+
+    /**
+     * @brief Prepares a request on the persistent client for url.
+     *
+     * Reuses the open connection if it points to the same scheme, host and
+     * port; otherwise the old connection is closed first. A new connection is
+     * opened here, so its TCP/TLS setup time is measured apart from the
+     * request. Resets the request timeout to the HTTPClient default.
+     *
+     * @param url Full request URL (http:// or https://)
+     * @param endpoint Latency histogram the request is counted in
+     * @return true if the URL could be parsed
+     */
+    bool begin(const String& url, MetricEndpoint endpoint = METRIC_EP_OTHER);
+
+    HTTPClient& http();
+
+    /**
+     * @brief Counts the request in the metrics: time since begin() and result class.
+     *
+     * @param httpCode HTTP status or HTTPClient error (< 0)
+     * @return httpCode
+     */
+    int recordResult(int httpCode);
+
+private:
+    MetricEndpoint endpoint;
+    unsigned long startMs;
+
+    HttpSession(const HttpSession&) = delete;
+    HttpSession& operator=(const HttpSession&) = delete;
+};
+
+/**
+ * @brief Creates the lock protecting the shared connection.
+ *
+ * Must run before a second task issues requests (called by netWorkerBegin()).
+ * Safe to call more than once.
+ */
+void httpSessionInit();
+
+/**
+ * @brief Closes the shared connection, e.g. before deep sleep.
+ *
+ * @note Side effects: Waits for a running request to finish
+ */
+void httpSessionClose();
+
+#endif
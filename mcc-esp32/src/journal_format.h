@@ -0,0 +1,119 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    journal_format.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * On-flash record format of the ride journal (store-and-forward of intervals
+ * that could not be uploaded).
+ */
+
+#ifndef JOURNAL_FORMAT_H
+#define JOURNAL_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define JOURNAL_RECORD_MAGIC 0x4D434A52u   // "MCJR"
+#define JOURNAL_ID_TAG_LEN 40
+
+// Stored outside the CRC so a record can be marked as sent with a single in-place write
+#define JOURNAL_STATE_PENDING 0x50454E44u  // "PEND"
+#define JOURNAL_STATE_SENT    0x53454E54u  // "SENT"
+
+struct JournalRecord {
+    uint32_t magic;
+    uint32_t seq;            // Monotonic sequence number, defines replay order
+    uint32_t recordedMs;     // millis() when the interval was recorded
+    uint32_t pulses;         // Pulses in the interval
+    float distance_mm;       // Distance with the wheel size valid at record time
+    char idTag[JOURNAL_ID_TAG_LEN];
+    uint32_t crc;            // CRC-32 over all preceding fields
+    uint32_t state;          // JOURNAL_STATE_PENDING or JOURNAL_STATE_SENT
+};
+
+/**
+ * @brief Summary of the records found when scanning the journal after boot.
+ */
+struct JournalScan {
+    bool any;                   // At least one valid record was found
+    uint32_t nextSeq;           // Sequence number for the next append
+    uint32_t oldestPendingSeq;  // Lowest pending sequence number (valid if pendingCount > 0)
+    uint32_t pendingCount;
+};
+
+/**
+ * @brief CRC-32 (IEEE 802.3, reflected, as used by zlib).
+ *
+ * @param crc Previous CRC to continue a running checksum, 0 to start
+ */
+static inline uint32_t journalCrc32(const uint8_t* data, size_t len, uint32_t crc = 0) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static inline uint32_t journalRecordCrc(const JournalRecord* rec) {
+    return journalCrc32((const uint8_t*)rec, offsetof(JournalRecord, crc));
+}
+
+/**
+ * @brief Fills a pending record and computes its CRC.
+ */
+static inline void journalRecordInit(JournalRecord* rec, uint32_t seq, uint32_t recordedMs,
+                                     const char* idTag, uint32_t pulses, float distance_mm) {
+    memset(rec, 0, sizeof(*rec));
+    rec->magic = JOURNAL_RECORD_MAGIC;
+    rec->seq = seq;
+    rec->recordedMs = recordedMs;
+    rec->pulses = pulses;
+    rec->distance_mm = distance_mm;
+    if (idTag != nullptr) {
+        strncpy(rec->idTag, idTag, JOURNAL_ID_TAG_LEN - 1);
+    }
+    rec->crc = journalRecordCrc(rec);
+    rec->state = JOURNAL_STATE_PENDING;
+}
+
+/**
+ * @brief Checks magic and CRC; torn or erased slots are rejected.
+ */
+static inline bool journalRecordValid(const JournalRecord* rec) {
+    return rec->magic == JOURNAL_RECORD_MAGIC && rec->crc == journalRecordCrc(rec) &&
+           rec->idTag[JOURNAL_ID_TAG_LEN - 1] == '\0';
+}
+
+static inline void journalScanReset(JournalScan* scan) {
+    scan->any = false;
+    scan->nextSeq = 0;
+    scan->oldestPendingSeq = 0;
+    scan->pendingCount = 0;
+}
+
+/**
+ * @brief Feeds one slot read from flash into the scan. Slots may come in any order.
+ */
+static inline void journalScanAdd(JournalScan* scan, const JournalRecord* rec) {
+    if (!journalRecordValid(rec)) {
+        return;
+    }
+    if (!scan->any || rec->seq + 1 > scan->nextSeq) {
+        scan->nextSeq = rec->seq + 1;
+    }
+    scan->any = true;
+    if (rec->state == JOURNAL_STATE_PENDING) {
+        if (scan->pendingCount == 0 || rec->seq < scan->oldestPendingSeq) {
+            scan->oldestPendingSeq = rec->seq;
+        }
+        scan->pendingCount++;
+    }
+}
+
+#endif // JOURNAL_FORMAT_H
@@ -8,9 +8,11 @@
 
 #include "led_control.h"
 
+// External variables from main.cpp (also changed by the config server)
+extern bool ledEnabled;
+
 static bool ledIsOn = false;
 static unsigned long ledOnTime = 0;
-static bool ledEnabled = false;
 
 /**
  * @brief Initializes the LED pin and enables/disables LED functionality.
@@ -33,7 +35,8 @@ void setupLed(bool enabled) {
  * @brief Updates LED state based on pulse detection.
  * 
  * If LED is enabled and a pulse is detected, turns LED on for 50ms.
- * Automatically turns LED off after the timeout period.
+ * Automatically turns LED off after the timeout period; call with false
+ * from loop() so the LED blinks without blocking.
  * 
  * @param pulseDetected If true, triggers LED to turn on for 50ms
  * 
@@ -41,9 +44,7 @@ void setupLed(bool enabled) {
  * @note Side effects: Controls LED state based on pulse events
  */
 void updateLed(bool pulseDetected) {
-    if (!ledEnabled) return;
-
-    if (pulseDetected) {
+    if (pulseDetected && ledEnabled) {
         ledIsOn = true;
         ledOnTime = millis();
         digitalWrite(LED_PIN, HIGH);
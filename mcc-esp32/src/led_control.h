@@ -28,7 +28,8 @@ void setupLed(bool enabled);
  * @brief Updates LED state based on pulse detection.
  * 
  * If LED is enabled and a pulse is detected, turns LED on for 50ms.
- * Automatically turns LED off after the timeout period.
+ * Automatically turns LED off after the timeout period; call with false
+ * from loop() so the LED blinks without blocking.
  * 
  * @param pulseDetected If true, triggers LED to turn on for 50ms
  * 
@@ -13,11 +13,34 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <Update.h>
-#include "driver/pcnt.h"
 #include "configserver.h"
 #include "esp_system.h" // unique chip ID
 #include "led_control.h" // Header for LED control
 #include "device_management.h" // Device management APIs
+#include "pulse_capture.h" // ISR timestamp based speed measurement
+#include "pulse_counter.h" // PCNT overflow accumulator and deep sleep carry
+#include "net_worker.h" // Asynchronous HTTP requests outside of loop()
+#include "http_session.h" // Shared keep-alive connection to the server
+#include "ride_journal.h" // Store-and-forward of intervals during outages
+#include "payload_codec.h" // JSON request/response exchange with the server
+#include "tag_cache.h" // Cached username lookups for known ID tags
+#include "ui_scheduler.h" // Timed OLED screens without delay()
+#include "fast_resume.h" // Cached WiFi and session state across deep sleep
+#include "ulp_pulse_counter.h" // Pulse counting by the ULP during riding sleeps
+#include "device_config.h" // Persistent configuration with dirty tracking
+#include "metrics.h" // Loop, request and connection timing for heartbeat and /metrics
+#include "velos.h" // Local extrapolation of the session Velos between server responses
+#include "wifi_manager.h" // Non-blocking WiFi connection with backoff and fallback network
+#include "gateway_link.h" // ESP-NOW uplink of bike nodes through a gateway device
+#include "mqtt_link.h" // Optional MQTT transport with server pushes
+#include "bike_channel.h" // Further bikes of a multi-bike station on their own PCNT units
+#include "ride_state.h" // Consistent ride state snapshot for readers outside loop()
+#include "mcc_log.h" // Deferred serial log, kept in RAM for the portal
+#include "pulse_replay.h" // On-device pulse generator for load tests (ENABLE_PULSE_REPLAY)
+#include "boot_profile.h" // Timestamps of the init stages for the boot timeline
+#include "api_wire.h" // Request bodies and response fields, shared with the fleet simulator
+#include "upload_scheduler.h" // Jittered upload intervals and server backpressure
+#include "esp_timer.h"
 // getFirmwareVersion() is declared in device_management.h
 
 #ifdef ENABLE_OLED
@@ -88,9 +111,6 @@ MFRC522 mfrc522(SS_PIN, RST_PIN);
   #define SENSOR_PIN PulseMeasurePin
 #endif
 
-// Configure PCNT unit
-#define PCNT_UNIT PCNT_UNIT_0
-
 // Wait time at the beginning of setup for configuration mode (in milliseconds)
 //RR const unsigned long CONFIG_WAIT_TIME_MS = 120000; // 2 min= 120000
 
@@ -101,6 +121,9 @@ unsigned long deepSleepTimeout_sec = 300; // Time in seconds until deep sleep, d
 // API endpoint paths (legacy - device management APIs are in device_management.h)
 const char* API_UPDATE_DATA_PATH = "/api/update-data"; // Path for sending tachometer data
 const char* API_GET_USER_ID_PATH = "/api/get-user-id"; // Path for retrieving user data
+const char* API_UPDATE_DATA_BATCH_PATH = "/api/update-data-batch"; // Path for sending several intervals at once
+const size_t UPDATE_DATA_PAYLOAD_LEN = 448; // Buffer for one serialized update-data body (fits into a net worker job)
+const size_t UPDATE_DATA_TRACE_PAYLOAD_LEN = UPDATE_DATA_PAYLOAD_LEN + RIDE_TRACE_BASE64_LEN + 64; // With a ride trace (heap copy in the net worker)
 
 // global variables for configuration mode
 const unsigned long CONFIG_TIMEOUT_SEC = 300; // Timeout in seconds (5 minutes)
@@ -123,15 +146,20 @@ static bool idTagAtConfigStartInitialized = false;
 
 String wifi_ssid = "";
 String wifi_password = "";
+String wifi_ssid2 = "";      // Optional fallback network
+String wifi_password2 = "";
 String deviceName = "";
 String idTag = "";        // uid from RFID tag
 String username ="";      // internal symbolic name from admin database
 String lastSentIdTag = "";
 bool idTagFromRFID = false;  // Track if current idTag came from RFID detection (true) or default user (false)
 unsigned long lastServerErrorTime = 0;  // Track last server error time for backoff
-unsigned long serverErrorBackoffInterval = 60000;  // Wait 60 seconds between retries after server error
+UploadScheduler uploadScheduler;  // Upload intervals with jitter, early uploads and server error backoff
+uint32_t pulsesSubmitted = 0;  // Counter value of the last queued upload (pending until its result)
 bool apiKeyErrorActive = false;  // Track if API key error is active (don't show username error until fixed)
-int wifiConnectAttempts = 0;  // Track number of WiFi connection attempts (max 3)
+int wifiConnectAttempts = 0;  // Consecutive failed WiFi attempts; the error screen is shown from the 3rd on
+unsigned long loopStartUs = 0;  // micros() at the start of the current loop() pass, 0 after a light sleep
+const unsigned long WIFI_CONNECT_WAIT_MS = 12000;  // connectToWiFi() waits this long, then the manager continues in the background
 float wheel_size = 2075.0;  // Default: 26 Zoll = 2075 mm circumference
 float paedagogischer_bonus = 0.0f;
 String serverUrl = "";
@@ -144,55 +172,113 @@ bool ledIsOn = false;
 unsigned long ledOnTime = 0;
 float speed_kmh = 0;
 unsigned int configFetchInterval_sec = 3600; // Default: 1 hour
+unsigned int uploadBatchSize = 1; // Intervals per upload; 1 = every interval is sent on its own
+bool batchUploadUnsupported = false; // Server has no batch endpoint, fall back to single uploads
+unsigned long lastBatchUploadTime = 0; // Last time a batch was queued
+uint32_t batchIsolateSeq = 0; // Batch up to this seq was rejected (400): replay one by one until it is through, 0 = none
+TagCache tagCache; // Recent get-user-id results, so known riders can count right after the tap
+bool userIdLookupBlocking = false; // Counting waits for the lookup of an uncached ID tag
 unsigned long lastConfigFetchTime = 0; // Timestamp of last config fetch
+String staticIp = ""; // "ip,gateway,subnet[,dns]"; empty = DHCP
+String mqttUrl = ""; // MQTT broker; empty = uploads and config over HTTP only
+bool fastWake = false; // Cached WiFi data after a deep sleep or riding sleep: connect without scan, defer server calls
+bool lowPowerRide = false; // Light sleep between uploads while the ULP counts pulses
+bool lowPowerRideUnsupported = false; // ULP could not be started on this board/pin
+unsigned int traceMaxBytes = 0; // Ride trace bytes per upload, 0 = no trace (server config trace_max_bytes)
+unsigned int traceInterval_sec = 0; // Seconds between uploads with a trace, 0 = every upload
+unsigned long lastTraceUploadTime = 0; // millis() of the last upload that carried a trace, 0 = none yet
+GatewayRole gatewayRole = GATEWAY_ROLE_STANDALONE; // node_role: own WiFi, uplink through a gateway, or gateway
+String gatewaySecret = ""; // Keys the ESP-NOW link between a gateway and its nodes
+SyncResult connectSyncResult = SYNC_UNSUPPORTED; // Sync after the last WiFi connection (SYNC_UNSUPPORTED: separate calls were used)
+unsigned long deferredServerCallsStart = 0; // Fast wakeup time; heartbeat and config report follow FAST_RESUME_DEFER_MS later, 0 = none
+bool fastBoot = false; // fast_boot: counting first, splash and tones from loop(), WiFi connects in the background
+bool bootTonePending = false; // Startup or wakeup tone deferred by fast boot, played on the first loop pass
+bool backgroundConnectPending = false; // connectToWiFi() returned without waiting; loop() finishes the connect
+BootProfile bootProfile = {}; // Init stages of this boot, sent once with the first heartbeat or sync
 // variables for OLED
 int textWidth=0;
 const char* textline="";
 
 // Counter and distance
-int16_t currentPulseCount = 0;
-int16_t lastPulseCount = 0;
+// 32-bit session counters derived from the 64-bit PCNT accumulator; unsigned differences stay correct across wrap
+uint32_t currentPulseCount = 0;
+uint32_t lastPulseCount = 0;
 float totalDistance_mm = 0;       // total distance traveled for current user since start or wakeup (in mm)
 float distanceInInterval_mm = 0; // distance traveled between two send cycles (in mm)
-int16_t pulsesAtLastSend = 0; // stores counter value at last send
+uint32_t pulsesAtLastSend = 0; // stores counter value at last send
+uint32_t distanceSession = 0; // incremented on every counter reset, detects stale upload results
+
+// Further bikes of a multi-bike station (PCNT unit = index + 1), uploaded together per send interval
+BikeChannel stationBikes[BIKE_CHANNEL_MAX - 1];
+uint8_t stationBikeCount = 0;
+unsigned long lastStationSendTime = 0;
 
 // Timer for data transmission
 unsigned long lastDataSendTime = 0;
 unsigned long reconnectLastAttemptTime = 0;
 const unsigned long RECONNECT_INTERVAL_MS = 30000;
 
+// Goodbye screen before deep sleep; a pulse during this time keeps the device awake
+const unsigned long SLEEP_NOTICE_MS = 10000;
+unsigned long sleepNoticeStart = 0; // 0 = no goodbye screen shown
+
+// Riding sleeps end this long before the next upload, so WiFi is back in time
+const unsigned long LOW_POWER_WAKE_AHEAD_MS = 1500;
+// Shorter sleeps are not worth switching WiFi off
+const unsigned long LOW_POWER_MIN_SLEEP_MS = 3000;
+
 // Global variable for suffix
 String deviceIdSuffix;
 
 
 unsigned long lastPulseTime = 0; // Timestamp of last pulse
-float currentSpeed_kmh = 0.0; // Current speed calculated from time between pulses (averaged)
-unsigned long previousPulseTime = 0; // Timestamp of previous pulse for speed calculation
-const unsigned long SPEED_TIMEOUT_MS = 5000; // After 5 seconds without pulse → 0 km/h
-const int SPEED_AVERAGE_COUNT = 5; // Number of pulses to average for speed smoothing
-float speedHistory[SPEED_AVERAGE_COUNT] = {0.0, 0.0, 0.0, 0.0, 0.0}; // Array to store last 5 speed values
+float currentSpeed_kmh = 0.0; // Current speed from the pulse capture task (averaged)
 
 // Server-authoritative session Velos for OLED display
 char displayedSessionVelosStr[16] = "0";
 String sessionEpoch = "";
 bool hasSessionVelosFromServer = false;
+// Live session value plus local pulses, shown between server responses (see anchorLocalVelos())
+VelosAnchor velosAnchor = {false, -1.0f, 0, 0};
 // Set when a server response changes the displayed Velos, so the OLED is
 // refreshed even without a new pulse (e.g. after a pedaling pause).
 bool oledVelosNeedsRefresh = false;
-int speedHistoryIndex = 0; // Current index in speed history array
-int speedHistoryCount = 0; // Number of valid values in speed history (0 to SPEED_AVERAGE_COUNT)
 
 // --- Function prototypes ---
 /**
  * @brief Connects the ESP32 to a WiFi network using stored credentials.
  * 
- * Reads WiFi SSID and password from global variables and attempts connection.
+ * Starts the WiFi manager with the primary and fallback network and waits
+ * up to WIFI_CONNECT_WAIT_MS. Only used in setup() and on mode changes;
+ * loop() reconnects through wifiManagerLoop() without waiting.
  * Updates OLED display (if enabled) with connection status.
  * 
+ * @param wait false: return right away, loop() handles the connect like a
+ *             fast wakeup (fast boot)
+ * 
  * @note Hardware interaction: OLED display (if ENABLE_OLED is defined)
  * @note Side effects: Modifies WiFi state, updates OLED display, writes to Serial
  */
-void connectToWiFi();
+void connectToWiFi(bool wait = true);
+
+/**
+ * @brief true if requests of the network worker can reach the server.
+ * 
+ * WiFi connection, or on a node the gateway (see gatewayNodeReachable()).
+ */
+bool uplinkConnected();
+
+/**
+ * @brief Server sync, firmware check and username query after a WiFi connection.
+ * 
+ * @param fastConnect true after a fast resume; the server calls are deferred then
+ */
+void onWiFiConnected(bool fastConnect);
+
+/**
+ * @brief Shows the connection error; the WiFi manager already scheduled the next attempt.
+ */
+void onWiFiConnectFailed();
 
 /**
  * @brief Sends tachometer data to the configured server via HTTP POST.
@@ -204,12 +290,257 @@ void connectToWiFi();
  * @param distanceInInterval_mm Distance traveled in the interval in millimeters
  * @param pulsesInInterval Number of pulses detected in the interval
  * @param isTest If true, sends simulated test data instead of real measurements
+ * @param idTagOverride If set, data is sent for this ID tag instead of the current idTag
  * @return HTTP status code on success (>0), -1 on WiFi error, -2 on configuration error
  * 
  * @note Hardware interaction: LED_PIN (blinks during transmission)
  * @note Side effects: Sends HTTP request, controls LED, writes to Serial
  */
-int  sendDataToServer(float currentSpeed_kmh, float distanceInInterval_mm, int pulsesInInterval, bool isTest);
+int  sendDataToServer(float currentSpeed_kmh, float distanceInInterval_mm, int pulsesInInterval, bool isTest, const char* idTagOverride = nullptr);
+
+/**
+ * @brief Uploads pulses that were counted but not sent before the last deep sleep.
+ * 
+ * The pulses are kept in RTC memory together with the ID tag of the rider
+ * and are sent for that tag, independent of the current user.
+ * 
+ * @note Side effects: Queues an upload in the network worker (see handleCarryUploadResult())
+ */
+void uploadCarriedPulses();
+
+/**
+ * @brief Replays the oldest interval from the ride journal.
+ * 
+ * @note Side effects: Queues an upload in the network worker (see handleJournalReplayResult())
+ */
+void replayJournal();
+
+/**
+ * @brief Uploads up to uploadBatchSize journaled intervals in one request.
+ * 
+ * @note Side effects: Queues an upload in the network worker (see handleJournalBatchResult())
+ */
+void replayJournalBatch();
+
+/**
+ * @brief Builds the JSON body for the update-data endpoint.
+ * 
+ * @param out Receives the serialized JSON payload (UPDATE_DATA_PAYLOAD_LEN bytes, UPDATE_DATA_TRACE_PAYLOAD_LEN with a trace)
+ * @return Payload length, 0 if it did not fit
+ * 
+ * @note Side effects: Consumes a pending boot_reason
+ */
+size_t buildUpdateDataPayload(char* out, size_t outSize, float currentSpeed_kmh, float distanceInInterval_mm, int pulsesInInterval, bool isTest, const char* idTagOverride, const RideStats* stats = nullptr, const RideTrace* trace = nullptr);
+
+/**
+ * @brief Builds the JSON body for the update-data-batch endpoint.
+ * 
+ * @return Serialized JSON payload
+ */
+String buildUpdateDataBatchPayload(const JournalRecord* records, uint32_t count);
+
+/**
+ * @brief Starts the PCNT units of the bikes listed in the station_bikes setting.
+ * 
+ * @note Hardware interaction: PCNT units 1 .. BIKE_CHANNEL_MAX - 1, their sensor pins
+ */
+void beginStationBikes();
+
+/**
+ * @brief Tracks the activity of the station bikes and uploads their intervals in one batch.
+ * 
+ * Runs every loop(); a pulse on any bike postpones deep sleep like one on SENSOR_PIN.
+ * 
+ * @note Side effects: Updates lastPulseTime, queues a NET_JOB_STATION_BATCH upload
+ */
+void stationBikesLoop();
+
+/**
+ * @brief Evaluates the result of a station batch upload; failed intervals go to the ride journal.
+ * 
+ * Each interval carries the channel number as seq. The server acknowledges with
+ * {"last_seq": N}: channels up to N are confirmed, later ones stay pending for the next batch.
+ * 
+ * @param responseCode HTTP status code (< 0 on connection error)
+ * @param response Response body (may be empty)
+ * 
+ * @note Side effects: Updates the station channels, writes the journal
+ */
+void handleStationBatchResult(int responseCode, const char* response);
+
+/**
+ * @brief Moves the pending intervals of the station bikes into the ride journal.
+ * 
+ * @param takeCurrent true: everything counted so far (before sleep); false: the batch in flight
+ * 
+ * @note Side effects: Writes the journal
+ */
+void journalStationBikes(bool takeCurrent);
+
+/**
+ * @brief Builds the JSON body for the get-user-id endpoint.
+ */
+String buildUserIdPayload(const String& tagId);
+
+/**
+ * @brief Evaluates a get-user-id response; shared by the sync and the worker path.
+ * 
+ * @return Same values as getUserIdFromTag()
+ */
+String applyUserIdResponse(int httpCode, const String& response);
+
+/**
+ * @brief Queues a username lookup for the current idTag in the network worker.
+ * 
+ * @return true if the lookup was queued
+ */
+bool requestUserIdLookup(bool fromTagChange);
+
+/**
+ * @brief Uses the cached username for the current idTag after a tag change.
+ * 
+ * @return true if the tag was cached and counting can start immediately
+ */
+bool applyCachedUsername();
+
+/**
+ * @brief Stores the outcome of a get-user-id lookup in the tag cache.
+ */
+void cacheUserIdResult(const String& tagId, const String& newUsername, const String& response);
+
+/**
+ * @brief Loads the tag cache from NVS; all entries start stale.
+ */
+void loadTagCache();
+
+/**
+ * @brief Writes the tag cache to NVS.
+ */
+void saveTagCache();
+
+/**
+ * @brief Applies the username returned by a lookup to the global state and OLED.
+ */
+void handleUserIdResult(const String& newUsername, bool fromTagChange);
+
+/**
+ * @brief Evaluates the result of a regular update-data upload.
+ */
+void handleUpdateDataResult(int responseCode, const char* response, uint32_t pulseSnapshot, uint32_t session, const char* sentIdTag);
+
+/**
+ * @brief Takes a server session value as base for the local Velos estimate.
+ * 
+ * @param live false for a frozen round or a response without numeric Velos (shown as sent)
+ * @param velos Session Velos of the response
+ * @param sessionKm session_km of the response, negative if not sent
+ * @param newSession true for the first value or a changed session_epoch
+ */
+void anchorLocalVelos(bool live, int velos, float sessionKm, bool newSession);
+
+/**
+ * @brief Velos for the data screen: local estimate if anchored, else the server string.
+ */
+void formatDisplayedVelos(char* out, size_t outSize);
+
+/**
+ * @brief Publishes the ride globals as a snapshot (see ride_state.h).
+ * 
+ * Called by loop() once per pass and before drawing, so readers in other
+ * tasks never see a half-updated rider, speed or Velos value.
+ */
+void publishRideState();
+
+/**
+ * @brief Evaluates the result of a carried pulse upload.
+ */
+void handleCarryUploadResult(int responseCode);
+
+/**
+ * @brief Evaluates the result of a journal replay upload.
+ */
+void handleJournalReplayResult(int responseCode, uint32_t seq);
+
+/**
+ * @brief Evaluates the result of a batch upload.
+ */
+void handleJournalBatchResult(int responseCode, const String& response, uint32_t lastSeqInBatch, const char* lastIdTag);
+
+/**
+ * @brief true if the server rejected the data itself, so a retry cannot succeed.
+ */
+bool isPermanentUploadError(int responseCode);
+
+/**
+ * @brief true while server requests are paused after an error (retry_after or exponential backoff).
+ */
+bool serverBackoffActive();
+
+/**
+ * @brief Records a server error and pauses all server requests.
+ */
+void noteServerError(uint32_t retryAfterSec);
+
+/**
+ * @brief Reads retry_after and upload_interval_seconds of an upload response.
+ */
+ApiWireBackpressure readBackpressure(const char* response);
+
+/**
+ * @brief Journals the pulses of the previous rider that were not uploaded yet.
+ */
+void flushRiderInterval();
+
+/**
+ * @brief Takes all finished network worker results and applies them in loop().
+ * 
+ * @note Side effects: Modifies globals, NVS (config fetch) and OLED display
+ */
+void processNetResults();
+
+/**
+ * @brief Applies messages the server pushed over MQTT (upload results, config, display, operator reset).
+ * 
+ * @note Side effects: Modifies globals, NVS (config) and OLED display
+ */
+void processMqttMessages();
+
+/**
+ * @brief Turns off the display and enters deep sleep after the goodbye screen.
+ * 
+ * @param hasValidUsername true if unsent pulses of the current session may be carried
+ */
+void enterDeepSleep(bool hasValidUsername);
+
+/**
+ * @brief Light sleep until shortly before the next upload while the ULP counts pulses.
+ * 
+ * WiFi is switched off during the sleep and reconnected with the cached
+ * channel, BSSID and IP afterwards. The device wakes on the timer or, with
+ * RFID_IRQ_PIN, on the reader interrupt.
+ * 
+ * @param sleepMs Sleep duration in milliseconds
+ * 
+ * @note Hardware interaction: ULP coprocessor, SENSOR_PIN (RTC IO during sleep), WiFi radio, RFID_IRQ_PIN
+ * @note Side effects: Adds the ULP pulses to the pulse counter, blocks for sleepMs
+ */
+void lowPowerRideSleep(uint32_t sleepMs);
+
+/**
+ * @brief Records the end of an init stage in the boot timeline.
+ * 
+ * @param stage Stage name (string literal), also the key in "boot_timeline"
+ * 
+ * @note Side effects: Ignored once the timeline was sent or is full
+ */
+void bootMark(const char* stage);
+
+/**
+ * @brief Prints the boot timeline: stage end and duration in ms, slowest stage.
+ * 
+ * @note Side effects: Writes to the log
+ */
+void printBootTimeline();
 
 /**
  * @brief Displays all configuration values stored in NVS to Serial output.
@@ -249,6 +580,8 @@ void getPreferences();
  * Clears both software counters and hardware PCNT unit. Called when a new RFID tag is detected
  * to start fresh distance tracking for the new user.
  * 
+ * Pulses carried over from before deep sleep are kept and uploaded separately.
+ * 
  * @note Hardware interaction: PCNT_UNIT (hardware pulse counter)
  * @note Side effects: Resets global distance variables and hardware counter
  */
@@ -310,9 +643,19 @@ void play_tag_detected_tone();
  * @note Only compiled if ENABLE_OLED is defined
  */
 #ifdef ENABLE_OLED
-void display_IdTag_Name(const char* text, bool isRfidDetected = false, bool queryWasSuccessful = false);
-void display_OperatorReset(bool didReset, const char* defaultUserName, const char* defaultTag);
-void display_ServerError(const char* errorType, int errorCode);
+void display_IdTag_Name(const char* text, bool isRfidDetected = false, bool queryWasSuccessful = false, uint16_t holdMs = 0);
+void display_OperatorReset(bool didReset, const char* defaultUserName, const char* defaultTag, uint16_t holdMs = 0);
+void display_ServerError(const char* errorType, int errorCode, uint16_t holdMs = 0);
+
+/**
+ * @brief Shows the WiFi status screen (project name, device name, status, SSID).
+ * 
+ * @param status Third line, e.g. "Verbinde mit WLAN:"
+ * @param holdMs Time the screen stays visible before the next screen or the data screen
+ * 
+ * @note Hardware interaction: OLED display (via the UI scheduler)
+ */
+void display_WifiStatus(const char* status, uint16_t holdMs);
 #endif
 
 /**
@@ -365,10 +708,22 @@ void display_Data();
  */
 void setup() {
     Serial.begin(115200); 
-    delay(1000);
-
+    mccLogBegin();
+    bootMark("setup");
+    esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+    const bool wokeFromDeepSleep = (wakeup_reason == ESP_SLEEP_WAKEUP_EXT0);
+    fastResumeBegin(wokeFromDeepSleep);
+
+    // After a wakeup the rider is already pedaling: the PCNT unit counts in hardware
+    // from here on, whatever the rest of setup() takes
+    bool pulseCountingStarted = false;
+    if (wokeFromDeepSleep) {
+        pulseCounterBegin(SENSOR_PIN);
+        pulseCountingStarted = true;
+        bootMark("pcnt");
+    }
 
-    Serial.printf("Setup: debugEnabled= %d\n", debugEnabled);
+    logSerial.printf("Setup: debugEnabled= %d\n", debugEnabled);
 
     // Generate unique device ID
     uint8_t mac[6];
@@ -378,13 +733,27 @@ void setup() {
     deviceIdSuffix = String("_") + String(macSuffix);
 
 
-    Serial.println("Setup: Reading configuration from NVS storage, getPreferences ...");
-    delay(1000);
+    logSerial.println("Setup: Reading configuration from NVS storage, getPreferences ...");
     preferences.begin("bike-tacho", false);
     getPreferences();
+    setupLed(ledEnabled);
     
     // Initialize device management (loads timestamps, firmware version)
     initDeviceManagement();
+    bootMark("nvs");
+
+    if (!wokeFromDeepSleep && !fastBoot) {
+        delay(2000);
+    }
+    if (fastBoot && !pulseCountingStarted) {
+        pulseCounterBegin(SENSOR_PIN);
+        pulseCountingStarted = true;
+        bootMark("pcnt");
+    }
+    if (pulseCountingStarted) {
+        // Speed capture needs wheel_size from NVS; pulses before this are counted, not timed
+        pulseCaptureBegin(SENSOR_PIN);
+    }
 
     // ----------------------------------------------------------------------
     // CHECK and CLEAR CONFIG-EXIT FLAG
@@ -392,9 +761,9 @@ void setup() {
     bool wasConfigExit = preferences.getBool("configExit", false);
     if (wasConfigExit) {
         if (!preferences.putBool("configExit", false)) { // Reset flag immediately
-            Serial.print("ERROR: getPreferences() - Failed to write parameter 'configExit' to NVS\n");
+            logSerial.print("ERROR: getPreferences() - Failed to write parameter 'configExit' to NVS\n");
         }
-        Serial.println("INFO: Previous restart was triggered to exit configuration mode.");
+        logSerial.println("INFO: Previous restart was triggered to exit configuration mode.");
     }
 
     // ----------------------------------------------------------------------
@@ -419,51 +788,49 @@ void setup() {
     #endif
     
     // Check for default_id_tag (not idTag, as idTag might be temporarily set by RFID)
-    String defaultIdTagCheck = preferences.getString("default_id_tag", "");
-    if (defaultIdTagCheck.length() == 0) {
-        defaultIdTagCheck = preferences.getString("idTag", ""); // Fallback to legacy key
-    }
+    String defaultIdTagCheck = deviceConfig.defaultIdTag;
     
     bool criticalConfigMissing = false;
     String missingParameter = "";  // Store the first missing parameter for OLED display
     
     // Check each critical parameter individually and report which one is missing
-    if (wifi_ssid.length() == 0) {
+    // A node uploads through the gateway and needs no network of its own
+    if (wifi_ssid.length() == 0 && gatewayRole != GATEWAY_ROLE_NODE) {
         criticalConfigMissing = true;
         if (missingParameter.length() == 0) missingParameter = "wifi_ssid";
-        Serial.println("ERROR: getPreferences() - Critical parameter 'wifi_ssid' is missing!");
+        MCC_LOGE("getPreferences() - Critical parameter 'wifi_ssid' is missing!");
     }
     // wifi_password.length() == 0 || // Password can be empty, e.g. for Freifunk
     if (defaultIdTagCheck.length() == 0) {
         criticalConfigMissing = true;
         if (missingParameter.length() == 0) missingParameter = "default_id_tag";
-        Serial.println("ERROR: getPreferences() - Critical parameter 'default_id_tag' (or 'idTag') is missing!");
+        MCC_LOGE("getPreferences() - Critical parameter 'default_id_tag' (or 'idTag') is missing!");
     }
     if (wheel_size < 500.0 || wheel_size > 3000.0) {  // Valid range: 500-3000 mm
         criticalConfigMissing = true;
         if (missingParameter.length() == 0) missingParameter = "wheel_size";
-        Serial.printf("ERROR: getPreferences() - Critical parameter 'wheel_size' is invalid (value: %.1f mm, valid range: 500-3000 mm)!\n", wheel_size);
+        MCC_LOGE("getPreferences() - Critical parameter 'wheel_size' is invalid (value: %.1f mm, valid range: 500-3000 mm)!\n", wheel_size);
     }
     if (sendInterval_sec == 0) {
         criticalConfigMissing = true;
         if (missingParameter.length() == 0) missingParameter = "sendInterval";
-        Serial.println("ERROR: getPreferences() - Critical parameter 'sendInterval' is missing or zero!");
+        MCC_LOGE("getPreferences() - Critical parameter 'sendInterval' is missing or zero!");
     }
     if (serverUrlCritical) {
         criticalConfigMissing = true;
         if (missingParameter.length() == 0) missingParameter = "serverUrl";
-        Serial.println("ERROR: getPreferences() - Critical parameter 'serverUrl' is missing!");
+        MCC_LOGE("getPreferences() - Critical parameter 'serverUrl' is missing!");
     }
     if (apiKeyCritical) {
         criticalConfigMissing = true;
         if (missingParameter.length() == 0) missingParameter = "apiKey";
-        Serial.println("ERROR: getPreferences() - Critical parameter 'apiKey' is missing!");
+        MCC_LOGE("getPreferences() - Critical parameter 'apiKey' is missing!");
     }
 
     if (criticalConfigMissing) {
         configMode = true;
         configModeForced = true;
-        Serial.println("WARNING: Critical configurations missing! Forcing configuration mode.");
+        MCC_LOGW("Critical configurations missing! Forcing configuration mode.");
         
         // Display missing parameter on OLED
         #ifdef ENABLE_OLED
@@ -533,14 +900,17 @@ void setup() {
     
     // Initialize LED - let there be light!
     pinMode(LED_PIN, OUTPUT);
-    digitalWrite(LED_PIN, HIGH);  // ON - we're alive!
-    delay(1000);
-    digitalWrite(LED_PIN, LOW);  // OFF
+    // Skipped after deep sleep and with fast boot: the wake pulse should be counted as early as possible
+    if (!wokeFromDeepSleep && !fastBoot) {
+        digitalWrite(LED_PIN, HIGH);  // ON - we're alive!
+        delay(1000);
+        digitalWrite(LED_PIN, LOW);  // OFF
+    }
     
     #ifdef ENABLE_OLED
     #ifdef BOARD_HELTEC
     // Turn on display - time to show
-    Serial.println("DEBUG: Turning on display - time to show");
+    logSerial.println("DEBUG: Turning on display - time to show");
     pinMode(VEXT_PIN, OUTPUT);
     digitalWrite(VEXT_PIN, LOW);  // LOW = ON (intuitive!)
     delay(50);  // Give display time to power up (as in example code)
@@ -549,22 +919,21 @@ void setup() {
     // Initialize display
     // Note: U8G2 with 4-parameter constructor handles I2C initialization internally
     display.begin();
-    if (debugEnabled) {
-        Serial.println("DEBUG: OLED display.begin() called");
-    }
+    MCC_LOGD("OLED display.begin() called");
+    bootMark("oled");
     #endif
  
     // RFID reader
     #ifdef ENABLE_RFID
     RFID_MFRC522_setup();
+    bootMark("rfid");
     #endif
     
     // Print sensor PIN configuration
-    Serial.printf("SENSOR_PIN: %.d \n", SENSOR_PIN);
+    logSerial.printf("SENSOR_PIN: %.d \n", SENSOR_PIN);
 
     // Check wakeup reason
-    esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
-    if (wakeup_reason == ESP_SLEEP_WAKEUP_EXT0) {
+    if (wokeFromDeepSleep) {
         setPendingBootReason("deep_sleep");
     } else {
         setPendingBootReason("power_on");
@@ -577,7 +946,7 @@ void setup() {
         
         configMode = true; // Always activate configuration mode on restart
         
-        Serial.println("Starting configuration mode (Automatic on every restart).");
+        logSerial.println("Starting configuration mode (Automatic on every restart).");
         configModeStartTime = millis(); // Start of timeout
         
         // Store current idTag value to detect if a new RFID tag is detected during config mode
@@ -587,104 +956,140 @@ void setup() {
         String ap_ssid_dynamic = "MCC" + deviceIdSuffix;
 
         #ifdef ENABLE_OLED
-        // First show firmware version for 5 seconds on first start
-        display.clearBuffer();
-        display.setFont(u8g2_font_7x14_tf);
+        if (fastBoot) {
+            // Same screens through the UI scheduler: loop() and counting run while they are shown
+            UiScreen screen;
+            uiScreenInit(&screen, 5000);
+            uiScreenAddLine(&screen, 12, "MyCyclingCity");
+            uiScreenAddLine(&screen, 28, deviceName.c_str());
+            uiScreenAddLine(&screen, 44, "Firmware Version");
+            uiScreenAddLine(&screen, 60, ("v" + getFirmwareVersion()).c_str());
+            uiShowScreen(screen);
+
+            uiScreenInit(&screen, 0);
+            uiScreenAddLine(&screen, 12, "MyCyclingCity");
+            uiScreenAddLine(&screen, 28, deviceName.c_str());
+            uiScreenAddLine(&screen, 44, ("SSID: " + ap_ssid_dynamic).c_str(), 0);
+            uiScreenAddLine(&screen, 60, "IP:   192.168.4.1", 0);
+            uiShowScreen(screen);
+        } else {
+            // First show firmware version for 5 seconds on first start
+            display.clearBuffer();
+            display.setFont(u8g2_font_7x14_tf);
 
-        textline = "MyCyclingCity";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 12); 
-        display.print(textline);
+            textline = "MyCyclingCity";
+            textWidth = display.getStrWidth(textline);
+            display.setCursor((128 - textWidth) / 2, 12); 
+            display.print(textline);
 
-        textline = deviceName.c_str();
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 28); 
-        display.print(textline);
+            textline = deviceName.c_str();
+            textWidth = display.getStrWidth(textline);
+            display.setCursor((128 - textWidth) / 2, 28); 
+            display.print(textline);
 
-        textline = "Firmware Version";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 44);
-        display.print(textline);
+            textline = "Firmware Version";
+            textWidth = display.getStrWidth(textline);
+            display.setCursor((128 - textWidth) / 2, 44);
+            display.print(textline);
 
-        String fwVersion = "v" + getFirmwareVersion();
-        textline = fwVersion.c_str();
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 60);
-        display.print(textline);
+            String fwVersion = "v" + getFirmwareVersion();
+            textline = fwVersion.c_str();
+            textWidth = display.getStrWidth(textline);
+            display.setCursor((128 - textWidth) / 2, 60);
+            display.print(textline);
 
-        display.sendBuffer();
-        delay(5000);  // Show firmware version for 5 seconds
+            display.sendBuffer();
+            delay(5000);  // Show firmware version for 5 seconds
 
-        // Now show config mode parameters
-        display.clearBuffer();
-        display.setFont(u8g2_font_7x14_tf);
+            // Now show config mode parameters
+            display.clearBuffer();
+            display.setFont(u8g2_font_7x14_tf);
 
-        textline = "MyCyclingCity";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 12); 
-        display.print(textline);
+            textline = "MyCyclingCity";
+            textWidth = display.getStrWidth(textline);
+            display.setCursor((128 - textWidth) / 2, 12); 
+            display.print(textline);
 
-        textline = deviceName.c_str();
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 28); 
-        display.print(textline);
+            textline = deviceName.c_str();
+            textWidth = display.getStrWidth(textline);
+            display.setCursor((128 - textWidth) / 2, 28); 
+            display.print(textline);
               
-        display.drawStr(0, 44, "SSID: ");  
-        display.drawStr(40, 44, ap_ssid_dynamic.c_str());
+            display.drawStr(0, 44, "SSID: ");  
+            display.drawStr(40, 44, ap_ssid_dynamic.c_str());
 
-        display.drawStr(0, 60, "IP: ");  
-        display.drawStr(40, 60, "192.168.4.1");
+            display.drawStr(0, 60, "IP: ");  
+            display.drawStr(40, 60, "192.168.4.1");
   
-        display.sendBuffer();
+            display.sendBuffer();
+        }
         #endif
         
-        play_startup_tone(); // <-- CALL: 3x short
+        if (fastBoot) {
+            bootTonePending = true;
+        } else {
+            play_startup_tone(); // <-- CALL: 3x short
+        }
+        bootMark("splash");
 
         setupConfigServer();
+        bootMark("config_ap");
 
         // Don't end setup here so code in loop() runs and checks timeout/pulse.
     } else {
         configMode = false;
-        Serial.println("Awakened from deep sleep. Skipping configuration check.");
-        play_wakeup_tone(); // <-- CALL: 2x short
-        Serial.println("DEBUG: Setup - connectToWiFi() ...");
-        connectToWiFi();
+        logSerial.println("Awakened from deep sleep. Skipping configuration check.");
+
+        // Same rider as before the sleep: continue the session instead of starting a new one
+        if (fastResumeRestoreSession(idTag.c_str(), &username, &sessionEpoch,
+                                 displayedSessionVelosStr, sizeof(displayedSessionVelosStr))) {
+            lastSentIdTag = idTag;
+            hasSessionVelosFromServer = sessionEpoch.length() > 0;
+            MCC_LOGD("Session of %s restored from RTC memory\n", username.c_str());
+        }
+
+        fastWake = fastResumeAvailable(wifi_ssid);
+        if (fastBoot) {
+            bootTonePending = true;
+        } else {
+            play_wakeup_tone(); // <-- CALL: 2x short
+        }
+        logSerial.println("DEBUG: Setup - connectToWiFi() ...");
+        // Fast boot: no waiting here, loop() counts while the manager connects
+        connectToWiFi(!fastBoot);
+        bootMark("wifi");
         
         // Send heartbeat and fetch config after wakeup from deep sleep
-        if (WiFi.status() == WL_CONNECTED) {
-            if (debugEnabled) {
-                Serial.println("DEBUG: Sending heartbeat after wakeup from deep sleep...");
-            }
-            sendHeartbeat();
-            
-            // Fetch device configuration after wakeup from deep sleep
-            if (configFetchInterval_sec > 0) {
-                if (debugEnabled) {
-                    Serial.println("DEBUG: Fetching device configuration after wakeup from deep sleep...");
-                }
-                if (fetchDeviceConfig()) {
-                    lastConfigFetchTime = millis();
-                    // Reload default_id_tag from NVS after config fetch, in case it was updated
-                    // This ensures we use the default_id_tag, not any temporary RFID tag
-                    String defaultIdTag = preferences.getString("default_id_tag", "");
-                    if (defaultIdTag.length() == 0) {
-                        defaultIdTag = preferences.getString("idTag", ""); // Fallback to legacy key
-                    }
-                    if (defaultIdTag.length() > 0) {
-                        idTag = defaultIdTag; // Restore default_id_tag after config fetch
-                        idTagFromRFID = false; // Default user, not from RFID
-                        if (debugEnabled) {
-                            Serial.printf("DEBUG: Default ID tag restored after config fetch: %s\n", defaultIdTag.c_str());
-                        }
-                    }
-                    if (debugEnabled) {
-                        Serial.println("DEBUG: Config fetched successfully after wakeup");
-                    }
-                } else {
-                    if (debugEnabled) {
-                        Serial.println("DEBUG: Config fetch failed after wakeup, will retry later");
+        // After a fast wakeup both run later from loop(), so counting and uploads are not delayed.
+        // With the sync endpoint connectToWiFi() already did both in one request.
+        if (WiFi.status() == WL_CONNECTED && deferredServerCallsStart == 0) {
+            bool configFetched = (connectSyncResult == SYNC_OK);
+            if (connectSyncResult == SYNC_UNSUPPORTED) {
+                MCC_LOGD("Sending heartbeat after wakeup from deep sleep...");
+                sendHeartbeat();
+                
+                // Fetch device configuration after wakeup from deep sleep
+                if (configFetchInterval_sec > 0) {
+                    MCC_LOGD("Fetching device configuration after wakeup from deep sleep...");
+                    if (fetchDeviceConfig()) {
+                        lastConfigFetchTime = millis();
+                        configFetched = true;
+                        MCC_LOGD("Config fetched successfully after wakeup");
+                    } else {
+                        MCC_LOGD("Config fetch failed after wakeup, will retry later");
                     }
                 }
+                bootMark("server");
+            }
+            if (configFetched) {
+                // Reload default_id_tag after config fetch, in case it was updated
+                // This ensures we use the default_id_tag, not any temporary RFID tag
+                String defaultIdTag = deviceConfig.defaultIdTag;
+                if (defaultIdTag.length() > 0) {
+                    idTag = defaultIdTag; // Restore default_id_tag after config fetch
+                    idTagFromRFID = false; // Default user, not from RFID
+                    MCC_LOGD("Default ID tag restored after config fetch: %s\n", defaultIdTag.c_str());
+                }
             }
         }
 
@@ -692,33 +1097,42 @@ void setup() {
     }
         
     // Configure PCNT unit
-    Serial.println("Setup: Configuring ESP32 PCNT counter");
-    pcnt_config_t pcnt_config = {};
-    pcnt_config.pulse_gpio_num = SENSOR_PIN;
-    pcnt_config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
-    pcnt_config.unit = PCNT_UNIT;
-    pcnt_config.channel = PCNT_CHANNEL_0;
-    pcnt_config.counter_h_lim = 0;
-    pcnt_config.counter_l_lim = 0;
-    pcnt_config.pos_mode = PCNT_COUNT_INC;
-    pcnt_config.neg_mode = PCNT_COUNT_DIS;
-    pcnt_config.lctrl_mode = PCNT_MODE_KEEP;
-    pcnt_config.hctrl_mode = PCNT_MODE_KEEP;
-    pcnt_unit_config(&pcnt_config);
-    pcnt_counter_clear(PCNT_UNIT);
-    // 1000 clock cycles / 80,000,000 clock cycles per second = 0.0000125 seconds or 12.5 microseconds
-    pcnt_set_filter_value(PCNT_UNIT, 1023); // wait number of clock cycles, max 1023 cycles definable
-    pcnt_filter_enable(PCNT_UNIT);
-    // Start the PCNT counter so it can detect pulses
-    pcnt_counter_resume(PCNT_UNIT);
+    if (!pulseCountingStarted) {
+        logSerial.println("Setup: Configuring ESP32 PCNT counter");
+        pulseCounterBegin(SENSOR_PIN);
+
+        // Edge timestamps for speed are captured by an ISR and a dedicated task,
+        // so blocking code in loop() no longer distorts the measured intervals
+        pulseCaptureBegin(SENSOR_PIN);
+        bootMark("pcnt");
+    }
+    beginStationBikes();
+    MCC_LOGD("Lifetime pulses since power-on: %llu\n", (unsigned long long)pulseCounterLifetime());
+
+    // Intervals that could not be uploaded survive restarts in flash
+    rideJournalBegin();
+    bootMark("journal");
+
+    // HTTP requests of the periodic path run in their own task
+    netWorkerBegin();
+
+    #ifdef ENABLE_PULSE_REPLAY
+    // Load test: generated pulses on the sensor input (profile needs LittleFS from rideJournalBegin())
+    pulseReplayBegin();
+    #endif
     
-    // Set initial send time
+    // Set initial send time; the first interval is spread per device, so boards that start
+    // together after a power failure do not upload at the same time
     lastDataSendTime = millis();
+    uploadSchedulerInit(&uploadScheduler, ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | ((uint32_t)mac[4] << 8) | mac[5],
+                        lastDataSendTime, (uint32_t)sendInterval_sec * 1000);
 
     // Initialize deep sleep
     //setupDeepSleep(); 
 
-    Serial.println("Setup finished, starting loop ...");
+    bootMark("setup_done");
+    printBootTimeline();
+    logSerial.println("Setup finished, starting loop ...");
     
 }
 
@@ -748,11 +1162,40 @@ void setup() {
  * @note Side effects: Continuous monitoring, periodic HTTP requests, hardware state changes
  */
 void loop() {
+    // Start to start: also covers the passes that leave loop() early
+    const unsigned long loopNowUs = micros();
+    if (loopStartUs != 0) {
+        metricsRecordLoop(loopNowUs - loopStartUs);
+    }
+    loopStartUs = loopNowUs;
+
+    #ifdef ENABLE_PULSE_REPLAY
+    pulseReplayLoop();
+    #endif
+
+    // Fast boot: the tone follows once counting and the loop are running
+    if (bootTonePending) {
+        bootTonePending = false;
+        if (configMode) {
+            play_startup_tone();
+        } else {
+            play_wakeup_tone();
+        }
+    }
 
     // --- CALL RFID PROCESSING ---
     #ifdef ENABLE_RFID
     RFID_MFRC522_loop_handler();
     #endif
+
+    // --- TIMED OLED SCREENS AND LED BLINK ---
+    #ifdef ENABLE_OLED
+    if (uiSchedulerLoop()) {
+        // Last timed screen expired: bring back the data screen
+        oledVelosNeedsRefresh = true;
+    }
+    #endif
+    updateLed(false);
         
     if (configMode) {
         server.handleClient();
@@ -766,9 +1209,7 @@ void loop() {
         if (!idTagAtConfigStartInitialized) {
             idTagAtConfigStart = idTag; // Store idTag value when config mode started
             idTagAtConfigStartInitialized = true;
-            if (debugEnabled) {
-                Serial.printf("DEBUG: Config mode started with idTag: %s\n", idTagAtConfigStart.c_str());
-            }
+            MCC_LOGD("Config mode started with idTag: %s\n", idTagAtConfigStart.c_str());
         }
         
         // Only end config mode if:
@@ -776,7 +1217,7 @@ void loop() {
         // 2. idTag is different from what it was when config mode started (means new RFID tag detected)
         if (idTag.length() > 0 && idTag != idTagAtConfigStart) {
             idTagAtConfigStartInitialized = false; // Reset for next config mode entry
-            Serial.println("\nINFO: RFID tag detected. Ending configuration mode and switching to normal operation.");
+            logSerial.println("\nINFO: RFID tag detected. Ending configuration mode and switching to normal operation.");
             
             // Note: Tag detected tone is already played in RFID_MFRC522_loop_handler() for every tag detection
             
@@ -785,32 +1226,27 @@ void loop() {
             // The RFID tag will be used temporarily in RAM to start counting pulses immediately
             
             if (debugEnabled) {
-                Serial.printf("DEBUG: Using RFID tag temporarily (not saving to NVS): %s\n", idTag.c_str());
-                Serial.println("DEBUG: Default-ID-Tag remains unchanged in NVS");
+                logSerial.printf("DEBUG: Using RFID tag temporarily (not saving to NVS): %s\n", idTag.c_str());
+                logSerial.println("DEBUG: Default-ID-Tag remains unchanged in NVS");
             }
 
             #ifdef ENABLE_OLED
-            display.clearBuffer();
-            display.setFont(u8g2_font_7x14_tf);
-            display.drawStr(20, 12, "ID Tag erkannt!");
-            display.drawStr(20, 28, idTag.c_str());
-            display.drawStr(20, 44, "Wechsel zu");
-            display.drawStr(20, 60, "Normalbetrieb");
-            display.sendBuffer();
-            delay(2000);
+            UiScreen screen;
+            uiScreenInit(&screen, 2000);
+            uiScreenAddLine(&screen, 12, "ID Tag erkannt!", 20);
+            uiScreenAddLine(&screen, 28, idTag.c_str(), 20);
+            uiScreenAddLine(&screen, 44, "Wechsel zu", 20);
+            uiScreenAddLine(&screen, 60, "Normalbetrieb", 20);
+            uiShowScreen(screen);
             #endif
             
             // Stop config server
             server.stop();
-            if (debugEnabled) {
-                Serial.println("DEBUG: Config server stopped");
-            }
+            MCC_LOGD("Config server stopped");
             
             // Disconnect WiFi AP
             WiFi.softAPdisconnect(true);
-            if (debugEnabled) {
-                Serial.println("DEBUG: WiFi AP disconnected");
-            }
+            MCC_LOGD("WiFi AP disconnected");
             
             // Switch WiFi mode to Station only
             WiFi.mode(WIFI_STA);
@@ -819,9 +1255,7 @@ void loop() {
             configMode = false;
             
             // Connect to WiFi and start normal operation
-            if (debugEnabled) {
-                Serial.println("DEBUG: Connecting to WiFi and starting normal operation...");
-            }
+            MCC_LOGD("Connecting to WiFi and starting normal operation...");
             connectToWiFi();
             
             // Reset lastSentIdTag so the RFID tag is recognized as new and counting starts immediately
@@ -835,27 +1269,22 @@ void loop() {
         // --- End configuration mode on timeout ---
         if (millis() - configModeStartTime >= configModeTimeout_sec * 1000) {
             // Check if critical configurations are still missing
-            // Reload preferences to check current state (user might have saved config)
-            preferences.begin("bike-tacho", true); // Read-only mode
-            String currentWifiSsid = preferences.getString("wifi_ssid", "");
-            String currentDefaultIdTag = preferences.getString("default_id_tag", "");
-            if (currentDefaultIdTag.length() == 0) {
-                currentDefaultIdTag = preferences.getString("idTag", "");
-            }
+            // deviceConfig holds the current state (handleSave() updates it when the user saves)
+            String currentWifiSsid = deviceConfig.wifiSsid;
+            String currentDefaultIdTag = deviceConfig.defaultIdTag;
             // Check if DEFAULT_ID_TAG is available as fallback
             #ifdef DEFAULT_ID_TAG
             if (currentDefaultIdTag.length() == 0) {
                 currentDefaultIdTag = String(DEFAULT_ID_TAG);
             }
             #endif
-            float currentWheelSize = preferences.getFloat("wheel_size", 2075.0);  // Default: 26 Zoll = 2075 mm
-            unsigned int currentSendInterval = preferences.getUInt("sendInterval", 0);
-            preferences.end();
+            float currentWheelSize = deviceConfig.wheelSize;
+            unsigned int currentSendInterval = deviceConfig.sendInterval;
             
             // Check if critical configs are still missing
             // Note: serverUrl and apiKey are not critical if DEFAULT values are available
             bool stillMissingCritical = (
-                currentWifiSsid.length() == 0 ||
+                (currentWifiSsid.length() == 0 && deviceConfig.nodeRole != GATEWAY_ROLE_NODE) ||
                 currentDefaultIdTag.length() == 0 ||
                 currentWheelSize == 0.0 ||
                 currentSendInterval == 0
@@ -864,16 +1293,15 @@ void loop() {
             if (stillMissingCritical) {
                 // Critical configs still missing - reset timeout and stay in config mode
                 configModeStartTime = millis(); // Reset timeout timer
-                Serial.println("\nWARNING: Configuration mode timeout reached, but critical configurations still missing. Staying in config mode.");
+                logSerial.println("\nWARNING: Configuration mode timeout reached, but critical configurations still missing. Staying in config mode.");
                 
                 #ifdef ENABLE_OLED
-                display.clearBuffer();
-                display.setFont(u8g2_font_7x14_tf);
-                display.drawStr(20, 12, "Config Timeout");
-                display.drawStr(20, 28, "Bitte");
-                display.drawStr(20, 44, "konfigurieren!");
-                display.sendBuffer();
-                delay(3000);
+                UiScreen screen;
+                uiScreenInit(&screen, 3000);
+                uiScreenAddLine(&screen, 12, "Config Timeout", 20);
+                uiScreenAddLine(&screen, 28, "Bitte", 20);
+                uiScreenAddLine(&screen, 44, "konfigurieren!", 20);
+                uiShowScreen(screen);
                 #endif
                 
                 // Continue in config mode - don't exit
@@ -884,29 +1312,24 @@ void loop() {
             // Reset static variables for next config mode entry
             idTagAtConfigStartInitialized = false;
             
-            Serial.println("\nINFO: Configuration mode timeout reached. All critical configurations present. Switching to normal operation and connecting to server.");
+            logSerial.println("\nINFO: Configuration mode timeout reached. All critical configurations present. Switching to normal operation and connecting to server.");
             
             #ifdef ENABLE_OLED
-            display.clearBuffer();
-            display.setFont(u8g2_font_7x14_tf);
-            display.drawStr(20, 12, "Config Timeout");
-            display.drawStr(20, 28, "Wechsel zu");
-            display.drawStr(20, 44, "Normalbetrieb");
-            display.sendBuffer();
-            delay(2000);
+            UiScreen screen;
+            uiScreenInit(&screen, 2000);
+            uiScreenAddLine(&screen, 12, "Config Timeout", 20);
+            uiScreenAddLine(&screen, 28, "Wechsel zu", 20);
+            uiScreenAddLine(&screen, 44, "Normalbetrieb", 20);
+            uiShowScreen(screen);
             #endif
             
             // Stop config server
             server.stop();
-            if (debugEnabled) {
-                Serial.println("DEBUG: Config server stopped");
-            }
+            MCC_LOGD("Config server stopped");
             
             // Disconnect WiFi AP
             WiFi.softAPdisconnect(true);
-            if (debugEnabled) {
-                Serial.println("DEBUG: WiFi AP disconnected");
-            }
+            MCC_LOGD("WiFi AP disconnected");
             
             // Switch WiFi mode to Station only
             WiFi.mode(WIFI_STA);
@@ -915,14 +1338,10 @@ void loop() {
             configMode = false;
             
             // Reload preferences to get latest values (user might have saved config)
-            preferences.begin("bike-tacho", false);
             getPreferences();
-            preferences.end();
             
             // Connect to WiFi and start normal operation (this will also connect to server)
-            if (debugEnabled) {
-                Serial.println("DEBUG: Connecting to WiFi and starting normal operation...");
-            }
+            MCC_LOGD("Connecting to WiFi and starting normal operation...");
             connectToWiFi();
             
             // Reset lastSentIdTag so the default_id_tag is recognized as new and counting starts immediately
@@ -933,38 +1352,31 @@ void loop() {
         }
 
         // Optional: Pulse detection in config mode for quick switch to normal mode
-        pcnt_get_counter_value(PCNT_UNIT, &currentPulseCount);
+        currentPulseCount = (uint32_t)pulseCounterRead();
         if (currentPulseCount > 0) { // Pulse detected - always allow exit from config mode
             // Reset static variables for next config mode entry
             idTagAtConfigStartInitialized = false;
             
-            Serial.println("\nINFO: Pulse detected. Ending configuration mode and switching to normal operation.");
+            logSerial.println("\nINFO: Pulse detected. Ending configuration mode and switching to normal operation.");
             
-            if (debugEnabled) {
-                Serial.println("DEBUG: Pulse detected, switching to normal operation without restart");
-            }
+            MCC_LOGD("Pulse detected, switching to normal operation without restart");
 
             #ifdef ENABLE_OLED
-            display.clearBuffer();
-            display.setFont(u8g2_font_7x14_tf);
-            display.drawStr(20, 12, "Puls erkannt!");
-            display.drawStr(20, 44, "Wechsel zu");
-            display.drawStr(20, 60, "Normalbetrieb");
-            display.sendBuffer();
-            delay(2000);
+            UiScreen screen;
+            uiScreenInit(&screen, 2000);
+            uiScreenAddLine(&screen, 12, "Puls erkannt!", 20);
+            uiScreenAddLine(&screen, 44, "Wechsel zu", 20);
+            uiScreenAddLine(&screen, 60, "Normalbetrieb", 20);
+            uiShowScreen(screen);
             #endif
             
             // Stop config server
             server.stop();
-            if (debugEnabled) {
-                Serial.println("DEBUG: Config server stopped");
-            }
+            MCC_LOGD("Config server stopped");
             
             // Disconnect WiFi AP
             WiFi.softAPdisconnect(true);
-            if (debugEnabled) {
-                Serial.println("DEBUG: WiFi AP disconnected");
-            }
+            MCC_LOGD("WiFi AP disconnected");
             
             // Switch WiFi mode to Station only
             WiFi.mode(WIFI_STA);
@@ -973,9 +1385,7 @@ void loop() {
             configMode = false;
             
             // Connect to WiFi and start normal operation
-            if (debugEnabled) {
-                Serial.println("DEBUG: Connecting to WiFi and starting normal operation...");
-            }
+            MCC_LOGD("Connecting to WiFi and starting normal operation...");
             connectToWiFi();
             
             // Reset lastSentIdTag so the default_id_tag is recognized as new and counting starts immediately
@@ -987,6 +1397,13 @@ void loop() {
         }
     } else {
 
+        // Apply finished network requests (uploads, username lookups, config fetch)
+        processNetResults();
+        processMqttMessages();
+        // Gateway: queue requests received from nodes
+        gatewayLinkLoop();
+        diagServerLoop();
+
         // ----------------------------------------------------------------------
         // MONITOR ID TAG CHANGE
         // ----------------------------------------------------------------------
@@ -997,12 +1414,12 @@ void loop() {
             // Only play tone if tag was NOT detected via RFID (to avoid double beep)
             // RFID detection already plays tone in RFID_MFRC522_loop_handler()
             if (!idTagFromRFID) {
-                if (debugEnabled) {
-                  Serial.println("DEBUG: play_tag_detected_tone ");
-                }
+                MCC_LOGD("play_tag_detected_tone ");
                 play_tag_detected_tone(); // <-- CALL: 1x long
             }
             
+            // The previous rider's last pulses go to the journal, which uploads them right away
+            flushRiderInterval();
             resetDistanceCounters();
 
             // IMPORTANT CORRECTION: lastSentIdTag MUST be set to the new idTag immediately to end the infinite loop.
@@ -1011,43 +1428,20 @@ void loop() {
             // QUERY USER_ID FROM SERVER AND DISPLAY ON OLED (if enabled)
             // This works independently of RFID - the server is queried for any idTag
             // Only query if WLAN is connected and API key error is not active
-            if (WiFi.status() == WL_CONNECTED && !apiKeyErrorActive) {
-                String newUsername = getUserIdFromTag(idTag);
-                // getUserIdFromTag() returns:
-                // - Valid username string if found
-                // - "NULL" if user not found (HTTP 404 or server returned "NULL")
-                // - "" (empty) if query failed (backoff period, connection error, etc.)
-                if (newUsername.length() > 0) {
-                    // Query was successful - update username (could be valid name or "NULL")
-                    bool wasUsernameNull = (username.length() == 0 || username == "NULL");
-                    bool isUsernameNull = (newUsername == "NULL");
-                    bool usernameChanged = (wasUsernameNull != isUsernameNull) || (username != newUsername);
-                    
-                    if (usernameChanged) {
-                        username = newUsername;
-            
-            #ifdef ENABLE_OLED
-                        // Always update display when ID tag changes (new query was made)
-                        // queryWasSuccessful = true because newUsername.length() > 0 means query was successful
-                        // Note: If HTTP 404, username was already set to "NULL" in getUserIdFromTag() and error was already shown
-            if (username.length() > 0 && username != "NULL") {
-                            display_IdTag_Name(username.c_str(), idTagFromRFID, true);
-            } else {
-                            // HTTP 404 - error message was already shown in getUserIdFromTag(), don't overwrite it
-                            // Just keep the "Radler nicht gefunden" message that was already displayed
-            }
-            delay(3000);
-            #endif
-                    }
-        }  
-                // If newUsername is empty, query failed - don't update username, keep previous value
+            // A cached tag starts counting right away; only unknown tags wait for the server
+            userIdLookupBlocking = false;
+            if (applyCachedUsername()) {
+                // Fresh entries need no request, stale ones are confirmed in the background
+            } else if (uplinkConnected() && !apiKeyErrorActive) {
+                // Lookup runs in the network worker; the result is applied in processNetResults()
+                userIdLookupBlocking = requestUserIdLookup(true);
             } else {
                 // WLAN not connected or API key error is active - don't query username
                 if (debugEnabled) {
-                    if (WiFi.status() != WL_CONNECTED) {
-                        Serial.println("DEBUG: WLAN not connected, skipping username query.");
+                    if (!uplinkConnected()) {
+                        logSerial.println("DEBUG: WLAN not connected, skipping username query.");
                     } else {
-                        Serial.println("DEBUG: API key error active, skipping username query.");
+                        logSerial.println("DEBUG: API key error active, skipping username query.");
                     }
                 }
             }
@@ -1056,42 +1450,54 @@ void loop() {
         
         // Check if username is valid - if not, don't send data to server
         // Also don't send if API key error is active
-        bool hasValidUsername = (!apiKeyErrorActive && username.length() > 0 && username != "NULL");  
-
-        if (WiFi.status() != WL_CONNECTED) {
-            // Only try to reconnect if we haven't exceeded 3 attempts
-            if (wifiConnectAttempts < 3) {
-            // Connection is disconnected: TRY TO RESTORE CONNECTION
-            connectToWiFi(); 
-            } else {
-                // Already tried 3 times, don't retry (error message already shown)
-                if (debugEnabled && (millis() % 60000 < 100)) { // Log every ~60 seconds
-                    Serial.println("DEBUG: WiFi connection failed after 3 attempts. Not retrying.");
-                }
-            }
-        } else {
-            // WiFi is connected - reset attempt counter and update display if error was shown
-            bool hadWifiError = (wifiConnectAttempts >= 3);
-            if (wifiConnectAttempts > 0) {
-                wifiConnectAttempts = 0;
-              if (debugEnabled) {
-                    Serial.println("DEBUG: WiFi connection restored. Resetting attempt counter.");
-              }
-                
-                // Update display if WiFi error was just resolved
-                if (hadWifiError) {
-                    #ifdef ENABLE_OLED
-                    // Show normal display (username or default message) - WiFi error is resolved
-                    // queryWasSuccessful = false because we're just showing the current username, no new query was made
-                    if (username.length() > 0 && username != "NULL") {
-                        display_IdTag_Name(username.c_str(), idTagFromRFID, false);
-                    } else {
-                        display_IdTag_Name("NULL", idTagFromRFID, false);
-                    }
-                    #endif
+        // While a lookup for an uncached ID tag is running, the previous username is not valid anymore
+        bool hasValidUsername = (!apiKeyErrorActive && username.length() > 0 && username != "NULL" &&
+                                 !userIdLookupBlocking);
+
+        // Reconnects with backoff run in the WiFi manager; loop() only reacts to its transitions
+        switch (wifiManagerLoop()) {
+            case WIFI_MGR_EVENT_CONNECTED:
+                if (backgroundConnectPending) {
+                    // First connect of a fast boot: as in connectToWiFi(), deferred calls after a fast resume
+                    backgroundConnectPending = false;
+                    onWiFiConnected(wifiManagerFastResumed());
+                    break;
                 }
+                MCC_LOGD("WiFi connection restored.");
+                // Full server sync; also replaces the WiFi error screen
+                onWiFiConnected(false);
+                break;
+            case WIFI_MGR_EVENT_FAILED:
+                backgroundConnectPending = false;
+                onWiFiConnectFailed();
+                break;
+            case WIFI_MGR_EVENT_LOST:
+                MCC_LOGD("WiFi connection lost, reconnecting in background.");
+                break;
+            case WIFI_MGR_EVENT_NONE:
+                break;
+        }
+        
+        // Server calls skipped by the fast wakeup path; the firmware check runs before the next deep sleep
+        if (deferredServerCallsStart != 0 && WiFi.status() == WL_CONNECTED && !apiKeyErrorActive &&
+            millis() - deferredServerCallsStart >= FAST_RESUME_DEFER_MS) {
+            deferredServerCallsStart = 0;
+            MCC_LOGD("Sending deferred heartbeat and device configuration after fast wakeup...");
+            if (syncDevice(true, nullptr) == SYNC_OK) {
+                lastConfigFetchTime = millis();
+            } else if (!deviceSyncSupported()) {
+                sendHeartbeat();
+                reportDeviceConfig();
             }
         }
+
+        // Upload pulses that were still unsent when the device went to deep sleep,
+        // then intervals that were journaled during a WiFi or server outage
+        if (!testActive && !apiKeyErrorActive && uplinkConnected()) {
+            uploadCarriedPulses();
+            replayJournal();
+        }
+        stationBikesLoop();
         
         // Note: Heartbeat is only sent:
         // 1. At first start (after WiFi connection in connectToWiFi)
@@ -1107,9 +1513,9 @@ void loop() {
         // Block pulse counting if errors are active, as it makes no sense to count pulses that cannot be sent
         if (hasValidUsername) {
         // Query counter value and output in log, but only on change
-        pcnt_get_counter_value(PCNT_UNIT, &currentPulseCount);
+        currentPulseCount = (uint32_t)pulseCounterRead();
         //if (debugEnabled) {
-        //      Serial.printf("Pulse detected! Current Pulse Count: %d\n", currentPulseCount);
+        //      logSerial.printf("Pulse detected! Current Pulse Count: %d\n", currentPulseCount);
         //}
         //delay(1);
 
@@ -1118,74 +1524,40 @@ void loop() {
             // wheel_size is in mm, so result is in mm
             totalDistance_mm = (float)currentPulseCount * wheel_size;
 
-            // Calculate current speed based on time between pulses
+            // Speed is derived from the ISR edge timestamps by the capture task
             unsigned long currentTime = millis();
-            if (previousPulseTime > 0) {
-                // Calculate time difference in milliseconds
-                unsigned long timeSinceLastPulse_ms = currentTime - previousPulseTime;
-                float newSpeed = 0.0;
-                if (timeSinceLastPulse_ms > 0 && timeSinceLastPulse_ms < SPEED_TIMEOUT_MS) {
-                    // Speed calculation: (wheel_size_mm / time_ms) * 3.6
-                    // Formula: (mm/ms) * (1000 ms/s) * (3600 s/h) / (1000000 mm/km) = (mm/ms) * 3.6
-                    newSpeed = (wheel_size / (float)timeSinceLastPulse_ms) * 3.6;
-                    if (debugEnabled) {
-                        Serial.printf("DEBUG: Speed calculated: %.1f km/h (time between pulses: %lu ms)\n", newSpeed, timeSinceLastPulse_ms);
-                    }
-                } else {
-                    // Timeout or invalid time - set speed to 0
-                    newSpeed = 0.0;
-                }
-                
-                // Add new speed value to history array (rolling average)
-                speedHistory[speedHistoryIndex] = newSpeed;
-                speedHistoryIndex = (speedHistoryIndex + 1) % SPEED_AVERAGE_COUNT; // Circular buffer
-                if (speedHistoryCount < SPEED_AVERAGE_COUNT) {
-                    speedHistoryCount++; // Increment count until we have 5 values
-                }
-                
-                // Calculate average of last 5 speed values
-                float speedSum = 0.0;
-                for (int i = 0; i < speedHistoryCount; i++) {
-                    speedSum += speedHistory[i];
-                }
-                currentSpeed_kmh = speedSum / (float)speedHistoryCount;
-                
-                if (debugEnabled) {
-                    Serial.printf("DEBUG: Speed average (last %d pulses): %.1f km/h\n", speedHistoryCount, currentSpeed_kmh);
-                }
+            PulseSnapshot pulseSnapshot;
+            pulseCaptureGetSnapshot(&pulseSnapshot);
+            currentSpeed_kmh = pulseSnapshot.speed_kmh;
+            MCC_LOGD("Speed average (last %u pulses): %.1f km/h\n", (unsigned)pulseSnapshot.speedSamples, currentSpeed_kmh);
+            if (pulseSnapshot.dropped > 0) {
+                MCC_LOGD("Pulse capture dropped %u timestamps (ring buffer full)\n", (unsigned)pulseSnapshot.dropped);
             }
-            previousPulseTime = currentTime; // Store current time for next pulse calculation
 
-            if (debugEnabled) {
-              Serial.printf("DEBUG: Pulse detected! currentPulseCount: %d | totalDistance_mm: %.1f mm\n", currentPulseCount, totalDistance_mm);
-            }
+            MCC_LOGD("Pulse detected! currentPulseCount: %u | totalDistance_mm: %.1f mm\n", (unsigned)currentPulseCount, totalDistance_mm);
             lastPulseCount = currentPulseCount;
             lastPulseTime = currentTime; // Update the timestamp of the last pulse for Deep Sleep
+            uploadSchedulerPulses(&uploadScheduler, (uint32_t)sendInterval_sec * 1000);
             
             #ifdef ENABLE_OLED
             display_Data();
             #endif
 
-            // Let LED briefly blink on counted pulse
+            // Let LED briefly blink on counted pulse (switched off again by updateLed() in loop())
             if (ledEnabled) {
-                //ledIsOn = true;
-                //ledOnTime = millis();
-                digitalWrite(LED_PIN, HIGH);
-                delay(50);
-                //ledIsOn = false;
-                digitalWrite(LED_PIN, LOW);
-                }
+                updateLed(true);
+            }
             }
         } else {
             // Block pulse counting when errors are active
             // Don't read counter value to prevent counting pulses that cannot be sent
             if (debugEnabled && (millis() % 10000 < 100)) { // Log every ~10 seconds
-                if (WiFi.status() != WL_CONNECTED) {
-                    Serial.println("DEBUG: Pulse counting blocked - WLAN not connected");
+                if (!uplinkConnected()) {
+                    logSerial.println("DEBUG: Pulse counting blocked - WLAN not connected");
                 } else if (apiKeyErrorActive) {
-                    Serial.println("DEBUG: Pulse counting blocked - API key error active");
+                    logSerial.println("DEBUG: Pulse counting blocked - API key error active");
                 } else {
-                    Serial.println("DEBUG: Pulse counting blocked - no valid username assigned");
+                    logSerial.println("DEBUG: Pulse counting blocked - no valid username assigned");
                 }
             }
         }
@@ -1194,189 +1566,145 @@ void loop() {
         // Also fetches on first start (lastConfigFetchTime == 0) or when interval is reached
         // Don't fetch if API key error is active (must fix API key first)
         if (configFetchInterval_sec > 0) {
-            if (WiFi.status() == WL_CONNECTED && !apiKeyErrorActive) {
+            if (uplinkConnected() && !apiKeyErrorActive) {
                 unsigned long elapsed_ms = (lastConfigFetchTime == 0) ? 0 : (millis() - lastConfigFetchTime);
                 bool shouldFetch = (lastConfigFetchTime == 0) || (elapsed_ms >= (unsigned long)configFetchInterval_sec * 1000);
                 
-                if (debugEnabled && shouldFetch) {
+                if (debugEnabled && shouldFetch && !netWorkerPending(NET_JOB_CONFIG_FETCH)) {
                     if (lastConfigFetchTime == 0) {
-                        Serial.println("DEBUG: Periodic config fetch - first fetch after startup");
+                        logSerial.println("DEBUG: Periodic config fetch - first fetch after startup");
                     } else {
-                        Serial.printf("DEBUG: Periodic config fetch triggered (interval: %u s, elapsed: %lu s)\n", 
+                        logSerial.printf("DEBUG: Periodic config fetch triggered (interval: %u s, elapsed: %lu s)\n", 
                             configFetchInterval_sec, elapsed_ms / 1000);
                     }
                 }
                 
-                if (shouldFetch) {
-                    if (fetchDeviceConfig()) {
-                        lastConfigFetchTime = millis();
-                        if (debugEnabled) {
-                            Serial.printf("DEBUG: Config fetched successfully. Next fetch in %u seconds\n", configFetchInterval_sec);
-                        }
-                    } else {
-                        if (debugEnabled) {
-                            Serial.println("DEBUG: Config fetch failed, will retry on next interval");
-                        }
-                        // Don't update lastConfigFetchTime on failure, so it retries sooner
-                    }
+                // Over MQTT the server pushes config changes, polling is not needed
+                if (shouldFetch && !netWorkerPending(NET_JOB_CONFIG_FETCH) && !mqttLinkConnected()) {
+                    // Fetch runs in the network worker; lastConfigFetchTime is updated in processNetResults()
+                    netWorkerSubmit(NET_JOB_CONFIG_FETCH, apiUrl(API_EP_CONFIG_FETCH), "", 0,
+                                    deviceConfig.serverHash, 0, nullptr);
                 }
             } else {
                 if (debugEnabled && (millis() % 60000 < 100)) { // Log every ~60 seconds
                     if (apiKeyErrorActive) {
-                        Serial.println("DEBUG: Periodic config fetch skipped - API key error active (must fix API key first)");
+                        logSerial.println("DEBUG: Periodic config fetch skipped - API key error active (must fix API key first)");
                     } else {
-                Serial.printf("DEBUG: Periodic config fetch skipped - WiFi not connected (interval: %u s)\n", configFetchInterval_sec);
+                logSerial.printf("DEBUG: Periodic config fetch skipped - WiFi not connected (interval: %u s)\n", configFetchInterval_sec);
                     }
                 }
             }
         }
         
+        // Rider stopped: the rest of the ride is uploaded now instead of at the end of the interval
+        if (!testActive && hasValidUsername && currentPulseCount != pulsesAtLastSend &&
+            uploadSchedulerSessionEnd(&uploadScheduler, millis() - lastPulseTime)) {
+            MCC_LOGD("No pulses for %u s, uploading early.\n", (unsigned)(UPLOAD_SESSION_END_MS / 1000));
+        }
+
         // Logic for normal send mode
-        // Only send data if username is valid (assigned on server)
-        if (!testActive && hasValidUsername && (millis() - lastDataSendTime >= (unsigned long)sendInterval_sec * 1000)) {
+        // Only send data if username is valid (assigned on server); the scheduler adds
+        // per-device jitter, stretches idle intervals and pauses during a server backoff
+        const bool uploadDue = uploadSchedulerDue(&uploadScheduler, millis());
+        if (!testActive && hasValidUsername && uploadDue) {
+          if (netWorkerPending(NET_JOB_UPDATE_DATA)) {
+            // Previous upload is still in flight (slow server). Its pulses are not
+            // confirmed yet and are included in the next interval instead.
+            MCC_LOGD("Previous upload still running, skipping this interval.");
+          } else {
            if (debugEnabled) {
-              Serial.println("DEBUG: Sending data");
+              logSerial.println("DEBUG: Sending data");
             }
             // Calculate distance traveled and speed in last interval
-            //pcnt_get_counter_value(PCNT_UNIT, &currentPulseCount);
-            int16_t pulsesInInterval = currentPulseCount - pulsesAtLastSend;
+            uint32_t pulsesInInterval = currentPulseCount - pulsesAtLastSend;
             // wheel_size is in mm, so result is in mm
             distanceInInterval_mm = (float)pulsesInInterval * wheel_size;
-            if (debugEnabled) {
-              Serial.printf("DEBUG: pulsesInInterval: %d | distanceInInterval_mm: %.1f mm\n", pulsesInInterval, distanceInInterval_mm);
-            }
+            MCC_LOGD("pulsesInInterval: %u | distanceInInterval_mm: %.1f mm\n", (unsigned)pulsesInInterval, distanceInInterval_mm);
             // Convert speed from mm/s to km/h: (mm/s) * (3600 s/h) / (1000000 mm/km) = (mm/s) * 0.0036
-            speed_kmh = (distanceInInterval_mm / (float)sendInterval_sec) * 0.0036;
+            // Intervals vary with jitter and early uploads, so the elapsed time is used
+            const float intervalSec = (millis() - lastDataSendTime) / 1000.0f;
+            speed_kmh = intervalSec > 0.0f ? (distanceInInterval_mm / intervalSec) * 0.0036 : 0.0;
             
+            // Statistics of the pulse intervals since the last upload (not part of batch uploads)
+            RideStats intervalStats;
+            pulseCaptureTakeStats(&intervalStats);
+            // Ride trace of the interval: at most every traceInterval_sec, not over the ESP-NOW gateway link
+            const RideTrace* intervalTrace = pulseCaptureTakeTrace(traceMaxBytes);
+            const bool traceDue = intervalTrace->count > 0 && gatewayRole != GATEWAY_ROLE_NODE &&
+                                  (lastTraceUploadTime == 0 ||
+                                   millis() - lastTraceUploadTime >= (unsigned long)traceInterval_sec * 1000);
+
             // Send data only if distance has changed
             if (distanceInInterval_mm > 0) {
-              if (debugEnabled) {
-                Serial.println("DEBUG: Sending real data after interval elapsed.");
-              }             
+              MCC_LOGD("Sending real data after interval elapsed.");
 
-              int responseCode =  sendDataToServer(speed_kmh, distanceInInterval_mm, pulsesInInterval, false);
-              
-              if (responseCode > 0 && responseCode < 300) { // HTTP status codes 2xx are usually successful
-                    lastDataSendTime = millis();
-                    pulsesAtLastSend = currentPulseCount;
-                    // Update lastSentIdTag here since data was sent successfully
-                    lastSentIdTag = idTag;
-                    // Clear server error backoff on success
-                    bool hadServerError = (lastServerErrorTime > 0);
-                    lastServerErrorTime = 0;
-                    // Clear API key error flag on successful communication
-                    bool wasApiKeyError = apiKeyErrorActive;
-                    apiKeyErrorActive = false;
-                    
-                    // Update display if any error was just resolved (API key, WLAN, Wartung, Server)
-                    if (wasApiKeyError || hadServerError) {
-                        #ifdef ENABLE_OLED
-                        // Show normal display (username or default message) - error is resolved
-                        // queryWasSuccessful = false because we're just showing the current username, no new query was made
-                        if (username.length() > 0 && username != "NULL") {
-                            display_IdTag_Name(username.c_str(), idTagFromRFID, false);
-                        } else {
-                            display_IdTag_Name("NULL", idTagFromRFID, false);
-                        }
-                        #endif
-                    }
-
-                    if (debugEnabled) {
-                        Serial.printf("DEBUG: Data sent successfully! Status: %d\n", responseCode);
-                    }
-                } else if (responseCode == -1) {
-                    // WiFi error: No update of send time so it tries faster next time.
-                    digitalWrite(LED_PIN, LOW);
-                    if (debugEnabled) {
-                        Serial.println("DEBUG: Send failed: No WiFi.");
-                    }
+              if (uploadBatchSize > 1 && !batchUploadUnsupported &&
+                  rideJournalAppend(idTag.c_str(), pulsesInInterval, distanceInInterval_mm)) {
+                // Batch mode: the interval is uploaded together with the next ones by replayJournalBatch()
+                pulsesAtLastSend = currentPulseCount;
+                if (debugEnabled) {
+                  logSerial.printf("DEBUG: Interval queued for batch upload (%u of %u).\n",
+                                (unsigned)rideJournalPendingCount(), uploadBatchSize);
+                }
+              } else {
+                // Upload runs in the network worker; the result is handled in processNetResults()
+                char jsonPayload[UPDATE_DATA_PAYLOAD_LEN];
+                // With a trace the body is larger than a queue item and goes through a static buffer
+                static char tracePayload[UPDATE_DATA_TRACE_PAYLOAD_LEN];
+                char* body = traceDue ? tracePayload : jsonPayload;
+                const size_t bodySize = traceDue ? sizeof(tracePayload) : sizeof(jsonPayload);
+                size_t payloadLen = buildUpdateDataPayload(body, bodySize, speed_kmh,
+                                                           distanceInInterval_mm, (int)pulsesInInterval, false, nullptr,
+                                                           &intervalStats, traceDue ? intervalTrace : nullptr);
+                if (payloadLen == 0 ||
+                    !netWorkerSubmit(NET_JOB_UPDATE_DATA, apiUrl(API_EP_UPDATE_DATA), body, payloadLen,
+                                     currentPulseCount, distanceSession, idTag.c_str())) {
+                  MCC_LOGD("Upload could not be queued, retrying next interval.");
                 } else {
-                    // Other error (e.g. HTTP 4xx/5xx, internal error)
-                    // Update backoff timer
-                    lastServerErrorTime = millis();
-                    digitalWrite(LED_PIN, LOW);
-                    
-                    // Show error on display
-                    String errorType = "Server";
-                    bool isApiKeyError = false;
-                    if (responseCode == 401 || responseCode == 403) {
-                        errorType = "API Key";
-                        isApiKeyError = true;
-                    } else if (responseCode == 503) {
-                        errorType = "Wartung";
-                    }
-                    
-                    // Set API key error flag if API key error detected
-                    if (isApiKeyError) {
-                        apiKeyErrorActive = true;
-                    }
-                    
-                    #ifdef ENABLE_OLED
-                    display_ServerError(errorType.c_str(), responseCode);
-                    delay(2000);
-                    // Ensure LED stays off after error display
-                    digitalWrite(LED_PIN, LOW);
-                    #endif
-                    
-                    if (debugEnabled) {
-                        Serial.printf("DEBUG: Send failed: Code %d. Waiting for next attempt.\n", responseCode);
-                    }
+                  pulsesSubmitted = currentPulseCount;
+                  if (traceDue) {
+                    lastTraceUploadTime = millis();
+                    MCC_LOGD("Ride trace attached: %u intervals in %u bytes (%u dropped).\n",
+                             (unsigned)intervalTrace->count, (unsigned)intervalTrace->len, (unsigned)intervalTrace->dropped);
+                  }
+                }
+                if (debugEnabled) {
+                  // Minimum and largest block stay constant once the upload cycle runs without allocations
+                  logSerial.printf("DEBUG: Heap free: %u, min free: %u, largest block: %u\n",
+                                (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(),
+                                (unsigned)ESP.getMaxAllocHeap());
+                }
               }
-                
             }
+          }
             lastDataSendTime = millis();
-        } else if (!testActive && !hasValidUsername && (millis() - lastDataSendTime >= (unsigned long)sendInterval_sec * 1000)) {
+            uploadSchedulerStart(&uploadScheduler, lastDataSendTime, (uint32_t)sendInterval_sec * 1000);
+        } else if (!testActive && !hasValidUsername && uploadDue) {
             // No valid username - skip sending but update timer to avoid spamming
             // Retry after backoff period, even if API key error is active (to check if API key was fixed)
-            if (lastServerErrorTime == 0 || (millis() - lastServerErrorTime) >= serverErrorBackoffInterval) {
+            if (!serverBackoffActive()) {
                 // Only query if WLAN is connected
-                if (WiFi.status() == WL_CONNECTED) {
+                if (uplinkConnected()) {
                     if (debugEnabled) {
                         if (apiKeyErrorActive) {
-                            Serial.println("DEBUG: Retrying connection after backoff period to check if API key error is resolved.");
+                            logSerial.println("DEBUG: Retrying connection after backoff period to check if API key error is resolved.");
                         } else {
-                            Serial.println("DEBUG: Retrying username query after backoff period.");
+                            logSerial.println("DEBUG: Retrying username query after backoff period.");
                         }
                     }
-                    String newUsername = getUserIdFromTag(idTag);
-                    // getUserIdFromTag() returns:
-                    // - Valid username string if found
-                    // - "NULL" if user not found (HTTP 404 or server returned "NULL")
-                    // - "" (empty) if query failed (backoff period, connection error, etc.)
-                    if (newUsername.length() > 0) {
-                        // Query was successful - update username (could be valid name or "NULL")
-                        bool wasUsernameNull = (username.length() == 0 || username == "NULL");
-                        bool isUsernameNull = (newUsername == "NULL");
-                        bool usernameChanged = (wasUsernameNull != isUsernameNull) || (username != newUsername);
-                        
-                        if (usernameChanged) {
-                            username = newUsername;
-                            
-                            #ifdef ENABLE_OLED
-                            // Show updated display (username or default message)
-                            // queryWasSuccessful = true because newUsername.length() > 0 means query was successful
-                            // Note: If HTTP 404, username was already set to "NULL" in getUserIdFromTag() and error was already shown
-                            if (username.length() > 0 && username != "NULL") {
-                                display_IdTag_Name(username.c_str(), idTagFromRFID, true);
-                            } else {
-                                // HTTP 404 - error message was already shown in getUserIdFromTag(), don't overwrite it
-                                // Just keep the "Radler nicht gefunden" message that was already displayed
-                            }
-                            #endif
-                        }
-                    }
-                    // If newUsername is empty, query failed - don't update username, keep previous value
+                    requestUserIdLookup(false);
                 }
             } else {
                 if (debugEnabled) {
                     if (apiKeyErrorActive) {
-                        Serial.println("DEBUG: Skipping connection retry - still in backoff period (API key error active).");
+                        logSerial.println("DEBUG: Skipping connection retry - still in backoff period (API key error active).");
                     } else {
-                        Serial.println("DEBUG: Skipping data send - no valid username assigned on server (in backoff period).");
+                        logSerial.println("DEBUG: Skipping data send - no valid username assigned on server (in backoff period).");
                     }
                 }
             }
             lastDataSendTime = millis();
+            uploadSchedulerStart(&uploadScheduler, lastDataSendTime, (uint32_t)sendInterval_sec * 1000);
         }
 
         // Refresh the OLED when the server changed the displayed Velos, even
@@ -1389,25 +1717,46 @@ void loop() {
             }
         }
         #endif
+        publishRideState();
 
         // Deep Sleep Check - only if deepSleepTimeout_sec > 0 (0 = disabled)
-        if ( deepSleepTimeout_sec > 0 && (millis() - lastPulseTime >= (unsigned long)deepSleepTimeout_sec * 1000) && DeepSleep ) {
+        // Sleep only when no upload is in flight, otherwise its pulses would be lost
+        bool sleepDue = deepSleepTimeout_sec > 0 && (millis() - lastPulseTime >= (unsigned long)deepSleepTimeout_sec * 1000) && DeepSleep && netWorkerIdle();
+        #ifdef ENABLE_PULSE_REPLAY
+        // Standstill steps of a replay must not end the load test
+        sleepDue = sleepDue && !pulseReplayActive();
+        #endif
+        // A gateway stays awake for its nodes
+        sleepDue = sleepDue && gatewayRole != GATEWAY_ROLE_GATEWAY;
+        if (!sleepDue && sleepNoticeStart != 0) {
+            // Pedaling resumed (or an upload was queued) while the goodbye screen was shown: stay awake
+            sleepNoticeStart = 0;
+            #ifdef ENABLE_OLED
+            uiClearScreens();
+            oledVelosNeedsRefresh = true;
+            #endif
+            MCC_LOGD("Deep sleep cancelled.");
+        } else if (sleepDue && sleepNoticeStart != 0) {
+            if (millis() - sleepNoticeStart >= SLEEP_NOTICE_MS) {
+                enterDeepSleep(hasValidUsername);
+            }
+        } else if (sleepDue) {
           if (debugEnabled) {
-              Serial.println("DEBUG: Deep Sleep check ...");
-              Serial.printf("DEBUG: deepSleepTimeout_sec= %d.\n", deepSleepTimeout_sec);
+              logSerial.println("DEBUG: Deep Sleep check ...");
+              logSerial.printf("DEBUG: deepSleepTimeout_sec= %d.\n", deepSleepTimeout_sec);
           }
           
           // Check for firmware update before going to sleep
           // This ensures we don't miss updates when device is inactive
           if (WiFi.status() == WL_CONNECTED) {
-              if (debugEnabled) {
-                  Serial.println("DEBUG: Checking for firmware update before deep sleep...");
+              MCC_LOGD("Checking for firmware update before deep sleep...");
+              bool updateAvailable = false;
+              if (syncDevice(false, &updateAvailable) == SYNC_UNSUPPORTED) {
+                  updateAvailable = checkFirmwareUpdate();
               }
-              if (checkFirmwareUpdate()) {
+              if (updateAvailable) {
                   // Update is available, download and install
-                  if (debugEnabled) {
-                      Serial.println("DEBUG: Firmware update available. Starting download before sleep...");
-                  }
+                  MCC_LOGD("Firmware update available. Starting download before sleep...");
                   downloadFirmware();
                   // Note: downloadFirmware() will restart the device on success
                   return; // Exit loop if update is being installed
@@ -1415,50 +1764,49 @@ void loop() {
           }
           
           if (digitalRead(SENSOR_PIN) == HIGH) {
-            if (debugEnabled) {
-              Serial.println("DEBUG: Pin is HIGH. Switching to deep sleep mode.");
-            }
+            MCC_LOGD("Pin is HIGH. Showing goodbye screen before deep sleep.");
 
-            // --- OLED control: Turn off display ---
             #ifdef ENABLE_OLED
-            if (debugEnabled) {
-                Serial.println("DEBUG: Turning off OLED display.");
-            }
-
-            display.clearBuffer();
-            display.setFont(u8g2_font_7x14_tf);
-            display.drawStr(0, 12, "Keine Impulse mehr!");
-            display.drawStr(5, 28, "Ich geh schlafen!");
-            display.drawStr(30, 44, "Strampeln");  // 
-            display.drawStr(10, 60, "weckt mich auf" );  // 
-            display.sendBuffer();
-            delay(10000);
-
-            // 1. Put U8g2 display controller into sleep mode
-            display.clearDisplay();
-            display.sendBuffer(); 
-            display.sleepOn();     // SSD1306 into sleep mode (Display Off)
+            UiScreen screen;
+            uiScreenInit(&screen, SLEEP_NOTICE_MS);
+            uiScreenAddLine(&screen, 12, "Keine Impulse mehr!", 0);
+            uiScreenAddLine(&screen, 28, "Ich geh schlafen!", 5);
+            uiScreenAddLine(&screen, 44, "Strampeln", 30);
+            uiScreenAddLine(&screen, 60, "weckt mich auf", 10);
+            uiClearScreens();
+            uiShowScreen(screen);
             #endif
-
-            // --- Heltec VEXT control: Turn off power supply (if defined) ---
-            #ifdef BOARD_HELTEC
-            if (debugEnabled) {
-                Serial.println("DEBUG: Turning off VEXT (OLED power).");
-            }
-            // Set VEXT_PIN to HIGH to completely turn off display (HIGH = OFF)
-            digitalWrite(VEXT_PIN, HIGH);
-            #endif
-
-            esp_sleep_enable_ext0_wakeup((gpio_num_t)SENSOR_PIN, LOW);
-            esp_deep_sleep_start();
+            sleepNoticeStart = millis() | 1;  // Never 0
           } else {
-             if (debugEnabled) {
-                Serial.println("DEBUG: Pin is already LOW. Deep sleep will be delayed until pin goes HIGH.");
-             }
+             MCC_LOGD("Pin is already LOW. Deep sleep will be delayed until pin goes HIGH.");
             // Stay in loop and wait until pin goes HIGH again.
             lastPulseTime = millis();
           }  
         }
+
+        // Low-power riding: sleep between uploads, the ULP keeps counting
+        bool lowPowerAllowed = lowPowerRide && !lowPowerRideUnsupported;
+        #ifdef ENABLE_PULSE_REPLAY
+        // The generator runs from esp_timer, which light sleep would stall
+        lowPowerAllowed = lowPowerAllowed && !pulseReplayActive();
+        #endif
+        // ESP-NOW is not received while the radio is off between uploads
+        lowPowerAllowed = lowPowerAllowed && gatewayRole == GATEWAY_ROLE_STANDALONE;
+        // The ULP only counts SENSOR_PIN, the PCNT units of further bikes stop in light sleep
+        lowPowerAllowed = lowPowerAllowed && stationBikeCount == 0;
+        if (lowPowerAllowed && !sleepDue && sleepNoticeStart == 0 && !testActive &&
+            hasValidUsername && netWorkerIdle() && deferredServerCallsStart == 0) {
+            const unsigned long untilUploadMs = uploadSchedulerRemainingMs(&uploadScheduler, millis());
+            #ifdef ENABLE_OLED
+            const bool screenBusy = uiScreenBusy();
+            #else
+            const bool screenBusy = false;
+            #endif
+            if (!screenBusy && untilUploadMs >= LOW_POWER_WAKE_AHEAD_MS + LOW_POWER_MIN_SLEEP_MS) {
+                lowPowerRideSleep(untilUploadMs - LOW_POWER_WAKE_AHEAD_MS);
+                loopStartUs = 0;  // The sleep is not loop time
+            }
+        }
     }
 }
 
@@ -1473,64 +1821,102 @@ void loop() {
  * @note Hardware interaction: OLED display (if ENABLE_OLED is defined)
  * @note Side effects: Modifies WiFi state, updates OLED display, writes to Serial
  */
-void connectToWiFi() {
+void connectToWiFi(bool wait) {
+    if (gatewayRole == GATEWAY_ROLE_NODE) {
+        // No association: the network worker sends every request to the gateway over ESP-NOW
+        gatewayLinkBegin(GATEWAY_ROLE_NODE, gatewaySecret);
+        #ifdef ENABLE_OLED
+        if (!fastWake) {
+            display_WifiStatus("Sendet über Gateway", 2000);
+        }
+        #endif
+        fastWake = false;
+        return;
+    }
+
     if (debugEnabled) {
-      Serial.print("DEBUG: Connecting to WiFi ");
-      Serial.println(wifi_ssid);
+      logSerial.print("DEBUG: Connecting to WiFi ");
+      logSerial.println(wifi_ssid);
 
     }
 
-    #ifdef ENABLE_OLED
-    display.clearBuffer();
-    display.setFont(u8g2_font_7x14_tf);
+    // Turn on LED to indicate WiFi connection activity
+    digitalWrite(LED_PIN, HIGH);
 
-    textline = "MyCyclingCity";
-    textWidth = display.getStrWidth(textline);
-    display.setCursor((128 - textWidth) / 2, 12); 
-    display.print(textline);
+    wifiManagerSetNetwork(0, wifi_ssid, wifi_password);
+    wifiManagerSetNetwork(1, wifi_ssid2, wifi_password2);
+    const bool fast = fastWake;
+    wifiManagerConnect(fast, staticIp);
+    // Later reconnects in this wake cycle use the normal path
+    fastWake = false;
+    // ESP-NOW follows the channel of the access point
+    gatewayLinkBegin(gatewayRole, gatewaySecret);
 
-    textline = deviceName.c_str();
-    textWidth = display.getStrWidth(textline);
-    display.setCursor((128 - textWidth) / 2, 28); 
-    display.print(textline);
+    #ifdef ENABLE_OLED
+    if (!fast) {
+        display_WifiStatus("Verbinde mit WLAN:", 2000);
+    }
+    #endif
 
- 
-    textline = "Verbinde mit WLAN:";
-    textWidth = display.getStrWidth(textline);
-    display.setCursor((128 - textWidth) / 2, 44); 
-    display.print(textline);
+    if (!wait) {
+        backgroundConnectPending = true;
+        MCC_LOGD("WiFi connecting in background (fast boot).");
+        digitalWrite(LED_PIN, LOW);
+        return;
+    }
 
-    textline = wifi_ssid.c_str();
-    textWidth = display.getStrWidth(textline);
-    display.setCursor((128 - textWidth) / 2, 60); 
-    display.print(textline);
- 
-    display.sendBuffer();
-    delay(2000);
-    #endif
+    // Bounded wait for setup() and mode changes; after that the manager keeps trying from loop()
+    const unsigned long waitStart = millis();
+    WifiManagerEvent event = WIFI_MGR_EVENT_NONE;
+    while (event != WIFI_MGR_EVENT_CONNECTED && event != WIFI_MGR_EVENT_FAILED &&
+           wifiManagerState() != WIFI_MGR_IDLE && millis() - waitStart < WIFI_CONNECT_WAIT_MS) {
+        delay(50);
+        #ifdef ENABLE_OLED
+        uiSchedulerLoop();  // Advance queued screens while waiting
+        #endif
+        event = wifiManagerLoop();
+    }
 
-    // Turn on LED to indicate WiFi connection activity
-    digitalWrite(LED_PIN, HIGH);
-    
-    WiFi.begin(wifi_ssid.c_str(), wifi_password.c_str());
-    int attempts = 0;
-    const int MAX_ATTEMPTS = 20;  // Maximum 20 connection attempts (20 * 500ms = 10 seconds timeout)
-    while (WiFi.status() != WL_CONNECTED && attempts < MAX_ATTEMPTS) {
-        delay(500);
-        if (debugEnabled) {
-          Serial.print(".");
-        }
-        attempts++;
+    if (event == WIFI_MGR_EVENT_CONNECTED) {
+        onWiFiConnected(wifiManagerFastResumed());
+    } else if (event == WIFI_MGR_EVENT_FAILED) {
+        onWiFiConnectFailed();
+    } else {
+        // Still scanning or connecting: loop() gets the result from wifiManagerLoop()
+        MCC_LOGD("WiFi not connected yet, continuing in background.");
+        digitalWrite(LED_PIN, LOW);
     }
-    
-    if (WiFi.status() == WL_CONNECTED) {
+}
+
+bool uplinkConnected() {
+    if (gatewayRole == GATEWAY_ROLE_NODE) {
+        return gatewayNodeReachable();
+    }
+    return WiFi.status() == WL_CONNECTED;
+}
+
+void onWiFiConnected(bool fastConnect) {
+    bootMark("wifi_up");  // First connect only: later ones come after the timeline was sent
+    {
         // Reset connection attempt counter on successful connection
         bool hadWifiError = (wifiConnectAttempts >= 3);
         wifiConnectAttempts = 0;
         if (debugEnabled) {
-          Serial.println("\nDEBUG: Connected!");
-          Serial.print("DEBUG: IP address: ");
-          Serial.println(WiFi.localIP());
+          logSerial.println("\nDEBUG: Connected!");
+          logSerial.print("DEBUG: IP address: ");
+          logSerial.println(WiFi.localIP());
+        }
+
+        // Reconnects on its own after later WiFi drops
+        mqttLinkBegin(mqttUrl, deviceIdFull(), apiKey);
+
+        if (fastConnect) {
+            // Heartbeat and config report follow from loop(); the config fetch is the
+            // first periodic fetch and the username comes from the restored session or
+            // the ID tag check in loop()
+            deferredServerCallsStart = millis() | 1;  // Never 0
+            digitalWrite(LED_PIN, LOW);
+            return;
         }
         
         // Update display if WiFi error was just resolved
@@ -1540,119 +1926,77 @@ void connectToWiFi() {
             #ifdef ENABLE_OLED
             // Show normal display (username or default message) - WiFi error is resolved
             // Note: username will be queried after WiFi connection, so we show a temporary message first
-            display.clearBuffer();
-            display.setFont(u8g2_font_7x14_tf);
-            
-            textline = "WLAN verbunden";
-            textWidth = display.getStrWidth(textline);
-            display.setCursor((128 - textWidth) / 2, 28);
-            display.print(textline);
-            
-            display.sendBuffer();
-            delay(1000);  // Brief display of connection message
+            UiScreen screen;
+            uiScreenInit(&screen, 1000);  // Brief display of connection message
+            uiScreenAddLine(&screen, 28, "WLAN verbunden");
+            uiShowScreen(screen);
             #endif
         }
         
-        // Report device configuration to server after successful WiFi connection
-        // This allows the server to detect configuration differences
-        if (debugEnabled) {
-          Serial.println("DEBUG: Reporting device configuration to server...");
-        }
-        bool configReported = reportDeviceConfig();
-        if (debugEnabled) {
-            Serial.printf("DEBUG: reportDeviceConfig() returned: %s\n", configReported ? "true" : "false");
-        }
-        
-        // Fetch server-side configuration if available
-        // Only fetch if config was successfully reported (server is reachable)
-        if (configReported) {
-            if (debugEnabled) {
-                Serial.println("DEBUG: Fetching server-side configuration after WiFi connection...");
-            }
-            bool fetchSuccess = fetchDeviceConfig();
-            if (fetchSuccess) {
-                lastConfigFetchTime = millis();
-                if (debugEnabled) {
-                    Serial.println("DEBUG: Config fetched successfully after WiFi connection");
+        // One round trip after connecting: heartbeat, config report, config delta and
+        // firmware availability. Servers without /api/device/sync get the separate calls.
+        MCC_LOGD("Syncing device with server after WiFi connection...");
+        bool updateAvailable = false;
+        connectSyncResult = syncDevice(true, &updateAvailable);
+        if (connectSyncResult == SYNC_OK) {
+            lastConfigFetchTime = millis();
+        } else if (connectSyncResult == SYNC_UNSUPPORTED) {
+            // Report device configuration to server after successful WiFi connection
+            // This allows the server to detect configuration differences
+            MCC_LOGD("Reporting device configuration to server...");
+            bool configReported = reportDeviceConfig();
+            MCC_LOGD("reportDeviceConfig() returned: %s\n", configReported ? "true" : "false");
+            
+            // Fetch server-side configuration if available
+            // Only fetch if config was successfully reported (server is reachable)
+            if (configReported) {
+                MCC_LOGD("Fetching server-side configuration after WiFi connection...");
+                bool fetchSuccess = fetchDeviceConfig();
+                if (fetchSuccess) {
+                    lastConfigFetchTime = millis();
+                    MCC_LOGD("Config fetched successfully after WiFi connection");
+                } else {
+                    MCC_LOGD("Config fetch failed after WiFi connection, will retry later");
                 }
             } else {
-                if (debugEnabled) {
-                    Serial.println("DEBUG: Config fetch failed after WiFi connection, will retry later");
-                }
-            }
-        } else {
-            if (debugEnabled) {
-                Serial.println("DEBUG: Skipping fetchDeviceConfig() because reportDeviceConfig() returned false");
+                MCC_LOGD("Skipping fetchDeviceConfig() because reportDeviceConfig() returned false");
             }
+            
+            // Check for firmware update immediately after WiFi connection
+            // This ensures firmware check happens even if device goes to sleep soon
+            MCC_LOGD("Checking for firmware update after WiFi connection...");
+            updateAvailable = checkFirmwareUpdate();
+            MCC_LOGD("checkFirmwareUpdate() returned: %s\n", updateAvailable ? "true" : "false");
         }
         
-        // Check for firmware update immediately after WiFi connection
-        // This ensures firmware check happens even if device goes to sleep soon
-        if (debugEnabled) {
-            Serial.println("DEBUG: Checking for firmware update after WiFi connection...");
-        }
-        bool updateAvailable = checkFirmwareUpdate();
-        if (debugEnabled) {
-            Serial.printf("DEBUG: checkFirmwareUpdate() returned: %s\n", updateAvailable ? "true" : "false");
-        }
         if (updateAvailable) {
             // Update is available, download and install
-            if (debugEnabled) {
-                Serial.println("DEBUG: Firmware update available. Starting download...");
-            }
+            MCC_LOGD("Firmware update available. Starting download...");
             bool downloadSuccess = downloadFirmware();
-            if (debugEnabled) {
-                Serial.printf("DEBUG: downloadFirmware() returned: %s\n", downloadSuccess ? "true" : "false");
-            }
+            MCC_LOGD("downloadFirmware() returned: %s\n", downloadSuccess ? "true" : "false");
             // Note: downloadFirmware() will restart the device on success
         } else {
-            if (debugEnabled) {
-                Serial.println("DEBUG: No firmware update available or check failed.");
-            }
+            MCC_LOGD("No firmware update available or check failed.");
         }
         
-        // Send heartbeat at first start (only if not woken from deep sleep)
-        // Note: wakeup_reason is checked here because connectToWiFi() is called from both
-        // first start and wakeup scenarios, but we only want heartbeat at first start here
-        esp_sleep_wakeup_cause_t wakeup_reason_check = esp_sleep_get_wakeup_cause();
-        if (wakeup_reason_check != ESP_SLEEP_WAKEUP_EXT0) {
-            // This is first start, not wakeup from deep sleep
-            if (debugEnabled) {
-                Serial.println("DEBUG: Sending heartbeat at first start...");
+        if (connectSyncResult == SYNC_UNSUPPORTED) {
+            // Send heartbeat at first start (only if not woken from deep sleep)
+            // Note: wakeup_reason is checked here because connectToWiFi() is called from both
+            // first start and wakeup scenarios, but we only want heartbeat at first start here
+            esp_sleep_wakeup_cause_t wakeup_reason_check = esp_sleep_get_wakeup_cause();
+            if (wakeup_reason_check != ESP_SLEEP_WAKEUP_EXT0) {
+                // This is first start, not wakeup from deep sleep
+                MCC_LOGD("Sending heartbeat at first start...");
+                sendHeartbeat();  // LED is controlled inside sendHeartbeat()
             }
-            sendHeartbeat();  // LED is controlled inside sendHeartbeat()
+            // Note: If wakeup from deep sleep, heartbeat is sent in setup() after connectToWiFi()
         }
-        // Note: If wakeup from deep sleep, heartbeat is sent in setup() after connectToWiFi()
 
         // Turn off LED after all WiFi activities are complete
         digitalWrite(LED_PIN, LOW);
 
         #ifdef ENABLE_OLED
-        display.clearBuffer();
-        display.setFont(u8g2_font_7x14_tf);
-
-        textline = "MyCyclingCity";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 12);
-        display.print(textline);
-
-        textline = deviceName.c_str();
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 28);
-        display.print(textline);
-
-        textline = "Verbunden mit:";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 44);
-        display.print(textline);
-
-        textline = wifi_ssid.c_str();
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 60);
-        display.print(textline);
-
-        display.sendBuffer();
-        delay(2000);
+        display_WifiStatus("Verbunden mit:", 2000);
         #endif
 
         // Query username from server after successful WiFi connection
@@ -1687,229 +2031,237 @@ void connectToWiFi() {
             if (debugEnabled) {
                 if (newUsername.length() > 0) {
                     if (username.length() > 0 && username != "NULL") {
-                        Serial.printf("DEBUG: Username queried on WiFi connect: %s\n", username.c_str());
+                        logSerial.printf("DEBUG: Username queried on WiFi connect: %s\n", username.c_str());
                     } else {
-                        Serial.println("DEBUG: No username assigned on server for this tag.");
+                        logSerial.println("DEBUG: No username assigned on server for this tag.");
                     }
                 } else {
-                    Serial.println("DEBUG: Username query failed (backoff or connection error).");
+                    logSerial.println("DEBUG: Username query failed (backoff or connection error).");
                 }
             }
         }
+    }
+}
 
-    } else {
+void onWiFiConnectFailed() {
+    {
         // Increment connection attempt counter
         wifiConnectAttempts++;
         
         if (debugEnabled) {
-          Serial.println("\nDEBUG: Connection failed.");
-          Serial.printf("DEBUG: WiFi connection attempt %d of 3\n", wifiConnectAttempts);
+          logSerial.println("\nDEBUG: Connection failed.");
+          logSerial.printf("DEBUG: WiFi connection attempt %d failed, next attempt in %lu ms\n",
+                        wifiConnectAttempts, (unsigned long)wifiManagerRetryInMs());
         }
         
         // Show error message after 3 failed attempts
         if (wifiConnectAttempts >= 3) {
         #ifdef ENABLE_OLED
-        display.clearBuffer();
-        display.setFont(u8g2_font_7x14_tf);
-            
-            textline = "Fehler:";
-            textWidth = display.getStrWidth(textline);
-            display.setCursor((128 - textWidth) / 2, 12);
-            display.print(textline);
-            
-            textline = "Keine";
-            textWidth = display.getStrWidth(textline);
-            display.setCursor((128 - textWidth) / 2, 28);
-            display.print(textline);
+            UiScreen screen;
+            uiScreenInit(&screen, 0);
+            uiScreenAddLine(&screen, 12, "Fehler:");
+            uiScreenAddLine(&screen, 28, "Keine");
+            uiScreenAddLine(&screen, 44, "WLAN-Verbindung");
+            uiShowScreen(screen);
+            #endif
+            digitalWrite(LED_PIN, LOW);
             
-            textline = "WLAN-Verbindung";
-            textWidth = display.getStrWidth(textline);
-            display.setCursor((128 - textWidth) / 2, 44);
-            display.print(textline);
-            
-            display.sendBuffer();
-            #endif
-            digitalWrite(LED_PIN, LOW);
-            
-            if (debugEnabled) {
-                Serial.println("DEBUG: WiFi connection failed after 3 attempts. Showing error message.");
-            }
+            MCC_LOGD("WiFi connection failed 3 times. Showing error message, retrying in background.");
         }
         
         #ifdef ENABLE_OLED
         // Only show "keine Verbindung" message if we haven't already shown the error after 3 attempts
         if (wifiConnectAttempts < 3) {
-            display.clearBuffer();
-            display.setFont(u8g2_font_7x14_tf);
-
-        textline = "MyCyclingCity";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 12);
-        display.print(textline);
-
-        textline = deviceName.c_str();
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 28);
-        display.print(textline);
-
-        textline = "keine Verbindung:";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 44); 
-        display.print(textline);
-
-        textline = wifi_ssid.c_str();
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 60);
-        display.print(textline);
-
-        display.sendBuffer();
-        delay(2000); 
+            display_WifiStatus("keine Verbindung:", 2000);
         }
         #endif
         
         // Turn off LED on connection failure
         digitalWrite(LED_PIN, LOW);
     }
-    
-    // Turn off LED after all WiFi activities are complete (if not already turned off)
-    // Note: LED is already turned off in the else block above, but we ensure it's off here too
-    digitalWrite(LED_PIN, LOW);
 }
 
 /**
- * @brief Sends tachometer data to the configured server via HTTP POST.
+ * @brief Builds the JSON body for the update-data endpoint.
  * 
- * Sends distance, speed, and pulse data as JSON to the server API endpoint.
- * Handles both test mode (simulated data) and normal mode (real measurements).
+ * Shared by the synchronous sendDataToServer() and the network worker path.
+ * Serializes into the caller's buffer, so the periodic upload does not allocate.
  * 
- * @param currentSpeed_kmh Current speed in kilometers per hour
- * @param distanceInInterval_mm Distance traveled in the interval in millimeters
- * @param pulsesInInterval Number of pulses detected in the interval
- * @param isTest If true, sends simulated test data instead of real measurements
- * @return HTTP status code on success (>0), -1 on WiFi error, -2 on configuration error
+ * @param out Receives the serialized JSON payload
+ * @param outSize Size of out in bytes (UPDATE_DATA_PAYLOAD_LEN)
+ * @param stats Ride statistics of the interval, sent as "stats" (nullptr: none)
+ * @param trace Ride trace of the interval, sent as "trace" (nullptr: none)
+ * @return Payload length, 0 if it did not fit
  * 
- * @note Hardware interaction: LED_PIN (blinks during transmission)
- * @note Side effects: Sends HTTP request, controls LED, writes to Serial
+ * @note Side effects: Consumes a pending boot_reason
  */
-int sendDataToServer(float currentSpeed_kmh, float distanceInInterval_mm, int pulsesInInterval, bool isTest) {
-  if (serverUrl.length() == 0 || wifi_ssid.length() == 0) {
-    digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-    if (debugEnabled) {
-      Serial.println("DEBUG: Error: Server URL or WiFi SSID is not configured.");
-    }
-    return -2;
-  }
-
-  if (WiFi.status() != WL_CONNECTED) {
-    digitalWrite(LED_PIN, LOW);  // Turn off LED on error
-    if (debugEnabled) {
-      Serial.println("DEBUG: sendDataToServer: ERROR: No WiFi connected.");
-    }
-    return -1;
-  }
-  
-  HTTPClient http;
-  StaticJsonDocument<256> doc;
+size_t buildUpdateDataPayload(char* out, size_t outSize, float currentSpeed_kmh, float distanceInInterval_mm, int pulsesInInterval, bool isTest, const char* idTagOverride, const RideStats* stats, const RideTrace* trace) {
+  StaticJsonDocument<640> doc;
 
   if (isTest) {
     if (debugEnabled) {
-      Serial.print("DEBUG: Sending test data. Simulated distance: ");
-      Serial.print(testDistance);
-      Serial.println(" km");
+      logSerial.print("DEBUG: Sending test data. Simulated distance: ");
+      logSerial.print(testDistance);
+      logSerial.println(" km");
     }
+    // Overwrite ID tag for test mode; stored by pointer, so the String lives until serialization
+    const String testIdTag = "MCC-Testuser" + deviceIdSuffix;
+    apiWireUpdateData(doc.to<JsonObject>(), deviceIdFull(), testIdTag.c_str(), 0.0f);
     char distanceStr[10];
     snprintf(distanceStr, sizeof(distanceStr), "%.2f", testDistance);
     doc["distance"] = distanceStr;
+    doc["id_tag"] = testIdTag;
+    MCC_LOGD("In test mode, ID tag is overwritten: %s\n", testIdTag.c_str());
   } else {
       float distanceInInterval_km = distanceInInterval_mm / 1000000.0;  // Convert mm to km
       if (debugEnabled) {
-        Serial.println("DEBUG: Sending real data.");
-        Serial.printf("DEBUG: Speed: %.2f km/h, Distance: %.6f km, Pulses: %d\n", currentSpeed_kmh, distanceInInterval_km, pulsesInInterval);
+        logSerial.println("DEBUG: Sending real data.");
+        logSerial.printf("DEBUG: Speed: %.2f km/h, Distance: %.6f km, Pulses: %d\n", currentSpeed_kmh, distanceInInterval_km, pulsesInInterval);
       }
-      doc["distance"] = distanceInInterval_km;
+      apiWireUpdateData(doc.to<JsonObject>(), deviceIdFull(),
+                        idTagOverride != nullptr ? idTagOverride : idTag.c_str(), distanceInInterval_km);
   }
-  
-  String finalDeviceId = deviceName;
-  if (finalDeviceId.length() > 0) {
-    finalDeviceId += deviceIdSuffix;
+
+  appendPendingBootReasonToJson(doc.as<JsonObject>());
+
+  if (stats != nullptr && !isTest) {
+      apiWireRideStats(doc.as<JsonObject>(), *stats);
   }
-  
-  doc["device_id"] = finalDeviceId;
 
-  // Overwrite ID tag for test mode
-  if (isTest) {
-      doc["id_tag"] = "MCC-Testuser" + deviceIdSuffix;
-      if (debugEnabled) {
-        Serial.printf("DEBUG: In test mode, ID tag is overwritten: %s\n", doc["id_tag"].as<String>().c_str());
+  if (trace != nullptr && !isTest) {
+      // Stored by pointer in the document, so it must outlive serializeJson() below
+      static char traceBase64[RIDE_TRACE_BASE64_LEN];
+      if (rideTraceBase64(trace->data, trace->len, traceBase64, sizeof(traceBase64)) > 0) {
+          const uint32_t ageMs = ((uint32_t)esp_timer_get_time() - trace->startUs) / 1000;
+          apiWireRideTrace(doc.as<JsonObject>(), *trace, traceBase64, ageMs);
       }
-  } else {
-      doc["id_tag"] = idTag;
   }
 
-  appendPendingBootReasonToJson(doc.as<JsonObject>());
+  if (measureJson(doc) >= outSize) {
+    MCC_LOGD("update-data payload exceeds %u bytes, not sent.\n", (unsigned)outSize);
+    out[0] = '\0';
+    return 0;
+  }
+  return serializeJson(doc, out, outSize);
+}
+
+/**
+ * @brief Builds the JSON body for the update-data-batch endpoint.
+ * 
+ * Format: {"device_id": "...", "intervals": [{"seq": 12, "id_tag": "...", "distance": 0.0415}, ...]}
+ * Each interval carries the same distance (km) as a single update-data request.
+ * 
+ * @param records Journal records in sequence order
+ * @param count Number of records
+ * @return Serialized JSON payload
+ */
+String buildUpdateDataBatchPayload(const JournalRecord* records, uint32_t count) {
+  DynamicJsonDocument doc(JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(UPLOAD_BATCH_MAX) +
+                          UPLOAD_BATCH_MAX * JSON_OBJECT_SIZE(3) + 128);
+
+  doc["device_id"] = deviceIdFull();
+
+  JsonArray intervals = doc.createNestedArray("intervals");
+  for (uint32_t i = 0; i < count; i++) {
+    JsonObject interval = intervals.createNestedObject();
+    interval["seq"] = records[i].seq;
+    interval["id_tag"] = (const char*)records[i].idTag;  // Stored by pointer, records outlive serialization
+    interval["distance"] = records[i].distance_mm / 1000000.0;  // Convert mm to km
+  }
 
   String jsonPayload;
   serializeJson(doc, jsonPayload);
+  return jsonPayload;
+}
 
-  // Combine base URL + specific path ---
-  String finalUrl = serverUrl;
-  
-  // Ensure base URL doesn't end with slash before appending path
-  if (finalUrl.endsWith("/")) {
-    finalUrl.remove(finalUrl.length() - 1);
+/**
+ * @brief Sends tachometer data to the configured server via HTTP POST.
+ * 
+ * Sends distance, speed, and pulse data as JSON to the server API endpoint.
+ * Handles both test mode (simulated data) and normal mode (real measurements).
+ * 
+ * @param currentSpeed_kmh Current speed in kilometers per hour
+ * @param distanceInInterval_mm Distance traveled in the interval in millimeters
+ * @param pulsesInInterval Number of pulses detected in the interval
+ * @param isTest If true, sends simulated test data instead of real measurements
+ * @param idTagOverride If set, data is sent for this ID tag instead of the current idTag
+ * @return HTTP status code on success (>0), -1 on WiFi error, -2 on configuration error
+ * 
+ * @note Hardware interaction: LED_PIN (blinks during transmission)
+ * @note Side effects: Sends HTTP request, controls LED, writes to Serial
+ */
+int sendDataToServer(float currentSpeed_kmh, float distanceInInterval_mm, int pulsesInInterval, bool isTest, const char* idTagOverride) {
+  if (serverUrl.length() == 0 || wifi_ssid.length() == 0) {
+    digitalWrite(LED_PIN, LOW);  // Turn off LED on error
+    MCC_LOGD("Error: Server URL or WiFi SSID is not configured.");
+    return -2;
+  }
+
+  if (WiFi.status() != WL_CONNECTED) {
+    digitalWrite(LED_PIN, LOW);  // Turn off LED on error
+    MCC_LOGD("sendDataToServer: ERROR: No WiFi connected.");
+    return -1;
   }
   
+  HttpSession session;
+  HTTPClient& http = session.http();
+  char jsonPayload[UPDATE_DATA_PAYLOAD_LEN];
+  if (buildUpdateDataPayload(jsonPayload, sizeof(jsonPayload), currentSpeed_kmh, distanceInInterval_mm, pulsesInInterval, isTest, idTagOverride) == 0) {
+    return -2;
+  }
+
   // Use UPDATE_DATA path for sending tachometer data
-  finalUrl += API_UPDATE_DATA_PATH;
+  const char* finalUrl = apiUrl(API_EP_UPDATE_DATA);
 
   if (debugEnabled) {
-    Serial.print("DEBUG: Sending to URL: ");
-    Serial.println(finalUrl);
+    logSerial.print("DEBUG: Sending to URL: ");
+    logSerial.println(finalUrl);
     
     // Display current send interval in log
     if (isTest) {
-      Serial.printf("Test send interval: %u s\n", testInterval_sec);
+      logSerial.printf("Test send interval: %u s\n", testInterval_sec);
     } else {
-      Serial.printf("Send interval: %u s\n", sendInterval_sec);
+      logSerial.printf("Send interval: %u s\n", sendInterval_sec);
     }
 
     // Display current wheel circumference in log
-    Serial.printf("Wheel circumference: %.1f mm\n", wheel_size);
+    logSerial.printf("Wheel circumference: %.1f mm\n", wheel_size);
 
-    Serial.println("Sending JSON data:");
-    Serial.println(jsonPayload);
+    logSerial.println("Sending JSON data:");
+    logSerial.println(jsonPayload);
   }
 
-  http.begin(finalUrl);
+  session.begin(finalUrl, METRIC_EP_UPDATE_DATA);
   http.addHeader("Content-Type", "application/json");
   if (apiKey.length() > 0) {
-    if (debugEnabled) {
-      Serial.print("Using API key header: X-Api-Key: ");
-      Serial.println(apiKey);
-    }
+    // Secrets are shortened: the log can be read in the portal
+    MCC_LOGD("Using API key header: X-Api-Key: %.3s***", apiKey.c_str());
     http.addHeader("X-Api-Key", apiKey);
   }
   
   digitalWrite(LED_PIN, HIGH);  // Turn on LED when sending
     
-  int httpCode = http.POST(jsonPayload);
+  String response;
+  int httpCode = session.recordResult(payloadExchange(http, jsonPayload, &response));
 
   digitalWrite(LED_PIN, LOW);  // OFF
 
   if (httpCode > 0 && httpCode < 300) {
-    String response = http.getString();
-    applyDisplayVelosFromResponse(response);
+    // Velos in the response belong to the ID tag the data was sent for
+    if (idTagOverride == nullptr || idTag == idTagOverride) {
+      applyDisplayVelosFromResponse(response.c_str());
+    }
     if (debugEnabled) {
-      Serial.printf("HTTP Code: %d\n", httpCode);
-      Serial.println("Server Response:");
-      Serial.println(response);
+      logSerial.printf("HTTP Code: %d\n", httpCode);
+      logSerial.println("Server Response:");
+      logSerial.println(response);
     }
   } else if (debugEnabled) {
-    Serial.printf("HTTP Code: %d\n", httpCode);
+    logSerial.printf("HTTP Code: %d\n", httpCode);
     if (httpCode > 0) {
-      Serial.println(http.getString());
+      logSerial.println(response);
     } else {
-      Serial.printf("HTTP error: %s\n", http.errorToString(httpCode).c_str());
+      logSerial.printf("HTTP error: %s\n", http.errorToString(httpCode).c_str());
     }
   }
 
@@ -1943,12 +2295,11 @@ bool applyOperatorResetFromResponse(JsonDocument& responseDoc) {
     String defaultTag = responseDoc["default_id_tag"] | "";
     String defaultUser = responseDoc["default_user_id"] | "NULL";
 
-    preferences.begin("bike-tacho", false);
     if (defaultTag.length() > 0) {
-        preferences.putString("default_id_tag", defaultTag);
+        configSetString(CFG_DEFAULT_ID_TAG, defaultTag);
+        configCommit();
         idTag = defaultTag;
     }
-    preferences.end();
 
     idTagFromRFID = false;
     resetDistanceCounters();
@@ -1956,7 +2307,7 @@ bool applyOperatorResetFromResponse(JsonDocument& responseDoc) {
     lastSentIdTag = idTag;
 
     if (debugEnabled) {
-        Serial.printf("DEBUG: Operator reset applied (default_tag=%s, user=%s)\n",
+        logSerial.printf("DEBUG: Operator reset applied (default_tag=%s, user=%s)\n",
                         defaultTag.c_str(), username.c_str());
     }
 
@@ -1966,76 +2317,96 @@ bool applyOperatorResetFromResponse(JsonDocument& responseDoc) {
 
 String getUserIdFromTag(String& tagId) {
     // Check backoff interval - don't spam server with requests after errors
-    // After 60 seconds, retry even if API key error is active (to check if API key was fixed)
-    if (lastServerErrorTime > 0 && (millis() - lastServerErrorTime) < serverErrorBackoffInterval) {
-        if (debugEnabled) {
-            Serial.println("DEBUG: getUserIdFromTag: Still in backoff period, skipping request.");
-        }
+    // After the backoff, retry even if API key error is active (to check if API key was fixed)
+    if (serverBackoffActive()) {
+        MCC_LOGD("getUserIdFromTag: Still in backoff period, skipping request.");
         // Return empty string to indicate query was not attempted (not just "not found")
         return "";
     }
     
     if (serverUrl.length() == 0 || wifi_ssid.length() == 0 || WiFi.status() != WL_CONNECTED) {
-        if (debugEnabled) {
-            Serial.println("DEBUG: getUserIdFromTag: Error: No connection or configuration error.");
-        }
+        MCC_LOGD("getUserIdFromTag: Error: No connection or configuration error.");
         // Don't show error message here - WLAN error is shown in connectToWiFi() after 3 failed attempts
         digitalWrite(LED_PIN, LOW);
         // Return empty string to indicate query was not attempted (not just "not found")
         return "";
     }
 
-    HTTPClient http;
-    StaticJsonDocument<256> doc;
-    
-    doc["id_tag"] = tagId;
-    doc["device_id"] = deviceName;
-    doc["current_id_tag"] = idTag;
-    String jsonPayload;
-    serializeJson(doc, jsonPayload);
+    HttpSession session;
+    HTTPClient& http = session.http();
+    String jsonPayload = buildUserIdPayload(tagId);
 
     // Combine base URL + specific path
-    String finalUrl = serverUrl;
-    if (finalUrl.endsWith("/")) {
-        finalUrl.remove(finalUrl.length() - 1);
-    }
-    finalUrl += API_GET_USER_ID_PATH;
+    const char* finalUrl = apiUrl(API_EP_GET_USER_ID);
 
     if (debugEnabled) {
-        Serial.print("DEBUG: Querying user_id from: ");
-        Serial.println(finalUrl);
-        Serial.printf("DEBUG: For ID tag: %s\n", tagId.c_str());
+        logSerial.print("DEBUG: Querying user_id from: ");
+        logSerial.println(finalUrl);
+        logSerial.printf("DEBUG: For ID tag: %s\n", tagId.c_str());
     }
 
-    http.begin(finalUrl);
+    session.begin(finalUrl, METRIC_EP_GET_USER_ID);
     http.addHeader("Content-Type", "application/json");
     // Add API key header
     if (apiKey.length() > 0) {
         http.addHeader("X-Api-Key", apiKey);
     }
     
-    int httpCode = http.POST(jsonPayload);
+    int httpCode = session.recordResult(http.POST(jsonPayload));
     String response = "";
+    if (httpCode > 0) {
+        response = http.getString();
+    }
+    http.end();
+
+    String newUsername = applyUserIdResponse(httpCode, response);
+    cacheUserIdResult(tagId, newUsername, response);
+    return newUsername;
+}
+
+/**
+ * @brief Builds the JSON body for the get-user-id endpoint.
+ * 
+ * @param tagId RFID tag UID in hex format
+ * @return Serialized JSON payload
+ */
+String buildUserIdPayload(const String& tagId) {
+    StaticJsonDocument<256> doc;
+    
+    apiWireUserIdQuery(doc.to<JsonObject>(), tagId.c_str(), deviceName.c_str(), idTag.c_str());
+    String jsonPayload;
+    serializeJson(doc, jsonPayload);
+    return jsonPayload;
+}
+
+/**
+ * @brief Evaluates a get-user-id response (HTTP code and body).
+ * 
+ * Shared by getUserIdFromTag() and the network worker result handling.
+ * Updates error state, username and OLED exactly like the synchronous query.
+ * 
+ * @param httpCode HTTP status code (< 0 on connection error)
+ * @param response Response body (may be empty)
+ * @return Same values as getUserIdFromTag()
+ * 
+ * @note Side effects: Modifies username and error state, updates OLED display
+ */
+String applyUserIdResponse(int httpCode, const String& response) {
     
     if (httpCode > 0) {
         if (httpCode == HTTP_CODE_OK) { // 200
-            response = http.getString();
-            if (debugEnabled) {
-                Serial.printf("DEBUG: Server response: %s\n", response.c_str());
-            }
+            MCC_LOGD("Server response: %s\n", response.c_str());
 
             StaticJsonDocument<384> responseDoc;
             DeserializationError error = deserializeJson(responseDoc, response);
 
             if (error) {
-                if (debugEnabled) {
-                    Serial.printf("DEBUG: JSON deserialization error: %s\n", error.c_str());
-                }
-                http.end();
+                MCC_LOGD("JSON deserialization error: %s\n", error.c_str());
                 return "FEHLER";
             }
 
-            if (responseDoc.containsKey("is_operator_tag") && responseDoc["is_operator_tag"].as<bool>()) {
+            const ApiWireUserId result = apiWireUserId(responseDoc.as<JsonVariantConst>(), TAG_CACHE_DEFAULT_TTL_SEC);
+            if (result.operatorTag) {
                 bool didReset = applyOperatorResetFromResponse(responseDoc);
                 String defaultTag = responseDoc["default_id_tag"] | "";
                 String defaultUserId = responseDoc["default_user_id"] | String("NULL");
@@ -2043,7 +2414,6 @@ String getUserIdFromTag(String& tagId) {
                 if (!didReset) {
                     operatorUserId = String("OPERATOR");
                 }
-                http.end();
                 lastServerErrorTime = 0;
                 apiKeyErrorActive = false;
                 username = operatorUserId;
@@ -2051,9 +2421,9 @@ String getUserIdFromTag(String& tagId) {
                 display_OperatorReset(
                     didReset,
                     defaultUserId.c_str(),
-                    defaultTag.c_str()
+                    defaultTag.c_str(),
+                    3000
                 );
-                delay(3000);
                 #endif
                 // Display handled; username already updated. Empty return prevents
                 // the ID-tag-change loop from showing "ID Tag erkannt!" again.
@@ -2061,9 +2431,8 @@ String getUserIdFromTag(String& tagId) {
             }
             
             // Response should contain a JSON object with key "user_id"
-            if (responseDoc.containsKey("user_id")) {
-                String userId = responseDoc["user_id"].as<String>();
-                http.end();
+            if (result.userId != nullptr) {
+                String userId = result.userId;
                 // Clear server error backoff on success
                 bool hadServerError = (lastServerErrorTime > 0);
                 lastServerErrorTime = 0;
@@ -2101,30 +2470,26 @@ String getUserIdFromTag(String& tagId) {
             
         } else {
             // HTTP error codes
+            const ApiWireError wireError = apiWireError(httpCode);
             String errorType = "Server";
             bool isApiKeyError = false;
-            if (httpCode == 401) {
+            if (wireError == API_WIRE_API_KEY) {
                 errorType = "API Key";
                 isApiKeyError = true;
-            } else if (httpCode == 403) {
-                errorType = "API Key";
-                isApiKeyError = true;
-            } else if (httpCode == 503) {
+            } else if (wireError == API_WIRE_MAINTENANCE) {
                 errorType = "Wartung";
-            } else if (httpCode == 500) {
-                errorType = "Server";
-            } else if (httpCode == 404) {
+            } else if (wireError == API_WIRE_NOT_FOUND) {
                 // 404 in getUserIdFromTag means cyclist not found
                 errorType = "Radler nicht";
             }
             
             if (debugEnabled) {
-                Serial.printf("DEBUG: HTTP error when retrieving user ID: %d\n", httpCode);
-                Serial.println(http.getString());
+                logSerial.printf("DEBUG: HTTP error when retrieving user ID: %d\n", httpCode);
+                logSerial.println(response);
             }
             
             // Update backoff timer
-            lastServerErrorTime = millis();
+            noteServerError(readBackpressure(response.c_str()).retryAfterSec);
             
             // Set API key error flag if API key error detected
             if (isApiKeyError) {
@@ -2142,69 +2507,47 @@ String getUserIdFromTag(String& tagId) {
                 
                 #ifdef ENABLE_OLED
                 // Show specific message for cyclist not found
-                display.clearBuffer();
-                display.setFont(u8g2_font_7x14_tf);
-                
-                textline = "Fehler:";
-                textWidth = display.getStrWidth(textline);
-                display.setCursor((128 - textWidth) / 2, 12);
-                display.print(textline);
-                
-                textline = "Radler nicht";
-                textWidth = display.getStrWidth(textline);
-                display.setCursor((128 - textWidth) / 2, 28);
-                display.print(textline);
-                
-                textline = "gefunden";
-                textWidth = display.getStrWidth(textline);
-                display.setCursor((128 - textWidth) / 2, 44);
-                display.print(textline);
-                
-                display.sendBuffer();
-                delay(3000);
+                UiScreen screen;
+                uiScreenInit(&screen, 3000);
+                uiScreenAddLine(&screen, 12, "Fehler:");
+                uiScreenAddLine(&screen, 28, "Radler nicht");
+                uiScreenAddLine(&screen, 44, "gefunden");
+                uiShowScreen(screen);
                 #endif
                 
                 // Ensure LED stays off after error display
                 digitalWrite(LED_PIN, LOW);
                 
-                http.end();
                 return "NULL";
     } else {
                 #ifdef ENABLE_OLED
-                display_ServerError(errorType.c_str(), httpCode);
-                delay(3000);
+                display_ServerError(errorType.c_str(), httpCode, 3000);
                 // Ensure LED stays off after error display
                 digitalWrite(LED_PIN, LOW);
                 #endif
             }
             // For other HTTP errors, return empty string (query failed, don't update username)
-            http.end();
             return "";
         }
     } else {
         // Connection error (httpCode < 0)
-        if (debugEnabled) {
-            Serial.printf("DEBUG: HTTP connection error: %s\n", http.errorToString(httpCode).c_str());
-        }
+        MCC_LOGD("HTTP connection error: %s\n", HTTPClient::errorToString(httpCode).c_str());
         
         // Update backoff timer
-        lastServerErrorTime = millis();
+        noteServerError(0);
         // Don't set apiKeyErrorActive for connection errors (only for HTTP 401/403)
         
         #ifdef ENABLE_OLED
-        display_ServerError("Server", 0);
-        delay(3000);
+        display_ServerError("Server", 0, 3000);
         #endif
         digitalWrite(LED_PIN, LOW);
         
-        http.end();
         // Return empty string if query was not attempted (connection error, backoff, etc.)
         // Only return "NULL" if query was actually made but user not found
         // Connection errors mean query was not attempted, so return empty string
         return ""; // Return empty string on connection errors (query not attempted)
     }
 
-    http.end();
     // Should not reach here, but return empty string as fallback
     return "";
 }
@@ -2217,31 +2560,31 @@ String getUserIdFromTag(String& tagId) {
  * @note Side effects: Writes to Serial output
  */
 void displayNVSConfig() {
-    Serial.println("\n--- NVS configuration data ---");
-    Serial.printf("WiFi SSID: %s\n", preferences.getString("wifi_ssid", "").c_str());
-    Serial.printf("WiFi password: %s\n", preferences.getString("wifi_password", "").c_str());
-    Serial.printf("Device name: %s\n", (preferences.getString("deviceName", "") + deviceIdSuffix).c_str());
-    Serial.printf("ID Tag: %s\n", preferences.getString("idTag", "").c_str());
-    Serial.printf("Wheel size: %.1f mm\n", preferences.getFloat("wheel_size", 2075.0));
-    Serial.printf("Paedagogischer bonus: %.2f\n", preferences.getFloat("ped_bonus", 0.0f));
-    Serial.printf("Server URL: %s\n", preferences.getString("serverUrl", "").c_str());
-    Serial.printf("API Key: %s\n", preferences.getString("apiKey", "").c_str());
-    Serial.printf("Send interval: %d s\n", preferences.getUInt("sendInterval", 30));
-    Serial.printf("LED enabled: %s\n", preferences.getBool("ledEnabled", true) ? "Yes" : "No");
-    Serial.printf("Debug mode: %s\n", preferences.getBool("debugEnabled", false) ? "Yes" : "No");
+    logSerial.println("\n--- NVS configuration data ---");
+    logSerial.printf("WiFi SSID: %s\n", preferences.getString("wifi_ssid", "").c_str());
+    logSerial.printf("WiFi password: %.3s***\n", preferences.getString("wifi_password", "").c_str());
+    logSerial.printf("Device name: %s\n", (preferences.getString("deviceName", "") + deviceIdSuffix).c_str());
+    logSerial.printf("ID Tag: %s\n", preferences.getString("idTag", "").c_str());
+    logSerial.printf("Wheel size: %.1f mm\n", preferences.getFloat("wheel_size", 2075.0));
+    logSerial.printf("Paedagogischer bonus: %.2f\n", preferences.getFloat("ped_bonus", 0.0f));
+    logSerial.printf("Server URL: %s\n", preferences.getString("serverUrl", "").c_str());
+    logSerial.printf("API Key: %.3s***\n", preferences.getString("apiKey", "").c_str());
+    logSerial.printf("Send interval: %d s\n", preferences.getUInt("sendInterval", 30));
+    logSerial.printf("LED enabled: %s\n", preferences.getBool("ledEnabled", true) ? "Yes" : "No");
+    logSerial.printf("Debug mode: %s\n", preferences.getBool("debugEnabled", false) ? "Yes" : "No");
     // NVS key max length is 15 characters, so use shorter key
-    Serial.printf("Deep-Sleep-Zeit: %lu s\n", preferences.getUInt("deep_sleep", 300));
-    Serial.printf("Test mode: %s\n", preferences.getBool("testModeEnabled", false) ? "Yes" : "No");
-    Serial.printf("  Test distance: %.2f km\n", preferences.getFloat("testDistance", 0.01));
-    Serial.printf("  Test interval: %d s\n", preferences.getUInt("testInterval", 5));
+    logSerial.printf("Deep-Sleep-Zeit: %lu s\n", preferences.getUInt("deep_sleep", 300));
+    logSerial.printf("Test mode: %s\n", preferences.getBool("testModeEnabled", false) ? "Yes" : "No");
+    logSerial.printf("  Test distance: %.2f km\n", preferences.getFloat("testDistance", 0.01));
+    logSerial.printf("  Test interval: %d s\n", preferences.getUInt("testInterval", 5));
     // Config-WLAN-Passwort (nicht im Klartext aus Sicherheitsgründen)
     String apPassword = preferences.getString("ap_passwd", "");
     if (apPassword.length() > 0) {
-        Serial.printf("Config-WLAN-Passwort: *** (gesetzt, %d Zeichen)\n", apPassword.length());
+        logSerial.printf("Config-WLAN-Passwort: *** (gesetzt, %d Zeichen)\n", apPassword.length());
     } else {
-        Serial.printf("Config-WLAN-Passwort: (Standard)\n");
+        logSerial.printf("Config-WLAN-Passwort: (Standard)\n");
     }
-    Serial.println("------------------------------\n");
+    logSerial.println("------------------------------\n");
 }
 
 
@@ -2258,7 +2601,7 @@ void setupDeepSleep() {
     // Enable wakeup from deep sleep only via sensor pin
     // Configures ESP32 to wake up on LOW signal on sensor pin
     if (debugEnabled) {
-      Serial.println("Setting up deep sleep wakeup.");
+      logSerial.println("Setting up deep sleep wakeup.");
     }
     esp_sleep_enable_ext0_wakeup((gpio_num_t)SENSOR_PIN, LOW); 
 }
@@ -2274,21 +2617,40 @@ void setupDeepSleep() {
  * @note Side effects: Modifies global configuration variables, writes to Serial
  */
 void getPreferences() {
+    // Everything is read from NVS once; missing keys get these defaults
+    DeviceConfig defaults;
+    defaults.sendInterval = 30;
+    defaults.deepSleep = deepSleepTimeout_sec;
+    defaults.testInterval = 5;
+    defaults.configFetchInterval = configFetchInterval_sec;
+    defaults.uploadBatch = uploadBatchSize;
+    defaults.wheelSize = 2075.0;  // Default: 26 Zoll = 2075 mm
+    defaults.pedBonus = 0.0f;
+    defaults.testDistance = 0.01;
+    defaults.debug = debugEnabled;  // Global default value (true) as fallback if NVS is empty
+    defaults.led = true;
+    defaults.testMode = false;
+    defaults.testAdmin = false;
+    defaults.lowPowerRide = false;
+    defaults.fastBoot = false;
+    defaults.traceMaxBytes = 0;
+    defaults.traceInterval = 0;
+    defaults.nodeRole = GATEWAY_ROLE_STANDALONE;
+    configLoad(defaults);
+
     // Load debug status first to immediately take control of serial output
-    // Use global default value (true) as fallback if NVS is empty.
-    debugEnabled = preferences.getBool("debugEnabled", debugEnabled); 
+    debugEnabled = deviceConfig.debug;
     
     // ***************************************************************
     // ADD DEBUG CHECK
     // ***************************************************************
-    if (debugEnabled) {
-        Serial.println("DEBUG: getPreferences() started.");
-    }
+    MCC_LOGD("getPreferences() started.");
     // Load saved configuration into global variables
-    //preferences.begin("bike-tacho", false);
-    wifi_ssid = preferences.getString("wifi_ssid", "");
-    wifi_password = preferences.getString("wifi_password", "");
-    deviceName = preferences.getString("deviceName", "");
+    wifi_ssid = deviceConfig.wifiSsid;
+    wifi_password = deviceConfig.wifiPassword;
+    wifi_ssid2 = deviceConfig.wifiSsid2;
+    wifi_password2 = deviceConfig.wifiPassword2;
+    deviceName = deviceConfig.deviceName;
     
     // Fallback to build flag DEFAULT_DEVICE_NAME if NVS is empty
     // Note: deviceIdSuffix is already generated in setup() before getPreferences() is called
@@ -2296,40 +2658,26 @@ void getPreferences() {
     if (deviceName.length() == 0) {
         deviceName = String(DEFAULT_DEVICE_NAME);
         // Write default device name to NVS so it's available on next startup
-        if (!preferences.putString("deviceName", deviceName)) {
-            Serial.print("ERROR: getPreferences() - Failed to write parameter 'deviceName' to NVS\n");
-        }
+        configSetString(CFG_DEVICE_NAME, deviceName);
         if (debugEnabled) {
-            Serial.print("DEBUG: Using build flag DEFAULT_DEVICE_NAME as fallback and saving to NVS: ");
-            Serial.println(deviceName);
+            logSerial.print("DEBUG: Using build flag DEFAULT_DEVICE_NAME as fallback and saving to NVS: ");
+            logSerial.println(deviceName);
         }
     }
     #endif
     
-    // Load default_id_tag from NVS (set via Config-GUI or Server config)
+    // default_id_tag is set via Config-GUI or Server config (configLoad() falls back to the legacy "idTag" key)
     // This is the default that should NOT be overwritten by RFID tag detection
-    String defaultIdTag = preferences.getString("default_id_tag", "");
-    // If default_id_tag doesn't exist, try legacy "idTag" key for backward compatibility
-    if (defaultIdTag.length() == 0) {
-        defaultIdTag = preferences.getString("idTag", "");
-        // If found in legacy key, migrate to new key
-        if (defaultIdTag.length() > 0) {
-            if (!preferences.putString("default_id_tag", defaultIdTag)) {
-                Serial.print("ERROR: getPreferences() - Failed to write parameter 'default_id_tag' to NVS\n");
-            }
-        }
-    }
+    String defaultIdTag = deviceConfig.defaultIdTag;
     // Fallback to build flag DEFAULT_ID_TAG if NVS is empty
     #ifdef DEFAULT_ID_TAG
     if (defaultIdTag.length() == 0) {
         defaultIdTag = String(DEFAULT_ID_TAG);
         // Write default ID tag to NVS so it's available on next startup
-        if (!preferences.putString("default_id_tag", defaultIdTag)) {
-            Serial.print("ERROR: getPreferences() - Failed to write parameter 'default_id_tag' to NVS\n");
-        }
+        configSetString(CFG_DEFAULT_ID_TAG, defaultIdTag);
         if (debugEnabled) {
-            Serial.print("DEBUG: Using build flag DEFAULT_ID_TAG as fallback and saving to NVS: ");
-            Serial.println(defaultIdTag);
+            logSerial.print("DEBUG: Using build flag DEFAULT_ID_TAG as fallback and saving to NVS: ");
+            logSerial.println(defaultIdTag);
         }
     }
     #endif
@@ -2340,47 +2688,72 @@ void getPreferences() {
     // This is important after deep sleep wakeup, as the default_id_tag should be used
     // even if a different RFID tag was used before deep sleep
     lastSentIdTag = "";
-    wheel_size = preferences.getFloat("wheel_size", 2075.0);  // Default: 26 Zoll = 2075 mm
-    paedagogischer_bonus = preferences.getFloat("ped_bonus", 0.0f);
-    serverUrl = preferences.getString("serverUrl", "");
-    // Check if apiKey exists in NVS before reading to avoid error log
-    if (preferences.isKey("apiKey")) {
-        apiKey = preferences.getString("apiKey", "");
-    } else {
-        apiKey = "";  // Key doesn't exist, use empty string
-    }
-    sendInterval_sec = preferences.getUInt("sendInterval", 30);
-    // If sendInterval is 0 or not set, use default value of 30 seconds and save to NVS
+    wheel_size = deviceConfig.wheelSize;
+    paedagogischer_bonus = deviceConfig.pedBonus;
+    serverUrl = deviceConfig.serverUrl;
+    apiKey = deviceConfig.apiKey;
+    sendInterval_sec = deviceConfig.sendInterval;
+    // If sendInterval is 0, use default value of 30 seconds and save to NVS
     if (sendInterval_sec == 0) {
         sendInterval_sec = 30;
-        if (!preferences.putUInt("sendInterval", sendInterval_sec)) {
-            Serial.print("ERROR: getPreferences() - Failed to write parameter 'sendInterval' to NVS\n");
-        }
+        configSetUInt(CFG_SEND_INTERVAL, sendInterval_sec);
         if (debugEnabled) {
-            Serial.print("DEBUG: Using default sendInterval (30 seconds) and saving to NVS: ");
-            Serial.println(sendInterval_sec);
+            logSerial.print("DEBUG: Using default sendInterval (30 seconds) and saving to NVS: ");
+            logSerial.println(sendInterval_sec);
         }
     }
-    ledEnabled = preferences.getBool("ledEnabled", true);
-    // NVS key max length is 15 characters, so use shorter key
-    deepSleepTimeout_sec = preferences.getUInt("deep_sleep", deepSleepTimeout_sec);
+    ledEnabled = deviceConfig.led;
+    deepSleepTimeout_sec = deviceConfig.deepSleep;
     // If deepSleepTimeout_sec is 0, disable deep sleep
     if (deepSleepTimeout_sec == 0) {
         DeepSleep = false;
-        if (debugEnabled) {
-            Serial.println("DEBUG: Deep Sleep disabled (timeout = 0)");
-        }
+        MCC_LOGD("Deep Sleep disabled (timeout = 0)");
     } else {
         DeepSleep = true;
     }
     
-    // Load config fetch interval from NVS
-    // NVS key max length is 15 characters, so use shorter key
-    configFetchInterval_sec = preferences.getUInt("cfg_fetch_int", configFetchInterval_sec);
-    if (debugEnabled) {
-        Serial.printf("DEBUG: Config fetch interval loaded from NVS: %u seconds\n", configFetchInterval_sec);
-    }
+    configFetchInterval_sec = deviceConfig.configFetchInterval;
+    MCC_LOGD("Config fetch interval loaded from NVS: %u seconds\n", configFetchInterval_sec);
     lastConfigFetchTime = 0; // Will be set after first config fetch
+
+    // Batch upload size (1 = no batching)
+    uploadBatchSize = constrain((unsigned int)deviceConfig.uploadBatch, 1u, (unsigned int)UPLOAD_BATCH_MAX);
+    MCC_LOGD("Upload batch size loaded from NVS: %u\n", uploadBatchSize);
+
+    // Low-power riding mode (light sleep between uploads, ULP counts pulses)
+    lowPowerRide = deviceConfig.lowPowerRide;
+    MCC_LOGD("Low-power riding loaded from NVS: %s\n", lowPowerRide ? "on" : "off");
+
+    // Ride trace (opt-in per-revolution timestamps with update-data)
+    traceMaxBytes = min((unsigned int)deviceConfig.traceMaxBytes, (unsigned int)RIDE_TRACE_MAX_BYTES);
+    traceInterval_sec = deviceConfig.traceInterval;
+    MCC_LOGD("Ride trace loaded from NVS: %u bytes, every %u s\n", traceMaxBytes, traceInterval_sec);
+
+    // Fast boot (counting first, splash, tones and network calls from loop())
+    fastBoot = deviceConfig.fastBoot;
+    MCC_LOGD("Fast boot loaded from NVS: %s\n", fastBoot ? "on" : "off");
+
+    // Gateway role; takes effect with the next WiFi start (connectToWiFi())
+    gatewayRole = deviceConfig.nodeRole <= GATEWAY_ROLE_GATEWAY ? (GatewayRole)deviceConfig.nodeRole : GATEWAY_ROLE_STANDALONE;
+    MCC_LOGD("Node role loaded from NVS: %s\n", gatewayRoleToString(gatewayRole));
+    gatewaySecret = deviceConfig.gatewaySecret;
+    if (gatewayRole != GATEWAY_ROLE_STANDALONE && gatewaySecret.length() < GATEWAY_SECRET_MIN_LEN) {
+        MCC_LOGW("Gateway secret not set, the ESP-NOW link stays off");
+    }
+
+    // Static IP configuration (empty = DHCP)
+    staticIp = deviceConfig.staticIp;
+    if (debugEnabled && staticIp.length() > 0) {
+        logSerial.printf("DEBUG: Static IP loaded from NVS: %s\n", staticIp.c_str());
+    }
+
+    mqttUrl = deviceConfig.mqttUrl;
+    if (debugEnabled && mqttUrl.length() > 0) {
+        logSerial.printf("DEBUG: MQTT broker loaded from NVS: %s\n", mqttUrl.c_str());
+    }
+
+    // Load cached ID tag lookups from NVS (confirmed again by the server on first use)
+    loadTagCache();
     
     // Fallback to build flags if NVS values are empty
     // This ensures devices can connect to server without manual configuration
@@ -2388,12 +2761,10 @@ void getPreferences() {
     if (serverUrl.length() == 0) {
         serverUrl = String(DEFAULT_SERVER_URL);
         // Write default server URL to NVS so it's available on next startup
-        if (!preferences.putString("serverUrl", serverUrl)) {
-            Serial.print("ERROR: getPreferences() - Failed to write parameter 'serverUrl' to NVS\n");
-        }
+        configSetString(CFG_SERVER_URL, serverUrl);
         if (debugEnabled) {
-            Serial.print("DEBUG: Using build flag DEFAULT_SERVER_URL as fallback and saving to NVS: ");
-            Serial.println(serverUrl);
+            logSerial.print("DEBUG: Using build flag DEFAULT_SERVER_URL as fallback and saving to NVS: ");
+            logSerial.println(serverUrl);
         }
     }
     #endif
@@ -2402,13 +2773,8 @@ void getPreferences() {
     if (apiKey.length() == 0) {
         apiKey = String(DEFAULT_API_KEY);
         // Write default API key to NVS so it's available on next startup
-        if (!preferences.putString("apiKey", apiKey)) {
-            Serial.print("ERROR: getPreferences() - Failed to write parameter 'apiKey' to NVS\n");
-        }
-        if (debugEnabled) {
-            Serial.print("DEBUG: Using build flag DEFAULT_API_KEY as fallback and saving to NVS: ");
-            Serial.println(apiKey);
-        }
+        configSetString(CFG_API_KEY, apiKey);
+        MCC_LOGD("Using build flag DEFAULT_API_KEY as fallback and saving to NVS: %.3s***", apiKey.c_str());
     }
     #endif
     
@@ -2418,52 +2784,41 @@ void getPreferences() {
         if (serverUrl.indexOf("http://http") >= 0 || serverUrl.indexOf("https://http") >= 0 ||
             serverUrl.indexOf("http://https") >= 0 || serverUrl.indexOf("https://https") >= 0) {
             if (debugEnabled) {
-                Serial.print("DEBUG: Detected malformed serverUrl: ");
-                Serial.println(serverUrl);
-                Serial.println("DEBUG: Clearing malformed URL, will use default.");
+                logSerial.print("DEBUG: Detected malformed serverUrl: ");
+                logSerial.println(serverUrl);
+                logSerial.println("DEBUG: Clearing malformed URL, will use default.");
             }
-            preferences.remove("serverUrl");
+            configSetString(CFG_SERVER_URL, "");  // Removes the key on commit
             serverUrl = "";
             // Apply default if available
             #ifdef DEFAULT_SERVER_URL
             serverUrl = String(DEFAULT_SERVER_URL);
             if (debugEnabled) {
-                Serial.print("DEBUG: Using default serverUrl: ");
-                Serial.println(serverUrl);
+                logSerial.print("DEBUG: Using default serverUrl: ");
+                logSerial.println(serverUrl);
             }
             #endif
         }
     }
     
-    testActive = preferences.getBool("testModeEnabled", false);
-    // Always load testDistance and testInterval_sec from NVS (even if test mode is not active)
-    // This ensures they are always available and initialized
-    testDistance = preferences.getFloat("testDistance", 0.01);
-    testInterval_sec = preferences.getUInt("testInterval", 5);
+    testActive = deviceConfig.testMode;
+    // testDistance and testInterval_sec are always loaded (even if test mode is not active)
+    testDistance = deviceConfig.testDistance;
+    testInterval_sec = deviceConfig.testInterval;
     
-    // If testDistance was not in NVS (default value used), save it now to prevent NVS error
-    // Check if the key exists by trying to read it and comparing with a sentinel value
-    // Since getFloat returns default if not found, we check if it's the default and save it
-    // This ensures the value is always in NVS, even if it was never set before
+    // If testDistance/testInterval were not in NVS (default value used), save them now to prevent NVS errors
     if (!preferences.isKey("testDistance")) {
-        if (!preferences.putFloat("testDistance", testDistance)) {
-            Serial.print("ERROR: getPreferences() - Failed to write parameter 'testDistance' to NVS\n");
-        }
-        if (debugEnabled) {
-            Serial.printf("DEBUG: Initialized testDistance in NVS: %.2f km\n", testDistance);
-        }
+        // Setters only mark changed values; the default must still be written once
+        configMarkDirty(CFG_TEST_DISTANCE);
+        MCC_LOGD("Initialized testDistance in NVS: %.2f km\n", testDistance);
     }
-    
-    // Same for testInterval_sec
     if (!preferences.isKey("testInterval")) {
-        if (!preferences.putUInt("testInterval", testInterval_sec)) {
-            Serial.print("ERROR: getPreferences() - Failed to write parameter 'testInterval' to NVS\n");
-        }
-        if (debugEnabled) {
-            Serial.printf("DEBUG: Initialized testInterval in NVS: %u s\n", testInterval_sec);
-        }
+        configMarkDirty(CFG_TEST_INTERVAL);
+        MCC_LOGD("Initialized testInterval in NVS: %u s\n", testInterval_sec);
     }
-    //preferences.end();
+
+    // All fallback values above are written with a single NVS commit (none on a normal boot)
+    configCommit();
     
     if (debugEnabled) {
       displayNVSConfig();
@@ -2487,117 +2842,1119 @@ void resetDistanceCounters() {
     pulsesAtLastSend = 0;
     lastPulseCount = 0;
     currentPulseCount = 0; // Also reset current counter value
-    pcnt_counter_clear(PCNT_UNIT); // Reset hardware counter
+    pulseCounterClear(); // Reset hardware counter and overflow accumulator
     
-    // Reset speed calculation variables
+    // Uploads still in flight belong to the previous session
+    distanceSession++;
+
+    // Reset speed calculation (history lives in the pulse capture task)
     currentSpeed_kmh = 0.0;
-    previousPulseTime = 0;
-    speedHistoryIndex = 0;
-    speedHistoryCount = 0;
-    // Clear speed history array
-    for (int i = 0; i < SPEED_AVERAGE_COUNT; i++) {
-        speedHistory[i] = 0.0;
-    }
+    pulseCaptureReset();
 
     strcpy(displayedSessionVelosStr, "0");
     sessionEpoch = "";
     hasSessionVelosFromServer = false;
+    velosAnchor.valid = false;
+
+    MCC_LOGD("Distance values reset to zero due to ID tag change.");
+}
+
+/**
+ * @brief Uploads pulses that were counted but not sent before the last deep sleep.
+ * 
+ * The pulses are kept in RTC memory together with the ID tag of the rider
+ * and are sent for that tag, independent of the current user.
+ * 
+ * @note Side effects: Queues an upload in the network worker (see handleCarryUploadResult())
+ */
+void uploadCarriedPulses() {
+    uint32_t carriedPulses = 0;
+    char carriedIdTag[PULSE_CARRY_ID_TAG_LEN];
+    if (!pulseCounterPeekCarry(&carriedPulses, carriedIdTag) || netWorkerPending(NET_JOB_CARRY_UPLOAD)) {
+        return;
+    }
+    // Respect server error backoff like the regular send path
+    if (serverBackoffActive()) {
+        return;
+    }
 
+    float carriedDistance_mm = (float)carriedPulses * wheel_size;
     if (debugEnabled) {
-        Serial.println("DEBUG: Distance values reset to zero due to ID tag change.");
+        logSerial.printf("DEBUG: Uploading %u pulses carried over from deep sleep for ID tag %s\n",
+                      (unsigned)carriedPulses, carriedIdTag);
+    }
+    char jsonPayload[UPDATE_DATA_PAYLOAD_LEN];
+    size_t payloadLen = buildUpdateDataPayload(jsonPayload, sizeof(jsonPayload), 0.0, carriedDistance_mm,
+                                               (int)carriedPulses, false, carriedIdTag);
+    if (payloadLen > 0) {
+        netWorkerSubmit(NET_JOB_CARRY_UPLOAD, apiUrl(API_EP_UPDATE_DATA), jsonPayload, payloadLen,
+                        carriedPulses, 0, carriedIdTag);
     }
 }
 
-// --- Buzzer control functions ---
 /**
- * @brief Generates a tone on the buzzer for a specified duration.
+ * @brief Evaluates the result of a carried pulse upload.
  * 
- * Controls the active buzzer by setting BUZZER_PIN HIGH for the duration, then LOW.
- * 
- * @param duration_ms Duration of the tone in milliseconds
+ * @param responseCode HTTP status code (< 0 on connection error)
  * 
- * @note Hardware interaction: BUZZER_PIN (GPIO output)
- * @note Side effects: Blocks execution for duration_ms milliseconds
+ * @note Side effects: Clears the RTC carry on success or permanent rejection
  */
-void buzzer_tone(int duration_ms) {
-    // For active buzzer, HIGH = ON, LOW = OFF
-    digitalWrite(BUZZER_PIN, HIGH);
-    delay(duration_ms);
-    digitalWrite(BUZZER_PIN, LOW);
+void handleCarryUploadResult(int responseCode) {
+    if (responseCode > 0 && responseCode < 300) {
+        pulseCounterClearCarry();
+        MCC_LOGD("Carried pulses uploaded successfully.");
+    } else if (isPermanentUploadError(responseCode)) {
+        // Tag or device unknown to the server - retrying will not help
+        pulseCounterClearCarry();
+        MCC_LOGD("Carried pulses rejected by server (HTTP %d), discarded.\n", responseCode);
+    } else {
+        // Server and connection errors (< 0) back off alike
+        noteServerError(0);
+    }
 }
 
 /**
- * @brief Plays startup tone sequence (3 short beeps).
+ * @brief true if the server rejected the data itself, so a retry cannot succeed.
  * 
- * Indicates device restart after power-on. Plays 3 beeps of 100ms each with 100ms pauses.
+ * @param responseCode HTTP status code (< 0 on connection error)
+ * @return true for 400 (bad request) and 404 (tag or device unknown)
+ */
+bool isPermanentUploadError(int responseCode) {
+    return responseCode == 400 || responseCode == 404;
+}
+
+/**
+ * @brief true while server requests are paused after an error.
  * 
- * @note Hardware interaction: BUZZER_PIN
- * @note Side effects: Blocks execution for ~500ms
+ * Uploads, journal replays and username lookups wait; their pulses stay
+ * pending or in the journal.
  */
-void play_startup_tone() {
-    // 3 x short beep = restart after power on
-    buzzer_tone(100); delay(100);
-    buzzer_tone(100); delay(100);
-    buzzer_tone(100);
+bool serverBackoffActive() {
+    return lastServerErrorTime > 0 && uploadSchedulerBackingOff(&uploadScheduler, millis());
 }
 
 /**
- * @brief Plays wakeup tone sequence (2 short beeps).
+ * @brief Records a server error and pauses all server requests.
  * 
- * Indicates wakeup from deep sleep. Plays 2 beeps of 150ms each with 150ms pause.
+ * @param retryAfterSec Pause requested by the server (retry_after), 0 for the exponential backoff
+ */
+void noteServerError(uint32_t retryAfterSec) {
+    if (lastServerErrorTime == 0) {
+        // First error after a success: the backoff starts from the base again
+        uploadSchedulerSucceeded(&uploadScheduler);
+    }
+    lastServerErrorTime = millis();
+    const uint32_t backoffMs = uploadSchedulerFailed(&uploadScheduler, lastServerErrorTime, retryAfterSec);
+    MCC_LOGD("Server error, pausing server requests for %u s%s\n", (unsigned)(backoffMs / 1000),
+             retryAfterSec > 0 ? " (retry_after)" : "");
+}
+
+/**
+ * @brief Reads retry_after and upload_interval_seconds of an upload response.
  * 
- * @note Hardware interaction: BUZZER_PIN
- * @note Side effects: Blocks execution for ~450ms
+ * @param response Response body, may be empty
+ * @return Zero fields if not sent
  */
-void play_wakeup_tone() {
-    // 2 x short beep = wakeup from deep sleep
-    buzzer_tone(150); delay(150);
-    buzzer_tone(150);
+ApiWireBackpressure readBackpressure(const char* response) {
+    ApiWireBackpressure result = {0, 0};
+    if (response == nullptr || response[0] == '\0') {
+        return result;
+    }
+    StaticJsonDocument<64> filter;
+    filter["retry_after"] = true;
+    filter["upload_interval_seconds"] = true;
+    StaticJsonDocument<96> doc;
+    if (!deserializeJson(doc, response, DeserializationOption::Filter(filter))) {
+        result = apiWireBackpressure(doc.as<JsonVariantConst>());
+    }
+    return result;
 }
 
 /**
- * @brief Plays tag detected tone (1 long beep).
+ * @brief Journals the pulses of the previous rider that were not uploaded yet.
  * 
- * Indicates successful RFID tag detection. Plays 1 beep of 500ms.
+ * Called before the counters are reset for a new ID tag. The journal replay
+ * sends them at once (respecting a backoff), so the last seconds of a ride
+ * are neither lost nor counted for the next rider.
  * 
- * @note Hardware interaction: BUZZER_PIN
- * @note Side effects: Blocks execution for 500ms
+ * @note Side effects: Appends to the ride journal, triggers a pending batch
  */
-void play_tag_detected_tone() {
-    // 1 x long = ID tag detected
-    buzzer_tone(500);
+void flushRiderInterval() {
+    const bool previousRiderValid = !apiKeyErrorActive && username.length() > 0 && username != "NULL";
+    if (testActive || !previousRiderValid || lastSentIdTag.length() == 0) {
+        return;
+    }
+    // An upload in flight covers the pulses up to its counter value
+    uint32_t from = pulsesAtLastSend;
+    if (netWorkerPending(NET_JOB_UPDATE_DATA) && pulsesSubmitted - pulsesAtLastSend <= currentPulseCount - pulsesAtLastSend) {
+        from = pulsesSubmitted;
+    }
+    const uint32_t pulses = currentPulseCount - from;
+    if (pulses == 0) {
+        return;
+    }
+    if (rideJournalAppend(lastSentIdTag.c_str(), pulses, (float)pulses * wheel_size)) {
+        lastBatchUploadTime = 0;  // A waiting batch goes out now as well
+        MCC_LOGD("Rider changed: %u pulses of %s journaled for upload.\n", (unsigned)pulses, lastSentIdTag.c_str());
+    }
 }
 
-#ifdef ENABLE_OLED
 /**
- * @brief Displays server communication error on OLED display.
- * 
- * Shows detailed error message when server communication fails (API key, server unreachable, maintenance, etc.)
- * Displays user-friendly error descriptions without technical error codes.
+ * @brief Replays the oldest interval from the ride journal.
  * 
- * @param errorType Error type string (e.g., "API Key", "Server", "Wartung", "Kein WLAN")
- * @param errorCode HTTP error code or 0 for connection error (not displayed, used only for internal logic)
+ * Records are sent one at a time in journal order for the ID tag they were
+ * recorded for, independent of the current user.
  * 
- * @note Hardware interaction: OLED display (I2C communication)
- * @note Side effects: Updates OLED display buffer and sends to display, turns off LED
- * @note Only compiled if ENABLE_OLED is defined
+ * @note Side effects: Queues an upload in the network worker (see handleJournalReplayResult())
  */
-void display_ServerError(const char* errorType, int errorCode) {
+void replayJournal() {
+    bool isolating = false;
+    if (batchIsolateSeq > 0) {
+        JournalRecord oldest;
+        isolating = rideJournalPeek(&oldest) && oldest.seq <= batchIsolateSeq;
+        if (!isolating) {
+            batchIsolateSeq = 0;
+            MCC_LOGD("Rejected batch replayed one by one, batch uploads resume.");
+        }
+    }
+    if (uploadBatchSize > 1 && !batchUploadUnsupported && !isolating) {
+        replayJournalBatch();
+        return;
+    }
+    if (rideJournalPendingCount() == 0 || netWorkerPending(NET_JOB_JOURNAL_REPLAY)) {
+        return;
+    }
+    // Respect server error backoff like the regular send path
+    if (serverBackoffActive()) {
+        return;
+    }
+
+    JournalRecord rec;
+    if (!rideJournalPeek(&rec)) {
+        return;
+    }
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: Replaying journal record %u (%u pulses, ID tag %s), %u pending\n",
+                      (unsigned)rec.seq, (unsigned)rec.pulses, rec.idTag, (unsigned)rideJournalPendingCount());
+    }
+    char jsonPayload[UPDATE_DATA_PAYLOAD_LEN];
+    size_t payloadLen = buildUpdateDataPayload(jsonPayload, sizeof(jsonPayload), 0.0, rec.distance_mm,
+                                               (int)rec.pulses, false, rec.idTag);
+    if (payloadLen > 0) {
+        netWorkerSubmit(NET_JOB_JOURNAL_REPLAY, apiUrl(API_EP_UPDATE_DATA), jsonPayload, payloadLen,
+                        rec.seq, 0, rec.idTag);
+    }
+}
+
+/**
+ * @brief Uploads up to uploadBatchSize journaled intervals in one request.
+ * 
+ * A batch is sent once enough intervals are pending, or when the oldest one
+ * has waited uploadBatchSize send intervals (rider stopped, outage is over).
+ * 
+ * @note Side effects: Queues an upload in the network worker (see handleJournalBatchResult())
+ */
+void replayJournalBatch() {
+    const uint32_t pending = rideJournalPendingCount();
+    if (pending == 0 || netWorkerPending(NET_JOB_JOURNAL_BATCH)) {
+        return;
+    }
+    if (serverBackoffActive()) {
+        return;
+    }
+    const unsigned long maxWait_ms = (unsigned long)uploadBatchSize * sendInterval_sec * 1000;
+    if (pending < uploadBatchSize && lastBatchUploadTime > 0 && millis() - lastBatchUploadTime < maxWait_ms) {
+        return;
+    }
+
+    JournalRecord records[UPLOAD_BATCH_MAX];
+    uint32_t count = rideJournalPeekMany(records, min(uploadBatchSize, (unsigned int)UPLOAD_BATCH_MAX));
+    if (count == 0) {
+        return;
+    }
+    lastBatchUploadTime = millis();
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: Uploading batch of %u interval(s), seq %u..%u, %u pending\n",
+                      (unsigned)count, (unsigned)records[0].seq, (unsigned)records[count - 1].seq, (unsigned)pending);
+    }
+    netWorkerSubmit(NET_JOB_JOURNAL_BATCH, apiUrl(API_EP_UPDATE_DATA_BATCH),
+                    buildUpdateDataBatchPayload(records, count), records[count - 1].seq, 0, records[count - 1].idTag);
+}
+
+/**
+ * @brief Evaluates the result of a batch upload.
+ * 
+ * The server acknowledges with {"last_seq": N}; all intervals up to N are
+ * marked as sent, the rest stays in the journal for the next batch.
+ * 
+ * @param responseCode HTTP status code (< 0 on connection error)
+ * @param response Response body (may be empty)
+ * @param lastSeqInBatch Sequence number of the last interval in the batch
+ * @param lastIdTag ID tag of the last interval in the batch
+ * 
+ * @note Side effects: Marks journal records as sent, may disable batch mode or switch to single replays for a rejected batch
+ */
+void handleJournalBatchResult(int responseCode, const String& response, uint32_t lastSeqInBatch, const char* lastIdTag) {
+    // Only the ack is needed here; Velos fields are parsed by applyDisplayVelosFromResponse()
+    StaticJsonDocument<16> filter;
+    filter["last_seq"] = true;
+    StaticJsonDocument<64> responseDoc;
+    bool hasAck = (responseCode > 0 && response.length() > 0 &&
+                   !deserializeJson(responseDoc, response, DeserializationOption::Filter(filter)) &&
+                   responseDoc.containsKey("last_seq"));
+
+    if (responseCode > 0 && responseCode < 300 && hasAck) {
+        uint32_t lastSeq = responseDoc["last_seq"].as<uint32_t>();
+        rideJournalMarkSent(lastSeq);
+        lastServerErrorTime = 0;
+        uploadSchedulerSucceeded(&uploadScheduler);
+        uploadSchedulerSetHint(&uploadScheduler, readBackpressure(response.c_str()).intervalSec);
+        // Velos in the response belong to the rider of the newest interval
+        if (idTag == lastIdTag) {
+            applyDisplayVelosFromResponse(response.c_str());
+        }
+        if (debugEnabled) {
+            logSerial.printf("DEBUG: Batch acknowledged up to seq %u (sent up to %u), %u pending\n",
+                          (unsigned)lastSeq, (unsigned)lastSeqInBatch, (unsigned)rideJournalPendingCount());
+        }
+    } else if (responseCode == 404 || responseCode == 405 || (responseCode > 0 && responseCode < 300)) {
+        // Endpoint missing on this server version (or answered without ack): send intervals one by one
+        batchUploadUnsupported = true;
+        MCC_LOGD("Batch upload not supported by server (HTTP %d), using single uploads.\n", responseCode);
+    } else if (isPermanentUploadError(responseCode)) {
+        // A record of the batch is malformed and the server booked none of them: single
+        // replays find it, it is discarded like a rejected single upload
+        batchIsolateSeq = lastSeqInBatch;
+        MCC_LOGD("Batch rejected by server (HTTP %d), replaying up to seq %u one by one.\n",
+                 responseCode, (unsigned)lastSeqInBatch);
+    } else {
+        noteServerError(readBackpressure(response.c_str()).retryAfterSec);
+        MCC_LOGD("Batch upload failed (HTTP %d), retrying later.\n", responseCode);
+    }
+}
+
+void beginStationBikes() {
+    stationBikeCount = bikeChannelParse(deviceConfig.stationBikes.c_str(), stationBikes);
+    uint8_t started = 0;
+    for (uint8_t i = 0; i < stationBikeCount; i++) {
+        const BikeChannel bike = stationBikes[i];
+        if (bike.pin == SENSOR_PIN || !pulseCounterBeginChannel(started + 1, bike.pin)) {
+            MCC_LOGW("Station bike on GPIO %d not started (pin in use)\n", bike.pin);
+            continue;
+        }
+        stationBikes[started++] = bike;
+        if (debugEnabled) {
+            logSerial.printf("DEBUG: Station bike %u: GPIO %d, wheel %.0f mm, ID tag %s\n",
+                          (unsigned)started, bike.pin, bike.wheelSize_mm, bike.idTag);
+        }
+    }
+    stationBikeCount = started;
+    lastStationSendTime = millis();
+}
+
+void stationBikesLoop() {
+    if (stationBikeCount == 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < stationBikeCount; i++) {
+        const uint32_t count = (uint32_t)pulseCounterReadChannel(i + 1);
+        if (count != stationBikes[i].lastPulseCount) {
+            stationBikes[i].lastPulseCount = count;
+            lastPulseTime = millis();
+        }
+    }
+    if (testActive || millis() - lastStationSendTime < (unsigned long)sendInterval_sec * 1000) {
+        return;
+    }
+    if (netWorkerPending(NET_JOB_STATION_BATCH)) {
+        // Pulses of a slow upload are not confirmed yet, the next batch includes them
+        return;
+    }
+    lastStationSendTime = millis();
+
+    StaticJsonDocument<JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(BIKE_CHANNEL_MAX) +
+                       BIKE_CHANNEL_MAX * JSON_OBJECT_SIZE(3) + 64> doc;
+    doc["device_id"] = deviceIdFull();
+    JsonArray intervals = doc.createNestedArray("intervals");
+    for (uint8_t i = 0; i < stationBikeCount; i++) {
+        BikeChannel& bike = stationBikes[i];
+        const uint32_t pulses = bikeChannelTakeInterval(&bike, bike.lastPulseCount);
+        if (pulses > 0) {
+            JsonObject interval = intervals.createNestedObject();
+            interval["seq"] = i + 1;  // Lets the server acknowledge a partially booked batch
+            interval["id_tag"] = (const char*)bike.idTag;  // Stored by pointer, channels outlive serialization
+            interval["distance"] = (float)pulses * bike.wheelSize_mm / 1000000.0;  // Convert mm to km
+        }
+    }
+    if (intervals.size() == 0) {
+        return;
+    }
+    if (batchUploadUnsupported) {
+        // Server without batch endpoint: the journal sends the intervals one by one
+        journalStationBikes(false);
+        return;
+    }
+    char jsonPayload[NET_JOB_PAYLOAD_LEN];
+    const size_t payloadLen = serializeJson(doc, jsonPayload, sizeof(jsonPayload));
+    if (payloadLen == 0 || payloadLen >= sizeof(jsonPayload) ||
+        !netWorkerSubmit(NET_JOB_STATION_BATCH, apiUrl(API_EP_UPDATE_DATA_BATCH), jsonPayload, payloadLen,
+                         0, 0, nullptr)) {
+        MCC_LOGD("Station batch could not be queued, retrying next interval.");
+    }
+}
+
+void handleStationBatchResult(int responseCode, const char* response) {
+    if (responseCode > 0 && responseCode < 300) {
+        StaticJsonDocument<16> filter;
+        filter["last_seq"] = true;
+        StaticJsonDocument<64> responseDoc;
+        // Servers without ack book all or nothing
+        uint32_t lastSeq = stationBikeCount;
+        if (!deserializeJson(responseDoc, response, DeserializationOption::Filter(filter)) &&
+            responseDoc.containsKey("last_seq")) {
+            lastSeq = responseDoc["last_seq"].as<uint32_t>();
+        }
+        for (uint8_t i = 0; i < stationBikeCount && i + 1u <= lastSeq; i++) {
+            bikeChannelConfirm(&stationBikes[i]);
+        }
+        MCC_LOGD("Station batch uploaded (acknowledged %u of %u bike(s))\n",
+                 (unsigned)min(lastSeq, (uint32_t)stationBikeCount), (unsigned)stationBikeCount);
+        return;
+    }
+    if (responseCode == 404 || responseCode == 405) {
+        batchUploadUnsupported = true;
+    }
+    // Same as a failed single upload: the journal replays the intervals later
+    journalStationBikes(false);
+    MCC_LOGD("Station batch failed (HTTP %d), intervals journaled.\n", responseCode);
+}
+
+void journalStationBikes(bool takeCurrent) {
+    for (uint8_t i = 0; i < stationBikeCount; i++) {
+        BikeChannel& bike = stationBikes[i];
+        if (takeCurrent) {
+            bikeChannelTakeInterval(&bike, (uint32_t)pulseCounterReadChannel(i + 1));
+        }
+        const uint32_t pulses = bike.pulsesInFlight - bike.pulsesAtLastSend;
+        // A full journal keeps the pulses pending for the next batch
+        if (pulses == 0 || rideJournalAppend(bike.idTag, pulses, (float)pulses * bike.wheelSize_mm)) {
+            bikeChannelConfirm(&bike);
+        }
+    }
+}
+
+/**
+ * @brief Evaluates the result of a journal replay upload.
+ * 
+ * @param responseCode HTTP status code (< 0 on connection error)
+ * @param seq Sequence number of the replayed record
+ * 
+ * @note Side effects: Marks the record as sent on success or permanent rejection
+ */
+void handleJournalReplayResult(int responseCode, uint32_t seq) {
+    if (responseCode > 0 && responseCode < 300) {
+        rideJournalMarkSent(seq);
+    } else if (isPermanentUploadError(responseCode)) {
+        rideJournalMarkSent(seq);
+        MCC_LOGD("Journal record %u rejected by server (HTTP %d), discarded.\n", (unsigned)seq, responseCode);
+    } else {
+        noteServerError(0);
+    }
+}
+
+/**
+ * @brief Takes a server session value as base for the local Velos estimate.
+ * 
+ * The anchor remembers which pulses the server value contains (pulsesAtLastSend),
+ * so every later pulse raises the displayed Velos without a round trip. While
+ * intervals wait in the journal or an upload is in flight, a server value of
+ * the same session may lack them; the previous anchor still covers them and
+ * is kept. A new session_epoch always replaces the anchor.
+ */
+void anchorLocalVelos(bool live, int velos, float sessionKm, bool newSession) {
+    if (!live) {
+        velosAnchor.valid = false;
+        return;
+    }
+    if (velosAnchor.valid && !newSession &&
+        (rideJournalPendingCount() > 0 || netWorkerPending(NET_JOB_UPDATE_DATA))) {
+        MCC_LOGD("Server Velos %d not anchored, unconfirmed intervals pending.\n", velos);
+        return;
+    }
+    velosAnchor.valid = true;
+    velosAnchor.sessionKm = sessionKm;
+    velosAnchor.velos = velos;
+    velosAnchor.pulses = pulsesAtLastSend;
+}
+
+void formatDisplayedVelos(char* out, size_t outSize) {
+    if (!hasSessionVelosFromServer) {
+        strlcpy(out, "0", outSize);
+    } else if (velosAnchor.valid) {
+        formatVelosDE(velosEstimate(&velosAnchor, currentPulseCount, wheel_size, paedagogischer_bonus), out, outSize);
+    } else {
+        strlcpy(out, displayedSessionVelosStr, outSize);
+    }
+}
+
+void publishRideState() {
+    RideState state = {};
+    strlcpy(state.idTag, idTag.c_str(), sizeof(state.idTag));
+    if (username.length() > 0 && username != "NULL") {
+        strlcpy(state.username, username.c_str(), sizeof(state.username));
+    }
+    formatDisplayedVelos(state.sessionVelos, sizeof(state.sessionVelos));
+    PulseSnapshot pulseSnapshot;
+    pulseCaptureGetSnapshot(&pulseSnapshot);
+    state.speed_kmh = pulseSnapshot.speed_kmh;
+    state.totalDistance_mm = totalDistance_mm;
+    state.pulses = currentPulseCount;
+    state.distanceSession = distanceSession;
+    rideStatePublish(state);
+}
+
+/**
+ * @brief Evaluates the result of a regular update-data upload.
+ * 
+ * On a connection or server error the interval is moved to the ride journal,
+ * so it is not lost if the device restarts or the rider changes before the
+ * next successful upload.
+ * 
+ * @param responseCode HTTP status code (< 0 on connection error)
+ * @param response Response body (may be empty)
+ * @param pulseSnapshot currentPulseCount at the time the upload was queued
+ * @param session distanceSession at the time the upload was queued
+ * @param sentIdTag ID tag the data was sent for
+ * 
+ * @note Side effects: Updates pulsesAtLastSend and error state, writes the journal, may update OLED display
+ */
+void handleUpdateDataResult(int responseCode, const char* response, uint32_t pulseSnapshot, uint32_t session, const char* sentIdTag) {
+    bool success = (responseCode > 0 && responseCode < 300);
+    if (!success && !isPermanentUploadError(responseCode) && session == distanceSession) {
+        uint32_t pulsesInInterval = pulseSnapshot - pulsesAtLastSend;
+        if (pulsesInInterval > 0 &&
+            rideJournalAppend(sentIdTag, pulsesInInterval, (float)pulsesInInterval * wheel_size)) {
+            // The journal owns these pulses now; the next interval starts after them
+            pulsesAtLastSend = pulseSnapshot;
+            if (debugEnabled) {
+                logSerial.printf("DEBUG: Interval journaled (%u pulses), %u record(s) pending.\n",
+                              (unsigned)pulsesInInterval, (unsigned)rideJournalPendingCount());
+            }
+        }
+    }
+
+    // Counters may have been reset for a new rider while the upload was running
+    if (success && session == distanceSession) {
+        // Before the Velos: the server value contains the pulses up to the snapshot
+        pulsesAtLastSend = pulseSnapshot;
+        // Velos in the response belong to the session the data was sent for
+        applyDisplayVelosFromResponse(response);
+    }
+
+    if (responseCode > 0 && responseCode < 300) { // HTTP status codes 2xx are usually successful
+        if (session == distanceSession) {
+            // Update lastSentIdTag here since data was sent successfully
+            lastSentIdTag = idTag;
+        }
+        // Clear server error backoff on success
+        bool hadServerError = (lastServerErrorTime > 0);
+        lastServerErrorTime = 0;
+        uploadSchedulerSucceeded(&uploadScheduler);
+        if (response[0] != '\0') {
+            // Without a body (MQTT PUBACK) the last suggestion stays
+            uploadSchedulerSetHint(&uploadScheduler, readBackpressure(response).intervalSec);
+        }
+        // Clear API key error flag on successful communication
+        bool wasApiKeyError = apiKeyErrorActive;
+        apiKeyErrorActive = false;
+
+        // Update display if any error was just resolved (API key, WLAN, Wartung, Server)
+        if (wasApiKeyError || hadServerError) {
+            #ifdef ENABLE_OLED
+            // Show normal display (username or default message) - error is resolved
+            // queryWasSuccessful = false because we're just showing the current username, no new query was made
+            if (username.length() > 0 && username != "NULL") {
+                display_IdTag_Name(username.c_str(), idTagFromRFID, false);
+            } else {
+                display_IdTag_Name("NULL", idTagFromRFID, false);
+            }
+            #endif
+        }
+
+        MCC_LOGD("Data sent successfully! Status: %d\n", responseCode);
+    } else if (responseCode == -1) {
+        // WiFi error: pulses are journaled above, or stay unconfirmed and are sent with the next interval.
+        digitalWrite(LED_PIN, LOW);
+        MCC_LOGD("Send failed: No WiFi.");
+    } else {
+        // Other error (e.g. HTTP 4xx/5xx, internal error)
+        // Update backoff timer
+        noteServerError(readBackpressure(response).retryAfterSec);
+        digitalWrite(LED_PIN, LOW);
+
+        // Show error on display
+        String errorType = "Server";
+        bool isApiKeyError = false;
+        if (responseCode == 401 || responseCode == 403) {
+            errorType = "API Key";
+            isApiKeyError = true;
+        } else if (responseCode == 503) {
+            errorType = "Wartung";
+        }
+
+        // Set API key error flag if API key error detected
+        if (isApiKeyError) {
+            apiKeyErrorActive = true;
+        }
+
+        #ifdef ENABLE_OLED
+        display_ServerError(errorType.c_str(), responseCode, 2000);
+        // Ensure LED stays off after error display
+        digitalWrite(LED_PIN, LOW);
+        #endif
+
+        MCC_LOGD("Send failed: Code %d. Waiting for next attempt.\n", responseCode);
+    }
+}
+
+/**
+ * @brief Queues a username lookup for the current idTag in the network worker.
+ * 
+ * Applies the same backoff and configuration checks as getUserIdFromTag().
+ * 
+ * @param fromTagChange true if triggered by a new ID tag (keeps the name screen visible longer)
+ * @return true if the lookup was queued
+ */
+bool requestUserIdLookup(bool fromTagChange) {
+    if (netWorkerPending(NET_JOB_GET_USER_ID) && !fromTagChange) {
+        return false;
+    }
+    // Check backoff interval - don't spam server with requests after errors
+    if (serverBackoffActive()) {
+        MCC_LOGD("requestUserIdLookup: Still in backoff period, skipping request.");
+        return false;
+    }
+    if (serverUrl.length() == 0 || !uplinkConnected()) {
+        MCC_LOGD("requestUserIdLookup: Error: No connection or configuration error.");
+        return false;
+    }
+    MCC_LOGD("Queueing user_id query for ID tag: %s\n", idTag.c_str());
+    return netWorkerSubmit(NET_JOB_GET_USER_ID, apiUrl(API_EP_GET_USER_ID), buildUserIdPayload(idTag),
+                           fromTagChange ? 1 : 0, distanceSession, idTag.c_str());
+}
+
+/**
+ * @brief Uses the cached username for the current idTag after a tag change.
+ * 
+ * A fresh entry is used as is. A stale entry (TTL expired or loaded from NVS
+ * after a restart) is used as well, and a lookup is queued to confirm it;
+ * the worker result then updates username and cache like any other lookup.
+ * 
+ * @return true if the tag was cached and counting can start immediately
+ * 
+ * @note Side effects: Modifies username, updates OLED display
+ */
+bool applyCachedUsername() {
+    char cachedName[TAG_CACHE_NAME_LEN];
+    TagCacheResult cached = tagCacheGet(&tagCache, idTag.c_str(), millis(), cachedName, sizeof(cachedName));
+    if (cached == TAG_CACHE_MISS) {
+        return false;
+    }
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: ID tag %s found in tag cache (%s): %s\n", idTag.c_str(),
+                      cached == TAG_CACHE_FRESH ? "fresh" : "stale", cachedName);
+    }
+    handleUserIdResult(String(cachedName), true);
+    if (cached == TAG_CACHE_STALE && WiFi.status() == WL_CONNECTED && !apiKeyErrorActive) {
+        requestUserIdLookup(false);
+    }
+    return true;
+}
+
+/**
+ * @brief Stores the outcome of a get-user-id lookup in the tag cache.
+ * 
+ * Valid usernames are kept for the cache_ttl seconds sent by the server
+ * (TAG_CACHE_DEFAULT_TTL_SEC if missing), "NULL" removes the tag. Failed
+ * queries and operator tags (empty return value) leave the cache alone.
+ * NVS is only written when a tag or username changes, not on every refresh.
+ * 
+ * @param tagId ID tag the lookup was made for
+ * @param newUsername Return value of applyUserIdResponse()
+ * @param response Response body, read for cache_ttl
+ * 
+ * @note Side effects: May write the tag cache to NVS
+ */
+void cacheUserIdResult(const String& tagId, const String& newUsername, const String& response) {
+    bool changed = false;
+    if (newUsername == "NULL") {
+        changed = tagCacheRemove(&tagCache, tagId.c_str());
+    } else if (newUsername.length() > 0 && newUsername != "FEHLER" && newUsername != "OPERATOR") {
+        StaticJsonDocument<32> filter;
+        filter["cache_ttl"] = true;
+        StaticJsonDocument<64> ttlDoc;
+        unsigned long ttl_sec = TAG_CACHE_DEFAULT_TTL_SEC;
+        if (!deserializeJson(ttlDoc, response, DeserializationOption::Filter(filter))) {
+            ttl_sec = apiWireUserId(ttlDoc.as<JsonVariantConst>(), TAG_CACHE_DEFAULT_TTL_SEC).cacheTtlSec;
+        }
+        if (ttl_sec == 0) {
+            // Server asked not to cache this tag
+            changed = tagCacheRemove(&tagCache, tagId.c_str());
+        } else {
+            ttl_sec = min(ttl_sec, 7UL * 24 * 3600);  // Keeps ttl in ms within 32 bit
+            changed = tagCachePut(&tagCache, tagId.c_str(), newUsername.c_str(), ttl_sec * 1000UL, millis());
+        }
+    }
+    if (changed) {
+        saveTagCache();
+    }
+}
+
+/**
+ * @brief Loads the tag cache from NVS; all entries start stale.
+ * 
+ * @note Side effects: Reads NVS (preferences must be open)
+ */
+void loadTagCache() {
+    tagCacheReset(&tagCache);
+    #ifndef DISABLE_TAG_CACHE_NVS
+    if (preferences.getBytesLength("tag_cache") == sizeof(tagCache) &&
+        preferences.getBytes("tag_cache", &tagCache, sizeof(tagCache)) == sizeof(tagCache) &&
+        tagCacheRestore(&tagCache)) {
+        MCC_LOGD("Tag cache loaded from NVS.");
+    } else {
+        tagCacheReset(&tagCache);
+    }
+    #endif
+}
+
+/**
+ * @brief Writes the tag cache to NVS.
+ * 
+ * @note Side effects: One NVS blob write (preferences must be open)
+ */
+void saveTagCache() {
+    #ifndef DISABLE_TAG_CACHE_NVS
+    if (preferences.putBytes("tag_cache", &tagCache, sizeof(tagCache)) != sizeof(tagCache) && debugEnabled) {
+        logSerial.println("DEBUG: Tag cache could not be written to NVS.");
+    }
+    #endif
+}
+
+/**
+ * @brief Applies the username returned by a lookup to the global state and OLED.
+ * 
+ * @param newUsername Return value of applyUserIdResponse()
+ * @param fromTagChange true if the lookup was triggered by a new ID tag
+ */
+void handleUserIdResult(const String& newUsername, bool fromTagChange) {
+    // applyUserIdResponse() returns:
+    // - Valid username string if found
+    // - "NULL" if user not found (HTTP 404 or server returned "NULL")
+    // - "" (empty) if query failed (backoff period, connection error, etc.)
+    if (newUsername.length() == 0) {
+        // Query failed - don't update username, keep previous value
+        return;
+    }
+    // Query was successful - update username (could be valid name or "NULL")
+    bool wasUsernameNull = (username.length() == 0 || username == "NULL");
+    bool isUsernameNull = (newUsername == "NULL");
+    bool usernameChanged = (wasUsernameNull != isUsernameNull) || (username != newUsername);
+
+    if (usernameChanged) {
+        username = newUsername;
+
+        #ifdef ENABLE_OLED
+        // queryWasSuccessful = true because newUsername.length() > 0 means query was successful
+        // Note: If HTTP 404, username was already set to "NULL" in applyUserIdResponse() and error was already shown
+        if (username.length() > 0 && username != "NULL") {
+            // Keep the name visible longer after a tag change before the data screen returns
+            display_IdTag_Name(username.c_str(), idTagFromRFID, true, fromTagChange ? 3000 : 0);
+        } else {
+            // HTTP 404 - error message was already shown, don't overwrite it
+            // Just keep the "Radler nicht gefunden" message that was already displayed
+        }
+        #endif
+    }
+}
+
+/**
+ * @brief Turns off the display and enters deep sleep after the goodbye screen.
+ * 
+ * If the sensor pin went LOW in the meantime, sleep is postponed instead,
+ * because the ext0 wakeup would fire immediately.
+ * 
+ * @param hasValidUsername true if unsent pulses of the current session may be carried
+ * 
+ * @note Hardware interaction: OLED display, VEXT_PIN, SENSOR_PIN (wakeup source)
+ * @note Side effects: Saves unsent pulses to RTC memory, does not return when sleeping
+ */
+void enterDeepSleep(bool hasValidUsername) {
+    sleepNoticeStart = 0;
+    if (digitalRead(SENSOR_PIN) != HIGH) {
+        MCC_LOGD("Pin went LOW during goodbye screen. Deep sleep postponed.");
+        lastPulseTime = millis();
+        #ifdef ENABLE_OLED
+        uiClearScreens();
+        oledVelosNeedsRefresh = true;
+        #endif
+        return;
+    }
+
+    #ifdef ENABLE_OLED
+    MCC_LOGD("Turning off OLED display.");
+
+    // 1. Put U8g2 display controller into sleep mode
+    display.clearDisplay();
+    display.sendBuffer(); 
+    display.sleepOn();     // SSD1306 into sleep mode (Display Off)
+    #endif
+
+    // --- Heltec VEXT control: Turn off power supply (if defined) ---
+    #ifdef BOARD_HELTEC
+    MCC_LOGD("Turning off VEXT (OLED power).");
+    // Set VEXT_PIN to HIGH to completely turn off display (HIGH = OFF)
+    digitalWrite(VEXT_PIN, HIGH);
+    #endif
+
+    // Keep pulses that were not uploaded yet, they are sent after wakeup
+    uint32_t unsentPulses = 0;
+    if (hasValidUsername && !testActive) {
+        unsentPulses = (uint32_t)pulseCounterRead() - pulsesAtLastSend;
+    }
+    pulseCounterSaveForSleep(unsentPulses, idTag.c_str());
+    if (debugEnabled && unsentPulses > 0) {
+        logSerial.printf("DEBUG: Keeping %u unsent pulses for ID tag %s in RTC memory.\n", (unsigned)unsentPulses, idTag.c_str());
+    }
+    // Station bikes have no RTC carry; the journal survives the sleep
+    journalStationBikes(true);
+
+    // The rider keeps the session if the same ID tag is active after wakeup
+    fastResumeSaveSession(hasValidUsername ? idTag.c_str() : "", username.c_str(), sessionEpoch.c_str(),
+                          displayedSessionVelosStr);
+
+    // Close the keep-alive connection cleanly instead of letting the server time it out;
+    // the broker keeps the MQTT session and queues pushes until the wakeup
+    httpSessionClose();
+    mqttLinkStop();
+
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)SENSOR_PIN, LOW);
+    mccLogFlush();
+    esp_deep_sleep_start();
+}
+
+/**
+ * @brief Light sleep until shortly before the next upload while the ULP counts pulses.
+ * 
+ * The PCNT unit does not count in light sleep, so the sensor pin is handed
+ * to the ULP program for the duration of the sleep. Its pulses and the last
+ * pulse interval are added to the pulse counter and the speed measurement
+ * afterwards, so the next upload contains the whole interval.
+ * 
+ * @param sleepMs Sleep duration in milliseconds
+ * 
+ * @note Hardware interaction: ULP coprocessor, SENSOR_PIN (RTC IO during sleep), WiFi radio, RFID_IRQ_PIN
+ * @note Side effects: Adds the ULP pulses to the pulse counter, blocks for sleepMs
+ */
+void lowPowerRideSleep(uint32_t sleepMs) {
+    if (!ulpPulseCounterStart(SENSOR_PIN)) {
+        lowPowerRideUnsupported = true;
+        MCC_LOGW("Low-power riding not available (no ULP counting on this board or pin). Staying awake.");
+        return;
+    }
+    MCC_LOGD("Riding sleep for %u ms, ULP counts pulses.\n", (unsigned)sleepMs);
+    // Light sleep stops the UART and the log task
+    mccLogFlush();
+
+    // Modem off until the next upload
+    httpSessionClose();
+    mqttLinkStop();
+    wifiManagerStop();
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    digitalWrite(LED_PIN, LOW);
+
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);  // ULP and RTC IO keep running
+    esp_sleep_enable_timer_wakeup((uint64_t)sleepMs * 1000ULL);
+    #if defined(ENABLE_RFID) && defined(RFID_IRQ_PIN)
+    // The reader only answers a card that is in the field when it is armed;
+    // later taps are picked up after the timer wakeup
+    RFID_MFRC522_clearInt();
+    RFID_MFRC522_activateRec();
+    gpio_wakeup_enable((gpio_num_t)RFID_IRQ_PIN, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    #endif
+
+    esp_light_sleep_start();
+
+    #if defined(ENABLE_RFID) && defined(RFID_IRQ_PIN)
+    gpio_wakeup_disable((gpio_num_t)RFID_IRQ_PIN);
+    gpio_set_intr_type((gpio_num_t)RFID_IRQ_PIN, GPIO_INTR_NEGEDGE);
+    #endif
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+
+    UlpPulseResult ulpResult;
+    ulpPulseCounterStop(&ulpResult);
+    if (ulpResult.pulses > 0) {
+        pulseCounterAdd(ulpResult.pulses);
+        pulseCaptureInject(ulpResult.pulses, ulpResult.lastIntervalUs, ulpResult.sinceLastPulseUs);
+    }
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: Riding sleep ended (%s), ULP counted %u pulses, last interval %u ms.\n",
+                      esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO ? "RFID" : "timer",
+                      (unsigned)ulpResult.pulses, (unsigned)(ulpResult.lastIntervalUs / 1000));
+    }
+
+    // Reconnect like after a deep sleep wakeup, without repeating heartbeat and config report
+    WiFi.mode(WIFI_STA);
+    fastWake = true;
+    connectToWiFi();
+    deferredServerCallsStart = 0;
+}
+
+void bootMark(const char* stage) {
+    bootProfileMark(&bootProfile, stage, (uint32_t)esp_timer_get_time());
+}
+
+void printBootTimeline() {
+    MCC_LOGI("Boot timeline (ms since application start):");
+    for (uint8_t i = 0; i < bootProfile.count; i++) {
+        MCC_LOGI("  %-12s %9.1f  (+%.1f)", bootProfile.names[i], bootProfile.us[i] / 1000.0f,
+                 bootProfileStageUs(&bootProfile, i) / 1000.0f);
+    }
+    const int slowest = bootProfileSlowest(&bootProfile);
+    if (slowest >= 0) {
+        MCC_LOGI("Slowest boot stage: %s (%.1f ms)\n", bootProfile.names[slowest],
+                 bootProfileStageUs(&bootProfile, slowest) / 1000.0f);
+    }
+}
+
+/**
+ * @brief Takes all finished network worker results and applies them.
+ * 
+ * Runs in loop(), so all state changes and display updates stay on the main task.
+ * 
+ * @note Side effects: Modifies globals, NVS (config fetch) and OLED display
+ */
+void processNetResults() {
+    NetResult result;
+    while (netWorkerPollResult(&result)) {
+        const char* response = result.body != nullptr ? result.body : "";
+        switch (result.type) {
+            case NET_JOB_UPDATE_DATA:
+                if (debugEnabled) {
+                    logSerial.printf("HTTP Code: %d\n", result.httpCode);
+                    logSerial.println("Server Response:");
+                    logSerial.println(response);
+                }
+                handleUpdateDataResult(result.httpCode, response, result.context, result.session, result.tag);
+                break;
+            case NET_JOB_CARRY_UPLOAD:
+                handleCarryUploadResult(result.httpCode);
+                break;
+            case NET_JOB_JOURNAL_REPLAY:
+                handleJournalReplayResult(result.httpCode, result.context);
+                break;
+            case NET_JOB_JOURNAL_BATCH:
+                handleJournalBatchResult(result.httpCode, response, result.context, result.tag);
+                break;
+            case NET_JOB_GET_USER_ID:
+                // A newer tag was presented while the lookup was running
+                if (idTag != result.tag || result.session != distanceSession) {
+                    MCC_LOGD("Ignoring stale user_id result for ID tag %s\n", result.tag);
+                    break;
+                }
+                userIdLookupBlocking = false;
+                {
+                    String newUsername = applyUserIdResponse(result.httpCode, response);
+                    cacheUserIdResult(idTag, newUsername, response);
+                    handleUserIdResult(newUsername, result.context != 0);
+                }
+                break;
+            case NET_JOB_CONFIG_FETCH:
+                if (applyDeviceConfigResponse(result.httpCode, response)) {
+                    lastConfigFetchTime = millis();
+                    MCC_LOGD("Config fetched successfully. Next fetch in %u seconds\n", configFetchInterval_sec);
+                } else if (debugEnabled) {
+                    // Don't update lastConfigFetchTime on failure, so it retries sooner
+                    logSerial.println("DEBUG: Config fetch failed, will retry on next interval");
+                }
+                break;
+            case NET_JOB_STATION_BATCH:
+                handleStationBatchResult(result.httpCode, response);
+                break;
+            case NET_JOB_GATEWAY_FORWARD:
+                gatewayHandleForwardResult(result);
+                break;
+            default:
+                break;
+        }
+        netWorkerFreeResult(&result);
+    }
+}
+
+void processMqttMessages() {
+    MqttMessage message;
+    while (mqttLinkPoll(&message)) {
+        MCC_LOGD("[mqtt] Downlink %d: %s\n", (int)message.type, message.payload);
+        switch (message.type) {
+            case MQTT_DOWN_UPDATE: {
+                // The upload itself was confirmed by the PUBACK; this is the server's answer
+                StaticJsonDocument<128> filter;
+                filter["status"] = true;
+                filter["id_tag"] = true;
+                StaticJsonDocument<128> statusDoc;
+                if (deserializeJson(statusDoc, message.payload, DeserializationOption::Filter(filter))) {
+                    break;
+                }
+                const int status = statusDoc["status"] | 0;
+                const char* sentIdTag = statusDoc["id_tag"] | "";
+                if (status >= 200 && status < 300) {
+                    // Velos of an earlier rider must not be shown for the current one
+                    if (idTag == sentIdTag) {
+                        applyDisplayVelosFromResponse(message.payload);
+                    }
+                } else if (status > 0) {
+                    noteServerError(0);
+                    if (status == 401 || status == 403) {
+                        apiKeyErrorActive = true;
+                    }
+                    #ifdef ENABLE_OLED
+                    display_ServerError(status == 401 || status == 403 ? "API Key" : "Server", status, 2000);
+                    #endif
+                    MCC_LOGD("[mqtt] Upload rejected by the server: %d\n", status);
+                }
+                break;
+            }
+            case MQTT_DOWN_CONFIG:
+                if (applyDeviceConfigResponse(HTTP_CODE_OK, message.payload)) {
+                    lastConfigFetchTime = millis();
+                    // A rotated API key is the broker password from the next connect on
+                    mqttLinkBegin(mqttUrl, deviceIdFull(), apiKey);
+                }
+                break;
+            case MQTT_DOWN_DISPLAY:
+                applyDisplayVelosFromResponse(message.payload);
+                break;
+            case MQTT_DOWN_RESET: {
+                StaticJsonDocument<384> resetDoc;
+                if (deserializeJson(resetDoc, message.payload) || !applyOperatorResetFromResponse(resetDoc)) {
+                    break;
+                }
+                #ifdef ENABLE_OLED
+                display_OperatorReset(true, username.c_str(), idTag.c_str(), 3000);
+                #endif
+                break;
+            }
+            default:
+                break;
+        }
+        mqttLinkFreeMessage(&message);
+    }
+}
+
+// --- Buzzer control functions ---
+/**
+ * @brief Generates a tone on the buzzer for a specified duration.
+ * 
+ * Controls the active buzzer by setting BUZZER_PIN HIGH for the duration, then LOW.
+ * 
+ * @param duration_ms Duration of the tone in milliseconds
+ * 
+ * @note Hardware interaction: BUZZER_PIN (GPIO output)
+ * @note Side effects: Blocks execution for duration_ms milliseconds
+ */
+void buzzer_tone(int duration_ms) {
+    // For active buzzer, HIGH = ON, LOW = OFF
+    digitalWrite(BUZZER_PIN, HIGH);
+    delay(duration_ms);
+    digitalWrite(BUZZER_PIN, LOW);
+}
+
+/**
+ * @brief Plays startup tone sequence (3 short beeps).
+ * 
+ * Indicates device restart after power-on. Plays 3 beeps of 100ms each with 100ms pauses.
+ * 
+ * @note Hardware interaction: BUZZER_PIN
+ * @note Side effects: Blocks execution for ~500ms
+ */
+void play_startup_tone() {
+    // 3 x short beep = restart after power on
+    buzzer_tone(100); delay(100);
+    buzzer_tone(100); delay(100);
+    buzzer_tone(100);
+}
+
+/**
+ * @brief Plays wakeup tone sequence (2 short beeps).
+ * 
+ * Indicates wakeup from deep sleep. Plays 2 beeps of 150ms each with 150ms pause.
+ * 
+ * @note Hardware interaction: BUZZER_PIN
+ * @note Side effects: Blocks execution for ~450ms
+ */
+void play_wakeup_tone() {
+    // 2 x short beep = wakeup from deep sleep
+    buzzer_tone(150); delay(150);
+    buzzer_tone(150);
+}
+
+/**
+ * @brief Plays tag detected tone (1 long beep).
+ * 
+ * Indicates successful RFID tag detection. Plays 1 beep of 500ms.
+ * 
+ * @note Hardware interaction: BUZZER_PIN
+ * @note Side effects: Blocks execution for 500ms
+ */
+void play_tag_detected_tone() {
+    // 1 x long = ID tag detected
+    buzzer_tone(500);
+}
+
+#ifdef ENABLE_OLED
+/**
+ * @brief Shows the WiFi status screen (project name, device name, status, SSID).
+ * 
+ * @param status Third line, e.g. "Verbinde mit WLAN:"
+ * @param holdMs Time the screen stays visible before the next screen or the data screen
+ * 
+ * @note Hardware interaction: OLED display (via the UI scheduler)
+ * @note Only compiled if ENABLE_OLED is defined
+ */
+void display_WifiStatus(const char* status, uint16_t holdMs) {
+    UiScreen screen;
+    uiScreenInit(&screen, holdMs);
+    uiScreenAddLine(&screen, 12, "MyCyclingCity");
+    uiScreenAddLine(&screen, 28, deviceName.c_str());
+    uiScreenAddLine(&screen, 44, status);
+    uiScreenAddLine(&screen, 60, wifi_ssid.c_str());
+    uiShowScreen(screen);
+}
+
+/**
+ * @brief Displays server communication error on OLED display.
+ * 
+ * Shows detailed error message when server communication fails (API key, server unreachable, maintenance, etc.)
+ * Displays user-friendly error descriptions without technical error codes.
+ * 
+ * @param errorType Error type string (e.g., "API Key", "Server", "Wartung", "Kein WLAN")
+ * @param errorCode HTTP error code or 0 for connection error (not displayed, used only for internal logic)
+ * @param holdMs Time the error stays visible before the next screen or the data screen
+ * 
+ * @note Hardware interaction: OLED display (via the UI scheduler)
+ * @note Side effects: Queues the error screen, turns off LED
+ * @note Only compiled if ENABLE_OLED is defined
+ */
+void display_ServerError(const char* errorType, int errorCode, uint16_t holdMs) {
     // Turn off LED on error
     digitalWrite(LED_PIN, LOW);
     
-    display.clearBuffer();
-    display.setFont(u8g2_font_7x14_tf);
-    
-    // First line: "Fehler:"
-    textline = "Fehler:";
-    textWidth = display.getStrWidth(textline);
-    display.setCursor((128 - textWidth) / 2, 12);
-    display.print(textline);
-    
     // Second and third lines: Detailed error description based on error type
-    String errorDescription = "";
-    String errorDescription2 = "";
+    const char* errorDescription = errorType;
+    const char* errorDescription2 = "";
     
     if (strcmp(errorType, "API Key") == 0) {
         errorDescription = "API-Key";
@@ -2616,27 +3973,17 @@ void display_ServerError(const char* errorType, int errorCode) {
     } else if (strcmp(errorType, "Kein WLAN") == 0) {
         errorDescription = "Keine";
         errorDescription2 = "WLAN-Verbindung";
-    } else {
-        // Fallback for unknown error types
-        errorDescription = errorType;
-        errorDescription2 = "";
     }
+    // Fallback for unknown error types: error type as the only description line
     
-    // Display first line of error description
-    textline = errorDescription.c_str();
-    textWidth = display.getStrWidth(textline);
-    display.setCursor((128 - textWidth) / 2, 28);
-    display.print(textline);
-    
-    // Display second line of error description (if available)
-    if (errorDescription2.length() > 0) {
-        textline = errorDescription2.c_str();
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 44);
-        display.print(textline);
+    UiScreen screen;
+    uiScreenInit(&screen, holdMs);
+    uiScreenAddLine(&screen, 12, "Fehler:");
+    uiScreenAddLine(&screen, 28, errorDescription);
+    if (errorDescription2[0] != '\0') {
+        uiScreenAddLine(&screen, 44, errorDescription2);
     }
-    
-    display.sendBuffer();
+    uiShowScreen(screen);
 }
 
 #ifdef ENABLE_OLED
@@ -2714,10 +4061,11 @@ void display_ConfigCheck() {
  * @param didReset True when the server reset the device to its default cyclist.
  * @param defaultUserName Kurzname of the default cyclist, or "NULL".
  * @param defaultTag Default RFID tag configured for the device.
+ * @param holdMs Time the message stays visible before the next screen or the data screen.
  */
-void display_OperatorReset(bool didReset, const char* defaultUserName, const char* defaultTag) {
+void display_OperatorReset(bool didReset, const char* defaultUserName, const char* defaultTag, uint16_t holdMs) {
     if (debugEnabled) {
-        Serial.printf(
+        logSerial.printf(
             "OLED: Operator reset display (didReset=%s, user=%s, tag=%s)\n",
             didReset ? "yes" : "no",
             defaultUserName != nullptr ? defaultUserName : "",
@@ -2725,19 +4073,12 @@ void display_OperatorReset(bool didReset, const char* defaultUserName, const cha
         );
     }
 
-    display.clearBuffer();
-    display.setFont(u8g2_font_7x14_tf);
+    UiScreen screen;
+    uiScreenInit(&screen, holdMs);
 
     if (didReset) {
-        textline = "Operator-Reset";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 12);
-        display.print(textline);
-
-        textline = "Standard-Radler:";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 28);
-        display.print(textline);
+        uiScreenAddLine(&screen, 12, "Operator-Reset");
+        uiScreenAddLine(&screen, 28, "Standard-Radler:");
 
         const char* showName = defaultUserName;
         if (
@@ -2748,27 +4089,14 @@ void display_OperatorReset(bool didReset, const char* defaultUserName, const cha
         ) {
             showName = (defaultTag != nullptr && strlen(defaultTag) > 0) ? defaultTag : "—";
         }
-        textWidth = display.getStrWidth(showName);
-        display.setCursor((128 - textWidth) / 2, 50);
-        display.print(showName);
+        uiScreenAddLine(&screen, 50, showName);
     } else {
-        textline = "Operator-Tag";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 12);
-        display.print(textline);
-
-        textline = "Kein Reset";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 28);
-        display.print(textline);
-
-        textline = "erforderlich";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 44);
-        display.print(textline);
+        uiScreenAddLine(&screen, 12, "Operator-Tag");
+        uiScreenAddLine(&screen, 28, "Kein Reset");
+        uiScreenAddLine(&screen, 44, "erforderlich");
     }
 
-    display.sendBuffer();
+    uiShowScreen(screen);
 }
 
 /**
@@ -2779,17 +4107,18 @@ void display_OperatorReset(bool didReset, const char* defaultUserName, const cha
  * 
  * @param id_name Username string to display (or "NULL" if not found)
  * @param isRfidDetected True if the current idTag came from RFID detection, false if it's the default user
+ * @param holdMs Time the name stays visible before the next screen or the data screen
  * 
- * @note Hardware interaction: OLED display (I2C communication)
- * @note Side effects: Updates OLED display buffer and sends to display
+ * @note Hardware interaction: OLED display (via the UI scheduler)
+ * @note Side effects: Queues the name screen
  * @note Only compiled if ENABLE_OLED is defined
  */
-void display_IdTag_Name(const char* id_name, bool isRfidDetected, bool queryWasSuccessful) {
+void display_IdTag_Name(const char* id_name, bool isRfidDetected, bool queryWasSuccessful, uint16_t holdMs) {
 
-        if (debugEnabled) Serial.printf("OLED: Show idTagName: '%s' (RFID detected: %s, query successful: %s)\n", id_name, isRfidDetected ? "yes" : "no", queryWasSuccessful ? "yes" : "no");
+        MCC_LOGD("OLED: Show idTagName: '%s' (RFID detected: %s, query successful: %s)\n", id_name, isRfidDetected ? "yes" : "no", queryWasSuccessful ? "yes" : "no");
         
-        display.clearBuffer();
-        display.setFont(u8g2_font_7x14_tf);
+        UiScreen screen;
+        uiScreenInit(&screen, holdMs);
 
         // Check if name is NULL or empty (no assignment found on server)
         bool nameNotFound = (strcmp(id_name, "NULL") == 0 || strlen(id_name) == 0);
@@ -2800,118 +4129,60 @@ void display_IdTag_Name(const char* id_name, bool isRfidDetected, bool queryWasS
         // 3. WiFi is connected (so we could actually query the server)
         // 4. No API key error is active (so the query could succeed)
         // This prevents showing the error when WiFi is not connected, API key is wrong, or query was not attempted
-        bool canShowNameError = nameNotFound && queryWasSuccessful && (WiFi.status() == WL_CONNECTED) && !apiKeyErrorActive;
+        bool canShowNameError = nameNotFound && queryWasSuccessful && uplinkConnected() && !apiKeyErrorActive;
 
         if (canShowNameError) {
             // Show "Radler nicht gefunden" error message (this is what the server returns for HTTP 404)
             // This is more specific than "Kein Kurzname zugewiesen" and matches the server response
-            textline = "Fehler:";
-            textWidth = display.getStrWidth(textline);
-            display.setCursor((128 - textWidth) / 2, 12);
-            display.print(textline);
-
-            textline = "Radler nicht";
-            textWidth = display.getStrWidth(textline);
-            display.setCursor((128 - textWidth) / 2, 28);
-            display.print(textline);
-
-            textline = "gefunden";
-            textWidth = display.getStrWidth(textline);
-            display.setCursor((128 - textWidth) / 2, 44);
-            display.print(textline);
-
+            uiScreenAddLine(&screen, 12, "Fehler:");
+            uiScreenAddLine(&screen, 28, "Radler nicht");
+            uiScreenAddLine(&screen, 44, "gefunden");
             // Show default tag ID so user knows which tag to report to admin (without "Tag:" prefix)
-            textline = idTag.c_str();
-            textWidth = display.getStrWidth(textline);
-            display.setCursor((128 - textWidth) / 2, 60);
-            display.print(textline);
-        } else if (nameNotFound) {
-            // Name is NULL but we can't show error (WiFi not connected or API key error)
-            // Just show the default user info without error message
-            if (isRfidDetected) {
-        textline = "Id Tag erkannt!";
-        textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 12);
-        display.print(textline);
-
-        textline = "Nun strampelt:";
-        textWidth = display.getStrWidth(textline);
-                display.setCursor((128 - textWidth) / 2, 28);
-                display.print(textline);
-                
-                textline = idTag.c_str();
-                textWidth = display.getStrWidth(textline);
-                display.setCursor((128 - textWidth) / 2, 50);
-                display.print(textline);
-            } else {
-                // Default user - just show the tag ID
-                textline = "Benutzer:";
-                textWidth = display.getStrWidth(textline);
-                display.setCursor((128 - textWidth) / 2, 28);
-                display.print(textline);
-                
-                textline = idTag.c_str();
-                textWidth = display.getStrWidth(textline);
-                display.setCursor((128 - textWidth) / 2, 50);
-                display.print(textline);
-            }
+            uiScreenAddLine(&screen, 60, idTag.c_str());
         } else {
+            // Name is NULL but we can't show error (WiFi not connected or API key error):
+            // show the tag ID instead of the name
+            const char* shownName = nameNotFound ? idTag.c_str() : id_name;
             // Only show "ID Tag erkannt!" if RFID tag was actually detected
             if (isRfidDetected) {
-                textline = "Id Tag erkannt!";
-                textWidth = display.getStrWidth(textline);
-                display.setCursor((128 - textWidth) / 2, 12);
-                display.print(textline);
-
-                textline = "Nun strampelt:";
-                textWidth = display.getStrWidth(textline);
-        display.setCursor((128 - textWidth) / 2, 28);
-        display.print(textline);
-
-        textWidth = display.getStrWidth(id_name);
-        display.setCursor((128 - textWidth) / 2, 50);
-        display.print(id_name);
+                uiScreenAddLine(&screen, 12, "Id Tag erkannt!");
+                uiScreenAddLine(&screen, 28, "Nun strampelt:");
             } else {
                 // Default user - just show the name without "ID Tag erkannt!"
-                textline = "Benutzer:";
-                textWidth = display.getStrWidth(textline);
-                display.setCursor((128 - textWidth) / 2, 28);
-                display.print(textline);
-
-                textWidth = display.getStrWidth(id_name);
-                display.setCursor((128 - textWidth) / 2, 50);
-                display.print(id_name);
+                uiScreenAddLine(&screen, 28, "Benutzer:");
             }
+            uiScreenAddLine(&screen, 50, shownName);
         }
         
-        display.sendBuffer();
+        uiShowScreen(screen);
 }
 
 /**
  * @brief Displays current cycling data on OLED display.
  * 
  * Shows username, current speed, and server-provided session Velos.
+ * Skipped while a timed screen is held; only the tile rows that changed
+ * since the last data screen (usually speed and Velos) are sent.
  * 
  * @note Hardware interaction: OLED display (I2C communication)
- * @note Side effects: Updates OLED display buffer and sends to display
+ * @note Side effects: Updates OLED display buffer and sends changed rows to display
  * @note Only compiled if ENABLE_OLED is defined
  */
 void display_Data() {
 
-        if (debugEnabled) Serial.printf("OLED: Show cycling data.\n");
-        
-        // Check for speed timeout - if no pulse for 5 seconds, set speed to 0 and reset history
-        unsigned long currentTime = millis();
-        if (lastPulseTime > 0 && (currentTime - lastPulseTime) >= SPEED_TIMEOUT_MS) {
-            currentSpeed_kmh = 0.0;
-            // Reset speed history to avoid old values in average
-            speedHistoryIndex = 0;
-            speedHistoryCount = 0;
-            for (int i = 0; i < SPEED_AVERAGE_COUNT; i++) {
-                speedHistory[i] = 0.0;
-            }
+        if (uiScreenBusy()) {
+            // Redrawn by loop() when the timed screen expires
+            return;
         }
+        MCC_LOGD("OLED: Show cycling data.\n");
+        
+        // Speed timeout (no pulse for SPEED_TIMEOUT_MS → 0 km/h) is applied by the capture task
+        publishRideState();
+        RideState ride;
+        rideStateGet(&ride);
+        currentSpeed_kmh = ride.speed_kmh;
         
+        bool panelMatches = uiFrameBegin();
         display.clearBuffer();
         display.setFont(u8g2_font_7x14_tf);
 
@@ -2923,11 +4194,11 @@ void display_Data() {
         display.print(textline);
 
         // Only display username if it's valid (not "NULL" or empty)
-        if (username.length() > 0 && username != "NULL") {
-        textWidth = display.getStrWidth(username.c_str());
+        if (ride.username[0] != '\0') {
+        textWidth = display.getStrWidth(ride.username);
         // X-Koordinate: (Gesamtbreite - Textbreite) / 2
         display.setCursor((128 - textWidth) / 2, 28);
-        display.print(username.c_str());
+        display.print(ride.username);
         } else {
             // Show default user tag ID instead
             textline = "Benutzer:";
@@ -2935,7 +4206,7 @@ void display_Data() {
             display.setCursor((128 - textWidth) / 2, 28);
             display.print(textline);
             
-            textline = idTag.c_str();
+            textline = ride.idTag;
             textWidth = display.getStrWidth(textline);
             display.setCursor((128 - textWidth) / 2, 44);
             display.print(textline);
@@ -2943,11 +4214,12 @@ void display_Data() {
 
         // Display speed instead of pulse count
         display.drawStr(0, 44,  "Geschw.:");  // 
-        String speedStr = String(currentSpeed_kmh, 1) + " km/h";
-        display.drawStr(70, 44, speedStr.c_str());  // 
+        char speedStr[16];
+        snprintf(speedStr, sizeof(speedStr), "%.1f km/h", ride.speed_kmh);
+        display.drawStr(70, 44, speedStr);  // 
         display.drawStr(0, 60,  "Velos:");  //
-        display.drawStr(70, 60, hasSessionVelosFromServer ? displayedSessionVelosStr : "0");
-        display.sendBuffer();     
+        display.drawStr(70, 60, ride.sessionVelos);
+        uiFrameSend(panelMatches);
 
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,193 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    mcc_log.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "mcc_log.h"
+#include <stdarg.h>
+
+// Same as loop(): a lower priority would starve the log while loop() is busy
+static const UBaseType_t MCC_LOG_TASK_PRIORITY = 1;
+static const uint32_t MCC_LOG_TASK_STACK = 2048;
+static const size_t MCC_LOG_CHUNK = 128;   // Bytes copied out per lock
+
+static char logRing[MCC_LOG_BUFFER_SIZE];
+// Positions count all bytes ever written; byte p lives at logRing[p % MCC_LOG_BUFFER_SIZE]
+static uint32_t logHead = 0;       // Guarded by logMux
+static volatile uint32_t logDrained = 0;   // Written by the log task only
+static volatile uint32_t logLost = 0;
+static portMUX_TYPE logMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t logTaskHandle = nullptr;
+
+static const char* const LEVEL_PREFIX[] = {"", "ERROR: ", "WARNING: ", "", "DEBUG: "};
+
+LogSerial logSerial;
+
+/**
+ * @brief Copies up to len bytes from position pos; returns how many were still in the ring.
+ *
+ * @param pos In: wanted position; out: moved past overwritten bytes
+ */
+static size_t copyFromRing(uint32_t* pos, char* out, size_t len, uint32_t* head) {
+    taskENTER_CRITICAL(&logMux);
+    *head = logHead;
+    if (*head - *pos > MCC_LOG_BUFFER_SIZE) {
+        *pos = *head - MCC_LOG_BUFFER_SIZE;
+    }
+    size_t n = *head - *pos;
+    if (n > len) {
+        n = len;
+    }
+    for (size_t i = 0; i < n; i++) {
+        out[i] = logRing[(*pos + i) % MCC_LOG_BUFFER_SIZE];
+    }
+    taskEXIT_CRITICAL(&logMux);
+    return n;
+}
+
+static void appendToRing(const char* data, size_t len) {
+    if (len > MCC_LOG_BUFFER_SIZE) {
+        // Only the tail would survive anyway
+        data += len - MCC_LOG_BUFFER_SIZE;
+        len = MCC_LOG_BUFFER_SIZE;
+    }
+    taskENTER_CRITICAL(&logMux);
+    for (size_t i = 0; i < len; i++) {
+        logRing[(logHead + i) % MCC_LOG_BUFFER_SIZE] = data[i];
+    }
+    logHead += len;
+    taskEXIT_CRITICAL(&logMux);
+
+    if (logTaskHandle != nullptr) {
+        xTaskNotifyGive(logTaskHandle);
+    }
+}
+
+static void logTask(void* arg) {
+    char chunk[MCC_LOG_CHUNK];
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (;;) {
+            uint32_t pos = logDrained;
+            uint32_t head;
+            const size_t n = copyFromRing(&pos, chunk, sizeof(chunk), &head);
+            if (pos != logDrained) {
+                logLost += pos - logDrained;
+                Serial.printf("\n... %u bytes of log lost ...\n", (unsigned)(pos - logDrained));
+            }
+            if (n == 0) {
+                logDrained = pos;
+                break;
+            }
+            // Blocks on the UART here instead of in the task that logged
+            Serial.write((const uint8_t*)chunk, n);
+            logDrained = pos + n;
+        }
+    }
+}
+
+void mccLogBegin() {
+    if (logTaskHandle != nullptr) {
+        return;
+    }
+    xTaskCreatePinnedToCore(logTask, "mcc_log", MCC_LOG_TASK_STACK, nullptr, MCC_LOG_TASK_PRIORITY,
+                            &logTaskHandle, ARDUINO_RUNNING_CORE);
+    if (logTaskHandle == nullptr) {
+        Serial.println("ERROR: mccLogBegin() - Could not create log task");
+        return;
+    }
+    xTaskNotifyGive(logTaskHandle);
+}
+
+void mccLogWrite(uint8_t level, const char* format, ...) {
+    char line[MCC_LOG_LINE_MAX];
+    const char* prefix = LEVEL_PREFIX[level <= MCC_LOG_LEVEL_DEBUG ? level : 0];
+    size_t len = strlcpy(line, prefix, sizeof(line));
+    va_list args;
+    va_start(args, format);
+    const int written = vsnprintf(line + len, sizeof(line) - len, format, args);
+    va_end(args);
+    if (written > 0) {
+        len += (size_t)written < sizeof(line) - len ? (size_t)written : sizeof(line) - len - 1;
+    }
+    if (len == 0 || line[len - 1] != '\n') {
+        if (len >= sizeof(line) - 1) {
+            len = sizeof(line) - 2;
+        }
+        line[len++] = '\n';
+    }
+
+    appendToRing(line, len);
+}
+
+void mccLogFlush(uint32_t timeoutMs) {
+    if (logTaskHandle == nullptr) {
+        return;
+    }
+    const unsigned long start = millis();
+    xTaskNotifyGive(logTaskHandle);
+    for (;;) {
+        taskENTER_CRITICAL(&logMux);
+        const bool drained = logDrained == logHead;
+        taskEXIT_CRITICAL(&logMux);
+        if (drained || millis() - start >= timeoutMs) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+    Serial.flush();
+}
+
+void mccLogDump(Print& out) {
+    char chunk[MCC_LOG_CHUNK];
+    uint32_t head;
+    taskENTER_CRITICAL(&logMux);
+    head = logHead;
+    taskEXIT_CRITICAL(&logMux);
+    uint32_t pos = head > MCC_LOG_BUFFER_SIZE ? head - MCC_LOG_BUFFER_SIZE : 0;
+    bool lineStart = pos == 0;
+    const uint32_t end = head;
+    while (pos < end) {
+        const uint32_t wanted = pos;
+        size_t n = copyFromRing(&pos, chunk, sizeof(chunk), &head);
+        if (pos != wanted) {
+            lineStart = false;
+        }
+        if (pos + n > end) {
+            n = end - pos;   // Lines logged while dumping are left for the next request
+        }
+        if (n == 0) {
+            break;
+        }
+        size_t skip = 0;
+        if (!lineStart) {
+            // The oldest line was partly overwritten
+            while (skip < n && chunk[skip] != '\n') {
+                skip++;
+            }
+            if (skip < n) {
+                skip++;
+                lineStart = true;
+            }
+        }
+        out.write((const uint8_t*)chunk + skip, n - skip);
+        pos += n;
+    }
+}
+
+uint32_t mccLogLostBytes() {
+    return logLost;
+}
+
+size_t LogSerial::write(uint8_t c) {
+    appendToRing((const char*)&c, 1);
+    return 1;
+}
+
+size_t LogSerial::write(const uint8_t* buffer, size_t size) {
+    appendToRing((const char*)buffer, size);
+    return size;
+}
@@ -0,0 +1,118 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    mcc_log.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Deferred serial log: lines are formatted into a RAM ring buffer and
+ * written to Serial by a low-priority task, so a slow UART no longer blocks
+ * loop() or the network task. The ring keeps the latest lines for the
+ * portal (GET /log). Levels above MCC_LOG_LEVEL are compiled out, debug
+ * lines are additionally switched at runtime by debugEnabled.
+ */
+
+#ifndef MCC_LOG_H
+#define MCC_LOG_H
+
+#include <Arduino.h>
+
+#define MCC_LOG_LEVEL_NONE    0
+#define MCC_LOG_LEVEL_ERROR   1
+#define MCC_LOG_LEVEL_WARNING 2
+#define MCC_LOG_LEVEL_INFO    3
+#define MCC_LOG_LEVEL_DEBUG   4
+
+// Highest level compiled in, e.g. -D MCC_LOG_LEVEL=2 strips info and debug lines
+#ifndef MCC_LOG_LEVEL
+#define MCC_LOG_LEVEL MCC_LOG_LEVEL_DEBUG
+#endif
+
+// Ring size in bytes; the oldest lines are overwritten
+#ifndef MCC_LOG_BUFFER_SIZE
+#define MCC_LOG_BUFFER_SIZE 4096
+#endif
+
+// Longer lines are truncated
+#define MCC_LOG_LINE_MAX 192
+
+extern bool debugEnabled;
+
+/**
+ * @brief Drop-in for Serial.print*() that goes through the ring buffer.
+ *
+ * For output without level (config dumps, payloads); keeps the order with
+ * the MCC_LOG* lines.
+ */
+class LogSerial : public Print {
+public:
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+};
+
+extern LogSerial logSerial;
+
+/**
+ * @brief Starts the task that writes the ring buffer to Serial.
+ *
+ * Lines logged before are kept and written once the task runs.
+ *
+ * @note Side effects: Creates a FreeRTOS task
+ */
+void mccLogBegin();
+
+/**
+ * @brief Formats one line into the ring buffer (use the MCC_LOG* macros).
+ *
+ * Adds the level prefix ("ERROR: ", "WARNING: ", "DEBUG: ") and a line
+ * break if the text has none.
+ *
+ * @note Safe to call from any task, not from an ISR
+ */
+void mccLogWrite(uint8_t level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Waits until all lines are written to Serial, e.g. before deep sleep or restart.
+ *
+ * @param timeoutMs Upper bound for the wait
+ */
+void mccLogFlush(uint32_t timeoutMs = 500);
+
+/**
+ * @brief Writes the lines still in the ring buffer, oldest first.
+ *
+ * @note Side effects: None, the drain to Serial continues independently
+ */
+void mccLogDump(Print& out);
+
+/**
+ * @brief Bytes overwritten before the task could write them to Serial.
+ */
+uint32_t mccLogLostBytes();
+
+#if MCC_LOG_LEVEL >= MCC_LOG_LEVEL_ERROR
+#define MCC_LOGE(...) mccLogWrite(MCC_LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define MCC_LOGE(...) do { } while (0)
+#endif
+
+#if MCC_LOG_LEVEL >= MCC_LOG_LEVEL_WARNING
+#define MCC_LOGW(...) mccLogWrite(MCC_LOG_LEVEL_WARNING, __VA_ARGS__)
+#else
+#define MCC_LOGW(...) do { } while (0)
+#endif
+
+#if MCC_LOG_LEVEL >= MCC_LOG_LEVEL_INFO
+#define MCC_LOGI(...) mccLogWrite(MCC_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define MCC_LOGI(...) do { } while (0)
+#endif
+
+// Arguments are only evaluated when debug output is enabled
+#if MCC_LOG_LEVEL >= MCC_LOG_LEVEL_DEBUG
+#define MCC_LOGD(...) do { if (debugEnabled) mccLogWrite(MCC_LOG_LEVEL_DEBUG, __VA_ARGS__); } while (0)
+#else
+#define MCC_LOGD(...) do { } while (0)
+#endif
+
+#endif // MCC_LOG_H
@@ -0,0 +1,227 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    metrics.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "metrics.h"
+#include "pulse_capture.h"
+#include "ride_journal.h"
+#include "ride_state.h"
+#include "mcc_log.h"
+
+static const uint32_t LOOP_BOUNDS_US[METRICS_HISTOGRAM_BOUNDS] = {
+    1000, 2000, 5000, 10000, 20000, 50000, 100000, 250000, 1000000
+};
+static const uint32_t HTTP_BOUNDS_MS[METRICS_HISTOGRAM_BOUNDS] = {
+    50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000
+};
+static const uint32_t CONNECT_BOUNDS_MS[METRICS_HISTOGRAM_BOUNDS] = {
+    20, 50, 100, 200, 500, 1000, 2000, 3000, 5000
+};
+static const uint32_t WIFI_BOUNDS_MS[METRICS_HISTOGRAM_BOUNDS] = {
+    250, 500, 1000, 2000, 3000, 5000, 7500, 10000, 15000
+};
+
+// Keys in the /metrics output, same order as MetricEndpoint
+static const char* const ENDPOINT_NAMES[METRIC_EP_COUNT] = {
+    "update_data", "update_data_batch", "get_user_id", "config_fetch",
+    "config_report", "heartbeat", "sync", "firmware", "other"
+};
+static const char* const STATUS_NAMES[METRIC_STATUS_COUNT] = {
+    "2xx", "3xx", "4xx", "5xx", "conn_error"
+};
+
+struct MetricsState {
+    bool initialized;
+    MetricHistogram loopUs;
+    MetricHistogram httpMs[METRIC_EP_COUNT];
+    uint32_t httpStatus[METRIC_EP_COUNT][METRIC_STATUS_COUNT];
+    MetricHistogram connectMs;
+    uint32_t tlsConnects;
+    uint32_t plainConnects;
+    uint32_t connectFailures;
+    MetricHistogram wifiMs;
+    uint32_t wifiConnects;
+    uint32_t wifiFailures;
+    uint32_t journalMax;
+};
+
+// Written by loop() and the network worker, so every access holds metricsMux
+static MetricsState metrics = {};
+static portMUX_TYPE metricsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Copy for the JSON output; only used from loop() (web server and heartbeat)
+static MetricsState metricsCopy;
+
+static void ensureInitialized() {
+    if (metrics.initialized) {
+        return;
+    }
+    metricHistogramInit(&metrics.loopUs, LOOP_BOUNDS_US);
+    for (int i = 0; i < METRIC_EP_COUNT; i++) {
+        metricHistogramInit(&metrics.httpMs[i], HTTP_BOUNDS_MS);
+    }
+    metricHistogramInit(&metrics.connectMs, CONNECT_BOUNDS_MS);
+    metricHistogramInit(&metrics.wifiMs, WIFI_BOUNDS_MS);
+    metrics.initialized = true;
+}
+
+static void copyMetrics() {
+    taskENTER_CRITICAL(&metricsMux);
+    ensureInitialized();
+    metricsCopy = metrics;
+    taskEXIT_CRITICAL(&metricsMux);
+}
+
+void metricsRecordLoop(uint32_t durationUs) {
+    // Sampled here, so the peak between two uploads is not missed
+    const uint32_t journalPending = rideJournalPendingCount();
+    taskENTER_CRITICAL(&metricsMux);
+    ensureInitialized();
+    metricHistogramRecord(&metrics.loopUs, durationUs);
+    if (journalPending > metrics.journalMax) {
+        metrics.journalMax = journalPending;
+    }
+    taskEXIT_CRITICAL(&metricsMux);
+}
+
+void metricsRecordHttp(MetricEndpoint endpoint, uint32_t durationMs, int httpCode) {
+    if (endpoint >= METRIC_EP_COUNT) {
+        endpoint = METRIC_EP_OTHER;
+    }
+    taskENTER_CRITICAL(&metricsMux);
+    ensureInitialized();
+    metricHistogramRecord(&metrics.httpMs[endpoint], durationMs);
+    metrics.httpStatus[endpoint][metricStatusClass(httpCode)]++;
+    taskEXIT_CRITICAL(&metricsMux);
+}
+
+void metricsRecordConnect(uint32_t durationMs, bool tls, bool success) {
+    taskENTER_CRITICAL(&metricsMux);
+    ensureInitialized();
+    if (success) {
+        metricHistogramRecord(&metrics.connectMs, durationMs);
+        if (tls) {
+            metrics.tlsConnects++;
+        } else {
+            metrics.plainConnects++;
+        }
+    } else {
+        metrics.connectFailures++;
+    }
+    taskEXIT_CRITICAL(&metricsMux);
+}
+
+void metricsRecordWifiConnect(uint32_t durationMs, bool success) {
+    taskENTER_CRITICAL(&metricsMux);
+    ensureInitialized();
+    if (success) {
+        metricHistogramRecord(&metrics.wifiMs, durationMs);
+        metrics.wifiConnects++;
+    } else {
+        metrics.wifiFailures++;
+    }
+    taskEXIT_CRITICAL(&metricsMux);
+}
+
+void metricsAppendSummary(JsonObject obj) {
+    copyMetrics();
+    const MetricsState& m = metricsCopy;
+
+    uint32_t requests = 0;
+    uint32_t errors = 0;
+    MetricHistogram http;
+    metricHistogramInit(&http, HTTP_BOUNDS_MS);
+    for (int ep = 0; ep < METRIC_EP_COUNT; ep++) {
+        for (int b = 0; b < METRICS_HISTOGRAM_BUCKETS; b++) {
+            http.counts[b] += m.httpMs[ep].counts[b];
+        }
+        http.count += m.httpMs[ep].count;
+        http.sum += m.httpMs[ep].sum;
+        http.max = max(http.max, m.httpMs[ep].max);
+        requests += m.httpMs[ep].count;
+        errors += m.httpStatus[ep][METRIC_STATUS_4XX] + m.httpStatus[ep][METRIC_STATUS_5XX] +
+                  m.httpStatus[ep][METRIC_STATUS_CONN_ERROR];
+    }
+
+    PulseSnapshot pulses;
+    pulseCaptureGetSnapshot(&pulses);
+
+    JsonObject summary = obj.createNestedObject("metrics");
+    summary["loop_p95_us"] = metricHistogramPercentile(&m.loopUs, 95);
+    summary["loop_max_us"] = m.loopUs.max;
+    summary["http_n"] = requests;
+    summary["http_err"] = errors;
+    summary["http_p95_ms"] = metricHistogramPercentile(&http, 95);
+    summary["conn_p95_ms"] = metricHistogramPercentile(&m.connectMs, 95);
+    summary["wifi_reconn"] = m.wifiConnects > 0 ? m.wifiConnects - 1 : 0;
+    summary["pulses_lost"] = pulses.dropped;
+    summary["journal_max"] = m.journalMax;
+}
+
+static void writeHistogram(Print& out, const char* name, const MetricHistogram& h) {
+    out.printf("\"%s\":{\"count\":%u,\"sum\":%llu,\"max\":%u,\"mean\":%u,\"p50\":%u,\"p95\":%u,\"p99\":%u,\"le\":[",
+               name, (unsigned)h.count, (unsigned long long)h.sum, (unsigned)h.max, (unsigned)metricHistogramMean(&h),
+               (unsigned)metricHistogramPercentile(&h, 50), (unsigned)metricHistogramPercentile(&h, 95),
+               (unsigned)metricHistogramPercentile(&h, 99));
+    for (int i = 0; i < METRICS_HISTOGRAM_BOUNDS; i++) {
+        out.printf(i == 0 ? "%u" : ",%u", (unsigned)h.bounds[i]);
+    }
+    // One more count than bounds: the last bucket is everything above
+    out.print("],\"counts\":[");
+    for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++) {
+        out.printf(i == 0 ? "%u" : ",%u", (unsigned)h.counts[i]);
+    }
+    out.print("]}");
+}
+
+void metricsWriteJson(Print& out) {
+    copyMetrics();
+    const MetricsState& m = metricsCopy;
+    PulseSnapshot pulses;
+    pulseCaptureGetSnapshot(&pulses);
+
+    out.printf("{\"uptime_ms\":%lu,\"heap\":{\"free\":%u,\"min_free\":%u,\"max_block\":%u},",
+               millis(), (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(), (unsigned)ESP.getMaxAllocHeap());
+    writeHistogram(out, "loop_us", m.loopUs);
+
+    out.print(",\"http\":{");
+    bool first = true;
+    for (int ep = 0; ep < METRIC_EP_COUNT; ep++) {
+        if (m.httpMs[ep].count == 0) {
+            continue;
+        }
+        out.printf("%s\"%s\":{\"status\":{", first ? "" : ",", ENDPOINT_NAMES[ep]);
+        for (int s = 0; s < METRIC_STATUS_COUNT; s++) {
+            out.printf("%s\"%s\":%u", s == 0 ? "" : ",", STATUS_NAMES[s], (unsigned)m.httpStatus[ep][s]);
+        }
+        out.print("},");
+        writeHistogram(out, "latency_ms", m.httpMs[ep]);
+        out.print("}");
+        first = false;
+    }
+
+    out.printf("},\"connect\":{\"tls\":%u,\"plain\":%u,\"failed\":%u,",
+               (unsigned)m.tlsConnects, (unsigned)m.plainConnects, (unsigned)m.connectFailures);
+    writeHistogram(out, "duration_ms", m.connectMs);
+
+    out.printf("},\"wifi\":{\"connects\":%u,\"reconnects\":%u,\"failed\":%u,",
+               (unsigned)m.wifiConnects, (unsigned)(m.wifiConnects > 0 ? m.wifiConnects - 1 : 0),
+               (unsigned)m.wifiFailures);
+    writeHistogram(out, "connect_ms", m.wifiMs);
+
+    out.printf("},\"pulses\":{\"dropped\":%u,\"merged\":%u},\"journal\":{\"pending\":%u,\"max\":%u},",
+               (unsigned)pulses.dropped, (unsigned)pulses.merged,
+               (unsigned)rideJournalPendingCount(), (unsigned)m.journalMax);
+
+    // Numbers only, rider identities stay out of the metrics
+    RideState ride;
+    rideStateGet(&ride);
+    out.printf("\"log\":{\"lost_bytes\":%u},", (unsigned)mccLogLostBytes());
+    out.printf("\"ride\":{\"version\":%u,\"speed_kmh\":%.1f,\"distance_m\":%.1f,\"pulses\":%u,\"velos\":\"%s\"}}",
+               (unsigned)rideStateVersion(), ride.speed_kmh, ride.totalDistance_mm / 1000.0f,
+               (unsigned)ride.pulses, ride.sessionVelos);
+}
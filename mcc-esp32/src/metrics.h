@@ -0,0 +1,79 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    metrics.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Runtime performance metrics of the firmware: loop iteration time, request
+ * latency and result codes per endpoint, connection setup (TCP + TLS), WiFi
+ * connect time, heap and the ride journal depth. Counters live in RAM since
+ * boot; the heartbeat carries a compact summary and the configuration portal
+ * serves the full set on /metrics.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "metrics_registry.h"
+
+/**
+ * @brief Request targets with their own latency histogram.
+ */
+enum MetricEndpoint : uint8_t {
+    METRIC_EP_UPDATE_DATA = 0,
+    METRIC_EP_UPDATE_DATA_BATCH,
+    METRIC_EP_GET_USER_ID,
+    METRIC_EP_CONFIG_FETCH,
+    METRIC_EP_CONFIG_REPORT,
+    METRIC_EP_HEARTBEAT,
+    METRIC_EP_SYNC,
+    METRIC_EP_FIRMWARE,      // firmware/info and firmware/download
+    METRIC_EP_OTHER,
+    METRIC_EP_COUNT
+};
+
+/**
+ * @brief Duration of one loop() pass.
+ */
+void metricsRecordLoop(uint32_t durationUs);
+
+/**
+ * @brief Latency and result of one request (called by HttpSession).
+ *
+ * @param httpCode HTTP status or HTTPClient error (< 0)
+ *
+ * @note Side effects: Safe to call from the network worker task
+ */
+void metricsRecordHttp(MetricEndpoint endpoint, uint32_t durationMs, int httpCode);
+
+/**
+ * @brief Setup of a new server connection (TCP connect plus TLS handshake for https).
+ */
+void metricsRecordConnect(uint32_t durationMs, bool tls, bool success);
+
+/**
+ * @brief Result of one connectToWiFi() call; every success after the first counts as reconnect.
+ */
+void metricsRecordWifiConnect(uint32_t durationMs, bool success);
+
+/**
+ * @brief Adds the compact summary under "metrics" (heartbeat and sync payload).
+ *
+ * About 150 bytes of JSON: loop p95/max, request count, errors and p95 over
+ * all endpoints, connect p95, WiFi reconnects, lost pulses and journal peak.
+ *
+ * @note Side effects: Reads the pulse capture snapshot and the ride journal
+ */
+void metricsAppendSummary(JsonObject obj);
+
+/**
+ * @brief Streams all counters and histograms as one JSON object.
+ *
+ * @note Side effects: Reads heap statistics, the pulse capture snapshot, the ride journal and the ride state
+ */
+void metricsWriteJson(Print& out);
+
+#endif
@@ -0,0 +1,111 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    metrics_registry.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Fixed-bucket histograms and HTTP status classes for the runtime metrics.
+ * Recording is a bounded loop without allocation, so it may run in loop()
+ * and in the network worker.
+ */
+
+#ifndef METRICS_REGISTRY_H
+#define METRICS_REGISTRY_H
+
+#include <stdint.h>
+
+// Upper bounds per histogram; one more bucket collects everything above the last bound
+#define METRICS_HISTOGRAM_BOUNDS 9
+#define METRICS_HISTOGRAM_BUCKETS (METRICS_HISTOGRAM_BOUNDS + 1)
+
+struct MetricHistogram {
+    const uint32_t* bounds;                    // METRICS_HISTOGRAM_BOUNDS ascending upper bounds (inclusive)
+    uint32_t counts[METRICS_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint64_t sum;
+    uint32_t max;
+};
+
+/**
+ * @brief Result classes of a request, index into a counter array.
+ */
+enum MetricStatusClass : uint8_t {
+    METRIC_STATUS_2XX = 0,
+    METRIC_STATUS_3XX,
+    METRIC_STATUS_4XX,
+    METRIC_STATUS_5XX,
+    METRIC_STATUS_CONN_ERROR,   // HTTPClient error (< 0) or no status line
+    METRIC_STATUS_COUNT
+};
+
+static inline void metricHistogramInit(MetricHistogram* h, const uint32_t* bounds) {
+    h->bounds = bounds;
+    for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++) {
+        h->counts[i] = 0;
+    }
+    h->count = 0;
+    h->sum = 0;
+    h->max = 0;
+}
+
+static inline void metricHistogramRecord(MetricHistogram* h, uint32_t value) {
+    int bucket = 0;
+    while (bucket < METRICS_HISTOGRAM_BOUNDS && value > h->bounds[bucket]) {
+        bucket++;
+    }
+    h->counts[bucket]++;
+    h->count++;
+    h->sum += value;
+    if (value > h->max) {
+        h->max = value;
+    }
+}
+
+/**
+ * @brief Estimates a percentile from the bucket counts.
+ *
+ * @param percent 1..100
+ * @return Upper bound of the bucket containing the percentile (max for the
+ *         overflow bucket and never above max), 0 without samples
+ */
+static inline uint32_t metricHistogramPercentile(const MetricHistogram* h, uint8_t percent) {
+    if (h->count == 0) {
+        return 0;
+    }
+    // Rank of the sample, rounded up: p50 of 3 samples is the 2nd
+    const uint32_t rank = (uint32_t)(((uint64_t)h->count * percent + 99) / 100);
+    uint32_t seen = 0;
+    for (int i = 0; i < METRICS_HISTOGRAM_BOUNDS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            return h->bounds[i] < h->max ? h->bounds[i] : h->max;
+        }
+    }
+    return h->max;
+}
+
+static inline uint32_t metricHistogramMean(const MetricHistogram* h) {
+    return h->count > 0 ? (uint32_t)(h->sum / h->count) : 0;
+}
+
+/**
+ * @brief Maps an HTTPClient return value to its result class.
+ */
+static inline MetricStatusClass metricStatusClass(int httpCode) {
+    if (httpCode >= 200 && httpCode < 300) {
+        return METRIC_STATUS_2XX;
+    }
+    if (httpCode >= 300 && httpCode < 400) {
+        return METRIC_STATUS_3XX;
+    }
+    if (httpCode >= 400 && httpCode < 500) {
+        return METRIC_STATUS_4XX;
+    }
+    if (httpCode >= 500 && httpCode < 600) {
+        return METRIC_STATUS_5XX;
+    }
+    return METRIC_STATUS_CONN_ERROR;
+}
+
+#endif // METRICS_REGISTRY_H
@@ -0,0 +1,276 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    mqtt_link.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "mqtt_link.h"
+#include "mcc_log.h"
+#include "mqtt_client.h"
+#ifdef CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+#include "esp_crt_bundle.h"
+#endif
+
+// External variables from main.cpp
+extern bool debugEnabled;
+
+static const size_t MQTT_TOPIC_LEN = 96;
+// PUBACKs remembered for the waiting publisher; more than one upload is never in flight
+static const uint8_t MQTT_ACK_HISTORY = 8;
+
+static esp_mqtt_client_handle_t mqttClient = nullptr;   // Created once, stopped and started again
+static bool mqttStarted = false;
+static QueueHandle_t mqttRxQueue = nullptr;
+static volatile bool mqttConnected = false;
+static String brokerUrl;
+static String clientId;
+static String clientPassword;
+static char topicBase[MQTT_TOPIC_LEN];      // "mcc/<device_id>/"
+static char statusTopic[MQTT_TOPIC_LEN];    // Retained "online"/"offline", also the last will
+
+// Written by the MQTT task, read by the publishing task
+static volatile int ackedIds[MQTT_ACK_HISTORY];
+static volatile uint8_t ackedNext = 0;
+static volatile TaskHandle_t publishWaiter = nullptr;
+
+// Message that arrives in several DATA events; only used by the MQTT task
+static MqttMessage partial = {};
+
+static const struct {
+    const char* name;
+    MqttDownlink type;
+} DOWNLINK_TOPICS[] = {
+    {"update", MQTT_DOWN_UPDATE},
+    {"config", MQTT_DOWN_CONFIG},
+    {"display", MQTT_DOWN_DISPLAY},
+    {"reset", MQTT_DOWN_RESET},
+};
+
+static MqttDownlink downlinkType(const char* topic, int topicLen) {
+    const size_t baseLen = strlen(topicBase);
+    static const char DOWN[] = "down/";
+    if ((size_t)topicLen <= baseLen + sizeof(DOWN) - 1 || strncmp(topic, topicBase, baseLen) != 0 ||
+        strncmp(topic + baseLen, DOWN, sizeof(DOWN) - 1) != 0) {
+        return MQTT_DOWN_UNKNOWN;
+    }
+    const char* name = topic + baseLen + sizeof(DOWN) - 1;
+    const size_t nameLen = topicLen - baseLen - (sizeof(DOWN) - 1);
+    for (const auto& entry : DOWNLINK_TOPICS) {
+        if (strlen(entry.name) == nameLen && strncmp(name, entry.name, nameLen) == 0) {
+            return entry.type;
+        }
+    }
+    return MQTT_DOWN_UNKNOWN;
+}
+
+/**
+ * @brief Collects the chunks of a downlink message and queues it when complete.
+ *
+ * The topic is only set in the first chunk.
+ */
+static void receiveChunk(esp_mqtt_event_handle_t event) {
+    if (event->current_data_offset == 0) {
+        free(partial.payload);
+        partial.payload = nullptr;
+        partial.type = downlinkType(event->topic, event->topic_len);
+        if (partial.type == MQTT_DOWN_UNKNOWN || event->total_data_len > MQTT_MESSAGE_MAX_LEN) {
+            if (debugEnabled) {
+                logSerial.printf("DEBUG: [mqtt] Ignoring message on %.*s (%d bytes)\n",
+                              event->topic_len, event->topic, event->total_data_len);
+            }
+            return;
+        }
+        partial.len = event->total_data_len;
+        partial.payload = (char*)malloc(partial.len + 1);
+    }
+    if (partial.payload == nullptr || (size_t)(event->current_data_offset + event->data_len) > partial.len) {
+        return;
+    }
+    memcpy(partial.payload + event->current_data_offset, event->data, event->data_len);
+    if ((size_t)(event->current_data_offset + event->data_len) < partial.len) {
+        return;
+    }
+    partial.payload[partial.len] = '\0';
+    if (xQueueSend(mqttRxQueue, &partial, 0) != pdTRUE) {
+        free(partial.payload);
+        MCC_LOGD("[mqtt] Downlink queue full, message dropped");
+    }
+    partial.payload = nullptr;
+}
+
+// Runs in the MQTT task
+static void onMqttEvent(void* arg, esp_event_base_t base, int32_t eventId, void* eventData) {
+    esp_mqtt_event_handle_t event = (esp_mqtt_event_handle_t)eventData;
+    switch ((esp_mqtt_event_id_t)eventId) {
+        case MQTT_EVENT_CONNECTED: {
+            // Subscribed again on every connect, so retained config and display are delivered
+            char topic[MQTT_TOPIC_LEN];
+            snprintf(topic, sizeof(topic), "%sdown/#", topicBase);
+            esp_mqtt_client_subscribe(mqttClient, topic, 1);
+            esp_mqtt_client_publish(mqttClient, statusTopic, "online", 0, 1, 1);
+            mqttConnected = true;
+            MCC_LOGD("[mqtt] Connected (session %s)\n", event->session_present ? "resumed" : "new");
+            break;
+        }
+        case MQTT_EVENT_DISCONNECTED:
+            mqttConnected = false;
+            MCC_LOGD("[mqtt] Disconnected");
+            break;
+        case MQTT_EVENT_PUBLISHED: {
+            ackedIds[ackedNext % MQTT_ACK_HISTORY] = event->msg_id;
+            ackedNext++;
+            TaskHandle_t waiter = publishWaiter;
+            if (waiter != nullptr) {
+                xTaskNotifyGive(waiter);
+            }
+            break;
+        }
+        case MQTT_EVENT_DATA:
+            receiveChunk(event);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Client settings; the client copies all strings.
+ */
+static esp_mqtt_client_config_t clientConfig() {
+    esp_mqtt_client_config_t config = {};
+    config.uri = brokerUrl.c_str();
+    config.client_id = clientId.c_str();
+    config.username = clientId.c_str();
+    config.password = clientPassword.c_str();
+    config.keepalive = MQTT_KEEPALIVE_SEC;
+    // Persistent session: QoS 1 downlinks wait at the broker while the device sleeps
+    config.disable_clean_session = true;
+    config.lwt_topic = statusTopic;
+    config.lwt_msg = "offline";
+    config.lwt_qos = 1;
+    config.lwt_retain = 1;
+    config.buffer_size = MQTT_MESSAGE_MAX_LEN;
+    #ifdef MQTT_CA_CERT
+    config.cert_pem = MQTT_CA_CERT;
+    #elif defined(CONFIG_MBEDTLS_CERTIFICATE_BUNDLE)
+    config.crt_bundle_attach = esp_crt_bundle_attach;
+    #endif
+    return config;
+}
+
+bool mqttLinkBegin(const String& url, const char* deviceId, const String& apiKey) {
+    if (url.length() == 0) {
+        mqttLinkStop();
+        return false;
+    }
+    if (!url.startsWith("mqtt://") && !url.startsWith("mqtts://")) {
+        MCC_LOGW("MQTT broker URL must start with mqtt:// or mqtts:// (%s), using HTTP only\n",
+                      url.c_str());
+        mqttLinkStop();
+        return false;
+    }
+    const bool changed = url != brokerUrl || clientId != deviceId || clientPassword != apiKey;
+    if (mqttClient != nullptr && mqttStarted && !changed) {
+        return true;
+    }
+    if (mqttRxQueue == nullptr) {
+        mqttRxQueue = xQueueCreate(MQTT_RX_QUEUE_LEN, sizeof(MqttMessage));
+        if (mqttRxQueue == nullptr) {
+            MCC_LOGE("mqttLinkBegin() - Could not create queue");
+            return false;
+        }
+    }
+    brokerUrl = url;
+    clientId = deviceId;
+    clientPassword = apiKey;
+    snprintf(topicBase, sizeof(topicBase), MQTT_TOPIC_PREFIX "%s/", deviceId);
+    snprintf(statusTopic, sizeof(statusTopic), "%sup/status", topicBase);
+    const esp_mqtt_client_config_t config = clientConfig();
+
+    if (mqttClient == nullptr) {
+        mqttClient = esp_mqtt_client_init(&config);
+        if (mqttClient == nullptr) {
+            MCC_LOGE("mqttLinkBegin() - Could not create MQTT client");
+            return false;
+        }
+        esp_mqtt_client_register_event(mqttClient, MQTT_EVENT_ANY, onMqttEvent, nullptr);
+    } else if (changed) {
+        // New API key (rotation) or broker: used from the next connect on
+        esp_mqtt_set_config(mqttClient, &config);
+        if (mqttStarted) {
+            esp_mqtt_client_reconnect(mqttClient);
+            MCC_LOGD("[mqtt] Settings changed, reconnecting");
+            return true;
+        }
+    }
+    if (esp_mqtt_client_start(mqttClient) != ESP_OK) {
+        MCC_LOGE("mqttLinkBegin() - Could not start MQTT client");
+        return false;
+    }
+    mqttStarted = true;
+    MCC_LOGD("[mqtt] Connecting to %s as %s\n", brokerUrl.c_str(), deviceId);
+    return true;
+}
+
+void mqttLinkStop() {
+    if (mqttClient == nullptr || !mqttStarted) {
+        return;
+    }
+    if (mqttConnected) {
+        // A clean disconnect does not trigger the last will
+        esp_mqtt_client_publish(mqttClient, statusTopic, "offline", 0, 0, 1);
+    }
+    // The handle stays valid, a publish of the network worker fails instead of using freed memory
+    esp_mqtt_client_stop(mqttClient);
+    mqttStarted = false;
+    mqttConnected = false;
+}
+
+bool mqttLinkConnected() {
+    return mqttConnected;
+}
+
+static bool ackReceived(int msgId) {
+    for (uint8_t i = 0; i < MQTT_ACK_HISTORY; i++) {
+        if (ackedIds[i] == msgId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int mqttLinkPublish(const char* name, const char* payload, size_t len) {
+    if (mqttClient == nullptr || !mqttConnected) {
+        return -1;
+    }
+    char topic[MQTT_TOPIC_LEN];
+    snprintf(topic, sizeof(topic), "%sup/%s", topicBase, name);
+
+    publishWaiter = xTaskGetCurrentTaskHandle();
+    const int msgId = esp_mqtt_client_publish(mqttClient, topic, payload, (int)len, 1, 0);
+    bool acked = false;
+    if (msgId > 0) {
+        // The PUBACK can arrive before this loop starts, so the history is checked before waiting
+        const unsigned long start = millis();
+        while (!(acked = ackReceived(msgId)) && millis() - start < MQTT_PUBLISH_TIMEOUT_MS) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        }
+    }
+    publishWaiter = nullptr;
+    if (debugEnabled && !acked) {
+        logSerial.printf("DEBUG: [mqtt] Publish on %s not acknowledged (msg id %d)\n", topic, msgId);
+    }
+    return acked ? 200 : -1;
+}
+
+bool mqttLinkPoll(MqttMessage* message) {
+    return mqttRxQueue != nullptr && xQueueReceive(mqttRxQueue, message, 0) == pdTRUE;
+}
+
+void mqttLinkFreeMessage(MqttMessage* message) {
+    free(message->payload);
+    message->payload = nullptr;
+    message->len = 0;
+}
@@ -0,0 +1,106 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    mqtt_link.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Optional MQTT transport next to HTTP (ESP-IDF MQTT client, TLS with
+ * mqtts://). Uploads are published with QoS 1 on mcc/<device_id>/up/update;
+ * the server pushes upload results, config changes, display updates and
+ * operator resets on mcc/<device_id>/down/#. The session is persistent, so
+ * messages sent while the device sleeps are delivered after the reconnect.
+ * The broker authenticates with the device ID and the API key.
+ */
+
+#ifndef MQTT_LINK_H
+#define MQTT_LINK_H
+
+#include <Arduino.h>
+
+#define MQTT_TOPIC_PREFIX "mcc/"
+
+// Largest downlink message (a config push is below 1 KB)
+#ifndef MQTT_MESSAGE_MAX_LEN
+#define MQTT_MESSAGE_MAX_LEN 2048
+#endif
+
+// Downlink messages waiting for loop()
+#ifndef MQTT_RX_QUEUE_LEN
+#define MQTT_RX_QUEUE_LEN 4
+#endif
+
+#ifndef MQTT_KEEPALIVE_SEC
+#define MQTT_KEEPALIVE_SEC 60
+#endif
+
+// A publish counts as failed without PUBACK in this time (same as an HTTP timeout)
+#ifndef MQTT_PUBLISH_TIMEOUT_MS
+#define MQTT_PUBLISH_TIMEOUT_MS 10000
+#endif
+
+enum MqttDownlink : uint8_t {
+    MQTT_DOWN_UPDATE,   // Result of an upload: update-data response plus "status" (HTTP code)
+    MQTT_DOWN_CONFIG,   // Config fetch response, sent when the server-side config changed
+    MQTT_DOWN_DISPLAY,  // Display Velos (round frozen / live)
+    MQTT_DOWN_RESET,    // Operator reset, same fields as the get-user-id response
+    MQTT_DOWN_UNKNOWN
+};
+
+/**
+ * @brief Downlink message, returned to loop() by mqttLinkPoll().
+ */
+struct MqttMessage {
+    MqttDownlink type;
+    char* payload;      // NUL-terminated JSON; release with mqttLinkFreeMessage()
+    size_t len;
+};
+
+/**
+ * @brief Starts the MQTT client, or applies changed settings (API key rotation).
+ *
+ * Call after the WiFi connection is up. The client reconnects on its own
+ * when the connection drops. With the same settings a running client is left
+ * alone; an empty URL stops it.
+ *
+ * @param brokerUrl mqtt://host[:port] or mqtts://host[:port]
+ * @param deviceId Client ID, user name and topic level
+ * @param apiKey Password at the broker
+ * @return false if the URL is empty or invalid or the client could not be started
+ *
+ * @note Side effects: Creates the MQTT client task and the downlink queue
+ */
+bool mqttLinkBegin(const String& brokerUrl, const char* deviceId, const String& apiKey);
+
+/**
+ * @brief Disconnects and stops the client (before sleep or a WiFi shutdown).
+ *
+ * The broker keeps the session; mqttLinkBegin() resumes it. A publish waiting
+ * in the network worker fails and is journaled like an HTTP timeout.
+ */
+void mqttLinkStop();
+
+/**
+ * @brief true while connected to the broker.
+ */
+bool mqttLinkConnected();
+
+/**
+ * @brief Publishes a message with QoS 1 and waits for the PUBACK; blocks the calling task.
+ *
+ * @param name Last topic level below mcc/<device_id>/up/
+ * @param payload JSON body (len bytes)
+ * @return 200 when acknowledged by the broker, -1 if not connected or timed out
+ */
+int mqttLinkPublish(const char* name, const char* payload, size_t len);
+
+/**
+ * @brief Takes the next downlink message without blocking.
+ *
+ * @return true if a message was available; call mqttLinkFreeMessage() when done
+ */
+bool mqttLinkPoll(MqttMessage* message);
+
+void mqttLinkFreeMessage(MqttMessage* message);
+
+#endif
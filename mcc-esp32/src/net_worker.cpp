@@ -0,0 +1,263 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    net_worker.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "net_worker.h"
+#include "mcc_log.h"
+#include <WiFi.h>
+#include "http_session.h"
+#include "payload_codec.h"
+#include "device_management.h"
+#include "wifi_manager.h"
+#include "gateway_link.h"
+#include "mqtt_link.h"
+
+// External variables from main.cpp
+extern String apiKey;
+extern bool debugEnabled;
+
+struct NetJob {
+    NetJobType type;
+    NetJobType forwardType;   // Job type on the node for NET_JOB_GATEWAY_FORWARD, else type
+    char url[NET_JOB_URL_LEN];
+    char apiKey[NET_JOB_API_KEY_LEN];
+    char tag[NET_JOB_TAG_LEN];
+    char* payload;        // Heap copy of a POST body larger than inlinePayload
+    size_t payloadLen;    // 0 for GET
+    uint32_t context;
+    uint32_t session;
+    char inlinePayload[NET_JOB_PAYLOAD_LEN];
+};
+
+// Job, result and the filtered config document are on this stack next to HTTPClient and TLS
+static const uint32_t NET_WORKER_STACK_SIZE = 8192 + sizeof(NetJob) + sizeof(NetResult) + DEVICE_CONFIG_DOC_SIZE;
+
+static QueueHandle_t netJobQueue = nullptr;
+static QueueHandle_t netResultQueue = nullptr;
+static TaskHandle_t netWorkerTaskHandle = nullptr;
+
+// Only touched from loop(): incremented on submit, decremented when the result is taken
+static uint8_t netJobsPending[NET_JOB_TYPE_COUNT] = {0};
+
+// Latency histogram per job type, same order as NetJobType (forwards use the node's job type)
+static const MetricEndpoint JOB_METRIC_ENDPOINT[NET_JOB_TYPE_COUNT] = {
+    METRIC_EP_UPDATE_DATA, METRIC_EP_UPDATE_DATA, METRIC_EP_GET_USER_ID,
+    METRIC_EP_CONFIG_FETCH, METRIC_EP_UPDATE_DATA, METRIC_EP_UPDATE_DATA_BATCH, METRIC_EP_UPDATE_DATA_BATCH,
+    METRIC_EP_OTHER
+};
+
+static void copyBounded(char* dest, size_t destLen, const char* src) {
+    if (src == nullptr) {
+        dest[0] = '\0';
+        return;
+    }
+    strncpy(dest, src, destLen - 1);
+    dest[destLen - 1] = '\0';
+}
+
+/**
+ * @brief Config fetch: parses the response from the stream with the config filter.
+ *
+ * The filtered document is handed to loop() as compact JSON, so the result
+ * stays small no matter what else the server sends.
+ */
+static int fetchFilteredConfig(HTTPClient& http, const char* body, size_t bodyLen, NetResult* result) {
+    StaticJsonDocument<DEVICE_CONFIG_DOC_SIZE> doc;
+    DeserializationError error;
+    int httpCode = payloadExchangeFiltered(http, body, bodyLen, doc, deviceConfigFilter(), &error);
+    if (httpCode != HTTP_CODE_OK || error) {
+        return httpCode;
+    }
+    const size_t len = measureJson(doc);
+    if (len < sizeof(result->inlineBody)) {
+        serializeJson(doc, result->inlineBody, sizeof(result->inlineBody));
+    } else {
+        result->body = (char*)malloc(len + 1);
+        if (result->body != nullptr) {
+            serializeJson(doc, result->body, len + 1);
+            result->bodyOnHeap = true;
+        }
+    }
+    return httpCode;
+}
+
+static void netWorkerTask(void* arg) {
+    NetJob job;
+    for (;;) {
+        if (xQueueReceive(netJobQueue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        NetResult result = {};
+        result.type = job.type;
+        result.context = job.context;
+        result.session = job.session;
+        memcpy(result.tag, job.tag, sizeof(result.tag));
+        // Request handling follows the job type on the node for gateway forwards
+        const NetJobType kind = job.forwardType;
+        const char* body = job.payload != nullptr ? job.payload : job.inlinePayload;
+
+        if (gatewayLinkRole() == GATEWAY_ROLE_NODE) {
+            // No WiFi association on a node: the gateway sends the request
+            digitalWrite(LED_PIN, HIGH);
+            result.httpCode = gatewayNodeExchange(kind, job.url, job.apiKey, body, job.payloadLen, job.context,
+                                                  result.inlineBody, sizeof(result.inlineBody));
+            digitalWrite(LED_PIN, LOW);
+        } else if (!wifiManagerConnected()) {
+            // Event flag of the WiFi manager: no driver call from this task, and a
+            // connection that dropped fails the job at once instead of timing out in HTTPClient
+            result.httpCode = -1;
+        } else if (job.type == kind && mqttLinkConnected() &&
+                   (kind == NET_JOB_UPDATE_DATA || kind == NET_JOB_CARRY_UPLOAD || kind == NET_JOB_JOURNAL_REPLAY)) {
+            // Uploads become a QoS 1 publish: the PUBACK counts as success, the server
+            // answer (Velos) follows on down/update. Gateway forwards keep using HTTP.
+            digitalWrite(LED_PIN, HIGH);
+            result.httpCode = mqttLinkPublish("update", body, job.payloadLen);
+            digitalWrite(LED_PIN, LOW);
+        } else {
+            HttpSession session;
+            HTTPClient& http = session.http();
+            session.begin(job.url, JOB_METRIC_ENDPOINT[kind]);
+            http.setTimeout(NET_WORKER_HTTP_TIMEOUT_MS);
+            http.addHeader("Content-Type", "application/json");
+            if (job.apiKey[0] != '\0') {
+                http.addHeader("X-Api-Key", job.apiKey);
+            }
+            if (kind == NET_JOB_CONFIG_FETCH) {
+                // context: config hash at submit time, an unchanged config costs a 304
+                addConfigIfNoneMatch(http, job.context);
+            }
+
+            String overflow;
+            digitalWrite(LED_PIN, HIGH);  // Turn on LED when sending
+            if (kind == NET_JOB_CONFIG_FETCH) {
+                result.httpCode = fetchFilteredConfig(http, body, job.payloadLen, &result);
+            } else {
+                result.httpCode = payloadExchange(http, body, job.payloadLen,
+                                                  result.inlineBody, sizeof(result.inlineBody), &overflow);
+            }
+            digitalWrite(LED_PIN, LOW);
+            session.recordResult(result.httpCode);
+
+            if (result.httpCode > 0) {
+                if (overflow.length() > 0) {
+                    result.body = strdup(overflow.c_str());
+                    result.bodyOnHeap = result.body != nullptr;
+                }
+            } else if (debugEnabled) {
+                logSerial.printf("DEBUG: [netWorker] HTTP error: %s\n", http.errorToString(result.httpCode).c_str());
+            }
+            http.end();
+        }
+
+        free(job.payload);
+        xQueueSend(netResultQueue, &result, portMAX_DELAY);
+    }
+}
+
+void netWorkerBegin() {
+    if (netWorkerTaskHandle != nullptr) {
+        return;
+    }
+    // The worker shares the keep-alive connection with the synchronous request paths
+    httpSessionInit();
+    netJobQueue = xQueueCreate(NET_WORKER_JOB_QUEUE_LEN, sizeof(NetJob));
+    netResultQueue = xQueueCreate(NET_WORKER_RESULT_QUEUE_LEN, sizeof(NetResult));
+    if (netJobQueue == nullptr || netResultQueue == nullptr) {
+        MCC_LOGE("netWorkerBegin() - Could not create queues");
+        return;
+    }
+    xTaskCreatePinnedToCore(netWorkerTask, "net_worker", NET_WORKER_STACK_SIZE, nullptr, 1, &netWorkerTaskHandle, NET_WORKER_CORE);
+}
+
+bool netWorkerSubmit(NetJobType type, const String& url, const String& payload,
+                     uint32_t context, uint32_t session, const char* tag) {
+    return netWorkerSubmit(type, url.c_str(), payload.c_str(), payload.length(), context, session, tag);
+}
+
+/**
+ * @brief Copies a job into the queue; shared by netWorkerSubmit() and netWorkerSubmitForward().
+ */
+static bool submitJob(NetJobType type, NetJobType forwardType, const char* url, const char* key,
+                      const char* payload, size_t payloadLen, uint32_t context, uint32_t session, const char* tag) {
+    if (netJobQueue == nullptr || strlen(url) >= NET_JOB_URL_LEN) {
+        return false;
+    }
+
+    NetJob job;
+    job.type = type;
+    job.forwardType = forwardType;
+    job.context = context;
+    job.session = session;
+    copyBounded(job.url, sizeof(job.url), url);
+    copyBounded(job.apiKey, sizeof(job.apiKey), key);
+    copyBounded(job.tag, sizeof(job.tag), tag);
+    job.payload = nullptr;
+    job.payloadLen = payloadLen;
+    if (payloadLen < sizeof(job.inlinePayload)) {
+        memcpy(job.inlinePayload, payload, payloadLen);
+        job.inlinePayload[payloadLen] = '\0';
+    } else {
+        job.payload = strndup(payload, payloadLen);
+        if (job.payload == nullptr) {
+            return false;
+        }
+    }
+
+    if (xQueueSend(netJobQueue, &job, 0) != pdTRUE) {
+        free(job.payload);
+        MCC_LOGD("[netWorker] Job queue full, dropping job type %d\n", (int)type);
+        return false;
+    }
+    netJobsPending[type]++;
+    return true;
+}
+
+bool netWorkerSubmit(NetJobType type, const char* url, const char* payload, size_t payloadLen,
+                     uint32_t context, uint32_t session, const char* tag) {
+    return submitJob(type, type, url, apiKey.c_str(), payload, payloadLen, context, session, tag);
+}
+
+bool netWorkerSubmitForward(NetJobType forwardType, const char* url, const char* apiKey,
+                            const char* payload, size_t payloadLen, uint32_t context, uint32_t session) {
+    return submitJob(NET_JOB_GATEWAY_FORWARD, forwardType, url, apiKey, payload, payloadLen, context, session, nullptr);
+}
+
+bool netWorkerPending(NetJobType type) {
+    return netJobsPending[type] > 0;
+}
+
+bool netWorkerIdle() {
+    for (int i = 0; i < NET_JOB_TYPE_COUNT; i++) {
+        if (netJobsPending[i] > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool netWorkerPollResult(NetResult* result) {
+    if (netResultQueue == nullptr || xQueueReceive(netResultQueue, result, 0) != pdTRUE) {
+        return false;
+    }
+    if (netJobsPending[result->type] > 0) {
+        netJobsPending[result->type]--;
+    }
+    // The queue copied the item, so the inline body is only addressable now
+    if (!result->bodyOnHeap) {
+        result->body = result->inlineBody[0] != '\0' ? result->inlineBody : nullptr;
+    }
+    return true;
+}
+
+void netWorkerFreeResult(NetResult* result) {
+    if (result->bodyOnHeap) {
+        free(result->body);
+    }
+    result->body = nullptr;
+    result->bodyOnHeap = false;
+}
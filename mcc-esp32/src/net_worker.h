@@ -0,0 +1,141 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    net_worker.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#ifndef NET_WORKER_H
+#define NET_WORKER_H
+
+#include <Arduino.h>
+
+// Bounded queue depths; submissions fail instead of blocking when full
+#ifndef NET_WORKER_JOB_QUEUE_LEN
+#define NET_WORKER_JOB_QUEUE_LEN 4
+#endif
+#ifndef NET_WORKER_RESULT_QUEUE_LEN
+#define NET_WORKER_RESULT_QUEUE_LEN 4
+#endif
+
+#ifndef NET_WORKER_CORE
+#define NET_WORKER_CORE 0
+#endif
+
+#ifndef NET_WORKER_HTTP_TIMEOUT_MS
+#define NET_WORKER_HTTP_TIMEOUT_MS 10000
+#endif
+
+#define NET_JOB_URL_LEN 192
+#define NET_JOB_API_KEY_LEN 72
+#define NET_JOB_TAG_LEN 40
+
+// Bodies up to this size travel inside the queue item; larger ones (batch uploads,
+// device config) fall back to a heap copy
+#ifndef NET_JOB_PAYLOAD_LEN
+#define NET_JOB_PAYLOAD_LEN 512
+#endif
+#ifndef NET_RESULT_BODY_LEN
+#define NET_RESULT_BODY_LEN 1024
+#endif
+
+enum NetJobType : uint8_t {
+    NET_JOB_UPDATE_DATA,    // Regular distance upload (POST update-data)
+    NET_JOB_CARRY_UPLOAD,   // Pulses carried over deep sleep (POST update-data)
+    NET_JOB_GET_USER_ID,    // ID tag → username lookup (POST get-user-id)
+    NET_JOB_CONFIG_FETCH,   // Periodic device config fetch (GET)
+    NET_JOB_JOURNAL_REPLAY, // Interval from the ride journal (POST update-data)
+    NET_JOB_JOURNAL_BATCH,  // Several journaled intervals (POST update-data-batch)
+    NET_JOB_STATION_BATCH,  // Intervals of the further bikes of a station (POST update-data-batch)
+    NET_JOB_GATEWAY_FORWARD, // Gateway: request of a bike node (see gateway_link.h)
+    NET_JOB_TYPE_COUNT
+};
+
+/**
+ * @brief Result of one HTTP exchange, returned to loop() through the result queue.
+ */
+struct NetResult {
+    NetJobType type;
+    int httpCode;              // HTTP status, HTTPClient error (< 0) on connection failure
+    char* body;                // Response body, nullptr if none; release with netWorkerFreeResult()
+    uint32_t context;          // Value passed at submit (e.g. pulse count snapshot)
+    uint32_t session;          // Caller session counter at submit, detects stale results
+    char tag[NET_JOB_TAG_LEN]; // ID tag the job was submitted for
+    bool bodyOnHeap;           // body is a heap copy instead of inlineBody
+    char inlineBody[NET_RESULT_BODY_LEN];
+};
+
+/**
+ * @brief Starts the network worker task and its job/result queues.
+ *
+ * All HTTP requests of the periodic path run in this task, so TLS handshakes
+ * and slow server responses do not block pulse handling, OLED and RFID in loop().
+ *
+ * @note Side effects: Creates a FreeRTOS task and two queues
+ */
+void netWorkerBegin();
+
+/**
+ * @brief Queues an HTTP request for the worker.
+ *
+ * URL and API key are copied at submit time, so later changes of the globals
+ * do not race with the worker.
+ *
+ * @param type Job type, returned unchanged in the result
+ * @param url Full request URL
+ * @param payload JSON body for POST; empty string sends a GET
+ * @param context Opaque value returned in the result
+ * @param session Caller session counter returned in the result
+ * @param tag ID tag the job belongs to (may be nullptr)
+ * @return false if the queue is full or the worker is not running
+ */
+bool netWorkerSubmit(NetJobType type, const String& url, const String& payload,
+                     uint32_t context, uint32_t session, const char* tag);
+
+/**
+ * @brief Same as above without String arguments; allocation free for bodies up to NET_JOB_PAYLOAD_LEN.
+ *
+ * @param payload JSON body (payloadLen bytes); payloadLen 0 sends a GET
+ */
+bool netWorkerSubmit(NetJobType type, const char* url, const char* payload, size_t payloadLen,
+                     uint32_t context, uint32_t session, const char* tag);
+
+/**
+ * @brief Gateway: queues the request of a node as NET_JOB_GATEWAY_FORWARD.
+ *
+ * The worker handles it like a job of forwardType (e.g. the config filter),
+ * with the API key of the node.
+ *
+ * @param forwardType Job type on the node
+ * @param apiKey API key of the node
+ * @param session Returned in the result; identifies node and request
+ * @return false if the queue is full or the worker is not running
+ */
+bool netWorkerSubmitForward(NetJobType forwardType, const char* url, const char* apiKey,
+                            const char* payload, size_t payloadLen, uint32_t context, uint32_t session);
+
+/**
+ * @brief Returns true while a job of this type is queued, running or its result not yet taken.
+ */
+bool netWorkerPending(NetJobType type);
+
+/**
+ * @brief Returns true if no job is queued, running or waiting for pickup.
+ */
+bool netWorkerIdle();
+
+/**
+ * @brief Takes the next finished result without blocking.
+ *
+ * @param result Receives the result; call netWorkerFreeResult() when done
+ * @return true if a result was available
+ */
+bool netWorkerPollResult(NetResult* result);
+
+/**
+ * @brief Releases the response body of a result.
+ */
+void netWorkerFreeResult(NetResult* result);
+
+#endif
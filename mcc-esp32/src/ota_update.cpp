@@ -0,0 +1,257 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ota_update.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "ota_update.h"
+#include "mcc_log.h"
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
+
+// External variables from main.cpp
+extern Preferences preferences;
+extern bool debugEnabled;
+
+// NVS keys of the download progress (max. 15 characters)
+static const char* OTA_KEY_ID = "ota_id";
+static const char* OTA_KEY_SIZE = "ota_size";
+static const char* OTA_KEY_DONE = "ota_done";
+static const char* OTA_KEY_PART = "ota_part";
+
+static const uint8_t ESP_IMAGE_MAGIC = 0xE9;
+
+// Word aligned for the flash driver; static, so the task stack is not involved
+static uint8_t otaBuffer[OTA_CHUNK_SIZE] __attribute__((aligned(4)));
+
+static const esp_partition_t* otaPartition = nullptr;
+static mbedtls_sha256_context otaSha;
+static bool otaActive = false;
+static bool otaFailed = false;       // Flash or image error: the stored progress is not resumed
+static uint32_t otaImageSize = 0;
+static uint32_t otaFlushed = 0;      // Bytes in flash, always a multiple of OTA_CHUNK_SIZE until the last sector
+static uint32_t otaBuffered = 0;     // Bytes in otaBuffer
+static uint32_t otaSavedAt = 0;      // otaFlushed at the last progress write
+static String otaImageId;
+static char otaExpectedSha[OTA_SHA256_HEX_LEN];
+
+static void clearProgress() {
+    if (preferences.isKey(OTA_KEY_DONE)) {
+        preferences.remove(OTA_KEY_ID);
+        preferences.remove(OTA_KEY_SIZE);
+        preferences.remove(OTA_KEY_DONE);
+        preferences.remove(OTA_KEY_PART);
+    }
+}
+
+static void saveProgress() {
+    if (otaImageSize == 0 || otaFlushed == otaSavedAt) {
+        return;
+    }
+    if (otaSavedAt == 0) {
+        // Identify image and partition once per download
+        preferences.putString(OTA_KEY_ID, otaImageId);
+        preferences.putUInt(OTA_KEY_SIZE, otaImageSize);
+        preferences.putUInt(OTA_KEY_PART, otaPartition->address);
+    }
+    preferences.putUInt(OTA_KEY_DONE, otaFlushed);
+    otaSavedAt = otaFlushed;
+}
+
+/**
+ * @brief Restores the SHA-256 state from the part of the image already in flash.
+ */
+static bool rehashFlash(uint32_t length) {
+    for (uint32_t offset = 0; offset < length; offset += OTA_CHUNK_SIZE) {
+        const uint32_t chunk = min((uint32_t)OTA_CHUNK_SIZE, length - offset);
+        if (esp_partition_read(otaPartition, offset, otaBuffer, chunk) != ESP_OK) {
+            return false;
+        }
+        if (offset == 0 && otaBuffer[0] != ESP_IMAGE_MAGIC) {
+            return false;
+        }
+        mbedtls_sha256_update(&otaSha, otaBuffer, chunk);
+    }
+    return true;
+}
+
+static bool flushBuffer() {
+    if (otaBuffered == 0) {
+        return true;
+    }
+    if (otaFlushed == 0 && otaBuffer[0] != ESP_IMAGE_MAGIC) {
+        // Not a firmware image (e.g. an error page)
+        MCC_LOGE("OTA image does not start with the ESP32 image magic byte");
+        otaFailed = true;
+        return false;
+    }
+    mbedtls_sha256_update(&otaSha, otaBuffer, otaBuffered);
+
+    // Encrypted flash needs 16 byte writes; the padding lies behind the image end
+    uint32_t writeLen = (otaBuffered + 15) & ~15UL;
+    memset(otaBuffer + otaBuffered, 0xFF, writeLen - otaBuffered);
+    esp_err_t err = esp_partition_erase_range(otaPartition, otaFlushed, OTA_CHUNK_SIZE);
+    if (err == ESP_OK) {
+        err = esp_partition_write(otaPartition, otaFlushed, otaBuffer, writeLen);
+    }
+    if (err != ESP_OK) {
+        MCC_LOGE("OTA flash write at offset %u failed (error %d)\n", (unsigned)otaFlushed, (int)err);
+        otaFailed = true;
+        return false;
+    }
+    otaFlushed += otaBuffered;
+    otaBuffered = 0;
+    return true;
+}
+
+int32_t otaBegin(uint32_t imageSize, const char* imageId, const char* sha256Hex, bool restart) {
+    if (otaActive) {
+        mbedtls_sha256_free(&otaSha);
+        otaActive = false;
+    }
+    otaPartition = esp_ota_get_next_update_partition(nullptr);
+    if (otaPartition == nullptr) {
+        MCC_LOGE("No OTA partition available");
+        return -1;
+    }
+    if (imageSize > otaPartition->size) {
+        MCC_LOGE("Firmware image (%u bytes) is larger than the OTA partition (%u bytes)\n",
+                      (unsigned)imageSize, (unsigned)otaPartition->size);
+        return -1;
+    }
+
+    otaImageSize = imageSize;
+    otaImageId = imageId != nullptr ? imageId : "";
+    strlcpy(otaExpectedSha, sha256Hex != nullptr ? sha256Hex : "", sizeof(otaExpectedSha));
+    otaFlushed = 0;
+    otaBuffered = 0;
+    otaSavedAt = 0;
+    otaFailed = false;
+    mbedtls_sha256_init(&otaSha);
+    mbedtls_sha256_starts(&otaSha, 0);
+    otaActive = true;
+
+    uint32_t resumeAt = 0;
+    if (!restart && imageSize > 0 && otaImageId.length() > 0 && preferences.isKey(OTA_KEY_DONE) &&
+        preferences.getString(OTA_KEY_ID, "") == otaImageId &&
+        preferences.getUInt(OTA_KEY_SIZE, 0) == imageSize &&
+        preferences.getUInt(OTA_KEY_PART, 0) == otaPartition->address) {
+        resumeAt = preferences.getUInt(OTA_KEY_DONE, 0);
+        if (resumeAt % OTA_CHUNK_SIZE != 0 || resumeAt >= imageSize || !rehashFlash(resumeAt)) {
+            resumeAt = 0;
+        }
+    }
+
+    if (resumeAt == 0) {
+        // Fresh download: the hash state may contain a failed rehash
+        mbedtls_sha256_free(&otaSha);
+        mbedtls_sha256_init(&otaSha);
+        mbedtls_sha256_starts(&otaSha, 0);
+        clearProgress();
+    } else {
+        otaFlushed = resumeAt;
+        otaSavedAt = resumeAt;
+    }
+
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: [OTA] Writing %u bytes to partition %s, starting at offset %u\n",
+                      (unsigned)imageSize, otaPartition->label, (unsigned)resumeAt);
+    }
+    return (int32_t)resumeAt;
+}
+
+uint32_t otaWriteFromStream(Stream& stream, uint32_t length) {
+    if (!otaActive) {
+        return 0;
+    }
+    stream.setTimeout(OTA_READ_TIMEOUT_MS);
+    uint32_t written = 0;
+    while (written < length) {
+        const uint32_t room = OTA_CHUNK_SIZE - otaBuffered;
+        const uint32_t want = min(room, length - written);
+        // readBytes() waits for data up to the timeout, no polling of available()
+        size_t got = stream.readBytes(otaBuffer + otaBuffered, want);
+        if (got == 0) {
+            MCC_LOGD("[OTA] Stream timeout after %u bytes\n", (unsigned)(otaFlushed + otaBuffered));
+            break;
+        }
+        otaBuffered += got;
+        written += got;
+        if (otaBuffered == OTA_CHUNK_SIZE) {
+            if (!flushBuffer()) {
+                break;
+            }
+            if (otaFlushed - otaSavedAt >= OTA_PROGRESS_SAVE_BYTES) {
+                saveProgress();
+                MCC_LOGD("[OTA] %u / %u bytes\n", (unsigned)otaFlushed, (unsigned)otaImageSize);
+            }
+        }
+    }
+    return written;
+}
+
+uint32_t otaBytesWritten() {
+    return otaFlushed + otaBuffered;
+}
+
+bool otaFinish() {
+    if (!otaActive) {
+        return false;
+    }
+    // Check before the last flush, so an incomplete image keeps sector-aligned progress
+    if (otaImageSize > 0 && otaBytesWritten() != otaImageSize) {
+        MCC_LOGE("OTA image incomplete (%u of %u bytes)\n", (unsigned)otaBytesWritten(), (unsigned)otaImageSize);
+        otaAbort(true);
+        return false;
+    }
+    if (!flushBuffer()) {
+        otaAbort(false);
+        return false;
+    }
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&otaSha, digest);
+    mbedtls_sha256_free(&otaSha);
+    otaActive = false;
+
+    if (otaExpectedSha[0] != '\0') {
+        char actual[OTA_SHA256_HEX_LEN];
+        for (int i = 0; i < 32; i++) {
+            snprintf(actual + 2 * i, 3, "%02x", digest[i]);
+        }
+        if (strcasecmp(actual, otaExpectedSha) != 0) {
+            MCC_LOGE("OTA SHA-256 mismatch (expected %s, got %s)\n", otaExpectedSha, actual);
+            clearProgress();
+            return false;
+        }
+        MCC_LOGD("[OTA] SHA-256 verified");
+    }
+
+    // Also runs the image check of the bootloader (segments, checksum, chip)
+    esp_err_t err = esp_ota_set_boot_partition(otaPartition);
+    clearProgress();
+    if (err != ESP_OK) {
+        MCC_LOGE("OTA image rejected (error %d)\n", (int)err);
+        return false;
+    }
+    return true;
+}
+
+void otaAbort(bool keepProgress) {
+    if (otaActive) {
+        mbedtls_sha256_free(&otaSha);
+        otaActive = false;
+    }
+    if (keepProgress && !otaFailed) {
+        saveProgress();
+        if (debugEnabled && otaSavedAt > 0) {
+            logSerial.printf("DEBUG: [OTA] Download interrupted, resuming at %u bytes next time\n", (unsigned)otaSavedAt);
+        }
+    } else {
+        clearProgress();
+    }
+}
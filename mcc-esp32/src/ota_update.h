@@ -0,0 +1,91 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ota_update.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Streaming firmware update into the next OTA partition. The image is
+ * written one flash sector at a time, hashed with SHA-256 on the way and
+ * only made bootable after the hash matched. The number of bytes already
+ * in flash is kept in NVS, so an interrupted download continues with an
+ * HTTP Range request instead of starting over.
+ */
+
+#ifndef OTA_UPDATE_H
+#define OTA_UPDATE_H
+
+#include <Arduino.h>
+
+// One flash sector: every chunk is erased and written in a single operation
+#define OTA_CHUNK_SIZE 4096
+
+// Progress is written to NVS after this many bytes (limits NVS wear)
+#ifndef OTA_PROGRESS_SAVE_BYTES
+#define OTA_PROGRESS_SAVE_BYTES (64 * 1024)
+#endif
+
+// Maximum wait for the next bytes of the image before the download counts as interrupted
+#ifndef OTA_READ_TIMEOUT_MS
+#define OTA_READ_TIMEOUT_MS 5000
+#endif
+
+// SHA-256 as lowercase hex string
+#define OTA_SHA256_HEX_LEN 65
+
+/**
+ * @brief Starts or resumes writing an image into the next OTA partition.
+ *
+ * A download is resumed if NVS holds progress for the same image (id and
+ * size) and partition. The bytes already in flash are read back to restore
+ * the SHA-256 state.
+ *
+ * @param imageSize Size of the image in bytes (0 = unknown, no resume)
+ * @param imageId Identifies the image across restarts (SHA-256, otherwise the version)
+ * @param sha256Hex Expected SHA-256 (nullptr or "" = only the image check of the bootloader)
+ * @param restart true to discard stored progress (server ignored the Range request)
+ * @return Offset to download from (0 = from the start), or -1 if no OTA partition is available
+ *
+ * @note Hardware interaction: Flash (reads the partial image on resume)
+ */
+int32_t otaBegin(uint32_t imageSize, const char* imageId, const char* sha256Hex, bool restart);
+
+/**
+ * @brief Copies length bytes from the stream into the OTA partition.
+ *
+ * Reads directly into the sector buffer; stops when length bytes were
+ * written, the stream timed out or a flash write failed.
+ *
+ * @return Bytes written by this call
+ *
+ * @note Hardware interaction: Flash (sector erase and write)
+ * @note Side effects: Writes the progress to NVS every OTA_PROGRESS_SAVE_BYTES
+ */
+uint32_t otaWriteFromStream(Stream& stream, uint32_t length);
+
+/**
+ * @brief Bytes of the image written so far (including a resumed part).
+ */
+uint32_t otaBytesWritten();
+
+/**
+ * @brief Verifies size and SHA-256 and makes the new image bootable.
+ *
+ * @return true if the device boots the new firmware after the next restart
+ *
+ * @note Hardware interaction: Flash (last sector, otadata partition)
+ * @note Side effects: Clears the progress in NVS
+ */
+bool otaFinish();
+
+/**
+ * @brief Stops the update.
+ *
+ * @param keepProgress true after a network error: the next download resumes;
+ *                     false after a verification error: the next download starts over
+ *
+ * @note Side effects: Writes or clears the progress in NVS
+ */
+void otaAbort(bool keepProgress);
+
+#endif
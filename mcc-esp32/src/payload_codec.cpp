@@ -0,0 +1,88 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    payload_codec.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "payload_codec.h"
+#include "mcc_log.h"
+
+// External variables from main.cpp
+extern bool debugEnabled;
+
+static const char* CONTENT_TYPE_JSON = "application/json";
+
+/**
+ * @brief Sends the request (GET for an empty body).
+ */
+static int sendRequest(HTTPClient& http, const char* jsonBody, size_t bodyLen) {
+    if (bodyLen == 0) {
+        return http.GET();
+    }
+    http.addHeader("Content-Type", CONTENT_TYPE_JSON);
+    return http.POST((uint8_t*)jsonBody, bodyLen);
+}
+
+int payloadExchange(HTTPClient& http, const String& jsonBody, String* jsonResponse) {
+    int httpCode = sendRequest(http, jsonBody.c_str(), jsonBody.length());
+    if (httpCode > 0) {
+        String body = http.getString();
+        if (jsonResponse != nullptr) {
+            *jsonResponse = body;
+        }
+    }
+    return httpCode;
+}
+
+int payloadExchange(HTTPClient& http, const char* jsonBody, size_t bodyLen,
+                    char* response, size_t responseSize, String* overflow) {
+    int httpCode = sendRequest(http, jsonBody, bodyLen);
+    response[0] = '\0';
+    if (httpCode <= 0) {
+        return httpCode;
+    }
+
+    const int size = http.getSize();
+    WiFiClient* stream = http.getStreamPtr();
+    if (size >= 0 && (size_t)size < responseSize && stream != nullptr) {
+        // Content-Length known: read straight into the caller's buffer
+        size_t got = size > 0 ? stream->readBytes(response, size) : 0;
+        response[got] = '\0';
+        return httpCode;
+    }
+
+    // Chunked or too large: HTTPClient needs the heap here
+    String body = http.getString();
+    if (body.length() < responseSize) {
+        memcpy(response, body.c_str(), body.length() + 1);
+    } else if (overflow != nullptr) {
+        *overflow = body;
+    } else if (debugEnabled) {
+        logSerial.printf("DEBUG: [payloadCodec] Response of %u bytes does not fit into %u bytes, dropped\n",
+                      (unsigned)body.length(), (unsigned)responseSize);
+    }
+    return httpCode;
+}
+
+int payloadExchangeFiltered(HTTPClient& http, const char* jsonBody, size_t bodyLen,
+                            JsonDocument& doc, const JsonDocument& filter, DeserializationError* error) {
+    int httpCode = sendRequest(http, jsonBody, bodyLen);
+    *error = DeserializationError::EmptyInput;
+    if (httpCode != HTTP_CODE_OK) {
+        return httpCode;
+    }
+
+    WiFiClient* stream = http.getStreamPtr();
+    if (http.getSize() >= 0 && stream != nullptr) {
+        *error = deserializeJson(doc, *stream, DeserializationOption::Filter(filter));
+    } else {
+        String body = http.getString();
+        *error = deserializeJson(doc, body.c_str(), body.length(), DeserializationOption::Filter(filter));
+    }
+    if (*error && debugEnabled) {
+        logSerial.printf("DEBUG: [payloadCodec] Response parse error: %s\n", error->c_str());
+    }
+    return httpCode;
+}
@@ -0,0 +1,63 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    payload_codec.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Sends JSON request bodies and reads the responses of the API requests,
+ * into caller buffers or straight from the stream with a field filter.
+ */
+
+#ifndef PAYLOAD_CODEC_H
+#define PAYLOAD_CODEC_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <ArduinoJson.h>
+
+/**
+ * @brief Sends a request prepared with HttpSession::begin() and returns the response as JSON.
+ *
+ * Headers other than Content-Type (e.g. X-Api-Key) must be added before.
+ *
+ * @param http HTTPClient of the current HttpSession
+ * @param jsonBody Request body; empty string sends a GET
+ * @param jsonResponse Receives the response body as JSON text (may be nullptr)
+ * @return HTTP status code, or a negative HTTPClient error
+ */
+int payloadExchange(HTTPClient& http, const String& jsonBody, String* jsonResponse);
+
+/**
+ * @brief Same as above with caller buffers, for the periodic upload path.
+ *
+ * A JSON response with Content-Length is read directly into response without
+ * heap allocation. Chunked responses still pass through a String; if they
+ * do not fit into response they are moved to overflow.
+ *
+ * @param jsonBody Request body (bodyLen bytes); bodyLen 0 sends a GET
+ * @param response Receives the NUL-terminated JSON response (empty if none or moved)
+ * @param responseSize Size of response in bytes
+ * @param overflow Receives a response that does not fit (may be nullptr: dropped)
+ * @return HTTP status code, or a negative HTTPClient error
+ */
+int payloadExchange(HTTPClient& http, const char* jsonBody, size_t bodyLen,
+                    char* response, size_t responseSize, String* overflow);
+
+/**
+ * @brief Same as above, parsing a 200 response straight from the stream into doc.
+ *
+ * Only the fields selected by filter are kept, so memory use is bounded by
+ * the capacity of doc instead of the size of the body. HTTPClient does not
+ * decode chunked transfer encoding on its stream, so a chunked response is
+ * read into a String first (still parsed with the filter).
+ *
+ * @param doc Receives the filtered response
+ * @param filter ArduinoJson filter document
+ * @param error Receives the parse result; DeserializationError::EmptyInput if not HTTP 200
+ * @return HTTP status code, or a negative HTTPClient error
+ */
+int payloadExchangeFiltered(HTTPClient& http, const char* jsonBody, size_t bodyLen,
+                            JsonDocument& doc, const JsonDocument& filter, DeserializationError* error);
+
+#endif
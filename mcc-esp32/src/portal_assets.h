@@ -0,0 +1,73 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    portal_assets.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Generated by scripts/build_portal_assets.py from portal/ - do not edit.
+ * Static files of the config portal, gzip compressed, kept in flash.
+ */
+
+#ifndef PORTAL_ASSETS_H
+#define PORTAL_ASSETS_H
+
+#include <Arduino.h>
+
+// style.css: 534 bytes, 289 bytes compressed
+static const uint8_t PORTAL_STYLE_CSS_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x7d, 0x90, 0xcb, 0x4e, 0xc3, 0x30,
+    0x10, 0x45, 0xf7, 0x7c, 0x45, 0xd5, 0x8a, 0x5d, 0x83, 0x9c, 0x8a, 0x97, 0x5c, 0xb1, 0xe0, 0x3b,
+    0x10, 0x0b, 0x3f, 0xc6, 0xc9, 0xa8, 0xce, 0x38, 0xb2, 0xc7, 0x4a, 0x4a, 0xc4, 0xbf, 0xe3, 0xb4,
+    0x05, 0x95, 0x8a, 0x22, 0x6f, 0x3c, 0x77, 0x5e, 0xe7, 0x8e, 0x0e, 0x76, 0x3f, 0xb9, 0x40, 0x5c,
+    0x39, 0xd5, 0xa1, 0xdf, 0xcb, 0xd7, 0x88, 0xca, 0xaf, 0x93, 0xa2, 0x54, 0x25, 0x88, 0xe8, 0xb6,
+    0x9d, 0x8a, 0x0d, 0x92, 0x54, 0x99, 0x43, 0xf9, 0x8f, 0xd5, 0x80, 0x96, 0x5b, 0xf9, 0x28, 0x44,
+    0x3f, 0x6e, 0x7b, 0x65, 0x2d, 0x52, 0x23, 0x37, 0x73, 0xf0, 0x79, 0x73, 0x67, 0xca, 0x20, 0x85,
+    0x04, 0x71, 0xd2, 0xca, 0xec, 0x9a, 0x18, 0x32, 0x59, 0xb9, 0x72, 0xf7, 0xf3, 0xfb, 0x5d, 0xac,
+    0x43, 0xb4, 0x10, 0xab, 0xa8, 0x2c, 0xe6, 0x24, 0xeb, 0xa3, 0x34, 0x56, 0x09, 0x3f, 0xe6, 0x92,
+    0x53, 0xb6, 0x28, 0x65, 0x6a, 0xbb, 0x99, 0x18, 0x46, 0xae, 0x94, 0xc7, 0x86, 0xa4, 0x01, 0x62,
+    0x88, 0x45, 0xf6, 0x4a, 0x83, 0x3f, 0xa2, 0x0f, 0x80, 0x4d, 0xcb, 0xa5, 0xcb, 0xdb, 0x92, 0x40,
+    0xea, 0x33, 0xbf, 0xf1, 0xbe, 0x87, 0x97, 0xe5, 0xdc, 0xb8, 0x7c, 0x5f, 0x2f, 0xce, 0x35, 0xca,
+    0x9d, 0x86, 0x78, 0xa9, 0x3a, 0xf4, 0x30, 0x6b, 0x09, 0x3c, 0x18, 0x9e, 0x8e, 0x2e, 0x6b, 0x21,
+    0x6e, 0x7f, 0xb8, 0x0f, 0x90, 0xa7, 0x6b, 0x3c, 0xf7, 0xe3, 0x42, 0x9c, 0x4c, 0xc8, 0xba, 0x04,
+    0x29, 0x78, 0xb4, 0x8b, 0x95, 0x31, 0xe6, 0xc2, 0xda, 0xc3, 0x3f, 0xce, 0xce, 0xf7, 0xa7, 0xac,
+    0x3b, 0x3c, 0xb0, 0xea, 0xcc, 0x1c, 0xe8, 0x2a, 0xc1, 0xf9, 0x65, 0x85, 0x78, 0xd2, 0xce, 0x6d,
+    0x4d, 0xf0, 0x21, 0xca, 0xa1, 0x45, 0x86, 0x6f, 0x26, 0x0a, 0x04, 0x7f, 0x90, 0x98, 0x1c, 0x53,
+    0x29, 0xed, 0x03, 0x1e, 0xae, 0x78, 0x0d, 0xec, 0x0b, 0x38, 0x87, 0xba, 0x52, 0x16, 0x02, 0x00,
+    0x00,
+};
+static const size_t PORTAL_STYLE_CSS_GZ_LEN = sizeof(PORTAL_STYLE_CSS_GZ);
+
+// portal.js: 1014 bytes, 428 bytes compressed
+static const uint8_t PORTAL_SCRIPT_JS_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xc5, 0x52, 0x4d, 0x6b, 0xc2, 0x40,
+    0x10, 0xbd, 0xe7, 0x57, 0x4c, 0x4f, 0x89, 0xd4, 0xc6, 0x68, 0x2b, 0x45, 0xa3, 0x97, 0x96, 0x16,
+    0x3c, 0x08, 0x85, 0x42, 0x7b, 0x10, 0x91, 0x35, 0x99, 0x98, 0xc5, 0xdd, 0x8d, 0x24, 0x1b, 0xa5,
+    0x95, 0xfc, 0xf7, 0xee, 0x66, 0xb3, 0x7e, 0x52, 0xe8, 0xad, 0x10, 0xc8, 0xec, 0xbc, 0x79, 0xb3,
+    0xf3, 0x66, 0x5f, 0x52, 0x8a, 0x48, 0xd2, 0x4c, 0x40, 0xb9, 0x89, 0x89, 0xc4, 0xcf, 0x14, 0x91,
+    0xbd, 0xd3, 0x6f, 0x7c, 0xcd, 0x33, 0xfe, 0x96, 0x63, 0x81, 0xd2, 0x6b, 0xc1, 0xde, 0x01, 0xd8,
+    0x92, 0x1c, 0x36, 0x75, 0x02, 0xc6, 0x10, 0x67, 0x51, 0xc9, 0x51, 0x48, 0x7f, 0x85, 0xf2, 0x85,
+    0xa1, 0x0e, 0x9f, 0xbe, 0x26, 0xb1, 0xe7, 0xee, 0x34, 0x7f, 0x51, 0xa8, 0x06, 0x0b, 0x53, 0xec,
+    0xb6, 0xc2, 0x86, 0xcc, 0x89, 0x28, 0x09, 0xfb, 0x1b, 0xd9, 0xb0, 0x68, 0x02, 0x9e, 0xe9, 0xe2,
+    0x6f, 0x09, 0x2b, 0xd1, 0x0c, 0x02, 0x4d, 0x27, 0x93, 0x53, 0xfd, 0x4e, 0x4b, 0x34, 0xad, 0x72,
+    0x2a, 0xc7, 0x49, 0xce, 0x75, 0x19, 0x29, 0x5a, 0xd4, 0xb4, 0x26, 0xff, 0x9f, 0xa8, 0x23, 0xeb,
+    0xc3, 0xce, 0x4f, 0xf2, 0x02, 0x27, 0x42, 0x7a, 0xa7, 0xba, 0x54, 0xad, 0x2a, 0xee, 0x74, 0xe0,
+    0x39, 0xc5, 0x68, 0xad, 0x57, 0xd1, 0x5c, 0x65, 0x54, 0x73, 0x22, 0xa3, 0x14, 0x0b, 0x20, 0x76,
+    0x7c, 0x6f, 0x47, 0x65, 0x0a, 0x7d, 0xce, 0x41, 0x66, 0x0c, 0x73, 0x22, 0x22, 0x6c, 0x9d, 0x09,
+    0x2c, 0xd4, 0x4d, 0xb3, 0x7a, 0x7d, 0xfb, 0xba, 0xc5, 0x10, 0xdc, 0x6e, 0x7f, 0x10, 0xb8, 0x6d,
+    0xe0, 0x7c, 0x08, 0x3a, 0xac, 0xda, 0x17, 0xf0, 0xa0, 0x7b, 0x80, 0x55, 0x78, 0x09, 0xf7, 0x82,
+    0xc7, 0x7e, 0x03, 0xeb, 0xf0, 0x0a, 0xee, 0xf5, 0x1e, 0x2c, 0xac, 0xc2, 0x2b, 0xf8, 0x3e, 0xb0,
+    0xcd, 0x75, 0x58, 0x29, 0x74, 0x5e, 0x4b, 0x36, 0xfb, 0xd1, 0xea, 0x62, 0x35, 0x71, 0x42, 0x58,
+    0x51, 0x3f, 0x6a, 0x92, 0xe5, 0xe0, 0x69, 0x8c, 0xaa, 0x6c, 0x10, 0xaa, 0xdf, 0xc8, 0x0a, 0xf3,
+    0x19, 0x8a, 0x95, 0x4c, 0x55, 0xee, 0xf6, 0xd6, 0x5a, 0x44, 0x5b, 0x67, 0x4a, 0x64, 0xea, 0x93,
+    0x65, 0xe1, 0x9d, 0xae, 0xfb, 0xce, 0xb2, 0x66, 0x74, 0xee, 0x73, 0xde, 0x82, 0xd1, 0x18, 0xfa,
+    0x96, 0x05, 0x67, 0x5e, 0x3a, 0x58, 0xab, 0xae, 0x3d, 0xd8, 0xcb, 0x38, 0xd0, 0x0e, 0x28, 0xf3,
+    0x63, 0x76, 0x99, 0x23, 0x59, 0x9b, 0x43, 0x55, 0xfb, 0xb0, 0xf1, 0xf0, 0x4d, 0x53, 0x6e, 0xaf,
+    0xb9, 0xb8, 0xc4, 0x75, 0x0f, 0xae, 0x55, 0xef, 0x3d, 0x11, 0x54, 0x52, 0xc2, 0x94, 0x5f, 0xec,
+    0xd3, 0x16, 0xc8, 0xd0, 0x78, 0x59, 0x7d, 0x1b, 0xb2, 0x42, 0x60, 0x19, 0x89, 0x9d, 0x1d, 0x15,
+    0x71, 0xb6, 0xf3, 0x33, 0xa1, 0x4f, 0x7a, 0x55, 0x8d, 0xe3, 0x1b, 0x6b, 0xff, 0xe6, 0xfb, 0xd0,
+    0xa9, 0x42, 0xe7, 0x07, 0xb3, 0xa7, 0x50, 0x58, 0xf6, 0x03, 0x00, 0x00,
+};
+static const size_t PORTAL_SCRIPT_JS_GZ_LEN = sizeof(PORTAL_SCRIPT_JS_GZ);
+
+#endif
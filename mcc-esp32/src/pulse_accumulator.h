@@ -0,0 +1,54 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    pulse_accumulator.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Folds the 16-bit hardware pulse counter into a 64-bit software total.
+ */
+
+#ifndef PULSE_ACCUMULATOR_H
+#define PULSE_ACCUMULATOR_H
+
+#include <stdint.h>
+
+struct PulseAccumulator {
+    uint64_t folded;     // Sum of all completed hardware counter periods
+    uint64_t lastTotal;  // Last value returned, keeps reads monotonic
+};
+
+static inline void pulseAccumulatorReset(PulseAccumulator* acc) {
+    acc->folded = 0;
+    acc->lastTotal = 0;
+}
+
+/**
+ * @brief Adds one completed hardware counter period (called on the high-limit event).
+ *
+ * @param period Counter value at which the hardware counter wrapped back to zero
+ */
+static inline void pulseAccumulatorFold(PulseAccumulator* acc, uint32_t period) {
+    acc->folded += period;
+}
+
+/**
+ * @brief Combines the folded periods with the current hardware counter value.
+ *
+ * If the hardware counter has already wrapped but the high-limit event has
+ * not been folded yet, the sum would briefly go backwards. The last returned
+ * total is held in that case until the event is processed.
+ *
+ * @param hardwareCount Current value of the hardware counter
+ * @return Monotonic pulse total since the last reset
+ */
+static inline uint64_t pulseAccumulatorTotal(PulseAccumulator* acc, int16_t hardwareCount) {
+    uint64_t total = acc->folded + (uint64_t)(hardwareCount > 0 ? hardwareCount : 0);
+    if (total < acc->lastTotal) {
+        total = acc->lastTotal;
+    }
+    acc->lastTotal = total;
+    return total;
+}
+
+#endif // PULSE_ACCUMULATOR_H
@@ -0,0 +1,219 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    pulse_capture.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "pulse_capture.h"
+#include "pulse_ring.h"
+#include "esp_timer.h"
+
+// External variables from main.cpp
+extern float wheel_size;
+
+// The task wakes at least this often to apply the speed timeout without pulses
+static const uint32_t PULSE_CAPTURE_IDLE_WAKE_MS = 250;
+
+static PulseRing pulseRing;
+static TaskHandle_t pulseCaptureTaskHandle = nullptr;
+static portMUX_TYPE pulseSnapshotMux = portMUX_INITIALIZER_UNLOCKED;
+static PulseSnapshot pulseSnapshot = {0, 0, 0.0f, 0, 0, 0};
+static volatile bool pulseResetRequested = false;
+static RideStats rideStats;  // Guarded by pulseSnapshotMux
+
+// Ride trace ping-pong: the task records into rideTraces[rideTraceActive], loop() reads the
+// other one until its next pulseCaptureTakeTrace() (both guarded by pulseSnapshotMux)
+static RideTrace rideTraces[2];
+static uint8_t rideTraceActive = 0;
+static volatile bool rideTraceOn = false;
+
+// Pulses handed over by pulseCaptureInject(), applied by the task (guarded by pulseSnapshotMux)
+static bool pulseInjectPending = false;
+static uint32_t pulseInjectCount = 0;
+static uint32_t pulseInjectIntervalUs = 0;
+static int64_t pulseInjectLastPulseUs = 0;
+
+static void IRAM_ATTR pulseCaptureISR() {
+    pulseRingPush(&pulseRing, (uint32_t)esp_timer_get_time());
+    if (pulseCaptureTaskHandle != nullptr) {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(pulseCaptureTaskHandle, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+static void pulseCaptureTask(void* arg) {
+    const int pin = (int)(intptr_t)arg;
+
+    // Attach from this task so the interrupt is allocated on the capture core
+    attachInterrupt(digitalPinToInterrupt(pin), pulseCaptureISR, RISING);
+
+    SpeedAverage speedAverage;
+    speedAverageReset(&speedAverage);
+    float speed_kmh = 0.0f;
+    uint32_t pulses = 0;
+    uint32_t merged = 0;
+    uint32_t previousPulse_us = 0;
+    bool hasPreviousPulse = false;
+    unsigned long lastPulseMs = 0;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PULSE_CAPTURE_IDLE_WAKE_MS));
+
+        if (pulseResetRequested) {
+            uint32_t discarded;
+            while (pulseRingPop(&pulseRing, &discarded)) {
+            }
+            speedAverageReset(&speedAverage);
+            speed_kmh = 0.0f;
+            pulses = 0;
+            hasPreviousPulse = false;
+            lastPulseMs = 0;
+            taskENTER_CRITICAL(&pulseSnapshotMux);
+            rideStatsReset(&rideStats);
+            RideTrace* trace = &rideTraces[rideTraceActive];
+            rideTraceBegin(trace, nullptr, trace->limit);
+            taskEXIT_CRITICAL(&pulseSnapshotMux);
+            pulseResetRequested = false;
+        }
+
+        taskENTER_CRITICAL(&pulseSnapshotMux);
+        const bool injected = pulseInjectPending && pulseInjectCount > 0;
+        const uint32_t injectCount = pulseInjectCount;
+        const uint32_t injectIntervalUs = pulseInjectIntervalUs;
+        const int64_t injectLastPulseUs = pulseInjectLastPulseUs;
+        pulseInjectPending = false;
+        pulseInjectCount = 0;
+        if (injected) {
+            // The injected pulses have no timestamps
+            rideTraceInterrupt(&rideTraces[rideTraceActive]);
+        }
+        taskEXIT_CRITICAL(&pulseSnapshotMux);
+        if (injected) {
+            speedAverageReset(&speedAverage);
+            speed_kmh = 0.0f;
+            if (injectIntervalUs >= PULSE_MIN_INTERVAL_US && injectIntervalUs < SPEED_TIMEOUT_MS * 1000UL) {
+                speed_kmh = speedAveragePush(&speedAverage, (wheel_size / (float)injectIntervalUs) * 3600.0f);
+            }
+            previousPulse_us = (uint32_t)injectLastPulseUs;
+            hasPreviousPulse = true;
+            pulses += injectCount;
+            lastPulseMs = (unsigned long)(injectLastPulseUs / 1000);
+        }
+
+        uint32_t timestamp_us;
+        while (pulseRingPop(&pulseRing, &timestamp_us)) {
+            if (hasPreviousPulse) {
+                const uint32_t interval_us = timestamp_us - previousPulse_us;
+                if (interval_us < PULSE_MIN_INTERVAL_US) {
+                    merged++;
+                    continue; // Contact bounce, keep the previous edge as reference
+                }
+                taskENTER_CRITICAL(&pulseSnapshotMux);
+                rideStatsAddInterval(&rideStats, interval_us, (uint32_t)(wheel_size + 0.5f), SPEED_TIMEOUT_MS * 1000UL);
+                taskEXIT_CRITICAL(&pulseSnapshotMux);
+                float newSpeed = 0.0f;
+                if (interval_us < SPEED_TIMEOUT_MS * 1000UL) {
+                    // (mm/us) * 3600 = km/h
+                    newSpeed = (wheel_size / (float)interval_us) * 3600.0f;
+                }
+                speed_kmh = speedAveragePush(&speedAverage, newSpeed);
+            }
+            if (rideTraceOn) {
+                taskENTER_CRITICAL(&pulseSnapshotMux);
+                rideTraceAdd(&rideTraces[rideTraceActive], timestamp_us);
+                taskEXIT_CRITICAL(&pulseSnapshotMux);
+            }
+            previousPulse_us = timestamp_us;
+            hasPreviousPulse = true;
+            pulses++;
+
+            // Rebuild the millis() timebase from the 32-bit edge timestamp
+            const int64_t now_us = esp_timer_get_time();
+            lastPulseMs = (unsigned long)((now_us - (int64_t)((uint32_t)now_us - timestamp_us)) / 1000);
+        }
+
+        // No pulse for SPEED_TIMEOUT_MS → 0 km/h and drop old values from the average
+        if (hasPreviousPulse && !speedAverageEmpty(&speedAverage) &&
+            (uint32_t)esp_timer_get_time() - previousPulse_us >= SPEED_TIMEOUT_MS * 1000UL) {
+            speedAverageReset(&speedAverage);
+            speed_kmh = 0.0f;
+        }
+
+        taskENTER_CRITICAL(&pulseSnapshotMux);
+        if (!pulseResetRequested) {
+            pulseSnapshot.pulses = pulses;
+            pulseSnapshot.lastPulseMs = lastPulseMs;
+            pulseSnapshot.speed_kmh = speed_kmh;
+            pulseSnapshot.speedSamples = (uint8_t)speedAverage.count;
+        }
+        pulseSnapshot.dropped = pulseRing.dropped.load(std::memory_order_relaxed);
+        pulseSnapshot.merged = merged;
+        taskEXIT_CRITICAL(&pulseSnapshotMux);
+    }
+}
+
+void pulseCaptureBegin(int pin) {
+    if (pulseCaptureTaskHandle != nullptr) {
+        return;
+    }
+    pulseRingReset(&pulseRing);
+    rideStatsReset(&rideStats);
+    xTaskCreatePinnedToCore(pulseCaptureTask, "pulse_capture", 3072, (void*)(intptr_t)pin,
+                            PULSE_CAPTURE_TASK_PRIORITY, &pulseCaptureTaskHandle, PULSE_CAPTURE_CORE);
+}
+
+void pulseCaptureReset() {
+    taskENTER_CRITICAL(&pulseSnapshotMux);
+    pulseResetRequested = true;
+    pulseSnapshot.pulses = 0;
+    pulseSnapshot.lastPulseMs = 0;
+    pulseSnapshot.speed_kmh = 0.0f;
+    pulseSnapshot.speedSamples = 0;
+    taskEXIT_CRITICAL(&pulseSnapshotMux);
+    if (pulseCaptureTaskHandle != nullptr) {
+        xTaskNotifyGive(pulseCaptureTaskHandle);
+    }
+}
+
+void pulseCaptureInject(uint32_t pulses, uint32_t lastIntervalUs, uint32_t sinceLastPulseUs) {
+    if (pulses == 0) {
+        return;
+    }
+    taskENTER_CRITICAL(&pulseSnapshotMux);
+    pulseInjectPending = true;
+    pulseInjectCount += pulses;
+    pulseInjectIntervalUs = lastIntervalUs;
+    pulseInjectLastPulseUs = esp_timer_get_time() - (int64_t)sinceLastPulseUs;
+    taskEXIT_CRITICAL(&pulseSnapshotMux);
+    if (pulseCaptureTaskHandle != nullptr) {
+        xTaskNotifyGive(pulseCaptureTaskHandle);
+    }
+}
+
+void pulseCaptureTakeStats(RideStats* out) {
+    taskENTER_CRITICAL(&pulseSnapshotMux);
+    *out = rideStats;
+    rideStatsReset(&rideStats);
+    taskEXIT_CRITICAL(&pulseSnapshotMux);
+}
+
+const RideTrace* pulseCaptureTakeTrace(uint16_t limit) {
+    taskENTER_CRITICAL(&pulseSnapshotMux);
+    const uint8_t done = rideTraceActive;
+    rideTraceActive ^= 1;
+    rideTraceBegin(&rideTraces[rideTraceActive], &rideTraces[done], limit);
+    rideTraceOn = rideTraces[rideTraceActive].limit > 0;
+    taskEXIT_CRITICAL(&pulseSnapshotMux);
+    return &rideTraces[done];
+}
+
+void pulseCaptureGetSnapshot(PulseSnapshot* out) {
+    taskENTER_CRITICAL(&pulseSnapshotMux);
+    *out = pulseSnapshot;
+    taskEXIT_CRITICAL(&pulseSnapshotMux);
+}
@@ -0,0 +1,113 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    pulse_capture.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#ifndef PULSE_CAPTURE_H
+#define PULSE_CAPTURE_H
+
+#include <Arduino.h>
+#include "speed_average.h"
+#include "ride_stats.h"
+#include "ride_trace.h"
+
+// Core and priority of the capture task. loop() runs on ARDUINO_RUNNING_CORE,
+// so by default the capture task is placed on the other core.
+#ifndef PULSE_CAPTURE_CORE
+#if CONFIG_FREERTOS_UNICORE
+#define PULSE_CAPTURE_CORE 0
+#else
+#define PULSE_CAPTURE_CORE (ARDUINO_RUNNING_CORE == 0 ? 1 : 0)
+#endif
+#endif
+
+#ifndef PULSE_CAPTURE_TASK_PRIORITY
+#define PULSE_CAPTURE_TASK_PRIORITY 5
+#endif
+
+const unsigned long SPEED_TIMEOUT_MS = 5000;     // After 5 seconds without pulse → 0 km/h
+const uint32_t PULSE_MIN_INTERVAL_US = 20000;    // Edges closer than 20 ms are contact bounce (>370 km/h at 2075 mm)
+
+/**
+ * @brief Consistent view of the capture state, copied out under a lock.
+ */
+struct PulseSnapshot {
+    uint32_t pulses;          // Edges seen by the ISR since the last reset
+    unsigned long lastPulseMs; // millis() timebase of the last accepted edge, 0 if none
+    float speed_kmh;          // Average over the last SPEED_AVERAGE_COUNT intervals
+    uint8_t speedSamples;     // Intervals in that average, fewer right after a start or stop
+    uint32_t dropped;         // Edges lost because the ring buffer was full
+    uint32_t merged;          // Edges discarded as contact bounce (closer than PULSE_MIN_INTERVAL_US)
+};
+
+/**
+ * @brief Starts the pulse capture task and attaches the sensor edge interrupt.
+ *
+ * The ISR stores a microsecond timestamp of every rising edge in a lock-free
+ * ring buffer. A task pinned to PULSE_CAPTURE_CORE drains the buffer and
+ * derives the speed from the exact edge intervals, independent of how long
+ * loop() is blocked by network or display code. PCNT remains the
+ * authoritative pulse counter for distance.
+ *
+ * @param pin GPIO of the wheel sensor (same pin as the PCNT input)
+ *
+ * @note Hardware interaction: GPIO interrupt on pin
+ * @note Side effects: Creates a FreeRTOS task, reads global wheel_size
+ */
+void pulseCaptureBegin(int pin);
+
+/**
+ * @brief Clears speed history and pulse count, e.g. after an ID tag change.
+ *
+ * The reset is performed by the capture task; it is visible in the next snapshot.
+ */
+void pulseCaptureReset();
+
+/**
+ * @brief Copies the current capture state.
+ *
+ * @param out Destination snapshot
+ *
+ * @note Safe to call from any task
+ */
+void pulseCaptureGetSnapshot(PulseSnapshot* out);
+
+/**
+ * @brief Returns the ride statistics since the last call and starts a new interval.
+ *
+ * @param out Destination, fed with every accepted pulse interval
+ *
+ * @note Safe to call from any task
+ */
+void pulseCaptureTakeStats(RideStats* out);
+
+/**
+ * @brief Returns the ride trace since the last call and starts a new one.
+ *
+ * The new trace continues from the last recorded pulse, so consecutive
+ * traces cover the ride without gaps. The returned trace stays unchanged
+ * until the next call.
+ *
+ * @param limit Bytes the new trace may use (trace_max_bytes), 0 stops recording
+ * @return Finished trace; empty (count 0) while recording was off
+ *
+ * @note Call from loop() only
+ */
+const RideTrace* pulseCaptureTakeTrace(uint16_t limit);
+
+/**
+ * @brief Feeds pulses that were counted while the capture ISR could not see the pin.
+ *
+ * The speed average restarts from the given interval, and the last pulse
+ * becomes the reference for the next edge.
+ *
+ * @param pulses Number of pulses counted elsewhere (e.g. by the ULP during a riding sleep)
+ * @param lastIntervalUs Time between the last two of them, 0 if unknown
+ * @param sinceLastPulseUs Time since the last of them
+ */
+void pulseCaptureInject(uint32_t pulses, uint32_t lastIntervalUs, uint32_t sinceLastPulseUs);
+
+#endif
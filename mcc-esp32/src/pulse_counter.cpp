@@ -0,0 +1,152 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    pulse_counter.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "pulse_counter.h"
+#include "pulse_accumulator.h"
+#include "esp_attr.h"
+
+// Marks valid RTC memory content (RTC RAM is random after power-on)
+static const uint32_t PULSE_CARRY_MAGIC = 0x4D434350; // "MCCP"
+
+struct PulseCarry {
+    uint32_t magic;
+    uint32_t unsentPulses;
+    uint64_t lifetimePulses;
+    char idTag[PULSE_CARRY_ID_TAG_LEN];
+};
+
+RTC_DATA_ATTR static PulseCarry pulseCarry;
+
+static PulseAccumulator pulseAccumulator[PULSE_COUNTER_MAX_CHANNELS];
+static bool channelStarted[PULSE_COUNTER_MAX_CHANNELS] = {false};
+static bool isrServiceInstalled = false;
+static portMUX_TYPE pulseCounterMux = portMUX_INITIALIZER_UNLOCKED;
+
+// arg: channel number, equal to the PCNT unit
+static void IRAM_ATTR pulseCounterOverflowISR(void* arg) {
+    portENTER_CRITICAL_ISR(&pulseCounterMux);
+    pulseAccumulatorFold(&pulseAccumulator[(uintptr_t)arg], PULSE_COUNTER_HIGH_LIMIT);
+    portEXIT_CRITICAL_ISR(&pulseCounterMux);
+}
+
+static void configureUnit(uint8_t channel, int pin) {
+    const pcnt_unit_t unit = (pcnt_unit_t)channel;
+    pulseAccumulatorReset(&pulseAccumulator[channel]);
+
+    pcnt_config_t pcnt_config = {};
+    pcnt_config.pulse_gpio_num = pin;
+    pcnt_config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+    pcnt_config.unit = unit;
+    pcnt_config.channel = PCNT_CHANNEL_0;
+    pcnt_config.counter_h_lim = PULSE_COUNTER_HIGH_LIMIT;
+    pcnt_config.counter_l_lim = 0;
+    pcnt_config.pos_mode = PCNT_COUNT_INC;
+    pcnt_config.neg_mode = PCNT_COUNT_DIS;
+    pcnt_config.lctrl_mode = PCNT_MODE_KEEP;
+    pcnt_config.hctrl_mode = PCNT_MODE_KEEP;
+    pcnt_unit_config(&pcnt_config);
+    pcnt_counter_pause(unit);
+    pcnt_counter_clear(unit);
+    // 1000 clock cycles / 80,000,000 clock cycles per second = 0.0000125 seconds or 12.5 microseconds
+    pcnt_set_filter_value(unit, 1023); // wait number of clock cycles, max 1023 cycles definable
+    pcnt_filter_enable(unit);
+
+    // Counter resets to zero on H_LIM, the ISR adds the completed period
+    pcnt_event_enable(unit, PCNT_EVT_H_LIM);
+    if (!isrServiceInstalled) {
+        pcnt_isr_service_install(0);
+        isrServiceInstalled = true;
+    }
+    pcnt_isr_handler_add(unit, pulseCounterOverflowISR, (void*)(uintptr_t)channel);
+
+    // Start the PCNT counter so it can detect pulses
+    pcnt_counter_resume(unit);
+    channelStarted[channel] = true;
+}
+
+void pulseCounterBegin(int pin) {
+    if (pulseCarry.magic != PULSE_CARRY_MAGIC) {
+        // Power-on reset: RTC memory content is undefined
+        memset(&pulseCarry, 0, sizeof(pulseCarry));
+        pulseCarry.magic = PULSE_CARRY_MAGIC;
+    }
+    configureUnit(0, pin);
+}
+
+bool pulseCounterBeginChannel(uint8_t channel, int pin) {
+    if (channel == 0 || channel >= PULSE_COUNTER_MAX_CHANNELS || channelStarted[channel]) {
+        return false;
+    }
+    configureUnit(channel, pin);
+    return true;
+}
+
+uint64_t pulseCounterReadChannel(uint8_t channel) {
+    if (channel >= PULSE_COUNTER_MAX_CHANNELS || !channelStarted[channel]) {
+        return 0;
+    }
+    int16_t hardwareCount = 0;
+    portENTER_CRITICAL(&pulseCounterMux);
+    pcnt_get_counter_value((pcnt_unit_t)channel, &hardwareCount);
+    uint64_t total = pulseAccumulatorTotal(&pulseAccumulator[channel], hardwareCount);
+    portEXIT_CRITICAL(&pulseCounterMux);
+    return total;
+}
+
+uint64_t pulseCounterRead() {
+    return pulseCounterReadChannel(0);
+}
+
+void pulseCounterAdd(uint32_t pulses) {
+    portENTER_CRITICAL(&pulseCounterMux);
+    pulseAccumulatorFold(&pulseAccumulator[0], pulses);
+    portEXIT_CRITICAL(&pulseCounterMux);
+}
+
+void pulseCounterClear() {
+    uint64_t total = pulseCounterRead();
+    portENTER_CRITICAL(&pulseCounterMux);
+    pcnt_counter_clear(PCNT_UNIT);
+    pulseAccumulatorReset(&pulseAccumulator[0]);
+    pulseCarry.lifetimePulses += total;
+    portEXIT_CRITICAL(&pulseCounterMux);
+}
+
+uint64_t pulseCounterLifetime() {
+    return pulseCarry.lifetimePulses + pulseCounterRead();
+}
+
+void pulseCounterSaveForSleep(uint32_t unsentPulses, const char* idTag) {
+    pulseCarry.lifetimePulses += pulseCounterRead();
+    // Pulses from an earlier sleep cycle that could not be uploaded yet stay included
+    if (unsentPulses > 0 && idTag != nullptr && idTag[0] != '\0') {
+        if (pulseCarry.unsentPulses > 0 && strncmp(pulseCarry.idTag, idTag, PULSE_CARRY_ID_TAG_LEN) != 0) {
+            // Only one pending carry is kept; the rider of the last session wins
+            pulseCarry.unsentPulses = 0;
+        }
+        pulseCarry.unsentPulses += unsentPulses;
+        strncpy(pulseCarry.idTag, idTag, PULSE_CARRY_ID_TAG_LEN - 1);
+        pulseCarry.idTag[PULSE_CARRY_ID_TAG_LEN - 1] = '\0';
+    }
+    pulseCarry.magic = PULSE_CARRY_MAGIC;
+}
+
+bool pulseCounterPeekCarry(uint32_t* unsentPulses, char* idTag) {
+    if (pulseCarry.magic != PULSE_CARRY_MAGIC || pulseCarry.unsentPulses == 0) {
+        return false;
+    }
+    *unsentPulses = pulseCarry.unsentPulses;
+    strncpy(idTag, pulseCarry.idTag, PULSE_CARRY_ID_TAG_LEN);
+    idTag[PULSE_CARRY_ID_TAG_LEN - 1] = '\0';
+    return true;
+}
+
+void pulseCounterClearCarry() {
+    pulseCarry.unsentPulses = 0;
+    pulseCarry.idTag[0] = '\0';
+}
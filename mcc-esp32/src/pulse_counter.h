@@ -0,0 +1,116 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    pulse_counter.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#ifndef PULSE_COUNTER_H
+#define PULSE_COUNTER_H
+
+#include <Arduino.h>
+#include "driver/pcnt.h"
+
+// Configure PCNT unit (channel 0, the bike on SENSOR_PIN); channel n uses PCNT unit n
+#define PCNT_UNIT PCNT_UNIT_0
+
+// PCNT units in use at most (the ESP32 has 8)
+#ifndef PULSE_COUNTER_MAX_CHANNELS
+#define PULSE_COUNTER_MAX_CHANNELS 4
+#endif
+
+// Hardware counter wraps to zero at this value and raises the H_LIM event
+#ifndef PULSE_COUNTER_HIGH_LIMIT
+#define PULSE_COUNTER_HIGH_LIMIT 30000
+#endif
+
+// Maximum length of an ID tag kept across deep sleep (including terminator)
+#define PULSE_CARRY_ID_TAG_LEN 40
+
+/**
+ * @brief Configures the PCNT unit and the high-limit overflow interrupt.
+ *
+ * The hardware counter only has 16 bits. Every time it reaches
+ * PULSE_COUNTER_HIGH_LIMIT the H_LIM event ISR folds it into a 64-bit
+ * software total, so long sessions and failed upload streaks cannot wrap.
+ *
+ * @param pin GPIO of the wheel sensor
+ *
+ * @note Hardware interaction: PCNT_UNIT, pin
+ * @note Side effects: Installs the PCNT ISR service
+ */
+void pulseCounterBegin(int pin);
+
+/**
+ * @brief Configures one more PCNT unit for a further bike of a multi-bike station.
+ *
+ * Same filter and overflow handling as channel 0. The channel is never
+ * cleared and takes no part in the deep sleep carry and the lifetime total.
+ *
+ * @param channel 1 .. PULSE_COUNTER_MAX_CHANNELS - 1
+ * @param pin GPIO of the wheel sensor
+ * @return false if the channel number is out of range
+ *
+ * @note Hardware interaction: PCNT unit <channel>, pin
+ */
+bool pulseCounterBeginChannel(uint8_t channel, int pin);
+
+/**
+ * @brief Returns the pulse total since the last pulseCounterClear().
+ *
+ * @return Monotonic 64-bit pulse total
+ */
+uint64_t pulseCounterRead();
+
+/**
+ * @brief Returns the pulse total of a channel (channel 0: same as pulseCounterRead()).
+ *
+ * @return Monotonic 64-bit pulse total, 0 for channels that were not started
+ */
+uint64_t pulseCounterReadChannel(uint8_t channel);
+
+/**
+ * @brief Adds pulses that were counted elsewhere while the PCNT unit was stopped.
+ *
+ * Used for the pulses counted by the ULP coprocessor during a riding sleep.
+ */
+void pulseCounterAdd(uint32_t pulses);
+
+/**
+ * @brief Clears the hardware counter and the software total.
+ *
+ * The cleared pulses are added to the lifetime total.
+ */
+void pulseCounterClear();
+
+/**
+ * @brief Pulses counted since power-on, including all sessions and deep sleep cycles.
+ */
+uint64_t pulseCounterLifetime();
+
+/**
+ * @brief Keeps not yet uploaded pulses in RTC memory before deep sleep.
+ *
+ * @param unsentPulses Pulses counted since the last successful upload
+ * @param idTag ID tag the pulses belong to
+ *
+ * @note Side effects: Writes RTC_DATA_ATTR memory, adds the session to the lifetime total
+ */
+void pulseCounterSaveForSleep(uint32_t unsentPulses, const char* idTag);
+
+/**
+ * @brief Returns pulses carried over from before deep sleep, if any.
+ *
+ * @param unsentPulses Receives the carried pulse count
+ * @param idTag Receives the ID tag the pulses belong to (PULSE_CARRY_ID_TAG_LEN bytes)
+ * @return true if a carry is pending
+ */
+bool pulseCounterPeekCarry(uint32_t* unsentPulses, char* idTag);
+
+/**
+ * @brief Discards the carried pulses after they were uploaded (or rejected for good).
+ */
+void pulseCounterClearCarry();
+
+#endif
@@ -0,0 +1,322 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    pulse_replay.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "pulse_replay.h"
+#include "mcc_log.h"
+
+#ifdef ENABLE_PULSE_REPLAY
+
+#include <LittleFS.h>
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "pulse_capture.h"
+#include "pulse_counter.h"
+
+// External variables from main.cpp
+extern float wheel_size;
+
+// Generator polls at this period while the target speed is 0
+static const uint32_t REPLAY_IDLE_POLL_US = 10000;
+// Measured speed is sampled at this period once the average is settled
+static const unsigned long REPLAY_SAMPLE_MS = 200;
+// After the last step: time for the last edge to pass the PCNT filter and the capture task
+static const unsigned long REPLAY_DRAIN_MS = 200;
+
+struct ReplayStep {
+    uint16_t seconds;
+    float speed_kmh;
+};
+
+// Stop-and-go ride used when no profile file is on LittleFS
+static const ReplayStep DEFAULT_PROFILE[] = {
+    {5, 0.0f}, {10, 12.0f}, {20, 22.0f}, {10, 28.0f}, {5, 15.0f}, {8, 0.0f},
+    {15, 25.0f}, {10, 35.0f}, {10, 18.0f}, {8, 0.0f}
+};
+
+enum ReplayState : uint8_t {
+    REPLAY_IDLE = 0,
+    REPLAY_WAITING,
+    REPLAY_RUNNING,
+    REPLAY_DRAINING
+};
+
+static ReplayStep replaySteps[PULSE_REPLAY_MAX_STEPS];
+static uint8_t replayStepCount = 0;
+static ReplayState replayState = REPLAY_IDLE;
+
+// Shared with the timer callback (esp_timer task)
+static esp_timer_handle_t replayTimer = nullptr;
+static volatile uint32_t replayIntervalUs = 0;   // 0 = no pulses
+static volatile uint32_t replayGenerated = 0;
+static bool replayContactClosed = false;         // Only touched by the callback
+
+// Per step, only touched from loop()
+static uint8_t replayStepIndex = 0;
+static unsigned long replayStepStartMs = 0;
+static unsigned long replayLastSampleMs = 0;
+static uint32_t replayStepGenerated = 0;         // Generator count at the step start
+static uint64_t replayStepCounted = 0;           // PCNT lifetime count at the step start
+static uint32_t replayStepDropped = 0;
+static uint32_t replayStepMerged = 0;
+static uint32_t replaySamples = 0;
+static float replayErrorSum = 0.0f;              // km/h
+static float replayErrorMax = 0.0f;              // km/h
+static float replaySpeedSum = 0.0f;
+
+// Whole run
+static uint32_t replayTotalGenerated = 0;
+static uint64_t replayTotalCounted = 0;
+static float replayWorstErrorPercent = 0.0f;
+
+static void IRAM_ATTR setContact(bool closed) {
+    gpio_set_level((gpio_num_t)PULSE_REPLAY_PIN, closed ? 0 : 1);
+}
+
+/**
+ * @brief Closes the contact for PULSE_REPLAY_WIDTH_US, then opens it; the opening is the rising edge.
+ */
+static void replayTimerCallback(void* arg) {
+    const uint32_t interval = replayIntervalUs;
+    if (replayContactClosed) {
+        setContact(false);
+        replayContactClosed = false;
+        replayGenerated++;
+        esp_timer_start_once(replayTimer, interval > PULSE_REPLAY_WIDTH_US ? interval - PULSE_REPLAY_WIDTH_US
+                                                                          : REPLAY_IDLE_POLL_US);
+    } else if (interval == 0) {
+        esp_timer_start_once(replayTimer, REPLAY_IDLE_POLL_US);
+    } else {
+        setContact(true);
+        replayContactClosed = true;
+        esp_timer_start_once(replayTimer, PULSE_REPLAY_WIDTH_US);
+    }
+}
+
+static uint32_t intervalForSpeed(float speed_kmh) {
+    if (speed_kmh <= 0.0f || wheel_size <= 0.0f) {
+        return 0;
+    }
+    // Inverse of speed = (wheel_size / interval_us) * 3600 in the capture task
+    const float interval = wheel_size * 3600.0f / speed_kmh;
+    return interval < 2.0f * PULSE_REPLAY_WIDTH_US ? 2 * PULSE_REPLAY_WIDTH_US : (uint32_t)interval;
+}
+
+static void addStep(uint16_t seconds, float speed_kmh) {
+    if (replayStepCount < PULSE_REPLAY_MAX_STEPS && seconds > 0) {
+        replaySteps[replayStepCount].seconds = seconds;
+        replaySteps[replayStepCount].speed_kmh = speed_kmh;
+        replayStepCount++;
+    }
+}
+
+#ifndef PULSE_REPLAY_SWEEP_MAX_KMH
+/**
+ * @brief Reads the steps from the recorded profile on LittleFS.
+ *
+ * @return false if the file is missing or holds no valid line
+ */
+static bool loadProfile() {
+    if (!LittleFS.exists(PULSE_REPLAY_PROFILE_PATH)) {
+        return false;
+    }
+    File f = LittleFS.open(PULSE_REPLAY_PROFILE_PATH, "r");
+    if (!f) {
+        return false;
+    }
+    char line[32];
+    size_t len = 0;
+    int c;
+    do {
+        c = f.read();
+        if (c >= 0 && c != '\n' && c != '\r') {
+            if (len < sizeof(line) - 1) {
+                line[len++] = (char)c;
+            }
+            continue;
+        }
+        line[len] = '\0';
+        unsigned seconds = 0;
+        float speed = 0.0f;
+        if (line[0] != '#' && sscanf(line, "%u,%f", &seconds, &speed) == 2 && seconds <= 0xFFFF) {
+            addStep((uint16_t)seconds, speed);
+        }
+        len = 0;
+    } while (c >= 0);
+    f.close();
+    return replayStepCount > 0;
+}
+#endif
+
+static void startStep(uint8_t index) {
+    PulseSnapshot snapshot;
+    pulseCaptureGetSnapshot(&snapshot);
+    replayStepIndex = index;
+    replayStepStartMs = millis();
+    replayLastSampleMs = replayStepStartMs;
+    replayStepGenerated = replayGenerated;
+    replayStepCounted = pulseCounterLifetime();
+    replayStepDropped = snapshot.dropped;
+    replayStepMerged = snapshot.merged;
+    replaySamples = 0;
+    replayErrorSum = 0.0f;
+    replayErrorMax = 0.0f;
+    replaySpeedSum = 0.0f;
+    replayIntervalUs = intervalForSpeed(replaySteps[index].speed_kmh);
+}
+
+static void finishStep() {
+    const ReplayStep& step = replaySteps[replayStepIndex];
+    PulseSnapshot snapshot;
+    pulseCaptureGetSnapshot(&snapshot);
+    const uint32_t generated = replayGenerated - replayStepGenerated;
+    const uint64_t counted = pulseCounterLifetime() - replayStepCounted;
+    replayTotalGenerated += generated;
+    replayTotalCounted += counted;
+
+    const float meanSpeed = replaySamples > 0 ? replaySpeedSum / replaySamples : 0.0f;
+    const float meanError = replaySamples > 0 ? replayErrorSum / replaySamples : 0.0f;
+    const float maxErrorPercent = step.speed_kmh > 0.0f ? replayErrorMax * 100.0f / step.speed_kmh : 0.0f;
+    if (maxErrorPercent > replayWorstErrorPercent) {
+        replayWorstErrorPercent = maxErrorPercent;
+    }
+
+    // An edge in flight at the step boundary is counted in the next step; the totals are exact
+    logSerial.printf("REPLAY: step %u/%u %.1f km/h (%u us) for %u s | generated %u, counted %u (diff %d) | "
+                  "speed mean %.2f km/h, error mean %.2f km/h, max %.2f km/h (%.1f %%), %u samples | "
+                  "dropped %u, merged %u\n",
+                  (unsigned)replayStepIndex + 1, (unsigned)replayStepCount, step.speed_kmh,
+                  (unsigned)intervalForSpeed(step.speed_kmh), (unsigned)step.seconds,
+                  (unsigned)generated, (unsigned)counted, (int)((int64_t)counted - generated),
+                  meanSpeed, meanError, replayErrorMax, maxErrorPercent, (unsigned)replaySamples,
+                  (unsigned)(snapshot.dropped - replayStepDropped), (unsigned)(snapshot.merged - replayStepMerged));
+}
+
+/**
+ * @brief Compares the measured speed with the target once the moving average only holds pulses of this step.
+ */
+static void sampleSpeed(unsigned long now) {
+    if (now - replayLastSampleMs < REPLAY_SAMPLE_MS) {
+        return;
+    }
+    replayLastSampleMs = now;
+
+    const ReplayStep& step = replaySteps[replayStepIndex];
+    const uint32_t interval = intervalForSpeed(step.speed_kmh);
+    // Standstill is only reported as 0 km/h after SPEED_TIMEOUT_MS
+    const unsigned long settleMs = interval == 0 ? SPEED_TIMEOUT_MS + REPLAY_SAMPLE_MS
+                                                 : (unsigned long)(SPEED_AVERAGE_COUNT + 1) * interval / 1000;
+    if (now - replayStepStartMs < settleMs) {
+        return;
+    }
+
+    PulseSnapshot snapshot;
+    pulseCaptureGetSnapshot(&snapshot);
+    const float error = fabsf(snapshot.speed_kmh - step.speed_kmh);
+    replaySpeedSum += snapshot.speed_kmh;
+    replayErrorSum += error;
+    if (error > replayErrorMax) {
+        replayErrorMax = error;
+    }
+    replaySamples++;
+}
+
+void pulseReplayBegin() {
+    if (replayState != REPLAY_IDLE) {
+        return;
+    }
+
+    replayStepCount = 0;
+#ifdef PULSE_REPLAY_SWEEP_MAX_KMH
+    for (float speed = PULSE_REPLAY_SWEEP_MIN_KMH; speed <= PULSE_REPLAY_SWEEP_MAX_KMH + 0.01f;
+         speed += PULSE_REPLAY_SWEEP_STEP_KMH) {
+        addStep(PULSE_REPLAY_SWEEP_STEP_SEC, speed);
+    }
+    const char* source = "sweep";
+#else
+    const char* source = PULSE_REPLAY_PROFILE_PATH;
+    if (!loadProfile()) {
+        for (size_t i = 0; i < sizeof(DEFAULT_PROFILE) / sizeof(DEFAULT_PROFILE[0]); i++) {
+            addStep(DEFAULT_PROFILE[i].seconds, DEFAULT_PROFILE[i].speed_kmh);
+        }
+        source = "built-in profile";
+    }
+#endif
+    if (replayStepCount == 0) {
+        MCC_LOGE("pulseReplayBegin() - No replay steps");
+        return;
+    }
+
+    const gpio_num_t pin = (gpio_num_t)PULSE_REPLAY_PIN;
+    // Open drain keeps the input path of PCNT and the capture ISR on the same pin
+    gpio_set_direction(pin, PULSE_REPLAY_PIN == PulseMeasurePin ? GPIO_MODE_INPUT_OUTPUT_OD : GPIO_MODE_OUTPUT);
+    setContact(false);
+
+    esp_timer_create_args_t args = {};
+    args.callback = replayTimerCallback;
+    args.name = "pulse_replay";
+    if (esp_timer_create(&args, &replayTimer) != ESP_OK) {
+        MCC_LOGE("pulseReplayBegin() - Could not create timer");
+        return;
+    }
+    replayIntervalUs = 0;
+    esp_timer_start_once(replayTimer, REPLAY_IDLE_POLL_US);
+
+    replayState = REPLAY_WAITING;
+    replayStepStartMs = millis();
+    logSerial.printf("REPLAY: %u steps from %s on GPIO %d (wheel %.0f mm, pulse width %u us), starting in %u s\n",
+                  (unsigned)replayStepCount, source, (int)PULSE_REPLAY_PIN, wheel_size,
+                  (unsigned)PULSE_REPLAY_WIDTH_US, (unsigned)(PULSE_REPLAY_START_DELAY_MS / 1000));
+}
+
+void pulseReplayLoop() {
+    const unsigned long now = millis();
+    switch (replayState) {
+        case REPLAY_IDLE:
+            return;
+
+        case REPLAY_WAITING:
+            if (now - replayStepStartMs >= PULSE_REPLAY_START_DELAY_MS) {
+                replayState = REPLAY_RUNNING;
+                startStep(0);
+            }
+            return;
+
+        case REPLAY_RUNNING:
+            sampleSpeed(now);
+            if (now - replayStepStartMs < (unsigned long)replaySteps[replayStepIndex].seconds * 1000UL) {
+                return;
+            }
+            if (replayStepIndex + 1 < replayStepCount) {
+                finishStep();
+                startStep(replayStepIndex + 1);
+            } else {
+                // Stop the generator and let the last edge arrive before the final count
+                replayIntervalUs = 0;
+                replayState = REPLAY_DRAINING;
+                replayLastSampleMs = now;
+            }
+            return;
+
+        case REPLAY_DRAINING:
+            if (now - replayLastSampleMs < REPLAY_DRAIN_MS) {
+                return;
+            }
+            finishStep();
+            logSerial.printf("REPLAY: done | generated %u, counted %llu (diff %lld) | worst step speed error %.1f %%\n",
+                          (unsigned)replayTotalGenerated, (unsigned long long)replayTotalCounted,
+                          (long long)replayTotalCounted - (long long)replayTotalGenerated, replayWorstErrorPercent);
+            replayState = REPLAY_IDLE;
+            return;
+    }
+}
+
+bool pulseReplayActive() {
+    return replayState != REPLAY_IDLE;
+}
+
+#endif // ENABLE_PULSE_REPLAY
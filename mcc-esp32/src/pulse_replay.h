@@ -0,0 +1,80 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    pulse_replay.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * On-device pulse generator for load tests of the counting pipeline
+ * (build flag ENABLE_PULSE_REPLAY). A timer drives the sensor GPIO like a
+ * reed contact, so PCNT with its glitch filter, the capture ISR, the speed
+ * average, the display and the uploads all see the generated pulses. The
+ * speed follows a ride profile or a speed sweep; after every step counted
+ * and generated pulses and the speed error are written to Serial.
+ */
+
+#ifndef PULSE_REPLAY_H
+#define PULSE_REPLAY_H
+
+#include <Arduino.h>
+
+#ifdef ENABLE_PULSE_REPLAY
+
+// Output GPIO. The default drives the sensor input itself (open drain, no
+// wiring); another pin is push-pull and needs a jumper to the sensor input.
+#ifndef PULSE_REPLAY_PIN
+#define PULSE_REPLAY_PIN PulseMeasurePin
+#endif
+
+// Time the simulated contact is closed (LOW) per pulse
+#ifndef PULSE_REPLAY_WIDTH_US
+#define PULSE_REPLAY_WIDTH_US 5000
+#endif
+
+// Wait after setup() so WiFi, sync and ID tag lookup are done before the first step
+#ifndef PULSE_REPLAY_START_DELAY_MS
+#define PULSE_REPLAY_START_DELAY_MS 15000
+#endif
+
+// Sweep instead of a profile: PULSE_REPLAY_SWEEP_MAX_KMH defines the last step
+#ifndef PULSE_REPLAY_SWEEP_MIN_KMH
+#define PULSE_REPLAY_SWEEP_MIN_KMH 5
+#endif
+#ifndef PULSE_REPLAY_SWEEP_STEP_KMH
+#define PULSE_REPLAY_SWEEP_STEP_KMH 5
+#endif
+#ifndef PULSE_REPLAY_SWEEP_STEP_SEC
+#define PULSE_REPLAY_SWEEP_STEP_SEC 10
+#endif
+
+// Recorded ride on LittleFS: one "seconds,km/h" segment per line, '#' starts a comment
+#define PULSE_REPLAY_PROFILE_PATH "/replay_profile.csv"
+#define PULSE_REPLAY_MAX_STEPS 64
+
+/**
+ * @brief Prepares the generator; the replay starts PULSE_REPLAY_START_DELAY_MS later.
+ *
+ * Steps come from the sweep (if PULSE_REPLAY_SWEEP_MAX_KMH is defined), else
+ * from PULSE_REPLAY_PROFILE_PATH, else from a built-in stop-and-go profile.
+ * Speeds are converted to pulse intervals with the configured wheel_size.
+ *
+ * @note Hardware interaction: PULSE_REPLAY_PIN (output), esp_timer
+ * @note Side effects: Reads LittleFS (call after rideJournalBegin() mounted it)
+ */
+void pulseReplayBegin();
+
+/**
+ * @brief Advances the steps and samples the measured speed; call from loop().
+ *
+ * @note Side effects: Writes the step and summary report to Serial
+ */
+void pulseReplayLoop();
+
+/**
+ * @brief true from pulseReplayBegin() until the last step was reported (keeps the device awake).
+ */
+bool pulseReplayActive();
+
+#endif // ENABLE_PULSE_REPLAY
+
+#endif
@@ -0,0 +1,85 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    pulse_ring.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Lock-free single-producer/single-consumer ring buffer for pulse timestamps.
+ * The producer is the sensor ISR, the consumer is the pulse capture task.
+ */
+
+#ifndef PULSE_RING_H
+#define PULSE_RING_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Must be a power of two. 64 entries cover ~3 s at 20 wheel revolutions per second.
+#ifndef PULSE_RING_CAPACITY
+#define PULSE_RING_CAPACITY 64
+#endif
+
+static_assert((PULSE_RING_CAPACITY & (PULSE_RING_CAPACITY - 1)) == 0,
+              "PULSE_RING_CAPACITY must be a power of two");
+
+// Force inlining so the push stays in IRAM when called from an IRAM_ATTR ISR
+#define PULSE_RING_INLINE static inline __attribute__((always_inline))
+
+struct PulseRing {
+    std::atomic<uint32_t> head;      // Next slot to write (owned by producer)
+    std::atomic<uint32_t> tail;      // Next slot to read (owned by consumer)
+    std::atomic<uint32_t> dropped;   // Timestamps lost because the ring was full
+    uint32_t timestamps_us[PULSE_RING_CAPACITY];
+};
+
+/**
+ * @brief Resets the ring to empty. Only call while producer and consumer are stopped.
+ */
+PULSE_RING_INLINE void pulseRingReset(PulseRing* ring) {
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_relaxed);
+    ring->dropped.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Appends a timestamp (producer side, ISR safe).
+ *
+ * @return false if the ring was full and the timestamp was dropped
+ */
+PULSE_RING_INLINE bool pulseRingPush(PulseRing* ring, uint32_t timestamp_us) {
+    const uint32_t head = ring->head.load(std::memory_order_relaxed);
+    const uint32_t tail = ring->tail.load(std::memory_order_acquire);
+    if (head - tail >= PULSE_RING_CAPACITY) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    ring->timestamps_us[head & (PULSE_RING_CAPACITY - 1)] = timestamp_us;
+    ring->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Removes the oldest timestamp (consumer side).
+ *
+ * @return false if the ring was empty
+ */
+PULSE_RING_INLINE bool pulseRingPop(PulseRing* ring, uint32_t* timestamp_us) {
+    const uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    const uint32_t head = ring->head.load(std::memory_order_acquire);
+    if (tail == head) {
+        return false;
+    }
+    *timestamp_us = ring->timestamps_us[tail & (PULSE_RING_CAPACITY - 1)];
+    ring->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Number of timestamps currently queued.
+ */
+PULSE_RING_INLINE uint32_t pulseRingSize(const PulseRing* ring) {
+    return ring->head.load(std::memory_order_acquire) - ring->tail.load(std::memory_order_acquire);
+}
+
+#endif // PULSE_RING_H
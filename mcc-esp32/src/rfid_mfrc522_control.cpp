@@ -9,11 +9,17 @@
 #ifdef ENABLE_RFID
 
 #include "rfid_mfrc522_control.h"
+#include "mcc_log.h"
 #include "led_control.h" // For the updateLed function
 
 // Forward declaration for buzzer function
 void play_tag_detected_tone();
 
+#ifdef RFID_IRQ_PIN
+static volatile bool rfidCardPending = false;
+static unsigned long rfidLastArmTime = 0;
+#endif
+
 
 // --- Helper functions ---
 
@@ -25,20 +31,21 @@ void play_tag_detected_tone();
  * 
  * @param buffer Pointer to byte array containing the UID
  * @param bufferSize Number of bytes in the buffer
- * @return String containing hexadecimal representation of UID (lowercase)
+ * @param out Receives the NUL-terminated hexadecimal UID (lowercase)
+ * @param outSize Size of out; RFID_UID_HEX_LEN covers the longest UID
  * 
- * @note Pure logic function - string conversion only
- * @note Side effects: Allocates String object
+ * @note Pure logic function - string conversion only, no heap allocation
  */
-String RFID_MFRC522_uidToHexString(byte *buffer, byte bufferSize) {
-  String str = "";
-  for (byte i = 0; i < bufferSize; i++) {
-    if (buffer[i] < 0x10) {
-      str += "0";
-    }
-    str += String(buffer[i], HEX);
+void RFID_MFRC522_uidToHex(const byte *buffer, byte bufferSize, char *out, size_t outSize) {
+  static const char digits[] = "0123456789abcdef";
+  size_t pos = 0;
+  for (byte i = 0; i < bufferSize && pos + 2 < outSize; i++) {
+    out[pos++] = digits[buffer[i] >> 4];
+    out[pos++] = digits[buffer[i] & 0x0F];
+  }
+  if (outSize > 0) {
+    out[pos] = '\0';
   }
-  return str;
 }
 
 /**
@@ -54,6 +61,35 @@ void RFID_MFRC522_clearInt() {
   mfrc522.PCD_WriteRegister(mfrc522.ComIrqReg, 0x7F);
 }
 
+/**
+ * @brief Sends a REQA command without waiting for the answer.
+ * 
+ * A card in the field answers with ATQA, which raises the receive interrupt
+ * (IRQ pin) of the MFRC522.
+ * 
+ * @note Hardware interaction: MFRC522 RFID reader via SPI (FIFO, command and bit framing registers)
+ * @note Side effects: Starts a transceive on the reader
+ */
+void RFID_MFRC522_activateRec() {
+  mfrc522.PCD_WriteRegister(mfrc522.FIFODataReg, mfrc522.PICC_CMD_REQA);
+  mfrc522.PCD_WriteRegister(mfrc522.CommandReg, mfrc522.PCD_Transceive);
+  mfrc522.PCD_WriteRegister(mfrc522.BitFramingReg, 0x87); // StartSend, 7 bit short frame
+}
+
+/**
+ * @brief Interrupt service routine for the MFRC522 IRQ pin (RFID_IRQ_PIN).
+ * 
+ * Only sets a flag; the card is read in RFID_MFRC522_loop_handler().
+ * 
+ * @note Hardware interaction: None (runs in interrupt context)
+ * @note Side effects: Sets the pending card flag
+ */
+void IRAM_ATTR RFID_MFRC522_ISR() {
+#ifdef RFID_IRQ_PIN
+  rfidCardPending = true;
+#endif
+}
+
 /**
  * @brief Initializes the MFRC522 RFID reader module.
  * 
@@ -70,20 +106,81 @@ void RFID_MFRC522_setup() {
   mfrc522.PCD_Init();
   
   if (debugEnabled) {
-    Serial.print(F("MFRC522 Version: 0x"));
-    Serial.println(mfrc522.PCD_ReadRegister(mfrc522.VersionReg), HEX);
+    logSerial.print(F("MFRC522 Version: 0x"));
+    logSerial.println(mfrc522.PCD_ReadRegister(mfrc522.VersionReg), HEX);
   }
 
+#ifdef RFID_IRQ_PIN
+  pinMode(RFID_IRQ_PIN, INPUT_PULLUP);
+  // IRqInv (IRQ pin active low) + RxIEn (interrupt on received frame)
+  mfrc522.PCD_WriteRegister(mfrc522.ComIEnReg, 0xA0);
+  RFID_MFRC522_clearInt();
+  rfidCardPending = false;
+  attachInterrupt(digitalPinToInterrupt(RFID_IRQ_PIN), RFID_MFRC522_ISR, FALLING);
+  RFID_MFRC522_activateRec();
+  rfidLastArmTime = millis();
+  if (debugEnabled) {
+    logSerial.printf("RFID-MFRC522: Interrupt mode on GPIO %d\n", RFID_IRQ_PIN);
+  }
+#endif
 }
 
 /**
- * @brief Main RFID polling handler called from main loop.
+ * @brief Reads the UID of a card that answered REQA and applies it as idTag.
  * 
- * Polls the MFRC522 for new RFID cards. When a card is detected and read successfully,
+ * @param source Detection mode for the debug output ("Polling" or "IRQ")
+ * 
+ * @note Hardware interaction: MFRC522 (anticollision/select via SPI), LED_PIN
+ * @note Side effects: Updates global idTag variable, controls LED, plays tone
+ */
+static void RFID_MFRC522_readCard(const char* source) {
+    MCC_LOGD("RFID-MFRC522: New card detected (%s).\n", source);
+
+    if (mfrc522.PICC_ReadCardSerial()) { 
+        
+        char newIdTag[RFID_UID_HEX_LEN];
+        RFID_MFRC522_uidToHex(mfrc522.uid.uidByte, mfrc522.uid.size, newIdTag, sizeof(newIdTag));
+        
+        // Always play tone when RFID tag is detected, even if it's the same tag
+        play_tag_detected_tone();
+        
+        // IMPORTANT CHANGE: The UID of the detected card should replace the UserID (idTag).
+        if (idTag != newIdTag) {
+            idTag = newIdTag; // Assignment of RFID UID as current UserID
+            extern bool idTagFromRFID;
+            idTagFromRFID = true; // Mark that this idTag came from RFID detection
+            if (debugEnabled) {
+                logSerial.print(F("New UserID (idTag) set by RFID tag: "));
+                logSerial.println(idTag);
+            }
+        } else {
+             if (debugEnabled) {
+                logSerial.print(F("RFID tag read, UserID (idTag) is already: "));
+                logSerial.println(idTag);
+            }
+        }
+        
+        if (ledEnabled) {
+            // Let LED briefly light up on successful read
+            updateLed(true); 
+        }
+
+        mfrc522.PICC_HaltA(); // Stop PICC
+    } else {
+         if (debugEnabled) logSerial.println("RFID-MFRC522: Card detected, but read error.");
+    }
+}
+
+/**
+ * @brief Main RFID handler called from main loop.
+ * 
+ * Checks the MFRC522 for new RFID cards. When a card is detected and read successfully,
  * converts the UID to hex string and updates the global idTag variable if it changed.
  * Triggers LED feedback if enabled.
  * 
- * This function uses polling instead of interrupts to detect cards.
+ * Without RFID_IRQ_PIN the reader is polled (one SPI transceive per call).
+ * With RFID_IRQ_PIN the card is only read after the IRQ fired; in between,
+ * the REQA command is re-sent every RFID_IRQ_REARM_MS with a few register writes.
  * 
  * @note Hardware interaction:
  *   - MFRC522 RFID reader (SPI communication for card detection and reading)
@@ -91,44 +188,26 @@ void RFID_MFRC522_setup() {
  * @note Side effects: Updates global idTag variable, controls LED, writes to Serial
  */
 void RFID_MFRC522_loop_handler() {
-    
+#ifdef RFID_IRQ_PIN
+    if (rfidCardPending) {
+        RFID_MFRC522_clearInt();
+        RFID_MFRC522_readCard("IRQ");
+    } else if (millis() - rfidLastArmTime < RFID_IRQ_REARM_MS) {
+        // No card answered yet: leave the SPI bus alone
+        return;
+    }
+    // Re-arm: a card entering the field answers the next REQA and raises the IRQ.
+    // The read leaves RxIEn enabled, so its own transceives set rfidCardPending again: clear it only now
+    RFID_MFRC522_clearInt();
+    rfidCardPending = false;
+    RFID_MFRC522_activateRec();
+    rfidLastArmTime = millis();
+#else
     // Polling check for a new card
     if (mfrc522.PICC_IsNewCardPresent()) { 
-        if (debugEnabled) Serial.println("RFID-MFRC522: New card detected (Polling).");
-
-        if (mfrc522.PICC_ReadCardSerial()) { 
-            
-            String newIdTag = RFID_MFRC522_uidToHexString(mfrc522.uid.uidByte, mfrc522.uid.size);
-            
-            // Always play tone when RFID tag is detected, even if it's the same tag
-            play_tag_detected_tone();
-            
-            // IMPORTANT CHANGE: The UID of the detected card should replace the UserID (idTag).
-            if (idTag != newIdTag) {
-                idTag = newIdTag; // Assignment of RFID UID as current UserID
-                extern bool idTagFromRFID;
-                idTagFromRFID = true; // Mark that this idTag came from RFID detection
-                if (debugEnabled) {
-                    Serial.print(F("New UserID (idTag) set by RFID tag: "));
-                    Serial.println(idTag);
-                }
-            } else {
-                 if (debugEnabled) {
-                    Serial.print(F("RFID tag read, UserID (idTag) is already: "));
-                    Serial.println(idTag);
-                }
-            }
-            
-            if (ledEnabled) {
-                // Let LED briefly light up on successful read
-                updateLed(true); 
-            }
-
-            mfrc522.PICC_HaltA(); // Stop PICC
-        } else {
-             if (debugEnabled) Serial.println("RFID-MFRC522: Card detected, but read error.");
-        }
+        RFID_MFRC522_readCard("Polling");
     }
+#endif
 }
 
-#endif // ENABLE_RFID
\ No newline at end of file
+#endif // ENABLE_RFID
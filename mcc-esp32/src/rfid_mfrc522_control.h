@@ -19,6 +19,18 @@
 // Globale MFRC522 Instanz
 extern MFRC522 mfrc522;
 
+// Optional: GPIO connected to the IRQ pin of the MFRC522 (-D RFID_IRQ_PIN=27).
+// Without it the reader is polled over SPI on every loop.
+#ifdef RFID_IRQ_PIN
+// Interval for re-sending the REQA command the IRQ answers to
+#ifndef RFID_IRQ_REARM_MS
+#define RFID_IRQ_REARM_MS 100
+#endif
+#endif
+
+// Hex text of the longest UID (10 bytes) plus terminator
+#define RFID_UID_HEX_LEN 21
+
 // --- Externe Projektvariablen ---
 extern String idTag;
 extern bool debugEnabled;
@@ -27,9 +39,12 @@ extern bool ledEnabled;
 // --- FUNKTIONSPROTOTYPEN ---
 
 /**
- * @brief Interrupt service routine for MFRC522 RFID reader (not currently implemented).
+ * @brief Interrupt service routine for the MFRC522 IRQ pin (RFID_IRQ_PIN).
  * 
- * @note This function is declared but not implemented in the current codebase.
+ * Only sets a flag; the card is read in RFID_MFRC522_loop_handler().
+ * 
+ * @note Hardware interaction: None (runs in interrupt context)
+ * @note Side effects: Sets the pending card flag
  */
 void RFID_MFRC522_ISR();
 
@@ -38,22 +53,27 @@ void RFID_MFRC522_ISR();
  * 
  * Initializes SPI communication and configures the MFRC522 RFID reader.
  * Reads and displays the chip version register for verification.
+ * With RFID_IRQ_PIN, enables the receive interrupt of the reader and
+ * attaches RFID_MFRC522_ISR() to the pin.
  * 
  * @note Hardware interaction: 
  *   - SPI bus (initialization)
  *   - MFRC522 RFID reader (SS_PIN, RST_PIN via SPI)
+ *   - RFID_IRQ_PIN (input with pull-up, falling edge interrupt) if defined
  * @note Side effects: Initializes SPI, configures MFRC522, writes to Serial
  */
 void RFID_MFRC522_setup();
 
 /**
- * @brief Main RFID polling handler called from main loop.
+ * @brief Main RFID handler called from main loop.
  * 
- * Polls the MFRC522 for new RFID cards. When a card is detected and read successfully,
+ * Checks the MFRC522 for new RFID cards. When a card is detected and read successfully,
  * converts the UID to hex string and updates the global idTag variable if it changed.
  * Triggers LED feedback if enabled.
  * 
- * This function uses polling instead of interrupts to detect cards.
+ * Without RFID_IRQ_PIN the reader is polled (one SPI transceive per call).
+ * With RFID_IRQ_PIN the card is only read after the IRQ fired; in between,
+ * the REQA command is re-sent every RFID_IRQ_REARM_MS with a few register writes.
  * 
  * @note Hardware interaction:
  *   - MFRC522 RFID reader (SPI communication for card detection and reading)
@@ -71,12 +91,12 @@ void RFID_MFRC522_loop_handler();
  * 
  * @param buffer Pointer to byte array containing the UID
  * @param bufferSize Number of bytes in the buffer
- * @return String containing hexadecimal representation of UID (lowercase)
+ * @param out Receives the NUL-terminated hexadecimal UID (lowercase)
+ * @param outSize Size of out; RFID_UID_HEX_LEN covers the longest UID
  * 
- * @note Pure logic function - string conversion only
- * @note Side effects: Allocates String object
+ * @note Pure logic function - string conversion only, no heap allocation
  */
-String RFID_MFRC522_uidToHexString(byte *buffer, byte bufferSize);
+void RFID_MFRC522_uidToHex(const byte *buffer, byte bufferSize, char *out, size_t outSize);
 
 /**
  * @brief Clears interrupt flags in MFRC522 register.
@@ -90,9 +110,13 @@ String RFID_MFRC522_uidToHexString(byte *buffer, byte bufferSize);
 void RFID_MFRC522_clearInt();
 
 /**
- * @brief Activates card reception mode on MFRC522 (not currently implemented).
+ * @brief Sends a REQA command without waiting for the answer.
+ * 
+ * A card in the field answers with ATQA, which raises the receive interrupt
+ * (IRQ pin) of the MFRC522.
  * 
- * @note This function is declared but not implemented in the current codebase.
+ * @note Hardware interaction: MFRC522 RFID reader via SPI (FIFO, command and bit framing registers)
+ * @note Side effects: Starts a transceive on the reader
  */
 void RFID_MFRC522_activateRec();
 
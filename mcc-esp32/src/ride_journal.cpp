@@ -0,0 +1,165 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ride_journal.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "ride_journal.h"
+#include "mcc_log.h"
+#include <FS.h>
+#include <LittleFS.h>
+
+// External variables from main.cpp
+extern bool debugEnabled;
+
+static bool journalReady = false;
+static uint32_t journalNextSeq = 0;
+static uint32_t journalOldestPending = 0;   // Pending records are [journalOldestPending, journalNextSeq)
+
+static size_t slotOffset(uint32_t seq) {
+    return (size_t)(seq % RIDE_JOURNAL_CAPACITY) * sizeof(JournalRecord);
+}
+
+static bool readSlot(uint32_t seq, JournalRecord* out) {
+    File f = LittleFS.open(RIDE_JOURNAL_PATH, "r");
+    if (!f) {
+        return false;
+    }
+    bool ok = f.seek(slotOffset(seq)) && f.read((uint8_t*)out, sizeof(*out)) == sizeof(*out);
+    f.close();
+    return ok;
+}
+
+static bool writeAt(size_t offset, const uint8_t* data, size_t len) {
+    File f = LittleFS.open(RIDE_JOURNAL_PATH, "r+");
+    if (!f) {
+        return false;
+    }
+    bool ok = f.seek(offset) && f.write(data, len) == len;
+    f.close();
+    return ok;
+}
+
+static bool createJournalFile() {
+    File f = LittleFS.open(RIDE_JOURNAL_PATH, "w");
+    if (!f) {
+        return false;
+    }
+    JournalRecord empty;
+    memset(&empty, 0, sizeof(empty));
+    bool ok = true;
+    for (uint32_t i = 0; i < RIDE_JOURNAL_CAPACITY && ok; i++) {
+        ok = f.write((const uint8_t*)&empty, sizeof(empty)) == sizeof(empty);
+    }
+    f.close();
+    return ok;
+}
+
+bool rideJournalBegin() {
+    if (journalReady) {
+        return true;
+    }
+    if (!LittleFS.begin(true)) {
+        MCC_LOGE("rideJournalBegin() - LittleFS not available, journal disabled");
+        return false;
+    }
+
+    const size_t expectedSize = (size_t)RIDE_JOURNAL_CAPACITY * sizeof(JournalRecord);
+    File f = LittleFS.open(RIDE_JOURNAL_PATH, "r");
+    if (!f || f.size() != expectedSize) {
+        if (f) {
+            f.close();
+        }
+        // Missing or written with a different capacity/format: start empty
+        if (!createJournalFile()) {
+            MCC_LOGE("rideJournalBegin() - Could not create journal file");
+            return false;
+        }
+        f = LittleFS.open(RIDE_JOURNAL_PATH, "r");
+        if (!f) {
+            return false;
+        }
+    }
+
+    JournalScan scan;
+    journalScanReset(&scan);
+    JournalRecord rec;
+    while (f.read((uint8_t*)&rec, sizeof(rec)) == sizeof(rec)) {
+        journalScanAdd(&scan, &rec);
+    }
+    f.close();
+
+    journalNextSeq = scan.nextSeq;
+    journalOldestPending = scan.pendingCount > 0 ? scan.oldestPendingSeq : scan.nextSeq;
+    journalReady = true;
+
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: Ride journal ready, %u pending record(s), next seq %u\n",
+                      (unsigned)rideJournalPendingCount(), (unsigned)journalNextSeq);
+    }
+    return true;
+}
+
+bool rideJournalAppend(const char* idTag, uint32_t pulses, float distance_mm) {
+    if (!journalReady) {
+        return false;
+    }
+    JournalRecord rec;
+    journalRecordInit(&rec, journalNextSeq, millis(), idTag, pulses, distance_mm);
+    if (!writeAt(slotOffset(rec.seq), (const uint8_t*)&rec, sizeof(rec))) {
+        MCC_LOGD("Ride journal write failed.");
+        return false;
+    }
+    journalNextSeq++;
+    if (journalNextSeq - journalOldestPending > RIDE_JOURNAL_CAPACITY) {
+        // Ring full: the slot of the oldest pending record was just reused
+        journalOldestPending = journalNextSeq - RIDE_JOURNAL_CAPACITY;
+        MCC_LOGD("Ride journal full, oldest record overwritten.");
+    }
+    return true;
+}
+
+bool rideJournalPeek(JournalRecord* out) {
+    // Skip slots that are unreadable or no longer hold the expected record
+    while (journalReady && journalOldestPending != journalNextSeq) {
+        if (readSlot(journalOldestPending, out) && journalRecordValid(out) &&
+            out->seq == journalOldestPending && out->state == JOURNAL_STATE_PENDING) {
+            return true;
+        }
+        journalOldestPending++;
+    }
+    return false;
+}
+
+uint32_t rideJournalPeekMany(JournalRecord* out, uint32_t maxCount) {
+    if (maxCount == 0 || !rideJournalPeek(&out[0])) {
+        return 0;
+    }
+    uint32_t count = 1;
+    while (count < maxCount && journalOldestPending + count != journalNextSeq) {
+        const uint32_t seq = journalOldestPending + count;
+        if (!readSlot(seq, &out[count]) || !journalRecordValid(&out[count]) ||
+            out[count].seq != seq || out[count].state != JOURNAL_STATE_PENDING) {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+void rideJournalMarkSent(uint32_t seq) {
+    const uint32_t state = JOURNAL_STATE_SENT;
+    // Wrap-safe "seq >= journalOldestPending" within the pending range
+    while (journalReady && journalOldestPending != journalNextSeq &&
+           seq - journalOldestPending < RIDE_JOURNAL_CAPACITY) {
+        writeAt(slotOffset(journalOldestPending) + offsetof(JournalRecord, state),
+                (const uint8_t*)&state, sizeof(state));
+        journalOldestPending++;
+    }
+}
+
+uint32_t rideJournalPendingCount() {
+    return journalReady ? journalNextSeq - journalOldestPending : 0;
+}
@@ -0,0 +1,80 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ride_journal.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Store-and-forward journal for ride intervals that could not be uploaded
+ * (no WiFi, server error). Records are kept in a fixed-size ring file on
+ * LittleFS and replayed in order once the server is reachable again.
+ */
+
+#ifndef RIDE_JOURNAL_H
+#define RIDE_JOURNAL_H
+
+#include <Arduino.h>
+#include "journal_format.h"
+
+// Number of record slots. 256 slots cover about two hours of riding at a 30 s send interval.
+#ifndef RIDE_JOURNAL_CAPACITY
+#define RIDE_JOURNAL_CAPACITY 256
+#endif
+
+#define RIDE_JOURNAL_PATH "/journal.bin"
+
+// Upper bound for upload_batch_size (records are read into a stack buffer of this size)
+#define UPLOAD_BATCH_MAX 20
+
+/**
+ * @brief Mounts LittleFS, creates the journal file if needed and scans it.
+ *
+ * @return false if the filesystem is not available; the journal then stays
+ *         disabled and all other functions are no-ops
+ *
+ * @note Hardware interaction: Flash (LittleFS on the "spiffs" partition)
+ * @note Side effects: Formats the partition if it cannot be mounted
+ */
+bool rideJournalBegin();
+
+/**
+ * @brief Appends one interval as pending record.
+ *
+ * When the ring is full the oldest pending record is overwritten.
+ *
+ * @return false if the journal is disabled or the write failed
+ *
+ * @note Hardware interaction: One record write to flash
+ */
+bool rideJournalAppend(const char* idTag, uint32_t pulses, float distance_mm);
+
+/**
+ * @brief Reads the oldest pending record without removing it.
+ *
+ * @return false if nothing is pending
+ */
+bool rideJournalPeek(JournalRecord* out);
+
+/**
+ * @brief Reads up to maxCount consecutive pending records, oldest first.
+ *
+ * @return Number of records copied to out
+ */
+uint32_t rideJournalPeekMany(JournalRecord* out, uint32_t maxCount);
+
+/**
+ * @brief Marks all pending records up to and including seq as sent.
+ *
+ * @param seq Sequence number of the last record confirmed by the server;
+ *            ignored if it is older than the oldest pending record
+ *
+ * @note Hardware interaction: One small flash write per record
+ */
+void rideJournalMarkSent(uint32_t seq);
+
+/**
+ * @brief Number of records waiting for replay.
+ */
+uint32_t rideJournalPendingCount();
+
+#endif
@@ -0,0 +1,40 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ride_state.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "ride_state.h"
+#include "seqlock.h"
+
+// Spins before a reader gives the writer a tick to finish
+static const uint8_t RIDE_STATE_READ_SPINS = 4;
+
+static SeqLock<RideState> rideStateLock = {};
+static RideState lastPublished = {};   // Only used by the writer
+
+bool rideStatePublish(const RideState& state) {
+    // Compared bytewise: callers start from a zeroed RideState, so string tails are zero too
+    if (seqLockVersion(&rideStateLock) > 0 && memcmp(&state, &lastPublished, sizeof(state)) == 0) {
+        return false;
+    }
+    lastPublished = state;
+    seqLockWrite(&rideStateLock, state);
+    return true;
+}
+
+void rideStateGet(RideState* out) {
+    uint8_t attempts = 0;
+    while (!seqLockTryRead(&rideStateLock, out)) {
+        if (++attempts >= RIDE_STATE_READ_SPINS) {
+            vTaskDelay(1);
+            attempts = 0;
+        }
+    }
+}
+
+uint32_t rideStateVersion() {
+    return seqLockVersion(&rideStateLock);
+}
@@ -0,0 +1,57 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ride_state.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Consistent snapshot of the ride state (rider, speed, distance, session
+ * Velos). loop() owns the ride globals and publishes a copy through a
+ * seqlock when they change; any task can read the latest copy without a
+ * mutex and without delaying the writer. The current readers, display_Data()
+ * and /metrics, still run in loop(); no other task reads the ride state yet.
+ */
+
+#ifndef RIDE_STATE_H
+#define RIDE_STATE_H
+
+#include <Arduino.h>
+
+#define RIDE_STATE_ID_TAG_LEN 40
+#define RIDE_STATE_NAME_LEN 48
+#define RIDE_STATE_VELOS_LEN 16
+
+struct RideState {
+    char idTag[RIDE_STATE_ID_TAG_LEN];
+    char username[RIDE_STATE_NAME_LEN];    // Empty until the server confirmed the rider
+    char sessionVelos[RIDE_STATE_VELOS_LEN]; // As displayed, including the local extrapolation
+    float speed_kmh;
+    float totalDistance_mm;                // Since the rider started or the device woke up
+    uint32_t pulses;                       // PCNT count of the current rider
+    uint32_t distanceSession;              // Changes on every counter reset
+};
+
+/**
+ * @brief Publishes a new snapshot if it differs from the last one.
+ *
+ * @note Only call from loop() (single writer)
+ * @return true if a new version was published
+ */
+bool rideStatePublish(const RideState& state);
+
+/**
+ * @brief Copies the latest snapshot.
+ *
+ * Retries while loop() is writing; after a few attempts the reader sleeps
+ * one tick, so a higher priority reader cannot starve the writer on its core.
+ *
+ * @note Safe to call from any task, not from an ISR
+ */
+void rideStateGet(RideState* out);
+
+/**
+ * @brief Version of the latest snapshot, e.g. to redraw only after a change.
+ */
+uint32_t rideStateVersion();
+
+#endif // RIDE_STATE_H
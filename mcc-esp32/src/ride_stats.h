@@ -0,0 +1,97 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ride_stats.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Per upload interval ride statistics: riding and idle time, minimum,
+ * average and maximum speed, and the time spent in 5 km/h speed bands.
+ * Fed with every pulse interval by the capture task; O(1) per pulse,
+ * integer math only (speeds in 0.01 km/h).
+ */
+
+#ifndef RIDE_STATS_H
+#define RIDE_STATS_H
+
+#include <stdint.h>
+
+#define RIDE_STATS_BANDS 9                         // 0-5, 5-10, ... 35-40, >= 40 km/h
+const uint32_t RIDE_STATS_BAND_WIDTH_CKMH = 500;  // Width of one speed band in 0.01 km/h
+
+struct RideStats {
+    uint32_t intervals;                  // Pulse intervals counted as riding
+    uint32_t distanceMm;                 // Distance of the riding intervals
+    uint64_t activeUs;                   // Time in riding intervals
+    uint64_t idleUs;                     // Time in intervals of at least the idle threshold
+    uint32_t minCkmh;                    // Slowest riding interval, 0.01 km/h (0 if none)
+    uint32_t maxCkmh;                    // Fastest riding interval, 0.01 km/h
+    uint32_t bandMs[RIDE_STATS_BANDS];   // Riding time per speed band
+};
+
+static inline void rideStatsReset(RideStats* stats) {
+    stats->intervals = 0;
+    stats->distanceMm = 0;
+    stats->activeUs = 0;
+    stats->idleUs = 0;
+    stats->minCkmh = 0;
+    stats->maxCkmh = 0;
+    for (int i = 0; i < RIDE_STATS_BANDS; i++) {
+        stats->bandMs[i] = 0;
+    }
+}
+
+/**
+ * @brief Speed of one wheel revolution in 0.01 km/h.
+ */
+static inline uint32_t rideStatsSpeedCkmh(uint32_t intervalUs, uint32_t wheelMm) {
+    if (intervalUs == 0) {
+        return 0;
+    }
+    // mm/us * 3600 = km/h
+    return (uint32_t)((uint64_t)wheelMm * 360000u / intervalUs);
+}
+
+/**
+ * @brief Adds the interval between two accepted pulses.
+ *
+ * An interval is attributed when it ends, i.e. a pause is counted as idle
+ * time once riding resumes.
+ *
+ * @param intervalUs Time between the two pulses
+ * @param wheelMm Wheel circumference
+ * @param idleThresholdUs Intervals at least this long count as idle time (the speed timeout)
+ */
+static inline void rideStatsAddInterval(RideStats* stats, uint32_t intervalUs, uint32_t wheelMm, uint32_t idleThresholdUs) {
+    if (intervalUs >= idleThresholdUs) {
+        stats->idleUs += intervalUs;
+        return;
+    }
+    const uint32_t speed = rideStatsSpeedCkmh(intervalUs, wheelMm);
+    if (stats->intervals == 0 || speed < stats->minCkmh) {
+        stats->minCkmh = speed;
+    }
+    if (speed > stats->maxCkmh) {
+        stats->maxCkmh = speed;
+    }
+    uint32_t band = speed / RIDE_STATS_BAND_WIDTH_CKMH;
+    if (band >= RIDE_STATS_BANDS) {
+        band = RIDE_STATS_BANDS - 1;
+    }
+    stats->bandMs[band] += (intervalUs + 500) / 1000;
+    stats->intervals++;
+    stats->distanceMm += wheelMm;
+    stats->activeUs += intervalUs;
+}
+
+/**
+ * @brief Average speed over the riding time in 0.01 km/h (distance / riding time, not the mean of the samples).
+ */
+static inline uint32_t rideStatsAvgCkmh(const RideStats* stats) {
+    if (stats->activeUs == 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)stats->distanceMm * 360000u / stats->activeUs);
+}
+
+#endif // RIDE_STATS_H
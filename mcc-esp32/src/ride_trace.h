@@ -0,0 +1,194 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ride_trace.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Opt-in per-revolution trace: the capture task records every accepted
+ * pulse timestamp as the change of the pulse interval against the previous
+ * one, zigzag and varint encoded, in a fixed buffer. At a steady cadence a
+ * revolution takes one byte, a speed change two. Timestamps are quantized
+ * to RIDE_TRACE_TICK_US without drift: the decoded ticks add up to the
+ * real time since the anchor pulse. The buffer is uploaded base64 encoded
+ * with update-data.
+ *
+ * Format of data: varint(zigzag(d0)), varint(zigzag(d1)), ... with
+ * d_i = ticks_i - ticks_(i-1) and ticks_(-1) = 0, so the first value is the
+ * first interval itself.
+ */
+
+#ifndef RIDE_TRACE_H
+#define RIDE_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef RIDE_TRACE_MAX_BYTES
+#define RIDE_TRACE_MAX_BYTES 512           // Upper bound of trace_max_bytes (one buffer; the capture task holds two)
+#endif
+#define RIDE_TRACE_TICK_US 100             // Resolution of the trace (0.1 ms)
+#define RIDE_TRACE_BASE64_LEN (((RIDE_TRACE_MAX_BYTES + 2) / 3) * 4 + 1)
+
+struct RideTrace {
+    uint8_t data[RIDE_TRACE_MAX_BYTES];
+    uint16_t len;              // Bytes used in data
+    uint16_t limit;            // Bytes allowed (trace_max_bytes), 0 = trace off
+    uint16_t count;            // Intervals in data
+    uint16_t dropped;          // Pulses not recorded (buffer full or trace interrupted)
+    uint32_t startUs;          // Timestamp of the anchor pulse the first interval starts from
+    uint32_t endUs;            // Timestamp of the last recorded pulse
+    uint32_t prevTicks;        // Last interval in ticks (delta reference)
+    uint32_t remUs;            // Quantization remainder carried into the next interval
+    bool anchored;             // endUs holds a pulse; the next one closes an interval
+    bool closed;               // Pulses were missed (e.g. riding sleep); nothing more is recorded
+};
+
+/**
+ * @brief Empties the trace and continues from the last pulse of another trace.
+ *
+ * @param previous Trace the new one continues (its last pulse becomes the anchor), may be nullptr
+ * @param limit Bytes the trace may use (capped at RIDE_TRACE_MAX_BYTES), 0 = off
+ */
+static inline void rideTraceBegin(RideTrace* t, const RideTrace* previous, uint16_t limit) {
+    t->len = 0;
+    t->limit = limit > RIDE_TRACE_MAX_BYTES ? RIDE_TRACE_MAX_BYTES : limit;
+    t->count = 0;
+    t->dropped = 0;
+    t->prevTicks = 0;
+    t->closed = false;
+    if (previous != nullptr && previous->anchored && !previous->closed) {
+        t->startUs = previous->endUs;
+        t->endUs = previous->endUs;
+        t->remUs = previous->remUs;
+        t->anchored = true;
+    } else {
+        t->startUs = 0;
+        t->endUs = 0;
+        t->remUs = 0;
+        t->anchored = false;
+    }
+}
+
+static inline uint8_t rideTraceVarintLen(uint32_t v) {
+    uint8_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Records an accepted pulse.
+ *
+ * O(1) and at most five bytes; if they do not fit within the limit the
+ * pulse is counted as dropped and the trace ends there.
+ *
+ * @param timestampUs Edge timestamp (32-bit microseconds, wrap-safe)
+ * @return true if an interval was recorded
+ */
+static inline bool rideTraceAdd(RideTrace* t, uint32_t timestampUs) {
+    if (t->limit == 0) {
+        return false;
+    }
+    if (!t->anchored) {
+        t->startUs = timestampUs;
+        t->endUs = timestampUs;
+        t->remUs = 0;
+        t->anchored = true;
+        return false;
+    }
+    if (t->closed) {
+        t->dropped++;
+        return false;
+    }
+    const uint32_t elapsedUs = (timestampUs - t->endUs) + t->remUs;
+    const uint32_t ticks = elapsedUs / RIDE_TRACE_TICK_US;
+    const int32_t delta = (int32_t)(ticks - t->prevTicks);
+    uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    if (t->len + rideTraceVarintLen(zigzag) > t->limit || t->count == UINT16_MAX) {
+        t->closed = true;
+        t->dropped++;
+        return false;
+    }
+    while (zigzag >= 0x80) {
+        t->data[t->len++] = (uint8_t)(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    t->data[t->len++] = (uint8_t)zigzag;
+    t->count++;
+    t->prevTicks = ticks;
+    t->remUs = elapsedUs % RIDE_TRACE_TICK_US;
+    t->endUs = timestampUs;
+    return true;
+}
+
+/**
+ * @brief Ends recording after pulses were counted without timestamps (e.g. by the ULP).
+ */
+static inline void rideTraceInterrupt(RideTrace* t) {
+    if (t->anchored) {
+        t->closed = true;
+    }
+}
+
+/**
+ * @brief Decodes a trace into intervals in ticks (for tests and host tools).
+ *
+ * @return Number of intervals written to out, stops at maxOut or a truncated varint
+ */
+static inline uint16_t rideTraceDecode(const uint8_t* data, uint16_t len, uint32_t* out, uint16_t maxOut) {
+    uint16_t n = 0;
+    uint16_t pos = 0;
+    uint32_t ticks = 0;
+    while (pos < len && n < maxOut) {
+        uint32_t zigzag = 0;
+        uint8_t shift = 0;
+        uint8_t b;
+        do {
+            if (pos >= len || shift > 28) {
+                return n;
+            }
+            b = data[pos++];
+            zigzag |= (uint32_t)(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        const int32_t delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+        ticks += (uint32_t)delta;
+        out[n++] = ticks;
+    }
+    return n;
+}
+
+/**
+ * @brief Base64 (RFC 4648, with padding) of the trace data for the JSON body.
+ *
+ * @param out At least ((len + 2) / 3) * 4 + 1 bytes (RIDE_TRACE_BASE64_LEN for a full trace)
+ * @return Length without the terminator, 0 if out is too small
+ */
+static inline size_t rideTraceBase64(const uint8_t* data, uint16_t len, char* out, size_t outSize) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const size_t needed = ((size_t)(len + 2) / 3) * 4;
+    if (outSize <= needed) {
+        if (outSize > 0) {
+            out[0] = '\0';
+        }
+        return 0;
+    }
+    size_t o = 0;
+    for (uint16_t i = 0; i < len; i += 3) {
+        const uint32_t b0 = data[i];
+        const uint32_t b1 = i + 1 < len ? data[i + 1] : 0;
+        const uint32_t b2 = i + 2 < len ? data[i + 2] : 0;
+        const uint32_t triple = (b0 << 16) | (b1 << 8) | b2;
+        out[o++] = alphabet[(triple >> 18) & 0x3F];
+        out[o++] = alphabet[(triple >> 12) & 0x3F];
+        out[o++] = i + 1 < len ? alphabet[(triple >> 6) & 0x3F] : '=';
+        out[o++] = i + 2 < len ? alphabet[triple & 0x3F] : '=';
+    }
+    out[o] = '\0';
+    return o;
+}
+
+#endif // RIDE_TRACE_H
@@ -0,0 +1,63 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    seqlock.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Single-writer sequence lock: the writer never blocks, readers copy the
+ * value and retry if a write overlapped the copy. The sequence number is
+ * odd while a write is in progress and counts the published versions.
+ */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+
+template <typename T>
+struct SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock values are copied while they may change");
+    std::atomic<uint32_t> seq;   // Even: stable, odd: write in progress
+    T value;
+};
+
+/**
+ * @brief Publishes a new value. Only one task may write.
+ */
+template <typename T>
+static inline void seqLockWrite(SeqLock<T>* lock, const T& value) {
+    const uint32_t seq = lock->seq.load(std::memory_order_relaxed);
+    lock->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    lock->value = value;
+    lock->seq.store(seq + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Copies the value once.
+ *
+ * @return false if a write overlapped the copy; *out is then inconsistent and must be read again
+ */
+template <typename T>
+static inline bool seqLockTryRead(const SeqLock<T>* lock, T* out) {
+    const uint32_t before = lock->seq.load(std::memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+    *out = lock->value;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return lock->seq.load(std::memory_order_relaxed) == before;
+}
+
+/**
+ * @brief Number of values published so far (changes with every write).
+ */
+template <typename T>
+static inline uint32_t seqLockVersion(const SeqLock<T>* lock) {
+    return lock->seq.load(std::memory_order_acquire) >> 1;
+}
+
+#endif // SEQLOCK_H
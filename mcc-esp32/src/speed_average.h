@@ -0,0 +1,52 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    speed_average.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Moving average over the speeds of the last pulse intervals. Runs once per
+ * sensor edge in the pulse capture task.
+ */
+
+#ifndef SPEED_AVERAGE_H
+#define SPEED_AVERAGE_H
+
+#include <stdint.h>
+
+const int SPEED_AVERAGE_COUNT = 5;               // Number of pulses to average for speed smoothing
+
+struct SpeedAverage {
+    float history[SPEED_AVERAGE_COUNT];
+    int index;   // Slot for the next value
+    int count;   // Valid values, fills up from history[0]
+};
+
+static inline void speedAverageReset(SpeedAverage* avg) {
+    avg->index = 0;
+    avg->count = 0;
+}
+
+/**
+ * @brief Adds the speed of one pulse interval.
+ *
+ * @return Average over the last SPEED_AVERAGE_COUNT values (fewer right after a reset)
+ */
+static inline float speedAveragePush(SpeedAverage* avg, float speed_kmh) {
+    avg->history[avg->index] = speed_kmh;
+    avg->index = (avg->index + 1) % SPEED_AVERAGE_COUNT;
+    if (avg->count < SPEED_AVERAGE_COUNT) {
+        avg->count++;
+    }
+    float sum = 0.0f;
+    for (int i = 0; i < avg->count; i++) {
+        sum += avg->history[i];
+    }
+    return sum / (float)avg->count;
+}
+
+static inline bool speedAverageEmpty(const SpeedAverage* avg) {
+    return avg->count == 0;
+}
+
+#endif // SPEED_AVERAGE_H
@@ -0,0 +1,165 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    tag_cache.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * LRU cache of ID tag → username results from get-user-id, so a rider who
+ * taps again can start counting without waiting for the server.
+ */
+
+#ifndef TAG_CACHE_H
+#define TAG_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+
+#ifndef TAG_CACHE_SIZE
+#define TAG_CACHE_SIZE 32
+#endif
+
+#define TAG_CACHE_TAG_LEN 40
+#define TAG_CACHE_NAME_LEN 48
+#define TAG_CACHE_VERSION 1
+
+// Used when the server does not send cache_ttl with the get-user-id response
+#define TAG_CACHE_DEFAULT_TTL_SEC 3600
+
+struct TagCacheEntry {
+    char tag[TAG_CACHE_TAG_LEN];    // Empty string = unused slot
+    char name[TAG_CACHE_NAME_LEN];
+    uint32_t validatedMs;           // millis() of the last server confirmation
+    uint32_t ttlMs;
+    uint32_t lastUse;               // LRU stamp, higher = more recent
+    uint8_t stale;                  // 1 = not confirmed since boot (loaded from NVS)
+};
+
+struct TagCache {
+    uint32_t version;
+    uint32_t useCounter;
+    TagCacheEntry entries[TAG_CACHE_SIZE];
+};
+
+enum TagCacheResult {
+    TAG_CACHE_MISS,    // Unknown tag: wait for the server
+    TAG_CACHE_FRESH,   // Confirmed within its TTL: no server request needed
+    TAG_CACHE_STALE    // Known but expired: usable, confirm in the background
+};
+
+static inline void tagCacheReset(TagCache* cache) {
+    memset(cache, 0, sizeof(*cache));
+    cache->version = TAG_CACHE_VERSION;
+}
+
+static inline TagCacheEntry* tagCacheFind(TagCache* cache, const char* tag) {
+    if (tag == nullptr || tag[0] == '\0') {
+        return nullptr;
+    }
+    for (int i = 0; i < TAG_CACHE_SIZE; i++) {
+        if (cache->entries[i].tag[0] != '\0' && strcasecmp(cache->entries[i].tag, tag) == 0) {
+            return &cache->entries[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Looks up a tag and marks it as most recently used.
+ *
+ * @param nameOut Receives the cached username on FRESH or STALE
+ * @param nameLen Size of nameOut
+ */
+static inline TagCacheResult tagCacheGet(TagCache* cache, const char* tag, uint32_t nowMs,
+                                         char* nameOut, size_t nameLen) {
+    TagCacheEntry* entry = tagCacheFind(cache, tag);
+    if (entry == nullptr) {
+        return TAG_CACHE_MISS;
+    }
+    entry->lastUse = ++cache->useCounter;
+    if (nameOut != nullptr && nameLen > 0) {
+        strncpy(nameOut, entry->name, nameLen - 1);
+        nameOut[nameLen - 1] = '\0';
+    }
+    if (entry->stale || nowMs - entry->validatedMs >= entry->ttlMs) {
+        return TAG_CACHE_STALE;
+    }
+    return TAG_CACHE_FRESH;
+}
+
+/**
+ * @brief Stores a server confirmed username, evicting the least recently used entry if full.
+ *
+ * @return true if tag or name changed (the persistent copy needs to be written)
+ */
+static inline bool tagCachePut(TagCache* cache, const char* tag, const char* name,
+                               uint32_t ttlMs, uint32_t nowMs) {
+    if (tag == nullptr || tag[0] == '\0' || name == nullptr) {
+        return false;
+    }
+    bool changed = false;
+    TagCacheEntry* entry = tagCacheFind(cache, tag);
+    if (entry == nullptr) {
+        entry = &cache->entries[0];
+        for (int i = 0; i < TAG_CACHE_SIZE; i++) {
+            TagCacheEntry* candidate = &cache->entries[i];
+            if (candidate->tag[0] == '\0') {
+                entry = candidate;
+                break;
+            }
+            if (candidate->lastUse < entry->lastUse) {
+                entry = candidate;
+            }
+        }
+        memset(entry, 0, sizeof(*entry));
+        strncpy(entry->tag, tag, TAG_CACHE_TAG_LEN - 1);
+        changed = true;
+    }
+    if (strncmp(entry->name, name, TAG_CACHE_NAME_LEN - 1) != 0) {
+        strncpy(entry->name, name, TAG_CACHE_NAME_LEN - 1);
+        entry->name[TAG_CACHE_NAME_LEN - 1] = '\0';
+        changed = true;
+    }
+    entry->validatedMs = nowMs;
+    entry->ttlMs = ttlMs;
+    entry->stale = 0;
+    entry->lastUse = ++cache->useCounter;
+    return changed;
+}
+
+/**
+ * @brief Forgets a tag, e.g. after the server reported it as unknown.
+ *
+ * @return true if the tag was cached
+ */
+static inline bool tagCacheRemove(TagCache* cache, const char* tag) {
+    TagCacheEntry* entry = tagCacheFind(cache, tag);
+    if (entry == nullptr) {
+        return false;
+    }
+    memset(entry, 0, sizeof(*entry));
+    return true;
+}
+
+/**
+ * @brief Prepares a copy loaded from NVS: millis() restarted, so nothing is confirmed anymore.
+ *
+ * @return false if the copy has another layout version (cache is reset)
+ */
+static inline bool tagCacheRestore(TagCache* cache) {
+    if (cache->version != TAG_CACHE_VERSION) {
+        tagCacheReset(cache);
+        return false;
+    }
+    for (int i = 0; i < TAG_CACHE_SIZE; i++) {
+        TagCacheEntry* entry = &cache->entries[i];
+        entry->tag[TAG_CACHE_TAG_LEN - 1] = '\0';
+        entry->name[TAG_CACHE_NAME_LEN - 1] = '\0';
+        entry->stale = 1;
+    }
+    return true;
+}
+
+#endif // TAG_CACHE_H
@@ -0,0 +1,131 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ui_scheduler.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#ifdef ENABLE_OLED
+
+#include "ui_scheduler.h"
+#include "mcc_log.h"
+#include <U8g2lib.h>
+
+// External variables from main.cpp
+extern U8G2_SSD1306_128X64_NONAME_F_HW_I2C display;
+extern bool debugEnabled;
+
+static UiScreen screenQueue[UI_SCREEN_QUEUE_LEN];
+static uint8_t queueHead = 0;
+static uint8_t queueCount = 0;
+
+static bool holdActive = false;
+static unsigned long holdStart = 0;
+static uint16_t holdMs = 0;
+
+// Copy of the last frame sent by uiFrameSend() (128x64 monochrome = 1024 bytes)
+static const size_t FRAME_SIZE = 1024;
+static uint8_t lastFrame[FRAME_SIZE];
+static bool lastFrameValid = false;
+
+void uiScreenInit(UiScreen* screen, uint16_t hold) {
+    memset(screen, 0, sizeof(*screen));
+    screen->holdMs = hold;
+}
+
+void uiScreenAddLine(UiScreen* screen, int16_t y, const char* text, int16_t x) {
+    if (screen->lineCount >= UI_SCREEN_MAX_LINES) {
+        return;
+    }
+    uint8_t i = screen->lineCount++;
+    strncpy(screen->text[i], text != nullptr ? text : "", UI_SCREEN_LINE_LEN - 1);
+    screen->text[i][UI_SCREEN_LINE_LEN - 1] = '\0';
+    screen->x[i] = x;
+    screen->y[i] = y;
+}
+
+static void renderScreen(const UiScreen& screen) {
+    display.clearBuffer();
+    display.setFont(u8g2_font_7x14_tf);
+    for (uint8_t i = 0; i < screen.lineCount; i++) {
+        int16_t x = screen.x[i];
+        if (x == UI_ALIGN_CENTER) {
+            x = (128 - display.getStrWidth(screen.text[i])) / 2;
+        }
+        display.setCursor(x, screen.y[i]);
+        display.print(screen.text[i]);
+    }
+    display.sendBuffer();
+
+    holdActive = screen.holdMs > 0;
+    holdStart = millis();
+    holdMs = screen.holdMs;
+}
+
+void uiShowScreen(const UiScreen& screen) {
+    if (!holdActive && queueCount == 0) {
+        renderScreen(screen);
+        return;
+    }
+    if (queueCount == UI_SCREEN_QUEUE_LEN) {
+        // Keep the newest information: drop the oldest waiting screen
+        queueHead = (queueHead + 1) % UI_SCREEN_QUEUE_LEN;
+        queueCount--;
+        MCC_LOGD("OLED screen queue full, oldest screen dropped.");
+    }
+    screenQueue[(queueHead + queueCount) % UI_SCREEN_QUEUE_LEN] = screen;
+    queueCount++;
+}
+
+void uiClearScreens() {
+    queueHead = 0;
+    queueCount = 0;
+    holdActive = false;
+}
+
+bool uiScreenBusy() {
+    return holdActive || queueCount > 0;
+}
+
+bool uiSchedulerLoop() {
+    if (holdActive && millis() - holdStart < holdMs) {
+        return false;
+    }
+    bool wasBusy = uiScreenBusy();
+    holdActive = false;
+    // Screens without hold time are only shown briefly when others are waiting behind them
+    while (!holdActive && queueCount > 0) {
+        UiScreen& next = screenQueue[queueHead];
+        queueHead = (queueHead + 1) % UI_SCREEN_QUEUE_LEN;
+        queueCount--;
+        renderScreen(next);
+    }
+    return wasBusy && !uiScreenBusy();
+}
+
+bool uiFrameBegin() {
+    return lastFrameValid && memcmp(display.getBufferPtr(), lastFrame, FRAME_SIZE) == 0;
+}
+
+void uiFrameSend(bool panelMatches) {
+    uint8_t* buffer = display.getBufferPtr();
+    const int tileWidth = display.getBufferTileWidth();
+    const int tileHeight = display.getBufferTileHeight();
+    const size_t rowBytes = (size_t)tileWidth * 8;
+
+    if (!panelMatches || rowBytes * tileHeight != FRAME_SIZE) {
+        display.sendBuffer();
+    } else {
+        // Buffer layout: one tile row (8 pixel lines) = tileWidth * 8 consecutive bytes
+        for (int row = 0; row < tileHeight; row++) {
+            if (memcmp(buffer + row * rowBytes, lastFrame + row * rowBytes, rowBytes) != 0) {
+                display.updateDisplayArea(0, row, tileWidth, 1);
+            }
+        }
+    }
+    memcpy(lastFrame, buffer, FRAME_SIZE);
+    lastFrameValid = true;
+}
+
+#endif // ENABLE_OLED
@@ -0,0 +1,102 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ui_scheduler.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Non-blocking OLED screens: messages that used to be shown with delay()
+ * are queued with a hold time and expired from loop(), so pulses, RFID
+ * and uploads keep running while they are visible.
+ */
+
+#ifndef UI_SCHEDULER_H
+#define UI_SCHEDULER_H
+
+#ifdef ENABLE_OLED
+
+#include <Arduino.h>
+
+#define UI_SCREEN_MAX_LINES 4
+#define UI_SCREEN_LINE_LEN 40
+#define UI_SCREEN_QUEUE_LEN 4
+
+// x value for horizontally centered lines
+#define UI_ALIGN_CENTER -1
+
+/**
+ * @brief One full-screen text message (font u8g2_font_7x14_tf).
+ */
+struct UiScreen {
+    char text[UI_SCREEN_MAX_LINES][UI_SCREEN_LINE_LEN];
+    int16_t x[UI_SCREEN_MAX_LINES];
+    int16_t y[UI_SCREEN_MAX_LINES];   // Baseline
+    uint8_t lineCount;
+    uint16_t holdMs;                  // 0 = may be replaced right away (e.g. by display_Data())
+};
+
+/**
+ * @brief Clears a screen description.
+ *
+ * @param holdMs Minimum time the screen stays visible before the next one
+ */
+void uiScreenInit(UiScreen* screen, uint16_t holdMs);
+
+/**
+ * @brief Adds a text line; extra lines beyond UI_SCREEN_MAX_LINES are ignored.
+ *
+ * @param y Baseline in pixels (12, 28, 44, 60 for four lines)
+ * @param x Left edge in pixels or UI_ALIGN_CENTER
+ */
+void uiScreenAddLine(UiScreen* screen, int16_t y, const char* text, int16_t x = UI_ALIGN_CENTER);
+
+/**
+ * @brief Shows a screen now, or after the screens that are still held.
+ *
+ * If the queue is full, the oldest waiting screen is dropped.
+ *
+ * @note Hardware interaction: OLED display (I2C) if shown immediately
+ */
+void uiShowScreen(const UiScreen& screen);
+
+/**
+ * @brief Drops the current hold and all waiting screens.
+ */
+void uiClearScreens();
+
+/**
+ * @brief true while a held screen is visible or screens are waiting.
+ *
+ * display_Data() does not draw during that time.
+ */
+bool uiScreenBusy();
+
+/**
+ * @brief Expires the current screen and shows the next one; call from loop().
+ *
+ * @return true when the last held screen just expired (data screen should be redrawn)
+ *
+ * @note Hardware interaction: OLED display (I2C) when the next screen is shown
+ */
+bool uiSchedulerLoop();
+
+/**
+ * @brief Checks whether the panel still shows the last frame sent by uiFrameSend().
+ *
+ * Call before drawing a new frame into the buffer. Other screens send the
+ * whole buffer, which makes the answer false and forces a full update.
+ */
+bool uiFrameBegin();
+
+/**
+ * @brief Sends only the 8-pixel tile rows of the buffer that changed.
+ *
+ * @param panelMatches Return value of uiFrameBegin(); false sends the whole buffer
+ *
+ * @note Hardware interaction: OLED display (I2C, updateDisplayArea per changed row)
+ */
+void uiFrameSend(bool panelMatches);
+
+#endif // ENABLE_OLED
+
+#endif // UI_SCHEDULER_H
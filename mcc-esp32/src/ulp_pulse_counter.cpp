@@ -0,0 +1,152 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ulp_pulse_counter.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "ulp_pulse_counter.h"
+#include "mcc_log.h"
+
+// The macro assembler of the FSM coprocessor is only used on the original ESP32;
+// other chips keep the device awake while riding
+#if defined(CONFIG_IDF_TARGET_ESP32) && (defined(CONFIG_ESP32_ULP_COPROC_ENABLED) || defined(CONFIG_ULP_COPROC_ENABLED))
+#define ULP_PULSE_AVAILABLE 1
+#include "esp32/ulp.h"
+#include "driver/rtc_io.h"
+#include "soc/rtc_cntl_reg.h"
+#include "soc/rtc_io_reg.h"
+#else
+#define ULP_PULSE_AVAILABLE 0
+#endif
+
+// External variables from main.cpp
+extern bool debugEnabled;
+
+#if ULP_PULSE_AVAILABLE
+
+// Word offsets in RTC slow memory (inside the ULP reserved area, before RTC_DATA_ATTR variables).
+// The ULP stores 16-bit values in the lower half of each word.
+enum {
+    ULP_VAR_COUNT = 0,   // Falling edges counted
+    ULP_VAR_LEVEL,       // Pin level of the previous sample
+    ULP_VAR_TICKS,       // Samples since the last counted edge (saturates at 0xFFFF)
+    ULP_VAR_GAP,         // Samples between the last two counted edges
+    ULP_VAR_WORDS = 8    // Program starts here
+};
+
+enum {
+    ULP_LABEL_SATURATED = 1,
+    ULP_LABEL_DONE
+};
+
+static const uint32_t ULP_DEBOUNCE_TICKS = ULP_PULSE_DEBOUNCE_US / ULP_PULSE_TICK_US;
+
+static bool ulpRunning = false;
+static int ulpPin = -1;
+
+static uint32_t ulpVar(int index) {
+    return RTC_SLOW_MEM[index] & 0xFFFF;
+}
+
+#endif // ULP_PULSE_AVAILABLE
+
+bool ulpPulseCounterSupported(int pin) {
+#if ULP_PULSE_AVAILABLE
+    return rtc_gpio_is_valid_gpio((gpio_num_t)pin);
+#else
+    (void)pin;
+    return false;
+#endif
+}
+
+bool ulpPulseCounterStart(int pin) {
+#if ULP_PULSE_AVAILABLE
+    if (ulpRunning || !ulpPulseCounterSupported(pin)) {
+        return ulpRunning;
+    }
+    const int rtcio = rtc_io_number_get((gpio_num_t)pin);
+    const uint32_t inBit = RTC_GPIO_IN_NEXT_S + rtcio;
+
+    const ulp_insn_t program[] = {
+        I_MOVI(R3, 0),                          // R3 = base address of the variables
+        // Samples since the last edge, saturating
+        I_LD(R1, R3, ULP_VAR_TICKS),
+        I_MOVR(R0, R1),
+        M_BGE(ULP_LABEL_SATURATED, 0xFFFF),
+        I_ADDI(R1, R1, 1),
+        I_ST(R1, R3, ULP_VAR_TICKS),
+        M_LABEL(ULP_LABEL_SATURATED),
+        // Level changed?
+        I_RD_REG(RTC_GPIO_IN_REG, inBit, inBit),
+        I_LD(R2, R3, ULP_VAR_LEVEL),
+        I_SUBR(R2, R0, R2),
+        M_BXZ(ULP_LABEL_DONE),
+        I_ST(R0, R3, ULP_VAR_LEVEL),
+        M_BGE(ULP_LABEL_DONE, 1),               // Rising edge: sensor released
+        // Falling edge: ignore contact bounce right after a counted edge
+        I_MOVR(R0, R1),
+        M_BL(ULP_LABEL_DONE, ULP_DEBOUNCE_TICKS),
+        I_ST(R1, R3, ULP_VAR_GAP),
+        I_MOVI(R1, 0),
+        I_ST(R1, R3, ULP_VAR_TICKS),
+        I_LD(R1, R3, ULP_VAR_COUNT),
+        I_ADDI(R1, R1, 1),
+        I_ST(R1, R3, ULP_VAR_COUNT),
+        M_LABEL(ULP_LABEL_DONE),
+        I_HALT()
+    };
+
+    rtc_gpio_init((gpio_num_t)pin);
+    rtc_gpio_set_direction((gpio_num_t)pin, RTC_GPIO_MODE_INPUT_ONLY);
+    rtc_gpio_pullup_en((gpio_num_t)pin);
+    rtc_gpio_pulldown_dis((gpio_num_t)pin);
+
+    RTC_SLOW_MEM[ULP_VAR_COUNT] = 0;
+    RTC_SLOW_MEM[ULP_VAR_LEVEL] = rtc_gpio_get_level((gpio_num_t)pin) ? 1 : 0;
+    RTC_SLOW_MEM[ULP_VAR_TICKS] = 0;
+    RTC_SLOW_MEM[ULP_VAR_GAP] = 0;
+
+    size_t size = sizeof(program) / sizeof(ulp_insn_t);
+    esp_err_t err = ulp_process_macros_and_load(ULP_VAR_WORDS, program, &size);
+    if (err == ESP_OK) {
+        ulp_set_wakeup_period(0, ULP_PULSE_PERIOD_US);
+        err = ulp_run(ULP_VAR_WORDS);
+    }
+    if (err != ESP_OK) {
+        rtc_gpio_deinit((gpio_num_t)pin);
+        MCC_LOGD("[ulpPulse] ULP program could not be started (error %d)\n", (int)err);
+        return false;
+    }
+    ulpRunning = true;
+    ulpPin = pin;
+    return true;
+#else
+    (void)pin;
+    return false;
+#endif
+}
+
+void ulpPulseCounterStop(UlpPulseResult* result) {
+    memset(result, 0, sizeof(*result));
+#if ULP_PULSE_AVAILABLE
+    if (!ulpRunning) {
+        return;
+    }
+    CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+    // Let a run that already started finish writing its variables
+    delayMicroseconds(ULP_PULSE_TICK_US);
+
+    const uint32_t ticks = ulpVar(ULP_VAR_TICKS);
+    result->pulses = ulpVar(ULP_VAR_COUNT);
+    result->sinceLastPulseUs = ticks * ULP_PULSE_TICK_US;
+    // The first gap is measured from the start, not from a previous pulse
+    if (result->pulses >= 2) {
+        result->lastIntervalUs = ulpVar(ULP_VAR_GAP) * ULP_PULSE_TICK_US;
+    }
+
+    rtc_gpio_deinit((gpio_num_t)ulpPin);
+    ulpRunning = false;
+#endif
+}
@@ -0,0 +1,67 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    ulp_pulse_counter.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Wheel sensor counting by the ULP coprocessor while the main cores are in
+ * light sleep. The PCNT unit stops with the APB clock, so during a riding
+ * sleep the sensor pin is handed to the RTC domain and sampled by a small
+ * ULP program that counts falling edges and measures the time between them.
+ */
+
+#ifndef ULP_PULSE_COUNTER_H
+#define ULP_PULSE_COUNTER_H
+
+#include <Arduino.h>
+
+// Sampling period of the ULP program
+#ifndef ULP_PULSE_PERIOD_US
+#define ULP_PULSE_PERIOD_US 1000
+#endif
+
+// One sample takes the period plus the run time of the program (~30 instructions at 8 MHz)
+#define ULP_PULSE_TICK_US (ULP_PULSE_PERIOD_US + 30)
+
+// Edges closer than this are contact bounce (same limit as PULSE_MIN_INTERVAL_US)
+#ifndef ULP_PULSE_DEBOUNCE_US
+#define ULP_PULSE_DEBOUNCE_US 20000
+#endif
+
+/**
+ * @brief Pulses seen by the ULP program since ulpPulseCounterStart().
+ */
+struct UlpPulseResult {
+    uint32_t pulses;
+    uint32_t lastIntervalUs;     // Time between the last two pulses, 0 if fewer than two
+    uint32_t sinceLastPulseUs;   // Time since the last pulse (or since start without pulses)
+};
+
+/**
+ * @brief true if this build and chip can count with the ULP coprocessor.
+ */
+bool ulpPulseCounterSupported(int pin);
+
+/**
+ * @brief Moves the sensor pin to the RTC domain and starts the ULP program.
+ *
+ * From now on the PCNT unit and the capture ISR do not see the pin anymore.
+ *
+ * @param pin GPIO of the wheel sensor, must be an RTC GPIO
+ * @return false if unsupported or the program could not be loaded (pin unchanged)
+ *
+ * @note Hardware interaction: ULP coprocessor, RTC IO of pin
+ */
+bool ulpPulseCounterStart(int pin);
+
+/**
+ * @brief Stops the ULP program and returns the pin to the digital GPIO matrix.
+ *
+ * @param result Receives the pulses counted while the ULP was running
+ *
+ * @note Hardware interaction: ULP coprocessor, RTC IO of pin
+ */
+void ulpPulseCounterStop(UlpPulseResult* result);
+
+#endif
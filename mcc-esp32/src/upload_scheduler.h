@@ -0,0 +1,210 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    upload_scheduler.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * When the next upload is due. Every interval is jittered per device, so
+ * bikes that boot together after a power failure drift apart instead of
+ * hitting the server on the same second. The server can suggest a longer
+ * interval (upload_interval_seconds) and ask for a pause (retry_after);
+ * without one, server errors back off exponentially. A rider who stopped
+ * is uploaded early, an idle bike stretches its interval. Pulses that are
+ * not uploaded stay pending or in the ride journal, so nothing is lost
+ * while backing off.
+ */
+
+#ifndef UPLOAD_SCHEDULER_H
+#define UPLOAD_SCHEDULER_H
+
+#include <stdint.h>
+
+#ifndef UPLOAD_JITTER_PERCENT
+#define UPLOAD_JITTER_PERCENT 10            // Each interval varies by +-10 %
+#endif
+#define UPLOAD_IDLE_STRETCH_MAX 4           // Intervals without pulses: 2x, then 4x
+#define UPLOAD_SESSION_END_MS 10000         // Rider stopped this long with pending pulses: upload now
+#define UPLOAD_BACKOFF_BASE_MS 15000        // First backoff after a server error without retry_after
+#define UPLOAD_BACKOFF_MAX_MS 600000        // Cap of backoff and retry_after
+#define UPLOAD_HINT_MAX_SEC 3600            // Cap of the suggested interval
+
+struct UploadScheduler {
+    uint32_t rng;              // xorshift32 state, seeded per device
+    uint32_t startMs;          // Start of the current interval
+    uint32_t intervalMs;       // Length of the current interval (jitter and stretch applied)
+    uint32_t hintMs;           // Interval suggested by the server, 0 = none
+    uint32_t backoffStartMs;
+    uint32_t backoffMs;        // No uploads for this long after backoffStartMs, 0 = none
+    uint8_t failures;          // Server errors in a row (exponential backoff)
+    uint8_t idleIntervals;     // Intervals in a row without pulses
+    bool early;                // Upload at the next check (rider stopped)
+    bool ridden;               // Pulses since the interval started
+};
+
+static inline uint32_t uploadSchedulerRandom(UploadScheduler* s) {
+    uint32_t x = s->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s->rng = x;
+    return x;
+}
+
+/**
+ * @brief Length of the next interval: the configured or suggested interval, stretched while idle, +-jitter.
+ */
+static inline uint32_t uploadSchedulerNextInterval(UploadScheduler* s, uint32_t baseMs) {
+    uint32_t ms = s->hintMs > baseMs ? s->hintMs : baseMs;
+    uint32_t stretch = 1u << s->idleIntervals;
+    if (stretch > UPLOAD_IDLE_STRETCH_MAX) {
+        stretch = UPLOAD_IDLE_STRETCH_MAX;
+    }
+    ms *= stretch;
+    const uint32_t span = ms / 100 * UPLOAD_JITTER_PERCENT;
+    if (span > 0) {
+        ms = ms - span + uploadSchedulerRandom(s) % (2 * span + 1);
+    }
+    return ms;
+}
+
+/**
+ * @brief Starts the schedule; the first interval falls anywhere between half and one and a half intervals.
+ *
+ * @param seed Per-device value (e.g. from the MAC address)
+ */
+static inline void uploadSchedulerInit(UploadScheduler* s, uint32_t seed, uint32_t nowMs, uint32_t baseMs) {
+    s->rng = seed != 0 ? seed : 0x9E3779B9u;
+    s->startMs = nowMs;
+    s->intervalMs = baseMs / 2 + (baseMs > 0 ? uploadSchedulerRandom(s) % baseMs : 0);
+    s->hintMs = 0;
+    s->backoffStartMs = 0;
+    s->backoffMs = 0;
+    s->failures = 0;
+    s->idleIntervals = 0;
+    s->early = false;
+    s->ridden = false;
+}
+
+/**
+ * @brief Returns true while the server asked for a pause or errors are backed off.
+ */
+static inline bool uploadSchedulerBackingOff(const UploadScheduler* s, uint32_t nowMs) {
+    return s->backoffMs > 0 && nowMs - s->backoffStartMs < s->backoffMs;
+}
+
+/**
+ * @brief Returns true if an upload is due: interval over or early send requested, and no backoff.
+ */
+static inline bool uploadSchedulerDue(const UploadScheduler* s, uint32_t nowMs) {
+    if (uploadSchedulerBackingOff(s, nowMs)) {
+        return false;
+    }
+    return s->early || nowMs - s->startMs >= s->intervalMs;
+}
+
+/**
+ * @brief Milliseconds until the next upload may be due (0 if due), for sleeping until then.
+ */
+static inline uint32_t uploadSchedulerRemainingMs(const UploadScheduler* s, uint32_t nowMs) {
+    uint32_t remaining = 0;
+    if (!s->early && nowMs - s->startMs < s->intervalMs) {
+        remaining = s->intervalMs - (nowMs - s->startMs);
+    }
+    if (uploadSchedulerBackingOff(s, nowMs)) {
+        const uint32_t backoffLeft = s->backoffMs - (nowMs - s->backoffStartMs);
+        if (backoffLeft > remaining) {
+            remaining = backoffLeft;
+        }
+    }
+    return remaining;
+}
+
+/**
+ * @brief A due interval was taken (uploaded, queued or skipped); the next one starts now.
+ */
+static inline void uploadSchedulerStart(UploadScheduler* s, uint32_t nowMs, uint32_t baseMs) {
+    if (s->ridden) {
+        s->idleIntervals = 0;
+    } else if (s->idleIntervals < 8) {
+        s->idleIntervals++;
+    }
+    s->startMs = nowMs;
+    s->intervalMs = uploadSchedulerNextInterval(s, baseMs);
+    s->early = false;
+    s->ridden = false;
+}
+
+/**
+ * @brief New pulses were counted; a stretched idle interval is shortened to the normal one.
+ */
+static inline void uploadSchedulerPulses(UploadScheduler* s, uint32_t baseMs) {
+    s->ridden = true;
+    if (s->idleIntervals > 0) {
+        s->idleIntervals = 0;
+        s->intervalMs = uploadSchedulerNextInterval(s, baseMs);
+    }
+}
+
+/**
+ * @brief Requests an upload at the next check once the rider stopped for UPLOAD_SESSION_END_MS.
+ *
+ * Only pulses since the interval started count, so a stop is uploaded once.
+ *
+ * @param sinceLastPulseMs Time since the last counted pulse
+ * @return true if the early upload was requested now
+ */
+static inline bool uploadSchedulerSessionEnd(UploadScheduler* s, uint32_t sinceLastPulseMs) {
+    if (!s->ridden || s->early || sinceLastPulseMs < UPLOAD_SESSION_END_MS) {
+        return false;
+    }
+    s->early = true;
+    return true;
+}
+
+/**
+ * @brief The server accepted a request: the backoff ends.
+ */
+static inline void uploadSchedulerSucceeded(UploadScheduler* s) {
+    s->failures = 0;
+    s->backoffMs = 0;
+}
+
+/**
+ * @brief Applies the interval suggestion of an upload response from the next interval on.
+ *
+ * @param hintSec upload_interval_seconds, 0 if not sent (suggestion withdrawn)
+ */
+static inline void uploadSchedulerSetHint(UploadScheduler* s, uint32_t hintSec) {
+    s->hintMs = (hintSec > UPLOAD_HINT_MAX_SEC ? UPLOAD_HINT_MAX_SEC : hintSec) * 1000;
+}
+
+/**
+ * @brief Server error (5xx, 429): pauses uploads for retry_after or an exponential backoff.
+ *
+ * Up to a quarter is added at random, so the retries of many devices spread out.
+ *
+ * @param retryAfterSec retry_after of the response, 0 if not sent
+ * @return Backoff in milliseconds
+ */
+static inline uint32_t uploadSchedulerFailed(UploadScheduler* s, uint32_t nowMs, uint32_t retryAfterSec) {
+    uint32_t ms;
+    if (retryAfterSec > 0) {
+        ms = retryAfterSec < UPLOAD_BACKOFF_MAX_MS / 1000 ? retryAfterSec * 1000 : UPLOAD_BACKOFF_MAX_MS;
+    } else {
+        const uint8_t shift = s->failures < 6 ? s->failures : 6;
+        ms = UPLOAD_BACKOFF_BASE_MS << shift;
+    }
+    ms += uploadSchedulerRandom(s) % (ms / 4 + 1);
+    if (ms > UPLOAD_BACKOFF_MAX_MS) {
+        ms = UPLOAD_BACKOFF_MAX_MS;
+    }
+    if (s->failures < 255) {
+        s->failures++;
+    }
+    s->backoffStartMs = nowMs;
+    s->backoffMs = ms;
+    return ms;
+}
+
+#endif // UPLOAD_SCHEDULER_H
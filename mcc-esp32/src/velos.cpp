@@ -58,3 +58,19 @@ void formatVelosDE(int velos, char* buffer, size_t bufferSize) {
 
     buffer[out] = '\0';
 }
+
+int velosEstimate(const VelosAnchor* anchor, uint32_t pulses, float radumfang_mm, float paedagogischer_bonus) {
+    if (anchor == nullptr || !anchor->valid) {
+        return 0;
+    }
+    if (pulses <= anchor->pulses) {
+        return anchor->velos;
+    }
+    const float localKm = static_cast<float>(pulses - anchor->pulses) * radumfang_mm / 1000000.0f;
+    if (anchor->sessionKm < 0.0f) {
+        return anchor->velos + calcVelos(localKm, radumfang_mm, paedagogischer_bonus);
+    }
+    const int velos = calcVelos(anchor->sessionKm + localKm, radumfang_mm, paedagogischer_bonus);
+    // float rounding of session_km must not show less than the server did
+    return velos > anchor->velos ? velos : anchor->velos;
+}
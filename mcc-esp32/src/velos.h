@@ -12,6 +12,7 @@
 #define VELOS_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 static const int FKM_BASE_MM = 2300;
 static const int VELOS_PER_KM = 100;
@@ -21,4 +22,25 @@ int calcVelosFromFkm(float km, float fkm_factor);
 int calcVelos(float km, float radumfang_mm, float paedagogischer_bonus);
 void formatVelosDE(int velos, char* buffer, size_t bufferSize);
 
+/**
+ * Last server session value and the local pulses it already contains.
+ */
+struct VelosAnchor {
+    bool valid;
+    float sessionKm;   // session_km of the server response, negative if not sent
+    int velos;         // Session Velos of the server response
+    uint32_t pulses;   // Local pulse count included in the server value
+};
+
+/**
+ * @brief Session Velos including the pulses counted after the server value.
+ *
+ * Uses the server formula on the cumulative distance, so the estimate
+ * matches the next server value for the same pulses. Falls back to adding
+ * the local Velos if the server sent no session_km.
+ *
+ * @return Estimated session Velos, never below the server value; 0 if the anchor is not valid
+ */
+int velosEstimate(const VelosAnchor* anchor, uint32_t pulses, float radumfang_mm, float paedagogischer_bonus);
+
 #endif
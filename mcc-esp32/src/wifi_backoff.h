@@ -0,0 +1,59 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    wifi_backoff.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Retry delay and network selection of the WiFi manager.
+ */
+
+#ifndef WIFI_BACKOFF_H
+#define WIFI_BACKOFF_H
+
+#include <stdint.h>
+
+/**
+ * @brief Delay before the next connection attempt: exponential backoff with jitter.
+ *
+ * The delay doubles with every failure up to maxMs. Half of it is fixed and
+ * half is random, so devices that lost the same router do not retry in lockstep
+ * when it comes back.
+ *
+ * @param failures Consecutive failed attempts (1 after the first failure)
+ * @param baseMs Delay after the first failure (before jitter)
+ * @param maxMs Upper bound of the delay
+ * @param random Any random number (e.g. esp_random())
+ * @return Delay in milliseconds, between half and all of the backoff step
+ */
+static inline uint32_t wifiBackoffDelayMs(uint32_t failures, uint32_t baseMs, uint32_t maxMs, uint32_t random) {
+    uint32_t delayMs = baseMs;
+    for (uint32_t i = 1; i < failures && delayMs < maxMs; i++) {
+        delayMs = delayMs > maxMs / 2 ? maxMs : delayMs * 2;
+    }
+    if (delayMs > maxMs) {
+        delayMs = maxMs;
+    }
+    const uint32_t half = delayMs / 2;
+    return half + random % (delayMs - half + 1);
+}
+
+/**
+ * @brief Picks the configured network to connect to from a scan result.
+ *
+ * @param scanRssi RSSI per configured network, INT32_MIN if it was not seen in the scan
+ * @param count Number of configured networks
+ * @param fallback Index to use if none of them was seen (e.g. hidden SSIDs, round robin)
+ * @return Index of the strongest network that was seen, else fallback
+ */
+static inline uint8_t wifiSelectNetwork(const int32_t* scanRssi, uint8_t count, uint8_t fallback) {
+    int best = -1;
+    for (uint8_t i = 0; i < count; i++) {
+        if (scanRssi[i] != INT32_MIN && (best < 0 || scanRssi[i] > scanRssi[best])) {
+            best = i;
+        }
+    }
+    return best >= 0 ? (uint8_t)best : fallback;
+}
+
+#endif // WIFI_BACKOFF_H
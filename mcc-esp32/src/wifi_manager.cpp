@@ -0,0 +1,303 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    wifi_manager.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include "wifi_manager.h"
+#include "mcc_log.h"
+#include <WiFi.h>
+#include "esp_system.h"
+#include "fast_resume.h"
+#include "metrics.h"
+#include "wifi_backoff.h"
+
+// External variables from main.cpp
+extern bool debugEnabled;
+
+// Async scans normally take 2-4 s; after this the attempt continues without a result
+static const unsigned long WIFI_SCAN_TIMEOUT_MS = 8000;
+// Disconnect events right after WiFi.begin() can belong to the previous connection
+static const unsigned long WIFI_DISCONNECT_GRACE_MS = 1000;
+
+struct WifiNetwork {
+    String ssid;
+    String password;
+};
+
+static WifiNetwork wifiNetworks[WIFI_MANAGER_MAX_NETWORKS];
+static String wifiStaticIp;
+static WifiManagerState wifiState = WIFI_MGR_IDLE;
+static uint8_t wifiNetworkIndex = 0;        // Network of the current attempt
+static uint8_t wifiFallbackIndex = 0;       // Tried next if the scan finds no configured network
+static bool wifiFastAttempt = false;
+static bool wifiDhcp = false;              // Address of the current attempt comes from DHCP (no static IP, no cached lease)
+static uint32_t wifiFailureCount = 0;
+static unsigned long wifiConnectStartMs = 0;  // Start of the connection (scan included), for the metrics
+static unsigned long wifiAttemptStartMs = 0;  // Start of the current state (scan or WiFi.begin())
+static uint32_t wifiRetryDelayMs = 0;
+static bool wifiEventsRegistered = false;
+
+// Written by the WiFi event task
+static volatile bool wifiGotIp = false;
+static volatile bool wifiDisconnected = false;   // Edge, cleared by the state machine
+static volatile uint8_t wifiDisconnectReason = 0;
+
+static void wifiManagerEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            wifiGotIp = true;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            wifiDisconnectReason = info.wifi_sta_disconnected.reason;
+            wifiGotIp = false;
+            wifiDisconnected = true;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+            wifiGotIp = false;
+            wifiDisconnected = true;
+            break;
+        default:
+            break;
+    }
+}
+
+static uint8_t networkCount() {
+    if (wifiNetworks[0].ssid.length() == 0) {
+        return 0;
+    }
+    return wifiNetworks[1].ssid.length() > 0 ? 2 : 1;
+}
+
+static void beginAttempt(uint8_t index) {
+    const WifiNetwork& network = wifiNetworks[index];
+    wifiNetworkIndex = index;
+    wifiFastAttempt = false;
+
+    IPAddress address, gateway, subnet, dns;
+    wifiDhcp = !(index == 0 && staticIpParse(wifiStaticIp, &address, &gateway, &subnet, &dns));
+    if (!wifiDhcp) {
+        WiFi.config(address, gateway, subnet, dns);
+    } else {
+        // DHCP, also after a fast wakeup that reused the cached lease
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    }
+    wifiDisconnected = false;
+    WiFi.begin(network.ssid.c_str(), network.password.c_str());
+    wifiAttemptStartMs = millis();
+    wifiState = WIFI_MGR_CONNECTING;
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: [wifi] Connecting to %s (attempt %u)\n", network.ssid.c_str(),
+                      (unsigned)wifiFailureCount + 1);
+    }
+}
+
+/**
+ * @brief Starts a regular attempt: directly with one network, after a scan with two.
+ */
+static void startAttempt() {
+    const uint8_t count = networkCount();
+    if (count == 0) {
+        wifiState = WIFI_MGR_IDLE;
+        return;
+    }
+    if (count == 1) {
+        beginAttempt(0);
+        return;
+    }
+    if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) {
+        beginAttempt(wifiFallbackIndex);
+        return;
+    }
+    wifiAttemptStartMs = millis();
+    wifiState = WIFI_MGR_SCANNING;
+}
+
+static void pollScan() {
+    const int16_t found = WiFi.scanComplete();
+    if (found == WIFI_SCAN_RUNNING && millis() - wifiAttemptStartMs < WIFI_SCAN_TIMEOUT_MS) {
+        return;
+    }
+
+    const uint8_t count = networkCount();
+    int32_t rssi[WIFI_MANAGER_MAX_NETWORKS];
+    for (uint8_t i = 0; i < count; i++) {
+        rssi[i] = INT32_MIN;
+    }
+    for (int16_t n = 0; n < found; n++) {
+        const String ssid = WiFi.SSID(n);
+        for (uint8_t i = 0; i < count; i++) {
+            if (ssid == wifiNetworks[i].ssid && WiFi.RSSI(n) > rssi[i]) {
+                rssi[i] = WiFi.RSSI(n);
+            }
+        }
+    }
+    WiFi.scanDelete();
+
+    const uint8_t index = wifiSelectNetwork(rssi, count, wifiFallbackIndex);
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: [wifi] Scan: %s %ld dBm, %s %ld dBm\n",
+                      wifiNetworks[0].ssid.c_str(), (long)rssi[0], wifiNetworks[1].ssid.c_str(), (long)rssi[1]);
+    }
+    beginAttempt(index);
+}
+
+static WifiManagerEvent attemptFailed() {
+    metricsRecordWifiConnect(millis() - wifiConnectStartMs, false);
+    WiFi.disconnect();
+    wifiFailureCount++;
+    // Without a scan result the next attempt uses the other network
+    wifiFallbackIndex = (uint8_t)((wifiNetworkIndex + 1) % (networkCount() > 0 ? networkCount() : 1));
+    wifiRetryDelayMs = wifiBackoffDelayMs(wifiFailureCount, WIFI_MANAGER_BACKOFF_BASE_MS,
+                                          WIFI_MANAGER_BACKOFF_MAX_MS, esp_random());
+    wifiAttemptStartMs = millis();
+    wifiState = WIFI_MGR_BACKOFF;
+    if (debugEnabled) {
+        logSerial.printf("DEBUG: [wifi] Connection to %s failed (reason %u), %u failure(s), retry in %u ms\n",
+                      wifiNetworks[wifiNetworkIndex].ssid.c_str(), (unsigned)wifiDisconnectReason,
+                      (unsigned)wifiFailureCount, (unsigned)wifiRetryDelayMs);
+    }
+    return WIFI_MGR_EVENT_FAILED;
+}
+
+void wifiManagerBegin() {
+    if (wifiEventsRegistered) {
+        return;
+    }
+    WiFi.onEvent(wifiManagerEvent);
+    // The driver would otherwise reconnect on its own, without backoff
+    WiFi.setAutoReconnect(false);
+    wifiEventsRegistered = true;
+}
+
+void wifiManagerSetNetwork(uint8_t index, const String& ssid, const String& password) {
+    if (index >= WIFI_MANAGER_MAX_NETWORKS) {
+        return;
+    }
+    wifiNetworks[index].ssid = ssid;
+    wifiNetworks[index].password = password;
+}
+
+void wifiManagerConnect(bool fast, const String& staticIp) {
+    wifiManagerBegin();
+    wifiStaticIp = staticIp;
+    wifiFailureCount = 0;
+    wifiFallbackIndex = 0;
+    wifiGotIp = false;
+    wifiConnectStartMs = millis();
+
+    // After deep sleep: known channel and BSSID, no scan; cached lease or static IP, no DHCP
+    const uint8_t count = networkCount();
+    for (uint8_t i = 0; fast && i < count; i++) {
+        if (fastResumeAvailable(wifiNetworks[i].ssid) &&
+            fastResumeWifiBegin(wifiNetworks[i].ssid, wifiNetworks[i].password, i == 0 ? staticIp : String(""),
+                                &wifiDhcp)) {
+            wifiNetworkIndex = i;
+            wifiFastAttempt = true;
+            wifiDisconnected = false;
+            wifiAttemptStartMs = millis();
+            wifiState = WIFI_MGR_CONNECTING;
+            return;
+        }
+    }
+    startAttempt();
+}
+
+void wifiManagerStop() {
+    if (wifiState == WIFI_MGR_SCANNING) {
+        WiFi.scanDelete();
+    }
+    wifiState = WIFI_MGR_IDLE;
+}
+
+WifiManagerEvent wifiManagerLoop() {
+    const unsigned long now = millis();
+    switch (wifiState) {
+        case WIFI_MGR_IDLE:
+            return WIFI_MGR_EVENT_NONE;
+
+        case WIFI_MGR_SCANNING:
+            pollScan();
+            return WIFI_MGR_EVENT_NONE;
+
+        case WIFI_MGR_CONNECTING:
+            if (wifiGotIp) {
+                metricsRecordWifiConnect(now - wifiConnectStartMs, true);
+                if (debugEnabled) {
+                    logSerial.printf("DEBUG: [wifi] Connected to %s after %lu ms%s, RSSI %d dBm\n",
+                                  wifiNetworks[wifiNetworkIndex].ssid.c_str(), now - wifiConnectStartMs,
+                                  wifiFastAttempt ? " (fast resume)" : "", (int)WiFi.RSSI());
+                }
+                fastResumeSaveWifi(wifiNetworks[wifiNetworkIndex].ssid, wifiDhcp);
+                wifiFailureCount = 0;
+                wifiDisconnected = false;
+                wifiState = WIFI_MGR_CONNECTED;
+                return WIFI_MGR_EVENT_CONNECTED;
+            }
+            if (wifiFastAttempt) {
+                if (now - wifiAttemptStartMs < FAST_RESUME_CONNECT_TIMEOUT_MS) {
+                    return WIFI_MGR_EVENT_NONE;
+                }
+                // Cached data is stale (other channel, new lease); a regular attempt follows right away
+                fastResumeWifiFailed();
+                startAttempt();
+                return WIFI_MGR_EVENT_NONE;
+            }
+            if (now - wifiAttemptStartMs >= WIFI_MANAGER_CONNECT_TIMEOUT_MS ||
+                (wifiDisconnected && now - wifiAttemptStartMs >= WIFI_DISCONNECT_GRACE_MS)) {
+                return attemptFailed();
+            }
+            return WIFI_MGR_EVENT_NONE;
+
+        case WIFI_MGR_CONNECTED:
+            if (wifiGotIp && !wifiDisconnected) {
+                return WIFI_MGR_EVENT_NONE;
+            }
+            if (debugEnabled) {
+                logSerial.printf("DEBUG: [wifi] Connection to %s lost (reason %u), reconnecting\n",
+                              wifiNetworks[wifiNetworkIndex].ssid.c_str(), (unsigned)wifiDisconnectReason);
+            }
+            wifiConnectStartMs = now;
+            wifiFallbackIndex = wifiNetworkIndex;
+            startAttempt();
+            return WIFI_MGR_EVENT_LOST;
+
+        case WIFI_MGR_BACKOFF:
+            if (now - wifiAttemptStartMs >= wifiRetryDelayMs) {
+                wifiConnectStartMs = now;
+                startAttempt();
+            }
+            return WIFI_MGR_EVENT_NONE;
+    }
+    return WIFI_MGR_EVENT_NONE;
+}
+
+WifiManagerState wifiManagerState() {
+    return wifiState;
+}
+
+bool wifiManagerConnected() {
+    return wifiGotIp;
+}
+
+uint32_t wifiManagerFailures() {
+    return wifiFailureCount;
+}
+
+uint32_t wifiManagerRetryInMs() {
+    if (wifiState != WIFI_MGR_BACKOFF) {
+        return 0;
+    }
+    const unsigned long waited = millis() - wifiAttemptStartMs;
+    return waited >= wifiRetryDelayMs ? 0 : wifiRetryDelayMs - waited;
+}
+
+bool wifiManagerFastResumed() {
+    return wifiState == WIFI_MGR_CONNECTED && wifiFastAttempt;
+}
+
+const String& wifiManagerSsid() {
+    return wifiNetworks[wifiNetworkIndex].ssid;
+}
@@ -0,0 +1,117 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    wifi_manager.h
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Non-blocking WiFi station connection. WiFi events report connect and
+ * disconnect; wifiManagerLoop() advances scan, connect and retry from
+ * loop() without waiting. Failed attempts are retried forever with
+ * exponential backoff and jitter. With a fallback network configured, a
+ * scan picks the stronger of the two.
+ */
+
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <Arduino.h>
+
+// Primary network (wifi_ssid) plus one fallback network (wifi_ssid2)
+#define WIFI_MANAGER_MAX_NETWORKS 2
+
+// One attempt is given up after this time (same as the former 20 x 500 ms)
+#ifndef WIFI_MANAGER_CONNECT_TIMEOUT_MS
+#define WIFI_MANAGER_CONNECT_TIMEOUT_MS 10000
+#endif
+
+// Delay after the first failure; doubles per failure up to WIFI_MANAGER_BACKOFF_MAX_MS
+#ifndef WIFI_MANAGER_BACKOFF_BASE_MS
+#define WIFI_MANAGER_BACKOFF_BASE_MS 2000
+#endif
+
+#ifndef WIFI_MANAGER_BACKOFF_MAX_MS
+#define WIFI_MANAGER_BACKOFF_MAX_MS 300000
+#endif
+
+enum WifiManagerState : uint8_t {
+    WIFI_MGR_IDLE = 0,     // Not started or stopped (config mode, sleep)
+    WIFI_MGR_SCANNING,     // Async scan to choose between the configured networks
+    WIFI_MGR_CONNECTING,   // WiFi.begin() issued, waiting for an IP address
+    WIFI_MGR_CONNECTED,
+    WIFI_MGR_BACKOFF       // Waiting for the next attempt
+};
+
+enum WifiManagerEvent : uint8_t {
+    WIFI_MGR_EVENT_NONE = 0,
+    WIFI_MGR_EVENT_CONNECTED,   // Got an IP address
+    WIFI_MGR_EVENT_FAILED,      // An attempt timed out or was rejected; the next one is scheduled
+    WIFI_MGR_EVENT_LOST         // An established connection dropped; reconnecting
+};
+
+/**
+ * @brief Registers the WiFi event handler; call once before the first connection.
+ *
+ * @note Hardware interaction: WiFi driver (auto reconnect off, the manager decides when to retry)
+ */
+void wifiManagerBegin();
+
+/**
+ * @brief Sets a network; an empty SSID removes it.
+ *
+ * @param index 0 = primary (uses the static IP setting), 1 = fallback (always DHCP)
+ */
+void wifiManagerSetNetwork(uint8_t index, const String& ssid, const String& password);
+
+/**
+ * @brief Starts a connection attempt now and clears the backoff.
+ *
+ * @param fast Try the fast resume data (cached channel, BSSID, lease) first
+ * @param staticIp static_ip setting for the primary network (empty: DHCP)
+ *
+ * @note Hardware interaction: WiFi radio
+ */
+void wifiManagerConnect(bool fast, const String& staticIp);
+
+/**
+ * @brief Stops retrying, e.g. before WiFi is switched off on purpose.
+ */
+void wifiManagerStop();
+
+/**
+ * @brief Advances the connection state machine; call from loop(), never blocks.
+ *
+ * @return Transition since the last call, WIFI_MGR_EVENT_NONE if nothing happened
+ *
+ * @note Side effects: Records connect times in the metrics, saves fast resume data
+ */
+WifiManagerEvent wifiManagerLoop();
+
+WifiManagerState wifiManagerState();
+
+/**
+ * @brief true while the station has an IP address; safe to call from any task.
+ */
+bool wifiManagerConnected();
+
+/**
+ * @brief Consecutive failed attempts since the last connection.
+ */
+uint32_t wifiManagerFailures();
+
+/**
+ * @brief Time until the next attempt in WIFI_MGR_BACKOFF, else 0.
+ */
+uint32_t wifiManagerRetryInMs();
+
+/**
+ * @brief true if the current connection came from the fast resume data.
+ */
+bool wifiManagerFastResumed();
+
+/**
+ * @brief SSID of the current or last attempt.
+ */
+const String& wifiManagerSsid();
+
+#endif
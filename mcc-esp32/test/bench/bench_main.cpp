@@ -0,0 +1,274 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    bench_main.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Host micro-benchmarks of the data-processing kernels. Every kernel is
+ * timed (ns/op) and its heap allocations are counted (allocs/op). The
+ * allocation count is deterministic, so it is checked against a budget:
+ * the program exits with 1 when a kernel allocates more than before, e.g.
+ * because a String sneaked into the pulse path. Times are only reported.
+ *
+ * Run with: pio run -e native_bench -t exec
+ */
+
+#ifdef MCC_BENCHMARK
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Plain C++ ArduinoJson: no Arduino String/Stream/Print on the host
+#define ARDUINOJSON_ENABLE_ARDUINO_STRING 0
+#define ARDUINOJSON_ENABLE_ARDUINO_STREAM 0
+#define ARDUINOJSON_ENABLE_ARDUINO_PRINT 0
+#define ARDUINOJSON_ENABLE_PROGMEM 0
+#include <ArduinoJson.h>
+
+#include "../../src/velos.h"
+#include "../../src/velos.cpp"
+#include "../../src/speed_average.h"
+#include "../../src/ride_stats.h"
+#include "../../src/api_wire.h"
+
+// --- Allocation counting ---------------------------------------------------
+
+// Counts C++ allocations (std::string, the String mock, containers). C malloc
+// is not intercepted; StaticJsonDocument, as used by the firmware, does not allocate.
+static size_t allocCount = 0;
+
+void* operator new(size_t size) {
+    allocCount++;
+    void* p = malloc(size != 0 ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocCount++;
+    return malloc(size != 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+// --- Harness ----------------------------------------------------------------
+
+// Keeps a result alive without letting the compiler drop the computation
+template <typename T>
+static inline void benchKeep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+typedef void (*BenchKernel)(uint32_t i);
+
+struct BenchCase {
+    const char* name;
+    BenchKernel kernel;
+    double maxAllocsPerOp;  // Budget; the current firmware code stays below it
+};
+
+static const double BENCH_MIN_RUN_MS = 50.0;  // Calibrated iteration count runs at least this long
+static const int BENCH_REPEATS = 5;           // Best of: filters out scheduler noise
+
+static double runIterations(BenchKernel kernel, uint32_t iterations) {
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        kernel(i);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/**
+ * @brief Times one kernel and checks its allocation budget.
+ *
+ * @return true if the allocations per operation are within the budget
+ */
+static bool runBench(const BenchCase& bench) {
+    // Warm up and find an iteration count that runs for BENCH_MIN_RUN_MS
+    uint32_t iterations = 1000;
+    while (runIterations(bench.kernel, iterations) < BENCH_MIN_RUN_MS * 1e6 && iterations < (1u << 30)) {
+        iterations *= 2;
+    }
+
+    double bestNs = 0.0;
+    size_t allocs = 0;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        const size_t allocsBefore = allocCount;
+        const double ns = runIterations(bench.kernel, iterations) / iterations;
+        allocs = allocCount - allocsBefore;
+        if (r == 0 || ns < bestNs) {
+            bestNs = ns;
+        }
+    }
+
+    const double allocsPerOp = (double)allocs / iterations;
+    const bool ok = allocsPerOp <= bench.maxAllocsPerOp;
+    printf("%-24s %12.1f %12.3f %10u  %s\n", bench.name, bestNs, allocsPerOp, (unsigned)iterations,
+           ok ? "ok" : "ALLOCATION BUDGET EXCEEDED");
+    return ok;
+}
+
+// --- Kernels ----------------------------------------------------------------
+
+static const float WHEEL_SIZE_MM = 2075.0f;
+static const float PAEDAGOGICAL_BONUS = 0.3f;
+
+static void benchCalcVelos(uint32_t i) {
+    const float km = (float)(i & 0xFFF) * 0.001f;
+    benchKeep(calcVelos(km, WHEEL_SIZE_MM, PAEDAGOGICAL_BONUS));
+}
+
+static void benchCalcFkmFactor(uint32_t i) {
+    benchKeep(calcFkmFactor(WHEEL_SIZE_MM + (float)(i & 0x3FF), PAEDAGOGICAL_BONUS));
+}
+
+static void benchFormatVelosDE(uint32_t i) {
+    char buffer[16];
+    formatVelosDE((int)(i * 7919u & 0xFFFFFF), buffer, sizeof(buffer));
+    benchKeep(buffer[0]);
+}
+
+static SpeedAverage benchAverage;
+static RideStats benchRideStats;
+
+static void benchSpeedAverage(uint32_t i) {
+    // One pulse at 15..30 km/h, as the capture task computes per edge
+    const uint32_t interval_us = 250000 + (i & 0xFFFF);
+    benchKeep(speedAveragePush(&benchAverage, (WHEEL_SIZE_MM / (float)interval_us) * 3600.0f));
+}
+
+static void benchRideStatsAdd(uint32_t i) {
+    // Per accepted edge in the capture task, 15..30 km/h
+    rideStatsAddInterval(&benchRideStats, 250000 + (i & 0xFFFF), 2075, 5000000);
+    benchKeep(benchRideStats.maxCkmh);
+}
+
+static RideTrace benchTrace;
+static uint32_t benchTraceUs = 0;
+
+static void benchRideTraceAdd(uint32_t i) {
+    // Per accepted edge in the capture task with trace_max_bytes set; a full trace starts over
+    if (benchTrace.closed) {
+        rideTraceBegin(&benchTrace, nullptr, RIDE_TRACE_MAX_BYTES);
+    }
+    benchTraceUs += 250000 + (i & 0xFF) * 64;
+    benchKeep(rideTraceAdd(&benchTrace, benchTraceUs));
+}
+
+/**
+ * Mirrors buildUpdateDataPayload() in main.cpp (payload of sendDataToServer()).
+ */
+static void benchUpdateDataPayload(uint32_t i) {
+    StaticJsonDocument<512> doc;
+    apiWireUpdateData(doc.to<JsonObject>(), "MCC-Bike-Demo-a1b2c3", "04a1b2c3d4e5f6",
+                      (float)(i & 0xFFFF) * 2075.0f / 1000000.0f);
+    apiWireRideStats(doc.as<JsonObject>(), benchRideStats);
+    char out[448];
+    if (measureJson(doc) < sizeof(out)) {
+        benchKeep(serializeJson(doc, out, sizeof(out)));
+    }
+}
+
+static const char DISPLAY_RESPONSE[] =
+    "{\"success\":true,\"display_mode\":\"live\",\"display_velos_display\":\"4.520\","
+    "\"session_velos_display\":\"1.230\",\"session_epoch\":\"2026-10-14T08:00:00Z\","
+    "\"message\":\"Data received\"}";
+
+/**
+ * The reading part of applyDisplayVelosFromDocument() in device_management.cpp.
+ */
+static void benchDisplayVelosParse(uint32_t i) {
+    static char displayed[16];
+    static char epoch[40];
+    StaticJsonDocument<512> responseDoc;
+    // const input: the strings are copied, as in the firmware
+    if (deserializeJson(responseDoc, (const char*)DISPLAY_RESPONSE)) {
+        return;
+    }
+    ApiWireDisplayVelos fields;
+    if (!apiWireDisplayVelos(responseDoc.as<JsonVariantConst>(), &fields)) {
+        return;
+    }
+    if (strcmp(epoch, fields.epoch) != 0) {
+        snprintf(epoch, sizeof(epoch), "%s", fields.epoch);
+    }
+    snprintf(displayed, sizeof(displayed), "%s", fields.text);
+    benchKeep(displayed[i & 3]);
+}
+
+/**
+ * Mirrors RFID_MFRC522_uidToHex() in rfid_mfrc522_control.cpp.
+ */
+static void uidToHex(const uint8_t* buffer, uint8_t bufferSize, char* out, size_t outSize) {
+    static const char digits[] = "0123456789abcdef";
+    size_t pos = 0;
+    for (uint8_t b = 0; b < bufferSize && pos + 2 < outSize; b++) {
+        out[pos++] = digits[buffer[b] >> 4];
+        out[pos++] = digits[buffer[b] & 0x0F];
+    }
+    if (outSize > 0) {
+        out[pos] = '\0';
+    }
+}
+
+static void benchUidToHex(uint32_t i) {
+    const uint8_t uid[7] = {0x04, (uint8_t)i, (uint8_t)(i >> 8), 0x56, 0x78, 0x9A, 0xBC};
+    char out[21];
+    uidToHex(uid, sizeof(uid), out, sizeof(out));
+    benchKeep(out[2]);
+}
+
+static const BenchCase BENCHES[] = {
+    {"calcVelos", benchCalcVelos, 0.0},
+    {"calcFkmFactor", benchCalcFkmFactor, 0.0},
+    {"formatVelosDE", benchFormatVelosDE, 0.0},
+    {"speedAveragePush", benchSpeedAverage, 0.0},
+    {"rideStatsAddInterval", benchRideStatsAdd, 0.0},
+    {"rideTraceAdd", benchRideTraceAdd, 0.0},
+    {"updateDataPayload", benchUpdateDataPayload, 0.0},
+    {"displayVelosParse", benchDisplayVelosParse, 0.0},
+    {"uidToHex", benchUidToHex, 0.0},
+};
+
+int main() {
+    speedAverageReset(&benchAverage);
+    rideStatsReset(&benchRideStats);
+    rideTraceBegin(&benchTrace, nullptr, RIDE_TRACE_MAX_BYTES);
+    printf("%-24s %12s %12s %10s\n", "kernel", "ns/op", "allocs/op", "iterations");
+    bool ok = true;
+    for (const BenchCase& bench : BENCHES) {
+        ok = runBench(bench) && ok;
+    }
+    return ok ? 0 : 1;
+}
+
+#endif // MCC_BENCHMARK
@@ -0,0 +1,919 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    fleet_main.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ *
+ * Host fleet simulator: emulates many devices against an mcc-web server.
+ * Request bodies are built and responses read with the firmware's own
+ * api_wire.h, so the server sees exactly what a device sends. Every device
+ * rides a profile (steady, intervals, stop-and-go) with jitter, swaps
+ * riders of its group, sleeps now and then and follows the send and config
+ * fetch intervals from the server config. Reported are the latency
+ * percentiles per endpoint, the error classes of the firmware and how far
+ * the schedule fell behind (the load generator itself being the bottleneck).
+ *
+ * Devices and ID tags come from a generate_large_test_data fixture, which
+ * must be loaded on the server first (load_test_data). Plain HTTP only.
+ *
+ * Run with: pio run -e native_fleet && .pio/build/native_fleet/program \
+ *     --server http://127.0.0.1:8000 --api-key KEY --data ../mcc-web/api/tests/test_data_medium.json
+ *
+ * Smoke run against a local runserver: add --devices 5 --duration 60. It should
+ * report "errors: 0" and a schedule lag of a few ms; 403 means the key is
+ * neither MCC_APP_API_KEY nor the shared IoT device key.
+ */
+
+#ifdef MCC_FLEET
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// Plain C++ ArduinoJson: no Arduino String/Stream/Print on the host
+#define ARDUINOJSON_ENABLE_ARDUINO_STRING 0
+#define ARDUINOJSON_ENABLE_ARDUINO_STREAM 0
+#define ARDUINOJSON_ENABLE_ARDUINO_PRINT 0
+#define ARDUINOJSON_ENABLE_PROGMEM 0
+#include <ArduinoJson.h>
+
+#include "../../src/ride_stats.h"
+#include "../../src/metrics_registry.h"
+#include "../../src/api_wire.h"
+#include "../../src/tag_cache.h"
+
+typedef std::chrono::steady_clock FleetClock;
+
+// Firmware defaults (main.cpp, device_management.h)
+static const uint32_t FLEET_WHEEL_MM = 2075;                  // 26 inch, default of wheel_size
+static const uint32_t FLEET_IDLE_THRESHOLD_US = 5000000;      // SPEED_TIMEOUT_MS: longer intervals count as idle
+static const uint32_t FLEET_HEARTBEAT_SEC = 60;               // HEARTBEAT_INTERVAL_MS
+static const uint32_t FLEET_CONFIG_FETCH_SEC = 3600;          // config_fetch_interval_seconds
+static const int FLEET_TIMEOUT_MS = 10000;                    // NET_WORKER_HTTP_TIMEOUT_MS
+
+// --- Options ------------------------------------------------------------------
+
+struct FleetOptions {
+    std::string host = "127.0.0.1";
+    std::string port = "8000";
+    std::string apiKey;
+    std::string dataFile;
+    uint32_t devices = 0;              // 0 = all devices of the fixture
+    uint32_t durationSec = 300;
+    uint32_t connections = 8;          // Worker threads, one keep-alive connection each
+    uint32_t sendIntervalSec = 30;     // Until the config fetch sends send_interval_seconds
+    double jitter = 0.1;               // Relative jitter of intervals and speeds
+    double swapRate = 0.05;            // Rider swap probability per upload
+    double sleepRate = 0.01;           // Deep sleep probability per upload
+    double maxErrorRate = 1.0;         // Percent; exit code 1 above
+    uint32_t seed = 1;
+};
+
+static void printUsage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s --api-key KEY --data FIXTURE.json [options]\n"
+            "  --server URL          http://host:port (default http://127.0.0.1:8000)\n"
+            "  --devices N           Simulated devices (default: all of the fixture)\n"
+            "  --duration SEC        Run time (default 300)\n"
+            "  --connections N       Worker threads and keep-alive connections (default 8)\n"
+            "  --send-interval SEC   Upload interval before the first config fetch (default 30)\n"
+            "  --jitter F            Relative jitter of intervals and speeds (default 0.1)\n"
+            "  --swap-rate F         Rider swap probability per upload (default 0.05)\n"
+            "  --sleep-rate F        Deep sleep probability per upload (default 0.01)\n"
+            "  --max-error-rate PCT  Exit with 1 above this error rate (default 1.0)\n"
+            "  --seed N              Random seed (default 1)\n",
+            program);
+}
+
+static bool parseServer(const char* url, FleetOptions* options) {
+    static const char HTTP[] = "http://";
+    if (strncmp(url, HTTP, sizeof(HTTP) - 1) != 0) {
+        fprintf(stderr, "Only http:// servers are supported: %s\n", url);
+        return false;
+    }
+    std::string rest(url + sizeof(HTTP) - 1);
+    const size_t slash = rest.find('/');
+    if (slash != std::string::npos) {
+        rest.resize(slash);
+    }
+    const size_t colon = rest.rfind(':');
+    if (colon != std::string::npos) {
+        options->host = rest.substr(0, colon);
+        options->port = rest.substr(colon + 1);
+    } else {
+        options->host = rest;
+        options->port = "80";
+    }
+    return !options->host.empty();
+}
+
+static bool parseOptions(int argc, char** argv, FleetOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--help") == 0) {
+            return false;
+        }
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return false;
+        }
+        i++;
+        if (strcmp(arg, "--server") == 0) {
+            if (!parseServer(value, options)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--api-key") == 0) {
+            options->apiKey = value;
+        } else if (strcmp(arg, "--data") == 0) {
+            options->dataFile = value;
+        } else if (strcmp(arg, "--devices") == 0) {
+            options->devices = (uint32_t)strtoul(value, nullptr, 10);
+        } else if (strcmp(arg, "--duration") == 0) {
+            options->durationSec = (uint32_t)strtoul(value, nullptr, 10);
+        } else if (strcmp(arg, "--connections") == 0) {
+            options->connections = std::max(1u, (uint32_t)strtoul(value, nullptr, 10));
+        } else if (strcmp(arg, "--send-interval") == 0) {
+            options->sendIntervalSec = std::max(1u, (uint32_t)strtoul(value, nullptr, 10));
+        } else if (strcmp(arg, "--jitter") == 0) {
+            options->jitter = atof(value);
+        } else if (strcmp(arg, "--swap-rate") == 0) {
+            options->swapRate = atof(value);
+        } else if (strcmp(arg, "--sleep-rate") == 0) {
+            options->sleepRate = atof(value);
+        } else if (strcmp(arg, "--max-error-rate") == 0) {
+            options->maxErrorRate = atof(value);
+        } else if (strcmp(arg, "--seed") == 0) {
+            options->seed = (uint32_t)strtoul(value, nullptr, 10);
+        } else {
+            fprintf(stderr, "Unknown option %s\n", arg);
+            return false;
+        }
+    }
+    return !options->apiKey.empty() && !options->dataFile.empty();
+}
+
+// --- HTTP client --------------------------------------------------------------
+
+struct FleetResponse {
+    int status;                // HTTP status, or -1 for a connection error (as HTTPClient)
+    std::string etag;
+    std::string body;
+};
+
+/**
+ * @brief One keep-alive connection, reconnected after errors and "Connection: close".
+ */
+class FleetConnection {
+public:
+    FleetConnection(const std::string& host, const std::string& port, const std::string& apiKey)
+        : host_(host), port_(port), apiKey_(apiKey) {}
+
+    ~FleetConnection() {
+        close();
+    }
+
+    FleetResponse request(const char* method, const std::string& path, const char* body, size_t bodyLen,
+                          const char* ifNoneMatch) {
+        // A stale keep-alive connection fails on the first write or read; one retry on a fresh one
+        for (int attempt = 0; attempt < 2; attempt++) {
+            const bool reused = fd_ >= 0;
+            if (fd_ < 0 && !open()) {
+                break;
+            }
+            FleetResponse response;
+            if (send(method, path, body, bodyLen, ifNoneMatch) && receive(&response)) {
+                return response;
+            }
+            close();
+            if (!reused) {
+                break;
+            }
+        }
+        FleetResponse failed;
+        failed.status = -1;
+        return failed;
+    }
+
+private:
+    bool open() {
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        if (getaddrinfo(host_.c_str(), port_.c_str(), &hints, &result) != 0) {
+            return false;
+        }
+        for (addrinfo* ai = result; ai != nullptr && fd_ < 0; ai = ai->ai_next) {
+            fd_ = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (fd_ < 0) {
+                continue;
+            }
+            timeval timeout = {FLEET_TIMEOUT_MS / 1000, 0};
+            setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            const int one = 1;
+            setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            if (connect(fd_, ai->ai_addr, ai->ai_addrlen) != 0) {
+                ::close(fd_);
+                fd_ = -1;
+            }
+        }
+        freeaddrinfo(result);
+        buffer_.clear();
+        return fd_ >= 0;
+    }
+
+    void close() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        buffer_.clear();
+    }
+
+    bool send(const char* method, const std::string& path, const char* body, size_t bodyLen, const char* ifNoneMatch) {
+        std::string head;
+        head.reserve(256);
+        head += method;
+        head += ' ';
+        head += path;
+        head += " HTTP/1.1\r\nHost: ";
+        head += host_;
+        head += "\r\nConnection: keep-alive\r\nX-Api-Key: ";
+        head += apiKey_;
+        head += "\r\n";
+        if (ifNoneMatch != nullptr) {
+            head += "If-None-Match: ";
+            head += ifNoneMatch;
+            head += "\r\n";
+        }
+        if (body != nullptr) {
+            head += "Content-Type: application/json\r\nContent-Length: ";
+            head += std::to_string(bodyLen);
+            head += "\r\n";
+        }
+        head += "\r\n";
+        if (body != nullptr) {
+            head.append(body, bodyLen);
+        }
+        size_t sent = 0;
+        while (sent < head.size()) {
+            const ssize_t n = ::send(fd_, head.data() + sent, head.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            sent += (size_t)n;
+        }
+        return true;
+    }
+
+    bool fill() {
+        char chunk[4096];
+        const ssize_t n = recv(fd_, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return false;
+        }
+        buffer_.append(chunk, (size_t)n);
+        return true;
+    }
+
+    static bool headerIs(const std::string& line, const char* name) {
+        const size_t len = strlen(name);
+        return line.size() > len && strncasecmp(line.c_str(), name, len) == 0 && line[len] == ':';
+    }
+
+    static std::string headerValue(const std::string& line) {
+        size_t start = line.find(':') + 1;
+        while (start < line.size() && line[start] == ' ') {
+            start++;
+        }
+        return line.substr(start);
+    }
+
+    /**
+     * @brief Reads status line, headers and a Content-Length or chunked body.
+     *
+     * A response without length ends with the connection.
+     */
+    bool receive(FleetResponse* response) {
+        size_t headerEnd;
+        while ((headerEnd = buffer_.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        const std::string head = buffer_.substr(0, headerEnd + 2);
+        buffer_.erase(0, headerEnd + 4);
+        if (sscanf(head.c_str(), "HTTP/1.%*d %d", &response->status) != 1) {
+            return false;
+        }
+
+        long contentLength = -1;
+        bool chunked = false;
+        bool keepAlive = true;
+        size_t lineStart = head.find("\r\n") + 2;
+        while (lineStart < head.size()) {
+            const size_t lineEnd = head.find("\r\n", lineStart);
+            const std::string line = head.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 2;
+            if (headerIs(line, "Content-Length")) {
+                contentLength = atol(headerValue(line).c_str());
+            } else if (headerIs(line, "Transfer-Encoding")) {
+                chunked = headerValue(line).find("chunked") != std::string::npos;
+            } else if (headerIs(line, "Connection")) {
+                keepAlive = strncasecmp(headerValue(line).c_str(), "close", 5) != 0;
+            } else if (headerIs(line, "ETag")) {
+                response->etag = headerValue(line);
+            }
+        }
+
+        if (response->status == 304 || response->status == 204) {
+            contentLength = 0;
+        }
+        if (chunked) {
+            for (;;) {
+                size_t sizeEnd;
+                while ((sizeEnd = buffer_.find("\r\n")) == std::string::npos) {
+                    if (!fill()) {
+                        return false;
+                    }
+                }
+                const size_t size = strtoul(buffer_.c_str(), nullptr, 16);
+                while (buffer_.size() < sizeEnd + 2 + size + 2) {
+                    if (!fill()) {
+                        return false;
+                    }
+                }
+                response->body.append(buffer_, sizeEnd + 2, size);
+                buffer_.erase(0, sizeEnd + 2 + size + 2);
+                if (size == 0) {
+                    break;
+                }
+            }
+        } else if (contentLength >= 0) {
+            while (buffer_.size() < (size_t)contentLength) {
+                if (!fill()) {
+                    return false;
+                }
+            }
+            response->body = buffer_.substr(0, (size_t)contentLength);
+            buffer_.erase(0, (size_t)contentLength);
+        } else {
+            while (fill()) {
+            }
+            response->body.swap(buffer_);
+            keepAlive = false;
+        }
+        if (!keepAlive) {
+            close();
+        }
+        return true;
+    }
+
+    std::string host_;
+    std::string port_;
+    std::string apiKey_;
+    int fd_ = -1;
+    std::string buffer_;     // Received but not yet consumed bytes
+};
+
+// --- Results ------------------------------------------------------------------
+
+enum FleetEndpoint : uint8_t {
+    EP_UPDATE_DATA = 0,
+    EP_GET_USER_ID,
+    EP_HEARTBEAT,
+    EP_CONFIG_FETCH,
+    EP_COUNT
+};
+
+static const char* const ENDPOINT_NAMES[EP_COUNT] = {"update-data", "get-user-id", "heartbeat", "config/fetch"};
+static const char* const WIRE_ERROR_NAMES[API_WIRE_ERROR_COUNT] = {"ok", "api_key", "not_found", "maintenance",
+                                                                   "server", "connection"};
+static const char* const STATUS_CLASS_NAMES[METRIC_STATUS_COUNT] = {"2xx", "3xx", "4xx", "5xx", "conn"};
+
+/**
+ * @brief Results of one worker; merged after the run.
+ *
+ * Latencies are kept as raw samples, so the percentiles are exact.
+ */
+struct FleetResults {
+    std::vector<uint32_t> latencyUs[EP_COUNT];
+    uint32_t wireErrors[EP_COUNT][API_WIRE_ERROR_COUNT] = {};
+    uint32_t statusClasses[EP_COUNT][METRIC_STATUS_COUNT] = {};
+    std::vector<uint32_t> lagUs;       // Start of each request behind its schedule
+    uint32_t notModified = 0;          // 304 of config fetches
+    uint32_t riderSwaps = 0;
+    uint32_t sleeps = 0;
+    uint64_t distanceMm = 0;
+
+    void merge(const FleetResults& other) {
+        for (int e = 0; e < EP_COUNT; e++) {
+            latencyUs[e].insert(latencyUs[e].end(), other.latencyUs[e].begin(), other.latencyUs[e].end());
+            for (int c = 0; c < API_WIRE_ERROR_COUNT; c++) {
+                wireErrors[e][c] += other.wireErrors[e][c];
+            }
+            for (int c = 0; c < METRIC_STATUS_COUNT; c++) {
+                statusClasses[e][c] += other.statusClasses[e][c];
+            }
+        }
+        lagUs.insert(lagUs.end(), other.lagUs.begin(), other.lagUs.end());
+        notModified += other.notModified;
+        riderSwaps += other.riderSwaps;
+        sleeps += other.sleeps;
+        distanceMm += other.distanceMm;
+    }
+};
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, double percent) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const size_t rank = (size_t)std::ceil(percent / 100.0 * sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+// --- Devices ------------------------------------------------------------------
+
+enum RideProfile : uint8_t {
+    RIDE_STEADY = 0,      // Constant speed around the base speed
+    RIDE_INTERVALS,       // Alternating sprints and easy riding
+    RIDE_STOP_AND_GO,     // Riding with pauses (idle time)
+    RIDE_PROFILE_COUNT
+};
+
+struct FleetDevice {
+    std::string name;
+    const std::vector<std::string>* riders;   // ID tags of the device's group
+    size_t rider;                              // Index into riders
+    RideProfile profile;
+    double baseKmh;
+    uint32_t sendIntervalSec;
+    uint32_t configFetchSec;
+    uint32_t configHash;                       // 0 until the first config fetch
+    const char* bootReason;                    // Sent with the next update, then nullptr
+    double rideSec;                            // Time in the ride profile
+    uint32_t carryUs;                          // Part of a wheel revolution carried into the next interval
+};
+
+enum FleetEventKind : uint8_t {
+    EV_UPLOAD = 0,        // get-user-id after a swap, then update-data
+    EV_HEARTBEAT,
+    EV_CONFIG_FETCH
+};
+
+struct FleetEvent {
+    FleetClock::time_point due;
+    uint32_t device;
+    FleetEventKind kind;
+
+    bool operator>(const FleetEvent& other) const {
+        return due > other.due;
+    }
+};
+
+/**
+ * @brief Loads devices and the ID tags per group from a generate_large_test_data fixture.
+ */
+static bool loadFixture(const std::string& path, std::vector<std::string>* deviceNames, std::vector<long>* deviceGroups,
+                        std::vector<std::pair<long, std::string>>* tags) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot open %s\n", path.c_str());
+        return false;
+    }
+    std::string json;
+    char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        json.append(chunk, n);
+    }
+    fclose(file);
+
+    StaticJsonDocument<256> filter;
+    filter["devices"][0]["name"] = true;
+    filter["devices"][0]["group_id"] = true;
+    filter["cyclists"][0]["id_tag"] = true;
+    filter["cyclists"][0]["group_ids"] = true;
+
+    DynamicJsonDocument doc(json.size() + 4096);
+    const DeserializationError error = deserializeJson(doc, json, DeserializationOption::Filter(filter));
+    if (error) {
+        fprintf(stderr, "Cannot parse %s: %s\n", path.c_str(), error.c_str());
+        return false;
+    }
+    for (JsonVariantConst device : doc["devices"].as<JsonArrayConst>()) {
+        const char* name = device["name"] | "";
+        if (name[0] != '\0') {
+            deviceNames->push_back(name);
+            deviceGroups->push_back(device["group_id"] | -1L);
+        }
+    }
+    for (JsonVariantConst cyclist : doc["cyclists"].as<JsonArrayConst>()) {
+        const char* idTag = cyclist["id_tag"] | "";
+        for (JsonVariantConst group : cyclist["group_ids"].as<JsonArrayConst>()) {
+            if (idTag[0] != '\0') {
+                tags->push_back(std::make_pair(group.as<long>(), std::string(idTag)));
+            }
+        }
+    }
+    return !deviceNames->empty();
+}
+
+// --- Simulation ---------------------------------------------------------------
+
+class FleetWorker {
+public:
+    FleetWorker(const FleetOptions& options, std::vector<FleetDevice>* devices, uint32_t seed)
+        : options_(options), devices_(devices), connection_(options.host, options.port, options.apiKey), random_(seed) {}
+
+    void add(uint32_t device, FleetClock::time_point start) {
+        // Devices start spread over one send interval, as after a power failure of a school
+        const FleetDevice& d = (*devices_)[device];
+        const auto offset = std::chrono::milliseconds((uint64_t)(uniform() * d.sendIntervalSec * 1000));
+        schedule(start + offset, device, EV_CONFIG_FETCH);
+        schedule(start + offset + std::chrono::seconds(d.sendIntervalSec), device, EV_UPLOAD);
+        schedule(start + offset + std::chrono::seconds(FLEET_HEARTBEAT_SEC), device, EV_HEARTBEAT);
+    }
+
+    void run(FleetClock::time_point end) {
+        while (!queue_.empty()) {
+            const FleetEvent event = queue_.top();
+            if (event.due >= end) {
+                break;
+            }
+            queue_.pop();
+            std::this_thread::sleep_until(event.due);
+            const auto lag = FleetClock::now() - event.due;
+            results_.lagUs.push_back((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(lag).count());
+            handle(event);
+        }
+    }
+
+    const FleetResults& results() const {
+        return results_;
+    }
+
+private:
+    double uniform() {
+        return std::uniform_real_distribution<double>(0.0, 1.0)(random_);
+    }
+
+    // Factor around 1 within +-jitter
+    double jitter() {
+        return 1.0 + options_.jitter * (2.0 * uniform() - 1.0);
+    }
+
+    void schedule(FleetClock::time_point due, uint32_t device, FleetEventKind kind) {
+        FleetEvent event;
+        event.due = due;
+        event.device = device;
+        event.kind = kind;
+        queue_.push(event);
+    }
+
+    FleetClock::duration jittered(uint32_t seconds) {
+        return std::chrono::microseconds((int64_t)(seconds * 1e6 * jitter()));
+    }
+
+    FleetResponse request(FleetEndpoint endpoint, const char* method, const std::string& path, const char* body,
+                          size_t bodyLen, const char* ifNoneMatch = nullptr) {
+        const auto start = FleetClock::now();
+        FleetResponse response = connection_.request(method, path, body, bodyLen, ifNoneMatch);
+        const auto elapsed = FleetClock::now() - start;
+        results_.latencyUs[endpoint].push_back(
+            (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        results_.statusClasses[endpoint][metricStatusClass(response.status)]++;
+        // 304 is the expected answer of a config fetch, not an error
+        const ApiWireError error = response.status == 304 ? API_WIRE_OK : apiWireError(response.status);
+        results_.wireErrors[endpoint][error]++;
+        return response;
+    }
+
+    void handle(const FleetEvent& event) {
+        FleetDevice& device = (*devices_)[event.device];
+        switch (event.kind) {
+            case EV_UPLOAD: {
+                const uint32_t sleepSec = upload(&device);
+                schedule(event.due + jittered(device.sendIntervalSec + sleepSec), event.device, EV_UPLOAD);
+                break;
+            }
+            case EV_HEARTBEAT:
+                heartbeat(device);
+                schedule(event.due + jittered(FLEET_HEARTBEAT_SEC), event.device, EV_HEARTBEAT);
+                break;
+            case EV_CONFIG_FETCH:
+                configFetch(&device);
+                schedule(event.due + jittered(device.configFetchSec), event.device, EV_CONFIG_FETCH);
+                break;
+        }
+    }
+
+    // Speed of the ride profile at a point in time, 0 while standing
+    double speedKmh(const FleetDevice& device, double t) {
+        switch (device.profile) {
+            case RIDE_INTERVALS:
+                return device.baseKmh * (fmod(t, 120.0) < 30.0 ? 1.4 : 0.8);
+            case RIDE_STOP_AND_GO:
+                return fmod(t, 90.0) < 60.0 ? device.baseKmh : 0.0;
+            default:
+                return device.baseKmh;
+        }
+    }
+
+    /**
+     * @brief Simulates the pulse intervals of one upload interval into the ride statistics.
+     *
+     * @return Distance in mm
+     */
+    uint32_t ride(FleetDevice* device, uint32_t intervalSec, RideStats* stats) {
+        rideStatsReset(stats);
+        const uint64_t intervalUs = (uint64_t)intervalSec * 1000000u;
+        uint64_t t = device->carryUs;
+        uint32_t idleUs = 0;
+        while (t < intervalUs) {
+            const double kmh = speedKmh(*device, device->rideSec + t / 1e6) * jitter();
+            if (kmh < 2.0) {
+                // Standing: the pause ends with the next pulse and is counted as idle there
+                idleUs += 1000000;
+                t += 1000000;
+                continue;
+            }
+            // mm / (km/h) * 3600 = us per revolution
+            const uint32_t revolutionUs = (uint32_t)(FLEET_WHEEL_MM * 3600.0 / kmh);
+            rideStatsAddInterval(stats, idleUs > 0 ? idleUs + revolutionUs : revolutionUs, FLEET_WHEEL_MM,
+                                 FLEET_IDLE_THRESHOLD_US);
+            idleUs = 0;
+            t += revolutionUs;
+        }
+        device->carryUs = (uint32_t)(t - intervalUs);
+        device->rideSec += intervalSec;
+        return stats->intervals * FLEET_WHEEL_MM;
+    }
+
+    /**
+     * @brief Swaps the rider (get-user-id), rides one interval and uploads it.
+     *
+     * @return Seconds the device sleeps before the next upload
+     */
+    uint32_t upload(FleetDevice* device) {
+        if (device->riders->size() > 1 && uniform() < options_.swapRate) {
+            swapRider(device);
+        }
+        const std::string& idTag = (*device->riders)[device->rider];
+
+        RideStats stats;
+        const uint32_t distanceMm = ride(device, device->sendIntervalSec, &stats);
+        results_.distanceMm += distanceMm;
+
+        StaticJsonDocument<512> doc;
+        apiWireUpdateData(doc.to<JsonObject>(), device->name.c_str(), idTag.c_str(), distanceMm / 1000000.0f);
+        if (device->bootReason != nullptr) {
+            doc["boot_reason"] = device->bootReason;
+            device->bootReason = nullptr;
+        }
+        apiWireRideStats(doc.as<JsonObject>(), stats);
+        char body[512];
+        const size_t len = serializeJson(doc, body, sizeof(body));
+        const FleetResponse response = request(EP_UPDATE_DATA, "POST", "/api/update-data", body, len);
+        if (response.status == 200) {
+            // Read as the firmware does; the value only shows on the OLED
+            StaticJsonDocument<1024> responseDoc;
+            ApiWireDisplayVelos display;
+            if (!deserializeJson(responseDoc, response.body)) {
+                apiWireDisplayVelos(responseDoc.as<JsonVariantConst>(), &display);
+            }
+        }
+
+        if (uniform() < options_.sleepRate) {
+            // Deep sleep: the next upload reports the wake-up and starts a new ride
+            results_.sleeps++;
+            device->bootReason = "deep_sleep";
+            device->carryUs = 0;
+            return (uint32_t)(device->sendIntervalSec * (2 + 8 * uniform()));
+        }
+        return 0;
+    }
+
+    void swapRider(FleetDevice* device) {
+        const size_t next = (device->rider + 1 + (size_t)(uniform() * (device->riders->size() - 1))) %
+                            device->riders->size();
+        const std::string& tag = (*device->riders)[next];
+        StaticJsonDocument<256> doc;
+        apiWireUserIdQuery(doc.to<JsonObject>(), tag.c_str(), device->name.c_str(),
+                           (*device->riders)[device->rider].c_str());
+        char body[256];
+        const size_t len = serializeJson(doc, body, sizeof(body));
+        const FleetResponse response = request(EP_GET_USER_ID, "POST", "/api/get-user-id", body, len);
+        if (response.status != 200) {
+            return;
+        }
+        StaticJsonDocument<512> responseDoc;
+        if (deserializeJson(responseDoc, response.body)) {
+            return;
+        }
+        const ApiWireUserId result = apiWireUserId(responseDoc.as<JsonVariantConst>(), TAG_CACHE_DEFAULT_TTL_SEC);
+        if (result.userId != nullptr && strcmp(result.userId, "NULL") != 0 && !result.operatorTag) {
+            device->rider = next;
+            results_.riderSwaps++;
+        }
+    }
+
+    void heartbeat(const FleetDevice& device) {
+        StaticJsonDocument<256> doc;
+        // Heap values of a healthy device; the server does not evaluate them yet
+        apiWireHeartbeat(doc.to<JsonObject>(), device.name.c_str(), 150000, 120000, 90000);
+        char body[256];
+        const size_t len = serializeJson(doc, body, sizeof(body));
+        request(EP_HEARTBEAT, "POST", "/api/device/heartbeat", body, len);
+    }
+
+    void configFetch(FleetDevice* device) {
+        char etag[16];
+        const bool conditional = apiWireConfigEtag(etag, sizeof(etag), device->configHash);
+        const FleetResponse response = request(EP_CONFIG_FETCH, "GET", "/api/device/config/fetch?device_id=" + device->name,
+                                               nullptr, 0, conditional ? etag : nullptr);
+        if (response.status == 304) {
+            results_.notModified++;
+            return;
+        }
+        if (response.status != 200) {
+            return;
+        }
+        StaticJsonDocument<2048> doc;
+        if (deserializeJson(doc, response.body)) {
+            return;
+        }
+        device->configHash = doc["config_hash"] | 0u;
+        const uint32_t sendInterval = doc["config"]["send_interval_seconds"] | 0u;
+        if (sendInterval > 0) {
+            device->sendIntervalSec = sendInterval;
+        }
+        const uint32_t fetchInterval = doc["config"]["config_fetch_interval_seconds"] | 0u;
+        if (fetchInterval > 0) {
+            device->configFetchSec = fetchInterval;
+        }
+    }
+
+    const FleetOptions& options_;
+    std::vector<FleetDevice>* devices_;   // Shared vector; each worker only touches its own devices
+    FleetConnection connection_;
+    std::mt19937 random_;
+    std::priority_queue<FleetEvent, std::vector<FleetEvent>, std::greater<FleetEvent>> queue_;
+    FleetResults results_;
+};
+
+// --- Report -------------------------------------------------------------------
+
+/**
+ * @brief Prints the report.
+ *
+ * @return Error rate in percent (everything but API_WIRE_OK)
+ */
+static double printReport(FleetResults* results, double elapsedSec, size_t deviceCount) {
+    uint32_t total = 0;
+    uint32_t errors = 0;
+    printf("\n%-14s %8s %9s %9s %9s %9s %9s", "endpoint", "requests", "req/s", "p50 ms", "p90 ms", "p99 ms", "max ms");
+    for (int c = 1; c < API_WIRE_ERROR_COUNT; c++) {
+        printf(" %11s", WIRE_ERROR_NAMES[c]);
+    }
+    printf("\n");
+    for (int e = 0; e < EP_COUNT; e++) {
+        std::vector<uint32_t>& samples = results->latencyUs[e];
+        std::sort(samples.begin(), samples.end());
+        printf("%-14s %8zu %9.1f %9.1f %9.1f %9.1f %9.1f", ENDPOINT_NAMES[e], samples.size(), samples.size() / elapsedSec,
+               percentile(samples, 50) / 1000.0, percentile(samples, 90) / 1000.0, percentile(samples, 99) / 1000.0,
+               samples.empty() ? 0.0 : samples.back() / 1000.0);
+        for (int c = 1; c < API_WIRE_ERROR_COUNT; c++) {
+            printf(" %11u", results->wireErrors[e][c]);
+            errors += results->wireErrors[e][c];
+        }
+        printf("\n");
+        total += (uint32_t)samples.size();
+    }
+
+    printf("\nHTTP classes:");
+    for (int c = 0; c < METRIC_STATUS_COUNT; c++) {
+        uint32_t count = 0;
+        for (int e = 0; e < EP_COUNT; e++) {
+            count += results->statusClasses[e][c];
+        }
+        printf(" %s=%u", STATUS_CLASS_NAMES[c], count);
+    }
+    printf("  (config fetch 304: %u)\n", results->notModified);
+
+    std::sort(results->lagUs.begin(), results->lagUs.end());
+    printf("Schedule lag: p50 %.1f ms, p99 %.1f ms, max %.1f ms%s\n", percentile(results->lagUs, 50) / 1000.0,
+           percentile(results->lagUs, 99) / 1000.0, results->lagUs.empty() ? 0.0 : results->lagUs.back() / 1000.0,
+           percentile(results->lagUs, 99) > 1000000 ? "  (generator saturated: raise --connections)" : "");
+    printf("Devices: %zu, rider swaps: %u, sleeps: %u, distance: %.1f km\n", deviceCount, results->riderSwaps,
+           results->sleeps, results->distanceMm / 1000000.0);
+
+    const double errorRate = total > 0 ? 100.0 * errors / total : 0.0;
+    printf("Requests: %u in %.0f s, errors: %u (%.2f %%)\n", total, elapsedSec, errors, errorRate);
+    return errorRate;
+}
+
+int main(int argc, char** argv) {
+    FleetOptions options;
+    if (!parseOptions(argc, argv, &options)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> names;
+    std::vector<long> groups;
+    std::vector<std::pair<long, std::string>> tags;
+    if (!loadFixture(options.dataFile, &names, &groups, &tags)) {
+        return 2;
+    }
+
+    // Riders per group; a device without riders of its own group uses all tags
+    std::vector<long> groupIds;
+    std::vector<std::vector<std::string>> ridersByGroup;
+    std::vector<std::string> allRiders;
+    for (const auto& tag : tags) {
+        allRiders.push_back(tag.second);
+        const auto it = std::find(groupIds.begin(), groupIds.end(), tag.first);
+        if (it == groupIds.end()) {
+            groupIds.push_back(tag.first);
+            ridersByGroup.push_back(std::vector<std::string>(1, tag.second));
+        } else {
+            ridersByGroup[it - groupIds.begin()].push_back(tag.second);
+        }
+    }
+    if (allRiders.empty()) {
+        fprintf(stderr, "No cyclists with ID tags in %s\n", options.dataFile.c_str());
+        return 2;
+    }
+
+    std::mt19937 random(options.seed);
+    const size_t count = options.devices > 0 ? options.devices : names.size();
+    std::vector<FleetDevice> devices(count);
+    for (size_t i = 0; i < count; i++) {
+        // More devices than in the fixture: the names repeat, as several boards of one device would
+        const size_t source = i % names.size();
+        FleetDevice& device = devices[i];
+        device.name = names[source];
+        const auto it = std::find(groupIds.begin(), groupIds.end(), groups[source]);
+        device.riders = it != groupIds.end() ? &ridersByGroup[it - groupIds.begin()] : &allRiders;
+        device.rider = random() % device.riders->size();
+        device.profile = (RideProfile)(random() % RIDE_PROFILE_COUNT);
+        device.baseKmh = 12.0 + (random() % 1300) / 100.0;     // 12-25 km/h
+        device.sendIntervalSec = options.sendIntervalSec;
+        device.configFetchSec = FLEET_CONFIG_FETCH_SEC;
+        device.configHash = 0;
+        device.bootReason = "power_on";
+        device.rideSec = 0.0;
+        device.carryUs = 0;
+    }
+
+    std::vector<FleetWorker*> workers;
+    for (uint32_t w = 0; w < options.connections; w++) {
+        workers.push_back(new FleetWorker(options, &devices, options.seed * 7919u + w));
+    }
+    const auto start = FleetClock::now();
+    const auto end = start + std::chrono::seconds(options.durationSec);
+    for (size_t i = 0; i < count; i++) {
+        workers[i % workers.size()]->add((uint32_t)i, start);
+    }
+
+    printf("Simulating %zu devices (%zu in the fixture, %zu ID tags) against %s:%s for %u s on %u connections\n",
+           count, names.size(), allRiders.size(), options.host.c_str(), options.port.c_str(), options.durationSec,
+           options.connections);
+    std::vector<std::thread> threads;
+    for (FleetWorker* worker : workers) {
+        threads.emplace_back([worker, end]() { worker->run(end); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const double elapsedSec = std::chrono::duration<double>(FleetClock::now() - start).count();
+
+    FleetResults total;
+    for (FleetWorker* worker : workers) {
+        total.merge(worker->results());
+        delete worker;
+    }
+    const double errorRate = printReport(&total, elapsedSec, count);
+    return errorRate > options.maxErrorRate ? 1 : 0;
+}
+
+#endif // MCC_FLEET
@@ -0,0 +1,52 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_bike_channel.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/bike_channel.h"
+
+void test_bike_channel() {
+    BikeChannel channels[BIKE_CHANNEL_MAX - 1];
+
+    // Empty setting: no further bikes
+    TEST_ASSERT_EQUAL_UINT8(0, bikeChannelParse("", channels));
+
+    // Entries with spaces around them, the ID tag is the rest of the entry
+    TEST_ASSERT_EQUAL_UINT8(2, bikeChannelParse(" 4:2075:bike-2 ; 16:1900.5:bike:3", channels));
+    TEST_ASSERT_EQUAL_INT(4, channels[0].pin);
+    TEST_ASSERT_EQUAL_FLOAT(2075.0f, channels[0].wheelSize_mm);
+    TEST_ASSERT_EQUAL_STRING("bike-2", channels[0].idTag);
+    TEST_ASSERT_EQUAL_INT(16, channels[1].pin);
+    TEST_ASSERT_EQUAL_FLOAT(1900.5f, channels[1].wheelSize_mm);
+    TEST_ASSERT_EQUAL_STRING("bike:3", channels[1].idTag);
+    TEST_ASSERT_EQUAL_UINT32(0, channels[1].pulsesAtLastSend);
+
+    // Invalid pin, wheel size or tag is skipped, valid entries after it are kept
+    TEST_ASSERT_EQUAL_UINT8(1, bikeChannelParse("40:2075:a;4:200:b;x:2075:c;5:2075:;6:2075:ok", channels));
+    TEST_ASSERT_EQUAL_INT(6, channels[0].pin);
+    TEST_ASSERT_EQUAL_STRING("ok", channels[0].idTag);
+
+    // At most one bike per free PCNT unit
+    TEST_ASSERT_EQUAL_UINT8(BIKE_CHANNEL_MAX - 1,
+                            bikeChannelParse("1:2000:a;2:2000:b;3:2000:c;4:2000:d;5:2000:e", channels));
+    TEST_ASSERT_EQUAL_STRING("c", channels[BIKE_CHANNEL_MAX - 2].idTag);
+
+    // Interval bookkeeping: pulses counted during an upload stay pending
+    BikeChannel* bike = &channels[0];
+    TEST_ASSERT_EQUAL_UINT32(120, bikeChannelTakeInterval(bike, 120));
+    bikeChannelConfirm(bike);
+    TEST_ASSERT_EQUAL_UINT32(30, bikeChannelTakeInterval(bike, 150));
+    // Upload failed and not confirmed: the next interval includes those pulses
+    TEST_ASSERT_EQUAL_UINT32(45, bikeChannelTakeInterval(bike, 165));
+    bikeChannelConfirm(bike);
+    TEST_ASSERT_EQUAL_UINT32(0, bikeChannelTakeInterval(bike, 165));
+
+    // 32-bit counter wrap
+    bike->pulsesAtLastSend = 0xFFFFFFF0u;
+    TEST_ASSERT_EQUAL_UINT32(0x20, bikeChannelTakeInterval(bike, 0x10));
+}
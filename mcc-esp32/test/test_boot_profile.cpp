@@ -0,0 +1,47 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_boot_profile.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/boot_profile.h"
+
+void test_boot_profile() {
+    static BootProfile profile = {};
+
+    // Nothing marked yet
+    TEST_ASSERT_EQUAL_INT(-1, bootProfileSlowest(&profile));
+    TEST_ASSERT_EQUAL_UINT32(0, bootProfileStageUs(&profile, 0));
+
+    TEST_ASSERT_TRUE(bootProfileMark(&profile, "setup", 310000));
+    TEST_ASSERT_TRUE(bootProfileMark(&profile, "pcnt", 310400));
+    TEST_ASSERT_TRUE(bootProfileMark(&profile, "nvs", 355000));
+    TEST_ASSERT_TRUE(bootProfileMark(&profile, "oled", 390000));
+    TEST_ASSERT_EQUAL_UINT8(4, profile.count);
+    TEST_ASSERT_EQUAL_STRING("nvs", profile.names[2]);
+
+    // The first stage starts with the application, the others with the previous mark
+    TEST_ASSERT_EQUAL_UINT32(310000, bootProfileStageUs(&profile, 0));
+    TEST_ASSERT_EQUAL_UINT32(400, bootProfileStageUs(&profile, 1));
+    TEST_ASSERT_EQUAL_UINT32(44600, bootProfileStageUs(&profile, 2));
+    TEST_ASSERT_EQUAL_UINT32(0, bootProfileStageUs(&profile, 7));
+    TEST_ASSERT_EQUAL_INT(0, bootProfileSlowest(&profile));
+
+    // Reported: the timeline stays as sent
+    profile.reported = true;
+    TEST_ASSERT_FALSE(bootProfileMark(&profile, "wifi", 2400000));
+    TEST_ASSERT_EQUAL_UINT8(4, profile.count);
+
+    // Full: further marks are dropped
+    static BootProfile full = {};
+    for (uint8_t i = 0; i < BOOT_PROFILE_MAX_STAGES; i++) {
+        TEST_ASSERT_TRUE(bootProfileMark(&full, "stage", 1000u * (i + 1)));
+    }
+    TEST_ASSERT_FALSE(bootProfileMark(&full, "late", 999999));
+    TEST_ASSERT_EQUAL_UINT8(BOOT_PROFILE_MAX_STAGES, full.count);
+    TEST_ASSERT_EQUAL_UINT32(1000, bootProfileStageUs(&full, BOOT_PROFILE_MAX_STAGES - 1));
+}
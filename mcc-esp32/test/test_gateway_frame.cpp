@@ -0,0 +1,144 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_gateway_frame.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/gateway_frame.h"
+
+static GatewayReassembly reassembly;
+
+void test_gateway_frame() {
+    uint8_t message[GATEWAY_MESSAGE_MAX_LEN + 1];
+    for (size_t i = 0; i < sizeof(message); i++) {
+        message[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    // Fragment counts; an empty message still takes one frame
+    TEST_ASSERT_EQUAL_UINT8(1, gatewayFragmentCount(0));
+    TEST_ASSERT_EQUAL_UINT8(1, gatewayFragmentCount(GATEWAY_FRAGMENT_LEN));
+    TEST_ASSERT_EQUAL_UINT8(2, gatewayFragmentCount(GATEWAY_FRAGMENT_LEN + 1));
+    TEST_ASSERT_EQUAL_UINT8(GATEWAY_MAX_FRAGMENTS, gatewayFragmentCount(GATEWAY_MESSAGE_MAX_LEN));
+
+    // Single frame round trip
+    uint8_t frame[GATEWAY_FRAME_MAX_LEN];
+    size_t len = gatewayFrameEncode(frame, GATEWAY_FRAME_ACK, 0x1234, message, 2, 0);
+    TEST_ASSERT_EQUAL(GATEWAY_FRAME_HEADER_LEN + 2, len);
+    GatewayFrameHeader hdr;
+    const uint8_t* payload = nullptr;
+    size_t payloadLen = 0;
+    TEST_ASSERT_TRUE(gatewayFrameDecode(frame, len, &hdr, &payload, &payloadLen));
+    TEST_ASSERT_EQUAL_UINT8(GATEWAY_FRAME_ACK, hdr.type);
+    TEST_ASSERT_EQUAL_UINT16(0x1234, hdr.seq);
+    TEST_ASSERT_EQUAL_UINT8(1, hdr.fragCount);
+    TEST_ASSERT_EQUAL(2, payloadLen);
+    TEST_ASSERT_EQUAL_MEMORY(message, payload, 2);
+
+    // Too long messages and fragment indexes out of range are not encoded
+    TEST_ASSERT_EQUAL(0, gatewayFrameEncode(frame, GATEWAY_FRAME_REQUEST, 1, message, GATEWAY_MESSAGE_MAX_LEN + 1, 0));
+    TEST_ASSERT_EQUAL(0, gatewayFrameEncode(frame, GATEWAY_FRAME_REQUEST, 1, message, 10, 1));
+
+    // Foreign, truncated or inconsistent frames are rejected
+    len = gatewayFrameEncode(frame, GATEWAY_FRAME_REQUEST, 7, message, 100, 0);
+    TEST_ASSERT_FALSE(gatewayFrameDecode(frame, len - 1, &hdr, &payload, &payloadLen));
+    TEST_ASSERT_FALSE(gatewayFrameDecode(frame, GATEWAY_FRAME_HEADER_LEN - 1, &hdr, &payload, &payloadLen));
+    frame[2] = GATEWAY_FRAME_VERSION + 1;
+    TEST_ASSERT_FALSE(gatewayFrameDecode(frame, len, &hdr, &payload, &payloadLen));
+    frame[2] = GATEWAY_FRAME_VERSION;
+    frame[7] = 2;   // Fragment count does not match the total length
+    TEST_ASSERT_FALSE(gatewayFrameDecode(frame, len, &hdr, &payload, &payloadLen));
+    frame[7] = 1;
+    frame[0] ^= 0xFF;
+    TEST_ASSERT_FALSE(gatewayFrameDecode(frame, len, &hdr, &payload, &payloadLen));
+
+    // Fragmented message reassembled out of order, with a duplicate fragment
+    const size_t total = GATEWAY_FRAGMENT_LEN * 2 + 17;
+    const uint8_t order[] = {2, 0, 0, 1};
+    gatewayReassemblyReset(&reassembly);
+    for (size_t i = 0; i < sizeof(order); i++) {
+        len = gatewayFrameEncode(frame, GATEWAY_FRAME_RESPONSE, 42, message, total, order[i]);
+        TEST_ASSERT_TRUE(len > 0);
+        TEST_ASSERT_TRUE(gatewayFrameDecode(frame, len, &hdr, &payload, &payloadLen));
+        bool complete = gatewayReassemblyAdd(&reassembly, &hdr, payload, payloadLen);
+        TEST_ASSERT_EQUAL(i == sizeof(order) - 1, complete);
+    }
+    TEST_ASSERT_EQUAL_UINT16(total, reassembly.totalLen);
+    TEST_ASSERT_EQUAL_MEMORY(message, reassembly.data, total);
+
+    // A fragment of another message restarts the reassembly
+    len = gatewayFrameEncode(frame, GATEWAY_FRAME_RESPONSE, 43, message, total, 0);
+    TEST_ASSERT_TRUE(gatewayFrameDecode(frame, len, &hdr, &payload, &payloadLen));
+    TEST_ASSERT_FALSE(gatewayReassemblyAdd(&reassembly, &hdr, payload, payloadLen));
+    TEST_ASSERT_EQUAL_UINT16(43, reassembly.seq);
+    TEST_ASSERT_EQUAL_UINT8(0x01, reassembly.receivedMask);
+
+    // Request with API key round trip
+    const uint8_t body[] = {0x82, 0xA1, 0x61, 0x01, 0xA1, 0x62, 0x02};
+    GatewayRequest req;
+    req.jobType = 3;
+    req.flags = GATEWAY_REQUEST_HAS_KEY;
+    req.context = 0xA1B2C3D4u;
+    req.path = "/api/update-data";
+    req.pathLen = (uint8_t)strlen(req.path);
+    req.apiKey = "secret-key";
+    req.apiKeyLen = (uint8_t)strlen(req.apiKey);
+    req.body = body;
+    req.bodyLen = sizeof(body);
+    uint8_t encoded[128];
+    len = gatewayRequestEncode(encoded, sizeof(encoded), &req);
+    TEST_ASSERT_EQUAL(7 + req.pathLen + 1 + req.apiKeyLen + sizeof(body), len);
+    TEST_ASSERT_EQUAL(0, gatewayRequestEncode(encoded, len - 1, &req));
+
+    GatewayRequest decoded;
+    TEST_ASSERT_TRUE(gatewayRequestDecode(encoded, len, &decoded));
+    TEST_ASSERT_EQUAL_UINT8(3, decoded.jobType);
+    TEST_ASSERT_EQUAL_UINT32(0xA1B2C3D4u, decoded.context);
+    TEST_ASSERT_EQUAL_UINT8(req.pathLen, decoded.pathLen);
+    TEST_ASSERT_EQUAL_MEMORY(req.path, decoded.path, req.pathLen);
+    TEST_ASSERT_EQUAL_UINT8(req.apiKeyLen, decoded.apiKeyLen);
+    TEST_ASSERT_EQUAL_MEMORY(req.apiKey, decoded.apiKey, req.apiKeyLen);
+    TEST_ASSERT_EQUAL(sizeof(body), decoded.bodyLen);
+    TEST_ASSERT_EQUAL_MEMORY(body, decoded.body, sizeof(body));
+
+    // Without key the body follows the path directly; GET requests have no body
+    req.flags = 0;
+    req.bodyLen = 0;
+    len = gatewayRequestEncode(encoded, sizeof(encoded), &req);
+    TEST_ASSERT_TRUE(gatewayRequestDecode(encoded, len, &decoded));
+    TEST_ASSERT_NULL(decoded.apiKey);
+    TEST_ASSERT_EQUAL(0, decoded.bodyLen);
+
+    // Truncated requests are rejected
+    TEST_ASSERT_FALSE(gatewayRequestDecode(encoded, 6, &decoded));
+    TEST_ASSERT_FALSE(gatewayRequestDecode(encoded, 7 + req.pathLen - 1, &decoded));
+    req.flags = GATEWAY_REQUEST_HAS_KEY;
+    len = gatewayRequestEncode(encoded, sizeof(encoded), &req);
+    TEST_ASSERT_FALSE(gatewayRequestDecode(encoded, len - 1, &decoded));
+
+    // URL path for forwarding
+    TEST_ASSERT_EQUAL_STRING("/api/get-user-id?id_tag=a", gatewayUrlPath("http://host:8000/api/get-user-id?id_tag=a"));
+    TEST_ASSERT_EQUAL_STRING("/api/x", gatewayUrlPath("https://example.org/api/x"));
+    const char* noPath = "http://host:8000";
+    TEST_ASSERT_TRUE(gatewayUrlPath(noPath) == noPath + strlen(noPath));
+
+    // Wake cycles: the node keeps its gateway (no HELLO) and its seq in RTC memory
+    GatewaySeqFilter requests = {};
+    uint16_t nodeSeq = 0xFFFE;
+    TEST_ASSERT_FALSE(gatewaySeqIsLast(&requests, ++nodeSeq));
+    gatewaySeqAccept(&requests, nodeSeq);
+    TEST_ASSERT_TRUE(gatewaySeqIsLast(&requests, nodeSeq));   // Lost ACK, sent again
+    for (int wake = 0; wake < 3; wake++) {
+        // Also across the wraparound
+        TEST_ASSERT_FALSE(gatewaySeqIsLast(&requests, ++nodeSeq));
+        gatewaySeqAccept(&requests, nodeSeq);
+    }
+
+    // Power-on: the node searches with a HELLO, then a seq the gateway saw before is a new request
+    const uint16_t reused = nodeSeq;
+    gatewaySeqReset(&requests);
+    TEST_ASSERT_FALSE(gatewaySeqIsLast(&requests, reused));
+}
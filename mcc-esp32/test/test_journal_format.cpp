@@ -0,0 +1,80 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_journal_format.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/journal_format.h"
+
+void test_journal_format() {
+    // Standard CRC-32 check value
+    const char* check = "123456789";
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926u, journalCrc32((const uint8_t*)check, 9));
+    // Running checksum over two parts equals checksum over the whole
+    uint32_t part = journalCrc32((const uint8_t*)check, 4);
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926u, journalCrc32((const uint8_t*)check + 4, 5, part));
+
+    JournalRecord rec;
+    journalRecordInit(&rec, 7, 123456, "04A1B2C3", 42, 42 * 2075.0f);
+    TEST_ASSERT_TRUE(journalRecordValid(&rec));
+    TEST_ASSERT_EQUAL_UINT32(JOURNAL_STATE_PENDING, rec.state);
+    TEST_ASSERT_EQUAL_STRING("04A1B2C3", rec.idTag);
+
+    // Marking as sent must not invalidate the record
+    rec.state = JOURNAL_STATE_SENT;
+    TEST_ASSERT_TRUE(journalRecordValid(&rec));
+
+    // Corrupted payload and erased slot are rejected
+    JournalRecord corrupt = rec;
+    corrupt.pulses++;
+    TEST_ASSERT_FALSE(journalRecordValid(&corrupt));
+    JournalRecord erased;
+    memset(&erased, 0xFF, sizeof(erased));
+    TEST_ASSERT_FALSE(journalRecordValid(&erased));
+    memset(&erased, 0, sizeof(erased));
+    TEST_ASSERT_FALSE(journalRecordValid(&erased));
+
+    // Overlong ID tag is truncated and stays terminated
+    journalRecordInit(&rec, 0, 0, "0123456789012345678901234567890123456789ABCDEF", 1, 1.0f);
+    TEST_ASSERT_TRUE(journalRecordValid(&rec));
+    TEST_ASSERT_EQUAL_UINT32(JOURNAL_ID_TAG_LEN - 1, (uint32_t)strlen(rec.idTag));
+
+    // Empty journal
+    JournalScan scan;
+    journalScanReset(&scan);
+    journalScanAdd(&scan, &erased);
+    TEST_ASSERT_FALSE(scan.any);
+    TEST_ASSERT_EQUAL_UINT32(0, scan.nextSeq);
+    TEST_ASSERT_EQUAL_UINT32(0, scan.pendingCount);
+
+    // Ring with wrapped slots: physical order differs from sequence order
+    JournalRecord slots[4];
+    journalRecordInit(&slots[0], 12, 0, "A", 1, 1.0f);   // pending
+    journalRecordInit(&slots[1], 9, 0, "A", 1, 1.0f);    // sent
+    slots[1].state = JOURNAL_STATE_SENT;
+    journalRecordInit(&slots[2], 10, 0, "B", 1, 1.0f);   // pending
+    journalRecordInit(&slots[3], 11, 0, "B", 1, 1.0f);   // torn write
+    slots[3].crc ^= 1;
+    journalScanReset(&scan);
+    for (int i = 0; i < 4; i++) {
+        journalScanAdd(&scan, &slots[i]);
+    }
+    TEST_ASSERT_TRUE(scan.any);
+    TEST_ASSERT_EQUAL_UINT32(13, scan.nextSeq);
+    TEST_ASSERT_EQUAL_UINT32(10, scan.oldestPendingSeq);
+    TEST_ASSERT_EQUAL_UINT32(2, scan.pendingCount);
+
+    // Everything sent: next append continues after the highest sequence number
+    slots[0].state = JOURNAL_STATE_SENT;
+    slots[2].state = JOURNAL_STATE_SENT;
+    journalScanReset(&scan);
+    for (int i = 0; i < 4; i++) {
+        journalScanAdd(&scan, &slots[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(13, scan.nextSeq);
+    TEST_ASSERT_EQUAL_UINT32(0, scan.pendingCount);
+}
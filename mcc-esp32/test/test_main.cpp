@@ -22,6 +22,20 @@ extern void test_json_generation();
 extern void test_rfid_utils();
 extern void test_config_utils();
 extern void test_velos();
+extern void test_pulse_ring();
+extern void test_pulse_accumulator();
+extern void test_journal_format();
+extern void test_tag_cache();
+extern void test_metrics_registry();
+extern void test_speed_average();
+extern void test_ride_stats();
+extern void test_wifi_backoff();
+extern void test_gateway_frame();
+extern void test_bike_channel();
+extern void test_seqlock();
+extern void test_boot_profile();
+extern void test_upload_scheduler();
+extern void test_ride_trace();
 
 void setUp(void) {
     // Set up test environment before each test
@@ -48,6 +62,20 @@ int main(int argc, char **argv) {
     RUN_TEST(test_rfid_utils);
     RUN_TEST(test_config_utils);
     RUN_TEST(test_velos);
+    RUN_TEST(test_pulse_ring);
+    RUN_TEST(test_pulse_accumulator);
+    RUN_TEST(test_journal_format);
+    RUN_TEST(test_tag_cache);
+    RUN_TEST(test_metrics_registry);
+    RUN_TEST(test_speed_average);
+    RUN_TEST(test_ride_stats);
+    RUN_TEST(test_wifi_backoff);
+    RUN_TEST(test_gateway_frame);
+    RUN_TEST(test_bike_channel);
+    RUN_TEST(test_seqlock);
+    RUN_TEST(test_boot_profile);
+    RUN_TEST(test_upload_scheduler);
+    RUN_TEST(test_ride_trace);
     
     UNITY_END();
     
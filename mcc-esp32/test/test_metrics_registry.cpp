@@ -0,0 +1,59 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_metrics_registry.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/metrics_registry.h"
+
+static const uint32_t BOUNDS[METRICS_HISTOGRAM_BOUNDS] = {10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+
+void test_metrics_registry() {
+    MetricHistogram h;
+    metricHistogramInit(&h, BOUNDS);
+    TEST_ASSERT_EQUAL_UINT32(0, metricHistogramPercentile(&h, 95));
+    TEST_ASSERT_EQUAL_UINT32(0, metricHistogramMean(&h));
+
+    // Bounds are inclusive upper limits
+    metricHistogramRecord(&h, 0);
+    metricHistogramRecord(&h, 10);
+    metricHistogramRecord(&h, 11);
+    TEST_ASSERT_EQUAL_UINT32(2, h.counts[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, h.counts[1]);
+    TEST_ASSERT_EQUAL_UINT32(3, h.count);
+    TEST_ASSERT_EQUAL_UINT32(21, (uint32_t)h.sum);
+    TEST_ASSERT_EQUAL_UINT32(11, h.max);
+    TEST_ASSERT_EQUAL_UINT32(7, metricHistogramMean(&h));
+
+    // p50 of three samples is the second one; never above the largest sample
+    TEST_ASSERT_EQUAL_UINT32(10, metricHistogramPercentile(&h, 50));
+    TEST_ASSERT_EQUAL_UINT32(11, metricHistogramPercentile(&h, 95));
+
+    // Values above the last bound land in the overflow bucket
+    metricHistogramRecord(&h, 60000);
+    TEST_ASSERT_EQUAL_UINT32(1, h.counts[METRICS_HISTOGRAM_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL_UINT32(60000, metricHistogramPercentile(&h, 100));
+
+    // 95 fast and 5 slow samples: p95 stays in the fast bucket, p99 does not
+    metricHistogramInit(&h, BOUNDS);
+    for (int i = 0; i < 95; i++) {
+        metricHistogramRecord(&h, 15);
+    }
+    for (int i = 0; i < 5; i++) {
+        metricHistogramRecord(&h, 900);
+    }
+    TEST_ASSERT_EQUAL_UINT32(20, metricHistogramPercentile(&h, 95));
+    TEST_ASSERT_EQUAL_UINT32(900, metricHistogramPercentile(&h, 99));
+
+    // Result classes
+    TEST_ASSERT_EQUAL_UINT8(METRIC_STATUS_2XX, metricStatusClass(200));
+    TEST_ASSERT_EQUAL_UINT8(METRIC_STATUS_3XX, metricStatusClass(304));
+    TEST_ASSERT_EQUAL_UINT8(METRIC_STATUS_4XX, metricStatusClass(404));
+    TEST_ASSERT_EQUAL_UINT8(METRIC_STATUS_5XX, metricStatusClass(503));
+    TEST_ASSERT_EQUAL_UINT8(METRIC_STATUS_CONN_ERROR, metricStatusClass(-1));
+    TEST_ASSERT_EQUAL_UINT8(METRIC_STATUS_CONN_ERROR, metricStatusClass(0));
+}
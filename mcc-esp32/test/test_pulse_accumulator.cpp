@@ -0,0 +1,53 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_pulse_accumulator.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/pulse_accumulator.h"
+
+static const uint32_t HIGH_LIMIT = 30000;
+
+void test_pulse_accumulator() {
+    PulseAccumulator acc;
+    pulseAccumulatorReset(&acc);
+
+    // No overflow yet: total equals hardware counter
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)pulseAccumulatorTotal(&acc, 0));
+    TEST_ASSERT_EQUAL_UINT32(1234, (uint32_t)pulseAccumulatorTotal(&acc, 1234));
+
+    // Hardware counter wrapped, event folded
+    pulseAccumulatorFold(&acc, HIGH_LIMIT);
+    TEST_ASSERT_EQUAL_UINT32(HIGH_LIMIT + 5, (uint32_t)pulseAccumulatorTotal(&acc, 5));
+
+    // Counter wrapped again, but event not folded yet: total must not go backwards
+    const uint64_t beforeWrap = pulseAccumulatorTotal(&acc, 29999);
+    TEST_ASSERT_TRUE(pulseAccumulatorTotal(&acc, 3) >= beforeWrap);
+    pulseAccumulatorFold(&acc, HIGH_LIMIT);
+    TEST_ASSERT_EQUAL_UINT32(2 * HIGH_LIMIT + 3, (uint32_t)pulseAccumulatorTotal(&acc, 3));
+
+    // Totals beyond 16 bits (previous int16_t counters would have wrapped here)
+    pulseAccumulatorReset(&acc);
+    for (int i = 0; i < 10; i++) {
+        pulseAccumulatorFold(&acc, HIGH_LIMIT);
+    }
+    TEST_ASSERT_EQUAL_UINT32(300000, (uint32_t)pulseAccumulatorTotal(&acc, 0));
+
+    // Beyond 32 bits the 64-bit total keeps counting
+    acc.folded = 0xFFFFFFFFull;
+    acc.lastTotal = 0;
+    TEST_ASSERT_TRUE(pulseAccumulatorTotal(&acc, 10) > 0xFFFFFFFFull);
+
+    // Interval from 32-bit session counters across wrap stays positive
+    const uint32_t pulsesAtLastSend = 0xFFFFFFF0u;
+    const uint32_t currentPulseCount = 0x00000010u;
+    TEST_ASSERT_EQUAL_UINT32(0x20u, currentPulseCount - pulsesAtLastSend);
+
+    // Negative hardware values are ignored
+    pulseAccumulatorReset(&acc);
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)pulseAccumulatorTotal(&acc, -1));
+}
@@ -0,0 +1,57 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_pulse_ring.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/pulse_ring.h"
+
+static PulseRing ring;
+
+void test_pulse_ring() {
+    uint32_t value = 0;
+
+    // Empty ring
+    pulseRingReset(&ring);
+    TEST_ASSERT_EQUAL_UINT32(0, pulseRingSize(&ring));
+    TEST_ASSERT_FALSE(pulseRingPop(&ring, &value));
+
+    // FIFO order
+    TEST_ASSERT_TRUE(pulseRingPush(&ring, 100));
+    TEST_ASSERT_TRUE(pulseRingPush(&ring, 200));
+    TEST_ASSERT_EQUAL_UINT32(2, pulseRingSize(&ring));
+    TEST_ASSERT_TRUE(pulseRingPop(&ring, &value));
+    TEST_ASSERT_EQUAL_UINT32(100, value);
+    TEST_ASSERT_TRUE(pulseRingPop(&ring, &value));
+    TEST_ASSERT_EQUAL_UINT32(200, value);
+    TEST_ASSERT_FALSE(pulseRingPop(&ring, &value));
+
+    // Full ring drops new timestamps and counts them
+    pulseRingReset(&ring);
+    for (uint32_t i = 0; i < PULSE_RING_CAPACITY; i++) {
+        TEST_ASSERT_TRUE(pulseRingPush(&ring, i));
+    }
+    TEST_ASSERT_FALSE(pulseRingPush(&ring, 9999));
+    TEST_ASSERT_EQUAL_UINT32(1, ring.dropped.load());
+    TEST_ASSERT_EQUAL_UINT32(PULSE_RING_CAPACITY, pulseRingSize(&ring));
+    TEST_ASSERT_TRUE(pulseRingPop(&ring, &value));
+    TEST_ASSERT_EQUAL_UINT32(0, value);
+
+    // Index wrap-around keeps order
+    pulseRingReset(&ring);
+    for (uint32_t i = 0; i < 3 * PULSE_RING_CAPACITY; i++) {
+        TEST_ASSERT_TRUE(pulseRingPush(&ring, i));
+        TEST_ASSERT_TRUE(pulseRingPop(&ring, &value));
+        TEST_ASSERT_EQUAL_UINT32(i, value);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, pulseRingSize(&ring));
+
+    // Interval across 32-bit timestamp overflow
+    const uint32_t before = 0xFFFFFF00u;
+    const uint32_t after = 0x00000100u;
+    TEST_ASSERT_EQUAL_UINT32(0x200u, after - before);
+}
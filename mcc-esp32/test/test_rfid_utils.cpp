@@ -18,7 +18,7 @@
 
 /**
  * Test helper: Convert RFID UID byte array to hexadecimal string
- * This mirrors RFID_MFRC522_uidToHexString() from rfid_mfrc522_control.cpp
+ * This mirrors RFID_MFRC522_uidToHex() from rfid_mfrc522_control.cpp
  */
 std::string uidToHexString(uint8_t* buffer, uint8_t bufferSize) {
     std::string str = "";
@@ -0,0 +1,62 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_ride_stats.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/ride_stats.h"
+
+static const uint32_t WHEEL_MM = 2075;
+static const uint32_t IDLE_US = 5000000;
+
+void test_ride_stats() {
+    RideStats stats;
+    rideStatsReset(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, rideStatsAvgCkmh(&stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.minCkmh);
+
+    // 2075 mm in 250 ms = 29.88 km/h
+    TEST_ASSERT_EQUAL_UINT32(2988, rideStatsSpeedCkmh(250000, WHEEL_MM));
+    TEST_ASSERT_EQUAL_UINT32(0, rideStatsSpeedCkmh(0, WHEEL_MM));
+
+    // 29.88 km/h, 14.94 km/h, 59.76 km/h
+    rideStatsAddInterval(&stats, 250000, WHEEL_MM, IDLE_US);
+    rideStatsAddInterval(&stats, 500000, WHEEL_MM, IDLE_US);
+    rideStatsAddInterval(&stats, 125000, WHEEL_MM, IDLE_US);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.intervals);
+    TEST_ASSERT_EQUAL_UINT32(3 * WHEEL_MM, stats.distanceMm);
+    TEST_ASSERT_EQUAL_UINT32(875000, (uint32_t)stats.activeUs);
+    TEST_ASSERT_EQUAL_UINT32(1494, stats.minCkmh);
+    TEST_ASSERT_EQUAL_UINT32(5976, stats.maxCkmh);
+
+    // Average is distance over riding time: 6225 mm in 875 ms = 25.61 km/h
+    TEST_ASSERT_EQUAL_UINT32(2561, rideStatsAvgCkmh(&stats));
+
+    // Bands: 25-30, 10-15 and the open band from 40 km/h
+    TEST_ASSERT_EQUAL_UINT32(250, stats.bandMs[5]);
+    TEST_ASSERT_EQUAL_UINT32(500, stats.bandMs[2]);
+    TEST_ASSERT_EQUAL_UINT32(125, stats.bandMs[RIDE_STATS_BANDS - 1]);
+
+    // A pause is idle time and leaves speed and distance alone
+    rideStatsAddInterval(&stats, IDLE_US, WHEEL_MM, IDLE_US);
+    rideStatsAddInterval(&stats, 12000000, WHEEL_MM, IDLE_US);
+    TEST_ASSERT_EQUAL_UINT32(17000000, (uint32_t)stats.idleUs);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.intervals);
+    TEST_ASSERT_EQUAL_UINT32(1494, stats.minCkmh);
+    TEST_ASSERT_EQUAL_UINT32(2561, rideStatsAvgCkmh(&stats));
+
+    uint32_t bandTotal = 0;
+    for (int i = 0; i < RIDE_STATS_BANDS; i++) {
+        bandTotal += stats.bandMs[i];
+    }
+    TEST_ASSERT_EQUAL_UINT32(875, bandTotal);
+
+    rideStatsReset(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.intervals);
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)stats.idleUs);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.bandMs[5]);
+}
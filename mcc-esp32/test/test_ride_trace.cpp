@@ -0,0 +1,99 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_ride_trace.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/ride_trace.h"
+
+void test_ride_trace() {
+    static RideTrace trace;
+    uint32_t ticks[64];
+
+    // Off: nothing is recorded
+    rideTraceBegin(&trace, nullptr, 0);
+    TEST_ASSERT_FALSE(rideTraceAdd(&trace, 1000));
+    TEST_ASSERT_FALSE(trace.anchored);
+
+    // The first pulse is the anchor, steady cadence takes one byte per revolution
+    rideTraceBegin(&trace, nullptr, 64);
+    TEST_ASSERT_FALSE(rideTraceAdd(&trace, 4294000000u));
+    TEST_ASSERT_TRUE(rideTraceAdd(&trace, 4294000000u + 250000));  // First interval: 2500 ticks, two bytes
+    TEST_ASSERT_EQUAL_UINT16(2, trace.len);
+    TEST_ASSERT_TRUE(rideTraceAdd(&trace, 4294000000u + 500000));  // Timestamp wraps; same interval
+    TEST_ASSERT_TRUE(rideTraceAdd(&trace, 4294000000u + 750040));  // 40 us longer
+    TEST_ASSERT_EQUAL_UINT16(4, trace.len);
+    TEST_ASSERT_EQUAL_UINT16(3, trace.count);
+    TEST_ASSERT_EQUAL_UINT16(3, rideTraceDecode(trace.data, trace.len, ticks, 64));
+    TEST_ASSERT_EQUAL_UINT32(2500, ticks[0]);
+    TEST_ASSERT_EQUAL_UINT32(2500, ticks[1]);
+    TEST_ASSERT_EQUAL_UINT32(2500, ticks[2]);  // 40 us are carried, not lost
+
+    // Sub-tick remainders add up: no drift against the real time
+    rideTraceBegin(&trace, nullptr, 64);
+    uint32_t us = 0;
+    rideTraceAdd(&trace, us);
+    for (int i = 0; i < 20; i++) {
+        us += 250050;
+        TEST_ASSERT_TRUE(rideTraceAdd(&trace, us));
+    }
+    const uint16_t n = rideTraceDecode(trace.data, trace.len, ticks, 64);
+    TEST_ASSERT_EQUAL_UINT16(20, n);
+    uint32_t sum = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        sum += ticks[i];
+    }
+    TEST_ASSERT_EQUAL_UINT32(us / RIDE_TRACE_TICK_US, sum);
+
+    // A pause and a sprint round-trip through the zigzag deltas
+    rideTraceBegin(&trace, nullptr, 64);
+    rideTraceAdd(&trace, 0);
+    rideTraceAdd(&trace, 300000);
+    rideTraceAdd(&trace, 8300000);
+    rideTraceAdd(&trace, 8450000);
+    TEST_ASSERT_EQUAL_UINT16(3, rideTraceDecode(trace.data, trace.len, ticks, 64));
+    TEST_ASSERT_EQUAL_UINT32(3000, ticks[0]);
+    TEST_ASSERT_EQUAL_UINT32(80000, ticks[1]);
+    TEST_ASSERT_EQUAL_UINT32(1500, ticks[2]);
+
+    // Limit reached: the trace ends, further pulses are counted as dropped
+    rideTraceBegin(&trace, nullptr, 4);
+    rideTraceAdd(&trace, 0);
+    TEST_ASSERT_TRUE(rideTraceAdd(&trace, 250000));
+    TEST_ASSERT_TRUE(rideTraceAdd(&trace, 500000));
+    TEST_ASSERT_TRUE(rideTraceAdd(&trace, 750000));
+    TEST_ASSERT_FALSE(rideTraceAdd(&trace, 1300000));  // Two bytes, only one left
+    TEST_ASSERT_FALSE(rideTraceAdd(&trace, 1550000));
+    TEST_ASSERT_EQUAL_UINT16(4, trace.len);
+    TEST_ASSERT_EQUAL_UINT16(2, trace.dropped);
+
+    // The next trace continues from the last recorded pulse unless it was interrupted
+    static RideTrace next;
+    rideTraceBegin(&trace, nullptr, 64);
+    rideTraceAdd(&trace, 0);
+    rideTraceAdd(&trace, 250000);
+    rideTraceBegin(&next, &trace, 1000);
+    TEST_ASSERT_EQUAL_UINT16(RIDE_TRACE_MAX_BYTES, next.limit);
+    TEST_ASSERT_EQUAL_UINT32(250000, next.startUs);
+    TEST_ASSERT_TRUE(rideTraceAdd(&next, 500000));
+    rideTraceInterrupt(&next);
+    TEST_ASSERT_FALSE(rideTraceAdd(&next, 750000));
+    TEST_ASSERT_EQUAL_UINT16(1, next.dropped);
+    rideTraceBegin(&trace, &next, 64);
+    TEST_ASSERT_FALSE(trace.anchored);
+
+    // Base64 with padding
+    const uint8_t bytes[] = {'M', 'a', 'n'};
+    char b64[16];
+    TEST_ASSERT_EQUAL(4, rideTraceBase64(bytes, 3, b64, sizeof(b64)));
+    TEST_ASSERT_EQUAL_STRING("TWFu", b64);
+    TEST_ASSERT_EQUAL(4, rideTraceBase64(bytes, 2, b64, sizeof(b64)));
+    TEST_ASSERT_EQUAL_STRING("TWE=", b64);
+    TEST_ASSERT_EQUAL(4, rideTraceBase64(bytes, 1, b64, sizeof(b64)));
+    TEST_ASSERT_EQUAL_STRING("TQ==", b64);
+    TEST_ASSERT_EQUAL(0, rideTraceBase64(bytes, 3, b64, 4));
+}
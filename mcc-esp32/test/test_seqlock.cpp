@@ -0,0 +1,57 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_seqlock.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+#include <string.h>
+
+#include "../src/seqlock.h"
+
+struct TestState {
+    char name[16];
+    float speed;
+    uint32_t pulses;
+};
+
+void test_seqlock() {
+    static SeqLock<TestState> lock = {};
+    TestState out;
+
+    // Nothing published yet: a zeroed value with version 0
+    TEST_ASSERT_EQUAL_UINT32(0, seqLockVersion(&lock));
+    TEST_ASSERT_TRUE(seqLockTryRead(&lock, &out));
+    TEST_ASSERT_EQUAL_UINT32(0, out.pulses);
+
+    TestState state = {};
+    strcpy(state.name, "Kette");
+    state.speed = 21.5f;
+    state.pulses = 120;
+    seqLockWrite(&lock, state);
+    TEST_ASSERT_EQUAL_UINT32(1, seqLockVersion(&lock));
+    TEST_ASSERT_TRUE(seqLockTryRead(&lock, &out));
+    TEST_ASSERT_EQUAL_STRING("Kette", out.name);
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, out.speed);
+    TEST_ASSERT_EQUAL_UINT32(120, out.pulses);
+
+    state.pulses = 121;
+    seqLockWrite(&lock, state);
+    TEST_ASSERT_EQUAL_UINT32(2, seqLockVersion(&lock));
+    TEST_ASSERT_TRUE(seqLockTryRead(&lock, &out));
+    TEST_ASSERT_EQUAL_UINT32(121, out.pulses);
+
+    // Write in progress (odd sequence): the reader has to retry
+    const uint32_t seq = lock.seq.load();
+    lock.seq.store(seq + 1);
+    TEST_ASSERT_FALSE(seqLockTryRead(&lock, &out));
+
+    // Write completed: readable again, with the new version
+    lock.value.pulses = 122;
+    lock.seq.store(seq + 2);
+    TEST_ASSERT_TRUE(seqLockTryRead(&lock, &out));
+    TEST_ASSERT_EQUAL_UINT32(122, out.pulses);
+    TEST_ASSERT_EQUAL_UINT32(3, seqLockVersion(&lock));
+}
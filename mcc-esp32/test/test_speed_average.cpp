@@ -0,0 +1,36 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_speed_average.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/speed_average.h"
+
+void test_speed_average() {
+    SpeedAverage avg;
+    speedAverageReset(&avg);
+    TEST_ASSERT_TRUE(speedAverageEmpty(&avg));
+
+    // Fewer values than SPEED_AVERAGE_COUNT: average over the values seen so far
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, speedAveragePush(&avg, 20.0f));
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, speedAveragePush(&avg, 30.0f));
+    TEST_ASSERT_FALSE(speedAverageEmpty(&avg));
+
+    // Full window: the oldest value drops out
+    float mean = 0.0f;
+    for (int i = 2; i < SPEED_AVERAGE_COUNT; i++) {
+        mean = speedAveragePush(&avg, 10.0f);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, (50.0f + 10.0f * (SPEED_AVERAGE_COUNT - 2)) / SPEED_AVERAGE_COUNT, mean);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, (70.0f + 10.0f * (SPEED_AVERAGE_COUNT - 2)) / SPEED_AVERAGE_COUNT,
+                             speedAveragePush(&avg, 40.0f));
+
+    // Reset starts a new window
+    speedAverageReset(&avg);
+    TEST_ASSERT_TRUE(speedAverageEmpty(&avg));
+    TEST_ASSERT_EQUAL_FLOAT(12.5f, speedAveragePush(&avg, 12.5f));
+}
@@ -0,0 +1,67 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_tag_cache.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+#include <stdio.h>
+
+#include "../src/tag_cache.h"
+
+void test_tag_cache() {
+    static TagCache cache;
+    char name[TAG_CACHE_NAME_LEN];
+    tagCacheReset(&cache);
+
+    TEST_ASSERT_EQUAL(TAG_CACHE_MISS, tagCacheGet(&cache, "04A1B2C3", 0, name, sizeof(name)));
+
+    // New entry is fresh within its TTL and stale afterwards
+    TEST_ASSERT_TRUE(tagCachePut(&cache, "04A1B2C3", "anna", 60000, 1000));
+    TEST_ASSERT_EQUAL(TAG_CACHE_FRESH, tagCacheGet(&cache, "04a1b2c3", 30000, name, sizeof(name)));
+    TEST_ASSERT_EQUAL_STRING("anna", name);
+    TEST_ASSERT_EQUAL(TAG_CACHE_STALE, tagCacheGet(&cache, "04A1B2C3", 61000, name, sizeof(name)));
+    TEST_ASSERT_EQUAL_STRING("anna", name);
+
+    // TTL survives millis() wrap
+    tagCachePut(&cache, "04A1B2C3", "anna", 60000, 0xFFFFF000u);
+    TEST_ASSERT_EQUAL(TAG_CACHE_FRESH, tagCacheGet(&cache, "04A1B2C3", 0x1000u, name, sizeof(name)));
+
+    // Refresh with the same name needs no NVS write, a renamed user does
+    TEST_ASSERT_FALSE(tagCachePut(&cache, "04A1B2C3", "anna", 60000, 2000));
+    TEST_ASSERT_TRUE(tagCachePut(&cache, "04A1B2C3", "anna2", 60000, 2000));
+
+    // Removal
+    TEST_ASSERT_TRUE(tagCacheRemove(&cache, "04A1B2C3"));
+    TEST_ASSERT_FALSE(tagCacheRemove(&cache, "04A1B2C3"));
+    TEST_ASSERT_EQUAL(TAG_CACHE_MISS, tagCacheGet(&cache, "04A1B2C3", 2000, name, sizeof(name)));
+
+    // Full cache evicts the least recently used tag
+    char tag[16];
+    for (int i = 0; i < TAG_CACHE_SIZE; i++) {
+        snprintf(tag, sizeof(tag), "TAG%02d", i);
+        tagCachePut(&cache, tag, "rider", 60000, 0);
+    }
+    TEST_ASSERT_EQUAL(TAG_CACHE_FRESH, tagCacheGet(&cache, "TAG00", 0, name, sizeof(name)));
+    tagCachePut(&cache, "NEWTAG", "new", 60000, 0);
+    TEST_ASSERT_EQUAL(TAG_CACHE_FRESH, tagCacheGet(&cache, "TAG00", 0, name, sizeof(name)));
+    TEST_ASSERT_EQUAL(TAG_CACHE_MISS, tagCacheGet(&cache, "TAG01", 0, name, sizeof(name)));
+    TEST_ASSERT_EQUAL(TAG_CACHE_FRESH, tagCacheGet(&cache, "NEWTAG", 0, name, sizeof(name)));
+
+    // Restored copy keeps names but every entry needs to be confirmed again
+    TEST_ASSERT_TRUE(tagCacheRestore(&cache));
+    TEST_ASSERT_EQUAL(TAG_CACHE_STALE, tagCacheGet(&cache, "NEWTAG", 0, name, sizeof(name)));
+    TEST_ASSERT_EQUAL_STRING("new", name);
+    tagCachePut(&cache, "NEWTAG", "new", 60000, 0);
+    TEST_ASSERT_EQUAL(TAG_CACHE_FRESH, tagCacheGet(&cache, "NEWTAG", 0, name, sizeof(name)));
+
+    // Blob of another layout version is discarded
+    cache.version = TAG_CACHE_VERSION + 1;
+    TEST_ASSERT_FALSE(tagCacheRestore(&cache));
+    TEST_ASSERT_EQUAL(TAG_CACHE_MISS, tagCacheGet(&cache, "NEWTAG", 0, name, sizeof(name)));
+
+    // Empty tags are never cached
+    TEST_ASSERT_FALSE(tagCachePut(&cache, "", "nobody", 60000, 0));
+}
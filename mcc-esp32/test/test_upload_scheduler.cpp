@@ -0,0 +1,97 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_upload_scheduler.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/upload_scheduler.h"
+
+void test_upload_scheduler() {
+    const uint32_t base = 30000;
+    UploadScheduler s;
+
+    // First interval: between half and one and a half intervals, different per device
+    uploadSchedulerInit(&s, 0x12345678u, 1000, base);
+    TEST_ASSERT_TRUE(s.intervalMs >= base / 2 && s.intervalMs < base + base / 2);
+    UploadScheduler other;
+    uploadSchedulerInit(&other, 0x87654321u, 1000, base);
+    TEST_ASSERT_NOT_EQUAL(s.intervalMs, other.intervalMs);
+    TEST_ASSERT_FALSE(uploadSchedulerDue(&s, 1000 + s.intervalMs - 1));
+    TEST_ASSERT_TRUE(uploadSchedulerDue(&s, 1000 + s.intervalMs));
+    TEST_ASSERT_EQUAL_UINT32(s.intervalMs - 500, uploadSchedulerRemainingMs(&s, 1500));
+
+    // Ridden intervals: jitter stays within +-UPLOAD_JITTER_PERCENT
+    uint32_t now = 100000;
+    for (int i = 0; i < 50; i++) {
+        uploadSchedulerPulses(&s, base);
+        uploadSchedulerStart(&s, now, base);
+        TEST_ASSERT_UINT32_WITHIN(base / 100 * UPLOAD_JITTER_PERCENT, base, s.intervalMs);
+    }
+
+    // Idle: 2x, then capped at 4x; pulses shorten it to the normal interval again
+    uploadSchedulerStart(&s, now, base);
+    TEST_ASSERT_UINT32_WITHIN(2 * base / 10, 2 * base, s.intervalMs);
+    uploadSchedulerStart(&s, now, base);
+    TEST_ASSERT_UINT32_WITHIN(4 * base / 10, 4 * base, s.intervalMs);
+    uploadSchedulerStart(&s, now, base);
+    TEST_ASSERT_UINT32_WITHIN(4 * base / 10, 4 * base, s.intervalMs);
+    uploadSchedulerPulses(&s, base);
+    TEST_ASSERT_UINT32_WITHIN(base / 10, base, s.intervalMs);
+
+    // Session end: requested once after the rider stopped
+    TEST_ASSERT_FALSE(uploadSchedulerSessionEnd(&s, UPLOAD_SESSION_END_MS - 1));
+    TEST_ASSERT_TRUE(uploadSchedulerSessionEnd(&s, UPLOAD_SESSION_END_MS));
+    TEST_ASSERT_FALSE(uploadSchedulerSessionEnd(&s, UPLOAD_SESSION_END_MS + 5000));
+    TEST_ASSERT_TRUE(uploadSchedulerDue(&s, now + 1));
+    TEST_ASSERT_EQUAL_UINT32(0, uploadSchedulerRemainingMs(&s, now + 1));
+    uploadSchedulerStart(&s, now + 1, base);
+    TEST_ASSERT_FALSE(uploadSchedulerDue(&s, now + 2));
+    TEST_ASSERT_FALSE(uploadSchedulerSessionEnd(&s, UPLOAD_SESSION_END_MS));  // No pulses since
+
+    // retry_after pauses uploads, even an early one
+    now = 200000;
+    uploadSchedulerPulses(&s, base);
+    TEST_ASSERT_TRUE(uploadSchedulerSessionEnd(&s, UPLOAD_SESSION_END_MS));
+    uint32_t backoff = uploadSchedulerFailed(&s, now, 60);
+    TEST_ASSERT_TRUE(backoff >= 60000 && backoff <= 75000);
+    TEST_ASSERT_TRUE(uploadSchedulerBackingOff(&s, now + 59999));
+    TEST_ASSERT_FALSE(uploadSchedulerDue(&s, now + 59999));
+    TEST_ASSERT_EQUAL_UINT32(backoff - 1000, uploadSchedulerRemainingMs(&s, now + 1000));
+    TEST_ASSERT_TRUE(uploadSchedulerDue(&s, now + backoff));
+    uploadSchedulerSucceeded(&s);
+    TEST_ASSERT_FALSE(uploadSchedulerBackingOff(&s, now + 1));
+
+    // Without retry_after: exponential backoff, capped
+    uint32_t previous = 0;
+    for (int i = 0; i < 4; i++) {
+        backoff = uploadSchedulerFailed(&s, now, 0);
+        const uint32_t expected = UPLOAD_BACKOFF_BASE_MS << i;
+        TEST_ASSERT_TRUE(backoff >= expected && backoff <= expected + expected / 4);
+        TEST_ASSERT_TRUE(backoff > previous);
+        previous = backoff;
+    }
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_TRUE(uploadSchedulerFailed(&s, now, 0) <= UPLOAD_BACKOFF_MAX_MS);
+    }
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_BACKOFF_MAX_MS, uploadSchedulerFailed(&s, now, 86400));
+    uploadSchedulerSucceeded(&s);
+    TEST_ASSERT_EQUAL_UINT8(0, s.failures);
+
+    // Suggested interval: only longer than the configured one, capped
+    uploadSchedulerSetHint(&s, 120);
+    uploadSchedulerPulses(&s, base);
+    uploadSchedulerStart(&s, now, base);
+    TEST_ASSERT_UINT32_WITHIN(12000, 120000, s.intervalMs);
+    uploadSchedulerSetHint(&s, 10);
+    uploadSchedulerPulses(&s, base);
+    uploadSchedulerStart(&s, now, base);
+    TEST_ASSERT_UINT32_WITHIN(base / 10, base, s.intervalMs);
+    uploadSchedulerSetHint(&s, 100000);
+    TEST_ASSERT_EQUAL_UINT32(UPLOAD_HINT_MAX_SEC * 1000u, s.hintMs);
+    uploadSchedulerSetHint(&s, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, s.hintMs);
+}
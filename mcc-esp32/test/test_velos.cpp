@@ -44,4 +44,22 @@ void test_velos() {
 
     formatVelosDE(1000, formatted, sizeof(formatted));
     TEST_ASSERT_EQUAL_STRING("1.000", formatted);
+
+    // Local estimate: server value at 10 pulses, 2300 mm per pulse at 29"
+    VelosAnchor anchor = {false, 1.0f, 100, 10};
+    TEST_ASSERT_EQUAL_INT(0, velosEstimate(&anchor, 20, 2300.0f, 0.0f));
+    anchor.valid = true;
+    TEST_ASSERT_EQUAL_INT(100, velosEstimate(&anchor, 10, 2300.0f, 0.0f));
+    TEST_ASSERT_EQUAL_INT(100, velosEstimate(&anchor, 5, 2300.0f, 0.0f));
+    TEST_ASSERT_EQUAL_INT(101, velosEstimate(&anchor, 15, 2300.0f, 0.0f));
+    // 435 pulses = 1.0005 km on top of the server km
+    TEST_ASSERT_EQUAL_INT(200, velosEstimate(&anchor, 445, 2300.0f, 0.0f));
+
+    // Without session_km the local Velos are added to the server Velos
+    anchor.sessionKm = -1.0f;
+    TEST_ASSERT_EQUAL_INT(200, velosEstimate(&anchor, 445, 2300.0f, 0.0f));
+
+    // Rounding of session_km never shows less than the server value
+    anchor.sessionKm = 0.997f;
+    TEST_ASSERT_EQUAL_INT(100, velosEstimate(&anchor, 11, 2300.0f, 0.0f));
 }
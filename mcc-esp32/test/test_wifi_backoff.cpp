@@ -0,0 +1,49 @@
+/* Copyright (c) 2026 SAI-Lab / MyCyclingCity
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * @file    test_wifi_backoff.cpp
+ * @author  Roland Rutz
+ * @note    This code was developed with the assistance of AI (LLMs).
+ */
+
+#include <unity.h>
+
+#include "../src/wifi_backoff.h"
+
+static const uint32_t BASE_MS = 2000;
+static const uint32_t MAX_MS = 300000;
+
+void test_wifi_backoff() {
+    // Random 0 gives the lower bound (half), random == step/2 the upper bound (full step)
+    TEST_ASSERT_EQUAL_UINT32(1000, wifiBackoffDelayMs(1, BASE_MS, MAX_MS, 0));
+    TEST_ASSERT_EQUAL_UINT32(2000, wifiBackoffDelayMs(1, BASE_MS, MAX_MS, 1000));
+    TEST_ASSERT_EQUAL_UINT32(1000, wifiBackoffDelayMs(1, BASE_MS, MAX_MS, 1001));
+
+    // Doubles per failure
+    TEST_ASSERT_EQUAL_UINT32(2000, wifiBackoffDelayMs(2, BASE_MS, MAX_MS, 0));
+    TEST_ASSERT_EQUAL_UINT32(4000, wifiBackoffDelayMs(3, BASE_MS, MAX_MS, 0));
+    TEST_ASSERT_EQUAL_UINT32(128000, wifiBackoffDelayMs(8, BASE_MS, MAX_MS, 0));
+
+    // Capped at the maximum, also for very long outages
+    TEST_ASSERT_EQUAL_UINT32(150000, wifiBackoffDelayMs(9, BASE_MS, MAX_MS, 0));
+    TEST_ASSERT_EQUAL_UINT32(300000, wifiBackoffDelayMs(9, BASE_MS, MAX_MS, 150000));
+    TEST_ASSERT_EQUAL_UINT32(150000, wifiBackoffDelayMs(100000, BASE_MS, MAX_MS, 0));
+
+    // Every random value stays within [half, step]
+    for (uint32_t r = 0; r < 100000; r += 7919) {
+        uint32_t delayMs = wifiBackoffDelayMs(4, BASE_MS, MAX_MS, r * 2654435761u);
+        TEST_ASSERT_TRUE(delayMs >= 8000 && delayMs <= 16000);
+    }
+
+    // Network selection: strongest network that was seen, else the fallback
+    int32_t rssi[2] = {-80, -60};
+    TEST_ASSERT_EQUAL_UINT8(1, wifiSelectNetwork(rssi, 2, 0));
+    rssi[1] = INT32_MIN;
+    TEST_ASSERT_EQUAL_UINT8(0, wifiSelectNetwork(rssi, 2, 1));
+    rssi[0] = INT32_MIN;
+    TEST_ASSERT_EQUAL_UINT8(1, wifiSelectNetwork(rssi, 2, 1));
+    TEST_ASSERT_EQUAL_UINT8(0, wifiSelectNetwork(rssi, 2, 0));
+    rssi[0] = -70;
+    rssi[1] = -70;
+    TEST_ASSERT_EQUAL_UINT8(0, wifiSelectNetwork(rssi, 2, 1));
+}
@@ -17,3 +17,11 @@ class ApiConfig(AppConfig):
     
     verbose_name = _('Gruppen & Radler')
 
+    def ready(self):
+        """Connect signals when app is ready."""
+        from django.db.models.signals import post_save
+        from iot.models import DeviceConfiguration
+        from . import signals as api_signals
+
+        post_save.connect(api_signals.on_device_configuration_saved, sender=DeviceConfiguration)
+
@@ -0,0 +1,71 @@
+# Copyright (c) 2026 SAI-Lab / MyCyclingCity
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# @file    mqtt_bridge.py
+# @author  Roland Rutz
+# @note    This code was developed with the assistance of AI (LLMs).
+
+#
+from django.conf import settings
+from django.core.management.base import BaseCommand, CommandError
+from django.db import close_old_connections
+
+from api.services import mqtt_push
+from config.logger_utils import get_logger
+
+logger = get_logger(__name__)
+
+CLIENT_ID = 'mcc-server-bridge'
+SUBSCRIPTION = f"{mqtt_push.TOPIC_PREFIX}+/up/#"
+
+
+class Command(BaseCommand):
+    help = 'Connects to the MQTT broker and processes device uploads and status messages'
+
+    def handle(self, *args, **options):
+        if not mqtt_push.is_enabled():
+            raise CommandError('MCC_MQTT_BROKER_URL is not set')
+        try:
+            import paho.mqtt.client as mqtt
+        except ImportError:
+            raise CommandError('paho-mqtt is not installed (pip install -r requirements.txt)')
+
+        params = mqtt_push.broker_params()
+        # Persistent session: uploads published while the bridge restarts are delivered afterwards
+        client = mqtt.Client(
+            mqtt.CallbackAPIVersion.VERSION2,
+            client_id=CLIENT_ID,
+            clean_session=False,
+        )
+        if settings.MCC_MQTT_BRIDGE_PASSWORD:
+            client.username_pw_set(settings.MCC_MQTT_BRIDGE_USERNAME, settings.MCC_MQTT_BRIDGE_PASSWORD)
+        if params['tls']:
+            client.tls_set()
+
+        def on_connect(client, userdata, flags, reason_code, properties):
+            if reason_code.is_failure:
+                logger.error(f"[mqtt_bridge] Connection refused: {reason_code}")
+                return
+            client.subscribe(SUBSCRIPTION, qos=mqtt_push.QOS)
+            logger.info(f"[mqtt_bridge] Connected to {params['hostname']}:{params['port']}, subscribed to {SUBSCRIPTION}")
+
+        def on_message(client, userdata, message):
+            # Long-running process: drop connections the database closed in the meantime
+            close_old_connections()
+            try:
+                mqtt_push.handle_bridge_message(message.topic, message.payload, client=client)
+            except Exception as e:
+                logger.error(f"[mqtt_bridge] Error handling {message.topic}: {e}", exc_info=True)
+
+        client.on_connect = on_connect
+        client.on_message = on_message
+
+        self.stdout.write(self.style.NOTICE(f"--- Starte MQTT Bridge: {params['hostname']}:{params['port']} ---"))
+        client.connect(params['hostname'], params['port'], keepalive=60)
+        try:
+            client.loop_forever(retry_first_connection=True)
+        except KeyboardInterrupt:
+            pass
+        finally:
+            client.disconnect()
+        self.stdout.write(self.style.NOTICE("--- MQTT Bridge beendet ---"))
@@ -67,6 +67,23 @@ def end_device_session_for_device(device: Device, *, reason: str = '') -> Option
     return cyclist
 
 
+def operator_reset_defaults(device: Device) -> tuple[str, str]:
+    """Default ID tag of *device* and the user_id shown after an operator reset ('NULL' if unknown)."""
+    from iot.models import DeviceConfiguration
+
+    try:
+        default_tag = (device.configuration.default_id_tag or '').strip()
+    except DeviceConfiguration.DoesNotExist:
+        default_tag = ''
+
+    default_user_id = 'NULL'
+    if default_tag:
+        default_cyclist = Cyclist.objects.filter(id_tag__iexact=default_tag).first()
+        if default_cyclist and default_cyclist.user_id:
+            default_user_id = default_cyclist.user_id
+    return default_tag, default_user_id
+
+
 def end_game_round_device_sessions(
     device_assignments: Dict[str, str],
     *,
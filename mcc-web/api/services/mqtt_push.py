@@ -0,0 +1,235 @@
+# Copyright (c) 2026 SAI-Lab / MyCyclingCity
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# MQTT transport for devices: server pushes (config, display Velos, operator
+# reset) and the bridge that turns device publishes into update-data calls.
+#
+# Topics per device (client ID and user name at the broker = device name):
+#   mcc/<device>/up/update     upload, same JSON body as POST /api/update-data
+#   mcc/<device>/up/status     "online" / "offline" (retained, also the last will)
+#   mcc/<device>/down/update   update-data response plus "status" and "id_tag"
+#   mcc/<device>/down/config   config fetch response (retained)
+#   mcc/<device>/down/display  display Velos (retained)
+#   mcc/<device>/down/reset    operator reset, fields as in the get-user-id response
+
+from __future__ import annotations
+
+import json
+import time
+from typing import Optional
+from urllib.parse import urlparse
+
+from django.conf import settings
+from django.core.cache import cache
+
+from config.logger_utils import get_logger
+from iot.models import Device, DeviceConfiguration, DeviceHealth
+
+logger = get_logger(__name__)
+
+TOPIC_PREFIX = 'mcc/'
+QOS = 1
+CONFIG_HASH_CACHE_PREFIX = 'mqtt_config_hash:'
+# After a failed short connection, pushes from web requests skip the broker for this long
+PUBLISH_BACKOFF_CACHE_KEY = 'mqtt_publish_backoff'
+PUBLISH_BACKOFF_SECONDS = 60
+# update-data answers 503 while the database is locked; the device does not retry a PUBACKed upload
+UPDATE_RETRIES = 3
+UPDATE_RETRY_DELAY_SECONDS = 1.0
+
+
+def is_enabled() -> bool:
+    return bool(getattr(settings, 'MCC_MQTT_BROKER_URL', ''))
+
+
+def device_topic(device_name: str, direction: str, name: str) -> str:
+    return f"{TOPIC_PREFIX}{device_name}/{direction}/{name}"
+
+
+def parse_topic(topic: str) -> Optional[tuple[str, str, str]]:
+    """Split mcc/<device>/<up|down>/<name>; None for foreign topics."""
+    parts = topic.split('/')
+    if len(parts) != 4 or parts[0] + '/' != TOPIC_PREFIX or parts[2] not in ('up', 'down'):
+        return None
+    if not parts[1] or not parts[3]:
+        return None
+    return parts[1], parts[2], parts[3]
+
+
+def broker_params() -> dict:
+    """Host, port and TLS flag from MCC_MQTT_BROKER_URL."""
+    url = urlparse(settings.MCC_MQTT_BROKER_URL)
+    tls = url.scheme == 'mqtts'
+    return {
+        'hostname': url.hostname or 'localhost',
+        'port': url.port or (8883 if tls else 1883),
+        'tls': tls,
+    }
+
+
+def _publish(topic: str, payload: dict, retain: bool = False, client=None) -> bool:
+    """
+    Publish JSON with QoS 1. Uses the given paho client (bridge) or a short
+    connection. Errors are logged only: the device still polls over HTTP
+    when it is not connected to the broker. After a failed short connection
+    the broker is not tried again for PUBLISH_BACKOFF_SECONDS, so requests
+    that save configurations do not each wait for the connect timeout.
+    """
+    if not is_enabled():
+        return False
+    message = json.dumps(payload, separators=(',', ':'), default=str)
+    if client is not None:
+        try:
+            client.publish(topic, message, qos=QOS, retain=retain)
+            return True
+        except Exception as e:
+            logger.warning(f"[mqtt_push] Publish on {topic} failed: {e}")
+            return False
+    if cache.get(PUBLISH_BACKOFF_CACHE_KEY):
+        logger.debug(f"[mqtt_push] Broker unreachable recently, skipping publish on {topic}")
+        return False
+    try:
+        import paho.mqtt.publish as mqtt_publish
+
+        params = broker_params()
+        auth = None
+        if settings.MCC_MQTT_BRIDGE_PASSWORD:
+            auth = {
+                'username': settings.MCC_MQTT_BRIDGE_USERNAME,
+                'password': settings.MCC_MQTT_BRIDGE_PASSWORD,
+            }
+        mqtt_publish.single(
+            topic,
+            message,
+            qos=QOS,
+            retain=retain,
+            hostname=params['hostname'],
+            port=params['port'],
+            auth=auth,
+            tls={} if params['tls'] else None,
+        )
+        return True
+    except Exception as e:
+        cache.set(PUBLISH_BACKOFF_CACHE_KEY, True, PUBLISH_BACKOFF_SECONDS)
+        logger.warning(f"[mqtt_push] Publish on {topic} failed, retrying after {PUBLISH_BACKOFF_SECONDS} s: {e}")
+        return False
+
+
+def push_device_config(config: DeviceConfiguration, client=None, force: bool = False) -> bool:
+    """Push the configuration as on a config fetch; skipped if this hash was pushed already."""
+    from api.views import _config_hash
+
+    config_dict = config.to_dict()
+    config_hash = _config_hash(config_dict)
+    cache_key = f"{CONFIG_HASH_CACHE_PREFIX}{config.device.name}"
+    if not force and cache.get(cache_key) == config_hash:
+        return False
+    payload = {
+        'success': True,
+        'config': config_dict,
+        'config_hash': config_hash,
+    }
+    if not _publish(device_topic(config.device.name, 'down', 'config'), payload, retain=True, client=client):
+        return False
+    cache.set(cache_key, config_hash, None)
+    logger.info(f"[mqtt_push] Pushed configuration to {config.device.name} (hash {config_hash})")
+    return True
+
+
+def push_device_display(device: Device, client=None) -> bool:
+    """Push the display Velos (round frozen or live session)."""
+    from api.services.device_display import (
+        build_device_display_api_payload,
+        get_active_session_for_device,
+    )
+
+    payload = build_device_display_api_payload(device, get_active_session_for_device(device))
+    return _publish(device_topic(device.name, 'down', 'display'), payload, retain=True, client=client)
+
+
+def push_operator_reset(device: Device, client=None) -> bool:
+    """Tell the device to return to its default ID tag (operator tag without RFID)."""
+    from api.services.device_session import operator_reset_defaults
+
+    default_tag, default_user_id = operator_reset_defaults(device)
+    payload = {
+        'action': 'reset_to_default',
+        'default_id_tag': default_tag,
+        'default_user_id': default_user_id,
+    }
+    # Not retained: a reset must not be repeated on every reconnect
+    return _publish(device_topic(device.name, 'down', 'reset'), payload, client=client)
+
+
+def _forward_update(device_name: str, payload: bytes) -> dict:
+    """Run update-data for a published upload; returns the response plus status."""
+    from django.test import RequestFactory
+    from api.views import update_data
+
+    try:
+        data = json.loads(payload)
+    except (json.JSONDecodeError, UnicodeDecodeError):
+        return {'status': 400, 'error': 'invalid JSON'}
+    if not isinstance(data, dict) or data.get('device_id') != device_name:
+        # The broker ACL only checks the topic, the body must name the same device
+        logger.warning(f"[mqtt_bridge] Upload on topic of {device_name} for device {data.get('device_id') if isinstance(data, dict) else None}")
+        return {'status': 403, 'error': 'device_id does not match topic'}
+
+    factory = RequestFactory()
+    response = None
+    for attempt in range(UPDATE_RETRIES):
+        # The broker authenticated the device; the server key passes the API key check
+        request = factory.post(
+            '/api/update-data',
+            data=payload,
+            content_type='application/json',
+            HTTP_X_API_KEY=settings.MCC_APP_API_KEY,
+        )
+        response = update_data(request)
+        if response.status_code != 503:
+            break
+        time.sleep(UPDATE_RETRY_DELAY_SECONDS * (attempt + 1))
+
+    try:
+        result = json.loads(response.content) if response.content else {}
+    except json.JSONDecodeError:
+        result = {}
+    if not isinstance(result, dict):
+        result = {}
+    result['status'] = response.status_code
+    result['id_tag'] = data.get('id_tag', '')
+    return result
+
+
+def _handle_status(device_name: str, payload: bytes, client=None) -> None:
+    try:
+        device = Device.objects.get(name=device_name)
+    except Device.DoesNotExist:
+        return
+    health, _ = DeviceHealth.objects.get_or_create(device=device)
+    state = payload.decode('utf-8', errors='ignore').strip()
+    if state == 'online':
+        health.update_heartbeat()
+        try:
+            # A config changed while no one listened is retained, this covers a cleared cache
+            push_device_config(device.configuration, client=client)
+        except DeviceConfiguration.DoesNotExist:
+            pass
+    elif state == 'offline':
+        health.status = 'offline'
+        health.save(update_fields=['status', 'updated_at'])
+
+
+def handle_bridge_message(topic: str, payload: bytes, client=None) -> None:
+    """Entry point of the mqtt_bridge command for each message on mcc/+/up/#."""
+    parsed = parse_topic(topic)
+    if parsed is None or parsed[1] != 'up':
+        return
+    device_name, _direction, name = parsed
+    if name == 'update':
+        result = _forward_update(device_name, payload)
+        _publish(device_topic(device_name, 'down', 'update'), result, client=client)
+    elif name == 'status':
+        _handle_status(device_name, payload, client=client)
+    else:
+        logger.debug(f"[mqtt_bridge] Ignoring {topic}")
@@ -0,0 +1,34 @@
+# Copyright (c) 2026 SAI-Lab / MyCyclingCity
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Push device configuration and display changes over MQTT (api/services/mqtt_push.py).
+
+from django.db import transaction
+
+from api.services import mqtt_push
+
+# Saves that only change the OLED lock (round stop, unlock) push the display instead of the config
+DISPLAY_FIELDS = frozenset({'display_velos_locked', 'frozen_display_velos', 'updated_at'})
+# Bookkeeping of config fetches and reports; nothing the device receives changes
+SYNC_FIELDS = frozenset({'last_synced_at', 'request_config_comparison', 'updated_at'})
+
+
+def on_device_configuration_saved(sender, instance, created, update_fields=None, **kwargs):
+    if not mqtt_push.is_enabled():
+        return
+    if update_fields is not None and set(update_fields) <= SYNC_FIELDS:
+        return
+    config_id = instance.pk
+    display_only = update_fields is not None and set(update_fields) <= DISPLAY_FIELDS
+
+    def push():
+        # Fresh instance after commit: the device must not get an uncommitted or stale state
+        config = sender.objects.select_related('device').filter(pk=config_id).first()
+        if config is None:
+            return
+        if display_only:
+            mqtt_push.push_device_display(config.device)
+        else:
+            mqtt_push.push_device_config(config)
+
+    transaction.on_commit(push)
@@ -0,0 +1,120 @@
+# Copyright (c) 2026 SAI-Lab / MyCyclingCity
+# SPDX-License-Identifier: AGPL-3.0-or-later
+
+import json
+import pytest
+from django.test import Client
+from django.urls import reverse
+
+from api.services.device_display import DISPLAY_MODE_LIVE, lock_device_display
+from api.tests.conftest import DeviceFactory
+from iot.models import DeviceAuditLog, DeviceHealth
+
+
+def _sync(api_key, payload):
+    return Client().post(
+        reverse('device_sync'),
+        data=json.dumps(payload),
+        content_type='application/json',
+        HTTP_X_API_KEY=api_key,
+    )
+
+
+@pytest.mark.unit
+@pytest.mark.django_db
+class TestDeviceSync:
+    def test_first_sync_returns_config_and_hash(self, api_key):
+        device = DeviceFactory()
+        response = _sync(api_key, {
+            'device_id': device.name,
+            'firmware_version': '1.0.0',
+            'config_hash': 0,
+        })
+        assert response.status_code == 200
+        data = response.json()
+        assert data['success'] is True
+        assert data['config']['send_interval_seconds'] == device.configuration.send_interval_seconds
+        assert data['config_hash'] != 0
+        assert data['firmware']['update_available'] is False
+        assert DeviceHealth.objects.get(device=device).last_heartbeat is not None
+
+    def test_unchanged_config_is_not_sent_again(self, api_key):
+        device = DeviceFactory()
+        first = _sync(api_key, {'device_id': device.name, 'config_hash': 0}).json()
+        second = _sync(api_key, {'device_id': device.name, 'config_hash': first['config_hash']}).json()
+        assert 'config' not in second
+        assert 'config_hash' not in second
+
+        config = device.configuration
+        config.send_interval_seconds = config.send_interval_seconds + 30
+        config.save()
+        third = _sync(api_key, {'device_id': device.name, 'config_hash': first['config_hash']}).json()
+        assert third['config']['send_interval_seconds'] == config.send_interval_seconds
+        assert third['config_hash'] != first['config_hash']
+
+    def test_config_report_and_boot_reason(self, api_key):
+        device = DeviceFactory()
+        lock_device_display(device, 99)
+        response = _sync(api_key, {
+            'device_id': device.name,
+            'boot_reason': 'deep_sleep',
+            'config_report': {'device_name': device.name, 'send_interval_seconds': 60},
+        })
+        assert response.status_code == 200
+        data = response.json()
+        assert data['config_report']['has_differences'] is False
+        assert data['display_mode'] == DISPLAY_MODE_LIVE
+        device.configuration.refresh_from_db()
+        assert device.configuration.display_velos_locked is False
+
+    def test_boot_timeline_kept_in_audit_log(self, api_key):
+        device = DeviceFactory()
+        response = _sync(api_key, {
+            'device_id': device.name,
+            'boot_reason': 'deep_sleep',
+            'boot_timeline': {'setup': 310000, 'pcnt': 310400, 'wifi': 'slow', 'nvs': True},
+        })
+        assert response.status_code == 200
+        entry = DeviceAuditLog.objects.filter(device=device, action='heartbeat_received').latest('created_at')
+        assert entry.details == {
+            'sync': True,
+            'boot_reason': 'deep_sleep',
+            'boot_timeline': {'setup': 310000, 'pcnt': 310400},
+        }
+
+    def test_invalid_api_key(self, api_key):
+        device = DeviceFactory()
+        response = _sync('WRONG-KEY', {'device_id': device.name})
+        assert response.status_code == 403
+
+
+@pytest.mark.unit
+@pytest.mark.django_db
+class TestConfigFetchConditional:
+    def _fetch(self, api_key, device, etag=None):
+        headers = {'HTTP_X_API_KEY': api_key}
+        if etag:
+            headers['HTTP_IF_NONE_MATCH'] = etag
+        return Client().get(reverse('device_config_fetch'), {'device_id': device.name}, **headers)
+
+    def test_unchanged_config_returns_304(self, api_key):
+        device = DeviceFactory()
+        first = self._fetch(api_key, device)
+        assert first.status_code == 200
+        assert first['ETag'] == f'"{first.json()["config_hash"]}"'
+
+        second = self._fetch(api_key, device, first['ETag'])
+        assert second.status_code == 304
+        assert second.content == b''
+
+    def test_changed_config_returns_200(self, api_key):
+        device = DeviceFactory()
+        etag = self._fetch(api_key, device)['ETag']
+        config = device.configuration
+        config.deep_sleep_seconds = config.deep_sleep_seconds + 60
+        config.save()
+
+        response = self._fetch(api_key, device, etag)
+        assert response.status_code == 200
+        assert response.json()['config']['deep_sleep_seconds'] == config.deep_sleep_seconds
+        assert response['ETag'] != etag
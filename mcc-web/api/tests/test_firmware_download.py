@@ -0,0 +1,68 @@
+# Copyright (c) 2026 SAI-Lab / MyCyclingCity
+# SPDX-License-Identifier: AGPL-3.0-or-later
+
+import pytest
+from django.core.files.base import ContentFile
+from django.test import Client
+from django.urls import reverse
+
+from api.tests.conftest import DeviceFactory
+from iot.models import FirmwareImage
+
+# Above the 10 KB the view accepts as a plausible ESP32 image
+FIRMWARE = bytes(range(256)) * 80
+
+
+@pytest.fixture
+def device(settings, tmp_path):
+    settings.MEDIA_ROOT = tmp_path
+    firmware = FirmwareImage(name='Test Firmware', version='2.0.0', environment='test')
+    firmware.firmware_file.save('test.bin', ContentFile(FIRMWARE), save=False)
+    firmware.save()
+    device = DeviceFactory()
+    device.configuration.assigned_firmware = firmware
+    device.configuration.save()
+    return device
+
+
+def _download(api_key, device, range_header=None):
+    headers = {'HTTP_X_API_KEY': api_key}
+    if range_header:
+        headers['HTTP_RANGE'] = range_header
+    return Client().get(reverse('device_firmware_download'), {'device_id': device.name}, **headers)
+
+
+def _body(response):
+    try:
+        return b''.join(response.streaming_content)
+    finally:
+        response.close()
+
+
+@pytest.mark.unit
+@pytest.mark.django_db
+class TestFirmwareDownloadRange:
+    def test_without_range_returns_whole_file(self, api_key, device):
+        response = _download(api_key, device)
+
+        assert response.status_code == 200
+        assert response['Content-Length'] == str(len(FIRMWARE))
+        assert response['Accept-Ranges'] == 'bytes'
+        assert not response.has_header('Content-Range')
+        assert _body(response) == FIRMWARE
+
+    def test_open_range_resumes_at_offset(self, api_key, device):
+        response = _download(api_key, device, 'bytes=5000-')
+
+        assert response.status_code == 206
+        assert response['Content-Length'] == str(len(FIRMWARE) - 5000)
+        assert response['Content-Range'] == f'bytes 5000-{len(FIRMWARE) - 1}/{len(FIRMWARE)}'
+        assert response['X-Firmware-Size'] == str(len(FIRMWARE))
+        assert _body(response) == FIRMWARE[5000:]
+
+    @pytest.mark.parametrize('offset', [len(FIRMWARE), len(FIRMWARE) + 1000])
+    def test_offset_past_end_returns_416(self, api_key, device, offset):
+        response = _download(api_key, device, f'bytes={offset}-')
+
+        assert response.status_code == 416
+        assert response['Content-Range'] == f'bytes */{len(FIRMWARE)}'
@@ -0,0 +1,211 @@
+# Copyright (c) 2026 SAI-Lab / MyCyclingCity
+# SPDX-License-Identifier: AGPL-3.0-or-later
+
+"""Tests for the MQTT transport: broker auth endpoints, bridge and server pushes."""
+
+import json
+import pytest
+from django.core.cache import cache
+from django.test import Client
+from django.urls import reverse
+
+from api.models import CyclistDeviceCurrentMileage
+from api.services import mqtt_push
+from api.services.device_display import lock_device_display
+from api.tests.conftest import CyclistFactory, DeviceFactory, GroupFactory
+from iot.models import DeviceHealth
+
+
+@pytest.fixture
+def published(settings, monkeypatch):
+    """Enable MQTT and record publishes instead of sending them."""
+    settings.MCC_MQTT_BROKER_URL = 'mqtt://broker.test:1883'
+    settings.MCC_MQTT_BRIDGE_USERNAME = 'mcc-server'
+    settings.MCC_MQTT_BRIDGE_PASSWORD = 'bridge-secret'
+    cache.clear()
+    messages = []
+
+    def record(topic, payload, retain=False, client=None):
+        messages.append({'topic': topic, 'payload': payload, 'retain': retain})
+        return True
+
+    monkeypatch.setattr(mqtt_push, '_publish', record)
+    return messages
+
+
+def _post(url_name, **data):
+    return Client().post(reverse(url_name), data=data)
+
+
+@pytest.mark.unit
+@pytest.mark.django_db
+class TestMqttAuth:
+    def test_device_login_with_own_key(self, published):
+        device = DeviceFactory(name='Bike-1')
+        key = device.configuration.device_specific_api_key
+
+        assert _post('mqtt_auth_user', username='Bike-1', password=key).status_code == 200
+        assert _post('mqtt_auth_user', username='Bike-1', password='wrong').status_code == 403
+
+    def test_device_key_of_other_device_rejected(self, published):
+        DeviceFactory(name='Bike-1')
+        other = DeviceFactory(name='Bike-2')
+        key = other.configuration.device_specific_api_key
+
+        assert _post('mqtt_auth_user', username='Bike-1', password=key).status_code == 403
+
+    def test_bridge_login(self, published):
+        assert _post('mqtt_auth_user', username='mcc-server', password='bridge-secret').status_code == 200
+        assert _post('mqtt_auth_user', username='mcc-server', password='nope').status_code == 403
+
+    def test_acl_limits_device_to_own_topics(self, published):
+        assert _post('mqtt_auth_acl', username='Bike-1', topic='mcc/Bike-1/up/update', acc=2).status_code == 200
+        assert _post('mqtt_auth_acl', username='Bike-1', topic='mcc/Bike-1/down/#', acc=4).status_code == 200
+        assert _post('mqtt_auth_acl', username='Bike-1', topic='mcc/Bike-1/down/config', acc=1).status_code == 200
+        # No pushes on behalf of the server, no foreign topics
+        assert _post('mqtt_auth_acl', username='Bike-1', topic='mcc/Bike-1/down/reset', acc=2).status_code == 403
+        assert _post('mqtt_auth_acl', username='Bike-1', topic='mcc/Bike-2/up/update', acc=2).status_code == 403
+        assert _post('mqtt_auth_acl', username='Bike-1', topic='mcc/+/up/#', acc=4).status_code == 403
+        assert _post('mqtt_auth_acl', username='mcc-server', topic='mcc/+/up/#', acc=4).status_code == 200
+
+
+@pytest.mark.unit
+@pytest.mark.django_db
+class TestMqttBridge:
+    def test_upload_is_processed_and_answered(self, published, api_key):
+        group = GroupFactory()
+        cyclist = CyclistFactory(user_id='Rider', id_tag='tag-1')
+        cyclist.groups.add(group)
+        DeviceFactory(name='Bike-1', group=group)
+        body = json.dumps({'id_tag': 'tag-1', 'device_id': 'Bike-1', 'distance': 0.5}).encode()
+
+        mqtt_push.handle_bridge_message('mcc/Bike-1/up/update', body)
+
+        assert CyclistDeviceCurrentMileage.objects.filter(cyclist=cyclist).exists()
+        reply = published[-1]
+        assert reply['topic'] == 'mcc/Bike-1/down/update'
+        assert reply['payload']['status'] == 200
+        assert reply['payload']['id_tag'] == 'tag-1'
+        assert reply['retain'] is False
+
+    def test_upload_for_other_device_rejected(self, published, api_key):
+        DeviceFactory(name='Bike-1')
+        body = json.dumps({'id_tag': 'tag-1', 'device_id': 'Bike-2', 'distance': 0.5}).encode()
+
+        mqtt_push.handle_bridge_message('mcc/Bike-1/up/update', body)
+
+        assert published[-1]['payload']['status'] == 403
+        assert not CyclistDeviceCurrentMileage.objects.exists()
+
+    def test_status_updates_health_and_pushes_config(self, published):
+        device = DeviceFactory(name='Bike-1')
+
+        mqtt_push.handle_bridge_message('mcc/Bike-1/up/status', b'online')
+        assert DeviceHealth.objects.get(device=device).status == 'online'
+        assert [m['topic'] for m in published] == ['mcc/Bike-1/down/config']
+
+        mqtt_push.handle_bridge_message('mcc/Bike-1/up/status', b'offline')
+        assert DeviceHealth.objects.get(device=device).status == 'offline'
+
+
+@pytest.mark.unit
+@pytest.mark.django_db
+class TestMqttPush:
+    def test_config_change_pushed_once(self, published, django_capture_on_commit_callbacks):
+        device = DeviceFactory(name='Bike-1')
+        published.clear()
+        config = device.configuration
+
+        with django_capture_on_commit_callbacks(execute=True):
+            config.send_interval_seconds = 30
+            config.save()
+        with django_capture_on_commit_callbacks(execute=True):
+            config.save()
+
+        assert len(published) == 1
+        message = published[0]
+        assert message['topic'] == 'mcc/Bike-1/down/config'
+        assert message['retain'] is True
+        assert message['payload']['config']['send_interval_seconds'] == 30
+
+    def test_sync_bookkeeping_not_pushed(self, published, django_capture_on_commit_callbacks):
+        device = DeviceFactory(name='Bike-1')
+        published.clear()
+        config = device.configuration
+        config.send_interval_seconds = 30
+
+        with django_capture_on_commit_callbacks(execute=True) as callbacks:
+            config.save(update_fields=['last_synced_at'])
+            config.save(update_fields=['request_config_comparison', 'last_synced_at'])
+
+        assert callbacks == []
+        assert published == []
+
+    def test_config_fetch_does_not_push(self, published, api_key, django_capture_on_commit_callbacks):
+        device = DeviceFactory(name='Bike-1')
+        published.clear()
+
+        with django_capture_on_commit_callbacks(execute=True):
+            response = Client().get(reverse('device_config_fetch'), {'device_id': device.name},
+                                    HTTP_X_API_KEY=api_key)
+
+        assert response.status_code == 200
+        assert published == []
+
+    def test_failed_publish_backs_off(self, settings, monkeypatch):
+        settings.MCC_MQTT_BROKER_URL = 'mqtt://broker.test:1883'
+        cache.clear()
+        import paho.mqtt.publish as mqtt_publish
+
+        attempts = []
+
+        def unreachable(*args, **kwargs):
+            attempts.append(args[0])
+            raise OSError('connection refused')
+
+        monkeypatch.setattr(mqtt_publish, 'single', unreachable)
+
+        assert mqtt_push._publish('mcc/Bike-1/down/config', {'a': 1}) is False
+        assert mqtt_push._publish('mcc/Bike-1/down/config', {'a': 2}) is False
+        assert len(attempts) == 1
+
+        cache.delete(mqtt_push.PUBLISH_BACKOFF_CACHE_KEY)
+        assert mqtt_push._publish('mcc/Bike-1/down/config', {'a': 3}) is False
+        assert len(attempts) == 2
+
+    def test_display_lock_pushes_display(self, published, django_capture_on_commit_callbacks):
+        device = DeviceFactory(name='Bike-1')
+        published.clear()
+
+        with django_capture_on_commit_callbacks(execute=True):
+            lock_device_display(device, 42)
+
+        assert [m['topic'] for m in published] == ['mcc/Bike-1/down/display']
+        assert published[0]['payload']['display_mode'] == 'round_frozen'
+        assert published[0]['payload']['display_velos'] == 42
+
+    def test_operator_reset_push(self, published):
+        default = CyclistFactory(user_id='Kette', id_tag='default-tag')
+        device = DeviceFactory(name='Bike-1')
+        device.configuration.default_id_tag = default.id_tag
+        device.configuration.save()
+        published.clear()
+
+        assert mqtt_push.push_operator_reset(device)
+        assert published[0]['topic'] == 'mcc/Bike-1/down/reset'
+        assert published[0]['payload'] == {
+            'action': 'reset_to_default',
+            'default_id_tag': 'default-tag',
+            'default_user_id': 'Kette',
+        }
+        assert published[0]['retain'] is False
+
+    def test_disabled_without_broker(self, settings, django_capture_on_commit_callbacks):
+        settings.MCC_MQTT_BROKER_URL = ''
+        device = DeviceFactory(name='Bike-1')
+
+        with django_capture_on_commit_callbacks(execute=False) as callbacks:
+            device.configuration.save()
+
+        assert callbacks == []
+        assert mqtt_push.push_operator_reset(device) is False
@@ -0,0 +1,149 @@
+# Copyright (c) 2026 SAI-Lab / MyCyclingCity
+# SPDX-License-Identifier: AGPL-3.0-or-later
+
+"""Tests for the update-data-batch endpoint (ride journal replay, multi-bike stations)."""
+
+import json
+from decimal import Decimal
+
+import pytest
+from django.db import OperationalError
+from django.test import Client
+from django.urls import reverse
+
+from api import views
+from api.tests.conftest import CyclistFactory
+
+
+def _post_batch(api_key, body):
+    return Client().post(
+        reverse('update_data_batch'),
+        data=json.dumps(body),
+        content_type='application/json',
+        HTTP_X_API_KEY=api_key,
+    )
+
+
+@pytest.mark.unit
+@pytest.mark.django_db
+class TestUpdateDataBatch:
+    def test_journal_batch_acknowledges_last_seq(self, api_key, complete_test_scenario):
+        cyclist = complete_test_scenario['cyclist']
+        device = complete_test_scenario['device']
+
+        response = _post_batch(api_key, {
+            'device_id': device.name,
+            'intervals': [
+                {'seq': 41, 'id_tag': cyclist.id_tag, 'distance': 0.25},
+                {'seq': 42, 'id_tag': cyclist.id_tag, 'distance': 0.5},
+            ],
+        })
+
+        assert response.status_code == 200
+        data = response.json()
+        assert data['last_seq'] == 42
+        assert data['processed'] == 2
+        assert 'display_mode' in data
+        cyclist.refresh_from_db()
+        assert cyclist.distance_total == Decimal('0.75')
+
+    def test_station_batch_for_several_riders(self, api_key, complete_test_scenario):
+        group = complete_test_scenario['child_group']
+        device = complete_test_scenario['device']
+        riders = [CyclistFactory(id_tag=f'station-{i}') for i in range(3)]
+        for rider in riders:
+            rider.groups.add(group)
+
+        response = _post_batch(api_key, {
+            'device_id': device.name,
+            'intervals': [{'id_tag': rider.id_tag, 'distance': 0.1} for rider in riders],
+        })
+
+        assert response.status_code == 200
+        data = response.json()
+        assert data['processed'] == 3
+        assert 'last_seq' not in data
+        for rider in riders:
+            rider.refresh_from_db()
+            assert rider.distance_total == Decimal('0.1')
+        device.refresh_from_db()
+        assert device.distance_total == Decimal('0.3')
+
+    def test_unknown_cyclist_is_acknowledged_not_404(self, api_key, complete_test_scenario):
+        device = complete_test_scenario['device']
+
+        response = _post_batch(api_key, {
+            'device_id': device.name,
+            'intervals': [{'seq': 7, 'id_tag': 'no-such-tag', 'distance': 0.2}],
+        })
+
+        # 404 would make the firmware switch to single uploads for good
+        assert response.status_code == 200
+        assert response.json()['last_seq'] == 7
+        assert response.json()['processed'] == 0
+
+    @pytest.mark.parametrize('with_seq', [True, False])
+    def test_locked_database_after_first_interval(self, api_key, complete_test_scenario, monkeypatch, with_seq):
+        cyclist = complete_test_scenario['cyclist']
+        device = complete_test_scenario['device']
+        distance_before = cyclist.distance_total
+        process_update = views._process_update_with_retry
+        calls = []
+
+        def locked_after_first(*args):
+            calls.append(args)
+            if len(calls) > 1:
+                raise OperationalError('database is locked')
+            return process_update(*args)
+
+        monkeypatch.setattr(views, '_process_update_with_retry', locked_after_first)
+        intervals = [{'id_tag': cyclist.id_tag, 'distance': 0.25} for _ in range(3)]
+        if with_seq:
+            for seq, interval in enumerate(intervals, start=1):
+                interval['seq'] = seq
+
+        response = _post_batch(api_key, {'device_id': device.name, 'intervals': intervals})
+
+        data = response.json()
+        assert data['processed'] == 1
+        if with_seq:
+            # Confirmed up to seq 1, the device sends the other two again
+            assert response.status_code == 200
+            assert data['last_seq'] == 1
+        else:
+            # A 2xx would make the device confirm the two unbooked intervals
+            assert response.status_code == 503
+            assert 'last_seq' not in data
+        cyclist.refresh_from_db()
+        assert cyclist.distance_total == distance_before + Decimal('0.25')
+
+    @pytest.mark.parametrize('bad_interval', [
+        {'seq': 2, 'id_tag': 'x', 'distance': None},
+        {'seq': 2, 'id_tag': 'x', 'distance': 'NaN'},
+        'not-an-interval',
+    ])
+    def test_bad_interval_rejects_batch_before_booking(self, api_key, complete_test_scenario, bad_interval):
+        cyclist = complete_test_scenario['cyclist']
+        device = complete_test_scenario['device']
+        distance_before = cyclist.distance_total
+
+        response = _post_batch(api_key, {
+            'device_id': device.name,
+            'intervals': [
+                {'seq': 1, 'id_tag': cyclist.id_tag, 'distance': 0.25},
+                bad_interval,
+            ],
+        })
+
+        # Nothing booked, so the device can resend or drop the batch without double counting
+        assert response.status_code == 400
+        cyclist.refresh_from_db()
+        assert cyclist.distance_total == distance_before
+
+    def test_rejects_invalid_key_and_body(self, api_key, complete_test_scenario):
+        device = complete_test_scenario['device']
+        body = {'device_id': device.name, 'intervals': [{'id_tag': 'x', 'distance': 0.1}]}
+
+        assert _post_batch('wrong-key', body).status_code == 403
+        assert _post_batch(api_key, {'device_id': device.name, 'intervals': []}).status_code == 400
+        assert _post_batch(api_key, {'device_id': 'unknown-device', 'intervals': body['intervals']}).status_code in (400, 403)
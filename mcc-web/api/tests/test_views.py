@@ -166,6 +166,51 @@ class TestUpdateDataView:
         data = response.json()
         assert data.get('skipped') is True
 
+    def test_update_data_sends_upload_interval_hint(self, api_key, complete_test_scenario, settings):
+        """The suggested upload interval is only sent when configured."""
+        scenario = complete_test_scenario
+        body = json.dumps({
+            'id_tag': scenario['cyclist'].id_tag,
+            'device_id': scenario['device'].name,
+            'distance': '0.5'
+        })
+        url = reverse('update_data')
+
+        settings.MCC_DEVICE_UPLOAD_INTERVAL_HINT = 0
+        response = Client().post(url, data=body, content_type='application/json', HTTP_X_API_KEY=api_key)
+        assert response.status_code == 200
+        assert 'upload_interval_seconds' not in response.json()
+
+        settings.MCC_DEVICE_UPLOAD_INTERVAL_HINT = 120
+        response = Client().post(url, data=body, content_type='application/json', HTTP_X_API_KEY=api_key)
+        assert response.status_code == 200
+        assert response.json()['upload_interval_seconds'] == 120
+
+    def test_update_data_locked_database_sends_retry_after(self, api_key, complete_test_scenario, monkeypatch):
+        """A locked database answers 503 with Retry-After, so devices back off instead of retrying at once."""
+        from django.db.utils import OperationalError
+        import api.views
+
+        def locked(*args, **kwargs):
+            raise OperationalError('database is locked')
+
+        monkeypatch.setattr(api.views, '_process_update_with_retry', locked)
+        scenario = complete_test_scenario
+        response = Client().post(
+            reverse('update_data'),
+            data=json.dumps({
+                'id_tag': scenario['cyclist'].id_tag,
+                'device_id': scenario['device'].name,
+                'distance': '0.5'
+            }),
+            content_type='application/json',
+            HTTP_X_API_KEY=api_key
+        )
+
+        assert response.status_code == 503
+        assert response['Retry-After'] == '5'
+        assert response.json()['retry_after'] == 5
+
 
 @pytest.mark.unit
 @pytest.mark.django_db
@@ -191,6 +236,22 @@ class TestGetUserIdView:
         assert response.status_code == 200
         data = response.json()
         assert data['user_id'] == cyclist.user_id
+        assert data['cache_ttl'] == 3600
+
+    def test_get_user_id_cache_ttl_setting(self, api_key, cyclist_with_group, settings):
+        """cache_ttl follows MCC_DEVICE_TAG_CACHE_TTL, 0 disables caching on the device."""
+        settings.MCC_DEVICE_TAG_CACHE_TTL = 0
+        cyclist = cyclist_with_group['cyclist']
+
+        response = Client().post(
+            reverse('get_user_id'),
+            data=json.dumps({'id_tag': cyclist.id_tag}),
+            content_type='application/json',
+            HTTP_X_API_KEY=api_key
+        )
+
+        assert response.status_code == 200
+        assert response.json()['cache_ttl'] == 0
     
     def test_get_user_id_not_found(self, api_key):
         """Test get_user_id with non-existent id_tag."""
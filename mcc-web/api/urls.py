@@ -11,6 +11,7 @@ from . import views
 
 urlpatterns = [
     path('update-data', views.update_data, name='update_data'),
+    path('update-data-batch', views.update_data_batch, name='update_data_batch'),
     path('get-user-id', views.get_user_id, name='get_user_id'),
     path('get-mapped-minecraft-players', views.get_mapped_minecraft_players, name='get_mapped_minecraft_players'),
     path('get-mapped-minecraft-cyclists', views.get_mapped_minecraft_cyclists, name='get_mapped_minecraft_cyclists'),
@@ -52,4 +53,9 @@ urlpatterns = [
     path('device/firmware/download', views.device_firmware_download, name='device_firmware_download'),
     path('device/firmware/info', views.device_firmware_info, name='device_firmware_info'),
     path('device/heartbeat', views.device_heartbeat, name='device_heartbeat'),
+    path('device/sync', views.device_sync, name='device_sync'),
+    
+    # MQTT broker authentication (HTTP auth backend)
+    path('mqtt/auth/user', views.mqtt_auth_user, name='mqtt_auth_user'),
+    path('mqtt/auth/acl', views.mqtt_auth_acl, name='mqtt_auth_acl'),
 ]
\ No newline at end of file
@@ -10,8 +10,9 @@ import json
 import logging
 import requests
 import time
+import zlib
 from typing import Dict, Optional
-from django.http import JsonResponse, Http404, HttpRequest, FileResponse
+from django.http import JsonResponse, Http404, HttpRequest, HttpResponse, FileResponse
 from ipaddress import ip_address
 from django.views.decorators.csrf import csrf_exempt
 from django.db import transaction
@@ -46,7 +47,7 @@ from kiosk.models import KioskDevice
 from django.shortcuts import get_object_or_404
 from django.db.models import Q, Sum
 from django.db.models.functions import TruncDate, TruncHour
-from decimal import Decimal, ROUND_FLOOR
+from decimal import Decimal, InvalidOperation, ROUND_FLOOR
 from datetime import timedelta, datetime
 from functools import wraps
 from config.logger_utils import get_logger
@@ -164,7 +165,19 @@ def get_client_ip(request: HttpRequest) -> str | None:
 
 def validate_device_api_key(request: HttpRequest, device_id: str = None) -> tuple[bool, Device | None, DeviceConfiguration | None]:
     """
-    Validate API key for device-specific endpoints.
+    Validate the X-Api-Key header for device-specific endpoints.
+    
+    See validate_device_key() for the accepted keys.
+    
+    Returns:
+        (is_valid, device, config) tuple
+    """
+    return validate_device_key(request.headers.get('X-Api-Key'), device_id)
+
+
+def validate_device_key(api_key_header: str | None, device_id: str = None) -> tuple[bool, Device | None, DeviceConfiguration | None]:
+    """
+    Validate a device API key (HTTP header or MQTT broker password).
     
     Validates in this order:
     1. Device-specific API key (current key)
@@ -175,7 +188,6 @@ def validate_device_api_key(request: HttpRequest, device_id: str = None) -> tupl
     Returns:
         (is_valid, device, config) tuple
     """
-    api_key_header = request.headers.get('X-Api-Key')
     if not api_key_header:
         logger.warning(f"[validate_device_api_key] API key validation failed: No API key provided (device_id: {device_id})")
         return False, None, None
@@ -610,17 +622,36 @@ def update_data(request):
                 f"[update_data] Database locked after all retries for id_tag: {id_tag}, "
                 f"device_id: {device_id}. Request could not be processed."
             )
-            return JsonResponse({
-                "error": _("Datenbank temporär nicht verfügbar"),
-                "message": _("Bitte versuchen Sie es später erneut"),
-                "retry_after": 5
-            }, status=503)
+            return _upload_retry_later_response()
         else:
             # Other OperationalError, re-raise as 500
             logger.error(f"[update_data] Database error: {e}", exc_info=True)
             raise
 
 
+UPLOAD_RETRY_AFTER_SECONDS = 5
+
+
+def _upload_retry_later_response(**extra) -> JsonResponse:
+    """503 of an upload while the database is locked; the device journals the data and retries after Retry-After."""
+    response = JsonResponse({
+        "error": _("Datenbank temporär nicht verfügbar"),
+        "message": _("Bitte versuchen Sie es später erneut"),
+        "retry_after": UPLOAD_RETRY_AFTER_SECONDS,
+        **extra
+    }, status=503)
+    response['Retry-After'] = str(UPLOAD_RETRY_AFTER_SECONDS)
+    return response
+
+
+def _add_upload_interval_hint(response_payload: dict) -> dict:
+    """Adds the server-suggested upload interval (MCC_DEVICE_UPLOAD_INTERVAL_HINT) to an upload response."""
+    hint = getattr(settings, 'MCC_DEVICE_UPLOAD_INTERVAL_HINT', 0)
+    if hint > 0:
+        response_payload["upload_interval_seconds"] = hint
+    return response_payload
+
+
 @retry_on_db_lock(max_retries=10, base_delay=0.05, max_delay=5.0)
 def _process_update_with_retry(cyclist_obj, device_obj, distance_delta, id_tag, device_id):
     """
@@ -834,7 +865,107 @@ def _process_update_with_retry(cyclist_obj, device_obj, distance_delta, id_tag,
         )
     except CyclistDeviceCurrentMileage.DoesNotExist:
         response_payload.update(build_device_display_api_payload(device_obj))
-    return JsonResponse(response_payload)
+    return JsonResponse(_add_upload_interval_hint(response_payload))
+
+@csrf_exempt
+def update_data_batch(request):
+    """
+    Processes several intervals of one device in order (ride journal replay, multi-bike stations).
+
+    Each interval is handled like an update-data request. Intervals of unknown
+    cyclists or with collection disabled are acknowledged without effect, just
+    as the device drops them after a single upload. Never answers 404: the
+    firmware takes that as "endpoint missing" and falls back to single uploads.
+
+    Response: {"success": true, "processed": n, "last_seq": N} plus the display
+    fields of the rider of the last interval; last_seq only if intervals carried one.
+    A locked database before the first ack answers 503 (with "processed"), so the
+    device confirms nothing it cannot tell apart from the unbooked rest.
+    """
+    if request.method != 'POST':
+        return JsonResponse({"error": _("Nur POST erlaubt")}, status=405)
+    try:
+        data = json.loads(request.body) if request.body else {}
+    except json.JSONDecodeError as e:
+        logger.error(f"[update_data_batch] JSON decode error: {str(e)}")
+        return JsonResponse({"error": _("Ungültiges JSON-Format"), "details": str(e)}, status=400)
+
+    device_id = data.get('device_id') if isinstance(data, dict) else None
+    intervals = data.get('intervals') if isinstance(data, dict) else None
+    if not device_id:
+        return JsonResponse({"error": _("device_id fehlt")}, status=400)
+    if not isinstance(intervals, list) or not intervals:
+        return JsonResponse({"error": _("intervals fehlt")}, status=400)
+
+    is_valid, _device_from_key, _config = validate_device_api_key(request, device_id)
+    if not is_valid:
+        logger.warning(f"[update_data_batch] Invalid API key for device {device_id}")
+        return JsonResponse({"error": _("Ungültiger API-Key")}, status=403)
+    try:
+        device_obj = Device.objects.get(name__iexact=device_id)
+    except Device.DoesNotExist:
+        logger.warning(f"[update_data_batch] Device not found: device_id={device_id}")
+        return JsonResponse({"error": _("Gerät nicht gefunden"), "device_id": device_id}, status=400)
+
+    from api.services.device_display import handle_boot_reason
+    handle_boot_reason(device_obj, data.get('boot_reason'))
+
+    # Validate all intervals first: a 400 after some intervals were booked would make
+    # the device send the whole batch again and count them twice
+    parsed_intervals = []
+    for interval in intervals:
+        if not isinstance(interval, dict):
+            return JsonResponse({"error": _("Ungültiges Intervall")}, status=400)
+        id_tag = interval.get('id_tag')
+        try:
+            distance_delta = Decimal(str(interval.get('distance', 0)))
+        except InvalidOperation:
+            distance_delta = None
+        if distance_delta is None or not distance_delta.is_finite():
+            return JsonResponse({"error": _("Ungültige Distanz"), "id_tag": id_tag}, status=400)
+        parsed_intervals.append((interval, id_tag, distance_delta))
+
+    last_seq = None
+    processed = 0
+    last_response = None
+    for interval, id_tag, distance_delta in parsed_intervals:
+        cyclist_obj = Cyclist.objects.filter(id_tag__iexact=id_tag).first() if id_tag else None
+        if cyclist_obj is None:
+            logger.warning(f"[update_data_batch] Cyclist not found, interval skipped: id_tag={id_tag}")
+        elif cyclist_obj.is_km_collection_enabled and device_obj.is_km_collection_enabled:
+            try:
+                last_response = _process_update_with_retry(cyclist_obj, device_obj, distance_delta, id_tag, device_id)
+            except OperationalError as e:
+                if 'locked' not in str(e).lower():
+                    logger.error(f"[update_data_batch] Database error: {e}", exc_info=True)
+                    raise
+                logger.error(f"[update_data_batch] Database locked after all retries, {processed} interval(s) processed")
+                if last_seq is None:
+                    # Without an ack the device cannot tell the booked intervals apart: none may be confirmed
+                    return _upload_retry_later_response(processed=processed)
+                # The device confirms up to last_seq and sends the rest again
+                break
+            processed += 1
+        if 'seq' in interval:
+            last_seq = interval['seq']
+
+    response_payload = {}
+    if last_response is not None:
+        response_payload.update(json.loads(last_response.content))
+    else:
+        from api.services.device_display import (
+            build_device_display_api_payload,
+            get_active_session_for_device,
+        )
+        response_payload.update(
+            build_device_display_api_payload(device_obj, get_active_session_for_device(device_obj))
+        )
+    response_payload["success"] = True
+    response_payload["processed"] = processed
+    if last_seq is not None:
+        response_payload["last_seq"] = last_seq
+    logger.info(f"[update_data_batch] Processed {processed}/{len(intervals)} interval(s) for device {device_id}")
+    return JsonResponse(_add_upload_interval_hint(response_payload))
 
 def get_mapped_minecraft_players(request):
     """Returns the complete player mapping structure."""
@@ -907,22 +1038,12 @@ def get_user_id(request):
                 status=400,
             )
 
-        default_tag = ''
-        try:
-            default_tag = (device_obj.configuration.default_id_tag or '').strip()
-        except DeviceConfiguration.DoesNotExist:
-            default_tag = ''
-
-        default_user_id = 'NULL'
-        if default_tag:
-            try:
-                default_cyclist = Cyclist.objects.get(id_tag__iexact=default_tag)
-                if default_cyclist.user_id:
-                    default_user_id = default_cyclist.user_id
-            except Cyclist.DoesNotExist:
-                pass
+        from api.services.device_session import (
+            end_device_session_for_device,
+            operator_reset_defaults,
+        )
 
-        from api.services.device_session import end_device_session_for_device
+        default_tag, default_user_id = operator_reset_defaults(device_obj)
 
         active = (
             CyclistDeviceCurrentMileage.objects.filter(device=device_obj)
@@ -961,14 +1082,16 @@ def get_user_id(request):
             'default_user_id': default_user_id,
         })
 
-    return_user_id = "NULL"
-    if cyclist_obj.user_id:
-        return_user_id = cyclist_obj.user_id
-        logger.info(f"[get_user_id] ID tag '{id_tag}' found, assigned to user_id: '{return_user_id}'")
-    else:
+    if not cyclist_obj.user_id:
         logger.info(f"[get_user_id] ID tag '{id_tag}' found but has no user_id assigned")
+        return JsonResponse({"user_id": "NULL"})
 
-    return JsonResponse({"user_id": return_user_id})
+    logger.info(f"[get_user_id] ID tag '{id_tag}' found, assigned to user_id: '{cyclist_obj.user_id}'")
+    # Devices keep the name for cache_ttl seconds and start counting right after the next tap
+    return JsonResponse({
+        "user_id": cyclist_obj.user_id,
+        "cache_ttl": max(0, getattr(settings, 'MCC_DEVICE_TAG_CACHE_TTL', 3600)),
+    })
 
 # --- NEW: Live Map Logic ---
 
@@ -2350,6 +2473,134 @@ def get_statistics(request):
 
 # --- DEVICE MANAGEMENT API ENDPOINTS ---
 
+def _process_config_report(device, device_id: str, reported_config: dict):
+    """
+    Stores a configuration reported by a device and compares it with the
+    server-side configuration if the comparison was requested.
+    
+    Shared by device_config_report and device_sync.
+    
+    Returns:
+        (config, differences): the device configuration and a list of
+        {'field', 'server_value', 'device_value'} dicts
+    """
+    # Get or create device configuration
+    config, created = DeviceConfiguration.objects.get_or_create(
+        device=device,
+        defaults={
+            'device_name': reported_config.get('device_name', ''),
+            'default_id_tag': reported_config.get('default_id_tag', ''),
+            'send_interval_seconds': reported_config.get('send_interval_seconds', 60),
+            'server_url': reported_config.get('server_url', ''),
+            'wifi_ssid': reported_config.get('wifi_ssid', ''),
+            'wifi_password': reported_config.get('wifi_password', ''),
+            'debug_mode': reported_config.get('debug_mode', False),
+            'test_mode': reported_config.get('test_mode', False),
+            'deep_sleep_seconds': reported_config.get('deep_sleep_seconds', 0),
+            'wheel_size': reported_config.get('wheel_size', 2075.0),  # Default: 26 Zoll = 2075 mm
+            'low_power_ride': bool(reported_config.get('low_power_ride', False)),
+        }
+    )
+    
+    # Refresh from database to ensure we have the latest request_config_comparison value
+    config.refresh_from_db()
+    
+    logger.info(f"[device_config_report] Device {device_id}: request_config_comparison={config.request_config_comparison}, created={created}")
+    
+    # Only create report and compare if comparison was requested
+    differences = []
+    report = None
+    
+    if config.request_config_comparison:
+        # Create configuration report only when comparison is requested
+        report = DeviceConfigurationReport.objects.create(
+            device=device,
+            reported_config=reported_config
+        )
+        
+        # Compare configurations and detect differences
+        server_config_dict = config.to_dict()
+        
+        # Fields that should be excluded from comparison (security or device-only)
+        excluded_fields = {'device_api_key', 'wifi_password'}  # device_api_key is not sent for security, wifi_password is never sent
+        
+        for key, server_value in server_config_dict.items():
+            # Skip excluded fields
+            if key in excluded_fields:
+                continue
+                
+            device_value = reported_config.get(key)
+            
+            # Special handling for wheel_size: compare with 1mm tolerance
+            if key == 'wheel_size':
+                try:
+                    server_float = float(server_value) if server_value is not None else 0.0
+                    device_float = float(device_value) if device_value is not None else 0.0
+                    # Compare with 1mm tolerance
+                    if abs(server_float - device_float) > 1.0:
+                        diff_info = {
+                            'field': key,
+                            'server_value': str(server_value) if server_value is not None else '',
+                            'device_value': str(device_value) if device_value is not None else ''
+                        }
+                        differences.append(diff_info)
+                        
+                        # Create diff record
+                        DeviceConfigurationDiff.objects.create(
+                            device=device,
+                            report=report,
+                            field_name=key,
+                            server_value=str(server_float),
+                            device_value=str(device_float),
+                            is_resolved=False
+                        )
+                    # If within tolerance, no difference
+                    continue
+                except (ValueError, TypeError):
+                    # If conversion fails, fall through to string comparison
+                    pass
+            
+            # Convert to strings for comparison (default for other fields)
+            server_str = str(server_value) if server_value is not None else ''
+            device_str = str(device_value) if device_value is not None else ''
+            
+            if server_str != device_str:
+                diff_info = {
+                    'field': key,
+                    'server_value': str(server_value) if server_value is not None else '',
+                    'device_value': str(device_value) if device_value is not None else ''
+                }
+                differences.append(diff_info)
+                
+                # Create diff record
+                DeviceConfigurationDiff.objects.create(
+                    device=device,
+                    report=report,
+                    field_name=key,
+                    server_value=server_str,
+                    device_value=device_str,
+                    is_resolved=False
+                )
+        
+        report.has_differences = len(differences) > 0
+        report.save()
+        
+        logger.info(f"[device_config_report] Config comparison completed for device {device_id}. Found {len(differences)} differences. Report ID: {report.id}")
+        
+        # Reset the flag after comparison
+        config.request_config_comparison = False
+        # Save immediately with update_fields to ensure the flag is persisted
+        config.save(update_fields=['request_config_comparison', 'last_synced_at'])
+        logger.info(f"[device_config_report] Flag request_config_comparison reset to False for device {device_id}")
+    else:
+        logger.info(f"[device_config_report] No comparison requested for device {device_id}. Skipping report creation.")
+        # Update last_synced_at (always, even without comparison)
+        config.last_synced_at = timezone.now()
+        config.save(update_fields=['last_synced_at'])
+    
+    return config, differences
+
+
 @csrf_exempt
 def device_config_report(request: HttpRequest) -> JsonResponse:
     """
@@ -2390,118 +2641,7 @@ def device_config_report(request: HttpRequest) -> JsonResponse:
             except Device.DoesNotExist:
                 return JsonResponse({"error": _("Gerät nicht gefunden")}, status=404)
         
-        # Get or create device configuration
-        config, created = DeviceConfiguration.objects.get_or_create(
-            device=device,
-            defaults={
-                'device_name': reported_config.get('device_name', ''),
-                'default_id_tag': reported_config.get('default_id_tag', ''),
-                'send_interval_seconds': reported_config.get('send_interval_seconds', 60),
-                'server_url': reported_config.get('server_url', ''),
-                'wifi_ssid': reported_config.get('wifi_ssid', ''),
-                'wifi_password': reported_config.get('wifi_password', ''),
-                'debug_mode': reported_config.get('debug_mode', False),
-                'test_mode': reported_config.get('test_mode', False),
-                'deep_sleep_seconds': reported_config.get('deep_sleep_seconds', 0),
-                'wheel_size': reported_config.get('wheel_size', 2075.0),  # Default: 26 Zoll = 2075 mm
-            }
-        )
-        
-        # Refresh from database to ensure we have the latest request_config_comparison value
-        config.refresh_from_db()
-        
-        logger.info(f"[device_config_report] Device {device_id}: request_config_comparison={config.request_config_comparison}, created={created}")
-        
-        # Only create report and compare if comparison was requested
-        differences = []
-        report = None
-        
-        if config.request_config_comparison:
-            # Create configuration report only when comparison is requested
-            report = DeviceConfigurationReport.objects.create(
-                device=device,
-                reported_config=reported_config
-            )
-            
-            # Compare configurations and detect differences
-            server_config_dict = config.to_dict()
-            
-            # Fields that should be excluded from comparison (security or device-only)
-            excluded_fields = {'device_api_key', 'wifi_password'}  # device_api_key is not sent for security, wifi_password is never sent
-            
-            for key, server_value in server_config_dict.items():
-                # Skip excluded fields
-                if key in excluded_fields:
-                    continue
-                    
-                device_value = reported_config.get(key)
-                
-                # Special handling for wheel_size: compare with 1mm tolerance
-                if key == 'wheel_size':
-                    try:
-                        server_float = float(server_value) if server_value is not None else 0.0
-                        device_float = float(device_value) if device_value is not None else 0.0
-                        # Compare with 1mm tolerance
-                        if abs(server_float - device_float) > 1.0:
-                            diff_info = {
-                                'field': key,
-                                'server_value': str(server_value) if server_value is not None else '',
-                                'device_value': str(device_value) if device_value is not None else ''
-                            }
-                            differences.append(diff_info)
-                            
-                            # Create diff record
-                            DeviceConfigurationDiff.objects.create(
-                                device=device,
-                                report=report,
-                                field_name=key,
-                                server_value=str(server_float),
-                                device_value=str(device_float),
-                                is_resolved=False
-                            )
-                        # If within tolerance, no difference
-                        continue
-                    except (ValueError, TypeError):
-                        # If conversion fails, fall through to string comparison
-                        pass
-                
-                # Convert to strings for comparison (default for other fields)
-                server_str = str(server_value) if server_value is not None else ''
-                device_str = str(device_value) if device_value is not None else ''
-                
-                if server_str != device_str:
-                    diff_info = {
-                        'field': key,
-                        'server_value': str(server_value) if server_value is not None else '',
-                        'device_value': str(device_value) if device_value is not None else ''
-                    }
-                    differences.append(diff_info)
-                    
-                    # Create diff record
-                    DeviceConfigurationDiff.objects.create(
-                        device=device,
-                        report=report,
-                        field_name=key,
-                        server_value=server_str,
-                        device_value=device_str,
-                        is_resolved=False
-                    )
-            
-            report.has_differences = len(differences) > 0
-            report.save()
-            
-            logger.info(f"[device_config_report] Config comparison completed for device {device_id}. Found {len(differences)} differences. Report ID: {report.id}")
-            
-            # Reset the flag after comparison
-            config.request_config_comparison = False
-            # Save immediately with update_fields to ensure the flag is persisted
-            config.save(update_fields=['request_config_comparison', 'last_synced_at'])
-            logger.info(f"[device_config_report] Flag request_config_comparison reset to False for device {device_id}")
-        else:
-            logger.info(f"[device_config_report] No comparison requested for device {device_id}. Skipping report creation.")
-            # Update last_synced_at (always, even without comparison)
-            config.last_synced_at = timezone.now()
-            config.save(update_fields=['last_synced_at'])
+        config, differences = _process_config_report(device, device_id, reported_config)
         
         # Update device last_active and health
         device.last_active = timezone.now()
@@ -2548,12 +2688,93 @@ def device_config_report(request: HttpRequest) -> JsonResponse:
         return JsonResponse({"error": _("Interner Serverfehler"), "details": str(e)}, status=500)
 
 
+def _default_device_config() -> dict:
+    """Configuration sent to devices without a server-side DeviceConfiguration."""
+    return {
+        # Note: device_name is NOT included - it's only configurable via device WebGUI
+        # This ensures the device can always send data even if server config is missing
+        'default_id_tag': '',
+        'send_interval_seconds': 60,
+        'server_url': '',
+        'wifi_ssid': '',
+        'wifi_password': '',
+        'ap_password': '',
+        'debug_mode': False,
+        'test_mode': False,
+        'test_distance_km': 0.01,
+        'test_interval_seconds': 5,
+        'deep_sleep_seconds': 0,
+        'wheel_size': 2075.0,  # Default: 26 Zoll = 2075 mm
+        'config_fetch_interval_seconds': 3600,
+        'low_power_ride': False,
+        'trace_max_bytes': 0,
+        'trace_interval_seconds': 0,
+    }
+
+
+def _config_hash(config_dict: dict) -> int:
+    """
+    Hash of a configuration dict as sent to the device (never 0).
+    
+    The device returns it with the next sync; the configuration is only
+    sent again when it changed.
+    """
+    serialized = json.dumps(config_dict, sort_keys=True, separators=(',', ':'), default=str)
+    return (zlib.crc32(serialized.encode('utf-8')) & 0xFFFFFFFF) or 1
+
+
+BOOT_TIMELINE_MAX_STAGES = 32
+
+
+def _boot_timeline(data: dict) -> Optional[dict]:
+    """
+    Boot timeline of the first heartbeat or sync after a start: stage name ->
+    end of the stage in microseconds since application start. Kept in the
+    audit log entry; anything that is not a plain integer is dropped.
+    """
+    timeline = data.get('boot_timeline')
+    if not isinstance(timeline, dict):
+        return None
+    stages = {}
+    for name, value in list(timeline.items())[:BOOT_TIMELINE_MAX_STAGES]:
+        if isinstance(value, int) and not isinstance(value, bool) and value >= 0:
+            stages[str(name)[:32]] = value
+    return stages or None
+
+
+def _config_fetch_response(request: HttpRequest, config_dict: dict, extra: Optional[dict] = None) -> HttpResponse:
+    """
+    Config fetch response with the config_hash as ETag; 304 Not Modified if
+    the device already has this configuration (If-None-Match).
+    """
+    config_hash = _config_hash(config_dict)
+    etag = f'"{config_hash}"'
+    if_none_match = request.headers.get('If-None-Match', '')
+    if etag in [tag.strip() for tag in if_none_match.split(',')]:
+        response = HttpResponse(status=304)
+    else:
+        response_data = {
+            "success": True,
+            "config": config_dict,
+            "config_hash": config_hash,
+        }
+        if extra:
+            response_data.update(extra)
+        response = JsonResponse(response_data)
+    response['ETag'] = etag
+    return response
+
+
 @csrf_exempt
 def device_config_fetch(request: HttpRequest) -> JsonResponse:
     """
     Endpoint for devices to fetch their server-side configuration.
     
     GET /api/device/config/fetch?device_id=device_name
+    
+    The response carries the config_hash as ETag. A device that sends it
+    back as If-None-Match gets a 304 without body while the configuration
+    is unchanged.
     """
     try:
         device_id = request.GET.get('device_id')
@@ -2578,32 +2799,14 @@ def device_config_fetch(request: HttpRequest) -> JsonResponse:
             config = device.configuration
         except DeviceConfiguration.DoesNotExist:
             # Return default configuration
-            default_config = {
-                # Note: device_name is NOT included - it's only configurable via device WebGUI
-                # This ensures the device can always send data even if server config is missing
-                'default_id_tag': '',
-                'send_interval_seconds': 60,
-                'server_url': '',
-                'wifi_ssid': '',
-                'wifi_password': '',
-                'ap_password': '',
-                'debug_mode': False,
-                'test_mode': False,
-                'test_distance_km': 0.01,
-                'test_interval_seconds': 5,
-                'deep_sleep_seconds': 0,
-                'wheel_size': 2075.0,  # Default: 26 Zoll = 2075 mm
-                'config_fetch_interval_seconds': 3600,
-            }
-            return JsonResponse({
-                "success": True,
-                "config": default_config,
+            default_config = _default_device_config()
+            return _config_fetch_response(request, default_config, {
                 "message": _("Verwende Standard-Konfiguration")
             })
         
-        # Update last_synced_at
+        # Update last_synced_at (only this field: a full save would push the config over MQTT)
         config.last_synced_at = timezone.now()
-        config.save()
+        config.save(update_fields=['last_synced_at'])
         
         # Update device last_active and health
         device.last_active = timezone.now()
@@ -2615,10 +2818,7 @@ def device_config_fetch(request: HttpRequest) -> JsonResponse:
         
         logger.info(f"[device_config_fetch] Device {device_id} fetched configuration")
         
-        return JsonResponse({
-            "success": True,
-            "config": config.to_dict()
-        })
+        return _config_fetch_response(request, config.to_dict())
         
     except Exception as e:
         logger.error(f"[device_config_fetch] Error: {str(e)}", exc_info=True)
@@ -2631,6 +2831,9 @@ def device_firmware_download(request: HttpRequest) -> JsonResponse:
     Endpoint for devices to download their assigned firmware.
     
     GET /api/device/firmware/download?device_id=device_name
+
+    Supports a single "Range: bytes=<start>-" header, so a device can resume
+    an interrupted download (206 Partial Content).
     """
     try:
         device_id = request.GET.get('device_id')
@@ -2699,18 +2902,39 @@ def device_firmware_download(request: HttpRequest) -> JsonResponse:
                 f"[device_firmware_download] File size mismatch: stored={stored_file_size}, actual={actual_file_size}"
             )
         
+        # Resume support: only "bytes=<start>-" is needed by the firmware
+        range_start = 0
+        range_header = request.META.get('HTTP_RANGE', '')
+        if range_header.startswith('bytes=') and range_header.endswith('-'):
+            try:
+                range_start = int(range_header[len('bytes='):-1])
+            except ValueError:
+                range_start = 0
+            if range_start < 0 or range_start >= actual_file_size:
+                response = HttpResponse(status=416)
+                response['Content-Range'] = f'bytes */{actual_file_size}'
+                return response
+            if range_start > 0:
+                logger.info(f"[device_firmware_download] Device {device_id} resumes at byte {range_start}")
+        
         # Return file response
         try:
             file_handle = open(file_path, 'rb')
+            file_handle.seek(range_start)
             response = FileResponse(
                 file_handle,
-                content_type='application/octet-stream'
+                content_type='application/octet-stream',
+                status=206 if range_start > 0 else 200
             )
             response['Content-Disposition'] = f'attachment; filename="{firmware.version}.bin"'
             response['X-Firmware-Version'] = firmware.version
             response['X-Firmware-Checksum'] = firmware.checksum_md5 or ''
+            response['X-Firmware-Checksum-SHA256'] = firmware.checksum_sha256 or ''
             response['X-Firmware-Size'] = str(actual_file_size)
-            response['Content-Length'] = str(actual_file_size)
+            response['Accept-Ranges'] = 'bytes'
+            response['Content-Length'] = str(actual_file_size - range_start)
+            if range_start > 0:
+                response['Content-Range'] = f'bytes {range_start}-{actual_file_size - 1}/{actual_file_size}'
             
             return response
         except Exception as e:
@@ -2722,6 +2946,58 @@ def device_firmware_download(request: HttpRequest) -> JsonResponse:
         return JsonResponse({"error": _("Interner Serverfehler"), "details": str(e)}, status=500)
 
 
+def _firmware_update_info(device, device_id: str, current_version: str) -> dict:
+    """
+    Firmware update information for a device, as returned by
+    device_firmware_info and in the "firmware" object of device_sync.
+    """
+    # Get device configuration and assigned firmware
+    try:
+        config = device.configuration
+        firmware = config.assigned_firmware
+    except DeviceConfiguration.DoesNotExist:
+        return {
+            "success": True,
+            "update_available": False,
+            "message": _("Keine Firmware zugewiesen")
+        }
+    except AttributeError:
+        return {
+            "success": True,
+            "update_available": False,
+            "message": _("Keine Firmware zugewiesen")
+        }
+    
+    if not firmware or not firmware.is_active:
+        return {
+            "success": True,
+            "update_available": False,
+            "message": _("Keine aktive Firmware zugewiesen")
+        }
+    
+    # Check if update is needed
+    update_available = firmware.version != current_version
+    
+    response_data = {
+        "success": True,
+        "update_available": update_available,
+        "current_version": current_version,
+        "available_version": firmware.version,
+        "firmware_name": firmware.name,
+        "file_size": firmware.file_size,
+        "checksum_md5": firmware.checksum_md5,
+        "checksum_sha256": firmware.checksum_sha256,
+        "download_url": f"/api/device/firmware/download?device_id={device_id}"
+    }
+    
+    if update_available:
+        response_data["message"] = _("Firmware-Update verfügbar")
+    else:
+        response_data["message"] = _("Gerät ist auf dem neuesten Stand")
+    
+    return response_data
+
+
 @csrf_exempt
 def device_firmware_info(request: HttpRequest) -> JsonResponse:
     """
@@ -2749,48 +3025,8 @@ def device_firmware_info(request: HttpRequest) -> JsonResponse:
             except Device.DoesNotExist:
                 return JsonResponse({"error": _("Gerät nicht gefunden")}, status=404)
         
-        # Get device configuration and assigned firmware
-        try:
-            config = device.configuration
-            firmware = config.assigned_firmware
-        except DeviceConfiguration.DoesNotExist:
-            return JsonResponse({
-                "success": True,
-                "update_available": False,
-                "message": _("Keine Firmware zugewiesen")
-            })
-        except AttributeError:
-            return JsonResponse({
-                "success": True,
-                "update_available": False,
-                "message": _("Keine Firmware zugewiesen")
-            })
-        
-        if not firmware or not firmware.is_active:
-            return JsonResponse({
-                "success": True,
-                "update_available": False,
-                "message": _("Keine aktive Firmware zugewiesen")
-            })
-        
-        # Check if update is needed
-        update_available = firmware.version != current_version
-        
-        response_data = {
-            "success": True,
-            "update_available": update_available,
-            "current_version": current_version,
-            "available_version": firmware.version,
-            "firmware_name": firmware.name,
-            "file_size": firmware.file_size,
-            "checksum_md5": firmware.checksum_md5,
-            "download_url": f"/api/device/firmware/download?device_id={device_id}"
-        }
-        
-        if update_available:
-            response_data["message"] = _("Firmware-Update verfügbar")
-        else:
-            response_data["message"] = _("Gerät ist auf dem neuesten Stand")
+        response_data = _firmware_update_info(device, device_id, current_version)
+        update_available = response_data["update_available"]
         
         logger.info(f"[device_firmware_info] Device {device_id} checked firmware. Update available: {update_available}")
         
@@ -2808,6 +3044,7 @@ def device_heartbeat(request: HttpRequest) -> JsonResponse:
     
     POST /api/device/heartbeat
     Expected JSON: {"device_id": "device_name"}
+    Optional: "boot_reason"; "boot_timeline" (stage -> µs since start) with the first heartbeat after a boot
     """
     try:
         if request.method != 'POST':
@@ -2849,10 +3086,12 @@ def device_heartbeat(request: HttpRequest) -> JsonResponse:
         handle_boot_reason(device, boot_reason)
         
         # Create audit log entry
+        boot_timeline = _boot_timeline(data)
         DeviceAuditLog.objects.create(
             device=device,
             action='heartbeat_received',
-            ip_address=get_client_ip(request)
+            ip_address=get_client_ip(request),
+            details={'boot_reason': boot_reason, 'boot_timeline': boot_timeline} if boot_timeline else None
         )
         
         logger.debug(f"[device_heartbeat] Device {device_id} sent heartbeat")
@@ -2879,6 +3118,136 @@ def device_heartbeat(request: HttpRequest) -> JsonResponse:
         return JsonResponse({"error": "Interner Serverfehler", "details": str(e)}, status=500)
 
 
+@csrf_exempt
+def device_sync(request: HttpRequest) -> JsonResponse:
+    """
+    Single round trip after a device connected: heartbeat, optional config
+    report, config delta, firmware availability and display Velos.
+    
+    Replaces config/report, config/fetch, firmware/info and heartbeat for
+    devices that support it; the separate endpoints stay for older firmware.
+    
+    POST /api/device/sync
+    Expected JSON:
+    {
+        "device_id": "device_name",
+        "firmware_version": "1.0.0",
+        "config_hash": 123456,      # config_hash from the last sync (0 = none)
+        "boot_reason": "...",       # optional, as for heartbeat
+        "boot_timeline": {...},     # optional, stage -> µs since start (first sync after boot)
+        "config_report": {...}      # optional, same content as "config" of config/report
+    }
+    
+    The response contains "config" and "config_hash" only if the server-side
+    configuration no longer matches config_hash.
+    """
+    try:
+        if request.method != 'POST':
+            return JsonResponse({"error": _("Methode nicht erlaubt")}, status=405)
+        
+        data = json.loads(request.body) if request.body else {}
+        device_id = data.get('device_id')
+        current_version = data.get('firmware_version', '')
+        device_config_hash = data.get('config_hash') or 0
+        boot_reason = data.get('boot_reason')
+        reported_config = data.get('config_report')
+        
+        if not device_id:
+            return JsonResponse({"error": _("device_id ist erforderlich")}, status=400)
+        
+        # Validate API key (device-specific or global)
+        is_valid, device, config = validate_device_api_key(request, device_id)
+        if not is_valid:
+            logger.warning(f"[device_sync] Invalid API key for device {device_id}")
+            return JsonResponse({"error": _("Ungültiger API-Key")}, status=403)
+        
+        # If device not found from API key, try to get it by name
+        if not device:
+            try:
+                device = Device.objects.get(name=device_id)
+            except Device.DoesNotExist:
+                return JsonResponse({"error": _("Gerät nicht gefunden")}, status=404)
+        
+        response_data = {"success": True}
+        
+        if isinstance(reported_config, dict):
+            config, differences = _process_config_report(device, device_id, reported_config)
+            config.rotate_api_key_if_needed()
+            response_data["config_report"] = {
+                "has_differences": len(differences) > 0,
+                "differences": differences,
+            }
+            DeviceAuditLog.objects.create(
+                device=device,
+                action='config_synced',
+                ip_address=get_client_ip(request),
+                details={'differences_count': len(differences)}
+            )
+        
+        # Update health status
+        health, _created = DeviceHealth.objects.get_or_create(device=device)
+        health.update_heartbeat()
+        
+        # Update device last_active
+        device.last_active = timezone.now()
+        device.save()
+        
+        from api.services.device_display import (
+            build_device_display_api_payload,
+            get_active_session_for_device,
+            handle_boot_reason,
+        )
+        handle_boot_reason(device, boot_reason)
+        
+        details = {'sync': True}
+        boot_timeline = _boot_timeline(data)
+        if boot_timeline:
+            details.update(boot_reason=boot_reason, boot_timeline=boot_timeline)
+        DeviceAuditLog.objects.create(
+            device=device,
+            action='heartbeat_received',
+            ip_address=get_client_ip(request),
+            details=details
+        )
+        
+        # Config delta: only sent when the device does not have the current one
+        try:
+            config = device.configuration
+            server_config = config.to_dict()
+            config.last_synced_at = timezone.now()
+            config.save(update_fields=['last_synced_at'])
+        except DeviceConfiguration.DoesNotExist:
+            server_config = _default_device_config()
+        
+        server_config_hash = _config_hash(server_config)
+        config_changed = server_config_hash != device_config_hash
+        if config_changed:
+            response_data["config"] = server_config
+            response_data["config_hash"] = server_config_hash
+        
+        response_data["firmware"] = _firmware_update_info(device, device_id, current_version)
+        response_data["status"] = health.status
+        response_data.update(
+            build_device_display_api_payload(
+                device,
+                get_active_session_for_device(device),
+            )
+        )
+        
+        logger.info(
+            f"[device_sync] Device {device_id} synced. Config sent: {config_changed}. "
+            f"Update available: {response_data['firmware']['update_available']}"
+        )
+        return JsonResponse(response_data)
+        
+    except json.JSONDecodeError as e:
+        logger.error(f"[device_sync] JSON decode error: {str(e)}")
+        return JsonResponse({"error": _("Ungültiges JSON-Format")}, status=400)
+    except Exception as e:
+        logger.error(f"[device_sync] Error: {str(e)}", exc_info=True)
+        return JsonResponse({"error": _("Interner Serverfehler"), "details": str(e)}, status=500)
+
+
 @csrf_exempt
 def redeem_milestone_reward(request: HttpRequest) -> JsonResponse:
     """
@@ -3026,4 +3395,85 @@ def get_group_rewards(request: HttpRequest) -> JsonResponse:
         'group_name': group.name,
         'rewards': rewards_data,
         'total_count': len(rewards_data)
-    })
\ No newline at end of file
+    })
+
+# --- MQTT broker authentication (HTTP auth backend, e.g. mosquitto-go-auth) ---
+
+def _mqtt_auth_params(request: HttpRequest) -> dict:
+    """Auth request fields; the backend sends them as form data or JSON."""
+    if request.content_type == 'application/json':
+        try:
+            data = json.loads(request.body or b'{}')
+            return data if isinstance(data, dict) else {}
+        except json.JSONDecodeError:
+            return {}
+    return request.POST.dict()
+
+
+def _is_mqtt_bridge_user(username: str) -> bool:
+    return bool(settings.MCC_MQTT_BRIDGE_PASSWORD) and username == settings.MCC_MQTT_BRIDGE_USERNAME
+
+
+@csrf_exempt
+def mqtt_auth_user(request: HttpRequest) -> HttpResponse:
+    """
+    Broker login check: user name = device name, password = device API key.
+    
+    POST /api/mqtt/auth/user (username, password)
+    200 allows the connection, 403 rejects it.
+    """
+    import hmac
+
+    if request.method != 'POST':
+        return HttpResponse(status=405)
+    params = _mqtt_auth_params(request)
+    username = str(params.get('username') or '')
+    password = str(params.get('password') or '')
+    if not username or not password:
+        return HttpResponse(status=403)
+
+    if _is_mqtt_bridge_user(username):
+        if hmac.compare_digest(password, settings.MCC_MQTT_BRIDGE_PASSWORD):
+            return HttpResponse(status=200)
+        logger.warning("[mqtt_auth_user] Invalid password for the bridge user")
+        return HttpResponse(status=403)
+
+    is_valid, device, _config = validate_device_key(password, username)
+    if not is_valid or device is None or device.name != username:
+        logger.warning(f"[mqtt_auth_user] Broker login rejected for {username}")
+        return HttpResponse(status=403)
+    return HttpResponse(status=200)
+
+
+@csrf_exempt
+def mqtt_auth_acl(request: HttpRequest) -> HttpResponse:
+    """
+    Broker topic check: a device may publish below mcc/<device>/up/ and
+    read or subscribe below mcc/<device>/down/; the bridge user may use all topics.
+    
+    POST /api/mqtt/auth/acl (username, topic, acc: 1 read, 2 write, 3 read/write, 4 subscribe)
+    """
+    from api.services.mqtt_push import TOPIC_PREFIX
+
+    if request.method != 'POST':
+        return HttpResponse(status=405)
+    params = _mqtt_auth_params(request)
+    username = str(params.get('username') or '')
+    topic = str(params.get('topic') or '')
+    try:
+        acc = int(params.get('acc') or 0)
+    except (TypeError, ValueError):
+        acc = 0
+    if not username or not topic:
+        return HttpResponse(status=403)
+
+    if _is_mqtt_bridge_user(username):
+        return HttpResponse(status=200)
+
+    base = f"{TOPIC_PREFIX}{username}/"
+    if acc == 2 and topic.startswith(base + 'up/'):
+        return HttpResponse(status=200)
+    if acc in (1, 4) and topic.startswith(base + 'down/'):
+        return HttpResponse(status=200)
+    logger.info(f"[mqtt_auth_acl] Denied {username} access {acc} on {topic}")
+    return HttpResponse(status=403)
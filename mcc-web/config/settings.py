@@ -409,6 +409,15 @@ MCC_KIOSK_BANNER_UPDATE_INTERVAL = config('MCC_KIOSK_BANNER_UPDATE_INTERVAL', de
 MCC_KIOSK_CONTENT_UPDATE_INTERVAL = config('MCC_KIOSK_CONTENT_UPDATE_INTERVAL', default=60, cast=int)  # Content (tiles) updates every 60 seconds (synchronized with cronjob)
 MCC_KIOSK_FOOTER_UPDATE_INTERVAL = config('MCC_KIOSK_FOOTER_UPDATE_INTERVAL', default=60, cast=int)  # Footer updates every 60 seconds (synchronized with cronjob)
 
+# Device upload backpressure: suggested upload interval in seconds, sent with every
+# update-data response (0 = devices use their configured send interval). Raise it
+# during large events to spread the load; devices never go below their own interval.
+MCC_DEVICE_UPLOAD_INTERVAL_HINT = config('MCC_DEVICE_UPLOAD_INTERVAL_HINT', default=0, cast=int)
+
+# Seconds a device may keep a resolved ID tag in its tag cache (cache_ttl in the
+# get-user-id response, 0 = devices do not cache). Lower it if tags are reassigned often.
+MCC_DEVICE_TAG_CACHE_TTL = config('MCC_DEVICE_TAG_CACHE_TTL', default=3600, cast=int)
+
 MCC_MINECRAFT_RCON_HOST = config('MCC_MINECRAFT_RCON_HOST', default='127.0.0.1')
 MCC_MINECRAFT_RCON_PORT = config('MCC_MINECRAFT_RCON_PORT', default=25575, cast=int)
 MCC_MINECRAFT_RCON_PASSWORD = config('MCC_MINECRAFT_RCON_PASSWORD', default='SECRET')
@@ -460,6 +469,12 @@ if _CHANNELS_AVAILABLE:
         },
     }
 MCC_APP_API_KEY = config('MCC_APP_API_KEY', default='MCC-APP-API-KEY-SECRET')
+# Optional MQTT transport for devices (api/services/mqtt_push.py, manage.py mqtt_bridge)
+# mqtt://host:1883 or mqtts://host:8883; empty: devices use HTTP only and nothing is pushed
+MCC_MQTT_BROKER_URL = config('MCC_MQTT_BROKER_URL', default='')
+# Broker account of the server (bridge and pushes); may read and write all mcc/# topics
+MCC_MQTT_BRIDGE_USERNAME = config('MCC_MQTT_BRIDGE_USERNAME', default='mcc-server')
+MCC_MQTT_BRIDGE_PASSWORD = config('MCC_MQTT_BRIDGE_PASSWORD', default='')
 # Must point to the location where the file actually exists (e.g., static/game/sound/)
 MCC_GAME_SOUND = BASE_DIR / 'game' / 'static' / 'game' / 'sound' / 'bonus-sound-with-bell.mp3'
 MCC_LOGO_LEFT = 'game/images/MCC-Button-v3-300x300.png'
@@ -0,0 +1,22 @@
+# Generated manually for the low-power riding mode of the firmware.
+
+from django.db import migrations, models
+
+
+class Migration(migrations.Migration):
+
+    dependencies = [
+        ('iot', '0015_device_display_velos_lock'),
+    ]
+
+    operations = [
+        migrations.AddField(
+            model_name='deviceconfiguration',
+            name='low_power_ride',
+            field=models.BooleanField(
+                default=False,
+                help_text='Light Sleep zwischen den Datenübertragungen, der ULP-Coprozessor zählt die Impulse weiter (nur ESP32, Sensor-Pin mit RTC-IO). Nicht für Stationen mit mehreren Rädern.',
+                verbose_name='Stromsparendes Fahren',
+            ),
+        ),
+    ]
@@ -0,0 +1,34 @@
+# Generated manually for the ride trace settings of the firmware.
+
+import django.core.validators
+from django.db import migrations, models
+
+
+class Migration(migrations.Migration):
+
+    dependencies = [
+        ('iot', '0016_deviceconfiguration_low_power_ride'),
+    ]
+
+    operations = [
+        migrations.AddField(
+            model_name='deviceconfiguration',
+            name='trace_max_bytes',
+            field=models.IntegerField(
+                default=0,
+                help_text='Bytes pro Datenübertragung für die Fahrtaufzeichnung (Zeitstempel jeder Radumdrehung, ca. 1 Byte pro Umdrehung). 0 = deaktiviert, maximal 512.',
+                validators=[django.core.validators.MinValueValidator(0), django.core.validators.MaxValueValidator(512)],
+                verbose_name='Fahrtaufzeichnung (Bytes)',
+            ),
+        ),
+        migrations.AddField(
+            model_name='deviceconfiguration',
+            name='trace_interval_seconds',
+            field=models.IntegerField(
+                default=0,
+                help_text='Mindestabstand in Sekunden zwischen Datenübertragungen mit Fahrtaufzeichnung. 0 = bei jeder Übertragung.',
+                validators=[django.core.validators.MinValueValidator(0)],
+                verbose_name='Fahrtaufzeichnung-Intervall (Sekunden)',
+            ),
+        ),
+    ]
@@ -226,6 +226,26 @@ class DeviceConfiguration(models.Model):
         verbose_name=_("Deep-Sleep-Zeit (Sekunden)"),
         help_text=_("Zeit in Sekunden für Deep-Sleep-Modus (0 = deaktiviert)")
     )
+
+    low_power_ride = models.BooleanField(
+        default=False,
+        verbose_name=_("Stromsparendes Fahren"),
+        help_text=_("Light Sleep zwischen den Datenübertragungen, der ULP-Coprozessor zählt die Impulse weiter (nur ESP32, Sensor-Pin mit RTC-IO). Nicht für Stationen mit mehreren Rädern.")
+    )
+
+    trace_max_bytes = models.IntegerField(
+        default=0,
+        validators=[MinValueValidator(0), MaxValueValidator(512)],
+        verbose_name=_("Fahrtaufzeichnung (Bytes)"),
+        help_text=_("Bytes pro Datenübertragung für die Fahrtaufzeichnung (Zeitstempel jeder Radumdrehung, ca. 1 Byte pro Umdrehung). 0 = deaktiviert, maximal 512.")
+    )
+
+    trace_interval_seconds = models.IntegerField(
+        default=0,
+        validators=[MinValueValidator(0)],
+        verbose_name=_("Fahrtaufzeichnung-Intervall (Sekunden)"),
+        help_text=_("Mindestabstand in Sekunden zwischen Datenübertragungen mit Fahrtaufzeichnung. 0 = bei jeder Übertragung.")
+    )
     
     # Hardware configuration
     wheel_size = models.FloatField(
@@ -374,6 +394,9 @@ class DeviceConfiguration(models.Model):
             'paedagogischer_bonus': self.paedagogischer_bonus,
             'device_api_key': self.device_specific_api_key or '',
             'config_fetch_interval_seconds': self.config_fetch_interval_seconds,
+            'low_power_ride': self.low_power_ride,
+            'trace_max_bytes': self.trace_max_bytes,
+            'trace_interval_seconds': self.trace_interval_seconds,
         }
     
     def get_reported_device_name(self) -> str:
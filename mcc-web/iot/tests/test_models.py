@@ -216,6 +216,9 @@ class TestDeviceConfiguration:
         assert config_dict['send_interval_seconds'] == 120
         assert config_dict['server_url'] == "https://example.com"
         assert config_dict['debug_mode'] is True
+        assert config_dict['low_power_ride'] is False
+        assert config_dict['trace_max_bytes'] == 0
+        assert config_dict['trace_interval_seconds'] == 0
         assert 'device_name' not in config_dict  # Should not be included
 
 
@@ -1581,7 +1581,7 @@ class DeviceConfigurationInline(admin.StackedInline):
             'description': _("Passwort für den Config-WLAN-Hotspot (MCC_XXXX). Minimum 8 Zeichen erforderlich (WPA2-Anforderung).")
         }),
         (_("Geräte-Verhalten"), {
-            'fields': ('debug_mode', 'test_mode', 'test_distance_km', 'test_interval_seconds', 'deep_sleep_seconds', 'config_fetch_interval_seconds', 'request_config_comparison')
+            'fields': ('debug_mode', 'test_mode', 'test_distance_km', 'test_interval_seconds', 'deep_sleep_seconds', 'low_power_ride', 'trace_max_bytes', 'trace_interval_seconds', 'config_fetch_interval_seconds', 'request_config_comparison')
         }),
         (_("Hardware"), {
             'fields': ('wheel_size', 'paedagogischer_bonus', 'fkm_factor_preview')
@@ -5723,6 +5723,7 @@ class DeviceAdmin(RetryOnDbLockMixin, BaseAdmin):
     fields = ('name', 'display_name', 'group', 'is_visible', 'is_km_collection_enabled', 'distance_total', 'gps_latitude', 'gps_longitude', 'last_active', 'comments')
     formfield_overrides = {models.DecimalField: {'widget': MapInputWidget}}
     inlines = [DeviceConfigurationInline, DeviceConfigurationReportInline]
+    actions = ['operator_reset_action']
 
     def get_fields(self, request, obj=None):
         fields = list(super().get_fields(request, obj))
@@ -5762,6 +5763,36 @@ class DeviceAdmin(RetryOnDbLockMixin, BaseAdmin):
             return mark_safe('<span style="color: gray;">- Keine Konfiguration</span>')
     config_status.short_description = _("Konfigurationsstatus")
 
+    @admin.action(description=_("Operator-Reset (Standard-Radler, per MQTT)"))
+    def operator_reset_action(self, request, queryset):
+        """Same as presenting the operator tag, for devices connected over MQTT."""
+        from api.services import mqtt_push
+        from api.services.device_display import unlock_device_display
+        from api.services.device_session import end_device_session_for_device
+        from django.contrib import messages
+
+        if not mqtt_push.is_enabled():
+            self.message_user(request, _("MQTT ist nicht konfiguriert (MCC_MQTT_BROKER_URL)."), level=messages.ERROR)
+            return
+        sent_count = 0
+        for device in queryset:
+            end_device_session_for_device(device, reason='operator_reset')
+            unlock_device_display(device, reason='operator_reset')
+            if mqtt_push.push_operator_reset(device):
+                sent_count += 1
+            else:
+                self.message_user(
+                    request,
+                    _("%(device)s: Reset konnte nicht gesendet werden.") % {'device': device.name},
+                    level=messages.WARNING,
+                )
+        if sent_count:
+            self.message_user(
+                request,
+                _("%(count)s Gerät(e) zurückgesetzt.") % {'count': sent_count},
+                level=messages.SUCCESS,
+            )
+
     def save_model(self, request, obj, form, change):
         """Override save_model to automatically create DeviceConfiguration for new devices."""
         # Save the device first
@@ -6382,7 +6413,7 @@ class DeviceConfigurationAdmin(admin.ModelAdmin):
             'description': _("Passwort für den Config-WLAN-Hotspot. Minimum 8 Zeichen erforderlich (WPA2-Anforderung).")
         }),
         (_("Geräte-Verhalten"), {
-            'fields': ('debug_mode', 'test_mode', 'test_distance_km', 'test_interval_seconds', 'deep_sleep_seconds', 'config_fetch_interval_seconds', 'request_config_comparison')
+            'fields': ('debug_mode', 'test_mode', 'test_distance_km', 'test_interval_seconds', 'deep_sleep_seconds', 'low_power_ride', 'trace_max_bytes', 'trace_interval_seconds', 'config_fetch_interval_seconds', 'request_config_comparison')
         }),
         (_("Hardware"), {
             'fields': ('wheel_size', 'paedagogischer_bonus', 'fkm_factor_preview')